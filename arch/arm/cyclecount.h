@@ -0,0 +1,94 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef ARM_CYCLECOUNT_H_
+#define ARM_CYCLECOUNT_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Public functions
+ *----------------------------------------------------------------------------*/
+
+#if defined(CONFIG_ARCH_ARMV5TE)
+
+/* ARM926EJ-S has no cycle counter */
+
+static inline void cycle_counter_enable(void)
+{
+}
+
+static inline uint32_t cycle_counter_read(void)
+{
+	return 0;
+}
+
+#elif defined(CONFIG_ARCH_ARMV7A)
+
+static inline void cycle_counter_enable(void)
+{
+	uint32_t pmcr;
+
+	/* PMCR: enable the counters, count every cycle (no divider) */
+	asm volatile("mrc p15, 0, %0, c9, c12, 0" : "=r"(pmcr));
+	pmcr = (pmcr | (1 << 0)) & ~(1 << 3);
+	asm volatile("mcr p15, 0, %0, c9, c12, 0" :: "r"(pmcr));
+	/* PMCNTENSET: enable the cycle counter */
+	asm volatile("mcr p15, 0, %0, c9, c12, 1" :: "r"(1u << 31));
+}
+
+static inline uint32_t cycle_counter_read(void)
+{
+	uint32_t value;
+
+	asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(value));
+	return value;
+}
+
+#elif defined(CONFIG_ARCH_ARMV7M)
+
+static inline void cycle_counter_enable(void)
+{
+	/* DEMCR.TRCENA then DWT_CTRL.CYCCNTENA */
+	*(volatile uint32_t*)0xE000EDFC |= (1 << 24);
+	*(volatile uint32_t*)0xE0001000 |= (1 << 0);
+}
+
+static inline uint32_t cycle_counter_read(void)
+{
+	return *(volatile uint32_t*)0xE0001004;
+}
+
+#endif
+
+#endif /* ARM_CYCLECOUNT_H_ */
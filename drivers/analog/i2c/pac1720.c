@@ -151,6 +151,12 @@
 #define PAC1720_CSENSE_RANGE_40MV (2)
 #define PAC1720_CSENSE_RANGE_80MV (3)
 
+/* Conversion cycle set by pac1720_configure(): channel 1 only, 80 ms
+ * current sensing and 20 ms voltage sampling */
+#define PAC1720_CONVERSION_TIME_US (100 * 1000)
+
+#define PAC1720_RESULTS_LENGTH (PAC1720_CH2_PRATIO_L - PAC1720_CH1_VSENSE_V_H + 1)
+
 /*------------------------------------------------------------------------------
  *         Local functions
  *----------------------------------------------------------------------------*/
@@ -363,6 +369,44 @@ int pac1720_read_power(struct _pac1720_desc* desc, uint8_t channel, uint16_t* po
 	return err;
 }
 
+#ifdef CONFIG_HAVE_SENSOR_HUB
+
+static int _pac1720_hub_decode(void* arg, const uint8_t* reg, struct _sensor_hub_sample* sample)
+{
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		const uint8_t* vsense = &reg[2 * i];
+		const uint8_t* vsource = &reg[PAC1720_CH1_VSOURCE_V_H - PAC1720_CH1_VSENSE_V_H + 2 * i];
+		const uint8_t* pratio = &reg[PAC1720_CH1_PRATIO_H - PAC1720_CH1_VSENSE_V_H + 2 * i];
+
+		sample->value[i] = (vsense[1] >> 4) | ((uint16_t)vsense[0] << 4);
+		sample->value[2 + i] = (vsource[1] >> 5) | ((uint16_t)vsource[0] << 3);
+		sample->value[4 + i] = pratio[1] | ((uint16_t)pratio[0] << 8);
+	}
+	sample->count = 6;
+
+	return 0;
+}
+
+int pac1720_sensor_hub_device(struct _pac1720_desc* desc,
+		struct _sensor_hub_device* dev, uint32_t period)
+{
+	memset(dev, 0, sizeof(*dev));
+	dev->bus = desc->cfg.bus;
+	dev->addr = desc->addr;
+	dev->reg = PAC1720_CH1_VSENSE_V_H;
+	dev->len = PAC1720_RESULTS_LENGTH;
+	dev->conversion = PAC1720_CONVERSION_TIME_US;
+	dev->period = period;
+	dev->decode = _pac1720_hub_decode;
+	dev->arg = desc;
+
+	return 0;
+}
+
+#endif /* CONFIG_HAVE_SENSOR_HUB */
+
 int pac1720_convert(struct _pac1720_desc* desc, float rsense,
 		uint16_t vsense, uint16_t vsource, uint16_t pratio,
 		float *i, float *v, float *p)
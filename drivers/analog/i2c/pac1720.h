@@ -36,6 +36,10 @@
 
 #include "peripherals/bus.h"
 
+#ifdef CONFIG_HAVE_SENSOR_HUB
+#include "sensor/sensor_hub.h"
+#endif
+
 /*----------------------------------------------------------------------------
  *        Definitions
  *----------------------------------------------------------------------------*/
@@ -67,4 +71,17 @@ extern int pac1720_convert(struct _pac1720_desc* desc, float rsense,
 		uint16_t vsense, uint16_t vsource, uint16_t pratio,
 		float* i, float* v, float* w);
 
+#ifdef CONFIG_HAVE_SENSOR_HUB
+/**
+ * \brief Describe the device for the sensor hub: one burst read of the
+ * VSENSE, VSOURCE and power ratio registers of both channels.
+ * Samples hold the raw codes, as returned by pac1720_read_vsense(),
+ * pac1720_read_vsource() and pac1720_read_power(): VSENSE channel 1 and 2
+ * (value[0..1]), VSOURCE channel 1 and 2 (value[2..3]) and power ratio
+ * channel 1 and 2 (value[4..5]).
+ */
+extern int pac1720_sensor_hub_device(struct _pac1720_desc* desc,
+		struct _sensor_hub_device* dev, uint32_t period);
+#endif
+
 #endif /* ! PAC1720_H_ */
@@ -46,10 +46,12 @@
 #include "compiler.h"
 #include "dma/dma.h"
 #include "irq/irq.h"
+#include "irqflags.h"
 #include "errno.h"
 #include "mm/cache.h"
 #include "mutex.h"
 #include "peripherals/pmc.h"
+#include "power/clkmgr.h"
 
 /*----------------------------------------------------------------------------
  *        Macros
@@ -156,6 +158,63 @@ static inline bool is_dest_periph(struct _dma_channel* channel)
 	return ((channel->dest_txif != 0xff) | (channel->dest_rxif != 0xff));
 }
 
+static uint32_t _dma_get_pid(struct _dma_channel* channel)
+{
+	uint32_t ctrl;
+
+	for (ctrl = 0; ctrl < DMA_CONTROLLERS; ctrl++)
+		if (_dma_ctrl.controllers[ctrl].hw == channel->hw)
+			return _dma_ctrl.controllers[ctrl].pid;
+
+	assert(0);
+	return ID_PERIPH_COUNT;
+}
+
+/**
+ * \brief Take a reference on the controller clock for the duration of a
+ * transfer
+ */
+static void _dma_hold_clock(struct _dma_channel* channel)
+{
+	uint32_t flags = arch_irq_save();
+	if (!channel->clock_held) {
+		clkmgr_get(_dma_get_pid(channel));
+		channel->clock_held = true;
+	}
+	arch_irq_restore(flags);
+}
+
+/**
+ * \brief Drop the controller clock reference of a transfer that is neither
+ * running nor suspended anymore
+ */
+static void _dma_release_clock(struct _dma_channel* channel)
+{
+	uint32_t flags = arch_irq_save();
+	if (channel->clock_held &&
+	    channel->state != DMA_STATE_STARTED &&
+	    channel->state != DMA_STATE_SUSPENDED) {
+		channel->clock_held = false;
+		clkmgr_put(_dma_get_pid(channel));
+	}
+	arch_irq_restore(flags);
+}
+
+/**
+ * \brief Controller interrupt handler: the transfer callbacks still access
+ * the channel registers, release the clocks once they have returned
+ */
+static void _dma_irq_handler(uint32_t source, void* user_arg)
+{
+	struct _dma_controller* controller = (struct _dma_controller*)user_arg;
+	uint32_t chan;
+
+	dma_irq_handler(source, user_arg);
+
+	for (chan = 0; chan < DMA_CHANNELS; chan++)
+		_dma_release_clock(&controller->channels[chan]);
+}
+
 /**
  * \brief Preinitialize all descriptors and pool and link them together
  */
@@ -506,11 +565,12 @@ void dma_initialize(bool polling)
 			channel->dest_txif = 0;
 			channel->dest_rxif = 0;
 			channel->state = DMA_STATE_FREE;
+			channel->clock_held = false;
 		}
 
 		if (!polling) {
 			/* enable interrupts */
-			irq_add_handler(controller->pid, dma_irq_handler, controller);
+			irq_add_handler(controller->pid, _dma_irq_handler, controller);
 			irq_enable(controller->pid);
 		}
 	}
@@ -522,7 +582,10 @@ void dma_poll(void)
 		uint32_t ctrl;
 		for (ctrl = 0; ctrl < DMA_CONTROLLERS; ctrl++) {
 			struct _dma_controller* controller = &_dma_ctrl.controllers[ctrl];
-			dma_irq_handler(controller->pid, controller);
+			/* a gated controller has no transfer in progress */
+			if (!pmc_is_peripheral_enabled(controller->pid))
+				continue;
+			_dma_irq_handler(controller->pid, controller);
 		}
 	}
 }
@@ -556,7 +619,9 @@ struct _dma_channel* dma_allocate_channel(uint8_t src, uint8_t dest)
 				channel->src_rxif = get_peripheral_dma_channel(src, channel->hw, false);
 				channel->dest_txif = get_peripheral_dma_channel(dest, channel->hw, true);
 				channel->dest_rxif = get_peripheral_dma_channel(dest, channel->hw, false);
+				clkmgr_get(_dma_get_pid(channel));
 				dma_prepare_channel(channel);
+				clkmgr_put(_dma_get_pid(channel));
 
 				channel->sg_list = NULL;
 
@@ -575,6 +640,7 @@ int dma_reset_channel(struct _dma_channel* channel)
 	if (channel->state == DMA_STATE_STARTED)
 		return -EBUSY;
 
+	clkmgr_get(_dma_get_pid(channel));
 #if defined(CONFIG_HAVE_XDMAC)
 	/* Disable channel */
 	xdmac_disable_channel(channel->hw, channel->id);
@@ -588,12 +654,14 @@ int dma_reset_channel(struct _dma_channel* channel)
 	/* Disable interrupts */
 	dmac_disable_global_it(channel->hw, (DMAC_EBCIDR_CBTC0 | DMAC_EBCIER_BTC0 | DMAC_EBCIER_ERR0) << channel->id);
 #endif
+	clkmgr_put(_dma_get_pid(channel));
 
 	_dma_sg_desc_free(channel->sg_list);
 	channel->sg_list = NULL;
 
 	/* Change state to 'allocated' */
 	channel->state = DMA_STATE_ALLOCATED;
+	_dma_release_clock(channel);
 
 	return 0;
 }
@@ -621,6 +689,7 @@ int dma_start_transfer(struct _dma_channel* channel)
 		return -EBUSY;
 
 	/* Change state to 'started' */
+	_dma_hold_clock(channel);
 	channel->state = DMA_STATE_STARTED;
 
 	/* Start DMA transfer */
@@ -641,6 +710,7 @@ int dma_start_transfer(struct _dma_channel* channel)
 
 int dma_stop_transfer(struct _dma_channel* channel)
 {
+	clkmgr_get(_dma_get_pid(channel));
 #if defined(CONFIG_HAVE_XDMAC)
 	/* Disable channel */
 	xdmac_disable_channel(channel->hw, channel->id);
@@ -655,9 +725,11 @@ int dma_stop_transfer(struct _dma_channel* channel)
 	/* Clear pending status */
 	dmac_get_global_isr(channel->hw);
 #endif
+	clkmgr_put(_dma_get_pid(channel));
 
 	/* Change state to 'allocated' */
 	channel->state = DMA_STATE_ALLOCATED;
+	_dma_release_clock(channel);
 
 	return 0;
 }
@@ -692,33 +764,47 @@ int dma_resume_transfer(struct _dma_channel* channel)
 
 void dma_fifo_flush(struct _dma_channel* channel)
 {
+	clkmgr_get(_dma_get_pid(channel));
 #if defined(CONFIG_HAVE_XDMAC)
 	xdmac_fifo_flush(channel->hw, channel->id);
 #elif defined(CONFIG_HAVE_DMAC)
 	dmac_fifo_flush(channel->hw, channel->id);
 #endif
+	clkmgr_put(_dma_get_pid(channel));
 }
 
 int dma_configure_transfer(struct _dma_channel* channel,
 			   struct _dma_cfg* cfg_dma,
 			   struct _dma_transfer_cfg* list, uint8_t list_size)
 {
+	int err;
+
 	if (list_size == 0)
 		return -EINVAL;
 
+	clkmgr_get(_dma_get_pid(channel));
 	if ((list_size == 1) && (!cfg_dma->loop))
-		return _dma_configure_transfer(channel, cfg_dma, list);
+		err = _dma_configure_transfer(channel, cfg_dma, list);
 	else
-		return _dma_sg_configure_transfer(channel, cfg_dma, list, list_size);
+		err = _dma_sg_configure_transfer(channel, cfg_dma, list, list_size);
+	clkmgr_put(_dma_get_pid(channel));
+
+	return err;
 }
 
 uint32_t dma_get_transferred_data_len(struct _dma_channel* channel, uint8_t chunk_size, uint32_t len)
 {
+	uint32_t transferred;
+
+	clkmgr_get(_dma_get_pid(channel));
 #if defined(CONFIG_HAVE_XDMAC)
-	return len - xdmac_get_microblock_control(channel->hw, channel->id) * (1 << chunk_size);
+	transferred = len - xdmac_get_microblock_control(channel->hw, channel->id) * (1 << chunk_size);
 #elif defined(CONFIG_HAVE_DMAC)
-	return dmac_get_btsize(channel->hw, channel->id) * (1 << chunk_size);
+	transferred = dmac_get_btsize(channel->hw, channel->id) * (1 << chunk_size);
 #endif
+	clkmgr_put(_dma_get_pid(channel));
+
+	return transferred;
 }
 
 int dma_set_callback(struct _dma_channel* channel, struct _callback* cb)
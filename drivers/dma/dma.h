@@ -132,6 +132,7 @@ struct _dma_channel {
 	volatile uint32_t rep_count;/* repeat count in auto mode */
 #endif
 	volatile uint8_t state;		/* Channel State */
+	volatile bool clock_held;	/* Controller clock held by the transfer */
 
 	struct _dma_sg_desc* sg_list;
 };
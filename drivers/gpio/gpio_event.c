@@ -0,0 +1,305 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "compiler.h"
+#include "gpio/gpio_event.h"
+#include "gpio/pio.h"
+
+#ifndef GPIO_EVENT_HOST
+#include "chip.h"
+#include "irqflags.h"
+#include "timer.h"
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define QUAD_INVALID 2
+
+/* Quadrature transitions, indexed by (previous A/B << 2) | current A/B.
+ * Forward sequence: 00 -> 10 -> 11 -> 01 -> 00 */
+static const int8_t _gpio_quad_table[16] = {
+	 0, -1,  1, QUAD_INVALID,
+	 1,  0, QUAD_INVALID, -1,
+	-1, QUAD_INVALID,  0,  1,
+	QUAD_INVALID,  1, -1,  0,
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions: state machines and queue
+ *----------------------------------------------------------------------------*/
+
+void gpio_debounce_init(struct _gpio_debounce* db, uint32_t delay, uint8_t level)
+{
+	db->delay = delay;
+	db->since = 0;
+	db->level = level ? 1 : 0;
+	db->locked = false;
+}
+
+bool gpio_debounce_update(struct _gpio_debounce* db, uint32_t now, uint8_t level)
+{
+	if (db->locked) {
+		if ((now - db->since) < db->delay)
+			return false;
+		db->locked = false;
+	}
+
+	level = level ? 1 : 0;
+	if (level == db->level)
+		return false;
+
+	db->level = level;
+	db->since = now;
+	db->locked = true;
+	return true;
+}
+
+void gpio_quad_init(struct _gpio_quad* quad, uint8_t steps, uint8_t a, uint8_t b)
+{
+	quad->state = (a ? 2 : 0) | (b ? 1 : 0);
+	quad->count = 0;
+	quad->steps = steps ? steps : 1;
+	quad->errors = 0;
+}
+
+int gpio_quad_update(struct _gpio_quad* quad, uint8_t a, uint8_t b)
+{
+	uint8_t state = (a ? 2 : 0) | (b ? 1 : 0);
+	int8_t delta = _gpio_quad_table[(quad->state << 2) | state];
+
+	quad->state = state;
+
+	if (delta == QUAD_INVALID) {
+		quad->errors++;
+		return 0;
+	}
+
+	quad->count += delta;
+	if (quad->count >= (int8_t)quad->steps) {
+		quad->count = 0;
+		return 1;
+	} else if (quad->count <= -(int8_t)quad->steps) {
+		quad->count = 0;
+		return -1;
+	}
+
+	return 0;
+}
+
+void gpio_event_queue_init(struct _gpio_event_queue* queue,
+                           struct _gpio_event* events, uint16_t size)
+{
+	queue->events = events;
+	queue->size = size;
+	queue->head = 0;
+	queue->tail = 0;
+	queue->overflows = 0;
+}
+
+bool gpio_event_queue_push(struct _gpio_event_queue* queue,
+                           const struct _gpio_event* event)
+{
+	uint16_t head = queue->head;
+	uint16_t next = (head + 1) % queue->size;
+
+	if (next == queue->tail) {
+		queue->overflows++;
+		return false;
+	}
+
+	queue->events[head] = *event;
+	/* publish the event before the index */
+	COMPILER_BARRIER();
+	queue->head = next;
+	return true;
+}
+
+bool gpio_event_queue_pop(struct _gpio_event_queue* queue,
+                          struct _gpio_event* event)
+{
+	uint16_t tail = queue->tail;
+
+	if (tail == queue->head)
+		return false;
+
+	COMPILER_BARRIER();
+	*event = queue->events[tail];
+	COMPILER_BARRIER();
+	queue->tail = (tail + 1) % queue->size;
+	return true;
+}
+
+#ifndef GPIO_EVENT_HOST
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct _gpio_event_queue _gpio_event_queue;
+
+static struct _gpio_event_source* _gpio_event_sources;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _gpio_event_emit(const struct _gpio_event_source* source,
+                             uint32_t now, uint8_t type, int8_t value)
+{
+	struct _gpio_event event = {
+		.timestamp = now,
+		.id = source->id,
+		.type = type,
+		.value = value,
+	};
+
+	gpio_event_queue_push(&_gpio_event_queue, &event);
+}
+
+static uint8_t _gpio_event_level(const struct _pin* pin)
+{
+	return pio_get(pin) ? 1 : 0;
+}
+
+static void _gpio_event_handler(uint32_t group, uint32_t status, void* arg)
+{
+	struct _gpio_event_source* source = (struct _gpio_event_source*)arg;
+	uint32_t now = (uint32_t)timer_get_us();
+	int step;
+
+	if (source->type == GPIO_EVENT_EDGE) {
+		if (gpio_debounce_update(&source->debounce, now, _gpio_event_level(source->pin[0])))
+			_gpio_event_emit(source, now, GPIO_EVENT_EDGE, source->debounce.level);
+	} else {
+		step = gpio_quad_update(&source->quad,
+				_gpio_event_level(source->pin[0]),
+				_gpio_event_level(source->pin[1]));
+		if (step)
+			_gpio_event_emit(source, now, GPIO_EVENT_STEP, step);
+	}
+}
+
+static void _gpio_event_attach(struct _gpio_event_source* source)
+{
+	const struct _pin* a = source->pin[0];
+	const struct _pin* b = source->pin[1];
+
+	source->next = _gpio_event_sources;
+	_gpio_event_sources = source;
+
+	/* one handler per PIO group */
+	if (b && b->group == a->group) {
+		pio_add_handler_to_group(a->group, a->mask | b->mask,
+				_gpio_event_handler, source);
+	} else {
+		pio_add_handler_to_group(a->group, a->mask, _gpio_event_handler, source);
+		if (b)
+			pio_add_handler_to_group(b->group, b->mask, _gpio_event_handler, source);
+	}
+
+	pio_enable_it(a);
+	if (b)
+		pio_enable_it(b);
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void gpio_event_init(struct _gpio_event* events, uint16_t size)
+{
+	gpio_event_queue_init(&_gpio_event_queue, events, size);
+	_gpio_event_sources = NULL;
+}
+
+void gpio_event_add_button(struct _gpio_event_source* source, uint8_t id,
+                           const struct _pin* pin, uint32_t debounce)
+{
+	memset(source, 0, sizeof(*source));
+	source->id = id;
+	source->type = GPIO_EVENT_EDGE;
+	source->pin[0] = pin;
+	gpio_debounce_init(&source->debounce, debounce, _gpio_event_level(pin));
+
+	_gpio_event_attach(source);
+}
+
+void gpio_event_add_encoder(struct _gpio_event_source* source, uint8_t id,
+                            const struct _pin* pin_a, const struct _pin* pin_b,
+                            uint8_t steps)
+{
+	memset(source, 0, sizeof(*source));
+	source->id = id;
+	source->type = GPIO_EVENT_STEP;
+	source->pin[0] = pin_a;
+	source->pin[1] = pin_b;
+	gpio_quad_init(&source->quad, steps,
+			_gpio_event_level(pin_a), _gpio_event_level(pin_b));
+
+	_gpio_event_attach(source);
+}
+
+void gpio_event_poll(void)
+{
+	struct _gpio_event_source* source;
+	uint32_t flags;
+	uint32_t now;
+
+	for (source = _gpio_event_sources; source; source = source->next) {
+		if (source->type != GPIO_EVENT_EDGE || !source->debounce.locked)
+			continue;
+
+		/* the PIO interrupt updates the debouncer too */
+		flags = arch_irq_save();
+		now = (uint32_t)timer_get_us();
+		if (gpio_debounce_update(&source->debounce, now, _gpio_event_level(source->pin[0])))
+			_gpio_event_emit(source, now, GPIO_EVENT_EDGE, source->debounce.level);
+		arch_irq_restore(flags);
+	}
+}
+
+bool gpio_event_get(struct _gpio_event* event)
+{
+	return gpio_event_queue_pop(&_gpio_event_queue, event);
+}
+
+uint32_t gpio_event_get_overflows(void)
+{
+	return _gpio_event_queue.overflows;
+}
+
+#endif /* !GPIO_EVENT_HOST */
@@ -0,0 +1,219 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _GPIO_EVENT_H
+#define _GPIO_EVENT_H
+
+/**
+ * \file
+ *
+ * GPIO event subsystem.
+ *
+ * Buttons and rotary encoders are attached to PIO interrupts. Their
+ * interrupt handlers filter bounces and decode the encoder steps, and push
+ * the resulting events into a lock-free queue, read from thread context
+ * with gpio_event_get().
+ *
+ * Debouncing uses a lockout: the first edge changing the stable level is
+ * reported immediately, then the input is ignored for the debounce delay.
+ * gpio_event_poll() samples the inputs whose lockout has expired, to report
+ * a level change that happened during the lockout; it should be called
+ * from the main loop.
+ *
+ * Encoders are decoded with a transition table on both edges of both
+ * inputs, invalid transitions (both inputs changed) are counted and
+ * ignored.
+ *
+ * The queue has a single producer: all the PIO interrupts feeding it must
+ * have the same priority.
+ */
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gpio/pio.h"
+
+/*------------------------------------------------------------------------------
+ *         Global Types
+ *------------------------------------------------------------------------------*/
+
+enum _gpio_event_type {
+	GPIO_EVENT_EDGE,    /*< debounced level change, value is the new level */
+	GPIO_EVENT_STEP,    /*< encoder detent, value is +1 or -1 */
+};
+
+struct _gpio_event {
+	uint32_t timestamp; /*< time of the event (us) */
+	uint8_t id;         /*< source ID */
+	uint8_t type;       /*< enum _gpio_event_type */
+	int8_t value;
+};
+
+struct _gpio_event_queue {
+	struct _gpio_event* events;
+	uint16_t size;
+	volatile uint16_t head;
+	volatile uint16_t tail;
+	volatile uint32_t overflows;
+};
+
+struct _gpio_debounce {
+	uint32_t delay;     /*< lockout after an edge (us) */
+	uint32_t since;     /*< time of the last reported edge (us) */
+	uint8_t level;      /*< stable level */
+	bool locked;
+};
+
+struct _gpio_quad {
+	uint8_t state;      /*< last A/B levels */
+	int8_t count;       /*< transitions since the last detent */
+	uint8_t steps;      /*< transitions per detent */
+	uint32_t errors;    /*< invalid transitions */
+};
+
+struct _gpio_event_source {
+	uint8_t id;
+	uint8_t type;
+	const struct _pin* pin[2];
+	union {
+		struct _gpio_debounce debounce;
+		struct _gpio_quad quad;
+	};
+	struct _gpio_event_source* next;
+};
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a debouncer
+ * \param delay Lockout after an edge (us)
+ * \param level Initial level
+ */
+extern void gpio_debounce_init(struct _gpio_debounce* db, uint32_t delay, uint8_t level);
+
+/**
+ * \brief Feed a debouncer with the level sampled at a given time
+ * \return true if the stable level changed (to level)
+ */
+extern bool gpio_debounce_update(struct _gpio_debounce* db, uint32_t now, uint8_t level);
+
+/**
+ * \brief Initialize a quadrature decoder
+ * \param steps Transitions per detent (1, 2 or 4)
+ * \param a Initial level of input A
+ * \param b Initial level of input B
+ */
+extern void gpio_quad_init(struct _gpio_quad* quad, uint8_t steps, uint8_t a, uint8_t b);
+
+/**
+ * \brief Feed a quadrature decoder with the levels of its inputs
+ * \return +1 or -1 when a detent is reached, 0 otherwise
+ */
+extern int gpio_quad_update(struct _gpio_quad* quad, uint8_t a, uint8_t b);
+
+/**
+ * \brief Initialize an event queue
+ * \param events Storage for the queue
+ * \param size Number of events in storage
+ */
+extern void gpio_event_queue_init(struct _gpio_event_queue* queue,
+                                  struct _gpio_event* events, uint16_t size);
+
+/**
+ * \brief Push an event (producer side, interrupt context)
+ * \return false if the queue was full, the event is dropped
+ */
+extern bool gpio_event_queue_push(struct _gpio_event_queue* queue,
+                                  const struct _gpio_event* event);
+
+/**
+ * \brief Pop the oldest event (consumer side, thread context)
+ * \return false if the queue is empty
+ */
+extern bool gpio_event_queue_pop(struct _gpio_event_queue* queue,
+                                 struct _gpio_event* event);
+
+#ifndef GPIO_EVENT_HOST
+
+/**
+ * \brief Initialize the GPIO event subsystem
+ * \param events Storage for the event queue
+ * \param size Number of events in storage
+ */
+extern void gpio_event_init(struct _gpio_event* events, uint16_t size);
+
+/**
+ * \brief Attach a debounced input. The pin must be configured as input
+ * with PIO_IT_BOTH_EDGE.
+ * \param source Source storage, must remain valid
+ * \param id Source ID reported in the events
+ * \param pin Input pin
+ * \param debounce Debounce delay (us)
+ */
+extern void gpio_event_add_button(struct _gpio_event_source* source, uint8_t id,
+                                  const struct _pin* pin, uint32_t debounce);
+
+/**
+ * \brief Attach a rotary encoder. The pins must be configured as inputs
+ * with PIO_IT_BOTH_EDGE.
+ * \param source Source storage, must remain valid
+ * \param id Source ID reported in the events
+ * \param pin_a Input A
+ * \param pin_b Input B
+ * \param steps Transitions per detent (1, 2 or 4)
+ */
+extern void gpio_event_add_encoder(struct _gpio_event_source* source, uint8_t id,
+                                   const struct _pin* pin_a, const struct _pin* pin_b,
+                                   uint8_t steps);
+
+/**
+ * \brief Report the level changes masked by the debounce lockout
+ */
+extern void gpio_event_poll(void);
+
+/**
+ * \brief Get the next event
+ * \return false if no event is pending
+ */
+extern bool gpio_event_get(struct _gpio_event* event);
+
+/**
+ * \brief Number of events dropped because the queue was full
+ */
+extern uint32_t gpio_event_get_overflows(void);
+
+#endif /* !GPIO_EVENT_HOST */
+
+#endif /* _GPIO_EVENT_H */
@@ -100,6 +100,32 @@ struct _pin
 
 typedef void (*pio_handler_t)(uint32_t group, uint32_t status, void *arg);
 
+/** Maximum number of shifts needed to map a pin group on one PIO group */
+#define PIO_PIN_GROUP_MAX_RUNS 8
+
+/* Value bits in mask land on the pins at bit + shift */
+struct _pio_pin_group_run
+{
+	uint32_t mask;
+	int8_t   shift;
+};
+
+struct _pio_pin_group_port
+{
+	uint8_t  group;     /*< PIO group */
+	uint8_t  runs;      /*< Number of runs */
+	uint32_t mask;      /*< Pins of the PIO group used by the pin group */
+	struct _pio_pin_group_run run[PIO_PIN_GROUP_MAX_RUNS];
+};
+
+/* Pin group compiled by pio_pin_group_compile() */
+struct _pio_pin_group
+{
+	uint8_t width;      /*< Number of bits of the values */
+	uint8_t ports;      /*< Number of PIO groups used */
+	struct _pio_pin_group_port port[PIO_GROUP_LENGTH];
+};
+
 /*------------------------------------------------------------------------------
  *         Exported functions
  *------------------------------------------------------------------------------*/
@@ -108,6 +134,40 @@ typedef void (*pio_handler_t)(uint32_t group, uint32_t status, void *arg);
 extern "C" {
 #endif
 
+/**
+ * \brief Map the bits of a pin group value to the pins of one PIO group
+ */
+static inline uint32_t pio_pin_group_to_port(const struct _pio_pin_group_port* port, uint32_t value)
+{
+	uint32_t bits = 0;
+	int i;
+
+	for (i = 0; i < port->runs; i++) {
+		uint32_t v = value & port->run[i].mask;
+		int8_t shift = port->run[i].shift;
+		bits |= shift >= 0 ? v << shift : v >> -shift;
+	}
+
+	return bits;
+}
+
+/**
+ * \brief Map the pins of one PIO group to the bits of a pin group value
+ */
+static inline uint32_t pio_pin_group_from_port(const struct _pio_pin_group_port* port, uint32_t bits)
+{
+	uint32_t value = 0;
+	int i;
+
+	for (i = 0; i < port->runs; i++) {
+		int8_t shift = port->run[i].shift;
+		uint32_t v = shift >= 0 ? bits >> shift : bits << -shift;
+		value |= v & port->run[i].mask;
+	}
+
+	return value;
+}
+
 /**
  * \brief Configures a list of Pin instances.
  *
@@ -224,6 +284,44 @@ extern void pio_enable_it(const struct _pin *pin);
  */
 extern void pio_disable_it(const struct _pin *pin);
 
+/**
+ * \brief Compile a list of pins into a pin group.
+ *
+ * \details Bit i of the values written or read through the pin group is
+ * mapped to pins[i], which must describe a single pin. The pins may be
+ * spread over several PIO groups; for each of them, the pin group holds
+ * the mask of its pins and the shifts moving the value bits in place, so
+ * that pio_pin_group_write() and pio_pin_group_read() access each PIO group
+ * once. Pins still have to be configured with pio_configure().
+ *
+ * \param pin_group Compiled pin group
+ * \param pins List of pins, one per value bit (up to 32)
+ * \param size Size of the pins list
+ * \return 0 on success, -EINVAL for an invalid or duplicated pin, -E2BIG
+ * if the pins of a PIO group need more than PIO_PIN_GROUP_MAX_RUNS shifts
+ */
+extern int pio_pin_group_compile(struct _pio_pin_group* pin_group,
+                                 const struct _pin *pins, uint32_t size);
+
+/**
+ * \brief Output a value on a pin group.
+ *
+ * Each PIO group is updated with a single masked write to its output data
+ * register (PIO4) or one set and one clear access (PIO3).
+ *
+ * \param pin_group Compiled pin group
+ * \param value Value to output, bit i driving pins[i]
+ */
+extern void pio_pin_group_write(const struct _pio_pin_group* pin_group, uint32_t value);
+
+/**
+ * \brief Read the levels of a pin group.
+ *
+ * \param pin_group Compiled pin group
+ * \return Value read, bit i being the level of pins[i]
+ */
+extern uint32_t pio_pin_group_read(const struct _pio_pin_group* pin_group);
+
 #ifdef __cplusplus
 }
 #endif
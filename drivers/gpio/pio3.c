@@ -87,6 +87,12 @@ struct _handler {
 
 static struct _handler _handlers[IRQ_PIO_HANDLERS_SIZE];
 
+/* For each pin, bitmap of the _handlers entries registered on it */
+static uint32_t _pin_handlers[PIO_GROUP_LENGTH][32];
+
+/* Pins with at least one handler, per group */
+static uint32_t _group_handled[PIO_GROUP_LENGTH];
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -208,6 +214,14 @@ static void _handler_push(uint32_t group, uint32_t mask, pio_handler_t handler,
 	_handlers[i].mask = mask;
 	_handlers[i].handler = handler;
 	_handlers[i].user_arg = user_arg;
+
+	_group_handled[group] |= mask;
+	while (mask) {
+		int bit = 31 - CLZ(mask);
+		_pin_handlers[group][bit] |= 1u << i;
+		mask &= ~(1u << bit);
+	}
+
 	i++;
 }
 
@@ -215,9 +229,21 @@ static void _pio_handle_interrupt(uint32_t group, Pio* pio)
 {
 	int i;
 	uint32_t status = pio->PIO_ISR;
-	for (i = 0; i < ARRAY_SIZE(_handlers); i++) {
-		if (_handlers[i].group == group && (_handlers[i].mask & status))
-			_handlers[i].handler(group, status, _handlers[i].user_arg);
+	uint32_t pending = status & _group_handled[group];
+	uint32_t handlers = 0;
+
+	/* collect the handlers of the pending pins, then call each once */
+	while (pending) {
+		i = 31 - CLZ(pending);
+		handlers |= _pin_handlers[group][i];
+		pending &= ~(1u << i);
+	}
+
+	while (handlers) {
+		/* lowest first: handlers are called in registration order */
+		i = 31 - CLZ(handlers & -handlers);
+		_handlers[i].handler(group, status, _handlers[i].user_arg);
+		handlers &= ~(1u << i);
 	}
 }
 
@@ -403,6 +429,37 @@ uint32_t pio_get_output_data_status(const struct _pin *pin)
 	return pio->PIO_ODSR & pin->mask;
 }
 
+void pio_pin_group_write(const struct _pio_pin_group* pin_group, uint32_t value)
+{
+	int i;
+
+	for (i = 0; i < pin_group->ports; i++) {
+		const struct _pio_pin_group_port* port = &pin_group->port[i];
+		Pio* pio = _pio_get_instance(port->group);
+		uint32_t bits = pio_pin_group_to_port(port, value);
+
+		/* PIO_ODSR writes would also affect the pins of other pin groups
+		 * enabled in PIO_OWSR, use the set/clear registers instead */
+		pio->PIO_SODR = bits;
+		pio->PIO_CODR = port->mask & ~bits;
+	}
+}
+
+uint32_t pio_pin_group_read(const struct _pio_pin_group* pin_group)
+{
+	int i;
+	uint32_t value = 0;
+
+	for (i = 0; i < pin_group->ports; i++) {
+		const struct _pio_pin_group_port* port = &pin_group->port[i];
+		Pio* pio = _pio_get_instance(port->group);
+
+		value |= pio_pin_group_from_port(port, pio->PIO_PDSR);
+	}
+
+	return value;
+}
+
 void pio_set_debounce_filter(uint32_t cutoff)
 {
 	int i;
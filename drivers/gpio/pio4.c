@@ -62,6 +62,7 @@
 
 #include "chip.h"
 #include "irq/irq.h"
+#include "irqflags.h"
 #include "gpio/pio.h"
 #include "peripherals/pmc.h"
 
@@ -87,6 +88,12 @@ struct _handler {
 
 static struct _handler _handlers[IRQ_PIO_HANDLERS_SIZE];
 
+/* For each pin, bitmap of the _handlers entries registered on it */
+static uint32_t _pin_handlers[PIO_GROUP_LENGTH][32];
+
+/* Pins with at least one handler, per group */
+static uint32_t _group_handled[PIO_GROUP_LENGTH];
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -161,6 +168,14 @@ static void _handler_push(uint32_t group, uint32_t mask, pio_handler_t handler,
 	_handlers[i].mask = mask;
 	_handlers[i].handler = handler;
 	_handlers[i].user_arg = user_arg;
+
+	_group_handled[group] |= mask;
+	while (mask) {
+		int bit = 31 - CLZ(mask);
+		_pin_handlers[group][bit] |= 1u << i;
+		mask &= ~(1u << bit);
+	}
+
 	i++;
 }
 
@@ -168,9 +183,21 @@ static void _pio_handle_interrupt(uint32_t group)
 {
 	int i;
 	uint32_t status = PIOA->PIO_IO[group].PIO_ISR;
-	for (i = 0; i < ARRAY_SIZE(_handlers); i++) {
-		if (_handlers[i].group == group && (_handlers[i].mask & status))
-			_handlers[i].handler(group, status, _handlers[i].user_arg);
+	uint32_t pending = status & _group_handled[group];
+	uint32_t handlers = 0;
+
+	/* collect the handlers of the pending pins, then call each once */
+	while (pending) {
+		i = 31 - CLZ(pending);
+		handlers |= _pin_handlers[group][i];
+		pending &= ~(1u << i);
+	}
+
+	while (handlers) {
+		/* lowest first: handlers are called in registration order */
+		i = 31 - CLZ(handlers & -handlers);
+		_handlers[i].handler(group, status, _handlers[i].user_arg);
+		handlers &= ~(1u << i);
 	}
 }
 
@@ -352,6 +379,39 @@ uint32_t pio_get_output_data_status(const struct _pin *pin)
 	return pio->PIO_ODSR & pin->mask;
 }
 
+void pio_pin_group_write(const struct _pio_pin_group* pin_group, uint32_t value)
+{
+	int i;
+	uint32_t flags;
+
+	for (i = 0; i < pin_group->ports; i++) {
+		const struct _pio_pin_group_port* port = &pin_group->port[i];
+		PioIo* pio = _pio_get_instance(port->group);
+		uint32_t bits = pio_pin_group_to_port(port, value);
+
+		/* PIO_MSKR is shared with pio_configure() and other pin groups */
+		flags = arch_irq_save();
+		pio->PIO_MSKR = port->mask;
+		pio->PIO_ODSR = bits;
+		arch_irq_restore(flags);
+	}
+}
+
+uint32_t pio_pin_group_read(const struct _pio_pin_group* pin_group)
+{
+	int i;
+	uint32_t value = 0;
+
+	for (i = 0; i < pin_group->ports; i++) {
+		const struct _pio_pin_group_port* port = &pin_group->port[i];
+		PioIo* pio = _pio_get_instance(port->group);
+
+		value |= pio_pin_group_from_port(port, pio->PIO_PDSR);
+	}
+
+	return value;
+}
+
 void pio_set_debounce_filter(uint32_t cutoff)
 {
 	cutoff = ((pmc_get_slow_clock() / (2 * cutoff)) - 1) & 0x3FFF;
@@ -0,0 +1,148 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+
+#include "chip.h"
+#include "callback.h"
+#include "gpio/pio.h"
+#include "gpio/pio_bitbang.h"
+#include "peripherals/tcd.h"
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _pio_bitbang_get_value(const struct _pio_bitbang* bitbang, uint32_t index)
+{
+	switch (bitbang->size) {
+	case 1:
+		return ((const uint8_t*)bitbang->data)[index];
+	case 2:
+		return ((const uint16_t*)bitbang->data)[index];
+	default:
+		return ((const uint32_t*)bitbang->data)[index];
+	}
+}
+
+static void _pio_bitbang_end(struct _pio_bitbang* bitbang)
+{
+	tcd_stop(bitbang->tc);
+	bitbang->busy = false;
+}
+
+static int _pio_bitbang_tick(void* arg, void* arg2)
+{
+	struct _pio_bitbang* bitbang = (struct _pio_bitbang*)arg;
+	uint32_t index = bitbang->index;
+
+	if (!bitbang->busy)
+		return 0;
+
+	pio_pin_group_write(bitbang->pin_group, _pio_bitbang_get_value(bitbang, index));
+
+	if (++index < bitbang->count) {
+		bitbang->index = index;
+		return 0;
+	}
+
+	bitbang->index = index;
+	_pio_bitbang_end(bitbang);
+	return callback_call(&bitbang->callback, NULL);
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+void pio_bitbang_init(struct _pio_bitbang* bitbang, struct _tcd_desc* tc,
+                      const struct _pio_pin_group* pin_group)
+{
+	bitbang->tc = tc;
+	bitbang->pin_group = pin_group;
+	bitbang->data = NULL;
+	bitbang->count = 0;
+	bitbang->size = 0;
+	bitbang->index = 0;
+	bitbang->busy = false;
+	callback_set(&bitbang->callback, NULL, NULL);
+}
+
+int pio_bitbang_start(struct _pio_bitbang* bitbang, uint32_t freq,
+                      const void* data, uint8_t size, uint32_t count,
+                      struct _callback* cb)
+{
+	struct _callback tick;
+	int rate, err;
+
+	if (size != 1 && size != 2 && size != 4)
+		return -EINVAL;
+	if (freq == 0 || count == 0 || !data)
+		return -EINVAL;
+	if (bitbang->busy)
+		return -EBUSY;
+
+	bitbang->data = data;
+	bitbang->size = size;
+	bitbang->count = count;
+	bitbang->index = 0;
+	callback_copy(&bitbang->callback, cb);
+
+	rate = tcd_configure_counter(bitbang->tc, freq, freq);
+
+	bitbang->busy = true;
+	callback_set(&tick, _pio_bitbang_tick, bitbang);
+	err = tcd_start(bitbang->tc, &tick);
+	if (err < 0) {
+		bitbang->busy = false;
+		return err;
+	}
+
+	return rate;
+}
+
+void pio_bitbang_stop(struct _pio_bitbang* bitbang)
+{
+	if (bitbang->busy)
+		_pio_bitbang_end(bitbang);
+}
+
+bool pio_bitbang_is_busy(const struct _pio_bitbang* bitbang)
+{
+	return bitbang->busy;
+}
+
+void pio_bitbang_wait(const struct _pio_bitbang* bitbang)
+{
+	while (bitbang->busy);
+}
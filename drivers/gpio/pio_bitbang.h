@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _PIO_BITBANG_H
+#define _PIO_BITBANG_H
+
+/**
+ * \file
+ *
+ * Timed bit-bang engine: outputs a sequence of values on a pin group at a
+ * fixed rate, paced by a timer counter. Each timer period, the interrupt
+ * handler writes the next value with pio_pin_group_write(). The completion
+ * callback is called from interrupt context once the last value has been
+ * output.
+ */
+
+/*------------------------------------------------------------------------------
+ *         Headers
+ *------------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "callback.h"
+#include "gpio/pio.h"
+#include "peripherals/tcd.h"
+
+/*------------------------------------------------------------------------------
+ *         Global Types
+ *------------------------------------------------------------------------------*/
+
+struct _pio_bitbang
+{
+	struct _tcd_desc* tc;                     /*< Timer pacing the output */
+	const struct _pio_pin_group* pin_group;   /*< Pins driven */
+
+	/* sequence being output */
+	const void* data;
+	uint32_t count;
+	uint8_t size;                             /*< Size of a value (1, 2 or 4 bytes) */
+	volatile uint32_t index;
+	volatile bool busy;
+	struct _callback callback;
+};
+
+/*------------------------------------------------------------------------------
+ *         Exported functions
+ *------------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a bit-bang engine.
+ *
+ * \param bitbang Bit-bang engine
+ * \param tc Timer descriptor (addr and channel set), reconfigured in counter
+ * mode by pio_bitbang_start()
+ * \param pin_group Compiled pin group
+ */
+extern void pio_bitbang_init(struct _pio_bitbang* bitbang, struct _tcd_desc* tc,
+                             const struct _pio_pin_group* pin_group);
+
+/**
+ * \brief Start outputting a sequence of values.
+ *
+ * \param bitbang Bit-bang engine
+ * \param freq Output rate (values per second)
+ * \param data Values, bit i driving pins[i] of the pin group
+ * \param size Size of one value in bytes (1, 2 or 4)
+ * \param count Number of values
+ * \param cb Completion callback (may be NULL)
+ * \return actual output rate, or -EINVAL / -EBUSY
+ */
+extern int pio_bitbang_start(struct _pio_bitbang* bitbang, uint32_t freq,
+                             const void* data, uint8_t size, uint32_t count,
+                             struct _callback* cb);
+
+/**
+ * \brief Stop the output.
+ */
+extern void pio_bitbang_stop(struct _pio_bitbang* bitbang);
+
+/**
+ * \brief Check if a sequence is being output.
+ */
+extern bool pio_bitbang_is_busy(const struct _pio_bitbang* bitbang);
+
+/**
+ * \brief Wait for the end of the sequence.
+ */
+extern void pio_bitbang_wait(const struct _pio_bitbang* bitbang);
+
+#endif /* _PIO_BITBANG_H */
@@ -0,0 +1,123 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Compilation of pin lists into pin groups (see pio_pin_group_compile()).
+ * Common to PIO3 and PIO4, the register accesses are done by the
+ * pio_pin_group_write() and pio_pin_group_read() functions of each driver.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <string.h>
+
+#include "gpio/pio.h"
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static struct _pio_pin_group_port* _pio_pin_group_get_port(struct _pio_pin_group* pin_group, uint8_t group)
+{
+	struct _pio_pin_group_port* port;
+	int i;
+
+	for (i = 0; i < pin_group->ports; i++) {
+		if (pin_group->port[i].group == group)
+			return &pin_group->port[i];
+	}
+
+	port = &pin_group->port[pin_group->ports++];
+	port->group = group;
+	return port;
+}
+
+static struct _pio_pin_group_run* _pio_pin_group_get_run(struct _pio_pin_group_port* port, int8_t shift)
+{
+	struct _pio_pin_group_run* run;
+	int i;
+
+	for (i = 0; i < port->runs; i++) {
+		if (port->run[i].shift == shift)
+			return &port->run[i];
+	}
+
+	if (port->runs >= PIO_PIN_GROUP_MAX_RUNS)
+		return NULL;
+
+	run = &port->run[port->runs++];
+	run->shift = shift;
+	return run;
+}
+
+/*----------------------------------------------------------------------------
+ *         Exported functions
+ *----------------------------------------------------------------------------*/
+
+int pio_pin_group_compile(struct _pio_pin_group* pin_group, const struct _pin *pins, uint32_t size)
+{
+	struct _pio_pin_group_port* port;
+	struct _pio_pin_group_run* run;
+	int i, bit;
+
+	memset(pin_group, 0, sizeof(*pin_group));
+
+	if (size == 0 || size > 32)
+		return -EINVAL;
+
+	for (i = 0; i < size; i++) {
+		const struct _pin* pin = &pins[i];
+
+		/* exactly one pin per value bit */
+		if (pin->group >= PIO_GROUP_LENGTH || pin->mask == 0 ||
+		    (pin->mask & (pin->mask - 1)) != 0)
+			return -EINVAL;
+
+		for (bit = 0; !(pin->mask & (1u << bit)); bit++);
+
+		port = _pio_pin_group_get_port(pin_group, pin->group);
+		if (port->mask & pin->mask)
+			return -EINVAL;
+		port->mask |= pin->mask;
+
+		run = _pio_pin_group_get_run(port, bit - i);
+		if (!run)
+			return -E2BIG;
+		run->mask |= 1u << i;
+	}
+
+	pin_group->width = size;
+
+	return 0;
+}
@@ -47,6 +47,7 @@
 #include "peripherals/flexcom.h"
 #endif
 #include "peripherals/pmc.h"
+#include "power/clkmgr.h"
 #include "timer.h"
 #include "trace.h"
 
@@ -81,6 +82,16 @@ static uint8_t adesc_index = 0;
  *        Local functions
  *----------------------------------------------------------------------------*/
 
+/**
+ * \brief End of transfer: drop the clock reference taken by _twid_transfer
+ * and release the descriptor
+ */
+static void _twid_release(struct _twi_desc* desc)
+{
+	clkmgr_put(get_twi_id_from_addr(desc->addr));
+	mutex_unlock(&desc->mutex);
+}
+
 /*
  *
  */
@@ -139,6 +150,7 @@ static bool _check_rx_timeout(struct _twi_desc* desc)
 static bool _check_tx_timeout(struct _twi_desc* desc)
 {
 	struct _timeout timeout;
+	uint32_t status;
 
 #ifdef CONFIG_HAVE_TWI_FIFO
 	if (desc->use_fifo)
@@ -146,7 +158,13 @@ static bool _check_tx_timeout(struct _twi_desc* desc)
 #endif
 
 	timer_start_timeout(&timeout, desc->timeout);
-	while (!twi_is_byte_sent(desc->addr)) {
+	for (;;) {
+		/* NACK is cleared on read, latch it for _twid_wait_twi_transfer */
+		status = twi_get_status(desc->addr);
+		if (status & TWI_SR_NACK)
+			desc->nack = true;
+		if (status & (TWI_SR_TXRDY | TWI_SR_NACK))
+			break;
 		if (timer_timeout_reached(&timeout)) {
 			trace_error("twid: Device doesn't answer (TX TIMEOUT)\r\n");
 			twid_configure(desc);
@@ -157,12 +175,23 @@ static bool _check_tx_timeout(struct _twi_desc* desc)
 	return false;
 }
 
+/*
+ * Wait for the end of the transfer. A NACK is reported silently as
+ * -ECONNABORTED: it is the expected answer of a busy device (e.g. an EEPROM
+ * in its write cycle being ACK polled).
+ */
 static int _twid_wait_twi_transfer(struct _twi_desc* desc)
 {
 	struct _timeout timeout;
+	uint32_t status;
 
 	timer_start_timeout(&timeout, desc->timeout);
-	while (!twi_is_transfer_complete(desc->addr)) {
+	for (;;) {
+		status = twi_get_status(desc->addr);
+		if (status & TWI_SR_NACK)
+			desc->nack = true;
+		if (status & TWI_SR_TXCOMP)
+			break;
 		if (timer_timeout_reached(&timeout)) {
 			trace_error("twid: Unable to complete transfer!\r\n");
 			twid_configure(desc);
@@ -170,6 +199,16 @@ static int _twid_wait_twi_transfer(struct _twi_desc* desc)
 		}
 	}
 
+	if (desc->nack) {
+#ifdef CONFIG_HAVE_TWI_FIFO
+		if (desc->use_fifo && twi_fifo_is_locked(desc->addr)) {
+			twi_fifo_unlock(desc->addr);
+			twi_fifo_flush_tx(desc->addr);
+		}
+#endif
+		return -ECONNABORTED;
+	}
+
 	return 0;
 }
 
@@ -182,7 +221,7 @@ static int _twid_dma_read_callback(void* arg, void* arg2)
 	dma_reset_channel(desc->dma.rx.channel);
 
 	if (_check_rx_timeout(desc)) {
-		mutex_unlock(&desc->mutex);
+		_twid_release(desc);
 		return -ETIMEDOUT;
 	}
 
@@ -196,14 +235,14 @@ static int _twid_dma_read_callback(void* arg, void* arg2)
 		((uint8_t*)desc->dma.rx.cfg.daddr)[desc->dma.rx.cfg.len] = twi_read_byte(desc->addr);
 
 		if (_check_rx_timeout(desc)) {
-			mutex_unlock(&desc->mutex);
+			_twid_release(desc);
 			return -ETIMEDOUT;
 		}
 
 		((uint8_t*)desc->dma.rx.cfg.daddr)[desc->dma.rx.cfg.len + 1] = twi_read_byte(desc->addr);
 	}
 
-	mutex_unlock(&desc->mutex);
+	_twid_release(desc);
 
 	callback_call(&desc->callback, NULL);
 
@@ -254,7 +293,7 @@ static int _twid_dma_write_callback(void* arg, void* arg2)
 	dma_reset_channel(desc->dma.tx.channel);
 
 	if (_check_tx_timeout(desc)) {
-		mutex_unlock(&desc->mutex);
+		_twid_release(desc);
 		return -ETIMEDOUT;
 	}
 
@@ -266,7 +305,7 @@ static int _twid_dma_write_callback(void* arg, void* arg2)
 		twi_write_byte(desc->addr, ((uint8_t *)desc->dma.tx.cfg.saddr)[desc->dma.tx.cfg.len]);
 #endif
 
-	mutex_unlock(&desc->mutex);
+	_twid_release(desc);
 
 	callback_call(&desc->callback, NULL);
 
@@ -361,7 +400,7 @@ static void _twid_handler(uint32_t source, void* user_arg)
 				twi_enable_it(addr, TWI_IER_TXCOMP);
 			} else {
 				adesc->twi_id = 0;
-				mutex_unlock(&adesc->twi_desc->mutex);
+				_twid_release(adesc->twi_desc);
 			}
 		}
 	} else if (TWI_STATUS_TXRDY(status)) {
@@ -404,7 +443,7 @@ static void _twid_handler(uint32_t source, void* user_arg)
 				twi_enable_it(addr, TWI_IER_TXCOMP);
 			} else {
 				adesc->twi_id = 0;
-				mutex_unlock(&adesc->twi_desc->mutex);
+				_twid_release(adesc->twi_desc);
 			}
 		}
 	}
@@ -413,7 +452,7 @@ static void _twid_handler(uint32_t source, void* user_arg)
 		irq_disable(adesc->twi_id);
 		twi_disable_it(addr, TWI_IDR_TXCOMP);
 		adesc->twi_id = 0;
-		mutex_unlock(&adesc->twi_desc->mutex);
+		_twid_release(adesc->twi_desc);
 		callback_call(&adesc->twi_desc->callback, NULL);
 	}
 }
@@ -648,10 +687,12 @@ static int _twid_transfer(struct _twi_desc* desc, struct _buffer* buf,  struct _
 
 	if (!mutex_try_lock(&desc->mutex))
 		return -EBUSY;
+	clkmgr_get(get_twi_id_from_addr(desc->addr));
 
 	callback_copy(&desc->callback, cb);
 	desc->flags = buf->attr;
 	tmode = desc->transfer_mode;
+	desc->nack = false;
 
 	/* If short transfer detected, use POLLING mode */
 	if (tmode != BUS_TRANSFER_MODE_POLLING) {
@@ -696,6 +737,7 @@ static int _twid_transfer(struct _twi_desc* desc, struct _buffer* buf,  struct _
 			if (_check_tx_timeout(desc)) {
 				twi_disable_it(desc->addr, TWI_IER_TXRDY);
 				irq_disable(id);
+				_twid_release(desc);
 				return -ETIMEDOUT;
 			}
 
@@ -732,7 +774,7 @@ static int _twid_transfer(struct _twi_desc* desc, struct _buffer* buf,  struct _
 
 		if (err == 0)
 			callback_call(&desc->callback, NULL);
-		mutex_unlock(&desc->mutex);
+		_twid_release(desc);
 		break;
 
 	case BUS_TRANSFER_MODE_DMA:
@@ -744,12 +786,44 @@ static int _twid_transfer(struct _twi_desc* desc, struct _buffer* buf,  struct _
 
 	default:
 		trace_error("Unknown TWI transfer mode");
+		_twid_release(desc);
 		err = -ENOTSUP;
 	}
 
 	return err;
 }
 
+#ifdef CONFIG_HAVE_DVFS
+
+/**
+ * \brief DVFS notifier: refuse clock changes during a transfer, recompute
+ * the TWI clock dividers afterwards.
+ */
+static int _twid_dvfs_notifier(enum _dvfs_event event,
+		const struct _dvfs_transition* transition, void* arg)
+{
+	struct _twi_desc* desc = (struct _twi_desc*)arg;
+	uint32_t id;
+
+	switch (event) {
+	case DVFS_PRE_CHANGE:
+		if (twid_is_busy(desc))
+			return -EBUSY;
+		break;
+	case DVFS_POST_CHANGE:
+		id = get_twi_id_from_addr(desc->addr);
+		clkmgr_get(id);
+		twi_configure_master(desc->addr, desc->freq);
+		clkmgr_put(id);
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+#endif /* CONFIG_HAVE_DVFS */
+
 /*----------------------------------------------------------------------------
  *        External functions
  *----------------------------------------------------------------------------*/
@@ -794,6 +868,12 @@ int twid_configure(struct _twi_desc* desc)
 
 	desc->mutex = 0;
 
+#ifdef CONFIG_HAVE_DVFS
+	desc->dvfs.fn = _twid_dvfs_notifier;
+	desc->dvfs.arg = desc;
+	dvfs_register_notifier(&desc->dvfs);
+#endif
+
 	return 0;
 }
 
@@ -39,6 +39,9 @@
 #include "i2c/twi.h"
 #include "io.h"
 #include "mutex.h"
+#ifdef CONFIG_HAVE_DVFS
+#include "power/dvfs.h"
+#endif
 
 /*------------------------------------------------------------------------------
  *        Types
@@ -54,6 +57,10 @@ struct _twi_desc
 	uint32_t timeout; /**< timeout (if 0, a default timeout is used) */
 	mutex_t mutex;
 	struct _callback callback;
+#ifdef CONFIG_HAVE_DVFS
+	struct _dvfs_notifier dvfs; /**< clock change notifier */
+#endif
+	bool nack; /**< NACK latched during a polled transfer */
 
 #ifdef CONFIG_HAVE_TWI_FIFO
 	bool use_fifo;
@@ -37,6 +37,7 @@
 #include "ring.h"
 
 #include "irq/irq.h"
+#include "irqflags.h"
 #include "network/emacd.h"
 #include "mm/cache.h"
 #include "peripherals/pmc.h"
@@ -309,6 +310,14 @@ static void _emacd_handler(struct _ethd * emacd)
 			rsr = emac_get_rx_status(emac);
 			emac_clear_rx_status(emac, rsr);
 
+			/* Hybrid mode: mask RX interrupts until the queue is
+			 * drained by ethd_napi_poll(), which skips the queues
+			 * without RX budget */
+			if (emacd->napi && q->rx_budget) {
+				emac_disable_it(emac, EMAC_INT_RX_BITS);
+				q->rx_napi_pending = 1;
+			}
+
 			/* Invoke callback */
 			if (q->rx_callback)
 				q->rx_callback(0, rsr);
@@ -320,8 +329,9 @@ static void _emacd_handler(struct _ethd * emacd)
 			break;
 		}
 
-		/* TX packet */
-		if (isr & EMAC_IER_TCOMP) {
+		/* TX packet, reclaimed by ethd_napi_poll() for the queues
+		 * it polls in hybrid mode */
+		if ((isr & EMAC_IER_TCOMP) && !(emacd->napi && q->rx_budget)) {
 			_emacd_tx_complete_handler(emacd);
 		}
 
@@ -338,6 +348,34 @@ static void _emacd_emac_irq_handler(uint32_t source, void* user_arg)
 	_emacd_handler(handler->emacd);
 }
 
+static void _emacd_set_rx_it(struct _ethd* emacd, uint8_t queue, bool enable)
+{
+	if (enable)
+		emac_enable_it(emacd->emac, EMAC_INT_RX_BITS);
+	else
+		emac_disable_it(emacd->emac, EMAC_INT_RX_BITS);
+}
+
+static void _emacd_set_tx_complete_it(struct _ethd* emacd, uint8_t queue, bool enable)
+{
+	if (enable)
+		emac_enable_it(emacd->emac, EMAC_IER_TCOMP);
+	else
+		emac_disable_it(emacd->emac, EMAC_IDR_TCOMP);
+}
+
+static void _emacd_tx_reclaim(struct _ethd* emacd, uint8_t queue)
+{
+	uint32_t flags;
+
+	/* Keep the TX error handler from resetting the queue meanwhile. The
+	 * caller may be the interrupt handler itself, restore the previous
+	 * interrupt state rather than unmasking */
+	flags = arch_irq_save();
+	_emacd_tx_complete_handler(emacd);
+	arch_irq_restore(flags);
+}
+
 /*---------------------------------------------------------------------------
  *         Exported functions
  *---------------------------------------------------------------------------*/
@@ -387,6 +425,8 @@ void emacd_configure(struct _ethd * emacd,
 			DUMMY_BUFFERS, dummy_buffer, dummy_rx_desc,
 			DUMMY_BUFFERS, dummy_buffer, dummy_tx_desc,
 			NULL);
+	/* do not poll the queue until it is given real buffers */
+	emacd->queues[0].rx_budget = 0;
 }
 
 
@@ -432,6 +472,7 @@ uint8_t emacd_setup_queue(struct _ethd* emacd, uint8_t queue,
 	q->rx_desc = (struct _eth_desc *)((uint32_t)rx_desc & 0xFFFFFFF8);
 	q->rx_size = rx_size;
 	q->rx_callback = NULL;
+	q->rx_budget = ETH_RX_DEFAULT_BUDGET;
 
 	/* Assign TX buffers */
 	if (((uint32_t)tx_buffer & 0x7)
@@ -512,4 +553,7 @@ const struct _ethd_op _emac_op = {
 	.poll = (_ethd_poll)ethd_poll,
 	.set_rx_callback = (_ethd_set_rx_callback)emacd_set_rx_callback,
 	.set_tx_wakeup_callback = (_ethd_set_tx_wakeup_callback)ethd_set_tx_wakeup_callback,
+	.set_rx_it = (_ethd_set_rx_it)_emacd_set_rx_it,
+	.set_tx_complete_it = (_ethd_set_tx_complete_it)_emacd_set_tx_complete_it,
+	.tx_reclaim = (_ethd_tx_reclaim)_emacd_tx_reclaim,
 };
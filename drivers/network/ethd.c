@@ -58,6 +58,52 @@
  *        Local functions
  *----------------------------------------------------------------------------*/
 
+static void _ethd_count_rx_csum(struct _ethd* ethd, uint32_t csum_status)
+{
+	switch (csum_status) {
+	case ETH_RX_STATUS_CSUM_IP_TCP:
+	case ETH_RX_STATUS_CSUM_IP_UDP:
+		ethd->csum_stats.rx_offloaded++;
+		break;
+	case ETH_RX_STATUS_CSUM_IP:
+		ethd->csum_stats.rx_ip_only++;
+		break;
+	default:
+		ethd->csum_stats.rx_software++;
+		break;
+	}
+}
+
+/**
+ * Unmask RX interrupts of a drained queue, unless a frame has been received
+ * in the meantime.
+ */
+static void _ethd_napi_complete(struct _ethd* ethd, uint8_t queue)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+
+	q->rx_napi_pending = 0;
+	ethd->op->set_rx_it(ethd, queue, true);
+
+	/* A frame received before RX interrupts were unmasked would not
+	 * trigger an interrupt, keep the queue scheduled */
+	if (q->rx_desc[q->rx_head].addr & ETH_RX_ADDR_OWN) {
+		ethd->op->set_rx_it(ethd, queue, false);
+		q->rx_napi_pending = 1;
+	}
+}
+
+static void _ethd_napi_account(struct _ethd* ethd, uint16_t count)
+{
+	int bucket = 0;
+
+	while (count && bucket < ETH_NAPI_HIST_SIZE - 1) {
+		count >>= 1;
+		bucket++;
+	}
+	ethd->napi_hist[bucket]++;
+}
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -74,8 +120,19 @@ void ethd_get_mac_addr(struct _ethd * ethd, uint8_t sa_idx, uint8_t* mac)
 
 bool ethd_configure(struct _ethd * ethd, enum _eth_type eth_type, void * addr, uint8_t enable_caf, uint8_t enable_nbc)
 {
+	int i;
+
 	ethd->addr = addr;
 	ethd->op = NULL;
+	ethd->csum_offload = 0;
+	memset(&ethd->csum_stats, 0, sizeof(ethd->csum_stats));
+	for (i = 0; i < ETH_QUEUE_COUNT; i++) {
+		ethd->queues[i].rx_budget = 0;
+		ethd->queues[i].rx_napi_pending = 0;
+	}
+	ethd->napi = false;
+	memset(ethd->napi_hist, 0, sizeof(ethd->napi_hist));
+	memset(&ethd->ptp, 0, sizeof(ethd->ptp));
 
 #ifdef CONFIG_HAVE_EMAC
 	if (ETH_TYPE_EMAC == eth_type)
@@ -159,9 +216,11 @@ uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_lis
 
 		desc = &q->tx_desc[idx];
 
-		/* Copy data into transmittion buffer */
+		/* Copy data into transmittion buffer, unless the frame has
+		 * been built in place (see ethd_get_tx_buffer()) */
 		if (sg->buffer && sg->size) {
-			memcpy((void*)desc->addr, sg->buffer, sg->size);
+			if (sg->buffer != (void*)desc->addr)
+				memcpy((void*)desc->addr, sg->buffer, sg->size);
 			cache_clean_region((void*)desc->addr, sg->size);
 		}
 
@@ -184,6 +243,11 @@ uint8_t ethd_send_sg(struct _ethd* ethd, uint8_t queue, const struct _eth_sg_lis
 	/* Update TX ring buffer pointers */
 	q->tx_head = tx_head;
 
+	if (ethd->csum_offload & ETH_CSUM_TX)
+		ethd->csum_stats.tx_offloaded++;
+	else
+		ethd->csum_stats.tx_software++;
+
 	/* Now start to transmit if it is not already done */
 	ethd->op->start_transmission(eth);
 
@@ -209,6 +273,15 @@ uint8_t ethd_send(struct _ethd* ethd, uint8_t queue, void *buffer, uint32_t size
 	return ethd_send_sg(ethd, queue, &sgl, callback);
 }
 
+void* ethd_get_tx_buffer(struct _ethd* ethd, uint8_t queue)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+
+	if (!q->tx_desc || RING_SPACE(q->tx_head, q->tx_tail, q->tx_size) < 1)
+		return NULL;
+	return (void*)q->tx_desc[q->tx_head].addr;
+}
+
 /**
  * Return current load of TX.
  * \param ethd   Pointer to ETH Driver instance.
@@ -220,6 +293,13 @@ uint32_t ethd_get_tx_load(struct _ethd* ethd, uint8_t queue)
 }
 
 uint8_t ethd_poll(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t buffer_size, uint32_t* recv_size)
+{
+	uint32_t csum_status;
+
+	return ethd_poll_csum(ethd, queue, buffer, buffer_size, recv_size, &csum_status);
+}
+
+uint8_t ethd_poll_csum(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t buffer_size, uint32_t* recv_size, uint32_t* csum_status)
 {
 	struct _ethd_queue* q = &ethd->queues[queue];
 	struct _eth_desc *desc;
@@ -232,6 +312,7 @@ uint8_t ethd_poll(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t b
 
 	/* Set the default return value */
 	*recv_size = 0;
+	*csum_status = ETH_RX_STATUS_CSUM_NONE;
 
 	/* Process RX descriptors */
 	idx = q->rx_head;
@@ -288,6 +369,12 @@ uint8_t ethd_poll(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t b
 					return ETH_SIZE_TOO_SMALL;
 				}
 
+				/* Checksum status is only reported on the
+				 * last buffer of the frame */
+				if (ethd->csum_offload & ETH_CSUM_RX)
+					*csum_status = desc->status & ETH_RX_STATUS_CSUM_MASK;
+				_ethd_count_rx_csum(ethd, *csum_status);
+
 				/* All data have been copied in the application
 				 * frame buffer => release descriptors */
 				while (q->rx_head != idx) {
@@ -333,3 +420,124 @@ uint8_t ethd_set_tx_wakeup_callback(struct _ethd* ethd, uint8_t queue, ethd_wake
 
 	return ETH_OK;
 }
+
+void ethd_set_rx_budget(struct _ethd* ethd, uint8_t queue, uint16_t budget)
+{
+	ethd->queues[queue].rx_budget = budget;
+}
+
+uint16_t ethd_get_rx_budget(struct _ethd* ethd, uint8_t queue)
+{
+	return ethd->queues[queue].rx_budget;
+}
+
+uint8_t ethd_get_csum_offload(struct _ethd* ethd)
+{
+	return ethd->csum_offload;
+}
+
+void ethd_get_csum_stats(struct _ethd* ethd, struct _ethd_csum_stats* stats)
+{
+	memcpy(stats, &ethd->csum_stats, sizeof(*stats));
+}
+
+void ethd_clear_csum_stats(struct _ethd* ethd)
+{
+	memset(&ethd->csum_stats, 0, sizeof(ethd->csum_stats));
+}
+
+void ethd_set_napi(struct _ethd* ethd, bool enable)
+{
+	struct _ethd_queue* q;
+	int i;
+
+	for (i = 0; i < ETH_QUEUE_COUNT; i++) {
+		q = &ethd->queues[i];
+		if (!q->rx_budget)
+			continue;
+
+		if (enable) {
+			/* Start scheduled: the first poll drains the queue
+			 * and unmasks RX interrupts */
+			ethd->op->set_rx_it(ethd, i, false);
+			ethd->op->set_tx_complete_it(ethd, i, false);
+			q->rx_napi_pending = 1;
+		} else {
+			q->rx_napi_pending = 0;
+			ethd->op->tx_reclaim(ethd, i);
+			ethd->op->set_tx_complete_it(ethd, i, true);
+			ethd->op->set_rx_it(ethd, i, true);
+		}
+	}
+	ethd->napi = enable;
+}
+
+uint16_t ethd_napi_poll(struct _ethd* ethd, uint16_t budget,
+		uint8_t* buffer, uint32_t buffer_size,
+		ethd_rx_handler_t handler, void* arg)
+{
+	struct _ethd_queue* q;
+	uint32_t size, csum_status;
+	uint16_t count = 0, limit;
+	uint8_t rc;
+	int i;
+
+	for (i = ETH_QUEUE_COUNT - 1; i >= 0; i--) {
+		q = &ethd->queues[i];
+		if (!q->rx_budget)
+			continue;
+
+		/* Batched reclaim of sent frames */
+		ethd->op->tx_reclaim(ethd, i);
+
+		if (!q->rx_napi_pending)
+			continue;
+
+		/* At most rx_budget frames per queue, within the poll budget */
+		limit = budget - count;
+		if (limit > q->rx_budget)
+			limit = q->rx_budget;
+		limit += count;
+
+		rc = ETH_OK;
+		while (count < limit) {
+			rc = ethd_poll_csum(ethd, i, buffer, buffer_size,
+					&size, &csum_status);
+			if (rc != ETH_OK)
+				break;
+			count++;
+			handler(arg, i, buffer, size, csum_status);
+		}
+
+		if (rc == ETH_RX_NULL)
+			_ethd_napi_complete(ethd, i);
+	}
+
+	_ethd_napi_account(ethd, count);
+	return count;
+}
+
+void ethd_tx_reclaim(struct _ethd* ethd, uint8_t queue)
+{
+	ethd->op->tx_reclaim(ethd, queue);
+}
+
+bool ethd_napi_pending(struct _ethd* ethd)
+{
+	int i;
+
+	for (i = 0; i < ETH_QUEUE_COUNT; i++)
+		if (ethd->queues[i].rx_napi_pending)
+			return true;
+	return false;
+}
+
+void ethd_get_napi_histogram(struct _ethd* ethd, uint32_t* hist)
+{
+	memcpy(hist, ethd->napi_hist, sizeof(ethd->napi_hist));
+}
+
+void ethd_clear_napi_histogram(struct _ethd* ethd)
+{
+	memset(ethd->napi_hist, 0, sizeof(ethd->napi_hist));
+}
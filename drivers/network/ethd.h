@@ -89,11 +89,23 @@ enum _eth_speed {
 #define ETH_RX_STATUS_SOF         (1u << 14)
 #define ETH_RX_STATUS_EOF         (1u << 15)
 
+/* Checksum status contained in struct _eth_desc status for RX when checksum
+ * offload is enabled (valid on the EOF buffer only) */
+#define ETH_RX_STATUS_CSUM_MASK   (3u << 22)
+#define ETH_RX_STATUS_CSUM_NONE   (0u << 22) /**< checksums not checked */
+#define ETH_RX_STATUS_CSUM_IP     (1u << 22) /**< IP header checksum OK */
+#define ETH_RX_STATUS_CSUM_IP_TCP (2u << 22) /**< IP and TCP checksums OK */
+#define ETH_RX_STATUS_CSUM_IP_UDP (3u << 22) /**< IP and UDP checksums OK */
+
 /* Bits contained in struct _eth_desc status when used for TX */
 #define ETH_TX_STATUS_LASTBUF (1u << 15)
 #define ETH_TX_STATUS_WRAP    (1u << 30)
 #define ETH_TX_STATUS_USED    (1u << 31)
 
+/* Checksum offload capabilities */
+#define ETH_CSUM_RX (1u << 0) /**< RX IP/TCP/UDP checksum verification */
+#define ETH_CSUM_TX (1u << 1) /**< TX IP/TCP/UDP checksum generation */
+
 /**@}*/
 
 /** \addtogroup eth_buf_size ETH(EMACD/GMACD) Default Buffer Size
@@ -101,6 +113,12 @@ enum _eth_speed {
 #define ETH_RX_UNITSIZE            128  /**< RX buffer size, must be 128 */
 #define ETH_TX_UNITSIZE            1536 /**< TX buffer size, must be multiple
 					   of 32 (cache line) */
+/** Default number of frames processed per poll on a queue */
+#define ETH_RX_DEFAULT_BUDGET      1
+
+/** Number of buckets of the packets-per-poll histogram: bucket 0 counts
+ * empty polls, bucket n counts polls of 2^(n-1) to 2^n - 1 frames */
+#define ETH_NAPI_HIST_SIZE         8
 /**     @}*/
 
 /** \addtogroup eth_rc ETH(EMACD/GMACD) Return Codes
@@ -148,6 +166,30 @@ struct _eth_sg_list {
 	struct _eth_sg *entries;
 };
 
+/** Checksum offload counters */
+struct _ethd_csum_stats {
+	uint32_t rx_offloaded; /**< RX frames with IP and TCP/UDP checksums checked by hardware */
+	uint32_t rx_ip_only;   /**< RX frames with only IP header checksum checked by hardware */
+	uint32_t rx_software;  /**< RX frames to be checked by software */
+	uint32_t tx_offloaded; /**< TX frames with checksums generated by hardware */
+	uint32_t tx_software;  /**< TX frames with checksums generated by software */
+};
+
+/** IEEE 1588 timestamp */
+struct _eth_timestamp {
+	uint64_t sec;  /**< seconds (only the 48 or 32 LSBs are used by hardware) */
+	uint32_t nsec; /**< nanoseconds */
+};
+
+/** IEEE 1588 timestamp unit state */
+struct _ethd_ptp {
+	uint32_t              incr;     /**< nominal timer increment (ns, 16.16 fixed point) */
+	volatile uint32_t     rx_count; /**< number of captured RX event timestamps */
+	volatile uint32_t     tx_count; /**< number of captured TX event timestamps */
+	struct _eth_timestamp rx_ts;    /**< last RX event (Sync) timestamp */
+	struct _eth_timestamp tx_ts;    /**< last TX event (Delay_Req) timestamp */
+};
+
 /** @}*/
 
 /** \addtogroup ethd_types
@@ -159,6 +201,10 @@ typedef void (*ethd_callback_t)(uint8_t queue, uint32_t status);
 /** TX Wakeup callback */
 typedef void (*ethd_wakeup_cb_t)(uint8_t queue);
 
+/** Frame handler for ethd_napi_poll() */
+typedef void (*ethd_rx_handler_t)(void* arg, uint8_t queue, uint8_t* frame,
+		uint32_t size, uint32_t csum_status);
+
 typedef void (*_ethd_configure)(void* ethd, void *pHw, uint8_t enable_caf, uint8_t enable_nbc);
 
 typedef uint8_t (*_ethd_setup_queue)(void* ethd, uint8_t queue,
@@ -188,6 +234,12 @@ typedef void (*_ethd_set_rx_callback)(void *ethd, uint8_t queue, ethd_callback_t
 
 typedef uint8_t (*_ethd_set_tx_wakeup_callback)(void *ethd, uint8_t queue, ethd_wakeup_cb_t wakeup_callback, uint16_t threshold);
 
+typedef void (*_ethd_set_rx_it)(void *ethd, uint8_t queue, bool enable);
+
+typedef void (*_ethd_set_tx_complete_it)(void *ethd, uint8_t queue, bool enable);
+
+typedef void (*_ethd_tx_reclaim)(void *ethd, uint8_t queue);
+
 /** @}*/
 
 /** \addtogroup ethd_structs
@@ -206,6 +258,9 @@ struct _ethd_op {
 	_ethd_poll poll;
 	_ethd_set_rx_callback set_rx_callback;
 	_ethd_set_tx_wakeup_callback set_tx_wakeup_callback;
+	_ethd_set_rx_it set_rx_it;
+	_ethd_set_tx_complete_it set_tx_complete_it;
+	_ethd_tx_reclaim tx_reclaim;
 };
 
 struct _ethd_queue {
@@ -213,6 +268,8 @@ struct _ethd_queue {
 	struct _eth_desc *rx_desc;
 	uint16_t          rx_size;
 	uint16_t          rx_head;
+	uint16_t          rx_budget;
+	volatile uint8_t  rx_napi_pending; /**< RX interrupts masked, waiting for poll */
 	ethd_callback_t   rx_callback;
 
 	uint8_t          *tx_buffer;
@@ -241,6 +298,11 @@ struct _ethd {
 	};
 	struct _ethd_queue queues[ETH_QUEUE_COUNT];
 	const struct _ethd_op *op;
+	uint8_t csum_offload;              /**< ETH_CSUM_* capabilities enabled */
+	struct _ethd_csum_stats csum_stats;
+	bool napi;                         /**< hybrid interrupt/polling RX mode */
+	uint32_t napi_hist[ETH_NAPI_HIST_SIZE]; /**< packets per poll histogram */
+	struct _ethd_ptp ptp;              /**< timestamp unit state (GMAC only) */
 };
 
 /** @}*/
@@ -289,6 +351,16 @@ extern void ethd_start(struct _ethd* ethd);
  */
 extern uint8_t ethd_send(struct _ethd* ethd, uint8_t queue, void *buffer, uint32_t size, ethd_callback_t callback);
 
+/**
+ * \brief Get the buffer of the next free TX descriptor, to build a frame in
+ * place. Passing this buffer to ethd_send() before any other frame is sent
+ * on the queue avoids copying the frame.
+ * \param ethd   Pointer to ETH Driver instance.
+ * \param queue  TX queue.
+ * \return Buffer of ETH_TX_UNITSIZE bytes, NULL if the TX queue is full.
+ */
+extern void* ethd_get_tx_buffer(struct _ethd* ethd, uint8_t queue);
+
 extern uint32_t ethd_get_tx_load(struct _ethd* ethd, uint8_t queue);
 
 /**
@@ -303,8 +375,41 @@ extern uint32_t ethd_get_tx_load(struct _ethd* ethd, uint8_t queue);
  */
 extern uint8_t ethd_poll(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t buffer_size, uint32_t* recv_size);
 
+/**
+ * \brief Receive a packet with ETH and return its checksum offload status.
+ * Same as ethd_poll(), but also reports which checksums of the frame have
+ * already been verified by hardware.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param buffer           Buffer to store the frame
+ *  \param buffer_size      Size of the frame
+ *  \param recv_size        Received size
+ *  \param csum_status      Checksum status (ETH_RX_STATUS_CSUM_*)
+ *  \return                 OK, no data, or frame too small
+ */
+extern uint8_t ethd_poll_csum(struct _ethd* ethd, uint8_t queue, uint8_t* buffer, uint32_t buffer_size, uint32_t* recv_size, uint32_t* csum_status);
+
 extern void ethd_set_rx_callback(struct _ethd *ethd, uint8_t queue, ethd_callback_t callback);
 
+/**
+ * \brief Get the checksum offload capabilities enabled on the interface.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \return ETH_CSUM_* flags
+ */
+extern uint8_t ethd_get_csum_offload(struct _ethd* ethd);
+
+/**
+ * \brief Get the checksum offload counters.
+ *  \param ethd Pointer to ETH Driver instance.
+ *  \param stats Pointer to the structure to fill
+ */
+extern void ethd_get_csum_stats(struct _ethd* ethd, struct _ethd_csum_stats* stats);
+
+/**
+ * \brief Reset the checksum offload counters.
+ *  \param ethd Pointer to ETH Driver instance.
+ */
+extern void ethd_clear_csum_stats(struct _ethd* ethd);
+
 /**
  * Register/Clear TX wakeup callback.
  *
@@ -325,6 +430,79 @@ extern void ethd_set_rx_callback(struct _ethd *ethd, uint8_t queue, ethd_callbac
  */
 extern uint8_t ethd_set_tx_wakeup_callback(struct _ethd* ethd, uint8_t queue, ethd_wakeup_cb_t callback, uint16_t threshold);
 
+/**
+ * Set the maximum number of frames an upper layer should process on the
+ * queue per poll. A budget of 0 means the queue is not polled.
+ *
+ * \param ethd   Pointer to ETH Driver instance.
+ * \param budget Number of frames per poll.
+ */
+extern void ethd_set_rx_budget(struct _ethd* ethd, uint8_t queue, uint16_t budget);
+
+extern uint16_t ethd_get_rx_budget(struct _ethd* ethd, uint8_t queue);
+
+/**
+ * Enable/Disable the hybrid interrupt/polling mode.
+ *
+ * When enabled, the first RX interrupt of a queue masks the RX interrupts of
+ * that queue and invokes its RX callback, which should schedule a call to
+ * ethd_napi_poll(). RX interrupts are unmasked once ethd_napi_poll() has
+ * drained the queue. TX completion interrupts are disabled and sent frames
+ * are reclaimed in batches by ethd_napi_poll(), which must therefore be
+ * called regularly when sending.
+ *
+ * \param ethd   Pointer to ETH Driver instance.
+ * \param enable Enable (true) or disable (false) the hybrid mode.
+ */
+extern void ethd_set_napi(struct _ethd* ethd, bool enable);
+
+/**
+ * Process received frames on the queues waiting for a poll, highest priority
+ * queue first, and reclaim sent frames. At most the RX budget of a queue is
+ * processed on that queue, see ethd_set_rx_budget().
+ *
+ * \param ethd        Pointer to ETH Driver instance.
+ * \param budget      Maximum number of frames to process.
+ * \param buffer      Buffer to store each frame, ETH_MAX_FRAME_LENGTH bytes
+ *                    at least.
+ * \param buffer_size Size of the buffer.
+ * \param handler     Handler invoked for each received frame.
+ * \param arg         Argument passed to the handler.
+ * \return Number of frames processed. Frames are left pending when the
+ *         budget or the budget of a queue is exhausted, ethd_napi_pending()
+ *         then tells that ethd_napi_poll() should be called again.
+ */
+extern uint16_t ethd_napi_poll(struct _ethd* ethd, uint16_t budget,
+		uint8_t* buffer, uint32_t buffer_size,
+		ethd_rx_handler_t handler, void* arg);
+
+/**
+ * Reclaim the frames sent on a queue and invoke their TX callbacks.
+ *
+ * In hybrid mode, sent frames are otherwise only reclaimed by
+ * ethd_napi_poll(). This lets a sender free TX descriptors without polling
+ * RX, e.g. from a frame handler invoked by ethd_napi_poll().
+ *
+ * \param ethd   Pointer to ETH Driver instance.
+ * \param queue  TX queue.
+ */
+extern void ethd_tx_reclaim(struct _ethd* ethd, uint8_t queue);
+
+/**
+ * \brief Check if a queue is waiting for ethd_napi_poll().
+ */
+extern bool ethd_napi_pending(struct _ethd* ethd);
+
+/**
+ * \brief Get the packets-per-poll histogram (ETH_NAPI_HIST_SIZE buckets).
+ */
+extern void ethd_get_napi_histogram(struct _ethd* ethd, uint32_t* hist);
+
+/**
+ * \brief Reset the packets-per-poll histogram.
+ */
+extern void ethd_clear_napi_histogram(struct _ethd* ethd);
+
 /** @}*/
 
 #ifdef __cplusplus
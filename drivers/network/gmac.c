@@ -356,6 +356,188 @@ void gmac_transmit_enable(Gmac* gmac, bool enable)
 		gmac->GMAC_NCR &= ~GMAC_NCR_TXEN;
 }
 
+void gmac_enable_rx_csum_offload(Gmac* gmac, bool enable)
+{
+	if (enable)
+		gmac->GMAC_NCFGR |= GMAC_NCFGR_RXCOEN;
+	else
+		gmac->GMAC_NCFGR &= ~GMAC_NCFGR_RXCOEN;
+}
+
+bool gmac_enable_tx_csum_offload(Gmac* gmac, bool enable)
+{
+#ifdef GMAC_DCFGR_TXCOEN
+	/* Checksum generation requires the whole frame to be stored in the
+	 * TX packet buffer, so use the full TX packet buffer memory */
+	if (enable)
+		gmac->GMAC_DCFGR |= GMAC_DCFGR_TXPBMS | GMAC_DCFGR_TXCOEN;
+	else
+		gmac->GMAC_DCFGR &= ~GMAC_DCFGR_TXCOEN;
+	return true;
+#else
+	/* No TX checksum generator on this GMAC */
+	return false;
+#endif
+}
+
+void gmac_set_tsu_increment(Gmac* gmac, uint32_t incr)
+{
+	uint32_t ns = incr >> 16;
+	uint32_t subns = incr & 0xffff;
+
+#ifdef GMAC_TISUBN_LSBTIR_Msk
+	gmac->GMAC_TISUBN = GMAC_TISUBN_LSBTIR(subns);
+	gmac->GMAC_TI = GMAC_TI_CNS(ns);
+#else
+	/* Use the alternative increment ns + 1 once every nit cycles (after
+	 * NIT = nit - 1 regular increments), giving an average increment of
+	 * ns + 1 / nit */
+	uint32_t nit = subns ? (0x10000 + subns / 2) / subns : 0;
+	if (nit == 1)
+		gmac->GMAC_TI = GMAC_TI_CNS(ns + 1);
+	else if (nit == 0 || nit > 256)
+		gmac->GMAC_TI = GMAC_TI_CNS(ns);
+	else
+		gmac->GMAC_TI = GMAC_TI_CNS(ns) | GMAC_TI_ACNS(ns + 1) |
+			GMAC_TI_NIT(nit - 1);
+#endif
+}
+
+void gmac_get_tsu_timer(Gmac* gmac, struct _eth_timestamp* ts)
+{
+	uint32_t ns, sec_low, sec_high = 0;
+
+	/* Read again if the nanoseconds wrapped while reading the seconds */
+	do {
+		ns = gmac->GMAC_TN & GMAC_TN_TNS_Msk;
+		sec_low = gmac->GMAC_TSL;
+#ifdef GMAC_TSH_TCS_Msk
+		sec_high = gmac->GMAC_TSH & GMAC_TSH_TCS_Msk;
+#endif
+	} while ((gmac->GMAC_TN & GMAC_TN_TNS_Msk) < ns);
+
+	ts->sec = ((uint64_t)sec_high << 32) | sec_low;
+	ts->nsec = ns;
+}
+
+void gmac_set_tsu_timer(Gmac* gmac, const struct _eth_timestamp* ts)
+{
+#ifdef GMAC_TSH_TCS_Msk
+	gmac->GMAC_TSH = GMAC_TSH_TCS((uint32_t)(ts->sec >> 32));
+#endif
+	gmac->GMAC_TSL = GMAC_TSL_TCS((uint32_t)ts->sec);
+	gmac->GMAC_TN = GMAC_TN_TNS(ts->nsec);
+}
+
+void gmac_adjust_tsu_timer(Gmac* gmac, int32_t delta_ns)
+{
+	if (delta_ns < 0)
+		gmac->GMAC_TA = GMAC_TA_ADJ | GMAC_TA_ITDT(-delta_ns);
+	else
+		gmac->GMAC_TA = GMAC_TA_ITDT(delta_ns);
+}
+
+void gmac_get_rx_event_timestamp(Gmac* gmac, struct _eth_timestamp* ts)
+{
+	uint32_t sec_high = 0;
+
+#ifdef GMAC_EFRSH_RUD_Msk
+	sec_high = gmac->GMAC_EFRSH & GMAC_EFRSH_RUD_Msk;
+#endif
+	ts->sec = ((uint64_t)sec_high << 32) | gmac->GMAC_EFRSL;
+	ts->nsec = gmac->GMAC_EFRN & GMAC_EFRN_RUD_Msk;
+}
+
+void gmac_get_tx_event_timestamp(Gmac* gmac, struct _eth_timestamp* ts)
+{
+	uint32_t sec_high = 0;
+
+#ifdef GMAC_EFTSH_RUD_Msk
+	sec_high = gmac->GMAC_EFTSH & GMAC_EFTSH_RUD_Msk;
+#endif
+	ts->sec = ((uint64_t)sec_high << 32) | gmac->GMAC_EFTSL;
+	ts->nsec = gmac->GMAC_EFTN & GMAC_EFTN_RUD_Msk;
+}
+
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+
+int gmac_pack_screeners(const struct _gmac_st1_rule* st1, uint8_t st1_count,
+		const struct _gmac_st2_rule* st2, uint8_t st2_count,
+		struct _gmac_screeners* screeners)
+{
+	uint8_t st2er_count = 0;
+	int i, j;
+
+	if (st1_count > GMAC_ST1_COUNT || st2_count > GMAC_ST2_COUNT)
+		return -ENOSPC;
+
+	memset(screeners, 0, sizeof(*screeners));
+
+	for (i = 0; i < st1_count; i++) {
+		uint32_t value;
+
+		if (st1[i].queue >= GMAC_QUEUE_COUNT)
+			return -EINVAL;
+		if (!st1[i].dstc_enable && !st1[i].udp_enable)
+			return -EINVAL;
+
+		value = GMAC_ST1RPQ_QNB(st1[i].queue);
+		if (st1[i].dstc_enable)
+			value |= GMAC_ST1RPQ_DSTCE | GMAC_ST1RPQ_DSTCM(st1[i].dstc);
+		if (st1[i].udp_enable)
+			value |= GMAC_ST1RPQ_UDPE | GMAC_ST1RPQ_UDPM(st1[i].udp_port);
+		screeners->st1rpq[i] = value;
+	}
+
+	for (i = 0; i < st2_count; i++) {
+		uint32_t value;
+
+		if (st2[i].queue >= GMAC_QUEUE_COUNT)
+			return -EINVAL;
+		if (!st2[i].vlan_enable && !st2[i].ethertype_enable)
+			return -EINVAL;
+		if (st2[i].vlan_priority > 7)
+			return -EINVAL;
+
+		value = GMAC_ST2RPQ_QNB(st2[i].queue);
+		if (st2[i].vlan_enable)
+			value |= GMAC_ST2RPQ_VLANE | GMAC_ST2RPQ_VLANP(st2[i].vlan_priority);
+		if (st2[i].ethertype_enable) {
+			/* Reuse an EtherType register already holding the
+			 * same value, or allocate a new one */
+			for (j = 0; j < st2er_count; j++)
+				if (screeners->st2er[j] == GMAC_ST2ER_COMPVAL(st2[i].ethertype))
+					break;
+			if (j == st2er_count) {
+				if (st2er_count == GMAC_ST2ER_COUNT)
+					return -ENOSPC;
+				screeners->st2er[st2er_count++] = GMAC_ST2ER_COMPVAL(st2[i].ethertype);
+			}
+			value |= GMAC_ST2RPQ_ETHE | GMAC_ST2RPQ_I2ETH(j);
+		}
+		screeners->st2rpq[i] = value;
+	}
+
+	return 0;
+}
+
+void gmac_set_screeners(Gmac* gmac, const struct _gmac_screeners* screeners)
+{
+	int i;
+
+	/* Disable type 2 screeners before updating the shared registers */
+	for (i = 0; i < GMAC_ST2_COUNT; i++)
+		gmac->GMAC_ST2RPQ[i] = 0;
+	for (i = 0; i < GMAC_ST2ER_COUNT; i++)
+		gmac->GMAC_ST2ER[i] = screeners->st2er[i];
+	for (i = 0; i < GMAC_ST1_COUNT; i++)
+		gmac->GMAC_ST1RPQ[i] = screeners->st1rpq[i];
+	for (i = 0; i < GMAC_ST2_COUNT; i++)
+		gmac->GMAC_ST2RPQ[i] = screeners->st2rpq[i];
+}
+
+#endif /* CONFIG_HAVE_GMAC_QUEUES */
+
 void gmac_set_rx_desc(Gmac* gmac, uint8_t queue, struct _eth_desc* desc)
 {
 	if (queue == 0) {
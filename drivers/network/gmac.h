@@ -91,6 +91,15 @@
 
 #define GMAC_MAX_JUMBO_FRAME_LENGTH 10240
 
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+/** Number of Screening Type 1 registers */
+#define GMAC_ST1_COUNT   4
+/** Number of Screening Type 2 registers */
+#define GMAC_ST2_COUNT   8
+/** Number of Screening Type 2 EtherType registers */
+#define GMAC_ST2ER_COUNT 4
+#endif
+
 /**@}*/
 
 /*----------------------------------------------------------------------------
@@ -100,6 +109,35 @@
 /** \addtogroup gmac_structs
 	@{*/
 
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+
+/** Screening Type 1 rule: steer IP frames by DS/TC field and/or UDP port */
+struct _gmac_st1_rule {
+	uint8_t  queue;        /**< destination priority queue */
+	bool     dstc_enable;  /**< match IPv4 DS or IPv6 TC field */
+	uint8_t  dstc;
+	bool     udp_enable;   /**< match UDP destination port */
+	uint16_t udp_port;
+};
+
+/** Screening Type 2 rule: steer frames by VLAN priority and/or EtherType */
+struct _gmac_st2_rule {
+	uint8_t  queue;            /**< destination priority queue */
+	bool     vlan_enable;      /**< match VLAN priority */
+	uint8_t  vlan_priority;
+	bool     ethertype_enable; /**< match EtherType */
+	uint16_t ethertype;
+};
+
+/** Packed screener register values */
+struct _gmac_screeners {
+	uint32_t st1rpq[GMAC_ST1_COUNT];
+	uint32_t st2rpq[GMAC_ST2_COUNT];
+	uint32_t st2er[GMAC_ST2ER_COUNT];
+};
+
+#endif /* CONFIG_HAVE_GMAC_QUEUES */
+
 /**     @}*/
 
 /*----------------------------------------------------------------------------
@@ -226,6 +264,82 @@ extern void gmac_receive_enable(Gmac* gmac, bool enable);
  */
 extern void gmac_transmit_enable(Gmac* gmac, bool enable);
 
+/**
+ *  \brief Enable/Disable RX IP/TCP/UDP checksum offload.
+ *  Frames with bad checksums are discarded by the GMAC and the checksum
+ *  status is reported in the RX descriptors (ETH_RX_STATUS_CSUM_*).
+ */
+extern void gmac_enable_rx_csum_offload(Gmac* gmac, bool enable);
+
+/**
+ *  \brief Enable/Disable TX IP/TCP/UDP checksum generation.
+ *  \return true if the GMAC has a TX checksum generator, false otherwise
+ *  (checksums must then be computed in software)
+ */
+extern bool gmac_enable_tx_csum_offload(Gmac* gmac, bool enable);
+
+/**
+ *  \brief Set the increment added to the 1588 timer on each peripheral
+ *  clock cycle.
+ *  On devices without sub-nanosecond increment register, the fractional
+ *  part is approximated by periodically using a 1ns larger increment.
+ *  \param incr Increment in nanoseconds, 16.16 fixed point
+ */
+extern void gmac_set_tsu_increment(Gmac* gmac, uint32_t incr);
+
+/**
+ *  \brief Read the 1588 timer.
+ */
+extern void gmac_get_tsu_timer(Gmac* gmac, struct _eth_timestamp* ts);
+
+/**
+ *  \brief Load the 1588 timer.
+ */
+extern void gmac_set_tsu_timer(Gmac* gmac, const struct _eth_timestamp* ts);
+
+/**
+ *  \brief Add a signed offset to the 1588 timer without stopping it.
+ *  \param delta_ns Offset in nanoseconds, must be less than one second
+ *  in absolute value.
+ */
+extern void gmac_adjust_tsu_timer(Gmac* gmac, int32_t delta_ns);
+
+/**
+ *  \brief Get the timestamp of the last PTP event frame received.
+ */
+extern void gmac_get_rx_event_timestamp(Gmac* gmac, struct _eth_timestamp* ts);
+
+/**
+ *  \brief Get the timestamp of the last PTP event frame transmitted.
+ */
+extern void gmac_get_tx_event_timestamp(Gmac* gmac, struct _eth_timestamp* ts);
+
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+
+/**
+ *  \brief Validate screening rules and pack them into register values.
+ *  Rules are evaluated by the GMAC in order, type 1 rules first. EtherType
+ *  compare registers are shared between type 2 rules matching the same
+ *  EtherType.
+ *  \param st1 Screening Type 1 rules
+ *  \param st1_count Number of Screening Type 1 rules
+ *  \param st2 Screening Type 2 rules
+ *  \param st2_count Number of Screening Type 2 rules
+ *  \param screeners Packed register values
+ *  \return 0 on success, -EINVAL for an invalid rule, -ENOSPC if the rules
+ *  do not fit in the screening registers.
+ */
+extern int gmac_pack_screeners(const struct _gmac_st1_rule* st1, uint8_t st1_count,
+		const struct _gmac_st2_rule* st2, uint8_t st2_count,
+		struct _gmac_screeners* screeners);
+
+/**
+ *  \brief Write packed screener values to the screening registers.
+ */
+extern void gmac_set_screeners(Gmac* gmac, const struct _gmac_screeners* screeners);
+
+#endif /* CONFIG_HAVE_GMAC_QUEUES */
+
 /**
  *  \brief Set RX descriptor address
  */
@@ -38,9 +38,11 @@
 
 #include "network/gmacd.h"
 #include "irq/irq.h"
+#include "irqflags.h"
 #include "mm/cache.h"
 #include "peripherals/pmc.h"
 
+#include <errno.h>
 #include <string.h>
 #include <assert.h>
 
@@ -57,6 +59,9 @@
 #define GMAC_INT_RX_BITS     (GMAC_IER_RCOMP | GMAC_IER_RXUBR | GMAC_IER_ROVR)
 #define GMAC_INT_TX_ERR_BITS (GMAC_IER_TUR | GMAC_IER_RLEX | GMAC_IER_TFC)
 #define GMAC_INT_TX_BITS     (GMAC_INT_TX_ERR_BITS | GMAC_IER_TCOMP)
+#define GMAC_INT_PTP_BITS    (GMAC_IER_SFR | GMAC_IER_DRQFT)
+
+#define NSEC_PER_SEC 1000000000ll
 
 /*---------------------------------------------------------------------------
  *         Types
@@ -351,19 +356,39 @@ static void _gmacd_handler(struct _ethd * gmacd, uint8_t queue)
 			rsr = gmac_get_rx_status(gmac);
 			gmac_clear_rx_status(gmac, rsr);
 
+			/* Hybrid mode: mask RX interrupts until the queue is
+			 * drained by ethd_napi_poll(), which skips the queues
+			 * without RX budget */
+			if (gmacd->napi && q->rx_budget) {
+				gmac_disable_it(gmac, queue, GMAC_INT_RX_BITS);
+				q->rx_napi_pending = 1;
+			}
+
 			/* Invoke callback */
 			if (q->rx_callback)
 				q->rx_callback(queue, rsr);
 		}
 
+		/* PTP event frames: the timestamps are only kept until the
+		 * next event frame, save them */
+		if (isr & GMAC_IER_SFR) {
+			gmac_get_rx_event_timestamp(gmac, &gmacd->ptp.rx_ts);
+			gmacd->ptp.rx_count++;
+		}
+		if (isr & GMAC_IER_DRQFT) {
+			gmac_get_tx_event_timestamp(gmac, &gmacd->ptp.tx_ts);
+			gmacd->ptp.tx_count++;
+		}
+
 		/* TX error */
 		if (isr & GMAC_INT_TX_ERR_BITS) {
 			_gmacd_tx_error_handler(gmacd, queue);
 			break;
 		}
 
-		/* TX packet */
-		if (isr & GMAC_IER_TCOMP) {
+		/* TX packet, reclaimed by ethd_napi_poll() for the queues
+		 * it polls in hybrid mode */
+		if ((isr & GMAC_IER_TCOMP) && !(gmacd->napi && q->rx_budget)) {
 			_gmacd_tx_complete_handler(gmacd, queue);
 		}
 
@@ -380,6 +405,34 @@ static void _gmacd_gmac_irq_handler(uint32_t source, void* user_arg)
 	_gmacd_handler(handler->gmacd, handler->queue);
 }
 
+static void _gmacd_set_rx_it(struct _ethd* gmacd, uint8_t queue, bool enable)
+{
+	if (enable)
+		gmac_enable_it(gmacd->gmac, queue, GMAC_INT_RX_BITS);
+	else
+		gmac_disable_it(gmacd->gmac, queue, GMAC_INT_RX_BITS);
+}
+
+static void _gmacd_set_tx_complete_it(struct _ethd* gmacd, uint8_t queue, bool enable)
+{
+	if (enable)
+		gmac_enable_it(gmacd->gmac, queue, GMAC_IER_TCOMP);
+	else
+		gmac_disable_it(gmacd->gmac, queue, GMAC_IDR_TCOMP);
+}
+
+static void _gmacd_tx_reclaim(struct _ethd* gmacd, uint8_t queue)
+{
+	uint32_t flags;
+
+	/* Keep the TX error handler from resetting the queue meanwhile. The
+	 * caller may be the interrupt handler itself, restore the previous
+	 * interrupt state rather than unmasking */
+	flags = arch_irq_save();
+	_gmacd_tx_complete_handler(gmacd, queue);
+	arch_irq_restore(flags);
+}
+
 /*---------------------------------------------------------------------------
  *         Exported functions
  *---------------------------------------------------------------------------*/
@@ -409,6 +462,9 @@ void gmacd_configure(struct _ethd * gmacd,
 			irq_add_handler(_gmacd_irq_handlers[i].irq,
 					_gmacd_gmac_irq_handler,
 					&_gmacd_irq_handlers[i]);
+			/* priority queues have their own interrupt line */
+			if (_gmacd_irq_handlers[i].irq != id)
+				irq_enable(_gmacd_irq_handlers[i].irq);
 		}
 	}
 	irq_enable(id);
@@ -425,11 +481,19 @@ void gmacd_configure(struct _ethd * gmacd,
 	}
 	gmac_set_network_config_register(gmac, ncfgr);
 
+	/* Enable IP/TCP/UDP checksum offload engines */
+	gmac_enable_rx_csum_offload(gmac, true);
+	gmacd->csum_offload = ETH_CSUM_RX;
+	if (gmac_enable_tx_csum_offload(gmac, true))
+		gmacd->csum_offload |= ETH_CSUM_TX;
+
 	for (i = 0; i < GMAC_QUEUE_COUNT; i++) {
 		gmacd_setup_queue(gmacd, i,
 				DUMMY_BUFFERS, dummy_buffer, dummy_rx_desc,
 				DUMMY_BUFFERS, dummy_buffer, dummy_tx_desc,
 				NULL);
+		/* do not poll queues until they are given real buffers */
+		gmacd->queues[i].rx_budget = 0;
 	}
 }
 
@@ -473,6 +537,7 @@ uint8_t gmacd_setup_queue(struct _ethd* gmacd, uint8_t queue,
 	q->rx_desc = (struct _eth_desc *)((uint32_t)rx_desc & 0xFFFFFFF8);
 	q->rx_size = rx_size;
 	q->rx_callback = NULL;
+	q->rx_budget = ETH_RX_DEFAULT_BUDGET;
 
 	/* Assign TX buffers */
 	if (((uint32_t)tx_buffer & 0x7)
@@ -542,6 +607,165 @@ void gmacd_set_rx_callback(struct _ethd* gmacd, uint8_t queue, ethd_callback_t c
 	}
 }
 
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+/**
+ * \brief Configure the GMAC screeners to steer received frames to the
+ * priority queues. Frames not matching any rule are received on queue 0.
+ * The destination queues must have been set up with gmacd_setup_queue().
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \param st1 Screening Type 1 rules (DS/TC field, UDP port)
+ *  \param st1_count Number of Screening Type 1 rules
+ *  \param st2 Screening Type 2 rules (VLAN priority, EtherType)
+ *  \param st2_count Number of Screening Type 2 rules
+ *  \return 0 on success, a negative errno otherwise
+ */
+int gmacd_set_rx_screeners(struct _ethd* gmacd,
+		const struct _gmac_st1_rule* st1, uint8_t st1_count,
+		const struct _gmac_st2_rule* st2, uint8_t st2_count)
+{
+	struct _gmac_screeners screeners;
+	int i, err;
+
+	err = gmac_pack_screeners(st1, st1_count, st2, st2_count, &screeners);
+	if (err < 0)
+		return err;
+
+	for (i = 0; i < st1_count; i++)
+		if (gmacd->queues[st1[i].queue].rx_buffer == dummy_buffer)
+			return -EINVAL;
+	for (i = 0; i < st2_count; i++)
+		if (gmacd->queues[st2[i].queue].rx_buffer == dummy_buffer)
+			return -EINVAL;
+
+	gmac_set_screeners(gmacd->gmac, &screeners);
+	return 0;
+}
+#endif /* CONFIG_HAVE_GMAC_QUEUES */
+
+/**
+ * \brief Start or stop the IEEE 1588 timer and the capture of the PTP event
+ * frame timestamps (Sync received, Delay_Req transmitted).
+ * The timer runs at the nominal rate of the GMAC peripheral clock.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \param enable true to start the timer.
+ */
+void gmacd_ptp_enable(struct _ethd* gmacd, bool enable)
+{
+	Gmac* gmac = gmacd->gmac;
+	uint32_t mck;
+
+	if (enable) {
+		mck = pmc_get_peripheral_clock(get_gmac_id_from_addr(gmac));
+		gmacd->ptp.incr = (uint32_t)((NSEC_PER_SEC << 16) / mck);
+		gmac_set_tsu_increment(gmac, gmacd->ptp.incr);
+		gmac_enable_it(gmac, 0, GMAC_INT_PTP_BITS);
+	} else {
+		gmac_disable_it(gmac, 0, GMAC_INT_PTP_BITS);
+		gmac_set_tsu_increment(gmac, 0);
+		gmacd->ptp.incr = 0;
+	}
+}
+
+void gmacd_ptp_get_time(struct _ethd* gmacd, struct _eth_timestamp* ts)
+{
+	gmac_get_tsu_timer(gmacd->gmac, ts);
+}
+
+void gmacd_ptp_set_time(struct _ethd* gmacd, const struct _eth_timestamp* ts)
+{
+	gmac_set_tsu_timer(gmacd->gmac, ts);
+}
+
+/**
+ * \brief Step the IEEE 1588 timer.
+ * Offsets below one second are applied by hardware without stopping the
+ * timer, larger ones reload the timer.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \param delta_ns Signed offset in nanoseconds.
+ */
+void gmacd_ptp_adjust_time(struct _ethd* gmacd, int64_t delta_ns)
+{
+	struct _eth_timestamp ts;
+	int64_t sec;
+	int32_t nsec;
+
+	if (delta_ns > -NSEC_PER_SEC && delta_ns < NSEC_PER_SEC) {
+		gmac_adjust_tsu_timer(gmacd->gmac, (int32_t)delta_ns);
+		return;
+	}
+
+	gmac_get_tsu_timer(gmacd->gmac, &ts);
+	sec = (int64_t)ts.sec + delta_ns / NSEC_PER_SEC;
+	nsec = (int32_t)ts.nsec + (int32_t)(delta_ns % NSEC_PER_SEC);
+	if (nsec < 0) {
+		nsec += NSEC_PER_SEC;
+		sec--;
+	} else if (nsec >= NSEC_PER_SEC) {
+		nsec -= NSEC_PER_SEC;
+		sec++;
+	}
+	ts.sec = sec < 0 ? 0 : sec;
+	ts.nsec = nsec;
+	gmac_set_tsu_timer(gmacd->gmac, &ts);
+}
+
+/**
+ * \brief Tune the IEEE 1588 timer rate.
+ * The resolution is limited by the timer increment register: about 1.3ppm
+ * with a 83MHz peripheral clock and 2^-16ns sub-nanosecond increments.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \param ppb Frequency offset from nominal, in parts per billion.
+ *  \return 0 on success, -EINVAL if the timer is not started or the offset
+ *  is out of range.
+ */
+int gmacd_ptp_adjust_freq(struct _ethd* gmacd, int32_t ppb)
+{
+	int64_t incr = gmacd->ptp.incr;
+
+	if (!incr || ppb > GMACD_PTP_MAX_ADJ_PPB || ppb < -GMACD_PTP_MAX_ADJ_PPB)
+		return -EINVAL;
+
+	incr += (incr * ppb) / NSEC_PER_SEC;
+	gmac_set_tsu_increment(gmacd->gmac, (uint32_t)incr);
+	return 0;
+}
+
+/**
+ * \brief Get the timestamp of the last Sync frame received.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \param ts Timestamp
+ *  \return Number of timestamps captured so far, 0 if none.
+ */
+uint32_t gmacd_ptp_get_rx_timestamp(struct _ethd* gmacd, struct _eth_timestamp* ts)
+{
+	uint32_t irq = get_gmac_id_from_addr(gmacd->gmac);
+	uint32_t count;
+
+	irq_disable(irq);
+	*ts = gmacd->ptp.rx_ts;
+	count = gmacd->ptp.rx_count;
+	irq_enable(irq);
+	return count;
+}
+
+/**
+ * \brief Get the timestamp of the last Delay_Req frame transmitted.
+ *  \param gmacd Pointer to GMAC Driver instance.
+ *  \param ts Timestamp
+ *  \return Number of timestamps captured so far, 0 if none.
+ */
+uint32_t gmacd_ptp_get_tx_timestamp(struct _ethd* gmacd, struct _eth_timestamp* ts)
+{
+	uint32_t irq = get_gmac_id_from_addr(gmacd->gmac);
+	uint32_t count;
+
+	irq_disable(irq);
+	*ts = gmacd->ptp.tx_ts;
+	count = gmacd->ptp.tx_count;
+	irq_enable(irq);
+	return count;
+}
+
 const struct _ethd_op _gmac_op = {
 	.configure = (_ethd_configure)gmacd_configure,
 	.setup_queue = (_ethd_setup_queue)gmacd_setup_queue,
@@ -555,4 +779,7 @@ const struct _ethd_op _gmac_op = {
 	.poll = (_ethd_poll)ethd_poll,
 	.set_rx_callback = (_ethd_set_rx_callback)gmacd_set_rx_callback,
 	.set_tx_wakeup_callback = (_ethd_set_tx_wakeup_callback)ethd_set_tx_wakeup_callback,
+	.set_rx_it = (_ethd_set_rx_it)_gmacd_set_rx_it,
+	.set_tx_complete_it = (_ethd_set_tx_complete_it)_gmacd_set_tx_complete_it,
+	.tx_reclaim = (_ethd_tx_reclaim)_gmacd_tx_reclaim,
 };
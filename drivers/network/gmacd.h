@@ -41,6 +41,12 @@
  * -# Send ethernet packets using ethd_send(), ethd_get_tx_load() is used
  *    to get the free space in TX queue.
  * -# Check and obtain received ethernet packets via ethd_poll().
+ * -# On devices with priority queues, steer received frames to the queues
+ *    with gmacd_set_rx_screeners().
+ * -# Start the IEEE 1588 timer with gmacd_ptp_enable(), read the PTP event
+ *    frame timestamps with gmacd_ptp_get_rx_timestamp() and
+ *    gmacd_ptp_get_tx_timestamp(), and discipline the timer with
+ *    gmacd_ptp_adjust_time() and gmacd_ptp_adjust_freq().
  *
  * \sa \ref gmacb_module, \ref gmac_module
  *
@@ -70,6 +76,9 @@
 /** \addtogroup gmacd_defines
     @{*/
 
+/** Maximum frequency adjustment of the IEEE 1588 timer (ppb) */
+#define GMACD_PTP_MAX_ADJ_PPB 500000
+
 /** @}*/
 
 /*---------------------------------------------------------------------------
@@ -122,6 +131,26 @@ extern uint8_t gmacd_poll(struct _ethd* gmacd, uint8_t queue,
 extern void gmacd_set_rx_callback(struct _ethd *gmacd, uint8_t queue,
 		ethd_callback_t callback);
 
+extern void gmacd_ptp_enable(struct _ethd* gmacd, bool enable);
+
+extern void gmacd_ptp_get_time(struct _ethd* gmacd, struct _eth_timestamp* ts);
+
+extern void gmacd_ptp_set_time(struct _ethd* gmacd, const struct _eth_timestamp* ts);
+
+extern void gmacd_ptp_adjust_time(struct _ethd* gmacd, int64_t delta_ns);
+
+extern int gmacd_ptp_adjust_freq(struct _ethd* gmacd, int32_t ppb);
+
+extern uint32_t gmacd_ptp_get_rx_timestamp(struct _ethd* gmacd, struct _eth_timestamp* ts);
+
+extern uint32_t gmacd_ptp_get_tx_timestamp(struct _ethd* gmacd, struct _eth_timestamp* ts);
+
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+extern int gmacd_set_rx_screeners(struct _ethd* gmacd,
+		const struct _gmac_st1_rule* st1, uint8_t st1_count,
+		const struct _gmac_st2_rule* st2, uint8_t st2_count);
+#endif
+
 /** @}*/
 
 #ifdef __cplusplus
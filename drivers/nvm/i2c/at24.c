@@ -128,10 +128,65 @@ static int _at24_compute_address_field(const struct _at24* at24, uint8_t *addr_b
 	}
 }
 
-static int _at24_twi_read(const struct _at24* at24, uint8_t addr_offset, struct _buffer *buf)
+/*
+ * Wait for the end of the write cycle started by the last page program.
+ * The EEPROM does not acknowledge its address until the cycle completes:
+ * poll it with a dummy address write, releasing the bus between the polls
+ * so that other devices can use it meanwhile.
+ */
+static int _at24_wait_ready(struct _at24* at24)
 {
+	struct _timeout timeout;
+	struct _buffer buf = {
+		.data = &at24->cycle.data,
+		.size = 1,
+		.attr = BUS_I2C_BUF_ATTR_START | BUS_BUF_ATTR_TX | BUS_I2C_BUF_ATTR_STOP,
+	};
+	uint32_t elapsed;
 	int err;
 
+	if (!at24->cycle.busy)
+		return 0;
+
+	timer_start_timeout(&timeout, AT24_WRITE_CYCLE_TIMEOUT);
+	for (;;) {
+		bus_start_transaction(at24->bus);
+		err = bus_transfer(at24->bus, at24->cycle.addr, &buf, 1, NULL);
+		if (err == 0)
+			err = bus_wait_transfer(at24->bus);
+		bus_stop_transaction(at24->bus);
+
+		if (err != -ECONNABORTED)
+			break;
+
+		at24->stats.polls++;
+		if (timer_timeout_reached(&timeout)) {
+			trace_error("at24: write cycle timeout\r\n");
+			at24->stats.timeouts++;
+			err = -ETIMEDOUT;
+			break;
+		}
+	}
+
+	if (err == 0) {
+		elapsed = (uint32_t)(timer_get_us() - at24->cycle.start);
+		at24->stats.cycle_total += elapsed;
+		if (elapsed > at24->stats.cycle_max)
+			at24->stats.cycle_max = elapsed;
+	}
+
+	at24->cycle.busy = false;
+	return err;
+}
+
+static int _at24_twi_read(struct _at24* at24, uint8_t addr_offset, struct _buffer *buf)
+{
+	int err;
+
+	err = _at24_wait_ready(at24);
+	if (err < 0)
+		return err;
+
 	/* start a TWI bus transaction */
 	bus_start_transaction(at24->bus);
 
@@ -143,6 +198,125 @@ static int _at24_twi_read(const struct _at24* at24, uint8_t addr_offset, struct
 	return err;
 }
 
+/*
+ * Program up to one page of data (the range must not cross a page boundary).
+ * The bus is released as soon as the data is sent, the write cycle is left
+ * running and waited for by the next access to the device.
+ */
+static int _at24_program(struct _at24* at24, uint32_t offset, const uint8_t* data, uint16_t length)
+{
+	uint8_t addr_offset, addr_buf[2];
+	struct _buffer buf[2] = {
+		{
+			.data = addr_buf,
+			/* .size */
+			.attr = BUS_I2C_BUF_ATTR_START | BUS_BUF_ATTR_TX,
+		},
+		{
+			.data = (uint8_t*)data,
+			.size = length,
+			.attr = BUS_BUF_ATTR_TX | BUS_I2C_BUF_ATTR_STOP,
+		},
+	};
+	int err;
+
+	err = _at24_wait_ready(at24);
+	if (err < 0)
+		return err;
+
+	/* prepare TWI bus buffers */
+	buf[0].size = _at24_compute_address_field(at24, addr_buf, offset, &addr_offset);
+
+	bus_start_transaction(at24->bus);
+	err = bus_transfer(at24->bus, at24->addr + addr_offset, buf, 2, NULL);
+	if (err == 0)
+		err = bus_wait_transfer(at24->bus);
+	bus_stop_transaction(at24->bus);
+	if (err < 0)
+		return err;
+
+	at24->cycle.busy = true;
+	at24->cycle.addr = at24->addr + addr_offset;
+	at24->cycle.data = addr_buf[0];
+	at24->cycle.start = timer_get_us();
+
+	at24->stats.page_writes++;
+	at24->stats.bytes_written += length;
+
+	return 0;
+}
+
+static struct _at24_cache_line* _at24_cache_find(struct _at24* at24, uint32_t page)
+{
+	int i;
+
+	for (i = 0; i < at24->cache.count; i++) {
+		struct _at24_cache_line* line = &at24->cache.lines[i];
+		if (line->valid && line->page == page)
+			return line;
+	}
+
+	return NULL;
+}
+
+static int _at24_cache_clean(struct _at24* at24, struct _at24_cache_line* line)
+{
+	int err;
+
+	if (!line->valid || line->lo == line->hi)
+		return 0;
+
+	err = _at24_program(at24, line->page + line->lo,
+			line->data + line->lo, line->hi - line->lo);
+	if (err < 0)
+		return err;
+
+	line->lo = line->hi = 0;
+	return 0;
+}
+
+/*
+ * Get a cache line for the page, evicting lines in a round-robin way and
+ * loading the current page contents from the EEPROM
+ */
+static int _at24_cache_load(struct _at24* at24, uint32_t page, struct _at24_cache_line** pline)
+{
+	struct _at24_cache_line* line = &at24->cache.lines[at24->cache.next];
+	uint8_t addr_offset, addr_buf[2];
+	struct _buffer buf[2] = {
+		{
+			.data = addr_buf,
+			/* .size */
+			.attr = BUS_I2C_BUF_ATTR_START | BUS_BUF_ATTR_TX,
+		},
+		{
+			.data = line->data,
+			.size = at24->desc->page_size,
+			.attr = BUS_I2C_BUF_ATTR_START | BUS_BUF_ATTR_RX | BUS_I2C_BUF_ATTR_STOP,
+		},
+	};
+	int err;
+
+	err = _at24_cache_clean(at24, line);
+	if (err < 0)
+		return err;
+
+	line->valid = false;
+	buf[0].size = _at24_compute_address_field(at24, addr_buf, page, &addr_offset);
+	err = _at24_twi_read(at24, addr_offset, buf);
+	if (err < 0)
+		return err;
+
+	line->page = page;
+	line->lo = line->hi = 0;
+	line->valid = true;
+	at24->cache.next = (at24->cache.next + 1) % at24->cache.count;
+	at24->stats.cache_misses++;
+
+	*pline = line;
+	return 0;
+}
+
 //------------------------------------------------------------------------------
 ///        Exported functions
 //------------------------------------------------------------------------------
@@ -164,9 +338,9 @@ int at24_configure(struct _at24* at24, const struct _at24_config* cfg)
 		return -ENOTSUP;
 	}
 
-	if (at24->desc->size == 18) {
+	if (desc->size == 18) {
 		addr_mask = ~4; /* A2 */
-	} else if (at24->desc->size == 17) {
+	} else if (desc->size == 17) {
 		addr_mask = ~6; /* A2 A1 */
 	} else {
 		addr_mask = ~7; /* A2 A1 A0 */
@@ -180,12 +354,17 @@ int at24_configure(struct _at24* at24, const struct _at24_config* cfg)
 	at24->addr = cfg->addr;
 	at24->desc = desc;
 
+	memset(&at24->cycle, 0, sizeof(at24->cycle));
+	memset(&at24->cache, 0, sizeof(at24->cache));
+	memset(&at24->stats, 0, sizeof(at24->stats));
+
 	return 0;
 }
 
-int at24_read(const struct _at24* at24, uint32_t offset, uint8_t* data, uint16_t length)
+int at24_read(struct _at24* at24, uint32_t offset, uint8_t* data, uint16_t length)
 {
 	uint8_t addr_offset, addr_buf[2];
+	int i, err;
 	struct _buffer buf[2] = {
 		{
 			.data = addr_buf,
@@ -203,58 +382,111 @@ int at24_read(const struct _at24* at24, uint32_t offset, uint8_t* data, uint16_t
 	buf[0].size = _at24_compute_address_field(at24, addr_buf, offset, &addr_offset);
 
 	/* read data */
-	return _at24_twi_read(at24, addr_offset, buf);
+	err = _at24_twi_read(at24, addr_offset, buf);
+	if (err < 0)
+		return err;
+
+	/* overlay pages modified in the write cache */
+	for (i = 0; i < at24->cache.count; i++) {
+		const struct _at24_cache_line* line = &at24->cache.lines[i];
+		uint32_t start, end;
+
+		if (!line->valid || line->lo == line->hi)
+			continue;
+		start = max_u32(offset, line->page + line->lo);
+		end = min_u32(offset + length, line->page + line->hi);
+		if (start < end)
+			memcpy(data + (start - offset), line->data + (start - line->page), end - start);
+	}
+
+	return 0;
 }
 
-int at24_write(const struct _at24* at24, uint32_t offset, const uint8_t* data, uint16_t length)
+int at24_write(struct _at24* at24, uint32_t offset, const uint8_t* data, uint16_t length)
 {
-	const uint8_t page_size = at24->desc->page_size;
-	uint8_t addr_offset, addr_buf[2];
-	struct _buffer buf[2] = {
-		{
-			.data = addr_buf,
-			/* .size */
-			.attr = BUS_I2C_BUF_ATTR_START | BUS_BUF_ATTR_TX,
-		},
-		{
-			/* .data */
-			/* .size */
-			.attr = BUS_BUF_ATTR_TX | BUS_I2C_BUF_ATTR_STOP,
-		},
-	};
-	uint8_t chunk_size;
+	const uint16_t page_size = at24->desc->page_size;
+	struct _at24_cache_line* line;
+	uint32_t page;
+	uint16_t pos;
+	uint16_t chunk_size;
 	int err = 0;
 
-	/* start a TWI bus transaction */
-	bus_start_transaction(at24->bus);
-
 	while (length) {
 		/* compute chunk size (aligned to write page size) */
-		chunk_size = min_u32(length, page_size - (offset % page_size));
-
-		/* prepare TWI bus buffers */
-		buf[0].size = _at24_compute_address_field(at24, addr_buf, offset, &addr_offset);
-		buf[1].data = (uint8_t*)data;
-		buf[1].size = chunk_size;
+		pos = offset % page_size;
+		page = offset - pos;
+		chunk_size = min_u32(length, page_size - pos);
+
+		line = _at24_cache_find(at24, page);
+		if (line) {
+			at24->stats.cache_hits++;
+		} else if (at24->cache.count && chunk_size < page_size) {
+			err = _at24_cache_load(at24, page, &line);
+			if (err < 0)
+				break;
+		}
 
-		/* start the TWI bus transfer */
-		err = bus_transfer(at24->bus, at24->addr + addr_offset, buf, 2, NULL);
-		if (err < 0)
-			break;
+		if (line) {
+			/* merge into the cached page */
+			memcpy(line->data + pos, data, chunk_size);
+			if (line->lo == line->hi) {
+				line->lo = pos;
+				line->hi = pos + chunk_size;
+			} else {
+				line->lo = min_u32(line->lo, pos);
+				line->hi = max_u32(line->hi, pos + chunk_size);
+			}
+		} else {
+			err = _at24_program(at24, offset, data, chunk_size);
+			if (err < 0)
+				break;
+		}
 
 		/* update position & remaining data length */
 		offset += chunk_size;
 		data += chunk_size;
 		length -= chunk_size;
+	}
 
-		/* wait 10 ms for write cycle to complete */
-		msleep(10);
-	};
+	return err;
+}
 
-	/* stop transaction */
-	bus_stop_transaction(at24->bus);
+int at24_enable_cache(struct _at24* at24, uint8_t* buffer, uint32_t size)
+{
+	const uint16_t page_size = at24->desc->page_size;
+	int i, err;
 
-	return err;
+	err = at24_flush(at24);
+	if (err < 0)
+		return err;
+
+	if (size < page_size)
+		return -EINVAL;
+
+	memset(&at24->cache, 0, sizeof(at24->cache));
+	at24->cache.count = min_u32(size / page_size, AT24_CACHE_LINES);
+	for (i = 0; i < at24->cache.count; i++)
+		at24->cache.lines[i].data = buffer + i * page_size;
+
+	return 0;
+}
+
+int at24_flush(struct _at24* at24)
+{
+	int i, err;
+
+	for (i = 0; i < at24->cache.count; i++) {
+		err = _at24_cache_clean(at24, &at24->cache.lines[i]);
+		if (err < 0)
+			return err;
+	}
+
+	return _at24_wait_ready(at24);
+}
+
+void at24_get_stats(const struct _at24* at24, struct _at24_stats* stats)
+{
+	memcpy(stats, &at24->stats, sizeof(*stats));
 }
 
 bool at24_has_serial(const struct _at24* at24)
@@ -264,7 +496,7 @@ bool at24_has_serial(const struct _at24* at24)
 	       at24->desc->family == AT24MAC6;
 }
 
-bool at24_read_serial(const struct _at24* at24, uint8_t* serial)
+bool at24_read_serial(struct _at24* at24, uint8_t* serial)
 {
 	uint8_t offset = AT24_SERIAL_OFFSET;
 	struct _buffer buf[2] = {
@@ -301,7 +533,7 @@ bool at24_has_eui48(const struct _at24* at24)
 	return (at24->desc->eui.len == EUI48_LENGTH);
 }
 
-bool at24_read_eui48(const struct _at24* at24, uint8_t* eui48)
+bool at24_read_eui48(struct _at24* at24, uint8_t* eui48)
 {
 	uint8_t offset = at24->desc->eui.offset;
 	struct _buffer buf[2] = {
@@ -338,7 +570,7 @@ bool at24_has_eui64(const struct _at24* at24)
 	return (at24->desc->eui.len == EUI64_LENGTH);
 }
 
-bool at24_read_eui64(const struct _at24* at24, uint8_t* eui64)
+bool at24_read_eui64(struct _at24* at24, uint8_t* eui64)
 {
 	uint8_t offset = at24->desc->eui.offset;
 	struct _buffer buf[2] = {
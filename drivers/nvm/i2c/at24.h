@@ -36,6 +36,7 @@
  *         Headers
  *----------------------------------------------------------------------------*/
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /*----------------------------------------------------------------------------
@@ -46,6 +47,12 @@
 #define EUI48_LENGTH  6
 #define EUI64_LENGTH  8
 
+/** Maximum number of pages in the write-combining cache */
+#define AT24_CACHE_LINES 4
+
+/** Maximum write cycle time (ms), after which ACK polling gives up */
+#define AT24_WRITE_CYCLE_TIMEOUT 20
+
 enum _at24_model {
 	AT24C01,
 	AT24C02,
@@ -100,10 +107,45 @@ struct _at24_config {
 	enum _at24_model model;
 };
 
+/** Write cycle and cache statistics */
+struct _at24_stats {
+	uint32_t page_writes;    /* page program operations */
+	uint32_t bytes_written;  /* bytes programmed */
+	uint32_t polls;          /* ACK polls answered by a NACK (device busy) */
+	uint32_t timeouts;       /* write cycles not completed in time */
+	uint32_t cycle_max;      /* longest write cycle (us) */
+	uint64_t cycle_total;    /* cumulated write cycle time (us) */
+	uint32_t cache_hits;     /* writes merged into a cached page */
+	uint32_t cache_misses;   /* pages loaded into the cache */
+};
+
+struct _at24_cache_line {
+	uint8_t* data;      /* page contents (page_size bytes) */
+	uint32_t page;      /* offset of the page in the EEPROM */
+	uint16_t lo, hi;    /* modified bytes, lo == hi when clean */
+	bool valid;
+};
+
 struct _at24 {
 	uint8_t bus;
 	uint8_t addr;
 	const struct _at24_desc *desc;
+
+	/* write cycle in progress, completion checked by ACK polling */
+	struct {
+		bool busy;
+		uint8_t addr;       /* device address of the page written */
+		uint8_t data;       /* first address byte, sent by the polls */
+		uint64_t start;     /* start of the write cycle (us) */
+	} cycle;
+
+	struct {
+		struct _at24_cache_line lines[AT24_CACHE_LINES];
+		uint8_t count;
+		uint8_t next;       /* next line to evict */
+	} cache;
+
+	struct _at24_stats stats;
 };
 
 /*----------------------------------------------------------------------------
@@ -111,14 +153,39 @@ struct _at24 {
  *----------------------------------------------------------------------------*/
 
 extern int at24_configure(struct _at24* at24, const struct _at24_config* cfg);
-extern int at24_read(const struct _at24* at24, uint32_t offset, uint8_t* data, uint16_t length);
-extern int at24_write(const struct _at24* at24, uint32_t offset, const uint8_t* data, uint16_t length);
+extern int at24_read(struct _at24* at24, uint32_t offset, uint8_t* data, uint16_t length);
+
+/**
+ * \brief Write data to the EEPROM, one page program per page. The bus is
+ * released between pages while the EEPROM completes its write cycle, and
+ * the function returns without waiting for the last one: the next access to
+ * the device waits for it by ACK polling.
+ * When the write-combining cache is enabled, partial pages are merged in the
+ * cache and only programmed by at24_flush() or on eviction.
+ */
+extern int at24_write(struct _at24* at24, uint32_t offset, const uint8_t* data, uint16_t length);
+
+/**
+ * \brief Enable the write-combining page cache
+ * \param buffer Cache storage, split in pages (up to AT24_CACHE_LINES)
+ * \param size Size of buffer, at least one page
+ * \return 0 on success, -EINVAL if buffer is smaller than a page
+ */
+extern int at24_enable_cache(struct _at24* at24, uint8_t* buffer, uint32_t size);
+
+/**
+ * \brief Program the modified pages of the cache and wait for the end of
+ * the write cycle
+ */
+extern int at24_flush(struct _at24* at24);
+
+extern void at24_get_stats(const struct _at24* at24, struct _at24_stats* stats);
 extern bool at24_has_serial(const struct _at24* at24);
-extern bool at24_read_serial(const struct _at24* at24, uint8_t* serial);
+extern bool at24_read_serial(struct _at24* at24, uint8_t* serial);
 extern bool at24_has_eui48(const struct _at24* at24);
-extern bool at24_read_eui48(const struct _at24* at24, uint8_t* eui48);
+extern bool at24_read_eui48(struct _at24* at24, uint8_t* eui48);
 extern bool at24_has_eui64(const struct _at24* at24);
-extern bool at24_read_eui64(const struct _at24* at24, uint8_t* eui64);
+extern bool at24_read_eui64(struct _at24* at24, uint8_t* eui64);
 
 #endif /* CONFIG_DRV_AT24 */
 
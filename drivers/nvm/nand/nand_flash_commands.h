@@ -56,6 +56,7 @@
 #define NAND_CMD_READID             0x90
 #define NAND_CMD_WRITE_1            0x80
 #define NAND_CMD_WRITE_2            0x10
+#define NAND_CMD_WRITE_CACHE        0x15
 #define NAND_CMD_ERASE_1            0x60
 #define NAND_CMD_ERASE_2            0xD0
 #define NAND_CMD_STATUS             0x70
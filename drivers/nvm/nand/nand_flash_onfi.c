@@ -135,6 +135,9 @@ static bool nand_onfi_retrieve_param(const struct _nand_flash *nand)
 
 		/* Bus width */
 		onfi_parameter.onfi_bus_width = (*(uint8_t*)(onfi_param_table + 6)) & 0x01;
+		/* Optional commands supported (bytes 8-9 in the param table) */
+		onfi_parameter.onfi_optional_commands = onfi_param_table[8] |
+			(onfi_param_table[9] << 8);
 		/* Device model */
 		onfi_parameter.onfi_device_model= *(uint8_t*)(onfi_param_table + 49);
 		/* JEDEC manufacturer ID */
@@ -232,6 +235,12 @@ uint8_t nand_onfi_get_ecc_correctability(void)
 	return onfi_parameter.onfi_ecc_correctability;
 }
 
+bool nand_onfi_has_cache_program(void)
+{
+	return onfi_parameter.onfi_compatible &&
+		(onfi_parameter.onfi_optional_commands & ONFI_OPT_CMD_CACHE_PROGRAM);
+}
+
 /**
  * \brief This function check if the NANDFLASH has an embedded ECC controller.
  * \return false if ONFI not compliant or internal ECC not supported, true if Internal ECC enabled.
@@ -46,6 +46,9 @@
 #define NAND_IO_RC_FAIL    1
 #define NAND_IO_RC_TIMEOUT 2
 
+/** ONFI optional commands supported */
+#define ONFI_OPT_CMD_CACHE_PROGRAM   (1 << 0)
+
 /** Describes memory organization block information in ONFI parameter page */
 struct _onfi_page_param {
 	/** ONFI compatible */
@@ -77,6 +80,9 @@ struct _onfi_page_param {
 
 	/** Device model */
 	uint8_t onfi_device_model;
+
+	/** Optional commands supported */
+	uint16_t onfi_optional_commands;
 };
 
 /*--------------------------------------------------------------------- */
@@ -107,4 +113,6 @@ extern uint16_t nand_onfi_get_blocks_per_lun(void);
 
 extern uint8_t nand_onfi_get_ecc_correctability(void);
 
+extern bool nand_onfi_has_cache_program(void);
+
 #endif /* NAND_FLASH_ONFI_H */
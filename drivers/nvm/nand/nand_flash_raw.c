@@ -335,11 +335,15 @@ static void _data_array_out(const struct _nand_flash *nand, bool nfc_sram,
 }
 
 /**
- * \brief Use STATUS command to determine if the last issued command was successful.
+ * \brief Use STATUS command to wait until the device is ready and check the
+ * given failure bits.
  * \param nand  Pointer to a struct _nand_flash instance.
- * \return 0 if the last command issued was successful, NAND_ERROR_STATUS otherwise
+ * \param fail_mask  Status bits reporting a failure (NAND_STATUS_FAIL and/or
+ * NAND_STATUS_FAILC).
+ * \return 0 if no failure bit is set, NAND_ERROR_STATUS otherwise
  */
-static uint8_t _status_ready_pass(const struct _nand_flash *nand)
+static uint8_t _status_ready_mask(const struct _nand_flash *nand,
+		uint8_t fail_mask)
 {
 	int i;
 
@@ -355,7 +359,7 @@ static uint8_t _status_ready_pass(const struct _nand_flash *nand)
 			continue;
 
 		/* Check if last command was successful */
-		if ((status & NAND_STATUS_FAIL) == 0)
+		if ((status & fail_mask) == 0)
 			return 0;
 		else
 			return NAND_ERROR_STATUS;
@@ -364,6 +368,16 @@ static uint8_t _status_ready_pass(const struct _nand_flash *nand)
 	return NAND_ERROR_STATUS;
 }
 
+/**
+ * \brief Use STATUS command to determine if the last issued command was successful.
+ * \param nand  Pointer to a struct _nand_flash instance.
+ * \return 0 if the last command issued was successful, NAND_ERROR_STATUS otherwise
+ */
+static uint8_t _status_ready_pass(const struct _nand_flash *nand)
+{
+	return _status_ready_mask(nand, NAND_STATUS_FAIL);
+}
+
 /**
  * \brief Waiting for the completion of a page program, erase and random read completion.
  * \param nand  Pointer to a struct _nand_flash instance.
@@ -562,10 +576,13 @@ static uint8_t _read_page_with_pmecc(const struct _nand_flash *nand,
  * \param block  Number of the block where the page to write resides.
  * \param page  Number of the page to write inside the given block.
  * \param data  Buffer containing the data area.
+ * \param program  Program command (NAND_CMD_WRITE_2 or NAND_CMD_WRITE_CACHE).
+ * \param fail_mask  Status bits reporting a failure.
  * \return 0 if the write operation is successful; otherwise returns 1.
 */
 static uint8_t _write_page(const struct _nand_flash *nand,
-	uint16_t block, uint16_t page, uint8_t *data, uint8_t *spare)
+	uint16_t block, uint16_t page, uint8_t *data, uint8_t *spare,
+	uint8_t program, uint8_t fail_mask)
 {
 	uint8_t error = 0;
 	uint32_t data_size = nand_model_get_page_data_size(&nand->model);
@@ -615,7 +632,7 @@ static uint8_t _write_page(const struct _nand_flash *nand,
 		}
 	}
 
-	_send_cle_ale(nand, CLE_WRITE_EN, NAND_CMD_WRITE_2, 0, 0, 0);
+	_send_cle_ale(nand, CLE_WRITE_EN, program, 0, 0, 0);
 
 #ifdef CONFIG_HAVE_NFC
 	if (nand_is_nfc_enabled()) {
@@ -624,7 +641,7 @@ static uint8_t _write_page(const struct _nand_flash *nand,
 	}
 #endif
 
-	if (_status_ready_pass(nand)) {
+	if (_status_ready_mask(nand, fail_mask)) {
 			trace_error("write_page_no_ecc: Failed writing data area.\r\n");
 			error = NAND_ERROR_CANNOTWRITE;
 	}
@@ -639,10 +656,13 @@ static uint8_t _write_page(const struct _nand_flash *nand,
  * \param block  Number of the block where the page to write resides.
  * \param page  Number of the page to write inside the given block.
  * \param data  Buffer containing the data area.
+ * \param program  Program command (NAND_CMD_WRITE_2 or NAND_CMD_WRITE_CACHE).
+ * \param fail_mask  Status bits reporting a failure.
  * \return 0 if the write operation is successful; otherwise returns 1.
 */
 static uint8_t _write_page_with_pmecc(const struct _nand_flash *nand,
-	uint16_t block, uint16_t page, uint8_t *data)
+	uint16_t block, uint16_t page, uint8_t *data,
+	uint8_t program, uint8_t fail_mask)
 {
 	uint8_t error = 0;
 	uint32_t data_size = nand_model_get_page_data_size(&nand->model);
@@ -706,7 +726,7 @@ static uint8_t _write_page_with_pmecc(const struct _nand_flash *nand,
 			ecc_table[i * ecc_bytes_per_sector + j] = pmecc_value(i, j);
 
 	_data_array_out(nand, false, ecc_table, pmecc_get_ecc_bytes_per_page(), 0);
-	_send_cle_ale(nand, CLE_WRITE_EN, NAND_CMD_WRITE_2, 0, 0, 0);
+	_send_cle_ale(nand, CLE_WRITE_EN, program, 0, 0, 0);
 
 #ifdef CONFIG_HAVE_NFC
 	if (nand_is_nfc_enabled()) {
@@ -715,7 +735,7 @@ static uint8_t _write_page_with_pmecc(const struct _nand_flash *nand,
 	}
 #endif
 
-	if (_nand_wait_ready(nand)) {
+	if (_status_ready_mask(nand, fail_mask)) {
 		trace_error("write_page_pmecc: Failed writing.\r\n");
 		error = NAND_ERROR_CANNOTWRITE;
 	}
@@ -871,10 +891,47 @@ uint8_t nand_raw_write_page(const struct _nand_flash *nand,
 	NAND_TRACE("nand_raw_write_page(B#%d:P#%d)\r\n", block, page);
 
 	if (!nand_is_using_pmecc() || spare)
-		return _write_page(nand, block, page, data, spare);
+		return _write_page(nand, block, page, data, spare,
+				NAND_CMD_WRITE_2, NAND_STATUS_FAIL);
 
 	if (nand_is_using_pmecc())
-		return _write_page_with_pmecc(nand, block, page, data);
+		return _write_page_with_pmecc(nand, block, page, data,
+				NAND_CMD_WRITE_2, NAND_STATUS_FAIL);
 
 	return NAND_ERROR_ECC_NOT_COMPATIBLE;
 }
+
+/**
+ * \brief Writes the data area of a page with the PAGE CACHE PROGRAM command,
+ * computing the PMECC if enabled. The function returns as soon as the device
+ * cache register is free again, while the array is still programming: the next
+ * page data transfer and PMECC computation overlap with the program time.
+ * A sequence must stay inside a block and end with 'last' set, which waits
+ * for the whole sequence to be programmed.
+ * As the device reports the status of the previous page of the sequence, a
+ * failure may concern the given page or the previous one.
+ * \param nand  Pointer to a struct _nand_flash instance.
+ * \param block  Number of the block where the page to write resides.
+ * \param page  Number of the page to write inside the given block.
+ * \param data  Buffer containing the data area.
+ * \param last  True for the last page of the sequence.
+ * \return 0 if the write operation is successful; otherwise returns
+ * NAND_ERROR_CANNOTWRITE.
+ */
+uint8_t nand_raw_write_page_cache(const struct _nand_flash *nand,
+		uint16_t block, uint16_t page, void *data, bool last)
+{
+	uint8_t program = last ? NAND_CMD_WRITE_2 : NAND_CMD_WRITE_CACHE;
+	uint8_t fail_mask = last ? NAND_STATUS_FAIL | NAND_STATUS_FAILC :
+		NAND_STATUS_FAILC;
+
+	NAND_TRACE("nand_raw_write_page_cache(B#%d:P#%d)\r\n", block, page);
+
+	assert(data);
+
+	if (nand_is_using_pmecc())
+		return _write_page_with_pmecc(nand, block, page, data,
+				program, fail_mask);
+
+	return _write_page(nand, block, page, data, NULL, program, fail_mask);
+}
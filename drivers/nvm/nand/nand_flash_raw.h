@@ -44,6 +44,7 @@
  * -# nand_raw_read_id() is used to read a NANDFLASH's id.
  * -# nand_raw_erase_block() is used to erase a certain NANDFLASH device's block.
  * -# nand_raw_read_page() and nand_raw_write_page is used to do read/write operation.
+ * -# nand_raw_write_page_cache() writes pages with the PAGE CACHE PROGRAM command.
  * -# nand_raw_copy_page() is used to issue copy-page command to NANDFLASH device.
  * -# nand_raw_copy_block() calls nand_raw_copy_page to do a NANDFLASH block copy.
 */
@@ -57,6 +58,7 @@
 /*------------------------------------------------------------------------------ */
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "gpio/pio.h"
 
@@ -84,6 +86,9 @@ extern uint8_t nand_raw_write_page(const struct _nand_flash *nand,
 		uint16_t block, uint16_t page,
 		void *data, void *spare);
 
+extern uint8_t nand_raw_write_page_cache(const struct _nand_flash *nand,
+		uint16_t block, uint16_t page, void *data, bool last);
+
 extern uint8_t nand_raw_copy_page(const struct _nand_flash *nand,
 		uint16_t source_block, uint16_t source_page,
 		uint16_t dest_block, uint16_t dest_page);
@@ -109,7 +109,6 @@ uint8_t nand_skipblock_erase_block(struct _nand_flash *nand,
 		uint16_t block, uint32_t erase_type)
 {
 	uint8_t error;
-	const struct _nand_spare_scheme *scheme;
 
 	if (erase_type != SCRUB_ERASE) {
 		/* Check block status */
@@ -124,18 +123,32 @@ uint8_t nand_skipblock_erase_block(struct _nand_flash *nand,
 	if (error) {
 		/* Try to mark the block as BAD */
 		trace_error("nand_skipblock_erase_block: Cannot erase block, try to mark it BAD\r\n");
-
-		/* Retrieve model scheme */
-		scheme = nand_model_get_scheme(&nand->model);
-
-		memset(spare_buf, 0xff, sizeof(spare_buf));
-		nand_spare_scheme_write_bad_block_marker(scheme, spare_buf, NANDBLOCK_STATUS_BAD);
-		return nand_raw_write_page(nand, block, 0, 0, spare_buf);
+		return nand_skipblock_mark_bad_block(nand, block);
 	}
 
 	return 0;
 }
 
+/**
+ * \brief Writes the bad block marker in the spare area of the first page of a
+ * block.
+ * \param nand  Pointer to a _raw_nand_flash instance.
+ * \param block  Number of block to mark.
+ * \return the nand_raw_write_page code.
+*/
+uint8_t nand_skipblock_mark_bad_block(const struct _nand_flash *nand,
+		uint16_t block)
+{
+	const struct _nand_spare_scheme *scheme;
+
+	/* Retrieve model scheme */
+	scheme = nand_model_get_scheme(&nand->model);
+
+	memset(spare_buf, 0xff, sizeof(spare_buf));
+	nand_spare_scheme_write_bad_block_marker(scheme, spare_buf, NANDBLOCK_STATUS_BAD);
+	return nand_raw_write_page(nand, block, 0, 0, spare_buf);
+}
+
 /**
  * \brief Reads the data and/or the spare area of a page on a SkipBlock nandflash. If
  * the data pointer is not 0, then the block MUST not be BAD
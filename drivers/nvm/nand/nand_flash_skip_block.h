@@ -90,6 +90,9 @@ extern uint8_t nand_skipblock_check_block(const struct _nand_flash *nand,
 extern uint8_t nand_skipblock_erase_block(struct _nand_flash *nand,
 		uint16_t block, uint32_t erase_type);
 
+extern uint8_t nand_skipblock_mark_bad_block(const struct _nand_flash *nand,
+		uint16_t block);
+
 extern uint8_t nand_skipblock_read_page(const struct _nand_flash *nand,
 		uint16_t block, uint16_t page,
 		void *data, void *spare);
@@ -243,6 +243,39 @@ static int _qspiflash_read_flag_status(const struct _qspiflash *flash, uint8_t *
 	}
 }
 
+/* Send the data of a page and start programming it, without waiting for the
+ * end of the operation. */
+static int _qspiflash_page_program(const struct _qspiflash *flash,
+		uint32_t addr, const void *data, uint32_t length)
+{
+	int ret;
+	struct _qspi_cmd cmd;
+
+	ret = _qspiflash_write_enable(flash);
+	if (ret < 0)
+		return ret;
+
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.ifr_type = QSPI_IFR_TFRTYP_TRSFR_WRITE_MEMORY;
+	cmd.ifr_width = flash->ifr_width_program;
+	cmd.enable.instruction = 1;
+	cmd.enable.address = flash->mode_addr4 ? 4 : 3;
+#ifdef CONFIG_HAVE_AESB
+	cmd.use_aesb = flash->use_aesb;
+#endif
+	cmd.enable.data = 1;
+	cmd.instruction = flash->opcode_page_program;
+	cmd.address = addr;
+	cmd.tx_buffer = data;
+	cmd.buffer_len = length;
+	cmd.timeout = TIMEOUT_DEFAULT;
+
+	if (!qspi_perform_command(flash->qspi, &cmd))
+		return -EIO;
+
+	return 0;
+}
+
 /*----------------------------------------------------------------------------
  *        Local Functions (convert opcode to its 4-byte address version)
  *----------------------------------------------------------------------------*/
@@ -941,23 +974,32 @@ int qspiflash_read_status(const struct _qspiflash *flash, uint8_t *status)
 	return _qspiflash_read_reg(flash, CMD_READ_STATUS, status, 1);
 }
 
+int qspiflash_check_ready(const struct _qspiflash *flash)
+{
+	int ret;
+	uint8_t status, flag_status;
+
+	ret = _qspiflash_read_flag_status(flash, &flag_status);
+	if (ret < 0)
+		return ret;
+	ret = qspiflash_read_status(flash, &status);
+	if (ret < 0)
+		return ret;
+
+	if (((status & SR_WIP) == 0) && ((flag_status & FSR_NBUSY) != 0))
+		return 0;
+
+	return -EBUSY;
+}
+
 int qspiflash_wait_ready(const struct _qspiflash *flash, uint32_t timeout)
 {
 	struct _timeout to;
 	timer_start_timeout(&to, timeout);
 	do {
-		int ret;
-		uint8_t status, flag_status;
-
-		ret = _qspiflash_read_flag_status(flash, &flag_status);
-		if (ret < 0)
-			return ret;
-		ret = qspiflash_read_status(flash, &status);
-		if (ret < 0)
+		int ret = qspiflash_check_ready(flash);
+		if (ret != -EBUSY)
 			return ret;
-
-		if (((status & SR_WIP) == 0) && ((flag_status & FSR_NBUSY) != 0))
-			return 0;
 	} while (!timer_timeout_reached(&to));
 
 	trace_debug("qspiflash_wait_ready timeout reached\r\n");
@@ -1037,7 +1079,9 @@ int qspiflash_erase_chip(const struct _qspiflash *flash)
 	return 0;
 }
 
-int qspiflash_erase_block(const struct _qspiflash *flash,
+/* Start erasing a block and return without waiting for the end of the erase
+ * (see qspiflash_check_ready and qspiflash_wait_ready). */
+int qspiflash_start_erase_block(const struct _qspiflash *flash,
 		uint32_t addr, uint32_t length)
 {
 	int ret;
@@ -1084,7 +1128,8 @@ int qspiflash_erase_block(const struct _qspiflash *flash,
 		return -EINVAL;
 	}
 
-	ret = qspiflash_wait_ready(flash, TIMEOUT_DEFAULT);
+	/* the previous operation may be an erase */
+	ret = qspiflash_wait_ready(flash, TIMEOUT_ERASE);
 	if (ret < 0)
 		return ret;
 
@@ -1106,6 +1151,18 @@ int qspiflash_erase_block(const struct _qspiflash *flash,
 	if (!qspi_perform_command(flash->qspi, &cmd))
 		return -EIO;
 
+	return 0;
+}
+
+int qspiflash_erase_block(const struct _qspiflash *flash,
+		uint32_t addr, uint32_t length)
+{
+	int ret;
+
+	ret = qspiflash_start_erase_block(flash, addr, length);
+	if (ret < 0)
+		return ret;
+
 	ret = qspiflash_wait_ready(flash, TIMEOUT_ERASE);
 	if (ret < 0)
 		return ret;
@@ -1113,11 +1170,31 @@ int qspiflash_erase_block(const struct _qspiflash *flash,
 	return 0;
 }
 
+/* Start programming data inside a page and return without waiting for the end
+ * of the program (see qspiflash_check_ready and qspiflash_wait_ready). */
+int qspiflash_start_page_program(const struct _qspiflash *flash,
+		uint32_t addr, const void *data, uint32_t length)
+{
+	int ret;
+
+	if (length == 0 ||
+	    (addr % flash->desc->page_size) + length > flash->desc->page_size) {
+		trace_error("qspiflash: program must fit in a page\r\n");
+		return -EINVAL;
+	}
+
+	/* the previous operation may be an erase */
+	ret = qspiflash_wait_ready(flash, TIMEOUT_ERASE);
+	if (ret < 0)
+		return ret;
+
+	return _qspiflash_page_program(flash, addr, data, length);
+}
+
 int qspiflash_write(const struct _qspiflash *flash, uint32_t addr,
 		const void *data, uint32_t length)
 {
 	int ret;
-	struct _qspi_cmd cmd;
 	uint32_t written = 0;
 	const uint8_t *ptr = data;
 
@@ -1132,28 +1209,10 @@ int qspiflash_write(const struct _qspiflash *flash, uint32_t addr,
 		/* number of bytes to write this round */
 		uint32_t count = min_u32(length - written, remaining);
 
-		ret = _qspiflash_write_enable(flash);
+		ret = _qspiflash_page_program(flash, addr, ptr, count);
 		if (ret < 0)
 			return ret;
 
-		memset(&cmd, 0, sizeof(cmd));
-		cmd.ifr_type = QSPI_IFR_TFRTYP_TRSFR_WRITE_MEMORY;
-		cmd.ifr_width = flash->ifr_width_program;
-		cmd.enable.instruction = 1;
-		cmd.enable.address = flash->mode_addr4 ? 4 : 3;
-#ifdef CONFIG_HAVE_AESB
-		cmd.use_aesb = flash->use_aesb;
-#endif
-		cmd.enable.data = 1;
-		cmd.instruction = flash->opcode_page_program;
-		cmd.address = addr;
-		cmd.tx_buffer = ptr;
-		cmd.buffer_len = count;
-		cmd.timeout = TIMEOUT_DEFAULT;
-
-		if (!qspi_perform_command(flash->qspi, &cmd))
-			return -EIO;
-
 		ret = qspiflash_wait_ready(flash, TIMEOUT_WRITE);
 		if (ret < 0)
 			return ret;
@@ -34,9 +34,11 @@
 #include <string.h>
 
 #include "callback.h"
+#include "chip.h"
 #include "dma/dma.h"
 #include "errno.h"
 #include "peripherals/bus.h"
+#include "power/clkmgr.h"
 #ifdef CONFIG_HAVE_BUS_SPI
 #include "spi/spid.h"
 #endif
@@ -88,6 +90,22 @@ static struct _bus_desc _bus[BUS_COUNT];
  *         Local functions
  *----------------------------------------------------------------------------*/
 
+static uint32_t _bus_get_periph_id(uint8_t bus_id)
+{
+	switch (_bus[bus_id].type) {
+#ifdef CONFIG_HAVE_SPI_BUS
+	case BUS_TYPE_SPI:
+		return get_spi_id_from_addr(_bus[bus_id].iface.spid.addr);
+#endif
+#ifdef CONFIG_HAVE_I2C_BUS
+	case BUS_TYPE_I2C:
+		return get_twi_id_from_addr(_bus[bus_id].iface.twid.addr);
+#endif
+	default:
+		return ID_PERIPH_COUNT;
+	}
+}
+
 static int _bus_callback(void* arg, void* arg2)
 {
 	uint32_t bus_id = (uint32_t)arg;
@@ -466,19 +484,35 @@ int bus_transfer(uint8_t bus_id, uint16_t remote, struct _buffer* buf, uint16_t
 
 int bus_start_transaction(uint8_t bus_id)
 {
+	uint32_t id;
+
 	if (bus_id >= BUS_COUNT)
 		return -ENODEV;
 
 	mutex_lock(&_bus[bus_id].mutex.transaction);
 
+	/* keep the controller clocked between the transfers of a transaction */
+	id = _bus_get_periph_id(bus_id);
+	if (id < ID_PERIPH_COUNT)
+		clkmgr_get(id);
+
 	return 0;
 }
 
 int bus_stop_transaction(uint8_t bus_id)
 {
+	uint32_t id;
+
 	if (bus_id >= BUS_COUNT)
 		return -ENODEV;
 
+	if (!mutex_is_locked(&_bus[bus_id].mutex.transaction))
+		return 0;
+
+	id = _bus_get_periph_id(bus_id);
+	if (id < ID_PERIPH_COUNT)
+		clkmgr_put(id);
+
 	mutex_unlock(&_bus[bus_id].mutex.transaction);
 
 	return 0;
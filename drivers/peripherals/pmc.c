@@ -775,6 +775,8 @@ void pmc_set_mck_prescaler(uint32_t prescaler)
 	/* Change MCK Prescaler divider in PMC_MCKR register */
 	PMC->PMC_MCKR = (PMC->PMC_MCKR & ~PMC_MCKR_PRES_Msk) | prescaler;
 	while (!(PMC->PMC_SR & PMC_SR_MCKRDY));
+
+	_pmc_mck = 0;
 }
 
 #ifdef CONFIG_HAVE_PMC_PLLADIV2
@@ -789,6 +791,8 @@ void pmc_set_mck_plladiv2(bool div2)
 			PMC->PMC_MCKR = mckr & ~PMC_MCKR_PLLADIV2;
 	}
 	while (!(PMC->PMC_SR & PMC_SR_MCKRDY));
+
+	_pmc_mck = 0;
 }
 #endif
 
@@ -804,6 +808,8 @@ void pmc_set_mck_uplldiv2(bool div2)
 			PMC->PMC_MCKR = mckr & ~PMC_MCKR_UPLLDIV2;
 	}
 	while (!(PMC->PMC_SR & PMC_SR_MCKRDY));
+
+	_pmc_mck = 0;
 }
 #endif
 
@@ -829,6 +835,8 @@ void pmc_set_mck_divider(uint32_t divider)
 	/* change MCK Prescaler divider in PMC_MCKR register */
 	PMC->PMC_MCKR = (PMC->PMC_MCKR & ~PMC_MCKR_MDIV_Msk) | divider;
 	while (!(PMC->PMC_SR & PMC_SR_MCKRDY));
+
+	_pmc_mck = 0;
 }
 
 void pmc_configure_plla(const struct _pmc_plla_cfg* plla)
@@ -849,6 +857,8 @@ void pmc_configure_plla(const struct _pmc_plla_cfg* plla)
 
 	if (plla->mul > 0)
 		while (!(PMC->PMC_SR & PMC_SR_LOCKA));
+
+	_pmc_mck = 0;
 }
 
 void pmc_disable_plla(void)
@@ -81,12 +81,14 @@
  *----------------------------------------------------------------------------*/
 
 #include <assert.h>
+#include <errno.h>
 #include <stdint.h>
 #include <string.h>
 
 #include "callback.h"
 #include "chip.h"
 #include "dma/dma.h"
+#include "irqflags.h"
 #include "mm/cache.h"
 #include "peripherals/pwmc.h"
 #include "trace.h"
@@ -306,6 +308,7 @@ static int _pwm_dma_callback_wrapper(void* arg, void* arg2)
 
 	if (dma_is_transfer_done(dma_channel)) {
 		dma_free_channel(dma_channel);
+		pwm_dma_channel = NULL;
 		callback_call(&pwmc_cb, NULL);
 	}
 
@@ -347,6 +350,177 @@ void pwmc_dma_duty_cycle(Pwm* pwm, uint16_t *duty, uint32_t size)
 	dma_start_transfer(pwm_dma_channel);
 }
 
+static int _pwmc_stream_dma_callback(void* arg, void* arg2);
+
+static void _pwmc_stream_transfer(struct _pwmc_stream* stream)
+{
+	struct _callback _cb;
+	struct _dma_cfg dma_cfg;
+	struct _dma_transfer_cfg cfg;
+
+	memset(&dma_cfg, 0, sizeof(dma_cfg));
+	cfg.saddr = stream->buffers[stream->playing];
+	cfg.daddr = (void*)&stream->pwm->PWM_DMAR;
+	cfg.len = stream->frames * stream->channels;
+	dma_cfg.incr_saddr = true;
+	dma_cfg.incr_daddr = false;
+	dma_cfg.data_width = DMA_DATA_WIDTH_HALF_WORD;
+	dma_cfg.chunk_size = DMA_CHUNK_SIZE_1;
+	dma_reset_channel(stream->dma_channel);
+	dma_configure_transfer(stream->dma_channel, &dma_cfg, &cfg, 1);
+	callback_set(&_cb, _pwmc_stream_dma_callback, stream);
+	dma_set_callback(stream->dma_channel, &_cb);
+	dma_start_transfer(stream->dma_channel);
+}
+
+static int _pwmc_stream_dma_callback(void* arg, void* arg2)
+{
+	struct _pwmc_stream* stream = (struct _pwmc_stream*)arg;
+	uint8_t next;
+
+	if (!stream->running)
+		return 0;
+
+	/* The PWM holds its DMA request until the next buffer is armed: the
+	 * channels keep their last duty, nothing glitches as long as this
+	 * runs within one update period. */
+	stream->completed++;
+	next = stream->playing ^ 1;
+	if (stream->ready & (1 << next)) {
+		stream->ready &= ~(1 << next);
+		stream->playing = next;
+	} else {
+		/* nothing committed, replay the current buffer */
+		stream->underruns++;
+	}
+	_pwmc_stream_transfer(stream);
+
+	next = stream->playing ^ 1;
+	if (!(stream->ready & (1 << next)))
+		callback_call(&stream->refill, stream->buffers[next]);
+
+	return 0;
+}
+
+int pwmc_stream_init(struct _pwmc_stream* stream, Pwm* pwm,
+		uint32_t sync_channels, uint16_t* buffer0, uint16_t* buffer1,
+		uint32_t frames, struct _callback* refill)
+{
+	uint32_t mask = sync_channels & (PWM_SCM_SYNC0 | PWM_SCM_SYNC1
+					 | PWM_SCM_SYNC2 | PWM_SCM_SYNC3);
+
+	if (!(mask & PWM_SCM_SYNC0) || mask != sync_channels)
+		return -EINVAL;
+	if (!buffer0 || !buffer1 || !frames)
+		return -EINVAL;
+
+	memset(stream, 0, sizeof(*stream));
+	stream->pwm = pwm;
+	stream->sync_channels = sync_channels;
+	stream->buffers[0] = buffer0;
+	stream->buffers[1] = buffer1;
+	stream->frames = frames;
+	for (; mask; mask &= mask - 1)
+		stream->channels++;
+	callback_copy(&stream->refill, refill);
+
+	return 0;
+}
+
+uint16_t* pwmc_stream_get_free_buffer(struct _pwmc_stream* stream)
+{
+	uint16_t* buffer = NULL;
+	uint32_t flags = arch_irq_save();
+	uint8_t free = stream->playing ^ 1;
+
+	if (!stream->running)
+		free = (stream->ready & 1) ? 1 : 0;
+	if (!(stream->ready & (1 << free)))
+		buffer = stream->buffers[free];
+	arch_irq_restore(flags);
+
+	return buffer;
+}
+
+int pwmc_stream_commit(struct _pwmc_stream* stream, uint16_t* buffer)
+{
+	uint32_t flags;
+	uint8_t index;
+
+	if (buffer == stream->buffers[0])
+		index = 0;
+	else if (buffer == stream->buffers[1])
+		index = 1;
+	else
+		return -EINVAL;
+
+	cache_clean_region(buffer, stream->frames * stream->channels
+			   * sizeof(uint16_t));
+
+	flags = arch_irq_save();
+	if (stream->running && stream->playing == index) {
+		arch_irq_restore(flags);
+		return -EBUSY;
+	}
+	stream->ready |= 1 << index;
+	arch_irq_restore(flags);
+
+	return 0;
+}
+
+int pwmc_stream_start(struct _pwmc_stream* stream, uint8_t update_period)
+{
+	Pwm* pwm = stream->pwm;
+
+	if (stream->running)
+		return -EBUSY;
+	if (!(stream->ready & 1))
+		return -EINVAL;
+
+	stream->dma_channel = dma_allocate_channel(DMA_PERIPH_MEMORY,
+			get_pwm_id_from_addr(pwm));
+	if (!stream->dma_channel)
+		return -EBUSY;
+
+	/* the synchronous channels must be disabled to be (re)defined */
+	pwmc_disable_channel(pwm, 0);
+	while (pwm->PWM_SR & stream->sync_channels);
+	pwmc_configure_sync_channels(pwm, PWM_SCM_UPDM_MODE2
+				     | stream->sync_channels);
+	pwmc_set_sync_channels_update_period(pwm, 0, update_period);
+
+	stream->ready &= ~1;
+	stream->playing = 0;
+	stream->completed = 0;
+	stream->underruns = 0;
+	stream->running = true;
+	_pwmc_stream_transfer(stream);
+
+	/* enabling channel 0 starts all the synchronous channels */
+	pwmc_enable_channel(pwm, 0);
+
+	return 0;
+}
+
+void pwmc_stream_set_update_period(struct _pwmc_stream* stream,
+		uint8_t update_period)
+{
+	pwmc_set_sync_channels_update_period_update(stream->pwm, update_period);
+}
+
+void pwmc_stream_stop(struct _pwmc_stream* stream)
+{
+	if (!stream->running)
+		return;
+
+	stream->running = false;
+	dma_stop_transfer(stream->dma_channel);
+	dma_free_channel(stream->dma_channel);
+	stream->dma_channel = NULL;
+	stream->ready = 0;
+	pwmc_disable_channel(stream->pwm, 0);
+}
+
 #endif /* CONFIG_HAVE_PWMC_DMA */
 
 #ifdef CONFIG_HAVE_PWMC_OOV
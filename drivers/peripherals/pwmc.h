@@ -43,6 +43,8 @@
  *    -# Enable & disable channel using pwmc_enable_channel() and pwmc_disable_channel().
  *    -# Enable & disable the period interrupt for the given PWM channel using
  *       pwmc_enable_channel_it() and pwmc_disable_channel_it().
+ *    -# Stream duty cycles to the synchronous channels with
+ *       pwmc_stream_init(), pwmc_stream_commit() and pwmc_stream_start().
  *
  */
 
@@ -53,11 +55,45 @@
  *        Headers
  *----------------------------------------------------------------------------*/
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "callback.h"
 #include "chip.h"
 
+#ifdef CONFIG_HAVE_PWMC_DMA
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct _dma_channel;
+
+/**
+ * PWM duty cycle stream.
+ *
+ * Two buffers of interleaved frames, one duty value per synchronous channel
+ * (in ascending channel order) in each frame, are played alternately by DMA
+ * into PWM_DMAR, one frame per update period. While a buffer plays, the
+ * other one is refilled and committed; if it is not committed in time the
+ * playing buffer is replayed, so a stream never refilled loops on its first
+ * buffer.
+ */
+struct _pwmc_stream {
+	Pwm *pwm;
+	struct _dma_channel *dma_channel;
+	uint32_t sync_channels;     /**< bitmap of PWM_SCM_SYNCx */
+	uint16_t *buffers[2];       /**< frames * channels duty values each */
+	uint32_t frames;            /**< frames per buffer */
+	uint8_t channels;           /**< duty values per frame */
+	struct _callback refill;    /**< called with the free buffer as arg2 */
+	volatile uint8_t playing;   /**< index of the buffer being played */
+	volatile uint8_t ready;     /**< bitmap of the committed buffers */
+	volatile bool running;
+	volatile uint32_t completed; /**< buffers played */
+	volatile uint32_t underruns; /**< buffers replayed for lack of data */
+};
+#endif /* CONFIG_HAVE_PWMC_DMA */
+
 /*----------------------------------------------------------------------------
  *        Macros
  *----------------------------------------------------------------------------*/
@@ -260,6 +296,75 @@ extern void pwmc_set_dma_finished_callback(Pwm *pwm, struct _callback* cb);
  */
 extern void pwmc_dma_duty_cycle(Pwm *pwm, uint16_t *duty, uint32_t size);
 
+/**
+ * \brief Initialize a duty cycle stream.
+ *
+ * Nothing is programmed in the PWM until pwmc_stream_start(). The refill
+ * callback, if any, runs in the DMA interrupt each time a buffer is free; it
+ * may fill and commit it right away.
+ *
+ * \param stream Pointer to the stream to initialize.
+ * \param pwm Pointer to a Pwm instance.
+ * \param sync_channels Bitmap of PWM_SCM_SYNCx, must include channel 0.
+ * \param buffer0 First duty buffer, cache aligned.
+ * \param buffer1 Second duty buffer, cache aligned.
+ * \param frames Number of frames in each buffer.
+ * \param refill Refill callback, or NULL.
+ * \return 0 on success, -EINVAL on invalid parameters.
+ */
+extern int pwmc_stream_init(struct _pwmc_stream* stream, Pwm* pwm,
+		uint32_t sync_channels, uint16_t* buffer0, uint16_t* buffer1,
+		uint32_t frames, struct _callback* refill);
+
+/**
+ * \brief Get the buffer to fill next.
+ * \param stream Pointer to a stream.
+ * \return the free buffer, NULL if it is already committed.
+ */
+extern uint16_t* pwmc_stream_get_free_buffer(struct _pwmc_stream* stream);
+
+/**
+ * \brief Hand a filled buffer over to the stream.
+ * \param stream Pointer to a stream.
+ * \param buffer Buffer returned by pwmc_stream_get_free_buffer().
+ * \return 0 on success, -EINVAL if buffer does not belong to the stream,
+ * -EBUSY if it is being played.
+ */
+extern int pwmc_stream_commit(struct _pwmc_stream* stream, uint16_t* buffer);
+
+/**
+ * \brief Start a stream.
+ *
+ * The first buffer must have been committed. The channels must have been
+ * configured (mode, period) by the caller; they are made synchronous and
+ * started with the stream.
+ *
+ * \param stream Pointer to a stream.
+ * \param update_period Number of channel periods between two frames, minus
+ * one (0..15).
+ * \return 0 on success, -EINVAL if the first buffer is not committed,
+ * -EBUSY if the stream is running or no DMA channel is available.
+ */
+extern int pwmc_stream_start(struct _pwmc_stream* stream, uint8_t update_period);
+
+/**
+ * \brief Change the frame rate of a running stream.
+ *
+ * The new update period takes effect at the end of the current one.
+ *
+ * \param stream Pointer to a stream.
+ * \param update_period Number of channel periods between two frames, minus
+ * one (0..15).
+ */
+extern void pwmc_stream_set_update_period(struct _pwmc_stream* stream,
+		uint8_t update_period);
+
+/**
+ * \brief Stop a stream and disable its channels.
+ * \param stream Pointer to a stream.
+ */
+extern void pwmc_stream_stop(struct _pwmc_stream* stream);
+
 #endif /* CONFIG_HAVE_PWMC_DMA */
 
 #ifdef CONFIG_HAVE_PWMC_OOV
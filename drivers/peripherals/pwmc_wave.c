@@ -0,0 +1,166 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "peripherals/pwmc_wave.h"
+
+/*----------------------------------------------------------------------------
+ *        Local constants
+ *----------------------------------------------------------------------------*/
+
+/** sin(i * pi / 128) in Q15, i = 0..64 */
+static const int16_t _quarter_sine[65] = {
+	    0,   804,  1608,  2411,  3212,  4011,  4808,  5602,
+	 6393,  7180,  7962,  8740,  9512, 10279, 11039, 11793,
+	12540, 13279, 14010, 14733, 15447, 16151, 16846, 17531,
+	18205, 18868, 19520, 20160, 20788, 21403, 22006, 22595,
+	23170, 23732, 24279, 24812, 25330, 25833, 26320, 26791,
+	27246, 27684, 28106, 28511, 28899, 29269, 29622, 29957,
+	30274, 30572, 30853, 31114, 31357, 31581, 31786, 31972,
+	32138, 32286, 32413, 32522, 32610, 32679, 32729, 32758,
+	32767,
+};
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static int32_t _pwmc_wave_sample(uint8_t shape, uint32_t phase)
+{
+	uint32_t t;
+
+	switch (shape) {
+	case PWMC_WAVE_RAMP:
+		return (int32_t)(phase >> 16) - 32768;
+	case PWMC_WAVE_TRIANGLE:
+		t = phase >> 15;
+		if (t < 65536)
+			return (int32_t)t - 32768;
+		return 98303 - (int32_t)t;
+	default:
+		return pwmc_wave_sin(phase);
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int16_t pwmc_wave_sin(uint32_t phase)
+{
+	uint32_t pos = phase & 0x3fffffff;
+	uint32_t idx, frac;
+	int32_t value;
+
+	/* second and fourth quadrants run the table backwards */
+	if (phase & 0x40000000)
+		pos = 0x40000000 - pos;
+	idx = pos >> 24;
+	frac = (pos >> 8) & 0xffff;
+	value = _quarter_sine[idx];
+	if (idx < 64)
+		value += ((_quarter_sine[idx + 1] - value) * (int32_t)frac + 0x8000) >> 16;
+
+	return (int16_t)((phase & 0x80000000) ? -value : value);
+}
+
+uint32_t pwmc_wave_phase_step(uint32_t freq_mhz, uint32_t frame_rate)
+{
+	assert(frame_rate);
+
+	return (uint32_t)(((uint64_t)freq_mhz << 32) /
+			((uint64_t)frame_rate * 1000));
+}
+
+void pwmc_wave_fill(struct _pwmc_wave* wave, uint16_t* frames, uint32_t count)
+{
+	int32_t values[PWMC_WAVE_MAX_CHANNELS];
+	uint32_t phase = wave->phase;
+	uint32_t i;
+	uint8_t c;
+
+	assert(wave->channels > 0 && wave->channels <= PWMC_WAVE_MAX_CHANNELS);
+
+	for (i = 0; i < count; i++) {
+		for (c = 0; c < wave->channels; c++) {
+			int32_t s = _pwmc_wave_sample(wave->shape,
+					phase + c * wave->spread);
+			values[c] = (s * wave->amplitude) >> 15;
+		}
+
+		if (wave->shape == PWMC_WAVE_SVPWM) {
+			/* shift the common mode to center the extreme
+			 * phases, equivalent to space vector modulation for
+			 * three phases, with 15% more headroom than sine */
+			int32_t lo = values[0], hi = values[0];
+			for (c = 1; c < wave->channels; c++) {
+				if (values[c] < lo)
+					lo = values[c];
+				if (values[c] > hi)
+					hi = values[c];
+			}
+			for (c = 0; c < wave->channels; c++)
+				values[c] -= (lo + hi) / 2;
+		}
+
+		for (c = 0; c < wave->channels; c++) {
+			int32_t v = values[c];
+			if (v < -32768)
+				v = -32768;
+			else if (v > 32768)
+				v = 32768;
+			*frames++ = (uint16_t)(((uint32_t)wave->period *
+					(uint32_t)(v + 32768) + 0x8000) >> 16);
+		}
+
+		phase += wave->step;
+	}
+
+	wave->phase = phase;
+}
+
+void pwmc_wave_interleave(uint16_t* frames, uint8_t channels,
+		uint8_t channel, const uint16_t* samples, uint32_t count)
+{
+	uint32_t i;
+
+	assert(channel < channels);
+
+	frames += channel;
+	for (i = 0; i < count; i++) {
+		*frames = samples[i];
+		frames += channels;
+	}
+}
@@ -0,0 +1,155 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * \par Purpose
+ *
+ * Fixed-point waveform generators for PWM duty cycle streaming.
+ *
+ * \par Usage
+ *
+ *    -# Describe the waveform in a struct _pwmc_wave: shape, number of
+ *       channels in a frame, channel period, modulation depth and phase
+ *       advance per frame (see pwmc_wave_phase_step()).
+ *    -# Call pwmc_wave_fill() to render consecutive frames into a duty
+ *       buffer, as expected by the PWM DMA (one duty value per synchronous
+ *       channel in each frame). The phase is kept in the structure, so
+ *       consecutive calls produce a continuous waveform.
+ *    -# Arbitrary per-channel tables can be packed into frames with
+ *       pwmc_wave_interleave().
+ *
+ * All computations are integer only: the phase is a 32-bit turn fraction,
+ * samples are Q15 and duties are scaled to the channel period.
+ */
+
+#ifndef PWMC_WAVE_H_
+#define PWMC_WAVE_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Macros
+ *----------------------------------------------------------------------------*/
+
+/** Unit modulation depth */
+#define PWMC_WAVE_Q15_ONE (1u << 15)
+
+/** Maximum number of channels in a frame */
+#define PWMC_WAVE_MAX_CHANNELS 8
+
+/** Phase of a turn fraction, e.g. PWMC_WAVE_PHASE(1, 3) for 120 degrees */
+#define PWMC_WAVE_PHASE(num, den) \
+	((uint32_t)(((uint64_t)(num) << 32) / (den)))
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+enum _pwmc_wave_shape {
+	PWMC_WAVE_SINE,     /**< sine */
+	PWMC_WAVE_SVPWM,    /**< sine with min-max common mode injection */
+	PWMC_WAVE_RAMP,     /**< rising sawtooth */
+	PWMC_WAVE_TRIANGLE, /**< triangle */
+};
+
+struct _pwmc_wave {
+	uint8_t shape;       /**< enum _pwmc_wave_shape */
+	uint8_t channels;    /**< duty values per frame */
+	uint16_t period;     /**< channel period, duties span 0..period */
+	uint16_t amplitude;  /**< modulation depth, Q15 */
+	uint32_t phase;      /**< current phase, a full turn is 2^32 */
+	uint32_t step;       /**< phase advance per frame */
+	uint32_t spread;     /**< phase offset between consecutive channels */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Q15 sine of a phase.
+ *
+ * Quarter wave table with linear interpolation, the error is below 3 LSB.
+ *
+ * \param phase  Phase, a full turn is 2^32.
+ * \return sine value, -32767..32767.
+ */
+extern int16_t pwmc_wave_sin(uint32_t phase);
+
+/**
+ * \brief Compute the phase advance per frame of a waveform.
+ *
+ * \param freq_mhz  Waveform frequency in mHz.
+ * \param frame_rate  Frame rate in Hz (channel frequency divided by the
+ * update period).
+ * \return phase step for struct _pwmc_wave.
+ */
+extern uint32_t pwmc_wave_phase_step(uint32_t freq_mhz, uint32_t frame_rate);
+
+/**
+ * \brief Render frames of a waveform.
+ *
+ * Channel c of each frame is the waveform at phase + c * spread, centered
+ * on period / 2 and scaled by the amplitude. Duties are clamped to
+ * 0..period. The phase is advanced by count * step.
+ *
+ * \param wave  Waveform description and state.
+ * \param frames  Destination buffer, count * wave->channels duty values.
+ * \param count  Number of frames to render.
+ */
+extern void pwmc_wave_fill(struct _pwmc_wave* wave, uint16_t* frames,
+		uint32_t count);
+
+/**
+ * \brief Pack a per-channel table into interleaved frames.
+ *
+ * \param frames  Destination buffer, count * channels duty values.
+ * \param channels  Number of duty values per frame.
+ * \param channel  Position of the channel in the frame.
+ * \param samples  Duty values of the channel.
+ * \param count  Number of frames.
+ */
+extern void pwmc_wave_interleave(uint16_t* frames, uint8_t channels,
+		uint8_t channel, const uint16_t* samples, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWMC_WAVE_H_ */
@@ -0,0 +1,199 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <string.h>
+
+#include "chip.h"
+#include "irqflags.h"
+#include "peripherals/pmc.h"
+#include "power/clkmgr.h"
+#include "timer.h"
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define CLKMGR_FLAG_MANAGED (1u << 0)
+#define CLKMGR_FLAG_ENABLED (1u << 1)
+#define CLKMGR_FLAG_GCK     (1u << 2) /**< GCK to restore when enabling */
+
+struct _clkmgr_clock {
+	uint8_t flags;
+	uint16_t refcount;
+	uint32_t gate_count;
+	uint64_t idle_since; /**< time of the last clkmgr_put() (ms) */
+	uint64_t on_since;   /**< time the clock was last enabled (ms) */
+	uint64_t on_time;    /**< cumulated enabled time until on_since (ms) */
+};
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct {
+	uint32_t timeout;
+	struct _clkmgr_clock clocks[ID_PERIPH_COUNT];
+} _clkmgr = {
+	.timeout = CLKMGR_DEFAULT_TIMEOUT,
+};
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _clkmgr_enable(uint32_t id, struct _clkmgr_clock* clk, uint64_t now)
+{
+	pmc_enable_peripheral(id);
+#ifdef CONFIG_HAVE_PMC_GENERATED_CLOCKS
+	if (clk->flags & CLKMGR_FLAG_GCK)
+		pmc_enable_gck(id);
+#endif
+	clk->flags |= CLKMGR_FLAG_ENABLED;
+	clk->on_since = now;
+}
+
+static void _clkmgr_gate(uint32_t id, struct _clkmgr_clock* clk, uint64_t now)
+{
+	clk->flags &= ~CLKMGR_FLAG_GCK;
+#ifdef CONFIG_HAVE_PMC_GENERATED_CLOCKS
+	if (pmc_is_gck_enabled(id)) {
+		pmc_disable_gck(id);
+		clk->flags |= CLKMGR_FLAG_GCK;
+	}
+#endif
+	pmc_disable_peripheral(id);
+	clk->flags &= ~CLKMGR_FLAG_ENABLED;
+	clk->on_time += now - clk->on_since;
+	clk->gate_count++;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void clkmgr_set_timeout(uint32_t timeout)
+{
+	_clkmgr.timeout = timeout;
+}
+
+void clkmgr_get(uint32_t id)
+{
+	struct _clkmgr_clock* clk;
+	uint64_t now;
+	uint32_t flags;
+
+	assert(id < ID_PERIPH_COUNT);
+	clk = &_clkmgr.clocks[id];
+
+	flags = arch_irq_save();
+	now = timer_get_tick();
+	if (!(clk->flags & CLKMGR_FLAG_MANAGED)) {
+		clk->flags = CLKMGR_FLAG_MANAGED;
+		if (pmc_is_peripheral_enabled(id)) {
+			clk->flags |= CLKMGR_FLAG_ENABLED;
+			clk->on_since = now;
+		}
+	}
+	if (!(clk->flags & CLKMGR_FLAG_ENABLED))
+		_clkmgr_enable(id, clk, now);
+	clk->refcount++;
+	arch_irq_restore(flags);
+}
+
+void clkmgr_put(uint32_t id)
+{
+	struct _clkmgr_clock* clk;
+	uint64_t now;
+	uint32_t flags;
+
+	assert(id < ID_PERIPH_COUNT);
+	clk = &_clkmgr.clocks[id];
+
+	flags = arch_irq_save();
+	now = timer_get_tick();
+	assert(clk->refcount > 0);
+	if (clk->refcount > 0 && --clk->refcount == 0) {
+		clk->idle_since = now;
+		if (_clkmgr.timeout == 0)
+			_clkmgr_gate(id, clk, now);
+	}
+	arch_irq_restore(flags);
+}
+
+int clkmgr_poll(void)
+{
+	uint64_t now;
+	uint32_t id, flags;
+	int gated = 0;
+
+	for (id = 0; id < ID_PERIPH_COUNT; id++) {
+		struct _clkmgr_clock* clk = &_clkmgr.clocks[id];
+
+		if ((clk->flags & (CLKMGR_FLAG_MANAGED | CLKMGR_FLAG_ENABLED)) !=
+				(CLKMGR_FLAG_MANAGED | CLKMGR_FLAG_ENABLED))
+			continue;
+
+		flags = arch_irq_save();
+		now = timer_get_tick();
+		if ((clk->flags & CLKMGR_FLAG_ENABLED) && clk->refcount == 0 &&
+				(now - clk->idle_since) >= _clkmgr.timeout) {
+			_clkmgr_gate(id, clk, now);
+			gated++;
+		}
+		arch_irq_restore(flags);
+	}
+
+	return gated;
+}
+
+void clkmgr_get_stats(uint32_t id, struct _clkmgr_stats* stats)
+{
+	struct _clkmgr_clock* clk;
+	uint64_t now;
+	uint32_t flags;
+
+	assert(id < ID_PERIPH_COUNT);
+	clk = &_clkmgr.clocks[id];
+
+	flags = arch_irq_save();
+	now = timer_get_tick();
+	stats->managed = (clk->flags & CLKMGR_FLAG_MANAGED) != 0;
+	stats->enabled = (clk->flags & CLKMGR_FLAG_ENABLED) != 0;
+	stats->refcount = clk->refcount;
+	stats->gate_count = clk->gate_count;
+	stats->on_time = clk->on_time;
+	if (stats->enabled)
+		stats->on_time += now - clk->on_since;
+	arch_irq_restore(flags);
+}
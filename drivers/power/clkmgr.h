@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _CLKMGR_H_
+#define _CLKMGR_H_
+
+/**
+ * \file
+ *
+ * Peripheral clock manager.
+ *
+ * Drivers take a reference on the clock of a peripheral with clkmgr_get()
+ * before touching its registers or starting a transfer, and drop it with
+ * clkmgr_put() when the transfer completes (both may be called from
+ * interrupt context). A peripheral becomes managed on its first
+ * clkmgr_get(); other peripherals keep the state set by
+ * pmc_configure_peripheral().
+ *
+ * When the last reference is dropped, the peripheral clock (and its
+ * generated clock, if enabled) is gated once the idle timeout has elapsed.
+ * Delayed gating is performed by clkmgr_poll(), which the application calls
+ * from its main loop or idle hook. With a timeout of 0 the clock is gated
+ * immediately on the last clkmgr_put(). The registers of a gated peripheral
+ * keep their content.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Default delay between the last clkmgr_put() and clock gating (ms) */
+#define CLKMGR_DEFAULT_TIMEOUT 10
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Per-peripheral clock statistics */
+struct _clkmgr_stats {
+	/** Peripheral is managed (clkmgr_get() was called at least once) */
+	bool managed;
+
+	/** Clock currently enabled */
+	bool enabled;
+
+	/** Current number of references */
+	uint32_t refcount;
+
+	/** Number of times the clock was gated */
+	uint32_t gate_count;
+
+	/** Time the clock was enabled since the peripheral became managed (ms) */
+	uint64_t on_time;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Set the delay between the last clkmgr_put() and clock gating
+ * \param timeout Idle timeout in ms, 0 to gate on the last clkmgr_put()
+ */
+extern void clkmgr_set_timeout(uint32_t timeout);
+
+/**
+ * \brief Take a reference on the clock of a peripheral, enabling it if
+ * it was gated
+ * \param id Peripheral ID (ID_xxx)
+ */
+extern void clkmgr_get(uint32_t id);
+
+/**
+ * \brief Drop a reference on the clock of a peripheral
+ * \param id Peripheral ID (ID_xxx)
+ */
+extern void clkmgr_put(uint32_t id);
+
+/**
+ * \brief Gate the clocks of the peripherals idle for longer than the
+ * timeout
+ * \return number of clocks gated
+ */
+extern int clkmgr_poll(void);
+
+/**
+ * \brief Get the statistics of a peripheral clock
+ * \param id Peripheral ID (ID_xxx)
+ * \param stats Filled with the current statistics
+ */
+extern void clkmgr_get_stats(uint32_t id, struct _clkmgr_stats* stats);
+
+#endif /* _CLKMGR_H_ */
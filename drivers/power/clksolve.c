@@ -0,0 +1,497 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <string.h>
+
+#include "errno.h"
+#include "power/clksolve.h"
+
+/*----------------------------------------------------------------------------
+ *        Local constants
+ *----------------------------------------------------------------------------*/
+
+/* Values from the device datasheets, checked against the board defaults */
+
+static const struct _clksolve_audio_limits _sama5d2_audio = {
+	.vco_min = 650000000,
+	.vco_max = 750000000,
+	.nd_max = 127,
+	.qdpmc_max = 127,
+	.qdaudio_max = 31,
+	.pmc_max = 125000000,
+	.pad_min = 8000000,
+	.pad_max = 48000000,
+};
+
+static const struct _clksolve_soc _socs[] = {
+	{
+		.name = "sama5d2",
+		.cpu = {
+			.pll_min = 400000000, .pll_max = 1200000000,
+			.mul_max = 127, .div_max = 1,
+			.has_div2 = true, .has_pres3 = false,
+			.pck_max = 500000000, .mck_max = 166000000,
+			.h32mx_max = 83000000,
+		},
+		.audio = &_sama5d2_audio,
+	},
+	{
+		.name = "sama5d3",
+		.cpu = {
+			.pll_min = 400000000, .pll_max = 1000000000,
+			.mul_max = 127, .div_max = 1,
+			.has_div2 = true, .has_pres3 = false,
+			.pck_max = 536000000, .mck_max = 166000000,
+			.h32mx_max = 0,
+		},
+		.audio = NULL,
+	},
+	{
+		.name = "sama5d4",
+		.cpu = {
+			.pll_min = 400000000, .pll_max = 1200000000,
+			.mul_max = 127, .div_max = 1,
+			.has_div2 = true, .has_pres3 = false,
+			.pck_max = 600000000, .mck_max = 200000000,
+			.h32mx_max = 100000000,
+		},
+		.audio = NULL,
+	},
+	{
+		.name = "sam9xx5",
+		.cpu = {
+			.pll_min = 400000000, .pll_max = 800000000,
+			.mul_max = 254, .div_max = 255,
+			.has_div2 = true, .has_pres3 = true,
+			.pck_max = 400000000, .mck_max = 133333334,
+			.h32mx_max = 0,
+		},
+		.audio = NULL,
+	},
+};
+
+#if defined(CONFIG_SOC_SAMA5D2)
+#define CLKSOLVE_SOC_NAME "sama5d2"
+#elif defined(CONFIG_SOC_SAMA5D3)
+#define CLKSOLVE_SOC_NAME "sama5d3"
+#elif defined(CONFIG_SOC_SAMA5D4)
+#define CLKSOLVE_SOC_NAME "sama5d4"
+#elif defined(CONFIG_SOC_SAM9XX5)
+#define CLKSOLVE_SOC_NAME "sam9xx5"
+#else
+#define CLKSOLVE_SOC_NAME NULL
+#endif
+
+static const uint32_t _prescalers[] = { 1, 2, 3, 4, 8, 16, 32, 64 };
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint64_t _abs_diff(uint64_t a, uint64_t b)
+{
+	return a > b ? a - b : b - a;
+}
+
+/** Error in parts per billion, used to compare candidates */
+static uint64_t _error_ppb(uint64_t freq, uint64_t target)
+{
+	return (_abs_diff(freq, target) * 1000000000ull) / target;
+}
+
+static uint64_t _div_round(uint64_t num, uint64_t den)
+{
+	return (num + den / 2) / den;
+}
+
+/**
+ * \brief Evaluate an audio PLL VCO target: compute ND/FRACR, then the best
+ * post-dividers for the PMC and pad clocks.
+ * \return score (sum of the errors in ppb), UINT64_MAX if not valid
+ */
+static uint64_t _audio_eval(const struct _clksolve_audio_limits* limits,
+		uint32_t in, uint64_t vco_target, uint32_t pmc, uint32_t pad,
+		struct _clksolve_audio* sol)
+{
+	uint64_t n1, fracr, vco;
+	uint64_t score = 0;
+
+	n1 = vco_target / in;
+	fracr = _div_round((vco_target - n1 * in) << CLKSOLVE_AUDIO_FRACR_BITS, in);
+	if (fracr >= (1ull << CLKSOLVE_AUDIO_FRACR_BITS)) {
+		n1++;
+		fracr = 0;
+	}
+	if (n1 < 1 || n1 - 1 > limits->nd_max)
+		return UINT64_MAX;
+
+	/* same computation as pmc_get_audio_pmc_clock() */
+	vco = ((uint64_t)in * ((n1 << CLKSOLVE_AUDIO_FRACR_BITS) + fracr)) >> CLKSOLVE_AUDIO_FRACR_BITS;
+	if (vco < limits->vco_min || vco > limits->vco_max)
+		return UINT64_MAX;
+
+	memset(sol, 0, sizeof(*sol));
+	sol->nd = (uint32_t)(n1 - 1);
+	sol->fracr = (uint32_t)fracr;
+	sol->vco = (uint32_t)vco;
+
+	if (pmc) {
+		uint64_t best = UINT64_MAX;
+		uint64_t q = _div_round(vco, pmc);
+		uint64_t d;
+
+		for (d = q > 1 ? q - 1 : 1; d <= q + 1 && d <= limits->qdpmc_max + 1; d++) {
+			uint64_t freq = vco / d;
+			uint64_t err;
+
+			if (freq > limits->pmc_max)
+				continue;
+			err = _error_ppb(freq, pmc);
+			if (err < best) {
+				best = err;
+				sol->qdpmc = (uint32_t)(d - 1);
+				sol->pmc = (uint32_t)freq;
+			}
+		}
+		if (best == UINT64_MAX)
+			return UINT64_MAX;
+		sol->pmc_error = clksolve_error_ppm(sol->pmc, pmc);
+		score += best;
+	} else {
+		/* PMC clock unused: keep it as slow as possible */
+		sol->qdpmc = limits->qdpmc_max;
+		sol->pmc = (uint32_t)(vco / (limits->qdpmc_max + 1));
+	}
+
+	if (pad) {
+		uint64_t best = UINT64_MAX;
+		uint32_t div, qd;
+
+		for (div = 2; div <= 3; div++) {
+			for (qd = 1; qd <= limits->qdaudio_max; qd++) {
+				uint64_t freq = vco / (div * qd);
+				uint64_t err;
+
+				if (freq < limits->pad_min || freq > limits->pad_max)
+					continue;
+				err = _error_ppb(freq, pad);
+				if (err < best) {
+					best = err;
+					sol->div = div;
+					sol->qdaudio = qd;
+					sol->pad = (uint32_t)freq;
+				}
+			}
+		}
+		if (best == UINT64_MAX)
+			return UINT64_MAX;
+		sol->pad_error = clksolve_error_ppm(sol->pad, pad);
+		score += best;
+	}
+
+	return score;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+const struct _clksolve_soc* clksolve_get_soc(const char* name)
+{
+	int i;
+
+	if (!name)
+		name = CLKSOLVE_SOC_NAME;
+	if (!name)
+		return NULL;
+
+	for (i = 0; i < (int)(sizeof(_socs) / sizeof(_socs[0])); i++)
+		if (!strcmp(_socs[i].name, name))
+			return &_socs[i];
+
+	return NULL;
+}
+
+uint32_t clksolve_error_ppm(uint64_t freq, uint64_t target)
+{
+	uint64_t diff = _abs_diff(freq, target);
+
+	if (target == 0)
+		return freq ? UINT32_MAX : 0;
+	return (uint32_t)((diff * 1000000ull + target - 1) / target);
+}
+
+int clksolve_cpu(const struct _clksolve_cpu_limits* limits, uint32_t in,
+		uint32_t pck, uint32_t mck, uint32_t tolerance,
+		struct _clksolve_cpu* sol)
+{
+	struct _clksolve_cpu cur;
+	uint64_t best_pck = UINT64_MAX, best_mck = UINT64_MAX;
+	uint32_t best_pll = UINT32_MAX;
+	uint32_t d2, p, div, mdiv;
+
+	if (in == 0 || pck == 0)
+		return -EINVAL;
+
+	/* on equal results, prefer PLLADIV2 to the prescaler like the boards do */
+	for (d2 = limits->has_div2 ? 2 : 1; d2 >= 1; d2--) {
+		for (p = 0; p < sizeof(_prescalers) / sizeof(_prescalers[0]); p++) {
+			uint32_t pres = _prescalers[p];
+
+			if (pres == 3 && !limits->has_pres3)
+				continue;
+
+			for (div = 1; div <= limits->div_max; div++) {
+				uint64_t pll_target = (uint64_t)pck * pres * d2;
+				uint64_t m1 = _div_round(pll_target * div, in);
+				uint64_t pll, freq;
+
+				if (m1 < 2 || m1 - 1 > limits->mul_max)
+					continue;
+
+				/* same computation as pmc_get_plla_clock() */
+				pll = (uint64_t)in * m1 / div;
+				if (pll < limits->pll_min || pll > limits->pll_max)
+					continue;
+				freq = pll / d2 / pres;
+				if (freq > limits->pck_max)
+					continue;
+
+				cur.mul = (uint32_t)(m1 - 1);
+				cur.div = div;
+				cur.div2 = d2 == 2;
+				cur.pres = pres;
+				cur.pll = (uint32_t)pll;
+				cur.pck = (uint32_t)freq;
+
+				for (mdiv = 1; mdiv <= 4; mdiv++) {
+					uint64_t err_pck = _error_ppb(cur.pck, pck);
+					uint64_t err_mck;
+
+					cur.mck = cur.pck / mdiv;
+					if (cur.mck > limits->mck_max)
+						continue;
+					cur.mdiv = mdiv;
+					cur.h32mx_div2 = limits->h32mx_max && cur.mck > limits->h32mx_max;
+					if (cur.h32mx_div2 && cur.mck / 2 > limits->h32mx_max)
+						continue;
+
+					if (mck)
+						err_mck = _error_ppb(cur.mck, mck);
+					else
+						err_mck = limits->mck_max - cur.mck;
+
+					if (err_pck < best_pck ||
+					    (err_pck == best_pck && err_mck < best_mck) ||
+					    (err_pck == best_pck && err_mck == best_mck && cur.pll < best_pll)) {
+						best_pck = err_pck;
+						best_mck = err_mck;
+						best_pll = cur.pll;
+						*sol = cur;
+					}
+				}
+			}
+		}
+	}
+
+	if (best_pck == UINT64_MAX)
+		return -ERANGE;
+
+	sol->pck_error = clksolve_error_ppm(sol->pck, pck);
+	sol->mck_error = mck ? clksolve_error_ppm(sol->mck, mck) : 0;
+	if (sol->pck_error > tolerance || sol->mck_error > tolerance)
+		return -ERANGE;
+
+	return 0;
+}
+
+int clksolve_audio(const struct _clksolve_audio_limits* limits,
+		uint32_t in, uint32_t pmc, uint32_t pad, uint32_t tolerance,
+		struct _clksolve_audio* sol)
+{
+	struct _clksolve_audio cur;
+	uint64_t best = UINT64_MAX;
+	uint32_t q, div;
+
+	if (in == 0 || (pmc == 0 && pad == 0))
+		return -EINVAL;
+
+	/* candidate VCO frequencies are the exact multiples of the targets
+	 * reachable with the post-dividers */
+	if (pmc) {
+		for (q = 1; q <= limits->qdpmc_max + 1; q++) {
+			uint64_t score = _audio_eval(limits, in, (uint64_t)pmc * q, pmc, pad, &cur);
+
+			if (score != UINT64_MAX &&
+			    (score < best || (score == best && cur.vco < sol->vco))) {
+				best = score;
+				*sol = cur;
+			}
+		}
+	}
+	if (pad) {
+		for (div = 2; div <= 3; div++) {
+			for (q = 1; q <= limits->qdaudio_max; q++) {
+				uint64_t score = _audio_eval(limits, in, (uint64_t)pad * div * q, pmc, pad, &cur);
+
+				if (score != UINT64_MAX &&
+			    (score < best || (score == best && cur.vco < sol->vco))) {
+					best = score;
+					*sol = cur;
+				}
+			}
+		}
+	}
+
+	if (best == UINT64_MAX)
+		return -ERANGE;
+	if (sol->pmc_error > tolerance || sol->pad_error > tolerance)
+		return -ERANGE;
+
+	return 0;
+}
+
+int clksolve_gck(const uint32_t sources[CLKSOLVE_GCK_SOURCES],
+		uint32_t max, uint32_t target, uint32_t tolerance,
+		struct _clksolve_gck* sol)
+{
+	uint64_t best = UINT64_MAX;
+	uint32_t src, best_src_freq = UINT32_MAX;
+
+	if (target == 0)
+		return -EINVAL;
+
+	for (src = 0; src < CLKSOLVE_GCK_SOURCES; src++) {
+		uint32_t freq = sources[src];
+		uint32_t div, d;
+
+		if (freq == 0)
+			continue;
+
+		div = (uint32_t)_div_round(freq, target);
+		for (d = div > 1 ? div - 1 : 1; d <= div + 1 && d <= 256; d++) {
+			uint32_t out = freq / d;
+			uint64_t err;
+
+			if (out > max)
+				continue;
+			err = _error_ppb(out, target);
+			if (err < best || (err == best && freq < best_src_freq)) {
+				best = err;
+				best_src_freq = freq;
+				sol->source = src;
+				sol->div = d;
+				sol->freq = out;
+			}
+		}
+	}
+
+	if (best == UINT64_MAX)
+		return -ERANGE;
+
+	sol->error = clksolve_error_ppm(sol->freq, target);
+	if (sol->error > tolerance)
+		return -ERANGE;
+
+	return 0;
+}
+
+#ifndef CLKSOLVE_HOST
+
+void clksolve_get_pck_mck_cfg(const struct _clksolve_cpu* sol,
+		struct pck_mck_cfg* cfg)
+{
+	static const uint32_t mdiv[] = {
+		PMC_MCKR_MDIV_EQ_PCK, PMC_MCKR_MDIV_PCK_DIV2,
+		PMC_MCKR_MDIV_PCK_DIV3, PMC_MCKR_MDIV_PCK_DIV4,
+	};
+
+	cfg->pck_input = PMC_MCKR_CSS_PLLA_CLK;
+	cfg->plla.mul = sol->mul;
+	cfg->plla.div = sol->div;
+	cfg->plla.count = 0x3f;
+#ifdef CONFIG_HAVE_PMC_PLLA_CHARGE_PUMP
+	cfg->plla.icp = 3;
+#endif
+
+	switch (sol->pres) {
+#ifdef PMC_MCKR_PRES_CLOCK_DIV3
+	case 3:
+		cfg->pck_pres = PMC_MCKR_PRES_CLOCK_DIV3;
+		break;
+#endif
+	case 2:
+		cfg->pck_pres = PMC_MCKR_PRES_CLOCK_DIV2;
+		break;
+	case 4:
+		cfg->pck_pres = PMC_MCKR_PRES_CLOCK_DIV4;
+		break;
+	case 8:
+		cfg->pck_pres = PMC_MCKR_PRES_CLOCK_DIV8;
+		break;
+	case 16:
+		cfg->pck_pres = PMC_MCKR_PRES_CLOCK_DIV16;
+		break;
+	case 32:
+		cfg->pck_pres = PMC_MCKR_PRES_CLOCK_DIV32;
+		break;
+	case 64:
+		cfg->pck_pres = PMC_MCKR_PRES_CLOCK_DIV64;
+		break;
+	default:
+		cfg->pck_pres = PMC_MCKR_PRES_CLOCK;
+		break;
+	}
+	cfg->mck_div = mdiv[sol->mdiv - 1];
+
+#ifdef CONFIG_HAVE_PMC_PLLADIV2
+	cfg->plla_div2 = sol->div2;
+#endif
+#ifdef CONFIG_HAVE_PMC_H32MXDIV
+	cfg->h32mx_div2 = sol->h32mx_div2;
+#endif
+}
+
+#ifdef CONFIG_HAVE_PMC_AUDIO_CLOCK
+void clksolve_get_audio_cfg(const struct _clksolve_audio* sol,
+		struct _pmc_audio_cfg* cfg)
+{
+	cfg->nd = sol->nd;
+	cfg->fracr = sol->fracr;
+	cfg->qdpmc = sol->qdpmc;
+	cfg->div = sol->div;
+	cfg->qdaudio = sol->qdaudio;
+}
+#endif /* CONFIG_HAVE_PMC_AUDIO_CLOCK */
+
+#endif /* !CLKSOLVE_HOST */
@@ -0,0 +1,227 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _CLKSOLVE_H_
+#define _CLKSOLVE_H_
+
+/**
+ * \file
+ *
+ * Clock-tree solver.
+ *
+ * Searches the PLLA multiplier/divider, PLLA divide-by-2, master clock
+ * prescaler and divider reaching a processor and master clock target, the
+ * audio PLL settings reaching a PMC and/or pad clock target, and the source
+ * and divider of a peripheral generated clock (GCK). Errors are reported in
+ * ppm of the target; a solution outside the requested tolerance is rejected.
+ *
+ * The solver itself only depends on the C library so that it can be built on
+ * the host: scripts/clksolve uses it to generate configuration tables at
+ * build time. On the target, the clksolve_get_*_cfg() helpers convert a
+ * solution to the structures expected by the PMC driver.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef CLKSOLVE_HOST
+#include "peripherals/pmc.h"
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Number of generated clock sources (PMC_PCR.GCKCSS values) */
+#define CLKSOLVE_GCK_SOURCES 6
+
+/** Fractional part resolution of the audio PLL */
+#define CLKSOLVE_AUDIO_FRACR_BITS 22
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Constraints of the PLLA and master clock dividers */
+struct _clksolve_cpu_limits {
+	uint32_t pll_min;   /**< PLLA output range (Hz) */
+	uint32_t pll_max;
+	uint32_t mul_max;   /**< maximum MULA value, PLLA = in * (MULA + 1) / DIVA */
+	uint32_t div_max;   /**< maximum DIVA value */
+	bool has_div2;      /**< PLLADIV2 available */
+	bool has_pres3;     /**< prescaler by 3 available */
+	uint32_t pck_max;   /**< maximum processor clock (Hz) */
+	uint32_t mck_max;   /**< maximum master clock (Hz) */
+	uint32_t h32mx_max; /**< maximum H32MX clock (Hz), 0 if no H32MX divider */
+};
+
+/** PLLA and master clock solution */
+struct _clksolve_cpu {
+	uint32_t mul;       /**< MULA */
+	uint32_t div;       /**< DIVA */
+	bool div2;          /**< PLLADIV2 */
+	uint32_t pres;      /**< prescaler (1, 2, 3, 4, 8, ..., 64) */
+	uint32_t mdiv;      /**< master clock divider (1 to 4) */
+	bool h32mx_div2;    /**< H32MX = MCK / 2 */
+	uint32_t pll;       /**< resulting PLLA output (Hz) */
+	uint32_t pck;       /**< resulting processor clock (Hz) */
+	uint32_t mck;       /**< resulting master clock (Hz) */
+	uint32_t pck_error; /**< processor clock error (ppm) */
+	uint32_t mck_error; /**< master clock error (ppm) */
+};
+
+/** Constraints of the audio PLL */
+struct _clksolve_audio_limits {
+	uint32_t vco_min;     /**< VCO range (Hz) */
+	uint32_t vco_max;
+	uint32_t nd_max;      /**< maximum ND value */
+	uint32_t qdpmc_max;   /**< maximum QDPMC value */
+	uint32_t qdaudio_max; /**< maximum QDAUDIO value */
+	uint32_t pmc_max;     /**< maximum PMC clock (Hz) */
+	uint32_t pad_min;     /**< pad clock range (Hz) */
+	uint32_t pad_max;
+};
+
+/** Audio PLL solution */
+struct _clksolve_audio {
+	uint32_t nd;        /**< VCO = in * (ND + 1 + FRACR / 2^22) */
+	uint32_t fracr;
+	uint32_t qdpmc;     /**< PMC clock = VCO / (QDPMC + 1) */
+	uint32_t div;       /**< pad clock = VCO / (DIV * QDAUDIO), DIV is 2 or 3 */
+	uint32_t qdaudio;   /**< 0 when the pad clock is not used */
+	uint32_t vco;       /**< resulting VCO frequency (Hz) */
+	uint32_t pmc;       /**< resulting PMC clock (Hz) */
+	uint32_t pad;       /**< resulting pad clock (Hz) */
+	uint32_t pmc_error; /**< PMC clock error (ppm) */
+	uint32_t pad_error; /**< pad clock error (ppm) */
+};
+
+/** Generated clock solution */
+struct _clksolve_gck {
+	uint32_t source;    /**< GCKCSS value */
+	uint32_t div;       /**< divider (1 to 256), as given to pmc_configure_gck() */
+	uint32_t freq;      /**< resulting frequency (Hz) */
+	uint32_t error;     /**< error (ppm) */
+};
+
+/** Known limits of a device */
+struct _clksolve_soc {
+	const char* name;
+	struct _clksolve_cpu_limits cpu;
+	const struct _clksolve_audio_limits* audio; /**< NULL if no audio PLL */
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Get the limits of a device
+ * \param name Device name ("sama5d2", ...), NULL for the device the code is
+ * built for
+ * \return the device limits, or NULL if unknown
+ */
+extern const struct _clksolve_soc* clksolve_get_soc(const char* name);
+
+/**
+ * \brief Compute the error of a frequency, in ppm of the target (rounded up)
+ */
+extern uint32_t clksolve_error_ppm(uint64_t freq, uint64_t target);
+
+/**
+ * \brief Find the PLLA and master clock settings closest to the targets.
+ * The processor clock error is minimized first, then the master clock error,
+ * then the PLLA frequency.
+ * \param limits Device constraints
+ * \param in Main clock frequency (Hz)
+ * \param pck Processor clock target (Hz)
+ * \param mck Master clock target (Hz), 0 for the highest allowed
+ * \param tolerance Maximum error on each clock (ppm)
+ * \param sol Filled with the solution
+ * \return 0 on success, -ERANGE if no solution is within the tolerance
+ */
+extern int clksolve_cpu(const struct _clksolve_cpu_limits* limits, uint32_t in,
+		uint32_t pck, uint32_t mck, uint32_t tolerance,
+		struct _clksolve_cpu* sol);
+
+/**
+ * \brief Find the audio PLL settings closest to the targets. The sum of the
+ * errors is minimized, then the VCO frequency.
+ * \param limits Device constraints
+ * \param in Main crystal frequency (Hz)
+ * \param pmc PMC clock target (Hz), 0 if unused
+ * \param pad Pad clock target (Hz), 0 if unused
+ * \param tolerance Maximum error on each clock (ppm)
+ * \param sol Filled with the solution
+ * \return 0 on success, -ERANGE if no solution is within the tolerance,
+ * -EINVAL if both targets are 0
+ */
+extern int clksolve_audio(const struct _clksolve_audio_limits* limits,
+		uint32_t in, uint32_t pmc, uint32_t pad, uint32_t tolerance,
+		struct _clksolve_audio* sol);
+
+/**
+ * \brief Find the generated clock source and divider closest to the target,
+ * preferring the slowest source on equal errors.
+ * \param sources Frequency of each GCKCSS source (Hz), 0 if unavailable
+ * \param max Maximum generated clock frequency (Hz)
+ * \param target Target frequency (Hz)
+ * \param tolerance Maximum error (ppm)
+ * \param sol Filled with the solution
+ * \return 0 on success, -ERANGE if no solution is within the tolerance
+ */
+extern int clksolve_gck(const uint32_t sources[CLKSOLVE_GCK_SOURCES],
+		uint32_t max, uint32_t target, uint32_t tolerance,
+		struct _clksolve_gck* sol);
+
+#ifndef CLKSOLVE_HOST
+
+/**
+ * \brief Fill the PLLA, prescaler and divider fields of a clock
+ * configuration from a solution, selecting PLLA as processor clock input.
+ * The oscillator fields are left untouched.
+ */
+extern void clksolve_get_pck_mck_cfg(const struct _clksolve_cpu* sol,
+		struct pck_mck_cfg* cfg);
+
+#ifdef CONFIG_HAVE_PMC_AUDIO_CLOCK
+/**
+ * \brief Convert an audio PLL solution for pmc_configure_audio()
+ */
+extern void clksolve_get_audio_cfg(const struct _clksolve_audio* sol,
+		struct _pmc_audio_cfg* cfg);
+#endif
+
+#endif /* !CLKSOLVE_HOST */
+
+#endif /* _CLKSOLVE_H_ */
@@ -0,0 +1,398 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#include "chip.h"
+#include "cpuidle.h"
+#include "irqflags.h"
+#include "peripherals/pmc.h"
+#include "power/dvfs.h"
+#include "timer.h"
+#include "trace.h"
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct {
+	const struct _dvfs_opp* opps;
+	int count;
+	int current;
+	struct _dvfs_limits limits;
+	struct _dvfs_notifier* notifiers;
+
+	bool governor_running;
+	struct _dvfs_governor governor;
+	uint64_t window_start; /**< start of the sampling period (us) */
+	uint64_t idle_time;    /**< time spent idle in the period (us) */
+
+	struct _dvfs_stats stats;
+} _dvfs = {
+	.current = -1,
+};
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static void _dvfs_set_dividers(const struct _dvfs_opp* from,
+		const struct _dvfs_opp* to)
+{
+#ifdef CONFIG_HAVE_PMC_H32MXDIV
+	/* H32MX must never exceed its maximum frequency: divide it first */
+	if (to->cfg.h32mx_div2)
+		pmc_set_mck_h32mxdiv(true);
+#endif
+
+	if (dvfs_prescaler_first(from, to)) {
+		pmc_set_mck_prescaler(to->cfg.pck_pres);
+		pmc_set_mck_divider(to->cfg.mck_div);
+	} else {
+		pmc_set_mck_divider(to->cfg.mck_div);
+		pmc_set_mck_prescaler(to->cfg.pck_pres);
+	}
+
+#ifdef CONFIG_HAVE_PMC_H32MXDIV
+	if (!to->cfg.h32mx_div2)
+		pmc_set_mck_h32mxdiv(false);
+#endif
+}
+
+static void _dvfs_apply(const struct _dvfs_opp* from, const struct _dvfs_opp* to)
+{
+	if (!dvfs_needs_relock(from, to)) {
+		_dvfs_set_dividers(from, to);
+		return;
+	}
+
+	/* Run from the main clock while the new source is set up, dividers
+	 * are changed before switching as required when selecting a PLL */
+	pmc_switch_mck_to_main();
+
+	switch (to->cfg.pck_input) {
+	case PMC_MCKR_CSS_PLLA_CLK:
+		pmc_disable_plla();
+#ifdef CONFIG_HAVE_PMC_PLLADIV2
+		pmc_set_mck_plladiv2(to->cfg.plla_div2);
+#endif
+		pmc_configure_plla(&to->cfg.plla);
+		break;
+	case PMC_MCKR_CSS_UPLL_CLK:
+		if (!pmc_is_upll_clock_enabled())
+			pmc_enable_upll_clock();
+#ifdef CONFIG_HAVE_PMC_UPLLDIV2
+		pmc_set_mck_uplldiv2(to->cfg.upll_div2);
+#endif
+		break;
+	default:
+		break;
+	}
+
+	_dvfs_set_dividers(NULL, to);
+	pmc_switch_mck_to_new_source(to->cfg.pck_input);
+}
+
+static void _dvfs_governor_update(uint64_t now)
+{
+	uint64_t elapsed = now - _dvfs.window_start;
+	uint8_t load;
+	int next;
+
+	if (elapsed < (uint64_t)_dvfs.governor.period * 1000)
+		return;
+
+	if (_dvfs.idle_time >= elapsed)
+		load = 0;
+	else
+		load = 100 - (uint8_t)((_dvfs.idle_time * 100) / elapsed);
+	_dvfs.stats.load = load;
+	_dvfs.window_start = now;
+	_dvfs.idle_time = 0;
+
+	if (_dvfs.current < 0)
+		next = _dvfs.count - 1;
+	else
+		next = dvfs_governor_select(&_dvfs.governor, _dvfs.opps,
+				_dvfs.count, _dvfs.current, load);
+	if (next != _dvfs.current)
+		dvfs_set_opp(next);
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int dvfs_check_opp(const struct _dvfs_limits* limits,
+		const struct _dvfs_opp* opp)
+{
+	if (!opp || !opp->pck || !opp->mck)
+		return -EINVAL;
+
+	if (opp->pck > limits->pck_max || opp->mck > limits->mck_max ||
+	    opp->mck < limits->mck_min)
+		return -EINVAL;
+
+	/* MCK is PCK divided by 1, 2, 3 or 4 */
+	if (opp->pck < opp->mck || opp->pck > 4 * opp->mck)
+		return -EINVAL;
+
+	switch (opp->cfg.pck_input) {
+	case PMC_MCKR_CSS_PLLA_CLK:
+		if (!opp->cfg.plla.mul || !opp->cfg.plla.div)
+			return -EINVAL;
+		break;
+	case PMC_MCKR_CSS_UPLL_CLK:
+	case PMC_MCKR_CSS_MAIN_CLK:
+		break;
+	default:
+		/* switching to/from the slow clock is left to low-power code */
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+bool dvfs_needs_relock(const struct _dvfs_opp* from,
+		const struct _dvfs_opp* to)
+{
+	if (!from || from->cfg.pck_input != to->cfg.pck_input)
+		return true;
+
+	switch (to->cfg.pck_input) {
+	case PMC_MCKR_CSS_PLLA_CLK:
+		if (from->cfg.plla.mul != to->cfg.plla.mul ||
+		    from->cfg.plla.div != to->cfg.plla.div)
+			return true;
+#ifdef CONFIG_HAVE_PMC_PLLADIV2
+		if (from->cfg.plla_div2 != to->cfg.plla_div2)
+			return true;
+#endif
+		break;
+#ifdef CONFIG_HAVE_PMC_UPLLDIV2
+	case PMC_MCKR_CSS_UPLL_CLK:
+		if (from->cfg.upll_div2 != to->cfg.upll_div2)
+			return true;
+		break;
+#endif
+	default:
+		break;
+	}
+
+	return false;
+}
+
+bool dvfs_prescaler_first(const struct _dvfs_opp* from,
+		const struct _dvfs_opp* to)
+{
+	/* Lowering PCK: the prescaler first gives MCK = new PCK / old ratio,
+	 * lower than the old MCK. Raising PCK: the divider first gives
+	 * MCK = old PCK / new ratio, lower than the new MCK. */
+	return !from || to->pck <= from->pck;
+}
+
+int dvfs_check_transition(const struct _dvfs_limits* limits,
+		const struct _dvfs_opp* from, const struct _dvfs_opp* to)
+{
+	if (from && dvfs_check_opp(limits, from) < 0)
+		return -EINVAL;
+	if (dvfs_check_opp(limits, to) < 0)
+		return -EINVAL;
+	if (dvfs_needs_relock(from, to) && !limits->allow_relock)
+		return -EPERM;
+	return 0;
+}
+
+int dvfs_governor_select(const struct _dvfs_governor* governor,
+		const struct _dvfs_opp* opps, int count, int current, uint8_t load)
+{
+	uint64_t target;
+	int i;
+
+	if (load > governor->up_threshold)
+		return count - 1;
+	if (load >= governor->down_threshold)
+		return current;
+
+	/* Processor clock at which the load would reach up_threshold */
+	target = ((uint64_t)opps[current].pck * load) / governor->up_threshold;
+	for (i = 0; i < current; i++)
+		if (opps[i].pck >= target)
+			return i;
+	return current;
+}
+
+int dvfs_init(const struct _dvfs_opp* opps, int count,
+		const struct _dvfs_limits* limits, int current)
+{
+	int i;
+
+	if (!opps || count <= 0 || current >= count)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++) {
+		if (dvfs_check_opp(limits, &opps[i]) < 0)
+			return -EINVAL;
+		if (i > 0 && opps[i].pck < opps[i - 1].pck)
+			return -EINVAL;
+	}
+
+	_dvfs.opps = opps;
+	_dvfs.count = count;
+	_dvfs.current = current < 0 ? -1 : current;
+	_dvfs.limits = *limits;
+	memset(&_dvfs.stats, 0, sizeof(_dvfs.stats));
+	return 0;
+}
+
+void dvfs_register_notifier(struct _dvfs_notifier* notifier)
+{
+	struct _dvfs_notifier* n;
+
+	for (n = _dvfs.notifiers; n; n = n->next)
+		if (n == notifier)
+			return;
+
+	notifier->next = _dvfs.notifiers;
+	_dvfs.notifiers = notifier;
+}
+
+void dvfs_unregister_notifier(struct _dvfs_notifier* notifier)
+{
+	struct _dvfs_notifier** n;
+
+	for (n = &_dvfs.notifiers; *n; n = &(*n)->next) {
+		if (*n == notifier) {
+			*n = notifier->next;
+			notifier->next = NULL;
+			return;
+		}
+	}
+}
+
+int dvfs_set_opp(int index)
+{
+	struct _dvfs_transition transition;
+	struct _dvfs_notifier *n, *refused;
+	uint32_t flags;
+	int err;
+
+	if (index < 0 || index >= _dvfs.count)
+		return -EINVAL;
+	if (index == _dvfs.current)
+		return 0;
+
+	transition.from = _dvfs.current < 0 ? NULL : &_dvfs.opps[_dvfs.current];
+	transition.to = &_dvfs.opps[index];
+
+	err = dvfs_check_transition(&_dvfs.limits, transition.from, transition.to);
+	if (err < 0)
+		return err;
+
+	for (n = _dvfs.notifiers; n; n = n->next) {
+		err = n->fn(DVFS_PRE_CHANGE, &transition, n->arg);
+		if (err < 0)
+			break;
+	}
+	if (n) {
+		refused = n;
+		for (n = _dvfs.notifiers; n != refused; n = n->next)
+			n->fn(DVFS_ABORT_CHANGE, &transition, n->arg);
+		_dvfs.stats.refused++;
+		trace_debug("dvfs: transition to %s refused (%d)\r\n",
+				transition.to->name, err);
+		return err;
+	}
+
+	flags = arch_irq_save();
+	_dvfs_apply(transition.from, transition.to);
+	_dvfs.current = index;
+	for (n = _dvfs.notifiers; n; n = n->next)
+		n->fn(DVFS_POST_CHANGE, &transition, n->arg);
+	arch_irq_restore(flags);
+
+	_dvfs.stats.transitions++;
+	if (pmc_get_master_clock() != transition.to->mck)
+		trace_warning("dvfs: %s: MCK is %uHz, expected %uHz\r\n",
+				transition.to->name,
+				(unsigned)pmc_get_master_clock(),
+				(unsigned)transition.to->mck);
+	return 0;
+}
+
+int dvfs_get_opp(void)
+{
+	return _dvfs.current;
+}
+
+void dvfs_governor_start(const struct _dvfs_governor* governor)
+{
+	assert(governor->up_threshold > governor->down_threshold);
+	assert(governor->up_threshold <= 100);
+
+	_dvfs.governor = *governor;
+	_dvfs.window_start = timer_get_us();
+	_dvfs.idle_time = 0;
+	_dvfs.governor_running = true;
+}
+
+void dvfs_governor_stop(void)
+{
+	_dvfs.governor_running = false;
+}
+
+void dvfs_idle(void)
+{
+	uint64_t start, end;
+	uint32_t flags;
+
+	/* The CPU wakes up on interrupts even when masked: the handler runs
+	 * after the end of the idle time is sampled and counts as load */
+	flags = arch_irq_save();
+	start = timer_get_us();
+	cpu_idle();
+	end = timer_get_us();
+	arch_irq_restore(flags);
+
+	_dvfs.idle_time += end - start;
+
+	if (_dvfs.governor_running && _dvfs.count > 0)
+		_dvfs_governor_update(end);
+}
+
+void dvfs_get_stats(struct _dvfs_stats* stats)
+{
+	memcpy(stats, &_dvfs.stats, sizeof(*stats));
+}
@@ -0,0 +1,256 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _DVFS_H_
+#define _DVFS_H_
+
+/**
+ * \file
+ *
+ * Dynamic frequency scaling.
+ *
+ * The application describes the clock configurations the system may run at
+ * as a table of operating points sorted by increasing processor clock.
+ * Before and after each transition between operating points, the notifier
+ * chain is called so that drivers can recompute their clock dividers; a
+ * driver can refuse a transition from its DVFS_PRE_CHANGE notifier (for
+ * example while a transfer is in progress). DVFS_POST_CHANGE notifiers are
+ * called with interrupts disabled, before any interrupt handler can run with
+ * stale clock dividers.
+ *
+ * The governor selects the operating point from the CPU load, measured as
+ * the time spent in dvfs_idle() over each sampling period.
+ *
+ * DVFS is built when the application sets CONFIG_HAVE_DVFS = y in its
+ * Makefile. Otherwise the system timer, seriald, usartd, spid, twid and sdmmc
+ * register no notifier and assume a fixed master clock.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "peripherals/pmc.h"
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Operating point */
+struct _dvfs_opp {
+	/** Name, for traces */
+	const char* name;
+
+	/** Clock configuration (the oscillator fields are ignored) */
+	struct pck_mck_cfg cfg;
+
+	/** Resulting processor clock (Hz) */
+	uint32_t pck;
+
+	/** Resulting master clock (Hz) */
+	uint32_t mck;
+};
+
+/** Constraints checked on each operating point and transition */
+struct _dvfs_limits {
+	/** Maximum processor clock (Hz) */
+	uint32_t pck_max;
+
+	/** Maximum master clock (Hz) */
+	uint32_t mck_max;
+
+	/** Minimum master clock (Hz), e.g. required by the DDR refresh */
+	uint32_t mck_min;
+
+	/** Transitions changing the master clock source or reprogramming the
+	 * PLL run the master clock from the main clock meanwhile. Set to false
+	 * if something (the DDR refresh for instance) cannot tolerate it. */
+	bool allow_relock;
+};
+
+enum _dvfs_event {
+	DVFS_PRE_CHANGE,   /**< clocks are about to change, may be refused */
+	DVFS_POST_CHANGE,  /**< clocks have changed */
+	DVFS_ABORT_CHANGE, /**< transition refused by a later notifier */
+};
+
+struct _dvfs_transition {
+	const struct _dvfs_opp* from; /**< current operating point, NULL if unknown */
+	const struct _dvfs_opp* to;   /**< new operating point */
+};
+
+/**
+ * \brief Notifier function.
+ * \return 0 to accept the transition, a negative error code to refuse it
+ * (only on DVFS_PRE_CHANGE)
+ */
+typedef int (*dvfs_notifier_fn_t)(enum _dvfs_event event,
+		const struct _dvfs_transition* transition, void* arg);
+
+/** Notifier chain element, owned by the registering driver */
+struct _dvfs_notifier {
+	dvfs_notifier_fn_t fn;
+	void* arg;
+	struct _dvfs_notifier* next;
+};
+
+struct _dvfs_governor {
+	/** Sampling period (ms) */
+	uint32_t period;
+
+	/** Load (%) above which the fastest operating point is selected */
+	uint8_t up_threshold;
+
+	/** Load (%) below which a slower operating point is selected, the
+	 * slowest one keeping the load under up_threshold */
+	uint8_t down_threshold;
+};
+
+struct _dvfs_stats {
+	uint32_t transitions; /**< successful transitions */
+	uint32_t refused;     /**< transitions refused by a notifier */
+	uint8_t load;         /**< CPU load (%) over the last period */
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Check an operating point against the limits.
+ * \return 0 on success, -EINVAL otherwise
+ */
+extern int dvfs_check_opp(const struct _dvfs_limits* limits,
+		const struct _dvfs_opp* opp);
+
+/**
+ * \brief Check if the PLL must be reprogrammed to go from one operating
+ * point to another.
+ */
+extern bool dvfs_needs_relock(const struct _dvfs_opp* from,
+		const struct _dvfs_opp* to);
+
+/**
+ * \brief Check if the prescaler must be changed before the divider. The
+ * order is chosen so that the intermediate master clock never exceeds the
+ * highest of both.
+ */
+extern bool dvfs_prescaler_first(const struct _dvfs_opp* from,
+		const struct _dvfs_opp* to);
+
+/**
+ * \brief Check a transition between two operating points.
+ * \param from Current operating point, NULL if unknown
+ * \return 0 on success, -EINVAL if an operating point is invalid, -EPERM if
+ * the transition needs a PLL relock that is not allowed
+ */
+extern int dvfs_check_transition(const struct _dvfs_limits* limits,
+		const struct _dvfs_opp* from, const struct _dvfs_opp* to);
+
+/**
+ * \brief Select the operating point for a CPU load.
+ * \param opps Operating points, sorted by increasing processor clock
+ * \param count Number of operating points
+ * \param current Index of the current operating point
+ * \param load CPU load (%) at the current operating point
+ * \return Index of the operating point to select
+ */
+extern int dvfs_governor_select(const struct _dvfs_governor* governor,
+		const struct _dvfs_opp* opps, int count, int current, uint8_t load);
+
+/**
+ * \brief Initialize DVFS.
+ * \param opps Operating points, sorted by increasing processor clock
+ * \param count Number of operating points
+ * \param limits Limits (copied)
+ * \param current Index of the operating point the system runs at, -1 if
+ * unknown
+ * \return 0 on success, -EINVAL if an operating point is invalid
+ */
+extern int dvfs_init(const struct _dvfs_opp* opps, int count,
+		const struct _dvfs_limits* limits, int current);
+
+/**
+ * \brief Register a notifier. Registering an element already in the chain
+ * has no effect.
+ */
+extern void dvfs_register_notifier(struct _dvfs_notifier* notifier);
+
+/**
+ * \brief Remove a notifier from the chain, if registered.
+ */
+extern void dvfs_unregister_notifier(struct _dvfs_notifier* notifier);
+
+/**
+ * \brief Switch to an operating point.
+ * \return 0 on success, -EINVAL if index is invalid, or the error returned
+ * by dvfs_check_transition() or by the notifier refusing the transition
+ */
+extern int dvfs_set_opp(int index);
+
+/**
+ * \brief Get the index of the current operating point, -1 if unknown.
+ */
+extern int dvfs_get_opp(void);
+
+/**
+ * \brief Start the governor.
+ */
+extern void dvfs_governor_start(const struct _dvfs_governor* governor);
+
+/**
+ * \brief Stop the governor. The current operating point is kept.
+ */
+extern void dvfs_governor_stop(void);
+
+/**
+ * \brief Idle the CPU until the next interrupt, accounting the time spent
+ * for the CPU load, and run the governor at the end of each period.
+ *
+ * To be used instead of cpu_idle() in the application idle loop.
+ */
+extern void dvfs_idle(void);
+
+/**
+ * \brief Get DVFS statistics.
+ */
+extern void dvfs_get_stats(struct _dvfs_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DVFS_H_ */
@@ -66,6 +66,7 @@
 
 #include "trace.h"
 #include "chip.h"
+#include "errno.h"
 #include "intmath.h"
 #include "timer.h"
 
@@ -219,6 +220,20 @@ static uint8_t sdmmc_unplug_device(struct sdmmc_set *set)
 	return SDMMC_SUCCESS;
 }
 
+static void sdmmc_set_calibration_count(struct sdmmc_set *set)
+{
+	Sdmmc *regs = set->regs;
+	uint32_t val;
+
+	/* Allow tSTARTUP = 2 usec for the analog circuitry to start up.
+	 * CNTVAL = fHCLOCK / (4 * (1 / tSTARTUP)) */
+	val = pmc_get_peripheral_clock(set->id);
+	val = ROUND_INT_DIV(val, 4 * 500000UL);
+	assert(!(val << SDMMC_CALCR_CNTVAL_Pos & ~SDMMC_CALCR_CNTVAL_Msk));
+	regs->SDMMC_CALCR = (regs->SDMMC_CALCR & ~SDMMC_CALCR_CNTVAL_Msk
+	    & ~SDMMC_CALCR_TUNDIS) | SDMMC_CALCR_CNTVAL(val);
+}
+
 static void sdmmc_calibrate_zout(struct sdmmc_set *set)
 {
 	assert(set);
@@ -476,6 +491,9 @@ static void sdmmc_set_device_clock(struct sdmmc_set *set, uint32_t freq)
 	uint16_t shval;
 	bool use_prog_mode = false;
 
+#ifdef CONFIG_HAVE_DVFS
+	set->req_freq = freq;
+#endif
 	freq = min_u32(freq, 120000000ul);
 #ifndef NDEBUG
 	if (!(regs->SDMMC_PCR & SDMMC_PCR_SDBPWR))
@@ -1201,6 +1219,37 @@ static uint8_t sdmmc_tune_sampling(struct sdmmc_set *set)
 	return rc;
 }
 
+#ifdef CONFIG_HAVE_DVFS
+
+/**
+ * \brief DVFS notifier: refuse clock changes during a command, or while
+ * the sampling point found by tuning is in use as it only holds for the
+ * current device clock. Recompute the clock dividers afterwards.
+ */
+static int sdmmc_dvfs_notifier(enum _dvfs_event event,
+		const struct _dvfs_transition* transition, void* arg)
+{
+	struct sdmmc_set *set = (struct sdmmc_set *)arg;
+
+	switch (event) {
+	case DVFS_PRE_CHANGE:
+		if (set->state == MCID_CMD
+		    || set->regs->SDMMC_HC2R & SDMMC_HC2R_SCLKSEL)
+			return -EBUSY;
+		break;
+	case DVFS_POST_CHANGE:
+		sdmmc_set_calibration_count(set);
+		if (set->dev_freq != 0)
+			sdmmc_set_device_clock(set, set->req_freq);
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+#endif /* CONFIG_HAVE_DVFS */
+
 /*----------------------------------------------------------------------------
  *        HAL for the SD/MMC library
  *----------------------------------------------------------------------------*/
@@ -1746,6 +1795,9 @@ bool sdmmc_initialize(struct sdmmc_set *set, uint32_t periph_id,
 	uint8_t exp;
 
 	assert(tc_module);
+#ifdef CONFIG_HAVE_DVFS
+	dvfs_unregister_notifier(&set->dvfs);
+#endif
 	memset(set, 0, sizeof(*set));
 	set->id = periph_id;
 	set->regs = regs;
@@ -1766,14 +1818,8 @@ bool sdmmc_initialize(struct sdmmc_set *set, uint32_t periph_id,
 	    | TC_CMR_CPCDIS | TC_CMR_BURST_NONE | TC_CMR_TCCLKS_TIMER_CLOCK2);
 	set->timer->TC_EMR |= TC_EMR_NODIVCLK;
 
-	/* Perform the initial I/O calibration sequence, manually.
-	 * Allow tSTARTUP = 2 usec for the analog circuitry to start up.
-	 * CNTVAL = fHCLOCK / (4 * (1 / tSTARTUP)) */
-	val = pmc_get_peripheral_clock(periph_id);
-	val = ROUND_INT_DIV(val, 4 * 500000UL);
-	assert(!(val << SDMMC_CALCR_CNTVAL_Pos & ~SDMMC_CALCR_CNTVAL_Msk));
-	regs->SDMMC_CALCR = (regs->SDMMC_CALCR & ~SDMMC_CALCR_CNTVAL_Msk
-	    & ~SDMMC_CALCR_TUNDIS) | SDMMC_CALCR_CNTVAL(val);
+	/* Perform the initial I/O calibration sequence, manually. */
+	sdmmc_set_calibration_count(set);
 	sdmmc_calibrate_zout(set);
 
 	/* Set DAT line timeout error to occur after 500 ms waiting delay.
@@ -1816,6 +1862,12 @@ bool sdmmc_initialize(struct sdmmc_set *set, uint32_t periph_id,
 		irq_enable(periph_id);
 	}
 
+#ifdef CONFIG_HAVE_DVFS
+	set->dvfs.fn = sdmmc_dvfs_notifier;
+	set->dvfs.arg = set;
+	dvfs_register_notifier(&set->dvfs);
+#endif
+
 	return true;
 }
 
@@ -35,6 +35,9 @@
  *----------------------------------------------------------------------------*/
 
 #include "chip.h"
+#ifdef CONFIG_HAVE_DVFS
+#include "power/dvfs.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -76,6 +79,11 @@ struct sdmmc_set
 	bool cmd_line_released;       /* handled the Command Complete event */
 	bool dat_lines_released;      /* handled the Transfer Complete event */
 	bool expect_auto_end;         /* waiting for completion of Auto CMD12 */
+#ifdef CONFIG_HAVE_DVFS
+	uint32_t req_freq;            /* device clock frequency requested, in
+				       * Hz, restored after clock changes */
+	struct _dvfs_notifier dvfs;   /* clock change notifier */
+#endif
 };
 
 /*----------------------------------------------------------------------------
@@ -39,6 +39,7 @@
  *----------------------------------------------------------------------------*/
 
 #include "chip.h"
+#include "errno.h"
 #include "math.h"
 #include "sensor/bmp280.h"
 #include "gpio/pio.h"
@@ -1101,6 +1102,55 @@ uint8_t bmp280_compute_wait_time (struct _bmp280* bmp280, uint8_t* delaytimer)
 	return com_rslt;
 }
 
+#ifdef CONFIG_HAVE_SENSOR_HUB
+
+/* Compensate a burst of the pressure and temperature registers, read by
+ * the sensor hub, using integer math only */
+static int _bmp280_hub_decode(void* arg, const uint8_t* dt, struct _sensor_hub_sample* sample)
+{
+	struct _bmp280* bmp280 = (struct _bmp280*)arg;
+	int32_t uncP, uncT;
+
+	uncP = (int32_t)((((uint32_t)(dt[0]))<<12) | (((uint32_t)(dt[1]))<<4) | ((uint32_t)dt[2]>>4));
+	uncT = (int32_t)((((uint32_t)(dt[3]))<<12) | (((uint32_t)(dt[4]))<<4) | ((uint32_t)dt[5]>>4));
+
+	/* 0x80000 is the reset value: no measurement done yet */
+	if (uncP == 0x80000 || uncT == 0x80000)
+		return -EAGAIN;
+
+	/* temperature first, it updates t_fine for the pressure */
+	sample->value[0] = bmp280_compensate_temperatureC(bmp280, uncT);
+#if defined(BMP280_ENABLE_INT64) && defined(BMP280_64BITSUPPORT_PRESENT)
+	sample->value[1] = (int32_t)bmp280_compensate_P_int64(bmp280, uncP);
+#else
+	sample->value[1] = (int32_t)bmp280_compensate_pressureP(bmp280, uncP);
+#endif
+	sample->count = 2;
+
+	return 0;
+}
+
+int bmp280_sensor_hub_device(struct _bmp280* bmp280, struct _sensor_hub_device* dev, uint32_t period)
+{
+	uint8_t wait;
+
+	bmp280_compute_wait_time(bmp280, &wait);
+
+	memset(dev, 0, sizeof(*dev));
+	dev->bus = bmp280->bus;
+	dev->addr = bmp280->addr;
+	dev->reg = BMP280_PRESSURE_MSB_REG;
+	dev->len = 6;
+	dev->conversion = wait * 1000;
+	dev->period = period;
+	dev->decode = _bmp280_hub_decode;
+	dev->arg = bmp280;
+
+	return 0;
+}
+
+#endif /* CONFIG_HAVE_SENSOR_HUB */
+
 /*
  *	Read ID and Calibration parameters
  *  Return results of bus communication function
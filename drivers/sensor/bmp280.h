@@ -38,6 +38,10 @@
 
 #include <stdint.h>
 
+#ifdef CONFIG_HAVE_SENSOR_HUB
+#include "sensor/sensor_hub.h"
+#endif
+
 /*----------------------------------------------------------------------------
  *        Definition
  *----------------------------------------------------------------------------*/
@@ -436,6 +440,19 @@ uint8_t bmp280_read_id_get_calib_param (struct _bmp280* bmp280);
 
 uint8_t bmp280_compute_wait_time (struct _bmp280* bmp280, uint8_t* delaytimer);
 
+#ifdef CONFIG_HAVE_SENSOR_HUB
+/**************************************************************/
+/**\name	SENSOR HUB DEVICE                        */
+/**************************************************************/
+
+/* Describe the sensor for the sensor hub: burst read of the pressure and
+ * temperature registers (0xF7 to 0xFC). The sensor must be configured in
+ * normal mode, with its calibration parameters read.
+ * Samples hold the temperature in 0.01 DegC (value[0]) and the pressure in
+ * Pa, Q24.8 when 64 bit integers are enabled (value[1]). */
+int bmp280_sensor_hub_device(struct _bmp280* bmp280, struct _sensor_hub_device* dev, uint32_t period);
+#endif
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
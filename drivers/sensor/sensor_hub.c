@@ -0,0 +1,288 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <string.h>
+
+#include "callback.h"
+#include "peripherals/bus.h"
+#include "sensor/sensor_hub.h"
+#include "timer.h"
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+enum _sensor_hub_state {
+	SENSOR_HUB_IDLE,
+	SENSOR_HUB_BUSY,
+	SENSOR_HUB_DONE,
+};
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static int _sensor_hub_callback(void* arg, void* arg2)
+{
+	struct _sensor_hub* hub = (struct _sensor_hub*)arg;
+
+	hub->done = timer_get_us();
+	hub->state = SENSOR_HUB_DONE;
+
+	return 0;
+}
+
+static void _sensor_hub_push(struct _sensor_hub* hub, const struct _sensor_hub_sample* sample)
+{
+	uint16_t head = hub->ring.head;
+	uint16_t next = (head + 1) % hub->ring.size;
+
+	if (next == hub->ring.tail) {
+		hub->ring.dropped++;
+		return;
+	}
+
+	memcpy(&hub->ring.samples[head], sample, sizeof(*sample));
+	hub->ring.head = next;
+}
+
+static int _sensor_hub_complete(struct _sensor_hub* hub)
+{
+	struct _sensor_hub_device* dev = hub->devices[hub->current];
+	struct _sensor_hub_sample sample;
+
+	sample.timestamp = hub->done;
+	sample.device = hub->current;
+	sample.count = 0;
+
+	hub->current = -1;
+	hub->state = SENSOR_HUB_IDLE;
+
+	if (dev->decode(dev->arg, hub->raw, &sample) < 0) {
+		dev->errors++;
+		return 0;
+	}
+
+	dev->samples++;
+	_sensor_hub_push(hub, &sample);
+	return 1;
+}
+
+/*
+ * Select the next device to read: a due device on the bus of the open
+ * transaction first, then the device that is the most late.
+ */
+static int _sensor_hub_next(const struct _sensor_hub* hub, uint64_t now)
+{
+	int i, best = -1;
+
+	for (i = 0; i < hub->count; i++) {
+		const struct _sensor_hub_device* dev = hub->devices[i];
+
+		if (dev->next > now)
+			continue;
+		if (dev->bus == hub->bus)
+			return i;
+		if (best < 0 || dev->next < hub->devices[best]->next)
+			best = i;
+	}
+
+	return best;
+}
+
+/*
+ * Move the device to its next slot of the timetable, skipping the slots
+ * that are already over
+ */
+static void _sensor_hub_schedule(struct _sensor_hub_device* dev, uint64_t now)
+{
+	uint32_t late;
+
+	dev->next += dev->period;
+	if (dev->next <= now) {
+		late = (uint32_t)((now - dev->next) / dev->period) + 1;
+		dev->missed += late;
+		dev->next += (uint64_t)late * dev->period;
+	}
+}
+
+static void _sensor_hub_close(struct _sensor_hub* hub)
+{
+	if (hub->bus >= 0) {
+		bus_stop_transaction(hub->bus);
+		hub->bus = -1;
+	}
+}
+
+static int _sensor_hub_issue(struct _sensor_hub* hub, int index)
+{
+	struct _sensor_hub_device* dev = hub->devices[index];
+	int err;
+
+	if (hub->bus != dev->bus) {
+		_sensor_hub_close(hub);
+		bus_start_transaction(dev->bus);
+		hub->bus = dev->bus;
+	}
+
+	hub->reg = dev->reg;
+	hub->buf[0].data = &hub->reg;
+	hub->buf[0].size = 1;
+	hub->buf[0].attr = BUS_I2C_BUF_ATTR_START | BUS_BUF_ATTR_TX;
+	hub->buf[1].data = hub->raw;
+	hub->buf[1].size = dev->len;
+	hub->buf[1].attr = BUS_I2C_BUF_ATTR_START | BUS_BUF_ATTR_RX | BUS_I2C_BUF_ATTR_STOP;
+
+	hub->current = index;
+	hub->state = SENSOR_HUB_BUSY;
+
+	err = bus_transfer(dev->bus, dev->addr, hub->buf, 2, &hub->cb);
+	if (err < 0) {
+		dev->errors++;
+		hub->current = -1;
+		hub->state = SENSOR_HUB_IDLE;
+	}
+
+	return err;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void sensor_hub_init(struct _sensor_hub* hub, struct _sensor_hub_sample* ring, uint16_t size)
+{
+	memset(hub, 0, sizeof(*hub));
+	hub->ring.samples = ring;
+	hub->ring.size = size;
+	hub->current = -1;
+	hub->bus = -1;
+	callback_set(&hub->cb, _sensor_hub_callback, hub);
+}
+
+int sensor_hub_add(struct _sensor_hub* hub, struct _sensor_hub_device* dev)
+{
+	if (!dev->decode || dev->len == 0 || dev->len > SENSOR_HUB_MAX_BURST)
+		return -EINVAL;
+	if (dev->period < dev->conversion)
+		dev->period = dev->conversion;
+	if (dev->period == 0)
+		return -EINVAL;
+	if (hub->count >= SENSOR_HUB_MAX_DEVICES)
+		return -ENOMEM;
+
+	hub->devices[hub->count] = dev;
+	return hub->count++;
+}
+
+void sensor_hub_start(struct _sensor_hub* hub)
+{
+	uint64_t now = timer_get_us();
+	int i;
+
+	for (i = 0; i < hub->count; i++) {
+		struct _sensor_hub_device* dev = hub->devices[i];
+
+		dev->next = now;
+		dev->samples = 0;
+		dev->missed = 0;
+		dev->errors = 0;
+	}
+}
+
+int sensor_hub_poll(struct _sensor_hub* hub)
+{
+	struct _sensor_hub_device* dev;
+	uint64_t now;
+	int index, count = 0;
+
+	for (;;) {
+		if (hub->state == SENSOR_HUB_BUSY)
+			return count;
+		if (hub->state == SENSOR_HUB_DONE)
+			count += _sensor_hub_complete(hub);
+
+		now = timer_get_us();
+		index = _sensor_hub_next(hub, now);
+		if (index < 0)
+			break;
+
+		dev = hub->devices[index];
+		_sensor_hub_schedule(dev, now);
+		_sensor_hub_issue(hub, index);
+	}
+
+	/* nothing left to read, release the bus */
+	_sensor_hub_close(hub);
+
+	return count;
+}
+
+bool sensor_hub_is_busy(const struct _sensor_hub* hub)
+{
+	return hub->state != SENSOR_HUB_IDLE;
+}
+
+uint32_t sensor_hub_get_idle_time(const struct _sensor_hub* hub)
+{
+	uint64_t now = timer_get_us();
+	uint64_t next = UINT64_MAX;
+	int i;
+
+	if (sensor_hub_is_busy(hub))
+		return 0;
+
+	for (i = 0; i < hub->count; i++) {
+		if (hub->devices[i]->next <= now)
+			return 0;
+		if (hub->devices[i]->next < next)
+			next = hub->devices[i]->next;
+	}
+
+	if (next - now > UINT32_MAX)
+		return UINT32_MAX;
+	return (uint32_t)(next - now);
+}
+
+bool sensor_hub_read(struct _sensor_hub* hub, struct _sensor_hub_sample* sample)
+{
+	uint16_t tail = hub->ring.tail;
+
+	if (tail == hub->ring.head)
+		return false;
+
+	memcpy(sample, &hub->ring.samples[tail], sizeof(*sample));
+	hub->ring.tail = (tail + 1) % hub->ring.size;
+	return true;
+}
@@ -0,0 +1,175 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+#ifndef _SENSOR_HUB_H_
+#define _SENSOR_HUB_H_
+
+/**
+ * \file
+ *
+ * Sensor hub: scheduled burst acquisition of I2C sensors.
+ *
+ * Each device declares the register block holding its measurements (first
+ * register and length), the time it needs to produce a new conversion and a
+ * decode function. The hub reads the whole block in a single bus transfer,
+ * on a fixed timetable: the n-th read of a device is due at
+ * start + n * period, late reads do not shift the following ones.
+ *
+ * sensor_hub_poll() is called from the main loop. It completes the transfer
+ * in progress and issues the reads that are due back to back, keeping the
+ * bus transaction open between consecutive devices of the same bus. With
+ * the bus in async or DMA mode, the transfers complete in the background and
+ * sensor_hub_poll() returns immediately.
+ *
+ * Decoded samples are pushed with their timestamp into a ring that can be
+ * drained with sensor_hub_read() (single reader).
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "peripherals/bus.h"
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Maximum number of devices in a hub */
+#define SENSOR_HUB_MAX_DEVICES 16
+
+/** Maximum length of a burst read (bytes) */
+#define SENSOR_HUB_MAX_BURST 32
+
+/** Maximum number of values in a sample */
+#define SENSOR_HUB_MAX_VALUES 6
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct _sensor_hub_sample {
+	uint64_t timestamp;    /**< end of the burst read (us) */
+	uint8_t device;        /**< index returned by sensor_hub_add() */
+	uint8_t count;         /**< number of values */
+	int32_t value[SENSOR_HUB_MAX_VALUES];
+};
+
+struct _sensor_hub_device {
+	uint8_t bus;           /**< bus ID */
+	uint8_t addr;          /**< I2C address */
+	uint8_t reg;           /**< first register of the burst read */
+	uint8_t len;           /**< length of the burst read */
+	uint32_t conversion;   /**< conversion time (us), minimum period */
+	uint32_t period;       /**< acquisition period (us) */
+
+	/** Convert the raw register block into values, return < 0 to drop it */
+	int (*decode)(void* arg, const uint8_t* raw, struct _sensor_hub_sample* sample);
+	void* arg;
+
+	/* run-time state, managed by the hub */
+	uint64_t next;         /**< due time of the next read (us) */
+	uint32_t samples;      /**< successful reads */
+	uint32_t missed;       /**< slots skipped because the hub was late */
+	uint32_t errors;       /**< failed transfers */
+};
+
+struct _sensor_hub {
+	struct _sensor_hub_device* devices[SENSOR_HUB_MAX_DEVICES];
+	uint8_t count;
+
+	struct {
+		struct _sensor_hub_sample* samples;
+		uint16_t size;
+		volatile uint16_t head;
+		volatile uint16_t tail;
+		uint32_t dropped;  /**< samples lost because the ring was full */
+	} ring;
+
+	/* transfer in progress */
+	volatile uint8_t state;
+	int8_t current;        /**< device being read, -1 if none */
+	int8_t bus;            /**< bus with an open transaction, -1 if none */
+	uint8_t reg;
+	volatile uint64_t done;
+	struct _buffer buf[2];
+	struct _callback cb;
+	uint8_t raw[SENSOR_HUB_MAX_BURST];
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a sensor hub
+ * \param ring Storage for the sample ring
+ * \param size Number of samples in ring
+ */
+extern void sensor_hub_init(struct _sensor_hub* hub, struct _sensor_hub_sample* ring, uint16_t size);
+
+/**
+ * \brief Add a device to the hub. The period is raised to the conversion
+ * time of the device if shorter.
+ * \return device index (>= 0), -EINVAL or -ENOMEM
+ */
+extern int sensor_hub_add(struct _sensor_hub* hub, struct _sensor_hub_device* dev);
+
+/**
+ * \brief Start the timetable: the first read of every device is due now
+ */
+extern void sensor_hub_start(struct _sensor_hub* hub);
+
+/**
+ * \brief Complete the transfer in progress and issue the reads that are due
+ * \return number of samples acquired
+ */
+extern int sensor_hub_poll(struct _sensor_hub* hub);
+
+/**
+ * \brief Check if a transfer is in progress
+ */
+extern bool sensor_hub_is_busy(const struct _sensor_hub* hub);
+
+/**
+ * \brief Time until the next read is due (us), 0 if a read is due or a
+ * transfer is in progress
+ */
+extern uint32_t sensor_hub_get_idle_time(const struct _sensor_hub* hub);
+
+/**
+ * \brief Pop the oldest sample from the ring
+ * \return true if a sample was available
+ */
+extern bool sensor_hub_read(struct _sensor_hub* hub, struct _sensor_hub_sample* sample);
+
+#endif /* _SENSOR_HUB_H_ */
@@ -146,6 +146,35 @@ static void seriald_handler(uint32_t source, void* user_arg)
 		serial->rx_handler(c);
 }
 
+#ifdef CONFIG_HAVE_DVFS
+
+/**
+ * \brief DVFS notifier: let the transmitter drain before the peripheral
+ * clock changes, then recompute the baudrate divider.
+ */
+static int seriald_dvfs_notifier(enum _dvfs_event event,
+		const struct _dvfs_transition* transition, void* arg)
+{
+	struct _seriald* serial = (struct _seriald*)arg;
+
+	switch (event) {
+	case DVFS_PRE_CHANGE:
+		while (!serial->ops->tx_empty(serial->addr));
+		break;
+	case DVFS_POST_CHANGE:
+		serial->ops->init(serial->addr, serial->ops->mode, serial->baudrate);
+		/* init disables all interrupts */
+		if (serial->rx_handler)
+			serial->ops->enable_it(serial->addr, serial->ops->rx_int_mask);
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+#endif /* CONFIG_HAVE_DVFS */
+
 /*------------------------------------------------------------------------------
  *         Exported functions
  *------------------------------------------------------------------------------*/
@@ -188,15 +217,25 @@ int seriald_configure(struct _seriald* serial, void* addr, uint32_t baudrate)
 		return -ENODEV;
 
 	/* Save serial peripheral address and ID */
+#ifdef CONFIG_HAVE_DVFS
+	dvfs_unregister_notifier(&serial->dvfs);
+#endif
 	memset(serial, 0, sizeof(*serial));
 	serial->id = id;
 	serial->addr = addr;
 	serial->ops = ops;
+	serial->baudrate = baudrate;
 
 	/* Initialize driver to use */
 	pmc_configure_peripheral(id, NULL, true);
 	ops->init(addr, ops->mode, baudrate);
 
+#ifdef CONFIG_HAVE_DVFS
+	serial->dvfs.fn = seriald_dvfs_notifier;
+	serial->dvfs.arg = serial;
+	dvfs_register_notifier(&serial->dvfs);
+#endif
+
 	return 0;
 }
 
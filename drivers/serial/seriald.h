@@ -38,6 +38,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#ifdef CONFIG_HAVE_DVFS
+#include "power/dvfs.h"
+#endif
+
 /*----------------------------------------------------------------------------
  *        Global Types
  *----------------------------------------------------------------------------*/
@@ -54,6 +58,10 @@ struct _seriald {
 	void *addr; /* peripheral address */
 	seriald_rx_handler_t rx_handler; /* rx callback */
 	const struct _seriald_ops* ops; /* low-level operations */
+	uint32_t baudrate; /* baudrate, restored on clock changes */
+#ifdef CONFIG_HAVE_DVFS
+	struct _dvfs_notifier dvfs; /* clock change notifier */
+#endif
 };
 
 /* ----------------------------------------------------------------------------
@@ -38,7 +38,9 @@
 #include "callback.h"
 #include "chip.h"
 #include "dma/dma.h"
+#include "errno.h"
 #include "io.h"
+#include "irqflags.h"
 #include "irq/irq.h"
 #include "mm/cache.h"
 #include "mutex.h"
@@ -46,6 +48,7 @@
 #include "peripherals/flexcom.h"
 #endif
 #include "peripherals/pmc.h"
+#include "power/clkmgr.h"
 #include "serial/usart.h"
 #include "serial/usartd.h"
 #include "trace.h"
@@ -63,6 +66,21 @@ static struct _usart_desc *_serial[USART_IFACE_COUNT];
  *        Internal functions
  *----------------------------------------------------------------------------*/
 
+/**
+ * \brief Release a transfer direction and drop the clock reference taken by
+ * usartd_transfer. The interrupt handler releases both directions on each
+ * event, only the first release of a transfer counts.
+ */
+static void _usartd_release(struct _usart_desc* desc, mutex_t* mutex)
+{
+	uint32_t flags = arch_irq_save();
+	if (mutex_is_locked(mutex)) {
+		clkmgr_put(get_usart_id_from_addr(desc->addr));
+		mutex_unlock(mutex);
+	}
+	arch_irq_restore(flags);
+}
+
 static int _usartd_dma_write_callback(void* arg, void* arg2)
 {
 	uint8_t iface = (uint32_t)arg;
@@ -70,7 +88,7 @@ static int _usartd_dma_write_callback(void* arg, void* arg2)
 
 	dma_reset_channel(_serial[iface]->dma.tx.channel);
 
-	mutex_unlock(&_serial[iface]->tx.mutex);
+	_usartd_release(_serial[iface], &_serial[iface]->tx.mutex);
 
 	callback_call(&_serial[iface]->tx.callback, NULL);
 
@@ -101,7 +119,7 @@ static int _usartd_dma_read_callback(void* arg, void* arg2)
 
 	desc->rx.buffer.size = 0;
 
-	mutex_unlock(&desc->rx.mutex);
+	_usartd_release(desc, &desc->rx.mutex);
 
 	callback_call(&desc->rx.callback, NULL);
 
@@ -146,6 +164,38 @@ static void _usartd_dma_write(uint8_t iface)
 	dma_start_transfer(desc->dma.tx.channel);
 }
 
+#ifdef CONFIG_HAVE_DVFS
+
+/**
+ * \brief DVFS notifier: refuse clock changes during a transfer, recompute
+ * the baudrate divider afterwards.
+ */
+static int _usartd_dvfs_notifier(enum _dvfs_event event,
+		const struct _dvfs_transition* transition, void* arg)
+{
+	struct _usart_desc* desc = (struct _usart_desc*)arg;
+	uint32_t id;
+
+	switch (event) {
+	case DVFS_PRE_CHANGE:
+		if (mutex_is_locked(&desc->rx.mutex) ||
+		    mutex_is_locked(&desc->tx.mutex))
+			return -EBUSY;
+		break;
+	case DVFS_POST_CHANGE:
+		id = get_usart_id_from_addr(desc->addr);
+		clkmgr_get(id);
+		usart_update_baudrate(desc->addr, desc->baudrate);
+		clkmgr_put(id);
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+#endif /* CONFIG_HAVE_DVFS */
+
 static void _usartd_handler(uint32_t source, void* user_arg)
 {
 	int iface;
@@ -223,11 +273,11 @@ static void _usartd_handler(uint32_t source, void* user_arg)
 	if (_rx_stop) {
 		desc->addr->US_CR = US_CR_STTTO;
 		desc->rx.buffer.size = 0;
-		mutex_unlock(&desc->rx.mutex);
+		_usartd_release(desc, &desc->rx.mutex);
 	}
 	if (_tx_stop) {
 		desc->tx.buffer.size = 0;
-		mutex_unlock(&desc->tx.mutex);
+		_usartd_release(desc, &desc->tx.mutex);
 	}
 }
 
@@ -276,6 +326,12 @@ void usartd_configure(uint8_t iface, struct _usart_desc* config)
 
 	config->dma.tx.channel = dma_allocate_channel(DMA_PERIPH_MEMORY, id);
 	assert(config->dma.tx.channel);
+
+#ifdef CONFIG_HAVE_DVFS
+	config->dvfs.fn = _usartd_dvfs_notifier;
+	config->dvfs.arg = config;
+	dvfs_register_notifier(&config->dvfs);
+#endif
 }
 
 uint32_t usartd_transfer(uint8_t iface, struct _buffer* buf, struct _callback* cb)
@@ -292,6 +348,7 @@ uint32_t usartd_transfer(uint8_t iface, struct _buffer* buf, struct _callback* c
 	if (buf->attr & USARTD_BUF_ATTR_READ) {
 		if (!mutex_try_lock(&desc->rx.mutex))
 			return USARTD_ERROR_LOCK;
+		clkmgr_get(get_usart_id_from_addr(desc->addr));
 
 		desc->rx.transferred = 0;
 		desc->rx.buffer.data = buf->data;
@@ -305,6 +362,7 @@ uint32_t usartd_transfer(uint8_t iface, struct _buffer* buf, struct _callback* c
 	if (buf->attr & USARTD_BUF_ATTR_WRITE) {
 		if (!mutex_try_lock(&desc->tx.mutex))
 			return USARTD_ERROR_LOCK;
+		clkmgr_get(get_usart_id_from_addr(desc->addr));
 
 		desc->tx.transferred = 0;
 		desc->tx.buffer.data = buf->data;
@@ -358,7 +416,7 @@ uint32_t usartd_transfer(uint8_t iface, struct _buffer* buf, struct _callback* c
 
 				if (desc->tx.transferred >= desc->tx.buffer.size) {
 					desc->tx.buffer.size = 0;
-					mutex_unlock(&desc->tx.mutex);
+					_usartd_release(desc, &desc->tx.mutex);
 					callback_call(&desc->tx.callback, NULL);
 				}
 			}
@@ -387,7 +445,7 @@ uint32_t usartd_transfer(uint8_t iface, struct _buffer* buf, struct _callback* c
 							desc->addr->US_CR = US_CR_STTTO;
 							desc->rx.buffer.size = 0;
 							desc->rx.transferred = i;
-							mutex_unlock(&desc->rx.mutex);
+							_usartd_release(desc, &desc->rx.mutex);
 							return USARTD_ERROR_TIMEOUT;
 						}
 						csr = desc->addr->US_CSR;
@@ -400,7 +458,7 @@ uint32_t usartd_transfer(uint8_t iface, struct _buffer* buf, struct _callback* c
 
 				if (desc->rx.transferred >= desc->rx.buffer.size) {
 					desc->rx.buffer.size = 0;
-					mutex_unlock(&desc->rx.mutex);
+					_usartd_release(desc, &desc->rx.mutex);
 					callback_call(&desc->rx.callback, NULL);
 				}
 			}
@@ -436,13 +494,13 @@ uint32_t usartd_transfer(uint8_t iface, struct _buffer* buf, struct _callback* c
 void usartd_finish_rx_transfer(uint8_t iface)
 {
 	assert(iface < USART_IFACE_COUNT);
-	mutex_unlock(&_serial[iface]->rx.mutex);
+	_usartd_release(_serial[iface], &_serial[iface]->rx.mutex);
 }
 
 void usartd_finish_tx_transfer(uint8_t iface)
 {
 	assert(iface < USART_IFACE_COUNT);
-	mutex_unlock(&_serial[iface]->tx.mutex);
+	_usartd_release(_serial[iface], &_serial[iface]->tx.mutex);
 }
 
 uint32_t usartd_rx_is_busy(const uint8_t iface)
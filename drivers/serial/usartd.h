@@ -40,6 +40,9 @@
 #include "dma/dma.h"
 #include "io.h"
 #include "mutex.h"
+#ifdef CONFIG_HAVE_DVFS
+#include "power/dvfs.h"
+#endif
 #include "serial/usart.h"
 
 /*----------------------------------------------------------------------------
@@ -81,6 +84,10 @@ struct _usart_desc
 		struct _callback callback;
 	} rx, tx;
 
+#ifdef CONFIG_HAVE_DVFS
+	struct _dvfs_notifier dvfs; /* clock change notifier */
+#endif
+
 #ifdef CONFIG_HAVE_USART_FIFO
 	bool use_fifo;
 	struct {
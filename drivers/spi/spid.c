@@ -46,6 +46,7 @@
 #include "peripherals/flexcom.h"
 #endif
 #include "peripherals/pmc.h"
+#include "power/clkmgr.h"
 #include "spi/spi.h"
 #include "spi/spid.h"
 #include "trace.h"
@@ -300,11 +301,51 @@ static void _spid_transfer_next_buffer(struct _spi_desc* desc)
 			spi_release_cs(desc->addr);
 
 		desc->xfer.current = NULL;
+		clkmgr_put(get_spi_id_from_addr(desc->addr));
 		mutex_unlock(&desc->mutex);
 		callback_call(&desc->xfer.callback, NULL);
 	}
 }
 
+#ifdef CONFIG_HAVE_DVFS
+
+/**
+ * \brief DVFS notifier: refuse clock changes during a transfer, recompute
+ * the chip select dividers and delays afterwards.
+ */
+static int _spid_dvfs_notifier(enum _dvfs_event event,
+		const struct _dvfs_transition* transition, void* arg)
+{
+	struct _spi_desc* desc = (struct _spi_desc*)arg;
+	uint32_t id;
+	int i;
+
+	switch (event) {
+	case DVFS_PRE_CHANGE:
+		if (spid_is_busy(desc))
+			return -EBUSY;
+		break;
+	case DVFS_POST_CHANGE:
+		id = get_spi_id_from_addr(desc->addr);
+		clkmgr_get(id);
+		for (i = 0; i < SPID_CS_COUNT; i++) {
+			if (!desc->cs[i].configured)
+				continue;
+			spi_configure_cs(desc->addr, i, desc->cs[i].bitrate,
+					desc->cs[i].delay_dlybs,
+					desc->cs[i].delay_dlybct,
+					desc->cs[i].mode);
+		}
+		clkmgr_put(id);
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+#endif /* CONFIG_HAVE_DVFS */
+
 /*----------------------------------------------------------------------------
  *        Public functions
  *----------------------------------------------------------------------------*/
@@ -327,6 +368,7 @@ int spid_transfer(struct _spi_desc* desc,
 		trace_error("SPID mutex already locked!\r\n");
 		return -EBUSY;
 	}
+	clkmgr_get(get_spi_id_from_addr(desc->addr));
 
 	spi_select_cs(desc->addr, desc->chip_select);
 
@@ -376,6 +418,13 @@ int spid_configure(struct _spi_desc* desc)
 
 	spi_enable(desc->addr);
 
+#ifdef CONFIG_HAVE_DVFS
+	memset(desc->cs, 0, sizeof(desc->cs));
+	desc->dvfs.fn = _spid_dvfs_notifier;
+	desc->dvfs.arg = desc;
+	dvfs_register_notifier(&desc->dvfs);
+#endif
+
 	return 0;
 }
 
@@ -400,19 +449,40 @@ void spid_configure_cs(struct _spi_desc* desc, uint8_t cs,
 		break;
 	}
 
+#ifdef CONFIG_HAVE_DVFS
+	assert(cs < SPID_CS_COUNT);
+	desc->cs[cs].configured = true;
+	desc->cs[cs].bitrate = bitrate;
+	desc->cs[cs].delay_dlybs = delay_dlybs;
+	desc->cs[cs].delay_dlybct = delay_dlybct;
+	desc->cs[cs].mode = csr;
+#endif
+
+	clkmgr_get(get_spi_id_from_addr(desc->addr));
 	spi_configure_cs(desc->addr, cs, bitrate, delay_dlybs, delay_dlybct, csr);
+	clkmgr_put(get_spi_id_from_addr(desc->addr));
 }
 
 void spid_set_cs_bitrate(struct _spi_desc* desc, uint8_t cs, uint32_t bitrate)
 {
+#ifdef CONFIG_HAVE_DVFS
+	assert(cs < SPID_CS_COUNT);
+	desc->cs[cs].bitrate = bitrate;
+#endif
+	clkmgr_get(get_spi_id_from_addr(desc->addr));
 	spi_set_cs_bitrate(desc->addr, cs, bitrate);
+	clkmgr_put(get_spi_id_from_addr(desc->addr));
 }
 
 int spid_configure_master(struct _spi_desc* desc, bool master)
 {
+	uint32_t id = get_spi_id_from_addr(desc->addr);
+
+	clkmgr_get(id);
 	spi_disable(desc->addr);
 	spi_mode_master_enable(desc->addr, master);
 	spi_enable(desc->addr);
+	clkmgr_put(id);
 
 	return 0;
 }
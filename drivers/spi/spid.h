@@ -41,6 +41,15 @@
 #include "dma/dma.h"
 #include "io.h"
 #include "mutex.h"
+#ifdef CONFIG_HAVE_DVFS
+#include "power/dvfs.h"
+#endif
+
+/*------------------------------------------------------------------------------
+ *        Constants
+ *----------------------------------------------------------------------------*/
+
+#define SPID_CS_COUNT 4
 
 /*------------------------------------------------------------------------------
  *        Types
@@ -59,6 +68,17 @@ struct _spi_desc {
 	int transfer_mode;
 	/* following fields are used internally */
 	mutex_t mutex;
+#ifdef CONFIG_HAVE_DVFS
+	struct _dvfs_notifier dvfs; /* clock change notifier */
+	/* chip select settings, recomputed when the peripheral clock changes */
+	struct {
+		bool configured; /* configured by spid_configure_cs() */
+		uint32_t bitrate;
+		uint32_t delay_dlybs;
+		uint32_t delay_dlybct;
+		uint32_t mode;
+	} cs[SPID_CS_COUNT];
+#endif
 
 #ifdef CONFIG_HAVE_SPI_FIFO
 	bool use_fifo;
@@ -55,6 +55,15 @@ static const struct sensor_profile* sensor_profiles[SENSOR_SUPPORTED_NUMBER] = {
 	&ov9740_profile
 };
 
+/** Output applied last, NULL if unknown */
+static const struct sensor_output* sensor_current;
+
+/** Context of the packed table bus operations */
+struct _sensor_pack_ctx {
+	uint8_t bus;
+	const struct sensor_profile* profile;
+};
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -178,6 +187,83 @@ static int sensor_twi_write_reg(uint8_t twi_mode, uint8_t bus, uint8_t addr,
 	return err;
 }
 
+/**
+ * \brief Write consecutive registers with one sequential write.
+ * \param bus  TWI bus
+ * \param addr Sensor TWI addr
+ * \param reg First register to be written
+ * \param data Data written
+ * \param count Number of registers
+ * \return 0 if no error; otherwise a negative error
+ */
+static int sensor_twi_write_seq(uint8_t twi_mode, uint8_t bus, uint8_t addr,
+				uint16_t reg, const uint8_t *data, uint16_t count)
+{
+	int err;
+	uint8_t addr_buf[2];
+	struct _buffer buf[2] = {
+		{
+			.data = addr_buf,
+			/* .size */
+			.attr = BUS_I2C_BUF_ATTR_START | BUS_BUF_ATTR_TX,
+		},
+		{
+			.data = (uint8_t*)data,
+			.size = count,
+			.attr = BUS_BUF_ATTR_TX | BUS_I2C_BUF_ATTR_STOP,
+		},
+	};
+
+	switch (twi_mode){
+	case SENSOR_TWI_REG_BYTE_DATA_BYTE:
+		buf[0].size = 1;
+		addr_buf[0] = reg & 0xff;
+		break;
+
+	case SENSOR_TWI_REG_2BYTE_DATA_BYTE:
+		buf[0].size = 2;
+		addr_buf[0] = (reg >> 8) & 0xff;
+		addr_buf[1] = reg & 0xff;
+		break;
+
+	default:
+		return -EINVAL;
+	}
+
+	bus_start_transaction(bus);
+	err = bus_transfer(bus, addr, buf, 2, NULL);
+	bus_stop_transaction(bus);
+
+	return err;
+}
+
+static int sensor_pack_write(void* arg, uint16_t reg, const uint8_t* data,
+			     uint16_t count)
+{
+	struct _sensor_pack_ctx* ctx = (struct _sensor_pack_ctx*)arg;
+	const struct sensor_profile* profile = ctx->profile;
+	int err;
+	uint16_t i;
+
+	if (profile->flags & SENSOR_FLAG_BURST)
+		return sensor_twi_write_seq(profile->twi_inf_mode, ctx->bus,
+					    profile->addr, reg, data, count);
+
+	for (i = 0; i < count; i++) {
+		err = sensor_twi_write_seq(profile->twi_inf_mode, ctx->bus,
+					   profile->addr, reg + i, data + i, 1);
+		msleep(2);
+		if (err < 0)
+			return err;
+	}
+	return 0;
+}
+
+static void sensor_pack_delay(void* arg, uint32_t ms)
+{
+	msleep(ms);
+}
+
 /**
  * \brief Read and check sensor product ID.
  * \param twi_bus  TWI bus
@@ -245,32 +331,125 @@ static uint32_t sensor_twi_write_regs(uint8_t twi_bus,
 	return SENSOR_OK;
 }
 
-/*----------------------------------------------------------------------------
- *        Exported functions
- *----------------------------------------------------------------------------*/
+/**
+ * \brief  Write a packed register table.
+ * \param twi_bus  TWI bus
+ * \param sensor_profile   Sensor private profile
+ * \param table Packed table to be written
+ * \param current Packed table applied last, to write only the differences,
+ * or NULL
+ * \return SENSOR_OK if no error; otherwise SENSOR_TWI_ERROR
+ */
+static uint32_t sensor_twi_write_packed(uint8_t twi_bus,
+					struct sensor_profile* sensor_profile,
+					const uint8_t* table,
+					const uint8_t* current)
+{
+	struct _sensor_pack_ctx ctx = {
+		.bus = twi_bus,
+		.profile = sensor_profile,
+	};
+	struct sensor_pack_ops ops = {
+		.write = sensor_pack_write,
+		.delay = sensor_pack_delay,
+		.arg = &ctx,
+	};
+	int written;
 
-uint32_t sensor_setup(uint8_t twi_bus, struct sensor_profile* sensor_profile,
-					  uint8_t resolution,
-					  uint8_t format)
+	written = sensor_pack_apply(table, current, &ops);
+	if (written < 0)
+		return SENSOR_TWI_ERROR;
+
+	trace_debug("SENSOR %d registers written\n\r", written);
+	return SENSOR_OK;
+}
+
+/**
+ * \brief Find the output matching a resolution and a format.
+ * \return the output, or NULL if not supported.
+ */
+static const struct sensor_output* sensor_find_output(struct sensor_profile* sensor_profile,
+						      uint8_t resolution,
+						      uint8_t format)
 {
 	uint8_t i;
-	uint8_t found = 0;
 
 	for (i = 0; i < SENSOR_SUPPORTED_OUTPUTS; i++) {
+		if (!sensor_profile->output_conf[i])
+			break;
 		if (sensor_profile->output_conf[i]->supported){
 			if (sensor_profile->output_conf[i]->output_resolution == resolution) {
-				if (sensor_profile->output_conf[i]->output_format == format) {
-					found = 1;
-					break;
-				}
+				if (sensor_profile->output_conf[i]->output_format == format)
+					return sensor_profile->output_conf[i];
 			}
 		}
 	}
-	if (found == 0)
+	return NULL;
+}
+
+/**
+ * \brief Write the settings of an output.
+ * \param current Output applied last, or NULL to write all the settings.
+ */
+static uint32_t sensor_write_output(uint8_t twi_bus,
+				    struct sensor_profile* sensor_profile,
+				    const struct sensor_output* output,
+				    const struct sensor_output* current)
+{
+	uint32_t status;
+
+	sensor_current = NULL;
+	if (output->output_packed) {
+		status = sensor_twi_write_packed(twi_bus, sensor_profile,
+				output->output_packed,
+				current ? current->output_packed : NULL);
+	} else {
+		status = sensor_twi_write_regs(twi_bus, sensor_profile,
+					       output->output_setting);
+	}
+	if (status == SENSOR_OK)
+		sensor_current = output;
+
+	return status;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+uint32_t sensor_setup(uint8_t twi_bus, struct sensor_profile* sensor_profile,
+					  uint8_t resolution,
+					  uint8_t format)
+{
+	const struct sensor_output* output;
+
+	output = sensor_find_output(sensor_profile, resolution, format);
+	if (!output)
 		return SENSOR_RESOLUTION_NOT_SUPPORTED;
 
-	return sensor_twi_write_regs(twi_bus, sensor_profile,
-								 sensor_profile->output_conf[i]->output_setting);
+	return sensor_write_output(twi_bus, sensor_profile, output, NULL);
+}
+
+uint32_t sensor_switch(uint8_t twi_bus, struct sensor_profile* sensor_profile,
+					   uint8_t resolution,
+					   uint8_t format)
+{
+	const struct sensor_output* output;
+	const struct sensor_output* current = NULL;
+	uint8_t i;
+
+	output = sensor_find_output(sensor_profile, resolution, format);
+	if (!output)
+		return SENSOR_RESOLUTION_NOT_SUPPORTED;
+
+	/* only an output of the same sensor can be the base of a switch */
+	if (sensor_current && (sensor_profile->flags & SENSOR_FLAG_DIFF)) {
+		for (i = 0; i < SENSOR_SUPPORTED_OUTPUTS; i++)
+			if (sensor_profile->output_conf[i] == sensor_current)
+				current = sensor_current;
+	}
+
+	return sensor_write_output(twi_bus, sensor_profile, output, current);
 }
 
 struct sensor_profile* sensor_detect(uint8_t twi_bus, bool detect_auto, uint8_t id)
@@ -278,6 +457,9 @@ struct sensor_profile* sensor_detect(uint8_t twi_bus, bool detect_auto, uint8_t
 	uint8_t i;
 	struct sensor_profile *sensor;
 
+	/* state of the sensor unknown until the next setup */
+	sensor_current = NULL;
+
 	if (!detect_auto) {
 		sensor = (struct sensor_profile*)sensor_profiles[id];
 		if (sensor_check_pid(twi_bus, sensor) == SENSOR_OK)
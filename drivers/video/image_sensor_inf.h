@@ -38,6 +38,7 @@
 
 #include <stdint.h>
 #include "board.h"
+#include "video/sensor_pack.h"
 
 /*---------------------------------------------------------------------------
  *         Definitions
@@ -58,6 +59,12 @@
 /** terminating list entry for value in configuration file */
 #define SENSOR_VAL_TERM         0xFF
 
+/** the sensor supports sequential writes (register address auto-increment) */
+#define SENSOR_FLAG_BURST       (1u << 0)
+/** the register map is flat: outputs can be switched by writing only the
+ * registers that differ */
+#define SENSOR_FLAG_DIFF        (1u << 1)
+
 /*----------------------------------------------------------------------------
  *        Types
  *----------------------------------------------------------------------------*/
@@ -125,6 +132,7 @@ struct sensor_output {
 	uint32_t output_width;                      /** output width */
 	uint32_t output_height;                     /** output height */
 	const struct sensor_reg* output_setting;    /** sensor registers setting */
+	const uint8_t* output_packed;               /** packed registers setting, used instead of output_setting if not NULL */
 };
 
 /** define a structure for sensor profile */
@@ -139,6 +147,7 @@ struct sensor_profile {
 	uint16_t pid_low;             /** product ID low byte */
 	uint16_t version_mask;        /** version mask */
 	const struct sensor_output* output_conf[SENSOR_SUPPORTED_OUTPUTS]; /** sensor settings */
+	uint8_t flags;                /** SENSOR_FLAG_xxx */
 };
 
 /*----------------------------------------------------------------------------
@@ -178,6 +187,22 @@ extern uint32_t sensor_setup(uint8_t twi_bus,
 							 uint8_t resolution,
 							 uint8_t format);
 
+/**
+ * \brief Switch the sensor to another output.
+ * Same as sensor_setup() but, if the sensor profile has SENSOR_FLAG_DIFF and
+ * the current and requested outputs have packed settings, only the
+ * registers that differ from the current output are written.
+ * \param twi_bus TWI bus
+ * \param sensor pointer to a sensor profile instance.
+ * \param resolution resolution request
+ * \param format format request
+ * \return SENSOR_OK if no error; otherwise return SENSOR_XXX_ERROR
+ */
+extern uint32_t sensor_switch(uint8_t twi_bus,
+							  struct sensor_profile* sensor,
+							  uint8_t resolution,
+							  uint8_t format);
+
 /**
  * \brief Retrieves sensor output bit width and size for giving resolution and format.
  * \param sensor pointer to a sensor profile instance.
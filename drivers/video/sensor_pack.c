@@ -0,0 +1,239 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "video/sensor_pack.h"
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Find the state part of a table.
+ * \return the first record after the last reset, or the table itself.
+ */
+static const uint8_t* _sensor_pack_body(const uint8_t* table)
+{
+	struct sensor_pack_rec rec;
+	const uint8_t* body = table;
+	const uint8_t* p = table;
+
+	while (p) {
+		p = sensor_pack_next(p, &rec);
+		if (rec.type == SENSOR_PACK_RESET)
+			body = p;
+	}
+
+	return body;
+}
+
+/**
+ * \brief Count the writes of a register.
+ * \param p  First record to search.
+ * \param reg  Register.
+ * \param val  Last value written, updated if found.
+ * \return the number of writes.
+ */
+static uint32_t _sensor_pack_lookup(const uint8_t* p, uint16_t reg,
+		uint8_t* val)
+{
+	struct sensor_pack_rec rec;
+	uint32_t writes = 0;
+
+	while (p) {
+		p = sensor_pack_next(p, &rec);
+		if (rec.type != SENSOR_PACK_SEQ && rec.type != SENSOR_PACK_RESET)
+			continue;
+		if (reg >= rec.reg && reg < rec.reg + rec.count) {
+			*val = rec.data[reg - rec.reg];
+			writes++;
+		}
+	}
+
+	return writes;
+}
+
+/**
+ * \brief Check that target can be applied over current by differences.
+ */
+static bool _sensor_pack_diffable(const uint8_t* target, const uint8_t* tbody,
+		const uint8_t* current, const uint8_t* cbody)
+{
+	struct sensor_pack_rec rec;
+	const uint8_t* p;
+	uint8_t val;
+	uint32_t i;
+
+	/* same writes up to the reset */
+	if (tbody - target != cbody - current)
+		return false;
+	if (memcmp(target, current, tbody - target))
+		return false;
+
+	/* no register left with a value target relies on being the default */
+	for (p = cbody; p; ) {
+		p = sensor_pack_next(p, &rec);
+		if (rec.type != SENSOR_PACK_SEQ)
+			continue;
+		for (i = 0; i < rec.count; i++)
+			if (!_sensor_pack_lookup(tbody, rec.reg + i, &val))
+				return false;
+	}
+
+	return true;
+}
+
+static bool _sensor_pack_skip(const uint8_t* tbody, const uint8_t* cbody,
+		uint16_t reg, uint8_t val)
+{
+	uint8_t tval, cval;
+
+	if (_sensor_pack_lookup(tbody, reg, &tval) != 1)
+		return false;
+	if (_sensor_pack_lookup(cbody, reg, &cval) != 1)
+		return false;
+	return cval == val;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+const uint8_t* sensor_pack_next(const uint8_t* p, struct sensor_pack_rec* rec)
+{
+	if (p[0] < SENSOR_SEQ_MAX) {
+		rec->type = SENSOR_PACK_SEQ;
+		rec->count = p[0] + 1;
+		rec->reg = (p[1] << 8) | p[2];
+		rec->data = p + 3;
+		return p + 3 + rec->count;
+	}
+
+	switch (p[0]) {
+	case SENSOR_PACK_OP_RESET:
+		rec->type = SENSOR_PACK_RESET;
+		rec->count = 1;
+		rec->reg = (p[1] << 8) | p[2];
+		rec->data = p + 3;
+		return p + 4;
+	case SENSOR_PACK_OP_DELAY:
+		rec->type = SENSOR_PACK_DELAY;
+		rec->count = p[1];
+		rec->reg = 0;
+		rec->data = NULL;
+		return p + 2;
+	default:
+		rec->type = SENSOR_PACK_END;
+		rec->count = 0;
+		rec->reg = 0;
+		rec->data = NULL;
+		return NULL;
+	}
+}
+
+int sensor_pack_apply(const uint8_t* target, const uint8_t* current,
+		const struct sensor_pack_ops* ops)
+{
+	struct sensor_pack_rec rec;
+	const uint8_t* tbody = _sensor_pack_body(target);
+	const uint8_t* cbody = NULL;
+	const uint8_t* p = target;
+	bool diff = false;
+	bool dirty = false;
+	int written = 0;
+	int err;
+
+	if (current) {
+		cbody = _sensor_pack_body(current);
+		diff = _sensor_pack_diffable(target, tbody, current, cbody);
+		if (diff) {
+			/* the sensor is already past the reset */
+			p = tbody;
+		}
+	}
+
+	while (p) {
+		uint16_t i, j;
+
+		p = sensor_pack_next(p, &rec);
+		switch (rec.type) {
+		case SENSOR_PACK_SEQ:
+		case SENSOR_PACK_RESET:
+			for (i = 0; i < rec.count; i = j) {
+				if (diff && _sensor_pack_skip(tbody, cbody,
+						rec.reg + i, rec.data[i])) {
+					j = i + 1;
+					continue;
+				}
+				for (j = i + 1; j < rec.count; j++)
+					if (diff && _sensor_pack_skip(tbody, cbody,
+							rec.reg + j, rec.data[j]))
+						break;
+				err = ops->write(ops->arg, rec.reg + i,
+						rec.data + i, j - i);
+				if (err < 0)
+					return err;
+				written += j - i;
+				dirty = true;
+			}
+			break;
+		case SENSOR_PACK_DELAY:
+			/* a delay lets the previous writes settle: not needed
+			 * if they were all skipped */
+			if (!diff || dirty)
+				ops->delay(ops->arg, rec.count);
+			dirty = false;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return written;
+}
+
+uint32_t sensor_pack_size(const uint8_t* table)
+{
+	struct sensor_pack_rec rec;
+	const uint8_t* p = table;
+	const uint8_t* next;
+
+	while ((next = sensor_pack_next(p, &rec)))
+		p = next;
+
+	return (uint32_t)(p - table) + 1;
+}
@@ -0,0 +1,155 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Packed image sensor register tables.
+ *
+ * A packed table is a byte stream of records built with the macros below:
+ *
+ * - SENSOR_SEQ(reg, count) followed by count values: registers reg to
+ *   reg + count - 1, written with one sequential (auto-increment) write on
+ *   sensors supporting it.
+ * - SENSOR_RESET(reg, val): the write resetting the sensor. Everything after
+ *   the last reset is the state of the sensor for the table.
+ * - SENSOR_DELAY(ms): wait before the next write.
+ * - SENSOR_END: end of the table.
+ *
+ * Registers are always given on 16 bits and values on 8 bits. The tables
+ * are produced from struct sensor_reg arrays by scripts/sensorpack.
+ *
+ * sensor_pack_apply() writes a table, or only the part of it differing
+ * from the table currently applied. This module does not access the bus,
+ * the same code builds in the host tool.
+ */
+
+#ifndef SENSOR_PACK_H
+#define SENSOR_PACK_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*---------------------------------------------------------------------------
+ *         Definitions
+ *---------------------------------------------------------------------------*/
+
+/** Largest number of registers of a SENSOR_SEQ record */
+#define SENSOR_SEQ_MAX          128
+
+#define SENSOR_PACK_OP_RESET    0x80
+#define SENSOR_PACK_OP_DELAY    0x81
+#define SENSOR_PACK_OP_END      0xFF
+
+#define SENSOR_SEQ(reg, count) \
+	((count) - 1), (((reg) >> 8) & 0xFF), ((reg) & 0xFF)
+
+#define SENSOR_RESET(reg, val) \
+	SENSOR_PACK_OP_RESET, (((reg) >> 8) & 0xFF), ((reg) & 0xFF), (val)
+
+#define SENSOR_DELAY(ms) \
+	SENSOR_PACK_OP_DELAY, (ms)
+
+#define SENSOR_END \
+	SENSOR_PACK_OP_END
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Packed record type */
+enum {
+	SENSOR_PACK_SEQ = 0,
+	SENSOR_PACK_RESET,
+	SENSOR_PACK_DELAY,
+	SENSOR_PACK_END
+};
+
+/** Decoded packed record */
+struct sensor_pack_rec {
+	uint8_t type;           /** SENSOR_PACK_xxx */
+	uint16_t reg;           /** first register (SEQ, RESET) */
+	uint16_t count;         /** number of values (SEQ, RESET) or ms (DELAY) */
+	const uint8_t* data;    /** values (SEQ, RESET) */
+};
+
+/** Bus operations used to apply a packed table */
+struct sensor_pack_ops {
+	/** write count consecutive registers, return 0 or a negative error */
+	int (*write)(void* arg, uint16_t reg, const uint8_t* data, uint16_t count);
+	/** wait ms milliseconds */
+	void (*delay)(void* arg, uint32_t ms);
+	void* arg;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Decode a record of a packed table.
+ * \param p  Record.
+ * \param rec  Decoded record.
+ * \return the next record, or NULL if p is the end of the table.
+ */
+extern const uint8_t* sensor_pack_next(const uint8_t* p,
+		struct sensor_pack_rec* rec);
+
+/**
+ * \brief Write a packed table.
+ *
+ * When current is not NULL, it is the table applied last to the sensor
+ * and only the differences are written, if it is safe: both tables have
+ * the same writes up to their last reset, which is not repeated, and every
+ * register set by current after its reset is also set by target. A write
+ * is then skipped if its register is written once by each table, with the
+ * same value. Registers written several times (control or strobe
+ * registers) are always written, in order. Otherwise the whole table is
+ * written.
+ *
+ * \param target  Table to apply.
+ * \param current  Table currently applied, or NULL.
+ * \param ops  Bus operations.
+ * \return the number of registers written, or a negative error returned
+ * by ops->write.
+ */
+extern int sensor_pack_apply(const uint8_t* target, const uint8_t* current,
+		const struct sensor_pack_ops* ops);
+
+/**
+ * \brief Size of a packed table.
+ * \param table  Table.
+ * \return the size in bytes, including SENSOR_END.
+ */
+extern uint32_t sensor_pack_size(const uint8_t* table);
+
+#endif /* SENSOR_PACK_H */
@@ -2,7 +2,7 @@
 #define LWIPOPTS_H
 
 #define NO_SYS                          1
-#define NO_SYS_NO_TIMERS                1
+#define NO_SYS_NO_TIMERS                0
 
 #define LWIP_MPU_COMPATIBLE             0
 #define LWIP_TCPIP_CORE_LOCKING         0
@@ -11,6 +11,14 @@
 
 #define MEM_ALIGNMENT                   4
 
+/* Checksums offloaded to the MAC are disabled per netif by ethif, the
+ * CHECKSUM_GEN_* and CHECKSUM_CHECK_* defaults must remain enabled */
+#define LWIP_CHECKSUM_CTRL_PER_NETIF    1
+
+/* Compute the checksum of TCP/UDP payloads while copying them into pbufs
+ * (LWIP_CHKSUM_COPY, see arch/cc.h) rather than in a second pass */
+#define LWIP_CHECKSUM_ON_COPY           1
+
 #define LWIP_ARP                        1
 #define LWIP_ETHERNET                   LWIP_ARP
 
@@ -26,7 +34,7 @@
 
 #define LWIP_AUTOIP                     0
 
-#define LWIP_IGMP                       0
+#define LWIP_IGMP                       1
 
 #define LWIP_DNS                        0
 
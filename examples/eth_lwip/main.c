@@ -116,6 +116,14 @@
 #include "liblwip.h"
 #include "lwip/apps/httpd.h"
 #include "lwip/apps/lwiperf.h"
+#include "arch/sys_arch.h"
+#include "arch/sys_loop.h"
+#ifdef CONFIG_LIB_LWIP_PTPD
+#include "apps/ptpd.h"
+#ifdef CONFIG_HAVE_GMAC
+#include "network/gmacd.h"
+#endif
+#endif
 
 #include <stdio.h>
 #include <string.h>
@@ -246,8 +254,25 @@ int main(void)
 	httpd_init();
 	lwiperf_start_tcp_server_default(lwiperf_report, NULL);
 	printf ("Type the IP address of the device in a web browser, http://192.168.1.3 \n\r");
+
+#if defined(CONFIG_LIB_LWIP_PTPD) && defined(CONFIG_HAVE_GMAC)
+	/* Synchronize the GMAC timestamp unit to a PTP master */
+	if (netif->num == 0 && BOARD_ETH0_TYPE == ETH_TYPE_GMAC) {
+		gmacd_ptp_enable(board_get_eth(0), true);
+		if (ptpd_start(netif, &ptpd_gmac_clock, board_get_eth(0), 0) == ERR_OK)
+			printf(" - PTP slave started on domain 0\n\r");
+	}
+#endif
+
+	/* Process frames in interrupt/polling mode, sleep when idle */
+	sys_loop_init(sys_arch_idle);
+	ethif_loop_add(netif);
+
 	while (1) {
 		/* Run polling tasks */
-		ethif_poll(netif);
+		sys_loop_run_once();
+#ifdef CONFIG_LIB_LWIP_PTPD
+		ptpd_poll();
+#endif
 	}
 }
@@ -52,6 +52,9 @@
 
 #include <board.h>
 #include <chip.h>
+#include "crc32.h"
+#include "intmath.h"
+#include "timer.h"
 #include "trace.h"
 
 #include "gpio/pio.h"
@@ -63,6 +66,7 @@
 
 #include "pin_defs.h"
 
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -72,7 +76,10 @@
  *        Local definitions
  *----------------------------------------------------------------------------*/
 /* Software version */
-#define VERSION "1.0"
+#define VERSION "1.1"
+
+/* Size of the buffer used to read back the flash */
+#define READ_BUFFER_SIZE 1024
 
 /*----------------------------------------------------------------------------
  *        Local Varible
@@ -90,6 +97,34 @@ uint32_t instance;
 uint32_t ioset;
 uint32_t freq;
 
+/* Verify the written data (--verify option) */
+static bool verify;
+
+/* Last write, programmed but not verified yet */
+static struct {
+	uint32_t addr;
+	uint32_t length;
+	uint32_t crc;
+} pending;
+
+static uint8_t read_buffer[READ_BUFFER_SIZE];
+
+/* Throughput statistics */
+static struct {
+	uint64_t start;       /* end of FlashInit (us) */
+	uint64_t busy;        /* time spent waiting for the flash (us) */
+	uint64_t verify;      /* time spent verifying (us) */
+	uint32_t erased;      /* bytes */
+	uint32_t verified;    /* bytes */
+	bool reported;
+} stats;
+
+/* CRC16 of the flash loader framework, used by C-SPY checksums */
+extern uint16_t Crc16_helper(uint8_t const *p, uint32_t len, uint16_t sum);
+
+/* Breakpoint of the flash loader framework, where C-SPY takes back control */
+extern void FlashBreak(void);
+
 /*----------------------------------------------------------------------------
  *         Local functions
  *----------------------------------------------------------------------------*/
@@ -112,6 +147,71 @@ static bool configure_instance_pio(uint32_t instance, uint32_t ioset, Qspi** add
 	return false;
 }
 
+static uint32_t _kbps(uint32_t bytes, uint64_t us)
+{
+	if (us == 0)
+		return 0;
+	return (uint32_t)(((uint64_t)bytes * 1000000) / (us * 1024));
+}
+
+static void _report_stats(void)
+{
+	uint64_t elapsed = timer_get_us() - stats.start;
+
+	if (stats.reported)
+		return;
+	stats.reported = true;
+
+	printf("-I- Wrote %u KB in %u ms: %u KB/s (flash busy %u ms, %u KB erased)\n\r",
+		(unsigned)(sizeWritten / 1024), (unsigned)(elapsed / 1000),
+		(unsigned)_kbps(sizeWritten, elapsed),
+		(unsigned)(stats.busy / 1000), (unsigned)(stats.erased / 1024));
+	if (verify)
+		printf("-I- Verified %u KB in %u ms: %u KB/s\n\r",
+			(unsigned)(stats.verified / 1024),
+			(unsigned)(stats.verify / 1000),
+			(unsigned)_kbps(stats.verified, stats.verify));
+}
+
+/*
+ * Read back the data of the last write and compare it with the CRC computed
+ * while it was programmed. This is done on the next call, once the last page
+ * of the write is programmed, so that the host can send the next buffer
+ * meanwhile.
+ */
+static uint32_t _verify_pending(void)
+{
+	uint64_t start;
+	uint32_t offset, count, crc = 0;
+
+	if (pending.length == 0)
+		return RESULT_OK;
+
+	start = timer_get_us();
+	for (offset = 0; offset < pending.length; offset += count) {
+		count = min_u32(pending.length - offset, sizeof(read_buffer));
+		if (qspiflash_read(&flash, pending.addr + offset, read_buffer, count) < 0) {
+			printf("-E- Failed to read back!\n\r");
+			pending.length = 0;
+			return RESULT_ERROR;
+		}
+		crc = crc32_update(crc, read_buffer, count);
+	}
+	stats.verify += timer_get_us() - start;
+	stats.verified += pending.length;
+
+	if (crc != pending.crc) {
+		printf("-E- Verify failed: address 0x%08x of 0x%x Bytes\n\r",
+			(unsigned)(base_address + pending.addr),
+			(unsigned)pending.length);
+		pending.length = 0;
+		return RESULT_ERROR;
+	}
+
+	pending.length = 0;
+	return RESULT_OK;
+}
+
 /* override default board init */
 void board_init(void)
 {
@@ -173,6 +273,8 @@ uint32_t FlashInit(void *base_of_flash,
 	arg = findOption("--freq", 1, argc, argv);
 	freq = strtoul(arg, 0, 0);
 
+	verify = findOption("--verify", 0, argc, argv) != NULL;
+
 	uint32_t max_freq = pmc_get_peripheral_clock(ID_QSPI0);
 	if (freq == 0 || (freq * 1000000) > max_freq) {
 		trace_error_wp("Invalid configuration: frequency must be " \
@@ -203,12 +305,20 @@ uint32_t FlashInit(void *base_of_flash,
 	trace_debug("QSPI Flash configured.\n\r");
 
 	sizeWritten = 0;
+	pending.length = 0;
+	memset(&stats, 0, sizeof(stats));
+	stats.start = timer_get_us();
 	return RESULT_OK;
 }
 
 /**
  * \brief Writes a data buffer in the internal flash.
  *
+ * Pages are programmed back to back: each page is sent as soon as the flash
+ * has finished the previous one, and its CRC is computed while it is
+ * programmed. The function returns without waiting for the last page, which
+ * is checked on the next call.
+ *
  * \param block_start  address of the start of the flash memory block affected by the write operation.
  * \param offset_into_block  How far into the current block that this write operation shall start.
  * \param count  Size of data buffer in bytes.
@@ -218,17 +328,51 @@ uint32_t FlashInit(void *base_of_flash,
 
 uint32_t FlashWrite(void *block_start, uint32_t offset_into_block, uint32_t count, char const *buffer)
 {
-  	printf("-I- Write arguments: address 0x%08x,  offset 0x%x of 0x%x Bytes\n\r",
-		(uint32_t)block_start, offset_into_block, count);
-	if (qspiflash_write(&flash, (uint32_t)block_start + offset_into_block - base_address, buffer, count) < 0)
-	{
-	// Write data
-		printf("-E- Failed to write!\n\r");
+	uint32_t addr = (uint32_t)block_start + offset_into_block - base_address;
+	uint32_t page_size = flash.desc->page_size;
+	const uint8_t *ptr = (const uint8_t *)buffer;
+	uint32_t written, crc = 0;
+
+	trace_debug("Write arguments: address 0x%08x,  offset 0x%x of 0x%x Bytes\n\r",
+		(unsigned)block_start, (unsigned)offset_into_block, (unsigned)count);
+
+	if (_verify_pending() != RESULT_OK)
 		return RESULT_ERROR;
+
+	for (written = 0; written < count; ) {
+		/* number of bytes to write in the current page */
+		uint32_t chunk = min_u32(count - written,
+				page_size - (addr + written) % page_size);
+		uint64_t start = timer_get_us();
+		int rc;
+
+		/* wait for the previous page (or erase) and start this one */
+		rc = qspiflash_start_page_program(&flash, addr + written,
+				ptr + written, chunk);
+		stats.busy += timer_get_us() - start;
+		if (rc < 0) {
+			printf("-E- Failed to write!\n\r");
+			return RESULT_ERROR;
+		}
+
+		/* the flash is busy programming the page */
+		if (verify)
+			crc = crc32_update(crc, ptr + written, chunk);
+		written += chunk;
+	}
+
+	if (verify) {
+		pending.addr = addr;
+		pending.length = count;
+		pending.crc = crc;
 	}
 
 	sizeWritten+= count;
 	if (sizeWritten >= sizeTobeWritten) {
+		if (_verify_pending() != RESULT_OK)
+			return RESULT_ERROR;
+		_report_stats();
+
 		printf("-I- Enter to XIP mode!\n\r");
 		/* Start continuous read mode to enter in XIP mode*/
 		if (qspiflash_read(&flash, 0, NULL, 0) < 0) {
@@ -236,13 +380,14 @@ uint32_t FlashWrite(void *block_start, uint32_t offset_into_block, uint32_t coun
 			return RESULT_ERROR;
 		}
 	}
-	printf("-I- Write Done!\n\r");
 	return RESULT_OK;
 }
 
 /**
  * \brief  erase the flash in giving address. (auto erased before program).
  *
+ * The erase is only started: the next program waits for its completion.
+ *
  * \param block_start Address of the start of the flash memory block affected by the write operation.
  * \param block_size  The size of the block, in bytes.
  * \return 0 if successful; otherwise returns an error code.
@@ -252,14 +397,21 @@ uint32_t FlashErase(void *block_start, uint32_t block_size)
 	uint32_t id;
 	uint32_t startAddr;
 
-	printf("-I- Erase arguments: address 0x%08x of 0x%x Bytes\n\r",
-		(uint32_t)block_start, block_size);
+	trace_debug("Erase arguments: address 0x%08x of 0x%x Bytes\n\r",
+		(unsigned)block_start, (unsigned)block_size);
 
 	id = ((uint32_t)block_start - base_address) / block_size;
 	if (SectorErased[id] == 0) {
+		/* the last write cannot be read back during the erase */
+		if (_verify_pending() != RESULT_OK)
+			return RESULT_ERROR;
+
 		startAddr = id * block_size;
-		qspiflash_erase_block(&flash, startAddr, block_size);
-		printf("-I- Erase Done!\n\r");
+		if (qspiflash_start_erase_block(&flash, startAddr, block_size) < 0) {
+			printf("-E- Failed to erase!\n\r");
+			return RESULT_ERROR;
+		}
+		stats.erased += block_size;
 		SectorErased[id] = 1;
 	}
 
@@ -267,11 +419,56 @@ uint32_t FlashErase(void *block_start, uint32_t block_size)
 }
 
 
+/**
+ * \brief  Computes the checksum used by C-SPY to verify the flash contents,
+ * reading the flash with the QSPI read command configured for the device
+ * (quad read when supported) instead of letting C-SPY read it back.
+ *
+ * \param begin  Address of the first byte.
+ * \param count  Number of bytes.
+ * \return the CRC16 of the flash contents. A read error stops the loader in
+ * FlashBreak().
+ */
+OPTIONAL_CHECKSUM
+uint32_t FlashChecksum(void const *begin, uint32_t count)
+{
+	uint32_t addr = (uint32_t)begin - base_address;
+	uint64_t start = timer_get_us();
+	uint8_t zero[2] = { 0, 0 };
+	uint32_t offset, chunk;
+	uint16_t sum = 0;
+
+	for (offset = 0; offset < count; offset += chunk) {
+		chunk = min_u32(count - offset, sizeof(read_buffer));
+		if (qspiflash_read(&flash, addr + offset, read_buffer, chunk) < 0) {
+			/* any returned value could match a checksum */
+			printf("-E- Failed to read!\n\r");
+			FlashBreak();
+		}
+		sum = Crc16_helper(read_buffer, chunk, sum);
+	}
+	sum = Crc16_helper(zero, 2, sum);
+
+	printf("-I- Checksum of %u KB in %u ms: %u KB/s\n\r",
+		(unsigned)(count / 1024),
+		(unsigned)((timer_get_us() - start) / 1000),
+		(unsigned)_kbps(count, timer_get_us() - start));
+
+	/* Back to XIP mode */
+	qspiflash_read(&flash, 0, NULL, 0);
+
+	return sum;
+}
+
 /**
  * \brief  UThis is an optional function. You can implement it if you need to perform
  * some cleanup after flash loading has finished.
  */
+OPTIONAL_SIGNOFF
 uint32_t FlashSignoff()
 {
+	if (_verify_pending() != RESULT_OK)
+		return RESULT_ERROR;
+	_report_stats();
 	return RESULT_OK;
 }
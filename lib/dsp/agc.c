@@ -0,0 +1,95 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "dsp/agc.h"
+#include "dsp/dsp.h"
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void dsp_agc_init(struct _dsp_agc* agc, uint16_t target, uint16_t attack,
+		uint16_t release, int32_t min_gain, int32_t max_gain)
+{
+	agc->target = target;
+	agc->attack = attack;
+	agc->release = release;
+	agc->min_gain = min_gain;
+	agc->max_gain = max_gain;
+	agc->envelope = target;
+	agc->gain = DSP_AGC_GAIN(1);
+	agc->next_gain = DSP_AGC_GAIN(1);
+}
+
+void dsp_agc_update(struct _dsp_agc* agc, uint64_t energy, uint32_t count)
+{
+	int32_t rms, delta;
+	uint64_t gain;
+
+	if (!count)
+		return;
+
+	rms = (int32_t)dsp_isqrt64(energy / count);
+	delta = rms - (int32_t)agc->envelope;
+	delta = (int32_t)(((int64_t)delta *
+			(delta > 0 ? agc->attack : agc->release)) >> 15);
+	agc->envelope += delta;
+	if (agc->envelope == 0)
+		agc->envelope = 1;
+
+	gain = ((uint64_t)agc->target << 16) / agc->envelope;
+	if (gain > (uint64_t)agc->max_gain)
+		gain = agc->max_gain;
+	if (gain < (uint64_t)agc->min_gain)
+		gain = agc->min_gain;
+	agc->next_gain = (int32_t)gain;
+}
+
+void dsp_agc_apply(struct _dsp_agc* agc, int16_t* x, uint32_t count)
+{
+	int32_t gain = agc->gain;
+	int32_t step;
+	uint32_t i;
+
+	if (!count)
+		return;
+
+	step = (agc->next_gain - gain) / (int32_t)count;
+	for (i = 0; i < count; i++) {
+		gain += step;
+		x[i] = (int16_t)dsp_sat16(dsp_smulwb(gain, x[i]));
+	}
+	agc->gain = agc->next_gain;
+}
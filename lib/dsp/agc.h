@@ -0,0 +1,115 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Automatic gain control, Q15 samples.
+ *
+ * The input level is the block RMS, smoothed by an envelope follower with
+ * separate attack (rising level) and release (falling level) coefficients.
+ * The gain bringing the envelope to the target level, bounded, is reached
+ * by a linear ramp over the next block so that gain changes do not click.
+ */
+
+#ifndef DSP_AGC_H_
+#define DSP_AGC_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Macros
+ *----------------------------------------------------------------------------*/
+
+/** Q16 gain of a constant */
+#define DSP_AGC_GAIN(x) ((int32_t)((x) * 65536.0))
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct _dsp_agc {
+	uint16_t target;    /**< output RMS target, Q15 */
+	uint16_t attack;    /**< envelope rise coefficient per block, Q15 */
+	uint16_t release;   /**< envelope fall coefficient per block, Q15 */
+	int32_t min_gain;   /**< Q16 */
+	int32_t max_gain;   /**< Q16 */
+
+	uint32_t envelope;  /**< input RMS estimate, Q15 */
+	int32_t gain;       /**< gain reached at the end of the last block, Q16 */
+	int32_t next_gain;  /**< gain to reach over the next block, Q16 */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize an AGC, with unity gain.
+ * \param agc  AGC.
+ * \param target  Output RMS target, Q15.
+ * \param attack  Envelope rise coefficient per block, Q15 (32767: instant).
+ * \param release  Envelope fall coefficient per block, Q15.
+ * \param min_gain  Minimum gain, Q16.
+ * \param max_gain  Maximum gain, Q16.
+ */
+extern void dsp_agc_init(struct _dsp_agc* agc, uint16_t target,
+		uint16_t attack, uint16_t release, int32_t min_gain,
+		int32_t max_gain);
+
+/**
+ * \brief Update the level estimate and the gain from a block.
+ * \param agc  AGC.
+ * \param energy  Energy of the block, see dsp_energy_q15().
+ * \param count  Number of samples in the block.
+ */
+extern void dsp_agc_update(struct _dsp_agc* agc, uint64_t energy,
+		uint32_t count);
+
+/**
+ * \brief Apply the gain to a block, ramping to the last computed gain.
+ * \param agc  AGC.
+ * \param x  Samples, processed in place.
+ * \param count  Number of samples.
+ */
+extern void dsp_agc_apply(struct _dsp_agc* agc, int16_t* x, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_AGC_H_ */
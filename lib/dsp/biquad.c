@@ -0,0 +1,177 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dsp/biquad.h"
+#include "dsp/dsp.h"
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static int16_t _dsp_biquad_q14(float x)
+{
+	float v = x * 16384.0f;
+
+	v += v < 0 ? -0.5f : 0.5f;
+	if (v > 32767.0f)
+		return 32767;
+	if (v < -32768.0f)
+		return -32768;
+	return (int16_t)v;
+}
+
+static void _dsp_biquad_set(struct _dsp_biquad_coef* coef, float b0,
+		float b1, float b2, float a0, float a1, float a2)
+{
+	coef->b0 = _dsp_biquad_q14(b0 / a0);
+	coef->b1 = _dsp_biquad_q14(b1 / a0);
+	coef->b2 = _dsp_biquad_q14(b2 / a0);
+	coef->a1 = _dsp_biquad_q14(-a1 / a0);
+	coef->a2 = _dsp_biquad_q14(-a2 / a0);
+}
+
+static void _dsp_biquad_stage(const struct _dsp_biquad_coef* c,
+		struct _dsp_biquad_state* st, const int16_t* in, int16_t* out,
+		uint32_t count)
+{
+	int32_t residue = st->residue;
+	uint32_t i;
+#ifdef DSP_HAVE_SIMD32
+	uint32_t b12 = dsp_pack16(c->b1, c->b2);
+	uint32_t a12 = dsp_pack16(c->a1, c->a2);
+	uint32_t xs = dsp_pack16(st->x1, st->x2);
+	uint32_t ys = dsp_pack16(st->y1, st->y2);
+
+	for (i = 0; i < count; i++) {
+		int32_t x0 = in[i];
+		int64_t acc = (int64_t)(c->b0 * x0) + residue;
+		int32_t y, sat;
+
+		acc = dsp_smlald(b12, xs, acc);
+		acc = dsp_smlald(a12, ys, acc);
+		y = (int32_t)(acc >> 14);
+		sat = dsp_sat16(y);
+		residue = sat == y ? (int32_t)(acc & 0x3fff) : 0;
+		out[i] = (int16_t)sat;
+
+		xs = dsp_pack16(x0, xs);
+		ys = dsp_pack16(sat, ys);
+	}
+
+	st->x1 = (int16_t)xs;
+	st->x2 = (int16_t)(xs >> 16);
+	st->y1 = (int16_t)ys;
+	st->y2 = (int16_t)(ys >> 16);
+#else
+	int32_t x1 = st->x1, x2 = st->x2;
+	int32_t y1 = st->y1, y2 = st->y2;
+
+	for (i = 0; i < count; i++) {
+		int32_t x0 = in[i];
+		int64_t acc = (int64_t)(c->b0 * x0) + residue;
+		int32_t y, sat;
+
+		acc += (int64_t)(c->b1 * x1) + (int64_t)(c->b2 * x2);
+		acc += (int64_t)(c->a1 * y1) + (int64_t)(c->a2 * y2);
+		y = (int32_t)(acc >> 14);
+		sat = dsp_sat16(y);
+		residue = sat == y ? (int32_t)(acc & 0x3fff) : 0;
+		out[i] = (int16_t)sat;
+
+		x2 = x1;
+		x1 = x0;
+		y2 = y1;
+		y1 = sat;
+	}
+
+	st->x1 = (int16_t)x1;
+	st->x2 = (int16_t)x2;
+	st->y1 = (int16_t)y1;
+	st->y2 = (int16_t)y2;
+#endif
+	st->residue = residue;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void dsp_biquad_init(struct _dsp_biquad* bq,
+		const struct _dsp_biquad_coef* coef,
+		struct _dsp_biquad_state* state, uint8_t stages)
+{
+	bq->coef = coef;
+	bq->state = state;
+	bq->stages = stages;
+	memset(state, 0, stages * sizeof(*state));
+}
+
+void dsp_biquad_process(struct _dsp_biquad* bq, const int16_t* in,
+		int16_t* out, uint32_t count)
+{
+	uint8_t s;
+
+	for (s = 0; s < bq->stages; s++) {
+		_dsp_biquad_stage(&bq->coef[s], &bq->state[s], in, out, count);
+		in = out;
+	}
+}
+
+void dsp_biquad_lowpass(struct _dsp_biquad_coef* coef, float fs, float fc,
+		float q)
+{
+	float w0 = 2.0f * (float)M_PI * fc / fs;
+	float cw = cosf(w0);
+	float alpha = sinf(w0) / (2.0f * q);
+
+	_dsp_biquad_set(coef, (1.0f - cw) / 2.0f, 1.0f - cw, (1.0f - cw) / 2.0f,
+			1.0f + alpha, -2.0f * cw, 1.0f - alpha);
+}
+
+void dsp_biquad_highpass(struct _dsp_biquad_coef* coef, float fs, float fc,
+		float q)
+{
+	float w0 = 2.0f * (float)M_PI * fc / fs;
+	float cw = cosf(w0);
+	float alpha = sinf(w0) / (2.0f * q);
+
+	_dsp_biquad_set(coef, (1.0f + cw) / 2.0f, -(1.0f + cw), (1.0f + cw) / 2.0f,
+			1.0f + alpha, -2.0f * cw, 1.0f - alpha);
+	/* keep the zeros exactly at DC: with the poles close to z = 1, any
+	 * rounding left in b0 + b1 + b2 is amplified into a DC offset */
+	coef->b1 = -(coef->b0 + coef->b2);
+}
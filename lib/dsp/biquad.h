@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Cascade of second order IIR filters (biquads), Q15 samples.
+ *
+ * Each stage computes, in direct form I:
+ *
+ *    y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] + a1 y[n-1] + a2 y[n-2]
+ *
+ * with Q14 coefficients (range [-2, 2)); a1 and a2 are stored with the sign
+ * used above, i.e. opposite to the usual transfer function denominator. The
+ * accumulator is 64-bit, and the rounding residue of each output is fed
+ * back into the next one, which keeps low cutoff filters (DC removal)
+ * accurate and free of limit cycles.
+ *
+ * The Q14 coefficients place the poles with a resolution of about 2^-7
+ * radian close to z = 1: high-pass cutoffs below fs / 800 are not
+ * accurate.
+ */
+
+#ifndef DSP_BIQUAD_H_
+#define DSP_BIQUAD_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Coefficients of a stage, Q14 */
+struct _dsp_biquad_coef {
+	int16_t b0, b1, b2;
+	int16_t a1, a2;
+};
+
+/** State of a stage */
+struct _dsp_biquad_state {
+	int16_t x1, x2;
+	int16_t y1, y2;
+	int32_t residue;
+};
+
+struct _dsp_biquad {
+	const struct _dsp_biquad_coef* coef;
+	struct _dsp_biquad_state* state;
+	uint8_t stages;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a biquad cascade and clear its state.
+ * \param bq  Cascade.
+ * \param coef  Coefficients, one set per stage.
+ * \param state  State memory, one per stage.
+ * \param stages  Number of stages.
+ */
+extern void dsp_biquad_init(struct _dsp_biquad* bq,
+		const struct _dsp_biquad_coef* coef,
+		struct _dsp_biquad_state* state, uint8_t stages);
+
+/**
+ * \brief Filter a block of samples.
+ * \param bq  Cascade.
+ * \param in  Input samples.
+ * \param out  Output samples, may be the same buffer as in.
+ * \param count  Number of samples.
+ */
+extern void dsp_biquad_process(struct _dsp_biquad* bq, const int16_t* in,
+		int16_t* out, uint32_t count);
+
+/**
+ * \brief Compute the coefficients of a second order low-pass stage.
+ * \param coef  Coefficients to fill.
+ * \param fs  Sample rate (Hz).
+ * \param fc  Cutoff frequency (Hz).
+ * \param q  Quality factor (0.7071 for Butterworth).
+ */
+extern void dsp_biquad_lowpass(struct _dsp_biquad_coef* coef, float fs,
+		float fc, float q);
+
+/**
+ * \brief Compute the coefficients of a second order high-pass stage.
+ * \param coef  Coefficients to fill.
+ * \param fs  Sample rate (Hz).
+ * \param fc  Cutoff frequency (Hz).
+ * \param q  Quality factor (0.7071 for Butterworth).
+ */
+extern void dsp_biquad_highpass(struct _dsp_biquad_coef* coef, float fs,
+		float fc, float q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_BIQUAD_H_ */
@@ -0,0 +1,106 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "dsp/dsp.h"
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+uint64_t dsp_energy_q15(const int16_t* x, uint32_t count)
+{
+	uint64_t energy = 0;
+
+#ifdef DSP_HAVE_SIMD32
+	int64_t acc = 0;
+	const uint32_t* pair;
+
+	if (count && ((uintptr_t)x & 2)) {
+		acc = (int32_t)*x * *x;
+		x++;
+		count--;
+	}
+	/* square two samples per instruction, the 64-bit accumulator cannot
+	 * overflow */
+	for (pair = (const uint32_t*)x; count >= 2; count -= 2, pair++)
+		acc = dsp_smlald(*pair, *pair, acc);
+	x = (const int16_t*)pair;
+	if (count)
+		acc += (int32_t)*x * *x;
+	energy = (uint64_t)acc;
+#else
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		energy += (uint32_t)((int32_t)x[i] * x[i]);
+#endif
+
+	return energy;
+}
+
+uint32_t dsp_zero_crossings(const int16_t* x, uint32_t count, int16_t* last)
+{
+	uint32_t crossings = 0;
+	int16_t prev = *last;
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		crossings += (uint32_t)((prev ^ x[i]) < 0);
+		prev = x[i];
+	}
+	*last = prev;
+
+	return crossings;
+}
+
+uint32_t dsp_isqrt64(uint64_t x)
+{
+	uint64_t root = 0;
+	uint64_t bit = 1ull << 62;
+
+	while (bit > x)
+		bit >>= 2;
+	while (bit) {
+		if (x >= root + bit) {
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return (uint32_t)root;
+}
@@ -0,0 +1,171 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Fixed-point signal processing library, common definitions.
+ *
+ * Samples are Q15 (int16_t). The kernels have a portable C implementation
+ * and, when the compiler targets the ARMv6 SIMD / DSP extension
+ * (__ARM_FEATURE_SIMD32: Cortex-A5, Cortex-M7), a variant processing two
+ * 16-bit values per multiply-accumulate instruction. Both produce the same
+ * results bit for bit. DSP_HAVE_SIMD32 is the only switch: it also selects
+ * the SSAT and SMULWB forms of dsp_sat16() and dsp_smulwb().
+ *
+ * Defining DSP_EMULATE_SIMD32 builds the SIMD variants with C emulations
+ * of the instructions, to check them on a host.
+ */
+
+#ifndef DSP_H_
+#define DSP_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Macros
+ *----------------------------------------------------------------------------*/
+
+#if defined(__ARM_FEATURE_SIMD32) || defined(DSP_EMULATE_SIMD32)
+#define DSP_HAVE_SIMD32
+#endif
+
+/** Q15 value of a constant in [-1, 1) */
+#define DSP_Q15(x) ((int16_t)((x) * 32768.0 + ((x) < 0 ? -0.5 : 0.5)))
+
+/*----------------------------------------------------------------------------
+ *        Inline functions
+ *----------------------------------------------------------------------------*/
+
+/** \brief Saturate to 16 bits */
+static inline int32_t dsp_sat16(int32_t x)
+{
+#if defined(DSP_HAVE_SIMD32) && !defined(DSP_EMULATE_SIMD32)
+	asm("ssat %0, #16, %1" : "=r"(x) : "r"(x));
+	return x;
+#else
+	return x > 32767 ? 32767 : (x < -32768 ? -32768 : x);
+#endif
+}
+
+/** \brief (a * b) >> 16, a on 32 bits and b on 16 bits */
+static inline int32_t dsp_smulwb(int32_t a, int16_t b)
+{
+#if defined(DSP_HAVE_SIMD32) && !defined(DSP_EMULATE_SIMD32)
+	int32_t r;
+	asm("smulwb %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+	return r;
+#else
+	return (int32_t)(((int64_t)a * b) >> 16);
+#endif
+}
+
+#ifdef DSP_HAVE_SIMD32
+
+/** \brief Pack two 16-bit values in a word, lo in the bottom half */
+static inline uint32_t dsp_pack16(int32_t lo, int32_t hi)
+{
+#ifndef DSP_EMULATE_SIMD32
+	uint32_t r;
+	asm("pkhbt %0, %1, %2, lsl #16" : "=r"(r) : "r"(lo), "r"(hi));
+	return r;
+#else
+	return ((uint32_t)lo & 0xffff) | ((uint32_t)hi << 16);
+#endif
+}
+
+/** \brief acc + x.lo * y.lo + x.hi * y.hi on 32 bits */
+static inline int32_t dsp_smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+#ifndef DSP_EMULATE_SIMD32
+	asm("smlad %0, %1, %2, %0" : "+r"(acc) : "r"(x), "r"(y));
+	return acc;
+#else
+	return (int32_t)((uint32_t)acc
+		+ (uint32_t)((int16_t)x * (int16_t)y)
+		+ (uint32_t)((int16_t)(x >> 16) * (int16_t)(y >> 16)));
+#endif
+}
+
+/** \brief acc + x.lo * y.lo + x.hi * y.hi on 64 bits */
+static inline int64_t dsp_smlald(uint32_t x, uint32_t y, int64_t acc)
+{
+#ifndef DSP_EMULATE_SIMD32
+	asm("smlald %Q0, %R0, %1, %2" : "+r"(acc) : "r"(x), "r"(y));
+	return acc;
+#else
+	return acc + (int32_t)(int16_t)x * (int16_t)y
+		+ (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+#endif
+}
+
+#endif /* DSP_HAVE_SIMD32 */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Sum of the squares of a block of samples.
+ * \param x  Samples.
+ * \param count  Number of samples.
+ * \return the energy, Q30.
+ */
+extern uint64_t dsp_energy_q15(const int16_t* x, uint32_t count);
+
+/**
+ * \brief Count the sign changes in a block of samples.
+ * \param x  Samples.
+ * \param count  Number of samples.
+ * \param last  Last sample of the previous block, updated.
+ * \return the number of zero crossings.
+ */
+extern uint32_t dsp_zero_crossings(const int16_t* x, uint32_t count,
+		int16_t* last);
+
+/**
+ * \brief Integer square root.
+ * \param x  Value.
+ * \return floor(sqrt(x)).
+ */
+extern uint32_t dsp_isqrt64(uint64_t x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_H_ */
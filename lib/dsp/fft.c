@@ -0,0 +1,525 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "dsp/dsp.h"
+#include "dsp/fft.h"
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+#if DSP_FFT_MAX_LOG2 < 4 || DSP_FFT_MAX_LOG2 > 12
+#error DSP_FFT_MAX_LOG2 must be between 4 and 12
+#endif
+
+#define _DSP_FFT_QUARTER (DSP_FFT_MAX_SIZE / 4)
+
+/* sin(x) for x in [0, pi/2], Taylor series up to x^19 (error < 3e-16),
+ * evaluated by the compiler */
+#define _DSP_FFT_SIN2(x2) (1.0 - (x2) / 6.0 * (1.0 - (x2) / 20.0 * \
+	(1.0 - (x2) / 42.0 * (1.0 - (x2) / 72.0 * (1.0 - (x2) / 110.0 * \
+	(1.0 - (x2) / 156.0 * (1.0 - (x2) / 210.0 * (1.0 - (x2) / 272.0 * \
+	(1.0 - (x2) / 342.0)))))))))
+#define _DSP_FFT_SIN(x) ((x) * _DSP_FFT_SIN2((x) * (x)))
+#define _DSP_FFT_ANGLE(i) \
+	((double)(i) * (1.57079632679489661923 / _DSP_FFT_QUARTER))
+#define _DSP_FFT_ENTRY(i) \
+	(int32_t)(_DSP_FFT_SIN(_DSP_FFT_ANGLE(i)) * 2147483648.0 + 0.5),
+
+#define _DSP_FFT_R1(i) _DSP_FFT_ENTRY(i)
+#define _DSP_FFT_R2(i) _DSP_FFT_R1(i) _DSP_FFT_R1((i) + 1)
+#define _DSP_FFT_R4(i) _DSP_FFT_R2(i) _DSP_FFT_R2((i) + 2)
+#define _DSP_FFT_R8(i) _DSP_FFT_R4(i) _DSP_FFT_R4((i) + 4)
+#define _DSP_FFT_R16(i) _DSP_FFT_R8(i) _DSP_FFT_R8((i) + 8)
+#define _DSP_FFT_R32(i) _DSP_FFT_R16(i) _DSP_FFT_R16((i) + 16)
+#define _DSP_FFT_R64(i) _DSP_FFT_R32(i) _DSP_FFT_R32((i) + 32)
+#define _DSP_FFT_R128(i) _DSP_FFT_R64(i) _DSP_FFT_R64((i) + 64)
+#define _DSP_FFT_R256(i) _DSP_FFT_R128(i) _DSP_FFT_R128((i) + 128)
+#define _DSP_FFT_R512(i) _DSP_FFT_R256(i) _DSP_FFT_R256((i) + 256)
+#define _DSP_FFT_R1024(i) _DSP_FFT_R512(i) _DSP_FFT_R512((i) + 512)
+
+#if DSP_FFT_MAX_LOG2 == 4
+#define _DSP_FFT_TABLE _DSP_FFT_R4(0)
+#elif DSP_FFT_MAX_LOG2 == 5
+#define _DSP_FFT_TABLE _DSP_FFT_R8(0)
+#elif DSP_FFT_MAX_LOG2 == 6
+#define _DSP_FFT_TABLE _DSP_FFT_R16(0)
+#elif DSP_FFT_MAX_LOG2 == 7
+#define _DSP_FFT_TABLE _DSP_FFT_R32(0)
+#elif DSP_FFT_MAX_LOG2 == 8
+#define _DSP_FFT_TABLE _DSP_FFT_R64(0)
+#elif DSP_FFT_MAX_LOG2 == 9
+#define _DSP_FFT_TABLE _DSP_FFT_R128(0)
+#elif DSP_FFT_MAX_LOG2 == 10
+#define _DSP_FFT_TABLE _DSP_FFT_R256(0)
+#elif DSP_FFT_MAX_LOG2 == 11
+#define _DSP_FFT_TABLE _DSP_FFT_R512(0)
+#else
+#define _DSP_FFT_TABLE _DSP_FFT_R1024(0)
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** sin(2 pi i / DSP_FFT_MAX_SIZE) for i in [0, DSP_FFT_MAX_SIZE / 4], Q31 */
+static const int32_t _dsp_fft_sin[_DSP_FFT_QUARTER + 1] = {
+	_DSP_FFT_TABLE
+	INT32_MAX
+};
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/** cos and sin of 2 pi idx / DSP_FFT_MAX_SIZE, Q31 */
+static inline void _dsp_fft_cos_sin(uint32_t idx, int32_t* c, int32_t* s)
+{
+	uint32_t r = idx & (_DSP_FFT_QUARTER - 1);
+
+	switch ((idx >> (DSP_FFT_MAX_LOG2 - 2)) & 3) {
+	case 0:
+		*c = _dsp_fft_sin[_DSP_FFT_QUARTER - r];
+		*s = _dsp_fft_sin[r];
+		break;
+	case 1:
+		*c = -_dsp_fft_sin[r];
+		*s = _dsp_fft_sin[_DSP_FFT_QUARTER - r];
+		break;
+	case 2:
+		*c = -_dsp_fft_sin[_DSP_FFT_QUARTER - r];
+		*s = -_dsp_fft_sin[r];
+		break;
+	default:
+		*c = _dsp_fft_sin[r];
+		*s = -_dsp_fft_sin[_DSP_FFT_QUARTER - r];
+		break;
+	}
+}
+
+/** cos and sin of 2 pi idx / DSP_FFT_MAX_SIZE, Q15 (1.0 is 32768) */
+static inline void _dsp_fft_cos_sin_q15(uint32_t idx, int32_t* c, int32_t* s)
+{
+	_dsp_fft_cos_sin(idx, c, s);
+	*c = ((*c >> 15) + 1) >> 1;
+	*s = ((*s >> 15) + 1) >> 1;
+}
+
+static inline int32_t _dsp_fft_sat32(int64_t x)
+{
+	return x > INT32_MAX ? INT32_MAX : (x < INT32_MIN ? INT32_MIN : (int32_t)x);
+}
+
+static void _dsp_fft_bitrev_q15(int16_t* x, uint32_t n)
+{
+	uint32_t i, j, bit;
+
+	for (i = 0, j = 0; i < n; i++) {
+		if (i < j) {
+			int16_t re = x[2 * i], im = x[2 * i + 1];
+			x[2 * i] = x[2 * j];
+			x[2 * i + 1] = x[2 * j + 1];
+			x[2 * j] = re;
+			x[2 * j + 1] = im;
+		}
+		for (bit = n >> 1; j & bit; bit >>= 1)
+			j ^= bit;
+		j |= bit;
+	}
+}
+
+static void _dsp_fft_bitrev_q31(int32_t* x, uint32_t n)
+{
+	uint32_t i, j, bit;
+
+	for (i = 0, j = 0; i < n; i++) {
+		if (i < j) {
+			int32_t re = x[2 * i], im = x[2 * i + 1];
+			x[2 * i] = x[2 * j];
+			x[2 * i + 1] = x[2 * j + 1];
+			x[2 * j] = re;
+			x[2 * j + 1] = im;
+		}
+		for (bit = n >> 1; j & bit; bit >>= 1)
+			j ^= bit;
+		j |= bit;
+	}
+}
+
+static void _dsp_fft_radix2_q15(int16_t* x, uint32_t n)
+{
+	uint32_t j;
+
+	for (j = 0; j < 2 * n; j += 4) {
+		int32_t ar = x[j], ai = x[j + 1];
+		int32_t br = x[j + 2], bi = x[j + 3];
+
+		x[j] = (int16_t)dsp_sat16((ar + br + 1) >> 1);
+		x[j + 1] = (int16_t)dsp_sat16((ai + bi + 1) >> 1);
+		x[j + 2] = (int16_t)dsp_sat16((ar - br + 1) >> 1);
+		x[j + 3] = (int16_t)dsp_sat16((ai - bi + 1) >> 1);
+	}
+}
+
+static void _dsp_fft_radix2_q31(int32_t* x, uint32_t n)
+{
+	uint32_t j;
+
+	for (j = 0; j < 2 * n; j += 4) {
+		int64_t ar = x[j], ai = x[j + 1];
+		int64_t br = x[j + 2], bi = x[j + 3];
+
+		x[j] = _dsp_fft_sat32((ar + br + 1) >> 1);
+		x[j + 1] = _dsp_fft_sat32((ai + bi + 1) >> 1);
+		x[j + 2] = _dsp_fft_sat32((ar - br + 1) >> 1);
+		x[j + 3] = _dsp_fft_sat32((ai - bi + 1) >> 1);
+	}
+}
+
+/*
+ * Radix-4 pass combining groups of four transforms of m points. After the
+ * bit-reversal, the groups at offsets 0, m, 2m and 3m hold the transforms
+ * of the samples of index 0, 2, 1 and 3 modulo 4. The twiddled terms are
+ * kept with two extra bits (Q17 / Q33) and the outputs are rounded and
+ * divided by 4.
+ */
+static void _dsp_fft_radix4_q15(int16_t* x, uint32_t n, uint32_t m)
+{
+	uint32_t stride = DSP_FFT_MAX_SIZE / (4 * m);
+	uint32_t j, k;
+
+	for (k = 0; k < m; k++) {
+		int32_t c1, s1, c2, s2, c3, s3;
+
+		_dsp_fft_cos_sin_q15(k * stride, &c1, &s1);
+		_dsp_fft_cos_sin_q15(2 * k * stride, &c2, &s2);
+		_dsp_fft_cos_sin_q15(3 * k * stride, &c3, &s3);
+
+		for (j = k; j < n; j += 4 * m) {
+			int16_t* p0 = x + 2 * j;
+			int16_t* p1 = p0 + 2 * m;
+			int16_t* p2 = p1 + 2 * m;
+			int16_t* p3 = p2 + 2 * m;
+			int32_t t1r, t1i, t2r, t2i, t3r, t3i;
+			int32_t ar, ai, br, bi, cr, ci, dr, di;
+
+			/* (re + j im) * (c - j s) */
+			t1r = (p2[0] * c1 + p2[1] * s1) >> 13;
+			t1i = (p2[1] * c1 - p2[0] * s1) >> 13;
+			t2r = (p1[0] * c2 + p1[1] * s2) >> 13;
+			t2i = (p1[1] * c2 - p1[0] * s2) >> 13;
+			t3r = (p3[0] * c3 + p3[1] * s3) >> 13;
+			t3i = (p3[1] * c3 - p3[0] * s3) >> 13;
+
+			ar = p0[0] * 4 + t2r;
+			ai = p0[1] * 4 + t2i;
+			br = p0[0] * 4 - t2r;
+			bi = p0[1] * 4 - t2i;
+			cr = t1r + t3r;
+			ci = t1i + t3i;
+			dr = t1r - t3r;
+			di = t1i - t3i;
+
+			p0[0] = (int16_t)dsp_sat16((ar + cr + 8) >> 4);
+			p0[1] = (int16_t)dsp_sat16((ai + ci + 8) >> 4);
+			p1[0] = (int16_t)dsp_sat16((br + di + 8) >> 4);
+			p1[1] = (int16_t)dsp_sat16((bi - dr + 8) >> 4);
+			p2[0] = (int16_t)dsp_sat16((ar - cr + 8) >> 4);
+			p2[1] = (int16_t)dsp_sat16((ai - ci + 8) >> 4);
+			p3[0] = (int16_t)dsp_sat16((br - di + 8) >> 4);
+			p3[1] = (int16_t)dsp_sat16((bi + dr + 8) >> 4);
+		}
+	}
+}
+
+static void _dsp_fft_radix4_q31(int32_t* x, uint32_t n, uint32_t m)
+{
+	uint32_t stride = DSP_FFT_MAX_SIZE / (4 * m);
+	uint32_t j, k;
+
+	for (k = 0; k < m; k++) {
+		int32_t c1, s1, c2, s2, c3, s3;
+
+		_dsp_fft_cos_sin(k * stride, &c1, &s1);
+		_dsp_fft_cos_sin(2 * k * stride, &c2, &s2);
+		_dsp_fft_cos_sin(3 * k * stride, &c3, &s3);
+
+		for (j = k; j < n; j += 4 * m) {
+			int32_t* p0 = x + 2 * j;
+			int32_t* p1 = p0 + 2 * m;
+			int32_t* p2 = p1 + 2 * m;
+			int32_t* p3 = p2 + 2 * m;
+			int64_t t1r, t1i, t2r, t2i, t3r, t3i;
+			int64_t ar, ai, br, bi, cr, ci, dr, di;
+
+			t1r = ((int64_t)p2[0] * c1 + (int64_t)p2[1] * s1) >> 29;
+			t1i = ((int64_t)p2[1] * c1 - (int64_t)p2[0] * s1) >> 29;
+			t2r = ((int64_t)p1[0] * c2 + (int64_t)p1[1] * s2) >> 29;
+			t2i = ((int64_t)p1[1] * c2 - (int64_t)p1[0] * s2) >> 29;
+			t3r = ((int64_t)p3[0] * c3 + (int64_t)p3[1] * s3) >> 29;
+			t3i = ((int64_t)p3[1] * c3 - (int64_t)p3[0] * s3) >> 29;
+
+			ar = (int64_t)p0[0] * 4 + t2r;
+			ai = (int64_t)p0[1] * 4 + t2i;
+			br = (int64_t)p0[0] * 4 - t2r;
+			bi = (int64_t)p0[1] * 4 - t2i;
+			cr = t1r + t3r;
+			ci = t1i + t3i;
+			dr = t1r - t3r;
+			di = t1i - t3i;
+
+			p0[0] = _dsp_fft_sat32((ar + cr + 8) >> 4);
+			p0[1] = _dsp_fft_sat32((ai + ci + 8) >> 4);
+			p1[0] = _dsp_fft_sat32((br + di + 8) >> 4);
+			p1[1] = _dsp_fft_sat32((bi - dr + 8) >> 4);
+			p2[0] = _dsp_fft_sat32((ar - cr + 8) >> 4);
+			p2[1] = _dsp_fft_sat32((ai - ci + 8) >> 4);
+			p3[0] = _dsp_fft_sat32((br - di + 8) >> 4);
+			p3[1] = _dsp_fft_sat32((bi + dr + 8) >> 4);
+		}
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int dsp_fft_cq15(int16_t* x, uint32_t log2n)
+{
+	uint32_t n = 1u << log2n;
+	uint32_t m = 1;
+
+	if (log2n < 1 || log2n > DSP_FFT_MAX_LOG2)
+		return -EINVAL;
+
+	_dsp_fft_bitrev_q15(x, n);
+	if (log2n & 1) {
+		_dsp_fft_radix2_q15(x, n);
+		m = 2;
+	}
+	for (; m < n; m <<= 2)
+		_dsp_fft_radix4_q15(x, n, m);
+
+	return 0;
+}
+
+int dsp_fft_cq31(int32_t* x, uint32_t log2n)
+{
+	uint32_t n = 1u << log2n;
+	uint32_t m = 1;
+
+	if (log2n < 1 || log2n > DSP_FFT_MAX_LOG2)
+		return -EINVAL;
+
+	_dsp_fft_bitrev_q31(x, n);
+	if (log2n & 1) {
+		_dsp_fft_radix2_q31(x, n);
+		m = 2;
+	}
+	for (; m < n; m <<= 2)
+		_dsp_fft_radix4_q31(x, n, m);
+
+	return 0;
+}
+
+/*
+ * The N real samples are transformed as N/2 complex values z[i] = x[2i] +
+ * j x[2i+1]. With A = Z[k] and B = conj(Z[N/2-k]), E = (A + B) / 2 and
+ * O = (A - B) / 2:
+ *
+ *    X[k]       = E - j W^k O
+ *    X[N/2 - k] = conj(E + j W^k O)
+ *
+ * The sums are kept doubled and the twiddled term has two extra bits, the
+ * outputs are divided by 4 to complete the 1 / N scaling.
+ */
+int dsp_fft_rq15(int16_t* x, uint32_t log2n)
+{
+	uint32_t n = 1u << log2n;
+	uint32_t stride = DSP_FFT_MAX_SIZE >> log2n;
+	int32_t zr, zi;
+	uint32_t k;
+
+	if (log2n < 2 || log2n > DSP_FFT_MAX_LOG2)
+		return -EINVAL;
+
+	dsp_fft_cq15(x, log2n - 1);
+
+	zr = x[0];
+	zi = x[1];
+	x[0] = (int16_t)dsp_sat16((zr + zi + 1) >> 1);
+	x[1] = (int16_t)dsp_sat16((zr - zi + 1) >> 1);
+
+	for (k = 1; k < n / 4; k++) {
+		int16_t* pa = x + 2 * k;
+		int16_t* pb = x + n - 2 * k;
+		int32_t er = (pa[0] + pb[0]) * 4;
+		int32_t ei = (pa[1] - pb[1]) * 4;
+		int32_t dr = pa[0] - pb[0];
+		int32_t di = pa[1] + pb[1];
+		int32_t c, s, pr, pi;
+
+		_dsp_fft_cos_sin_q15(k * stride, &c, &s);
+		pr = (int32_t)(((int64_t)dr * c + (int64_t)di * s) >> 13);
+		pi = (int32_t)(((int64_t)di * c - (int64_t)dr * s) >> 13);
+
+		pa[0] = (int16_t)dsp_sat16((er + pi + 8) >> 4);
+		pa[1] = (int16_t)dsp_sat16((ei - pr + 8) >> 4);
+		pb[0] = (int16_t)dsp_sat16((er - pi + 8) >> 4);
+		pb[1] = (int16_t)dsp_sat16((-ei - pr + 8) >> 4);
+	}
+
+	/* X[N/4] = conj(Z[N/4]) */
+	zr = x[n / 2];
+	zi = x[n / 2 + 1];
+	x[n / 2] = (int16_t)dsp_sat16((zr + 1) >> 1);
+	x[n / 2 + 1] = (int16_t)dsp_sat16((-zi + 1) >> 1);
+
+	return 0;
+}
+
+int dsp_fft_rq31(int32_t* x, uint32_t log2n)
+{
+	uint32_t n = 1u << log2n;
+	uint32_t stride = DSP_FFT_MAX_SIZE >> log2n;
+	int64_t zr, zi;
+	uint32_t k;
+
+	if (log2n < 2 || log2n > DSP_FFT_MAX_LOG2)
+		return -EINVAL;
+
+	dsp_fft_cq31(x, log2n - 1);
+
+	zr = x[0];
+	zi = x[1];
+	x[0] = _dsp_fft_sat32((zr + zi + 1) >> 1);
+	x[1] = _dsp_fft_sat32((zr - zi + 1) >> 1);
+
+	for (k = 1; k < n / 4; k++) {
+		int32_t* pa = x + 2 * k;
+		int32_t* pb = x + n - 2 * k;
+		int64_t er = ((int64_t)pa[0] + pb[0]) * 4;
+		int64_t ei = ((int64_t)pa[1] - pb[1]) * 4;
+		int64_t dr = (int64_t)pa[0] - pb[0];
+		int64_t di = (int64_t)pa[1] + pb[1];
+		int32_t c, s;
+		int64_t pr, pi;
+
+		/* the difference is on 33 bits: use Q30 twiddles */
+		_dsp_fft_cos_sin(k * stride, &c, &s);
+		c = (c + 1) >> 1;
+		s = (s + 1) >> 1;
+		pr = (dr * c + di * s) >> 28;
+		pi = (di * c - dr * s) >> 28;
+
+		pa[0] = _dsp_fft_sat32((er + pi + 8) >> 4);
+		pa[1] = _dsp_fft_sat32((ei - pr + 8) >> 4);
+		pb[0] = _dsp_fft_sat32((er - pi + 8) >> 4);
+		pb[1] = _dsp_fft_sat32((-ei - pr + 8) >> 4);
+	}
+
+	zr = x[n / 2];
+	zi = x[n / 2 + 1];
+	x[n / 2] = _dsp_fft_sat32((zr + 1) >> 1);
+	x[n / 2 + 1] = _dsp_fft_sat32((-zi + 1) >> 1);
+
+	return 0;
+}
+
+void dsp_fft_cmag_q15(const int16_t* x, uint16_t* mag, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		int32_t re = x[2 * i], im = x[2 * i + 1];
+		mag[i] = (uint16_t)dsp_isqrt64((uint32_t)(re * re)
+				+ (uint32_t)(im * im));
+	}
+}
+
+void dsp_fft_cmag_q31(const int32_t* x, uint32_t* mag, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		int64_t re = x[2 * i], im = x[2 * i + 1];
+		mag[i] = dsp_isqrt64((uint64_t)(re * re) + (uint64_t)(im * im));
+	}
+}
+
+void dsp_fft_rmag_q15(const int16_t* x, uint16_t* mag, uint32_t log2n)
+{
+	uint32_t half = 1u << (log2n - 1);
+
+	mag[0] = (uint16_t)(x[0] < 0 ? -x[0] : x[0]);
+	mag[half] = (uint16_t)(x[1] < 0 ? -x[1] : x[1]);
+	dsp_fft_cmag_q15(x + 2, mag + 1, half - 1);
+}
+
+void dsp_fft_rmag_q31(const int32_t* x, uint32_t* mag, uint32_t log2n)
+{
+	uint32_t half = 1u << (log2n - 1);
+
+	mag[0] = x[0] < 0 ? -(uint32_t)x[0] : (uint32_t)x[0];
+	mag[half] = x[1] < 0 ? -(uint32_t)x[1] : (uint32_t)x[1];
+	dsp_fft_cmag_q31(x + 2, mag + 1, half - 1);
+}
+
+int32_t dsp_sin_q31(uint32_t phase)
+{
+	uint32_t idx = phase >> (32 - DSP_FFT_MAX_LOG2);
+	uint32_t frac = phase & ((1u << (32 - DSP_FFT_MAX_LOG2)) - 1);
+	int32_t c, s, d, d2;
+
+	_dsp_fft_cos_sin(idx, &c, &s);
+	if (!frac)
+		return s;
+
+	/* sin(a + d) = sin(a) (1 - d^2 / 2) + cos(a) d, d < 2 pi /
+	 * DSP_FFT_MAX_SIZE rad: frac * 2 pi / 2^32 is frac * pi in Q31
+	 * (pi * 2^30 = 3373259426). Near the peaks, the first two terms can
+	 * exceed the Q31 range before the third one brings the sum back. */
+	d = (int32_t)(((uint64_t)frac * 3373259426u) >> 30);
+	d2 = (int32_t)(((int64_t)d * d) >> 32);
+
+	return _dsp_fft_sat32((int64_t)s + (((int64_t)c * d) >> 31)
+			- (((int64_t)s * d2) >> 31));
+}
+
+int32_t dsp_cos_q31(uint32_t phase)
+{
+	return dsp_sin_q31(phase + 0x40000000u);
+}
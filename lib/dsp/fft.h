@@ -0,0 +1,167 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Fixed-point FFT, Q15 and Q31.
+ *
+ * Complex data is interleaved (re, im) and transformed in place. The
+ * transforms are decimation in time: a bit-reversal permutation followed
+ * by radix-4 passes, preceded by one radix-2 pass when log2(N) is odd.
+ * Each pass scales its output down (by 2 or by 4) so that nothing
+ * overflows: the result is DFT(x) / N. Intermediate values keep two extra
+ * bits and are rounded once per pass.
+ *
+ * The input magnitude must not exceed 1 (|re + j im| <= 1, always true for
+ * real signals); outputs are saturated.
+ *
+ * The real FFT transforms N real samples as an N/2 point complex FFT
+ * followed by a split pass. Its output holds bins 0 to N/2 in N values:
+ * re(X[0]), re(X[N/2]), then re, im of X[1] to X[N/2 - 1], also scaled by
+ * 1 / N.
+ *
+ * The twiddle factors come from a quarter wave sine table computed by the
+ * compiler for DSP_FFT_MAX_LOG2; smaller transforms use it with a stride.
+ */
+
+#ifndef DSP_FFT_H_
+#define DSP_FFT_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Macros
+ *----------------------------------------------------------------------------*/
+
+/** log2 of the largest transform, 4 to 12 */
+#ifndef DSP_FFT_MAX_LOG2
+#define DSP_FFT_MAX_LOG2 12
+#endif
+
+/** Largest transform size */
+#define DSP_FFT_MAX_SIZE (1u << DSP_FFT_MAX_LOG2)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Complex FFT, Q15.
+ * \param x  N complex values (2 * N int16_t), replaced by DFT(x) / N.
+ * \param log2n  log2(N), 1 to DSP_FFT_MAX_LOG2.
+ * \return 0 on success, -EINVAL if log2n is out of range.
+ */
+extern int dsp_fft_cq15(int16_t* x, uint32_t log2n);
+
+/**
+ * \brief Complex FFT, Q31.
+ * \param x  N complex values (2 * N int32_t), replaced by DFT(x) / N.
+ * \param log2n  log2(N), 1 to DSP_FFT_MAX_LOG2.
+ * \return 0 on success, -EINVAL if log2n is out of range.
+ */
+extern int dsp_fft_cq31(int32_t* x, uint32_t log2n);
+
+/**
+ * \brief Real FFT, Q15.
+ * \param x  N samples, replaced by the packed spectrum (see above).
+ * \param log2n  log2(N), 2 to DSP_FFT_MAX_LOG2.
+ * \return 0 on success, -EINVAL if log2n is out of range.
+ */
+extern int dsp_fft_rq15(int16_t* x, uint32_t log2n);
+
+/**
+ * \brief Real FFT, Q31.
+ * \param x  N samples, replaced by the packed spectrum (see above).
+ * \param log2n  log2(N), 2 to DSP_FFT_MAX_LOG2.
+ * \return 0 on success, -EINVAL if log2n is out of range.
+ */
+extern int dsp_fft_rq31(int32_t* x, uint32_t log2n);
+
+/**
+ * \brief Magnitude of complex values, Q15.
+ * \param x  Complex values (interleaved re, im).
+ * \param mag  Magnitudes, Q15 (up to sqrt(2)).
+ * \param count  Number of complex values.
+ */
+extern void dsp_fft_cmag_q15(const int16_t* x, uint16_t* mag, uint32_t count);
+
+/**
+ * \brief Magnitude of complex values, Q31.
+ * \param x  Complex values (interleaved re, im).
+ * \param mag  Magnitudes, Q31 (up to sqrt(2)).
+ * \param count  Number of complex values.
+ */
+extern void dsp_fft_cmag_q31(const int32_t* x, uint32_t* mag, uint32_t count);
+
+/**
+ * \brief Magnitude spectrum of a real FFT output, Q15.
+ * \param x  Packed spectrum returned by dsp_fft_rq15().
+ * \param mag  N / 2 + 1 magnitudes, bins 0 to N / 2.
+ * \param log2n  log2(N).
+ */
+extern void dsp_fft_rmag_q15(const int16_t* x, uint16_t* mag, uint32_t log2n);
+
+/**
+ * \brief Magnitude spectrum of a real FFT output, Q31.
+ * \param x  Packed spectrum returned by dsp_fft_rq31().
+ * \param mag  N / 2 + 1 magnitudes, bins 0 to N / 2.
+ * \param log2n  log2(N).
+ */
+extern void dsp_fft_rmag_q31(const int32_t* x, uint32_t* mag, uint32_t log2n);
+
+/**
+ * \brief Sine from the twiddle table, interpolated.
+ * The error is about (2 pi / DSP_FFT_MAX_SIZE)^3 / 6: 2e-9 with the
+ * default table, 1e-2 with the smallest one.
+ * \param phase  Angle, 2^32 is a full turn.
+ * \return sin(phase), Q31.
+ */
+extern int32_t dsp_sin_q31(uint32_t phase);
+
+/**
+ * \brief Cosine from the twiddle table, interpolated.
+ * \param phase  Angle, 2^32 is a full turn.
+ * \return cos(phase), Q31.
+ */
+extern int32_t dsp_cos_q31(uint32_t phase);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_FFT_H_ */
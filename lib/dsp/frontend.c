@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cyclecount.h"
+#include "dsp/dsp.h"
+#include "dsp/frontend.h"
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t _dsp_frontend_decimate(struct _dsp_frontend* fe, int16_t* x,
+		uint32_t count)
+{
+	uint32_t i, n = 0;
+
+	for (i = fe->phase; i < count; i += fe->decimation)
+		x[n++] = x[i];
+	fe->phase = (uint8_t)(i - count);
+
+	return n;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void dsp_frontend_init(struct _dsp_frontend* fe,
+		const struct _dsp_biquad_coef* coef,
+		struct _dsp_biquad_state* state, uint8_t stages,
+		uint8_t decimation)
+{
+	memset(&fe->stats, 0, sizeof(fe->stats));
+	dsp_biquad_init(&fe->filter, coef, state, stages);
+	fe->decimation = decimation ? decimation : 1;
+	fe->phase = 0;
+	cycle_counter_enable();
+}
+
+uint32_t dsp_frontend_process(struct _dsp_frontend* fe, int16_t* x,
+		uint32_t count, bool* active)
+{
+	uint32_t start = cycle_counter_read();
+	uint64_t energy;
+	uint32_t cycles;
+	bool voice;
+
+	dsp_biquad_process(&fe->filter, x, x, count);
+	if (fe->decimation > 1)
+		count = _dsp_frontend_decimate(fe, x, count);
+
+	energy = dsp_energy_q15(x, count);
+	voice = dsp_vad_process(&fe->vad, x, count, energy);
+	if (voice)
+		dsp_agc_update(&fe->agc, energy, count);
+	dsp_agc_apply(&fe->agc, x, count);
+
+	cycles = cycle_counter_read() - start;
+	fe->stats.blocks++;
+	if (voice)
+		fe->stats.active_blocks++;
+	fe->stats.cycles_last = cycles;
+	fe->stats.cycles_total += cycles;
+	if (cycles > fe->stats.cycles_max)
+		fe->stats.cycles_max = cycles;
+
+	if (active)
+		*active = voice;
+
+	return count;
+}
+
+void dsp_frontend_get_stats(struct _dsp_frontend* fe,
+		struct _dsp_frontend_stats* stats)
+{
+	*stats = fe->stats;
+}
@@ -0,0 +1,128 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Voice capture front end: filter, decimation, voice activity detection
+ * and automatic gain control on blocks of Q15 samples, such as the PDMIC
+ * DMA buffers.
+ *
+ * Blocks are processed in place and fast enough to be called from the DMA
+ * completion callback; the CPU cycles spent per block are accounted for
+ * (not available on ARM926 cores, which have no cycle counter).
+ *
+ * Usage:
+ *    -# dsp_frontend_init() with the biquad cascade (DC removal high-pass,
+ *       plus anti-aliasing low-pass stages when decimating);
+ *    -# dsp_vad_init() and dsp_agc_init() on the vad and agc members;
+ *    -# dsp_frontend_process() on each block; blocks flagged inactive can
+ *       be dropped by the caller. The AGC gain is frozen while inactive.
+ */
+
+#ifndef DSP_FRONTEND_H_
+#define DSP_FRONTEND_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp/agc.h"
+#include "dsp/biquad.h"
+#include "dsp/vad.h"
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct _dsp_frontend_stats {
+	uint32_t blocks;         /**< blocks processed */
+	uint32_t active_blocks;  /**< blocks with voice */
+	uint32_t cycles_last;    /**< CPU cycles of the last block */
+	uint32_t cycles_max;     /**< CPU cycles of the slowest block */
+	uint64_t cycles_total;   /**< CPU cycles of all the blocks */
+};
+
+struct _dsp_frontend {
+	struct _dsp_biquad filter;
+	uint8_t decimation;      /**< output one sample out of decimation */
+	uint8_t phase;           /**< input samples to skip before the next */
+	struct _dsp_vad vad;
+	struct _dsp_agc agc;
+	struct _dsp_frontend_stats stats;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a front end. The VAD and AGC are initialized separately.
+ * \param fe  Front end.
+ * \param coef  Biquad cascade coefficients.
+ * \param state  Biquad cascade state memory.
+ * \param stages  Number of biquad stages (0 for no filtering).
+ * \param decimation  Decimation factor (1 for none).
+ */
+extern void dsp_frontend_init(struct _dsp_frontend* fe,
+		const struct _dsp_biquad_coef* coef,
+		struct _dsp_biquad_state* state, uint8_t stages,
+		uint8_t decimation);
+
+/**
+ * \brief Process a block of samples in place.
+ * \param fe  Front end.
+ * \param x  Samples; the decimated output is stored at the start.
+ * \param count  Number of input samples.
+ * \param active  Set to the voice activity of the block, may be NULL.
+ * \return the number of output samples.
+ */
+extern uint32_t dsp_frontend_process(struct _dsp_frontend* fe, int16_t* x,
+		uint32_t count, bool* active);
+
+/**
+ * \brief Get the statistics of a front end.
+ * \param fe  Front end.
+ * \param stats  Filled with the statistics.
+ */
+extern void dsp_frontend_get_stats(struct _dsp_frontend* fe,
+		struct _dsp_frontend_stats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_FRONTEND_H_ */
@@ -0,0 +1,117 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "dsp/dsp.h"
+#include "dsp/fft.h"
+#include "dsp/goertzel.h"
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/** (s * coef) >> 29 for |s| < 2^47, with two 32x32 multiplies */
+static inline int64_t _dsp_goertzel_mul(int64_t s, int32_t coef)
+{
+	int32_t hi = (int32_t)(s >> 16);
+	uint32_t lo = (uint32_t)s & 0xffff;
+
+	return ((int64_t)hi * coef + (((int64_t)lo * coef) >> 16)) >> 13;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void dsp_goertzel_init(struct _dsp_goertzel* g, uint32_t freq, uint32_t rate)
+{
+	uint32_t phase = (uint32_t)(((uint64_t)freq << 32) / rate);
+
+	g->cos = dsp_cos_q31(phase);
+	g->sin = dsp_sin_q31(phase);
+	g->coef = (g->cos + 1) >> 1;
+	dsp_goertzel_reset(g);
+}
+
+void dsp_goertzel_reset(struct _dsp_goertzel* g)
+{
+	g->s1 = 0;
+	g->s2 = 0;
+	g->count = 0;
+}
+
+void dsp_goertzel_process(struct _dsp_goertzel* g, const int16_t* x,
+		uint32_t stride, uint32_t count)
+{
+	int64_t s1 = g->s1, s2 = g->s2;
+	uint32_t i;
+
+	for (i = 0; i < count; i++, x += stride) {
+		int64_t s0 = *x + _dsp_goertzel_mul(s1, g->coef) - s2;
+		s2 = s1;
+		s1 = s0;
+	}
+
+	g->s1 = s1;
+	g->s2 = s2;
+	g->count += count;
+}
+
+uint32_t dsp_goertzel_amplitude(const struct _dsp_goertzel* g)
+{
+	int64_t m1 = g->s1 < 0 ? -g->s1 : g->s1;
+	int64_t m2 = g->s2 < 0 ? -g->s2 : g->s2;
+	int64_t max = m1 > m2 ? m1 : m2;
+	uint32_t shift = 0;
+	int32_t a, b;
+	int64_t re, im;
+	uint64_t amplitude;
+
+	if (!g->count)
+		return 0;
+
+	/* y = s1 - exp(-j w) s2, computed on 31 bits */
+	while ((max >> shift) >= (1ll << 30))
+		shift++;
+	a = (int32_t)(g->s1 >> shift);
+	b = (int32_t)(g->s2 >> shift);
+	re = a - (((int64_t)g->cos * b) >> 31);
+	im = ((int64_t)g->sin * b) >> 31;
+
+	amplitude = (uint64_t)dsp_isqrt64((uint64_t)(re * re)
+			+ (uint64_t)(im * im)) << shift;
+	amplitude = 2 * amplitude / g->count;
+
+	return amplitude > UINT32_MAX ? UINT32_MAX : (uint32_t)amplitude;
+}
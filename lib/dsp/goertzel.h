@@ -0,0 +1,112 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Goertzel single frequency detector, Q15 samples.
+ *
+ * The frequency does not have to fall on an FFT bin. The samples can be
+ * fed in several calls of any size, directly from an interleaved DMA
+ * buffer; dsp_goertzel_amplitude() then gives the amplitude of the tone
+ * over all the samples received since the last reset.
+ *
+ * The state is kept on 64 bits: the block length is only limited by
+ * count / sin(2 pi freq / rate) < 2^32.
+ */
+
+#ifndef DSP_GOERTZEL_H_
+#define DSP_GOERTZEL_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct _dsp_goertzel {
+	int32_t cos;        /**< cos(2 pi freq / rate), Q31 */
+	int32_t sin;        /**< sin(2 pi freq / rate), Q31 */
+	int32_t coef;       /**< 2 cos(2 pi freq / rate), Q29 */
+
+	int64_t s1, s2;     /**< resonator state, Q15 */
+	uint32_t count;     /**< samples since the last reset */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a detector and reset it.
+ * \param g  Detector.
+ * \param freq  Frequency to detect (Hz), below rate / 2.
+ * \param rate  Sample rate (Hz).
+ */
+extern void dsp_goertzel_init(struct _dsp_goertzel* g, uint32_t freq,
+		uint32_t rate);
+
+/**
+ * \brief Start a new measurement.
+ * \param g  Detector.
+ */
+extern void dsp_goertzel_reset(struct _dsp_goertzel* g);
+
+/**
+ * \brief Feed samples to a detector.
+ * \param g  Detector.
+ * \param x  First sample.
+ * \param stride  Distance between two samples (number of channels of the
+ *                frames).
+ * \param count  Number of samples.
+ */
+extern void dsp_goertzel_process(struct _dsp_goertzel* g, const int16_t* x,
+		uint32_t stride, uint32_t count);
+
+/**
+ * \brief Amplitude of the tone since the last reset.
+ * \param g  Detector.
+ * \return the peak amplitude, Q15 (a full scale sine gives 32768), 0 if
+ * no sample was received.
+ */
+extern uint32_t dsp_goertzel_amplitude(const struct _dsp_goertzel* g);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_GOERTZEL_H_ */
@@ -0,0 +1,92 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp/dsp.h"
+#include "dsp/vad.h"
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void dsp_vad_init(struct _dsp_vad* vad, uint32_t min_energy, uint16_t ratio,
+		uint16_t max_zcr, uint16_t noise_rise, uint16_t hangover)
+{
+	vad->min_energy = min_energy;
+	vad->ratio = ratio;
+	vad->max_zcr = max_zcr;
+	vad->noise_rise = noise_rise;
+	vad->hangover = hangover;
+	vad->noise = min_energy ? min_energy : 1;
+	vad->hold = 0;
+	vad->last = 0;
+	vad->speech = false;
+	vad->active = false;
+}
+
+bool dsp_vad_process(struct _dsp_vad* vad, const int16_t* x, uint32_t count,
+		uint64_t energy)
+{
+	uint32_t mean, zcr, rise;
+
+	if (!count)
+		return vad->active;
+
+	mean = (uint32_t)(energy / count);
+	zcr = (dsp_zero_crossings(x, count, &vad->last) << 8) / count;
+
+	vad->speech = mean > vad->min_energy &&
+		(uint64_t)mean << 8 > (uint64_t)vad->noise * vad->ratio &&
+		zcr <= vad->max_zcr;
+
+	if (mean < vad->noise) {
+		vad->noise = mean ? mean : 1;
+	} else {
+		rise = (uint32_t)(((uint64_t)(mean - vad->noise) *
+				   vad->noise_rise) >> 15);
+		vad->noise += rise ? rise : 1;
+	}
+
+	if (vad->speech) {
+		vad->hold = vad->hangover;
+		vad->active = true;
+	} else if (vad->hold) {
+		vad->hold--;
+	} else {
+		vad->active = false;
+	}
+
+	return vad->active;
+}
@@ -0,0 +1,109 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Energy and zero-crossing voice activity detector, Q15 samples.
+ *
+ * A block is speech when its mean square exceeds both an absolute floor
+ * and the noise floor times a ratio, and its zero-crossing rate is below a
+ * limit (broadband hiss crosses zero much more often than voice). The noise
+ * floor drops immediately to quieter blocks and rises slowly, so it follows
+ * the background level between words. Detection is held for a hangover
+ * number of blocks after the last speech block, not to cut word endings.
+ */
+
+#ifndef DSP_VAD_H_
+#define DSP_VAD_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct _dsp_vad {
+	uint32_t min_energy;  /**< mean square floor of speech, Q30 */
+	uint16_t ratio;       /**< speech to noise mean square ratio, Q8 */
+	uint16_t max_zcr;     /**< zero crossings per 256 samples of speech */
+	uint16_t noise_rise;  /**< noise floor rise coefficient per block, Q15 */
+	uint16_t hangover;    /**< blocks held active after speech */
+
+	uint32_t noise;       /**< noise floor, mean square Q30 */
+	uint16_t hold;        /**< hangover blocks left */
+	int16_t last;         /**< last sample of the previous block */
+	bool speech;          /**< last block was speech */
+	bool active;          /**< detector output */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize a voice activity detector.
+ * \param vad  Detector.
+ * \param min_energy  Mean square floor of speech, Q30.
+ * \param ratio  Speech to noise mean square ratio, Q8 (e.g. 4 << 8 for
+ * 6 dB).
+ * \param max_zcr  Zero crossings per 256 samples above which a block is
+ * not speech.
+ * \param noise_rise  Noise floor rise coefficient per block, Q15.
+ * \param hangover  Blocks held active after the last speech block.
+ */
+extern void dsp_vad_init(struct _dsp_vad* vad, uint32_t min_energy,
+		uint16_t ratio, uint16_t max_zcr, uint16_t noise_rise,
+		uint16_t hangover);
+
+/**
+ * \brief Process a block.
+ * \param vad  Detector.
+ * \param x  Samples.
+ * \param count  Number of samples.
+ * \param energy  Energy of the block, see dsp_energy_q15().
+ * \return true while voice is active.
+ */
+extern bool dsp_vad_process(struct _dsp_vad* vad, const int16_t* x,
+		uint32_t count, uint64_t energy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_VAD_H_ */
@@ -0,0 +1,182 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dsp/dsp.h"
+#include "dsp/fft.h"
+#include "dsp/window.h"
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define _DSP_WINDOW_Q31(x) ((int32_t)((x) * 2147483648.0 + 0.5))
+
+/** Number of cosine terms of the windows */
+#define _DSP_WINDOW_TERMS 5
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/** w[n] = a0 - a1 cos(2 pi n / N) + a2 cos(4 pi n / N) - ..., Q31 */
+static const int32_t _dsp_window_coefs[][_DSP_WINDOW_TERMS] = {
+	[DSP_WINDOW_HANN] = {
+		_DSP_WINDOW_Q31(0.5), _DSP_WINDOW_Q31(0.5),
+	},
+	[DSP_WINDOW_HAMMING] = {
+		_DSP_WINDOW_Q31(0.54), _DSP_WINDOW_Q31(0.46),
+	},
+	[DSP_WINDOW_BLACKMAN] = {
+		_DSP_WINDOW_Q31(7938.0 / 18608.0),
+		_DSP_WINDOW_Q31(9240.0 / 18608.0),
+		_DSP_WINDOW_Q31(1430.0 / 18608.0),
+	},
+	[DSP_WINDOW_FLAT_TOP] = {
+		_DSP_WINDOW_Q31(0.21557895), _DSP_WINDOW_Q31(0.41663158),
+		_DSP_WINDOW_Q31(0.277263158), _DSP_WINDOW_Q31(0.083578947),
+		_DSP_WINDOW_Q31(0.006947368),
+	},
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int dsp_window_init(int16_t* w, uint32_t log2n, enum _dsp_window_type type)
+{
+	uint32_t n = 1u << log2n;
+	uint32_t i, k;
+
+	if (log2n < 1 || log2n > DSP_FFT_MAX_LOG2)
+		return -EINVAL;
+	if (type > DSP_WINDOW_FLAT_TOP)
+		return -EINVAL;
+
+	for (i = 0; i < n; i++) {
+		int64_t acc = 0;
+		int32_t v;
+
+		if (type == DSP_WINDOW_RECTANGLE) {
+			w[i] = INT16_MAX;
+			continue;
+		}
+
+		for (k = 0; k < _DSP_WINDOW_TERMS; k++) {
+			int64_t term = (int64_t)_dsp_window_coefs[type][k]
+				* dsp_cos_q31((k * i) << (32 - log2n));
+			acc += (k & 1) ? -term : term;
+		}
+		v = (int32_t)((acc + (1ll << 46)) >> 47);
+		w[i] = (int16_t)dsp_sat16(v);
+	}
+
+	return 0;
+}
+
+uint32_t dsp_window_gain(const int16_t* w, uint32_t count)
+{
+	int64_t sum = 0;
+	uint32_t i;
+
+	if (!count)
+		return 0;
+	for (i = 0; i < count; i++)
+		sum += w[i];
+
+	return (uint32_t)(sum / count);
+}
+
+void dsp_window_apply_q15(int16_t* x, const int16_t* w, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		x[i] = (int16_t)dsp_sat16((x[i] * w[i] + 0x4000) >> 15);
+}
+
+void dsp_window_apply_q31(int32_t* x, const int16_t* w, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		x[i] = (int32_t)(((int64_t)x[i] * w[i] + 0x4000) >> 15);
+}
+
+void dsp_window_load_q15(int16_t* dst, const int16_t* src,
+		uint32_t stride, const int16_t* w, uint32_t count)
+{
+	uint32_t i;
+
+	if (!w) {
+		for (i = 0; i < count; i++, src += stride)
+			dst[i] = *src;
+		return;
+	}
+	for (i = 0; i < count; i++, src += stride)
+		dst[i] = (int16_t)dsp_sat16((*src * w[i] + 0x4000) >> 15);
+}
+
+void dsp_window_load_q31(int32_t* dst, const int32_t* src,
+		uint32_t stride, const int16_t* w, uint32_t count)
+{
+	uint32_t i;
+
+	if (!w) {
+		for (i = 0; i < count; i++, src += stride)
+			dst[i] = *src;
+		return;
+	}
+	for (i = 0; i < count; i++, src += stride)
+		dst[i] = (int32_t)(((int64_t)*src * w[i] + 0x4000) >> 15);
+}
+
+void dsp_window_load_adc(int16_t* dst, const uint16_t* src,
+		uint32_t stride, uint8_t bits, const int16_t* w, uint32_t count)
+{
+	uint32_t mask = (1u << bits) - 1;
+	int32_t offset = 1 << (bits - 1);
+	int32_t scale = 1 << (16 - bits);
+	uint32_t i;
+
+	for (i = 0; i < count; i++, src += stride) {
+		int32_t v = ((int32_t)(*src & mask) - offset) * scale;
+
+		if (w)
+			v = (v * w[i] + 0x4000) >> 15;
+		dst[i] = (int16_t)v;
+	}
+}
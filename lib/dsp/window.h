@@ -0,0 +1,154 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * FFT windows and sample loading, Q15.
+ *
+ * The windows are periodic (DFT-even) and generated from the FFT twiddle
+ * table, for the transform sizes supported by the FFT.
+ *
+ * The load functions read one channel of a DMA buffer, convert it to the
+ * FFT input format and apply a window in one pass: interleaved 16-bit or
+ * 32-bit audio frames as filled by audio_transfer(), or the 16-bit words
+ * written by the ADC driver (unsigned conversion result in the low bits,
+ * channel tag above).
+ */
+
+#ifndef DSP_WINDOW_H_
+#define DSP_WINDOW_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+enum _dsp_window_type {
+	DSP_WINDOW_RECTANGLE,
+	DSP_WINDOW_HANN,
+	DSP_WINDOW_HAMMING,
+	DSP_WINDOW_BLACKMAN,      /**< exact Blackman */
+	DSP_WINDOW_FLAT_TOP,      /**< amplitude accurate within 0.02 dB */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Compute a window.
+ * \param w  N coefficients, Q15.
+ * \param log2n  log2(N), 1 to DSP_FFT_MAX_LOG2.
+ * \param type  Window.
+ * \return 0 on success, -EINVAL if log2n or type is invalid.
+ */
+extern int dsp_window_init(int16_t* w, uint32_t log2n,
+		enum _dsp_window_type type);
+
+/**
+ * \brief Coherent gain of a window, to correct tone amplitudes.
+ * \param w  Coefficients.
+ * \param count  Number of coefficients.
+ * \return the mean of the coefficients, Q15.
+ */
+extern uint32_t dsp_window_gain(const int16_t* w, uint32_t count);
+
+/**
+ * \brief Apply a window in place, Q15 samples.
+ * \param x  Samples.
+ * \param w  Window.
+ * \param count  Number of samples.
+ */
+extern void dsp_window_apply_q15(int16_t* x, const int16_t* w,
+		uint32_t count);
+
+/**
+ * \brief Apply a window in place, Q31 samples.
+ * \param x  Samples.
+ * \param w  Window.
+ * \param count  Number of samples.
+ */
+extern void dsp_window_apply_q31(int32_t* x, const int16_t* w,
+		uint32_t count);
+
+/**
+ * \brief Load one channel of interleaved 16-bit samples.
+ * \param dst  Q15 samples.
+ * \param src  First sample of the channel.
+ * \param stride  Distance between two samples of the channel (number of
+ *                channels of the frames).
+ * \param w  Window, or NULL.
+ * \param count  Number of samples.
+ */
+extern void dsp_window_load_q15(int16_t* dst, const int16_t* src,
+		uint32_t stride, const int16_t* w, uint32_t count);
+
+/**
+ * \brief Load one channel of interleaved 32-bit samples (MSB aligned).
+ * \param dst  Q31 samples.
+ * \param src  First sample of the channel.
+ * \param stride  Distance between two samples of the channel.
+ * \param w  Window, or NULL.
+ * \param count  Number of samples.
+ */
+extern void dsp_window_load_q31(int32_t* dst, const int32_t* src,
+		uint32_t stride, const int16_t* w, uint32_t count);
+
+/**
+ * \brief Load one channel of unsigned ADC conversion results.
+ *
+ * The mid-scale code is mapped to 0 and full scale to [-1, 1).
+ *
+ * \param dst  Q15 samples.
+ * \param src  First conversion result of the channel.
+ * \param stride  Distance between two results of the channel (length of
+ *                the channel sequence).
+ * \param bits  Resolution of the results (1 to 16), upper bits are
+ *              ignored.
+ * \param w  Window, or NULL.
+ * \param count  Number of samples.
+ */
+extern void dsp_window_load_adc(int16_t* dst, const uint16_t* src,
+		uint32_t stride, uint8_t bits, const int16_t* w, uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_WINDOW_H_ */
@@ -0,0 +1,455 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "apps/ptp.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+#define NSEC_PER_SEC 1000000000ll
+
+/* controlField values */
+#define PTP_CONTROL_SYNC       0
+#define PTP_CONTROL_DELAY_REQ  1
+#define PTP_CONTROL_FOLLOW_UP  2
+#define PTP_CONTROL_DELAY_RESP 3
+#define PTP_CONTROL_OTHER      5
+
+/* logMessageInterval of Delay_Req messages */
+#define PTP_LOG_INTERVAL_NONE  0x7f
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint16_t _get_u16(const uint8_t* p)
+{
+	return (p[0] << 8) | p[1];
+}
+
+static uint32_t _get_u32(const uint8_t* p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+		((uint32_t)p[2] << 8) | p[3];
+}
+
+static void _put_u16(uint8_t* p, uint16_t v)
+{
+	p[0] = v >> 8;
+	p[1] = v;
+}
+
+static void _put_u32(uint8_t* p, uint32_t v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+static int _get_timestamp(const uint8_t* p, struct _ptp_time* t)
+{
+	uint32_t nsec = _get_u32(p + 6);
+
+	t->sec = ((int64_t)_get_u16(p) << 32) | _get_u32(p + 2);
+	t->nsec = (int32_t)nsec;
+	return nsec < NSEC_PER_SEC ? 0 : -EINVAL;
+}
+
+static void _put_timestamp(uint8_t* p, const struct _ptp_time* t)
+{
+	_put_u16(p, (uint16_t)(t->sec >> 32));
+	_put_u32(p + 2, (uint32_t)t->sec);
+	_put_u32(p + 6, t->nsec);
+}
+
+static void _get_port_identity(const uint8_t* p, struct _ptp_port_identity* id)
+{
+	memcpy(id->clock_identity, p, sizeof(id->clock_identity));
+	id->port_number = _get_u16(p + 8);
+}
+
+static void _put_port_identity(uint8_t* p, const struct _ptp_port_identity* id)
+{
+	memcpy(p, id->clock_identity, sizeof(id->clock_identity));
+	_put_u16(p + 8, id->port_number);
+}
+
+static bool _ptp_port_equal(const struct _ptp_port_identity* a,
+		const struct _ptp_port_identity* b)
+{
+	return a->port_number == b->port_number &&
+		!memcmp(a->clock_identity, b->clock_identity, sizeof(a->clock_identity));
+}
+
+static double _ptp_interval(int8_t log_interval)
+{
+	double interval = 1.0;
+
+	/* out of range values (e.g. 0x7f, unspecified) default to 1s */
+	if (log_interval < -7 || log_interval > 7)
+		return interval;
+	for (; log_interval > 0; log_interval--)
+		interval *= 2.0;
+	for (; log_interval < 0; log_interval++)
+		interval /= 2.0;
+	return interval;
+}
+
+static void _ptp_slave_update_delay(struct _ptp_slave* slave)
+{
+	int64_t delay;
+
+	/* mean path delay = ((t2 - t1) + (t4 - t3)) / 2 */
+	delay = (ptp_time_diff(&slave->t2, &slave->t1) +
+		 ptp_time_diff(&slave->t4, &slave->t3)) / 2;
+
+	/* low-pass filter the delay to reduce the jitter on the offset */
+	if (slave->delay_valid)
+		slave->path_delay += (delay - slave->path_delay) / 8;
+	else
+		slave->path_delay = delay;
+	slave->delay_valid = true;
+	slave->t3_valid = false;
+	slave->t4_valid = false;
+	slave->stats.path_delay = slave->path_delay;
+}
+
+/**
+ * Process a (t1, t2) pair, return true if a Delay_Req must be sent.
+ */
+static bool _ptp_slave_sample(struct _ptp_slave* slave)
+{
+	int64_t offset;
+	int32_t ppb;
+
+	/* offset from master = t2 - t1 - mean path delay */
+	offset = ptp_time_diff(&slave->t2, &slave->t1);
+	if (slave->delay_valid)
+		offset -= slave->path_delay;
+	slave->stats.offset = offset;
+
+	switch (ptp_servo_sample(&slave->servo, offset,
+			_ptp_interval(slave->log_sync_interval), &ppb)) {
+	case PTP_SERVO_STEP:
+		slave->clock->adjust_time(slave->clock_arg, -offset);
+		slave->stats.steps++;
+		/* timestamps taken before the step cannot be mixed with the
+		 * ones taken after it */
+		slave->delay_req_pending = false;
+		slave->t3_valid = false;
+		slave->t4_valid = false;
+		return false;
+	case PTP_SERVO_TRACKING:
+	case PTP_SERVO_LOCKED:
+		slave->clock->adjust_freq(slave->clock_arg, ppb);
+		slave->stats.freq = ppb;
+		return true;
+	default:
+		return false;
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int64_t ptp_time_diff(const struct _ptp_time* a, const struct _ptp_time* b)
+{
+	return (a->sec - b->sec) * NSEC_PER_SEC + (a->nsec - b->nsec);
+}
+
+void ptp_time_add(struct _ptp_time* t, int64_t ns)
+{
+	t->sec += ns / NSEC_PER_SEC;
+	t->nsec += (int32_t)(ns % NSEC_PER_SEC);
+	if (t->nsec < 0) {
+		t->nsec += NSEC_PER_SEC;
+		t->sec--;
+	} else if (t->nsec >= NSEC_PER_SEC) {
+		t->nsec -= NSEC_PER_SEC;
+		t->sec++;
+	}
+}
+
+int ptp_msg_unpack(const uint8_t* buf, uint16_t len, struct _ptp_msg* msg)
+{
+	uint16_t min_length;
+
+	if (len < PTP_HEADER_LENGTH)
+		return -EINVAL;
+
+	memset(msg, 0, sizeof(*msg));
+	msg->type = buf[0] & 0xf;
+	msg->version = buf[1] & 0xf;
+	msg->length = _get_u16(buf + 2);
+	if (msg->version != 2 || msg->length > len)
+		return -EINVAL;
+	msg->domain = buf[4];
+	msg->flags = _get_u16(buf + 6);
+	msg->correction = (int64_t)(((uint64_t)_get_u32(buf + 8) << 32) |
+			_get_u32(buf + 12));
+	_get_port_identity(buf + 20, &msg->source);
+	msg->sequence_id = _get_u16(buf + 30);
+	msg->control = buf[32];
+	msg->log_interval = (int8_t)buf[33];
+
+	switch (msg->type) {
+	case PTP_MSG_SYNC:
+	case PTP_MSG_DELAY_REQ:
+	case PTP_MSG_FOLLOW_UP:
+		min_length = PTP_SYNC_LENGTH;
+		break;
+	case PTP_MSG_DELAY_RESP:
+		min_length = PTP_DELAY_RESP_LENGTH;
+		break;
+	case PTP_MSG_ANNOUNCE:
+		min_length = PTP_ANNOUNCE_LENGTH;
+		break;
+	default:
+		/* header only */
+		return msg->length < PTP_HEADER_LENGTH ? -EINVAL : 0;
+	}
+
+	if (msg->length < min_length)
+		return -EINVAL;
+	if (_get_timestamp(buf + 34, &msg->timestamp) < 0)
+		return -EINVAL;
+	if (msg->type == PTP_MSG_DELAY_RESP)
+		_get_port_identity(buf + 44, &msg->requesting);
+	return 0;
+}
+
+uint16_t ptp_msg_pack(const struct _ptp_msg* msg, uint8_t* buf, uint16_t size)
+{
+	if (msg->length < PTP_HEADER_LENGTH || msg->length > size)
+		return 0;
+
+	memset(buf, 0, msg->length);
+	buf[0] = msg->type & 0xf;
+	buf[1] = 2;
+	_put_u16(buf + 2, msg->length);
+	buf[4] = msg->domain;
+	_put_u16(buf + 6, msg->flags);
+	_put_u32(buf + 8, (uint32_t)((uint64_t)msg->correction >> 32));
+	_put_u32(buf + 12, (uint32_t)msg->correction);
+	_put_port_identity(buf + 20, &msg->source);
+	_put_u16(buf + 30, msg->sequence_id);
+	buf[32] = msg->control;
+	buf[33] = (uint8_t)msg->log_interval;
+
+	if (msg->length >= PTP_SYNC_LENGTH)
+		_put_timestamp(buf + 34, &msg->timestamp);
+	if (msg->type == PTP_MSG_DELAY_RESP && msg->length >= PTP_DELAY_RESP_LENGTH)
+		_put_port_identity(buf + 44, &msg->requesting);
+	return msg->length;
+}
+
+void ptp_servo_init(struct _ptp_servo* servo, double kp, double ki,
+		int32_t max_ppb, int64_t step_threshold)
+{
+	servo->kp = kp;
+	servo->ki = ki;
+	servo->drift = 0.0;
+	servo->max_ppb = max_ppb;
+	servo->step_threshold = step_threshold;
+	servo->state = PTP_SERVO_UNLOCKED;
+}
+
+enum _ptp_servo_state ptp_servo_sample(struct _ptp_servo* servo,
+		int64_t offset, double interval, int32_t* ppb)
+{
+	double ki_term, out;
+	int64_t abs_offset = llabs(offset);
+
+	/* Step the clock on the first sample unless it is already close,
+	 * then only if the offset goes over the step threshold */
+	if ((servo->state == PTP_SERVO_UNLOCKED &&
+	     abs_offset > PTP_SERVO_LOCK_THRESHOLD) ||
+	    (servo->state != PTP_SERVO_UNLOCKED && servo->step_threshold &&
+	     abs_offset > servo->step_threshold)) {
+		servo->state = PTP_SERVO_STEP;
+		return servo->state;
+	}
+
+	/* PI controller, the integral term is the frequency drift estimate.
+	 * A positive offset means the local clock is ahead, slow it down. */
+	ki_term = servo->ki * offset * interval;
+	out = servo->kp * offset + servo->drift + ki_term;
+	if (out > servo->max_ppb) {
+		out = servo->max_ppb;
+	} else if (out < -servo->max_ppb) {
+		out = -servo->max_ppb;
+	} else {
+		/* anti-windup: integrate only when not saturated */
+		servo->drift += ki_term;
+	}
+	*ppb = -(int32_t)out;
+
+	if (abs_offset <= PTP_SERVO_LOCK_THRESHOLD)
+		servo->state = PTP_SERVO_LOCKED;
+	else
+		servo->state = PTP_SERVO_TRACKING;
+	return servo->state;
+}
+
+void ptp_slave_init(struct _ptp_slave* slave,
+		const struct _ptp_clock_ops* clock, void* clock_arg,
+		const uint8_t clock_identity[8], uint8_t domain)
+{
+	memset(slave, 0, sizeof(*slave));
+	slave->clock = clock;
+	slave->clock_arg = clock_arg;
+	slave->domain = domain;
+	memcpy(slave->port.clock_identity, clock_identity,
+			sizeof(slave->port.clock_identity));
+	slave->port.port_number = 1;
+	ptp_servo_init(&slave->servo, PTP_SERVO_KP, PTP_SERVO_KI,
+			PTP_SERVO_MAX_PPB, PTP_SERVO_STEP_THRESHOLD);
+}
+
+bool ptp_slave_rx(struct _ptp_slave* slave, const uint8_t* buf,
+		uint16_t len, const struct _ptp_time* rx_ts)
+{
+	struct _ptp_msg msg;
+	bool from_master;
+
+	if (ptp_msg_unpack(buf, len, &msg) < 0 || msg.domain != slave->domain) {
+		slave->stats.dropped++;
+		return false;
+	}
+	from_master = slave->has_master &&
+		_ptp_port_equal(&msg.source, &slave->master);
+
+	switch (msg.type) {
+	case PTP_MSG_ANNOUNCE:
+		/* No best master clock algorithm: follow the first master
+		 * announced on the domain */
+		slave->stats.announce++;
+		if (!slave->has_master) {
+			slave->master = msg.source;
+			slave->has_master = true;
+		}
+		return false;
+
+	case PTP_MSG_SYNC:
+		if (!from_master || !rx_ts)
+			break;
+		slave->stats.sync++;
+		slave->t2 = *rx_ts;
+		slave->sync_seq = msg.sequence_id;
+		slave->log_sync_interval = msg.log_interval;
+		if (msg.flags & PTP_FLAG_TWO_STEP) {
+			slave->sync_pending = true;
+			slave->sync_correction = msg.correction;
+			return false;
+		}
+		slave->sync_pending = false;
+		slave->t1 = msg.timestamp;
+		ptp_time_add(&slave->t1, msg.correction >> 16);
+		return _ptp_slave_sample(slave);
+
+	case PTP_MSG_FOLLOW_UP:
+		if (!from_master || !slave->sync_pending ||
+		    msg.sequence_id != slave->sync_seq)
+			break;
+		slave->stats.follow_up++;
+		slave->sync_pending = false;
+		slave->t1 = msg.timestamp;
+		ptp_time_add(&slave->t1,
+				(slave->sync_correction + msg.correction) >> 16);
+		return _ptp_slave_sample(slave);
+
+	case PTP_MSG_DELAY_RESP:
+		if (!from_master || !slave->delay_req_pending ||
+		    msg.sequence_id != slave->delay_req_seq ||
+		    !_ptp_port_equal(&msg.requesting, &slave->port))
+			break;
+		slave->stats.delay_resp++;
+		slave->delay_req_pending = false;
+		slave->t4 = msg.timestamp;
+		ptp_time_add(&slave->t4, -(msg.correction >> 16));
+		slave->t4_valid = true;
+		if (slave->t3_valid)
+			_ptp_slave_update_delay(slave);
+		return false;
+
+	default:
+		break;
+	}
+
+	slave->stats.dropped++;
+	return false;
+}
+
+uint16_t ptp_slave_pack_delay_req(struct _ptp_slave* slave,
+		uint8_t* buf, uint16_t size)
+{
+	struct _ptp_msg msg;
+	uint16_t length;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = PTP_MSG_DELAY_REQ;
+	msg.version = 2;
+	msg.length = PTP_DELAY_REQ_LENGTH;
+	msg.domain = slave->domain;
+	msg.source = slave->port;
+	msg.sequence_id = slave->delay_req_seq + 1;
+	msg.control = PTP_CONTROL_DELAY_REQ;
+	msg.log_interval = PTP_LOG_INTERVAL_NONE;
+	slave->clock->get_time(slave->clock_arg, &msg.timestamp);
+
+	length = ptp_msg_pack(&msg, buf, size);
+	if (length) {
+		slave->delay_req_seq = msg.sequence_id;
+		slave->delay_req_pending = true;
+		slave->t3_valid = false;
+		slave->t4_valid = false;
+		slave->stats.delay_req++;
+	}
+	return length;
+}
+
+void ptp_slave_tx_timestamp(struct _ptp_slave* slave,
+		const struct _ptp_time* tx_ts)
+{
+	slave->t3 = *tx_ts;
+	slave->t3_valid = true;
+	if (slave->t4_valid)
+		_ptp_slave_update_delay(slave);
+}
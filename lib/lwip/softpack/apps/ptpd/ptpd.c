@@ -0,0 +1,307 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lwip/opt.h"
+#include "lwip/igmp.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+
+#ifdef CONFIG_HAVE_GMAC
+#include "network/gmacd.h"
+#endif
+
+#include "apps/ptpd.h"
+
+#include <string.h>
+
+#if !LWIP_IGMP || !LWIP_UDP
+#error ptpd requires LWIP_IGMP and LWIP_UDP
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/* Largest message handled: Announce with a few TLVs */
+#define PTPD_MAX_MSG_LENGTH 128
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct _ptpd {
+	struct netif*      netif;
+	struct udp_pcb*    event_pcb;
+	struct udp_pcb*    general_pcb;
+	ip4_addr_t         group;
+	uint32_t           rx_count;   /**< last RX timestamp capture count */
+	uint32_t           tx_count;   /**< last TX timestamp capture count */
+	bool               tx_pending; /**< waiting for a Delay_Req timestamp */
+	struct _ptp_slave  slave;
+};
+
+/*---------------------------------------------------------------------------
+ *         Variables
+ *---------------------------------------------------------------------------*/
+
+static struct _ptpd _ptpd;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+#ifdef CONFIG_HAVE_GMAC
+
+static void _ptpd_gmac_get_time(void* arg, struct _ptp_time* t)
+{
+	struct _eth_timestamp ts;
+
+	gmacd_ptp_get_time((struct _ethd*)arg, &ts);
+	t->sec = ts.sec;
+	t->nsec = ts.nsec;
+}
+
+static void _ptpd_gmac_adjust_time(void* arg, int64_t delta_ns)
+{
+	gmacd_ptp_adjust_time((struct _ethd*)arg, delta_ns);
+}
+
+static int _ptpd_gmac_adjust_freq(void* arg, int32_t ppb)
+{
+	return gmacd_ptp_adjust_freq((struct _ethd*)arg, ppb);
+}
+
+static uint32_t _ptpd_gmac_get_rx_timestamp(void* arg, struct _ptp_time* t)
+{
+	struct _eth_timestamp ts;
+	uint32_t count;
+
+	count = gmacd_ptp_get_rx_timestamp((struct _ethd*)arg, &ts);
+	t->sec = ts.sec;
+	t->nsec = ts.nsec;
+	return count;
+}
+
+static uint32_t _ptpd_gmac_get_tx_timestamp(void* arg, struct _ptp_time* t)
+{
+	struct _eth_timestamp ts;
+	uint32_t count;
+
+	count = gmacd_ptp_get_tx_timestamp((struct _ethd*)arg, &ts);
+	t->sec = ts.sec;
+	t->nsec = ts.nsec;
+	return count;
+}
+
+const struct _ptp_clock_ops ptpd_gmac_clock = {
+	.get_time = _ptpd_gmac_get_time,
+	.adjust_time = _ptpd_gmac_adjust_time,
+	.adjust_freq = _ptpd_gmac_adjust_freq,
+	.get_rx_timestamp = _ptpd_gmac_get_rx_timestamp,
+	.get_tx_timestamp = _ptpd_gmac_get_tx_timestamp,
+};
+
+#endif /* CONFIG_HAVE_GMAC */
+
+static void _ptpd_send_delay_req(void)
+{
+	const struct _ptp_clock_ops* clock = _ptpd.slave.clock;
+	void* clock_arg = _ptpd.slave.clock_arg;
+	struct _ptp_time ts;
+	struct pbuf* p;
+	ip_addr_t dst;
+
+	p = pbuf_alloc(PBUF_TRANSPORT, PTP_DELAY_REQ_LENGTH, PBUF_RAM);
+	if (!p)
+		return;
+	if (!ptp_slave_pack_delay_req(&_ptpd.slave, (uint8_t*)p->payload, p->len)) {
+		pbuf_free(p);
+		return;
+	}
+
+	/* Remember the capture count to detect the Delay_Req timestamp */
+	if (clock->get_tx_timestamp)
+		_ptpd.tx_count = clock->get_tx_timestamp(clock_arg, &ts);
+
+	ip_addr_copy_from_ip4(dst, _ptpd.group);
+	udp_sendto(_ptpd.event_pcb, p, &dst, PTP_EVENT_PORT);
+	pbuf_free(p);
+
+	if (clock->get_tx_timestamp) {
+		_ptpd.tx_pending = true;
+	} else {
+		clock->get_time(clock_arg, &ts);
+		ptp_slave_tx_timestamp(&_ptpd.slave, &ts);
+	}
+}
+
+static void _ptpd_recv(void* arg, struct udp_pcb* pcb, struct pbuf* p,
+		const ip_addr_t* addr, u16_t port)
+{
+	const struct _ptp_clock_ops* clock = _ptpd.slave.clock;
+	void* clock_arg = _ptpd.slave.clock_arg;
+	uint8_t buf[PTPD_MAX_MSG_LENGTH];
+	const struct _ptp_time* rx_ts = NULL;
+	struct _ptp_time ts;
+	uint16_t len;
+	uint32_t count;
+
+	LWIP_UNUSED_ARG(arg);
+	LWIP_UNUSED_ARG(addr);
+	LWIP_UNUSED_ARG(port);
+
+	len = pbuf_copy_partial(p, buf, sizeof(buf), 0);
+	pbuf_free(p);
+
+	/* Event messages are timestamped by hardware when possible */
+	if (pcb == _ptpd.event_pcb) {
+		if (clock->get_rx_timestamp) {
+			count = clock->get_rx_timestamp(clock_arg, &ts);
+			if (count != _ptpd.rx_count) {
+				_ptpd.rx_count = count;
+				rx_ts = &ts;
+			}
+		} else {
+			clock->get_time(clock_arg, &ts);
+			rx_ts = &ts;
+		}
+	}
+
+	if (ptp_slave_rx(&_ptpd.slave, buf, len, rx_ts))
+		_ptpd_send_delay_req();
+}
+
+static struct udp_pcb* _ptpd_bind(u16_t port)
+{
+	struct udp_pcb* pcb;
+
+	pcb = udp_new();
+	if (!pcb)
+		return NULL;
+	if (udp_bind(pcb, IP_ADDR_ANY, port) != ERR_OK) {
+		udp_remove(pcb);
+		return NULL;
+	}
+	udp_set_multicast_netif_addr(pcb, netif_ip4_addr(_ptpd.netif));
+	udp_recv(pcb, _ptpd_recv, NULL);
+	return pcb;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+err_t ptpd_start(struct netif* netif, const struct _ptp_clock_ops* clock,
+		void* clock_arg, uint8_t domain)
+{
+	uint8_t clock_identity[8];
+	struct _ptp_time ts;
+	err_t err;
+
+	if (_ptpd.netif)
+		return ERR_USE;
+
+	/* EUI-64 clock identity built from the MAC address */
+	clock_identity[0] = netif->hwaddr[0];
+	clock_identity[1] = netif->hwaddr[1];
+	clock_identity[2] = netif->hwaddr[2];
+	clock_identity[3] = 0xff;
+	clock_identity[4] = 0xfe;
+	clock_identity[5] = netif->hwaddr[3];
+	clock_identity[6] = netif->hwaddr[4];
+	clock_identity[7] = netif->hwaddr[5];
+
+	memset(&_ptpd, 0, sizeof(_ptpd));
+	_ptpd.netif = netif;
+	IP4_ADDR(&_ptpd.group, 224, 0, 1, 129);
+	ptp_slave_init(&_ptpd.slave, clock, clock_arg, clock_identity, domain);
+
+	/* Ignore the timestamps captured before start */
+	if (clock->get_rx_timestamp)
+		_ptpd.rx_count = clock->get_rx_timestamp(clock_arg, &ts);
+
+	err = igmp_joingroup_netif(netif, &_ptpd.group);
+	if (err != ERR_OK)
+		goto error;
+
+	_ptpd.event_pcb = _ptpd_bind(PTP_EVENT_PORT);
+	_ptpd.general_pcb = _ptpd_bind(PTP_GENERAL_PORT);
+	if (!_ptpd.event_pcb || !_ptpd.general_pcb) {
+		err = ERR_MEM;
+		goto error;
+	}
+	return ERR_OK;
+
+error:
+	ptpd_stop();
+	return err;
+}
+
+void ptpd_stop(void)
+{
+	if (!_ptpd.netif)
+		return;
+	if (_ptpd.event_pcb)
+		udp_remove(_ptpd.event_pcb);
+	if (_ptpd.general_pcb)
+		udp_remove(_ptpd.general_pcb);
+	igmp_leavegroup_netif(_ptpd.netif, &_ptpd.group);
+	memset(&_ptpd, 0, sizeof(_ptpd));
+}
+
+void ptpd_poll(void)
+{
+	const struct _ptp_clock_ops* clock = _ptpd.slave.clock;
+	struct _ptp_time ts;
+	uint32_t count;
+
+	if (!_ptpd.tx_pending)
+		return;
+
+	count = clock->get_tx_timestamp(_ptpd.slave.clock_arg, &ts);
+	if (count != _ptpd.tx_count) {
+		_ptpd.tx_count = count;
+		_ptpd.tx_pending = false;
+		ptp_slave_tx_timestamp(&_ptpd.slave, &ts);
+	}
+}
+
+const struct _ptp_slave_stats* ptpd_get_stats(void)
+{
+	return &_ptpd.slave.stats;
+}
+
+enum _ptp_servo_state ptpd_get_servo_state(void)
+{
+	return _ptpd.slave.servo.state;
+}
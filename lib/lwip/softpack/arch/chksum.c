@@ -0,0 +1,207 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Internet checksum routines for lwIP (LWIP_CHKSUM and LWIP_CHKSUM_COPY).
+ *
+ * The data is summed 32 bits at a time into a 64-bit accumulator, carries
+ * are folded back once at the end (end-around carry). On ARM, the compiler
+ * turns the 64-bit additions into ADDS/ADC pairs, so the main loop costs
+ * about one load and two ALU instructions per word.
+ *
+ * Results are the same as lwip_standard_chksum(): host order, non-inverted
+ * Internet sum of the data, whatever its alignment.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lwip/opt.h"
+#include "lwip/def.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static inline uint16_t _fold(uint64_t sum)
+{
+	sum = (sum & 0xffffffffu) + (sum >> 32);
+	sum = (sum & 0xffffffffu) + (sum >> 32);
+	sum = (sum & 0xffffu) + (sum >> 16);
+	sum = (sum & 0xffffu) + (sum >> 16);
+	return (uint16_t)sum;
+}
+
+static inline uint16_t _swap(uint16_t sum)
+{
+	return (uint16_t)((sum << 8) | (sum >> 8));
+}
+
+/**
+ * Sum 32-bit aligned words, eight at a time.
+ */
+static uint64_t _sum_words(const uint32_t* p, uint32_t count)
+{
+	uint64_t sum = 0;
+
+	for (; count >= 8; count -= 8, p += 8) {
+		sum += p[0];
+		sum += p[1];
+		sum += p[2];
+		sum += p[3];
+		sum += p[4];
+		sum += p[5];
+		sum += p[6];
+		sum += p[7];
+	}
+	for (; count; count--)
+		sum += *p++;
+	return sum;
+}
+
+/**
+ * Copy and sum 32-bit aligned words, four at a time.
+ */
+static uint64_t _copy_sum_words(uint32_t* dst, const uint32_t* src, uint32_t count)
+{
+	uint64_t sum = 0;
+	uint32_t w0, w1, w2, w3;
+
+	for (; count >= 4; count -= 4, src += 4, dst += 4) {
+		w0 = src[0];
+		w1 = src[1];
+		w2 = src[2];
+		w3 = src[3];
+		dst[0] = w0;
+		dst[1] = w1;
+		dst[2] = w2;
+		dst[3] = w3;
+		sum += w0;
+		sum += w1;
+		sum += w2;
+		sum += w3;
+	}
+	for (; count; count--) {
+		w0 = *src++;
+		*dst++ = w0;
+		sum += w0;
+	}
+	return sum;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+u16_t lwip_arch_chksum(const void* dataptr, int len)
+{
+	const uint8_t* p = (const uint8_t*)dataptr;
+	int odd = (mem_ptr_t)p & 1;
+	uint64_t sum = 0;
+	uint16_t t = 0;
+	uint16_t result;
+
+	if (len <= 0)
+		return 0;
+
+	/* Get aligned to 16 bits: the first byte is the second byte of a
+	 * 16-bit word, the result is swapped back at the end */
+	if (odd) {
+		((uint8_t*)&t)[1] = *p++;
+		len--;
+	}
+
+	/* Get aligned to 32 bits */
+	if (((mem_ptr_t)p & 2) && len >= 2) {
+		sum += *(const uint16_t*)(const void*)p;
+		p += 2;
+		len -= 2;
+	}
+
+	/* Bulk of the data */
+	sum += _sum_words((const uint32_t*)(const void*)p, (uint32_t)len >> 2);
+	p += len & ~3;
+	len &= 3;
+
+	/* Left-over bytes */
+	if (len & 2) {
+		sum += *(const uint16_t*)(const void*)p;
+		p += 2;
+	}
+	if (len & 1)
+		((uint8_t*)&t)[0] = *p;
+	sum += t;
+
+	result = _fold(sum);
+	return odd ? _swap(result) : result;
+}
+
+u16_t lwip_arch_chksum_copy(void* dst, const void* src, u16_t len)
+{
+	uint8_t* d = (uint8_t*)dst;
+	const uint8_t* s = (const uint8_t*)src;
+	uint32_t head, words;
+	uint32_t sum;
+	uint16_t part;
+
+	/* Copy and sum at once only when both buffers can be 32-bit aligned
+	 * together, otherwise copy then sum the (cached) destination */
+	if ((((mem_ptr_t)d ^ (mem_ptr_t)s) & 3) || len < 16) {
+		MEMCPY(dst, src, len);
+		return lwip_arch_chksum(dst, len);
+	}
+
+	/* Unaligned head, at offset 0 of the data */
+	head = (4 - ((mem_ptr_t)s & 3)) & 3;
+	MEMCPY(d, s, head);
+	sum = lwip_arch_chksum(d, head);
+	d += head;
+	s += head;
+	len -= head;
+
+	/* Aligned words, swapped if they start at an odd offset of the data */
+	words = len >> 2;
+	part = _fold(_copy_sum_words((uint32_t*)(void*)d, (const uint32_t*)(const void*)s, words));
+	sum += (head & 1) ? _swap(part) : part;
+	d += words << 2;
+	s += words << 2;
+	len &= 3;
+
+	/* Tail, at an odd offset of the data if the head was odd */
+	MEMCPY(d, s, len);
+	part = lwip_arch_chksum(d, len);
+	sum += (head & 1) ? _swap(part) : part;
+
+	return _fold(sum);
+}
@@ -1,8 +1,34 @@
 #include "arch/cc.h"
 #include "arch/sys_arch.h"
+#include "lwip/opt.h"
 #include "timer.h"
 
+#if LWIP_TIMERS
+#include "arch/sys_loop.h"
+#include "cpuidle.h"
+#include "irqflags.h"
+#endif
+
 unsigned int sys_now(void)
 {
 	return timer_get_tick();
 }
+
+#if LWIP_TIMERS
+void sys_arch_idle(unsigned int timeout)
+{
+#ifndef CONFIG_TIMER_POLLING
+	uint64_t deadline = timer_get_tick() + timeout;
+
+	/* Interrupts are disabled so that a frame received after the check
+	 * wakes up the core from WFI instead of being missed */
+	arch_irq_disable();
+	if (!sys_loop_pending()) {
+		timer_set_alarm(deadline);
+		if (timer_get_tick() < deadline)
+			cpu_idle();
+	}
+	arch_irq_enable();
+#endif
+}
+#endif
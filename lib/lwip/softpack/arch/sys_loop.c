@@ -0,0 +1,151 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lwip/opt.h"
+#include "lwip/timeouts.h"
+
+#include "arch/sys_loop.h"
+
+#include <string.h>
+
+/* sys_loop relies on lwIP timeouts (NO_SYS_NO_TIMERS set to 0) */
+#if LWIP_TIMERS
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+struct _sys_loop_netif {
+	struct netif        *netif;
+	sys_loop_poll_fn     poll;
+	sys_loop_pending_fn  pending;
+};
+
+/*---------------------------------------------------------------------------
+ *         Variables
+ *---------------------------------------------------------------------------*/
+
+static struct _sys_loop {
+	struct _sys_loop_netif netifs[SYS_LOOP_MAX_NETIF];
+	u8_t                   netif_count;
+	sys_loop_idle_fn       idle;
+	struct _sys_loop_stats stats;
+} _loop;
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+void sys_loop_init(sys_loop_idle_fn idle)
+{
+	memset(&_loop, 0, sizeof(_loop));
+	_loop.idle = idle;
+}
+
+err_t sys_loop_add_netif(struct netif *netif, sys_loop_poll_fn poll,
+		sys_loop_pending_fn pending)
+{
+	struct _sys_loop_netif *n;
+
+	if (_loop.netif_count >= SYS_LOOP_MAX_NETIF)
+		return ERR_MEM;
+
+	n = &_loop.netifs[_loop.netif_count++];
+	n->netif = netif;
+	n->poll = poll;
+	n->pending = pending;
+	return ERR_OK;
+}
+
+bool sys_loop_pending(void)
+{
+	int i;
+
+	for (i = 0; i < _loop.netif_count; i++)
+		if (_loop.netifs[i].pending(_loop.netifs[i].netif))
+			return true;
+	return false;
+}
+
+u32_t sys_loop_run_once(void)
+{
+	struct _sys_loop_netif *n;
+	bool busy = false;
+	u32_t frames = 0;
+	u32_t sleeptime;
+	u16_t count;
+	int i;
+
+	_loop.stats.rounds++;
+
+	/* Round-robin between interfaces so that a busy one cannot starve
+	 * the others */
+	for (i = 0; i < _loop.netif_count; i++) {
+		n = &_loop.netifs[i];
+		count = n->poll(n->netif, SYS_LOOP_BUDGET);
+		frames += count;
+		if (count >= SYS_LOOP_BUDGET)
+			busy = true;
+	}
+	_loop.stats.frames += frames;
+
+	sys_check_timeouts();
+
+	/* More frames are waiting, start another round at once */
+	if (busy) {
+		_loop.stats.busy_rounds++;
+		return frames;
+	}
+
+	sleeptime = sys_timeouts_sleeptime();
+	if (sleeptime > SYS_LOOP_MAX_SLEEP)
+		sleeptime = SYS_LOOP_MAX_SLEEP;
+	if (sleeptime && _loop.idle) {
+		_loop.stats.idles++;
+		_loop.idle(sleeptime);
+	}
+	return frames;
+}
+
+void sys_loop_run(void)
+{
+	while (1)
+		sys_loop_run_once();
+}
+
+void sys_loop_get_stats(struct _sys_loop_stats *stats)
+{
+	memcpy(stats, &_loop.stats, sizeof(*stats));
+}
+
+#endif /* LWIP_TIMERS */
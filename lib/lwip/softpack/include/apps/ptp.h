@@ -0,0 +1,271 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * IEEE 1588-2008 (PTPv2) ordinary clock slave: message encoding, PI clock
+ * servo and slave state machine.
+ *
+ * This part does not depend on lwIP nor on the hardware: frames and their
+ * timestamps are fed by the caller and the local clock is driven through
+ * struct _ptp_clock_ops, so that it can be run against a simulated master.
+ */
+
+#ifndef _PTP_H
+#define _PTP_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** UDP port of event messages (Sync, Delay_Req) */
+#define PTP_EVENT_PORT   319
+/** UDP port of general messages (Follow_Up, Delay_Resp, Announce) */
+#define PTP_GENERAL_PORT 320
+
+/** Message types */
+#define PTP_MSG_SYNC       0x0
+#define PTP_MSG_DELAY_REQ  0x1
+#define PTP_MSG_FOLLOW_UP  0x8
+#define PTP_MSG_DELAY_RESP 0x9
+#define PTP_MSG_ANNOUNCE   0xb
+
+/** Message lengths */
+#define PTP_HEADER_LENGTH     34
+#define PTP_SYNC_LENGTH       44
+#define PTP_DELAY_REQ_LENGTH  44
+#define PTP_FOLLOW_UP_LENGTH  44
+#define PTP_DELAY_RESP_LENGTH 54
+#define PTP_ANNOUNCE_LENGTH   64
+
+/** flagField: two-step clock, a Follow_Up carries the Sync origin time */
+#define PTP_FLAG_TWO_STEP (1u << 9)
+
+/** Default servo settings, for a one second Sync interval */
+#define PTP_SERVO_KP             0.7
+#define PTP_SERVO_KI             0.3
+#define PTP_SERVO_MAX_PPB        500000
+#define PTP_SERVO_STEP_THRESHOLD 20000000ll /**< step above 20ms */
+
+/** Offset below which the servo is considered locked (ns) */
+#define PTP_SERVO_LOCK_THRESHOLD 1000
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** PTP time, nsec is always in [0, 999999999] */
+struct _ptp_time {
+	int64_t sec;
+	int32_t nsec;
+};
+
+struct _ptp_port_identity {
+	uint8_t  clock_identity[8];
+	uint16_t port_number;
+};
+
+/** Decoded PTP message (header and the fields of the supported messages) */
+struct _ptp_msg {
+	uint8_t  type;
+	uint8_t  version;
+	uint16_t length;
+	uint8_t  domain;
+	uint16_t flags;
+	int64_t  correction;   /**< correctionField, ns * 2^16 */
+	struct _ptp_port_identity source;
+	uint16_t sequence_id;
+	uint8_t  control;
+	int8_t   log_interval;
+	struct _ptp_time timestamp; /**< origin or receive timestamp */
+	struct _ptp_port_identity requesting; /**< Delay_Resp only */
+};
+
+/** Local clock driven by the slave */
+struct _ptp_clock_ops {
+	void (*get_time)(void* arg, struct _ptp_time* t);
+	/** step the clock by delta_ns */
+	void (*adjust_time)(void* arg, int64_t delta_ns);
+	/** set the frequency offset from nominal, in parts per billion */
+	int (*adjust_freq)(void* arg, int32_t ppb);
+	/** get the last event frame timestamps, return the capture count */
+	uint32_t (*get_rx_timestamp)(void* arg, struct _ptp_time* t);
+	uint32_t (*get_tx_timestamp)(void* arg, struct _ptp_time* t);
+};
+
+enum _ptp_servo_state {
+	PTP_SERVO_UNLOCKED = 0, /**< no sample processed yet */
+	PTP_SERVO_STEP,         /**< clock must be stepped by -offset */
+	PTP_SERVO_TRACKING,     /**< frequency adjusted, offset above lock threshold */
+	PTP_SERVO_LOCKED,       /**< frequency adjusted, offset below lock threshold */
+};
+
+/** PI servo */
+struct _ptp_servo {
+	double  kp;
+	double  ki;
+	double  drift;          /**< integral term, ppb */
+	int32_t max_ppb;
+	int64_t step_threshold; /**< ns, 0 to never step after the first sample */
+	enum _ptp_servo_state state;
+};
+
+struct _ptp_slave_stats {
+	uint32_t sync;
+	uint32_t follow_up;
+	uint32_t delay_req;
+	uint32_t delay_resp;
+	uint32_t announce;
+	uint32_t dropped;       /**< unexpected or malformed messages */
+	uint32_t steps;         /**< clock steps */
+	int64_t  offset;        /**< last offset from master, ns */
+	int64_t  path_delay;    /**< last mean path delay, ns */
+	int32_t  freq;          /**< last frequency adjustment, ppb */
+};
+
+/** Ordinary clock slave */
+struct _ptp_slave {
+	const struct _ptp_clock_ops* clock;
+	void*    clock_arg;
+	uint8_t  domain;
+	struct _ptp_port_identity port;
+	struct _ptp_port_identity master;
+	bool     has_master;
+
+	/* Sync / Follow_Up */
+	uint16_t sync_seq;
+	int8_t   log_sync_interval;
+	bool     sync_pending;   /**< waiting for the Follow_Up */
+	int64_t  sync_correction;
+	struct _ptp_time t1;     /**< master Sync origin time */
+	struct _ptp_time t2;     /**< local Sync receive time */
+
+	/* Delay_Req / Delay_Resp */
+	uint16_t delay_req_seq;
+	bool     delay_req_pending; /**< waiting for the Delay_Resp */
+	bool     t3_valid;
+	bool     t4_valid;
+	struct _ptp_time t3;     /**< local Delay_Req send time */
+	struct _ptp_time t4;     /**< master Delay_Req receive time */
+	bool     delay_valid;
+	int64_t  path_delay;     /**< filtered mean path delay, ns */
+
+	struct _ptp_servo servo;
+	struct _ptp_slave_stats stats;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Difference a - b in nanoseconds.
+ */
+extern int64_t ptp_time_diff(const struct _ptp_time* a, const struct _ptp_time* b);
+
+/**
+ * \brief Add a signed number of nanoseconds to a PTP time.
+ */
+extern void ptp_time_add(struct _ptp_time* t, int64_t ns);
+
+/**
+ * \brief Decode a PTP message.
+ * \return 0 on success, -EINVAL if the message is malformed or not PTPv2
+ */
+extern int ptp_msg_unpack(const uint8_t* buf, uint16_t len, struct _ptp_msg* msg);
+
+/**
+ * \brief Encode a PTP message, msg->length bytes are written.
+ * \return msg->length, or 0 if the buffer is too small
+ */
+extern uint16_t ptp_msg_pack(const struct _ptp_msg* msg, uint8_t* buf, uint16_t size);
+
+/**
+ * \brief Initialize a PI servo.
+ * \param kp Proportional constant, ppb per ns of offset for 1s interval
+ * \param ki Integral constant, ppb per ns of offset for 1s interval
+ * \param max_ppb Frequency adjustment limit
+ * \param step_threshold Offset above which the clock is stepped (ns)
+ */
+extern void ptp_servo_init(struct _ptp_servo* servo, double kp, double ki,
+		int32_t max_ppb, int64_t step_threshold);
+
+/**
+ * \brief Feed an offset sample to the servo.
+ * \param offset Offset of the local clock from the master, ns
+ * \param interval Time since the previous sample, s
+ * \param ppb Frequency adjustment to apply (valid unless PTP_SERVO_STEP)
+ * \return New servo state
+ */
+extern enum _ptp_servo_state ptp_servo_sample(struct _ptp_servo* servo,
+		int64_t offset, double interval, int32_t* ppb);
+
+/**
+ * \brief Initialize a slave.
+ * \param clock Local clock operations
+ * \param clock_arg Argument passed to the clock operations
+ * \param clock_identity Local clock identity, usually the EUI-64 built from
+ * the MAC address
+ * \param domain PTP domain
+ */
+extern void ptp_slave_init(struct _ptp_slave* slave,
+		const struct _ptp_clock_ops* clock, void* clock_arg,
+		const uint8_t clock_identity[8], uint8_t domain);
+
+/**
+ * \brief Process a received PTP message.
+ * \param buf Message
+ * \param len Message length
+ * \param rx_ts Receive timestamp (used for Sync only)
+ * \return true if a Delay_Req must be sent
+ */
+extern bool ptp_slave_rx(struct _ptp_slave* slave, const uint8_t* buf,
+		uint16_t len, const struct _ptp_time* rx_ts);
+
+/**
+ * \brief Build the next Delay_Req message.
+ * \return Message length, or 0 if the buffer is too small
+ */
+extern uint16_t ptp_slave_pack_delay_req(struct _ptp_slave* slave,
+		uint8_t* buf, uint16_t size);
+
+/**
+ * \brief Give the transmit timestamp of the last Delay_Req sent.
+ */
+extern void ptp_slave_tx_timestamp(struct _ptp_slave* slave,
+		const struct _ptp_time* tx_ts);
+
+#endif /* _PTP_H */
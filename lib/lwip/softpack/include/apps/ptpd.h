@@ -0,0 +1,101 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * PTPv2 ordinary clock slave over lwIP UDP/IPv4 (end-to-end delay
+ * mechanism, primary multicast address 224.0.1.129).
+ *
+ * Usage:
+ * -# Start the slave on a network interface with ptpd_start(), giving the
+ *    clock to discipline. On GMAC interfaces, use ptpd_gmac_clock with the
+ *    struct _ethd of the interface as argument, after gmacd_ptp_enable().
+ * -# Call ptpd_poll() periodically, along with ethif_poll().
+ * -# Monitor the synchronization with ptpd_get_stats().
+ */
+
+#ifndef _PTPD_H
+#define _PTPD_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lwip/netif.h"
+#include "lwip/err.h"
+
+#include "apps/ptp.h"
+
+/*----------------------------------------------------------------------------
+ *        Exported variables
+ *----------------------------------------------------------------------------*/
+
+#ifdef CONFIG_HAVE_GMAC
+/** GMAC timestamp unit clock, the argument is a struct _ethd* */
+extern const struct _ptp_clock_ops ptpd_gmac_clock;
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Start the PTP slave.
+ * \param netif Network interface
+ * \param clock Clock to discipline, if it cannot timestamp frames
+ * (get_rx_timestamp/get_tx_timestamp are NULL) the clock is read when
+ * frames are handled by lwIP
+ * \param clock_arg Argument of the clock operations
+ * \param domain PTP domain
+ * \return ERR_OK, ERR_MEM or ERR_USE
+ */
+extern err_t ptpd_start(struct netif* netif, const struct _ptp_clock_ops* clock,
+		void* clock_arg, uint8_t domain);
+
+/**
+ * \brief Stop the PTP slave.
+ */
+extern void ptpd_stop(void);
+
+/**
+ * \brief Process the pending transmit timestamps.
+ */
+extern void ptpd_poll(void);
+
+/**
+ * \brief Get the slave statistics.
+ */
+extern const struct _ptp_slave_stats* ptpd_get_stats(void);
+
+/**
+ * \brief Get the servo state.
+ */
+extern enum _ptp_servo_state ptpd_get_servo_state(void);
+
+#endif /* _PTPD_H */
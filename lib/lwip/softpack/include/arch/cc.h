@@ -30,6 +30,7 @@
 #ifndef _CC_H
 #define _CC_H
 
+#include <stdint.h>
 #include <stdio.h>
 
 /* Define platform endianness */
@@ -68,6 +69,18 @@
     #error "This compiler does not support."
 #endif
 
+/* Optimized checksum routines (lib/lwip/softpack/arch/chksum.c). Define
+ * LWIP_CHKSUM_ALGORITHM or LWIP_CHKSUM_COPY_ALGORITHM in lwipopts.h to use
+ * the portable lwIP implementations instead. */
+#ifndef LWIP_CHKSUM_ALGORITHM
+#define LWIP_CHKSUM lwip_arch_chksum
+uint16_t lwip_arch_chksum(const void* dataptr, int len);
+#endif
+#ifndef LWIP_CHKSUM_COPY_ALGORITHM
+#define LWIP_CHKSUM_COPY(dst, src, len) lwip_arch_chksum_copy(dst, src, len)
+uint16_t lwip_arch_chksum_copy(void* dst, const void* src, uint16_t len);
+#endif
+
 /* No assert */
 #define LWIP_NOASSERT
 
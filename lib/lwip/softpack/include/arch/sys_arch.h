@@ -37,4 +37,11 @@
 
 unsigned int sys_now(void);
 
+/**
+ * \brief Idle function for sys_loop: sleep until the system timer reaches
+ * timeout ms from now, or until an interrupt occurs.
+ * Returns at once if sys_loop_pending() is true.
+ */
+void sys_arch_idle(unsigned int timeout);
+
 #endif
@@ -0,0 +1,134 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file
+ *
+ * Event loop for lwIP without operating system (NO_SYS).
+ *
+ * The loop drains the received frames of all the registered network
+ * interfaces in rounds, each interface processing at most SYS_LOOP_BUDGET
+ * frames per round, then runs the expired lwIP timeouts. When there is
+ * nothing left to do, the idle function given to sys_loop_init() is called
+ * until the next timeout is due, or until a frame is received.
+ *
+ * lwIP timers must be enabled (NO_SYS_NO_TIMERS set to 0): timeouts are
+ * kept by lwIP in a list ordered by deadline.
+ */
+
+#ifndef _SYS_LOOP_H
+#define _SYS_LOOP_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lwip/netif.h"
+#include "lwip/err.h"
+
+#include <stdbool.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Maximum number of network interfaces handled by the loop */
+#ifndef SYS_LOOP_MAX_NETIF
+#define SYS_LOOP_MAX_NETIF  4
+#endif
+
+/** Maximum number of frames processed per interface and per round */
+#ifndef SYS_LOOP_BUDGET
+#define SYS_LOOP_BUDGET     16
+#endif
+
+/** Maximum time spent in the idle function (ms) */
+#ifndef SYS_LOOP_MAX_SLEEP
+#define SYS_LOOP_MAX_SLEEP  1000
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Process up to budget received frames, return the number processed */
+typedef u16_t (*sys_loop_poll_fn)(struct netif *netif, u16_t budget);
+
+/** Check if received frames are waiting to be processed */
+typedef bool (*sys_loop_pending_fn)(struct netif *netif);
+
+/** Wait for an event during at most timeout ms. Must return at once if
+ * sys_loop_pending() is true when called with interrupts disabled. */
+typedef void (*sys_loop_idle_fn)(u32_t timeout);
+
+struct _sys_loop_stats {
+	u32_t rounds;       /**< loop iterations */
+	u32_t idles;        /**< calls to the idle function */
+	u32_t frames;       /**< received frames processed */
+	u32_t busy_rounds;  /**< rounds where an interface used all its budget */
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Initialize the loop.
+ * \param idle Idle function, NULL to never sleep
+ */
+extern void sys_loop_init(sys_loop_idle_fn idle);
+
+/**
+ * \brief Register a network interface.
+ * \return ERR_OK, or ERR_MEM if SYS_LOOP_MAX_NETIF interfaces are registered
+ */
+extern err_t sys_loop_add_netif(struct netif *netif, sys_loop_poll_fn poll,
+		sys_loop_pending_fn pending);
+
+/**
+ * \brief Check if any registered interface has received frames waiting.
+ */
+extern bool sys_loop_pending(void);
+
+/**
+ * \brief Run one round of the loop, then sleep if there is nothing to do.
+ * \return Number of frames processed
+ */
+extern u32_t sys_loop_run_once(void);
+
+/**
+ * \brief Run the loop forever.
+ */
+extern void sys_loop_run(void);
+
+/**
+ * \brief Get the loop statistics.
+ */
+extern void sys_loop_get_stats(struct _sys_loop_stats *stats);
+
+#endif /* _SYS_LOOP_H */
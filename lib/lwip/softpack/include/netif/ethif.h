@@ -39,12 +39,39 @@
 #include "lwip/err.h"
 #include "netif/etharp.h"
 
+#include <stdbool.h>
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
 
 err_t ethif_init(struct netif * netif);
+
+/**
+ * Read received frames on all queues and run the lwIP timers.
+ * Should be called periodically when sys_loop is not used.
+ */
 void ethif_poll(struct netif * netif);
 
+/**
+ * Process up to budget received frames using the hybrid interrupt/polling
+ * mode of the ETH driver, and reclaim sent frames.
+ * \return Number of frames processed
+ */
+u16_t ethif_poll_budget(struct netif * netif, u16_t budget);
+
+/**
+ * Check if received frames are waiting for ethif_poll_budget().
+ */
+bool ethif_rx_pending(struct netif * netif);
+
+#if !NO_SYS_NO_TIMERS
+/**
+ * Switch the ETH driver to the hybrid interrupt/polling mode and register
+ * the interface to sys_loop.
+ */
+err_t ethif_loop_add(struct netif * netif);
+#endif
+
 #endif  /* _ETHIF_H */
 
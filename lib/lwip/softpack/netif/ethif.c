@@ -55,11 +55,18 @@
 #if LWIP_DHCP
 #include "lwip/dhcp.h"
 #endif
+#if LWIP_IGMP
+#include "lwip/igmp.h"
+#endif
 #include "lwip/mem.h"
 #include "lwip/pbuf.h"
 #include "lwip/priv/tcp_priv.h"
 #include "lwip/stats.h"
 #include "lwip/sys.h"
+#if !NO_SYS_NO_TIMERS
+#include "lwip/timeouts.h"
+#include "arch/sys_loop.h"
+#endif
 #include "timer.h"
 
 /*----------------------------------------------------------------------------
@@ -74,6 +81,7 @@
  *        Types
  *----------------------------------------------------------------------------*/
 
+#if NO_SYS_NO_TIMERS
 /* Timer for calling lwIP tmr functions without system */
 typedef struct _timers_info {
 	uint32_t timer;
@@ -100,13 +108,19 @@ static timers_info timers_table[] = {
 #if LWIP_DHCP
 	{ 0, DHCP_COARSE_TIMER_SECS, dhcp_coarse_tmr},
 	{ 0, DHCP_FINE_TIMER_MSECS,  dhcp_fine_tmr},
+#endif
+	/* LWIP_IGMP */
+#if LWIP_IGMP
+	{ 0, IGMP_TMR_INTERVAL,      igmp_tmr},
 #endif
 };
+#endif /* NO_SYS_NO_TIMERS */
 
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
 
+#if NO_SYS_NO_TIMERS
 /**
  * Process timing functions
  */
@@ -138,6 +152,8 @@ static void timers_update(void)
 	}
 }
 
+#endif /* NO_SYS_NO_TIMERS */
+
 /* Forward declarations. */
 static void  ethif_input(struct netif *netif);
 static err_t ethif_output(struct netif *netif, struct pbuf *p, ip4_addr_t *ipaddr);
@@ -155,8 +171,50 @@ static void glow_level_init(struct netif *netif, struct _ethd* ethd)
 	netif->mtu = 1500;
 	/* device capabilities */
 	netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET| NETIF_FLAG_LINK_UP;
+#if LWIP_IGMP
+	/* multicast frames are not filtered: the MAC copies all frames */
+	netif->flags |= NETIF_FLAG_IGMP;
+#endif
+
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+	/* skip software checksum generation done by hardware */
+	if (ethd_get_csum_offload(ethd) & ETH_CSUM_TX)
+		NETIF_SET_CHECKSUM_CTRL(netif, NETIF_CHECKSUM_ENABLE_ALL &
+				~(NETIF_CHECKSUM_GEN_IP | NETIF_CHECKSUM_GEN_UDP |
+				  NETIF_CHECKSUM_GEN_TCP));
+#endif
 }
 
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+/**
+ * Update the netif checksum checking flags for the frame about to be passed
+ * to the stack, skipping the checks already done by the hardware.
+ *
+ * @param netif the lwip network interface structure for this ethif
+ * @param csum_status checksum status of the frame (ETH_RX_STATUS_CSUM_*)
+ */
+static void ethif_set_rx_csum_ctrl(struct netif *netif, uint32_t csum_status)
+{
+	u16_t flags = netif->chksum_flags | NETIF_CHECKSUM_CHECK_IP |
+		NETIF_CHECKSUM_CHECK_UDP | NETIF_CHECKSUM_CHECK_TCP;
+
+	switch (csum_status) {
+	case ETH_RX_STATUS_CSUM_IP_TCP:
+		flags &= ~(NETIF_CHECKSUM_CHECK_IP | NETIF_CHECKSUM_CHECK_TCP);
+		break;
+	case ETH_RX_STATUS_CSUM_IP_UDP:
+		flags &= ~(NETIF_CHECKSUM_CHECK_IP | NETIF_CHECKSUM_CHECK_UDP);
+		break;
+	case ETH_RX_STATUS_CSUM_IP:
+		flags &= ~NETIF_CHECKSUM_CHECK_IP;
+		break;
+	default:
+		break;
+	}
+	NETIF_SET_CHECKSUM_CTRL(netif, flags);
+}
+#endif
+
 /**
  * This function should do the actual transmission of the packet. The packet is
  * contained in the pbuf that is passed to the function. This pbuf
@@ -170,6 +228,7 @@ static void glow_level_init(struct netif *netif, struct _ethd* ethd)
 static err_t glow_level_output(struct netif *netif, struct pbuf *p)
 {
 
+    struct _ethd *ethd = board_get_eth(netif->num);
     struct pbuf *q;
     uint8_t buf[1514];
     uint8_t *bufptr = &buf[0];
@@ -190,7 +249,13 @@ static err_t glow_level_output(struct netif *netif, struct pbuf *p)
     }
 
     /* signal that packet should be sent(); */
-    rc = ethd_send(board_get_eth(netif->num), 0, buf, p->tot_len, NULL);
+    rc = ethd_send(ethd, 0, buf, p->tot_len, NULL);
+    if (rc == ETH_TX_BUSY && ethd->napi) {
+        /* sent frames are only reclaimed when polling, and this may
+        run from the poll itself: only reclaim them */
+        ethd_tx_reclaim(ethd, 0);
+        rc = ethd_send(ethd, 0, buf, p->tot_len, NULL);
+    }
     if (rc != ETH_OK) {
         return ERR_BUF;
     }
@@ -204,31 +269,19 @@ static err_t glow_level_output(struct netif *netif, struct pbuf *p)
 }
 
 /**
- * Should allocate a pbuf and transfer the bytes of the incoming
- * packet from the interface into the pbuf.
+ * Should allocate a pbuf and transfer the bytes of a received frame into
+ * the pbuf.
  *
- * @param netif the lwip network interface structure for this ethif
+ * @param frame the received frame (including MAC header)
+ * @param frmlen size of the received frame
  * @return a pbuf filled with the received packet (including MAC header)
  *         NULL on memory error
  */
-static struct pbuf *glow_level_input(struct netif *netif)
+static struct pbuf *glow_level_frame_to_pbuf(const uint8_t *frame, uint32_t frmlen)
 {
     struct pbuf *p, *q;
-    u16_t len;
-    uint8_t buf[1514];
-    uint8_t *bufptr = &buf[0];
-
-    uint32_t frmlen;
-    uint8_t rc;
-
-    /* Obtain the size of the packet and put it into the "len"
-       variable. */
-    rc = ethd_poll(board_get_eth(netif->num), 0, buf, (uint32_t)sizeof(buf), (uint32_t*)&frmlen);
-    if (rc != ETH_OK)
-    {
-      return NULL;
-    }
-    len = frmlen;
+    u16_t len = frmlen;
+    const uint8_t *bufptr = frame;
 
 #if ETH_PAD_SIZE
     len += ETH_PAD_SIZE;      /* allow room for Ethernet padding */
@@ -265,6 +318,32 @@ static struct pbuf *glow_level_input(struct netif *netif)
     return p;
 }
 
+/**
+ * Should allocate a pbuf and transfer the bytes of the incoming
+ * packet from the interface into the pbuf.
+ *
+ * @param netif the lwip network interface structure for this ethif
+ * @param queue the ETH queue to read from
+ * @param csum_status checksum status of the received packet
+ * @return a pbuf filled with the received packet (including MAC header)
+ *         NULL on memory error
+ */
+static struct pbuf *glow_level_input(struct netif *netif, uint8_t queue, uint32_t *csum_status)
+{
+    uint8_t buf[1514];
+    uint32_t frmlen;
+    uint8_t rc;
+
+    /* Obtain the size of the packet and put it into the "len"
+       variable. */
+    rc = ethd_poll_csum(board_get_eth(netif->num), queue, buf, (uint32_t)sizeof(buf), (uint32_t*)&frmlen, csum_status);
+    if (rc != ETH_OK)
+    {
+      return NULL;
+    }
+    return glow_level_frame_to_pbuf(buf, frmlen);
+}
+
 /**
  * This function is called by the TCP/IP stack when an IP packet
  * should be sent. It calls the function called glow_level_output() to
@@ -277,24 +356,20 @@ static err_t ethif_output(struct netif *netif, struct pbuf *p, ip4_addr_t *ipadd
     return etharp_output(netif, p, ipaddr);
 }
 /**
- * This function should be called when a packet is ready to be read
- * from the interface. It uses the function low_level_input() that
- * should handle the actual reception of bytes from the network
- * interface. Then the type of the received packet is determined and
- * the appropriate input function is called.
+ * Determine the type of a received packet and call the appropriate input
+ * function.
  *
  * @param netif the lwip network interface structure for this ethif
+ * @param p the received packet (including MAC header)
+ * @param csum_status checksum status of the received packet
  */
-
-static void ethif_input(struct netif *netif)
+static void ethif_input_pbuf(struct netif *netif, struct pbuf *p, uint32_t csum_status)
 {
     struct eth_hdr *ethhdr;
-    struct pbuf *p;
 
-    /* move received packet into a new pbuf */
-    p = glow_level_input(netif);
-    /* no packet could be read, silently ignore this */
-    if (p == NULL) return;
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+    ethif_set_rx_csum_ctrl(netif, csum_status);
+#endif
     /* points to packet payload, which starts with an Ethernet header */
     ethhdr = p->payload;
 
@@ -316,7 +391,65 @@ static void ethif_input(struct netif *netif)
             p = NULL;
             break;
         }
+}
 
+/**
+ * This function should be called when a packet is ready to be read
+ * from the interface. It uses the function low_level_input() that
+ * should handle the actual reception of bytes from the network
+ * interface. Then the type of the received packet is determined and
+ * the appropriate input function is called.
+ *
+ * @param netif the lwip network interface structure for this ethif
+ * @param queue the ETH queue to read from
+ * @return 1 if a packet has been read, 0 otherwise
+ */
+static int ethif_input_queue(struct netif *netif, uint8_t queue)
+{
+    struct pbuf *p;
+    uint32_t csum_status;
+
+    /* move received packet into a new pbuf */
+    p = glow_level_input(netif, queue, &csum_status);
+    /* no packet could be read, silently ignore this */
+    if (p == NULL) return 0;
+    ethif_input_pbuf(netif, p, csum_status);
+    return 1;
+}
+
+/**
+ * Frame handler for ethd_napi_poll(): pass a received frame to the stack.
+ */
+static void ethif_napi_handler(void *arg, uint8_t queue, uint8_t *frame,
+		uint32_t size, uint32_t csum_status)
+{
+	struct netif *netif = (struct netif *)arg;
+	struct pbuf *p;
+
+	p = glow_level_frame_to_pbuf(frame, size);
+	if (p != NULL)
+		ethif_input_pbuf(netif, p, csum_status);
+}
+
+/**
+ * Read received packets from all ETH queues, highest priority queue first,
+ * up to the budget of each queue.
+ *
+ * @param netif the lwip network interface structure for this ethif
+ */
+static void ethif_input(struct netif *netif)
+{
+	struct _ethd *ethd = board_get_eth(netif->num);
+	uint16_t budget;
+	int queue;
+
+	for (queue = ETH_QUEUE_COUNT - 1; queue >= 0; queue--) {
+		budget = ethd_get_rx_budget(ethd, queue);
+		while (budget-- > 0) {
+			if (!ethif_input_queue(netif, queue))
+				break;
+		}
+	}
 }
 
 /*----------------------------------------------------------------------------
@@ -348,7 +481,32 @@ err_t ethif_init(struct netif *netif)
 void ethif_poll(struct netif *netif)
 {
 	/* Run periodic tasks */
+#if NO_SYS_NO_TIMERS
 	timers_update();
+#else
+	sys_check_timeouts();
+#endif
 
 	ethif_input(netif);
 }
+
+u16_t ethif_poll_budget(struct netif *netif, u16_t budget)
+{
+	static uint8_t buf[ETH_MAX_FRAME_LENGTH];
+
+	return ethd_napi_poll(board_get_eth(netif->num), budget,
+			buf, sizeof(buf), ethif_napi_handler, netif);
+}
+
+bool ethif_rx_pending(struct netif *netif)
+{
+	return ethd_napi_pending(board_get_eth(netif->num));
+}
+
+#if !NO_SYS_NO_TIMERS
+err_t ethif_loop_add(struct netif *netif)
+{
+	ethd_set_napi(board_get_eth(netif->num), true);
+	return sys_loop_add_netif(netif, ethif_poll_budget, ethif_rx_pending);
+}
+#endif
@@ -0,0 +1,135 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "pixfmt/pixfmt.h"
+#include "pixfmt/bayer.h"
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Interpolate the pixel x of row cur. l and r are the indexes of its left
+ * and right neighbours, site the color of the pixel: bit 0 set on the blue
+ * columns, bit 1 on the blue rows (0: red, 3: blue, 1 and 2: green).
+ */
+static inline void _bayer_pixel(const uint8_t* up, const uint8_t* cur,
+		const uint8_t* dn, uint32_t x, uint32_t l, uint32_t r,
+		uint32_t site, uint8_t* rgb)
+{
+	uint32_t c = cur[x];
+
+	switch (site) {
+	case 0:
+		rgb[0] = (uint8_t)c;
+		rgb[1] = (uint8_t)((up[x] + dn[x] + cur[l] + cur[r] + 2) >> 2);
+		rgb[2] = (uint8_t)((up[l] + up[r] + dn[l] + dn[r] + 2) >> 2);
+		break;
+	case 1:
+		rgb[0] = (uint8_t)((cur[l] + cur[r] + 1) >> 1);
+		rgb[1] = (uint8_t)c;
+		rgb[2] = (uint8_t)((up[x] + dn[x] + 1) >> 1);
+		break;
+	case 2:
+		rgb[0] = (uint8_t)((up[x] + dn[x] + 1) >> 1);
+		rgb[1] = (uint8_t)c;
+		rgb[2] = (uint8_t)((cur[l] + cur[r] + 1) >> 1);
+		break;
+	default:
+		rgb[0] = (uint8_t)((up[l] + up[r] + dn[l] + dn[r] + 2) >> 2);
+		rgb[1] = (uint8_t)((up[x] + dn[x] + cur[l] + cur[r] + 2) >> 2);
+		rgb[2] = (uint8_t)c;
+		break;
+	}
+}
+
+static inline void _bayer_put(void* dst, uint32_t x, const uint8_t* rgb,
+		enum _pixfmt_rgb format)
+{
+	if (format == PIXFMT_RGB565)
+		((uint16_t*)dst)[x] = pixfmt_pack565(rgb[0], rgb[1], rgb[2]);
+	else
+		((uint32_t*)dst)[x] = pixfmt_pack8888(rgb[0], rgb[1], rgb[2]);
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int pixfmt_bayer_to_rgb(const uint8_t* src, uint32_t src_stride,
+		void* dst, uint32_t dst_stride, uint32_t width, uint32_t height,
+		enum _pixfmt_bayer pattern, enum _pixfmt_rgb format)
+{
+	uint8_t* d = (uint8_t*)dst;
+	uint32_t rx = (uint32_t)pattern & 1;
+	uint32_t ry = ((uint32_t)pattern >> 1) & 1;
+	uint32_t x, y;
+	uint8_t rgb[3];
+
+	if (width < 2 || height < 2 || (uint32_t)pattern > PIXFMT_BAYER_BGGR)
+		return -EINVAL;
+	if (format != PIXFMT_RGB565 && format != PIXFMT_ARGB8888)
+		return -EINVAL;
+
+	for (y = 0; y < height; y++) {
+		const uint8_t* cur = src + y * src_stride;
+		const uint8_t* up = src + (y ? y - 1 : 1) * src_stride;
+		const uint8_t* dn = src + (y < height - 1 ? y + 1 : height - 2) * src_stride;
+		uint32_t row = ((y ^ ry) & 1) << 1;
+		uint32_t s0 = row | rx;
+		uint32_t s1 = row | (rx ^ 1);
+
+		/* mirrored borders, sites alternate s0, s1 along the row */
+		_bayer_pixel(up, cur, dn, 0, 1, 1, s0, rgb);
+		_bayer_put(d, 0, rgb, format);
+		for (x = 1; x + 2 < width; x += 2) {
+			_bayer_pixel(up, cur, dn, x, x - 1, x + 1, s1, rgb);
+			_bayer_put(d, x, rgb, format);
+			_bayer_pixel(up, cur, dn, x + 1, x, x + 2, s0, rgb);
+			_bayer_put(d, x + 1, rgb, format);
+		}
+		if (x < width - 1) {
+			_bayer_pixel(up, cur, dn, x, x - 1, x + 1, s1, rgb);
+			_bayer_put(d, x, rgb, format);
+			x++;
+		}
+		_bayer_pixel(up, cur, dn, x, x - 1, width - 2,
+				(x & 1) ? s1 : s0, rgb);
+		_bayer_put(d, x, rgb, format);
+		d += dst_stride;
+	}
+	return 0;
+}
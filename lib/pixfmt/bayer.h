@@ -0,0 +1,91 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Demosaicing of 8-bit raw Bayer images (ISC/ISI in raw mode with the 8
+ * most significant bits of the sensor data), by bilinear interpolation of
+ * the missing color components. The image borders are handled by mirroring,
+ * which keeps the color pattern.
+ */
+
+#ifndef PIXFMT_BAYER_H_
+#define PIXFMT_BAYER_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "pixfmt/pixfmt.h"
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Color pattern, given by the first two pixels of the first two rows */
+enum _pixfmt_bayer {
+	PIXFMT_BAYER_RGGB = 0,
+	PIXFMT_BAYER_GRBG = 1,
+	PIXFMT_BAYER_GBRG = 2,
+	PIXFMT_BAYER_BGGR = 3,
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Demosaic a raw Bayer image to RGB.
+ * \param src  Raw image, one byte per pixel.
+ * \param src_stride  Bytes between two rows of src.
+ * \param dst  RGB image, 16-bit aligned for RGB565, 32-bit aligned for
+ *             ARGB8888.
+ * \param dst_stride  Bytes between two rows of dst.
+ * \param width  Width of the image, in pixels (at least 2).
+ * \param height  Height of the image, in pixels (at least 2).
+ * \param pattern  Color pattern of src.
+ * \param format  Format of the RGB image.
+ * \return 0 on success, -EINVAL if a parameter is not valid.
+ */
+extern int pixfmt_bayer_to_rgb(const uint8_t* src, uint32_t src_stride,
+		void* dst, uint32_t dst_stride, uint32_t width, uint32_t height,
+		enum _pixfmt_bayer pattern, enum _pixfmt_rgb format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIXFMT_BAYER_H_ */
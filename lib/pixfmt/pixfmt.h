@@ -0,0 +1,96 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Pixel format conversion and scaling, common definitions.
+ *
+ * Images are described by a pointer to their first pixel, a stride (bytes
+ * from a row to the next one) and their size in pixels. YUV 4:2:2 packed
+ * images are YUYV (Y0 U Y1 V); planar and semiplanar images are in the
+ * layouts expected by lcdc_create_canvas_yuv_planar() and
+ * lcdc_create_canvas_yuv_semiplanar(), the semiplanar chroma plane being
+ * U V interleaved. RGB565 pixels are 16-bit words and ARGB8888 pixels
+ * 32-bit words (B, G, R, A in memory), as used by the LCDC.
+ *
+ * The kernels have a portable C implementation and, when the compiler
+ * targets NEON (__ARM_NEON: SAMA5D2 and SAMA5D4 built with
+ * -mfpu=neon-vfpv4), a variant processing 16 pixels per iteration. Both
+ * produce the same results bit for bit.
+ *
+ * The functions do not maintain the data cache: DMA buffers must be
+ * invalidated before and cleaned after the conversion by the caller.
+ */
+
+#ifndef PIXFMT_H_
+#define PIXFMT_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+/** Chroma subsampling of planar and semiplanar images */
+enum _pixfmt_chroma {
+	PIXFMT_CHROMA_422,     /**< chroma planes have the height of the image */
+	PIXFMT_CHROMA_420,     /**< chroma planes have half its height */
+};
+
+/** RGB output formats */
+enum _pixfmt_rgb {
+	PIXFMT_RGB565,
+	PIXFMT_ARGB8888,       /**< alpha is 0xff */
+};
+
+/*----------------------------------------------------------------------------
+ *        Inline functions
+ *----------------------------------------------------------------------------*/
+
+static inline uint8_t pixfmt_clamp8(int32_t x)
+{
+	return x < 0 ? 0 : (x > 255 ? 255 : (uint8_t)x);
+}
+
+static inline uint16_t pixfmt_pack565(uint8_t r, uint8_t g, uint8_t b)
+{
+	return (uint16_t)(((r & 0xf8) << 8) | ((g & 0xfc) << 3) | (b >> 3));
+}
+
+static inline uint32_t pixfmt_pack8888(uint8_t r, uint8_t g, uint8_t b)
+{
+	return 0xff000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+#endif /* PIXFMT_H_ */
@@ -0,0 +1,162 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pixfmt/scale.h"
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static bool _scale_check_size(uint32_t src_width, uint32_t src_height,
+		uint32_t dst_width, uint32_t dst_height)
+{
+	return src_width && src_height && dst_width && dst_height &&
+		src_width <= PIXFMT_SCALE_MAX_SIZE &&
+		src_height <= PIXFMT_SCALE_MAX_SIZE &&
+		dst_width <= PIXFMT_SCALE_MAX_SIZE &&
+		dst_height <= PIXFMT_SCALE_MAX_SIZE;
+}
+
+/** Source position of the first destination pixel center, 16.16 */
+static inline int32_t _scale_start(uint32_t step)
+{
+	return (int32_t)(step / 2) - 0x8000;
+}
+
+/**
+ * Split a 16.16 position in a pixel index, the index of the next pixel
+ * and an 8-bit weight for the latter, clamping at the image borders.
+ */
+static inline void _scale_tap(int32_t pos, uint32_t size, uint32_t* i0,
+		uint32_t* i1, uint32_t* w)
+{
+	if (pos <= 0) {
+		*i0 = *i1 = 0;
+		*w = 0;
+	} else if ((uint32_t)(pos >> 16) >= size - 1) {
+		*i0 = *i1 = size - 1;
+		*w = 0;
+	} else {
+		*i0 = (uint32_t)pos >> 16;
+		*i1 = *i0 + 1;
+		*w = ((uint32_t)pos >> 8) & 0xff;
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int pixfmt_scale_nearest(const void* src, uint32_t src_stride,
+		uint32_t src_width, uint32_t src_height,
+		void* dst, uint32_t dst_stride,
+		uint32_t dst_width, uint32_t dst_height, uint32_t bpp)
+{
+	uint32_t xstep, ystep, ypos, x, y;
+
+	if (!_scale_check_size(src_width, src_height, dst_width, dst_height))
+		return -EINVAL;
+	if (bpp != 1 && bpp != 2 && bpp != 4)
+		return -EINVAL;
+
+	xstep = (src_width << 16) / dst_width;
+	ystep = (src_height << 16) / dst_height;
+	ypos = ystep / 2;
+	for (y = 0; y < dst_height; y++, ypos += ystep) {
+		const uint8_t* s = (const uint8_t*)src + (ypos >> 16) * src_stride;
+		uint8_t* d = (uint8_t*)dst + y * dst_stride;
+		uint32_t xpos = xstep / 2;
+
+		switch (bpp) {
+		case 1:
+			for (x = 0; x < dst_width; x++, xpos += xstep)
+				d[x] = s[xpos >> 16];
+			break;
+		case 2:
+			for (x = 0; x < dst_width; x++, xpos += xstep)
+				((uint16_t*)d)[x] = ((const uint16_t*)s)[xpos >> 16];
+			break;
+		default:
+			for (x = 0; x < dst_width; x++, xpos += xstep)
+				((uint32_t*)d)[x] = ((const uint32_t*)s)[xpos >> 16];
+			break;
+		}
+	}
+	return 0;
+}
+
+int pixfmt_scale_bilinear(const uint8_t* src, uint32_t src_stride,
+		uint32_t src_width, uint32_t src_height,
+		uint8_t* dst, uint32_t dst_stride,
+		uint32_t dst_width, uint32_t dst_height, uint32_t channels)
+{
+	uint32_t xstep, ystep, x, y, c;
+	int32_t ypos;
+
+	if (!_scale_check_size(src_width, src_height, dst_width, dst_height))
+		return -EINVAL;
+	if (channels < 1 || channels > 4)
+		return -EINVAL;
+
+	xstep = (src_width << 16) / dst_width;
+	ystep = (src_height << 16) / dst_height;
+	ypos = _scale_start(ystep);
+	for (y = 0; y < dst_height; y++, ypos += (int32_t)ystep) {
+		const uint8_t *s0, *s1;
+		uint8_t* d = dst + y * dst_stride;
+		int32_t xpos = _scale_start(xstep);
+		uint32_t y0, y1, wy;
+
+		_scale_tap(ypos, src_height, &y0, &y1, &wy);
+		s0 = src + y0 * src_stride;
+		s1 = src + y1 * src_stride;
+		for (x = 0; x < dst_width; x++, xpos += (int32_t)xstep) {
+			uint32_t x0, x1, wx;
+
+			_scale_tap(xpos, src_width, &x0, &x1, &wx);
+			x0 *= channels;
+			x1 *= channels;
+			for (c = 0; c < channels; c++) {
+				uint32_t top = s0[x0 + c] * (256 - wx) + s0[x1 + c] * wx;
+				uint32_t bot = s1[x0 + c] * (256 - wx) + s1[x1 + c] * wx;
+
+				*d++ = (uint8_t)((top * (256 - wy) + bot * wy + 0x8000) >> 16);
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,111 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Image scaling, nearest neighbour and bilinear.
+ *
+ * Both scalers map the pixel centers, so that the image is neither shifted
+ * nor cropped, and accept any ratio. The bilinear scaler reads two by two
+ * source pixels for each output pixel: beyond a 2:1 downscale some source
+ * pixels are skipped and small details alias.
+ *
+ * YUYV images can be scaled by the nearest neighbour scaler on their
+ * macropixels (4 bytes, half the width), or converted to planar and scaled
+ * plane by plane with the bilinear scaler.
+ */
+
+#ifndef PIXFMT_SCALE_H_
+#define PIXFMT_SCALE_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Largest width or height accepted by the scalers */
+#define PIXFMT_SCALE_MAX_SIZE 32767
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Scale an image by picking the nearest source pixel.
+ * \param src  Source image.
+ * \param src_stride  Bytes between two rows of src.
+ * \param src_width  Width of src, in pixels.
+ * \param src_height  Height of src, in pixels.
+ * \param dst  Scaled image.
+ * \param dst_stride  Bytes between two rows of dst.
+ * \param dst_width  Width of dst, in pixels.
+ * \param dst_height  Height of dst, in pixels.
+ * \param bpp  Bytes per pixel: 1, 2 or 4, the images being aligned
+ *             accordingly.
+ * \return 0 on success, -EINVAL if a parameter is not valid.
+ */
+extern int pixfmt_scale_nearest(const void* src, uint32_t src_stride,
+		uint32_t src_width, uint32_t src_height,
+		void* dst, uint32_t dst_stride,
+		uint32_t dst_width, uint32_t dst_height, uint32_t bpp);
+
+/**
+ * \brief Scale an image by bilinear interpolation.
+ * \param src  Source image.
+ * \param src_stride  Bytes between two rows of src.
+ * \param src_width  Width of src, in pixels.
+ * \param src_height  Height of src, in pixels.
+ * \param dst  Scaled image.
+ * \param dst_stride  Bytes between two rows of dst.
+ * \param dst_width  Width of dst, in pixels.
+ * \param dst_height  Height of dst, in pixels.
+ * \param channels  8-bit channels per pixel, interpolated independently:
+ *                  1 for a plane, 4 for ARGB8888, up to 4.
+ * \return 0 on success, -EINVAL if a parameter is not valid.
+ */
+extern int pixfmt_scale_bilinear(const uint8_t* src, uint32_t src_stride,
+		uint32_t src_width, uint32_t src_height,
+		uint8_t* dst, uint32_t dst_stride,
+		uint32_t dst_width, uint32_t dst_height, uint32_t channels);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIXFMT_SCALE_H_ */
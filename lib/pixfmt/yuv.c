@@ -0,0 +1,405 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#include "pixfmt/pixfmt.h"
+#include "pixfmt/yuv.h"
+
+/*----------------------------------------------------------------------------
+ *        Local definitions
+ *----------------------------------------------------------------------------*/
+
+/* BT.601 video range coefficients, 6 fractional bits. The luma gain
+ * (1.164 * 64 = 74.5) is applied as (Y * 149) / 2 to keep its half LSB. */
+#define YUV_Y_GAIN2   149
+#define YUV_Y_OFFSET  1192      /* 16 * 74.5 */
+#define YUV_RV        102       /* 1.596 */
+#define YUV_GU        25        /* 0.392 */
+#define YUV_GV        52        /* 0.813 */
+#define YUV_BU        129       /* 2.017 */
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static int _yuv_check_size(uint32_t width, uint32_t height,
+		enum _pixfmt_chroma chroma)
+{
+	if (width == 0 || (width & 1) || height == 0)
+		return -EINVAL;
+	if (chroma == PIXFMT_CHROMA_420 && (height & 1))
+		return -EINVAL;
+	if (chroma != PIXFMT_CHROMA_422 && chroma != PIXFMT_CHROMA_420)
+		return -EINVAL;
+	return 0;
+}
+
+/** Saturate to 16 bits like the NEON saturating additions */
+static inline int32_t _yuv_sat16(int32_t x)
+{
+	return x < INT16_MIN ? INT16_MIN : (x > INT16_MAX ? INT16_MAX : x);
+}
+
+/** Rounding narrowing shift, as vqrshrun_n_s16(x, 6) */
+static inline uint8_t _yuv_narrow(int32_t x)
+{
+	return pixfmt_clamp8((x + 32) >> 6);
+}
+
+/**
+ * Split one YUYV row, or two rows for 4:2:0 (s1 and y1 not NULL, chroma
+ * averaged). If v is NULL, u is the interleaved chroma row of a semiplanar
+ * image.
+ */
+static void _yuyv_split(const uint8_t* s0, const uint8_t* s1,
+		uint8_t* y0, uint8_t* y1, uint8_t* u, uint8_t* v, uint32_t pairs)
+{
+#ifdef __ARM_NEON
+	for (; pairs >= 8; pairs -= 8) {
+		uint8x8x4_t a = vld4_u8(s0);
+		uint8x8x2_t ya = {{ a.val[0], a.val[2] }};
+		uint8x8_t cu = a.val[1];
+		uint8x8_t cv = a.val[3];
+
+		vst2_u8(y0, ya);
+		s0 += 32;
+		y0 += 16;
+		if (s1) {
+			uint8x8x4_t b = vld4_u8(s1);
+			uint8x8x2_t yb = {{ b.val[0], b.val[2] }};
+
+			vst2_u8(y1, yb);
+			cu = vrhadd_u8(cu, b.val[1]);
+			cv = vrhadd_u8(cv, b.val[3]);
+			s1 += 32;
+			y1 += 16;
+		}
+		if (v) {
+			vst1_u8(u, cu);
+			vst1_u8(v, cv);
+			u += 8;
+			v += 8;
+		} else {
+			uint8x8x2_t c = {{ cu, cv }};
+
+			vst2_u8(u, c);
+			u += 16;
+		}
+	}
+#endif
+	for (; pairs; pairs--) {
+		uint8_t cu = s0[1];
+		uint8_t cv = s0[3];
+
+		y0[0] = s0[0];
+		y0[1] = s0[2];
+		s0 += 4;
+		y0 += 2;
+		if (s1) {
+			y1[0] = s1[0];
+			y1[1] = s1[2];
+			cu = (uint8_t)((cu + s1[1] + 1) >> 1);
+			cv = (uint8_t)((cv + s1[3] + 1) >> 1);
+			s1 += 4;
+			y1 += 2;
+		}
+		if (v) {
+			*u++ = cu;
+			*v++ = cv;
+		} else {
+			u[0] = cu;
+			u[1] = cv;
+			u += 2;
+		}
+	}
+}
+
+/** Merge a YUYV row. If v is NULL, u is an interleaved chroma row. */
+static void _yuyv_merge(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+		uint8_t* d, uint32_t pairs)
+{
+#ifdef __ARM_NEON
+	for (; pairs >= 8; pairs -= 8) {
+		uint8x8x2_t l = vld2_u8(y);
+		uint8x8x4_t o;
+
+		o.val[0] = l.val[0];
+		o.val[2] = l.val[1];
+		if (v) {
+			o.val[1] = vld1_u8(u);
+			o.val[3] = vld1_u8(v);
+			u += 8;
+			v += 8;
+		} else {
+			uint8x8x2_t c = vld2_u8(u);
+
+			o.val[1] = c.val[0];
+			o.val[3] = c.val[1];
+			u += 16;
+		}
+		vst4_u8(d, o);
+		y += 16;
+		d += 32;
+	}
+#endif
+	for (; pairs; pairs--) {
+		d[0] = y[0];
+		d[2] = y[1];
+		if (v) {
+			d[1] = *u++;
+			d[3] = *v++;
+		} else {
+			d[1] = u[0];
+			d[3] = u[1];
+			u += 2;
+		}
+		y += 2;
+		d += 4;
+	}
+}
+
+#ifdef __ARM_NEON
+static inline void _yuv_rgb_neon(uint8x8_t y8, int16x8_t rv, int16x8_t gc,
+		int16x8_t bu, uint8x8_t* r, uint8x8_t* g, uint8x8_t* b)
+{
+	uint16x8_t t = vshrq_n_u16(vmull_u8(y8, vdup_n_u8(YUV_Y_GAIN2)), 1);
+	int16x8_t y = vsubq_s16(vreinterpretq_s16_u16(t),
+			vdupq_n_s16(YUV_Y_OFFSET));
+
+	*r = vqrshrun_n_s16(vqaddq_s16(y, rv), 6);
+	*g = vqrshrun_n_s16(vqsubq_s16(y, gc), 6);
+	*b = vqrshrun_n_s16(vqaddq_s16(y, bu), 6);
+}
+#endif
+
+static void _yuyv_to_rgb_row(const uint8_t* s, void* dst, uint32_t pairs,
+		enum _pixfmt_rgb format)
+{
+	uint16_t* d16 = (uint16_t*)dst;
+	uint32_t* d32 = (uint32_t*)dst;
+
+#ifdef __ARM_NEON
+	for (; pairs >= 8; pairs -= 8) {
+		uint8x8x4_t a = vld4_u8(s);
+		int16x8_t cu = vreinterpretq_s16_u16(vsubl_u8(a.val[1],
+					vdup_n_u8(128)));
+		int16x8_t cv = vreinterpretq_s16_u16(vsubl_u8(a.val[3],
+					vdup_n_u8(128)));
+		int16x8_t rv = vmulq_n_s16(cv, YUV_RV);
+		int16x8_t gc = vmlaq_n_s16(vmulq_n_s16(cu, YUV_GU), cv, YUV_GV);
+		int16x8_t bu = vmulq_n_s16(cu, YUV_BU);
+		uint8x8_t r0, g0, b0, r1, g1, b1;
+		uint8x8x2_t r, g, b;
+		int i;
+
+		_yuv_rgb_neon(a.val[0], rv, gc, bu, &r0, &g0, &b0);
+		_yuv_rgb_neon(a.val[2], rv, gc, bu, &r1, &g1, &b1);
+		r = vzip_u8(r0, r1);
+		g = vzip_u8(g0, g1);
+		b = vzip_u8(b0, b1);
+		for (i = 0; i < 2; i++) {
+			if (format == PIXFMT_RGB565) {
+				uint16x8_t p = vshll_n_u8(r.val[i], 8);
+
+				p = vsriq_n_u16(p, vshll_n_u8(g.val[i], 8), 5);
+				p = vsriq_n_u16(p, vshll_n_u8(b.val[i], 8), 11);
+				vst1q_u16(d16, p);
+				d16 += 8;
+			} else {
+				uint8x8x4_t p = {{ b.val[i], g.val[i], r.val[i],
+						vdup_n_u8(0xff) }};
+
+				vst4_u8((uint8_t*)d32, p);
+				d32 += 8;
+			}
+		}
+		s += 32;
+	}
+#endif
+	for (; pairs; pairs--) {
+		int32_t cu = s[1] - 128;
+		int32_t cv = s[3] - 128;
+		int32_t rv = cv * YUV_RV;
+		int32_t gc = cu * YUV_GU + cv * YUV_GV;
+		int32_t bu = cu * YUV_BU;
+		int i;
+
+		for (i = 0; i < 4; i += 2) {
+			int32_t y = ((s[i] * YUV_Y_GAIN2) >> 1) - YUV_Y_OFFSET;
+			uint8_t r = _yuv_narrow(_yuv_sat16(y + rv));
+			uint8_t g = _yuv_narrow(_yuv_sat16(y - gc));
+			uint8_t b = _yuv_narrow(_yuv_sat16(y + bu));
+
+			if (format == PIXFMT_RGB565)
+				*d16++ = pixfmt_pack565(r, g, b);
+			else
+				*d32++ = pixfmt_pack8888(r, g, b);
+		}
+		s += 4;
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int pixfmt_yuyv_to_planar(const uint8_t* src, uint32_t src_stride,
+		uint8_t* y, uint8_t* u, uint8_t* v,
+		uint32_t y_stride, uint32_t c_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_chroma chroma)
+{
+	uint32_t row;
+	int err;
+
+	err = _yuv_check_size(width, height, chroma);
+	if (err < 0)
+		return err;
+	if (chroma == PIXFMT_CHROMA_422) {
+		for (row = 0; row < height; row++) {
+			_yuyv_split(src, NULL, y, NULL, u, v, width / 2);
+			src += src_stride;
+			y += y_stride;
+			u += c_stride;
+			v += c_stride;
+		}
+	} else {
+		for (row = 0; row < height; row += 2) {
+			_yuyv_split(src, src + src_stride, y, y + y_stride,
+					u, v, width / 2);
+			src += 2 * src_stride;
+			y += 2 * y_stride;
+			u += c_stride;
+			v += c_stride;
+		}
+	}
+	return 0;
+}
+
+int pixfmt_yuyv_to_semiplanar(const uint8_t* src, uint32_t src_stride,
+		uint8_t* y, uint8_t* uv, uint32_t y_stride, uint32_t c_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_chroma chroma)
+{
+	uint32_t row;
+	int err;
+
+	err = _yuv_check_size(width, height, chroma);
+	if (err < 0)
+		return err;
+	if (chroma == PIXFMT_CHROMA_422) {
+		for (row = 0; row < height; row++) {
+			_yuyv_split(src, NULL, y, NULL, uv, NULL, width / 2);
+			src += src_stride;
+			y += y_stride;
+			uv += c_stride;
+		}
+	} else {
+		for (row = 0; row < height; row += 2) {
+			_yuyv_split(src, src + src_stride, y, y + y_stride,
+					uv, NULL, width / 2);
+			src += 2 * src_stride;
+			y += 2 * y_stride;
+			uv += c_stride;
+		}
+	}
+	return 0;
+}
+
+int pixfmt_planar_to_yuyv(const uint8_t* y, const uint8_t* u,
+		const uint8_t* v, uint32_t y_stride, uint32_t c_stride,
+		uint8_t* dst, uint32_t dst_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_chroma chroma)
+{
+	uint32_t row;
+	int err;
+
+	err = _yuv_check_size(width, height, chroma);
+	if (err < 0)
+		return err;
+	for (row = 0; row < height; row++) {
+		uint32_t c = (chroma == PIXFMT_CHROMA_420 ? row / 2 : row) * c_stride;
+
+		_yuyv_merge(y, u + c, v + c, dst, width / 2);
+		y += y_stride;
+		dst += dst_stride;
+	}
+	return 0;
+}
+
+int pixfmt_semiplanar_to_yuyv(const uint8_t* y, const uint8_t* uv,
+		uint32_t y_stride, uint32_t c_stride,
+		uint8_t* dst, uint32_t dst_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_chroma chroma)
+{
+	uint32_t row;
+	int err;
+
+	err = _yuv_check_size(width, height, chroma);
+	if (err < 0)
+		return err;
+	for (row = 0; row < height; row++) {
+		uint32_t c = (chroma == PIXFMT_CHROMA_420 ? row / 2 : row) * c_stride;
+
+		_yuyv_merge(y, uv + c, NULL, dst, width / 2);
+		y += y_stride;
+		dst += dst_stride;
+	}
+	return 0;
+}
+
+int pixfmt_yuyv_to_rgb(const uint8_t* src, uint32_t src_stride,
+		void* dst, uint32_t dst_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_rgb format)
+{
+	uint8_t* d = (uint8_t*)dst;
+	uint32_t row;
+	int err;
+
+	err = _yuv_check_size(width, height, PIXFMT_CHROMA_422);
+	if (err < 0)
+		return err;
+	if (format != PIXFMT_RGB565 && format != PIXFMT_ARGB8888)
+		return -EINVAL;
+	for (row = 0; row < height; row++) {
+		_yuyv_to_rgb_row(src, d, width / 2, format);
+		src += src_stride;
+		d += dst_stride;
+	}
+	return 0;
+}
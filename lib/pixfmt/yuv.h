@@ -0,0 +1,158 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * YUV 4:2:2 packed (YUYV) conversions to and from planar and semiplanar
+ * layouts, and to RGB.
+ *
+ * Widths must be even. For 4:2:0 layouts the heights must be even too:
+ * going to 4:2:0 the chroma of two rows is averaged, coming from 4:2:0 each
+ * chroma row is used for two rows.
+ *
+ * The RGB conversion uses the ITU-R BT.601 matrix on video range data
+ * (Y 16..235, Cb/Cr 16..240, as output by the image sensors), with 6
+ * fractional bits coefficients; results are within one LSB of the exact
+ * conversion.
+ */
+
+#ifndef PIXFMT_YUV_H_
+#define PIXFMT_YUV_H_
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdint.h>
+
+#include "pixfmt/pixfmt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Convert a YUYV image to planar YUV.
+ * \param src  YUYV image.
+ * \param src_stride  Bytes between two rows of src.
+ * \param y  Luma plane.
+ * \param u  Cb plane.
+ * \param v  Cr plane.
+ * \param y_stride  Bytes between two rows of the luma plane.
+ * \param c_stride  Bytes between two rows of the chroma planes.
+ * \param width  Width of the image, in pixels.
+ * \param height  Height of the image, in pixels.
+ * \param chroma  Subsampling of the planar image.
+ * \return 0 on success, -EINVAL if the size is not valid.
+ */
+extern int pixfmt_yuyv_to_planar(const uint8_t* src, uint32_t src_stride,
+		uint8_t* y, uint8_t* u, uint8_t* v,
+		uint32_t y_stride, uint32_t c_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_chroma chroma);
+
+/**
+ * \brief Convert a YUYV image to semiplanar YUV.
+ * \param src  YUYV image.
+ * \param src_stride  Bytes between two rows of src.
+ * \param y  Luma plane.
+ * \param uv  Interleaved Cb Cr plane.
+ * \param y_stride  Bytes between two rows of the luma plane.
+ * \param c_stride  Bytes between two rows of the chroma plane.
+ * \param width  Width of the image, in pixels.
+ * \param height  Height of the image, in pixels.
+ * \param chroma  Subsampling of the semiplanar image.
+ * \return 0 on success, -EINVAL if the size is not valid.
+ */
+extern int pixfmt_yuyv_to_semiplanar(const uint8_t* src, uint32_t src_stride,
+		uint8_t* y, uint8_t* uv, uint32_t y_stride, uint32_t c_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_chroma chroma);
+
+/**
+ * \brief Convert a planar YUV image to YUYV.
+ * \param y  Luma plane.
+ * \param u  Cb plane.
+ * \param v  Cr plane.
+ * \param y_stride  Bytes between two rows of the luma plane.
+ * \param c_stride  Bytes between two rows of the chroma planes.
+ * \param dst  YUYV image.
+ * \param dst_stride  Bytes between two rows of dst.
+ * \param width  Width of the image, in pixels.
+ * \param height  Height of the image, in pixels.
+ * \param chroma  Subsampling of the planar image.
+ * \return 0 on success, -EINVAL if the size is not valid.
+ */
+extern int pixfmt_planar_to_yuyv(const uint8_t* y, const uint8_t* u,
+		const uint8_t* v, uint32_t y_stride, uint32_t c_stride,
+		uint8_t* dst, uint32_t dst_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_chroma chroma);
+
+/**
+ * \brief Convert a semiplanar YUV image to YUYV.
+ * \param y  Luma plane.
+ * \param uv  Interleaved Cb Cr plane.
+ * \param y_stride  Bytes between two rows of the luma plane.
+ * \param c_stride  Bytes between two rows of the chroma plane.
+ * \param dst  YUYV image.
+ * \param dst_stride  Bytes between two rows of dst.
+ * \param width  Width of the image, in pixels.
+ * \param height  Height of the image, in pixels.
+ * \param chroma  Subsampling of the semiplanar image.
+ * \return 0 on success, -EINVAL if the size is not valid.
+ */
+extern int pixfmt_semiplanar_to_yuyv(const uint8_t* y, const uint8_t* uv,
+		uint32_t y_stride, uint32_t c_stride,
+		uint8_t* dst, uint32_t dst_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_chroma chroma);
+
+/**
+ * \brief Convert a YUYV image to RGB.
+ * \param src  YUYV image.
+ * \param src_stride  Bytes between two rows of src.
+ * \param dst  RGB image, 16-bit aligned for RGB565, 32-bit aligned for
+ *             ARGB8888.
+ * \param dst_stride  Bytes between two rows of dst.
+ * \param width  Width of the image, in pixels.
+ * \param height  Height of the image, in pixels.
+ * \param format  Format of the RGB image.
+ * \return 0 on success, -EINVAL if the size or format is not valid.
+ */
+extern int pixfmt_yuyv_to_rgb(const uint8_t* src, uint32_t src_stride,
+		void* dst, uint32_t dst_stride,
+		uint32_t width, uint32_t height, enum _pixfmt_rgb format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PIXFMT_YUV_H_ */
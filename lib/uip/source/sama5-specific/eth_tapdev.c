@@ -42,6 +42,34 @@
 
 #include "eth_tapdev.h"
 
+#if ETH_TX_UNITSIZE < (UIP_BUFSIZE + 2)
+#error uip_buf does not fit in a TX buffer
+#endif
+
+/*----------------------------------------------------------------------------
+ *        Variables
+ *----------------------------------------------------------------------------*/
+
+/** Used as uip_buf when the TX queue is full */
+static u8_t _tapdev_buf[UIP_BUFSIZE + 2];
+
+u8_t *uip_buf = _tapdev_buf;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * Point uip_buf to the buffer of the next free TX descriptor, so that the
+ * frame built there by uIP is sent without copy.
+ */
+static void _tapdev_get_buffer(u8_t iface)
+{
+	u8_t *buf = ethd_get_tx_buffer(board_get_eth(iface), 0);
+
+	uip_buf = buf ? buf : _tapdev_buf;
+}
+
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -49,7 +77,12 @@
 uint32_t eth_tapdev_read(u8_t iface)
 {
 	uint32_t pkt_len = 0;
-	uint8_t rc = ethd_poll(board_get_eth(iface), 0, (uint8_t*)uip_buf, UIP_CONF_BUFFER_SIZE, &pkt_len);
+	uint8_t rc;
+
+	/* The received frame is copied once from the RX descriptors to the
+	 * TX buffer, where uIP builds the reply in place */
+	_tapdev_get_buffer(iface);
+	rc = ethd_poll(board_get_eth(iface), 0, uip_buf, UIP_CONF_BUFFER_SIZE, &pkt_len);
 	if (rc != ETH_OK)
 		return 0;
 	return pkt_len;
@@ -60,4 +93,7 @@ void eth_tapdev_send(u8_t iface)
 	uint8_t rc = ethd_send(board_get_eth(iface), 0, (void*)uip_buf, uip_len, NULL);
 	if (rc != ETH_OK)
 		trace_error("E: Send, rc 0x%x\n\r", rc);
+
+	/* The TX buffer now belongs to the ETH, use the next one */
+	_tapdev_get_buffer(iface);
 }
@@ -34,6 +34,9 @@
 
 /**
  * Read from ETH device.
+ * uip_buf is pointed to the buffer of the next free TX descriptor, which
+ * also holds the received frame: replies and frames generated by the
+ * periodic functions are then sent by eth_tapdev_send() without copy.
  * \param iface Interface index
  * \return packet length, 0 if error
  */
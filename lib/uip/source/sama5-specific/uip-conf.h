@@ -104,6 +104,14 @@ typedef unsigned short uip_stats_t;
  * \hideinitializer
  */
 #define UIP_CONF_BUFFER_SIZE     1500
+
+/**
+ * uip_buf is maintained by eth_tapdev and points to the buffer of a free
+ * TX descriptor, so that frames are sent without copy.
+ *
+ * \hideinitializer
+ */
+#define UIP_CONF_EXTERNAL_BUFFER
 /**
  * CPU byte order.
  *
@@ -418,8 +418,16 @@ void uip_setipid(u16_t id);
     }
  }
  \endcode
+ *
+ * When UIP_CONF_EXTERNAL_BUFFER is defined, uip_buf is a pointer
+ * defined and maintained by the device driver, which must point to
+ * at least UIP_BUFSIZE + 2 bytes.
  */
+#ifdef UIP_CONF_EXTERNAL_BUFFER
+extern u8_t *uip_buf;
+#else
 extern u8_t uip_buf[UIP_BUFSIZE+2];
+#endif /* UIP_CONF_EXTERNAL_BUFFER */
 
 /** @} */
 
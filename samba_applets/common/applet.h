@@ -44,6 +44,12 @@
 #define APPLET_CMD_WRITE_PAGES       0x33 /* Write pages */
 #define APPLET_CMD_READ_BOOTCFG      0x34 /* Read Boot Config */
 #define APPLET_CMD_WRITE_BOOTCFG     0x35 /* Write Boot Config */
+#define APPLET_CMD_INIT_SLOTS        0x36 /* Split buffer into slots */
+#define APPLET_CMD_RUN_SLOTS         0x37 /* Process slot requests */
+#define APPLET_CMD_HASH_PAGES        0x38 /* Hash pages */
+#define APPLET_CMD_UPDATE_PAGES      0x39 /* Write pages that changed */
+#define APPLET_CMD_WRITE_STREAM      0x3A /* Write sparse/LZ4/raw image stream */
+#define APPLET_CMD_PROGRAM_BLOCKS    0x3B /* Erase and program whole blocks */
 
 #define APPLET_SUCCESS               0x00 /* Operation was successful */
 #define APPLET_DEV_UNKNOWN           0x01 /* Device unknown */
@@ -58,6 +64,34 @@
 #define APPLET_PMECC_CONFIG          0x0A /* ECC configure failure */
 #define APPLET_FAIL                  0x0F /* Generic/Unknown failure */
 
+/* Slot status words, requests written by the host */
+#define APPLET_SLOT_FREE             0x00 /* Slot can be filled by the host */
+#define APPLET_SLOT_WRITE            0x01 /* Write slot data to the media */
+#define APPLET_SLOT_READ             0x02 /* Read media into the slot */
+#define APPLET_SLOT_STOP             0x03 /* Leave 'run slots' */
+
+/* Slot status words, states written by the applet */
+#define APPLET_SLOT_BUSY             0x10 /* Request in progress */
+#define APPLET_SLOT_DONE             0x11 /* Request completed successfully */
+#define APPLET_SLOT_ERROR            0x12 /* Request failed, see 'error' */
+
+/* Hash algorithms */
+#define APPLET_HASH_CRC32            0x00 /* CRC-32 (IEEE 802.3) */
+#define APPLET_HASH_SHA256           0x01 /* SHA-256 */
+
+/* Write stream flags */
+#define APPLET_STREAM_START          0x01 /* First command of a stream */
+#define APPLET_STREAM_END            0x02 /* Last command of a stream */
+
+/* Program blocks flags */
+#define APPLET_PROGRAM_START         0x01 /* First command of a sequence */
+#define APPLET_PROGRAM_END           0x02 /* Last command of a sequence */
+#define APPLET_PROGRAM_STRICT        0x04 /* Fail on bad blocks instead of skipping them */
+#define APPLET_PROGRAM_NO_CACHE      0x08 /* Do not use cache program */
+
+/* Maximum number of slots */
+#define APPLET_MAX_SLOTS             4
+
 /* Communication link identification */
 #define COMM_TYPE_USB                0x00
 #define COMM_TYPE_DBGU               0x01
@@ -148,6 +182,176 @@ union read_write_erase_pages_mailbox {
 	} out;
 };
 
+/** Mailbox content for the 'initialize slots' command. */
+union init_slots_mailbox {
+	struct {
+		/** Number of slots (2 to APPLET_MAX_SLOTS) */
+		uint32_t count;
+	} in;
+
+	struct {
+		/** Slot table address (array of struct applet_slot) */
+		uint32_t table_addr;
+		/** Number of slots */
+		uint32_t count;
+		/** Slot size (in pages) */
+		uint32_t slot_pages;
+		/** Slot data addresses */
+		uint32_t slot_addr[APPLET_MAX_SLOTS];
+	} out;
+};
+
+/** Mailbox content for the 'run slots' command. */
+union run_slots_mailbox {
+	struct {
+		/** Requests to process before returning, 0 to run until a
+		 * 'stop' request */
+		uint32_t count;
+		/** Maximum wait for a request (in ms), 0 to wait forever */
+		uint32_t timeout;
+	} in;
+
+	struct {
+		/** Requests processed */
+		uint32_t count;
+		/** Pages read/written */
+		uint32_t pages;
+		/** Index of the next slot the applet will look at */
+		uint32_t next;
+	} out;
+};
+
+/** Mailbox content for the 'hash pages' command. */
+union hash_pages_mailbox {
+	struct {
+		/** Hash offset (in pages) */
+		uint32_t offset;
+		/** Hash length (in pages) */
+		uint32_t length;
+		/** Hash algorithm (APPLET_HASH_xxx) */
+		uint32_t algo;
+		/** Pages per hash, 0 to hash the whole range. Otherwise one
+		 * hash per block is stored at the start of the buffer (4 bytes
+		 * for CRC-32, 32 bytes for SHA-256). */
+		uint32_t block;
+	} in;
+
+	struct {
+		/** Pages hashed */
+		uint32_t pages;
+		/** Number of hashes */
+		uint32_t count;
+		/** Hash of the whole range: CRC-32 value in the first word,
+		 * or SHA-256 digest bytes */
+		uint32_t hash[8];
+	} out;
+};
+
+/** Mailbox content for the 'update pages' command. */
+union update_pages_mailbox {
+	struct {
+		/** Write offset (in pages), aligned on the erase size */
+		uint32_t offset;
+		/** Write length (in pages), multiple of the erase size */
+		uint32_t length;
+	} in;
+
+	struct {
+		/** Pages erased and written */
+		uint32_t pages;
+		/** Pages left untouched because identical */
+		uint32_t skipped;
+	} out;
+};
+
+/**
+ * Mailbox content for the 'write stream' command.
+ *
+ * On media that support erase, the stream erases each smallest erase unit
+ * the first time it enters it, including the whole last unit. Whole pages
+ * of sparse 0xFFFFFFFF fills are then only erased. Units entirely covered
+ * by "don't care" sparse chunks are neither erased nor written.
+ */
+union write_stream_mailbox {
+	struct {
+		/** Stream flags (APPLET_STREAM_xxx) */
+		uint32_t flags;
+		/** Write offset (in pages), with APPLET_STREAM_START only,
+		 * aligned on the smallest erase size */
+		uint32_t offset;
+		/** Stream data length at the start of the buffer (in bytes),
+		 * any value up to out.buf_size */
+		uint32_t length;
+	} in;
+
+	struct {
+		/** Maximum stream data length per command (in bytes) */
+		uint32_t buf_size;
+		/** Pages written since the start of the stream */
+		uint32_t pages;
+		/** Pages erased since the start of the stream */
+		uint32_t erased;
+		/** Offset of the first page not written yet (in pages) */
+		uint32_t next;
+	} out;
+};
+
+/** Mailbox content for the 'program blocks' command. */
+union program_blocks_mailbox {
+	struct {
+		/** Flags (APPLET_PROGRAM_xxx) */
+		uint32_t flags;
+		/** First block (in pages), with APPLET_PROGRAM_START only */
+		uint32_t offset;
+		/** Data length at the start of the buffer (in pages), a
+		 * multiple of the block size except with APPLET_PROGRAM_END */
+		uint32_t length;
+		/** End of the partition (in pages), 0 for the end of the
+		 * device, with APPLET_PROGRAM_START only */
+		uint32_t limit;
+	} in;
+
+	struct {
+		/** Pages written by this command */
+		uint32_t pages;
+		/** Blocks written since the start of the sequence */
+		uint32_t blocks;
+		/** Bad blocks skipped since the start of the sequence */
+		uint32_t skipped;
+		/** Next physical block (in pages) */
+		uint32_t next;
+		/** At the end of the sequence (or on error): number of map
+		 * entries at the start of the buffer. Entry N is the physical
+		 * offset (in pages) of the Nth block written. */
+		uint32_t map_count;
+	} out;
+};
+
+/**
+ * \brief Slot descriptor, shared between the host and the applet.
+ *
+ * The applet processes the slots in ring order: while it works on slot N
+ * (status BUSY), a host able to access the target memory during the applet
+ * execution (e.g. through JTAG) fills slot N+1 and posts its request.
+ * A request can be posted on a FREE, DONE or ERROR slot only.
+ */
+struct applet_slot {
+	volatile uint32_t status; /* APPLET_SLOT_xxx */
+	uint32_t offset;          /* Read/Write offset (in pages) */
+	uint32_t length;          /* Read/Write length (in pages) */
+	uint32_t pages;           /* Pages read/written */
+	uint32_t error;           /* APPLET_xxx status of a failed request */
+	uint32_t reserved[3];
+};
+
+/** Media accesses used by the generic commands, implemented by each applet. */
+struct applet_media_ops {
+	uint32_t (*read)(uint8_t *buf, uint32_t offset, uint32_t length,
+			uint32_t *pages);
+	uint32_t (*write)(uint8_t *buf, uint32_t offset, uint32_t length,
+			uint32_t *pages);
+};
+
 typedef uint32_t (*applet_command_handler_t)(uint32_t cmd, uint32_t *args);
 
 struct applet_command
@@ -161,10 +365,24 @@ extern uint32_t applet_buffer_size;
 
 extern const struct applet_command applet_commands[];
 
+extern const struct applet_media_ops applet_media_ops;
+
 extern bool applet_set_init_params(union initialize_mailbox* mbx);
 
 extern applet_command_handler_t get_applet_command_handler(uint8_t cmd);
 
+extern bool applet_get_info(union initialize_mailbox* info);
+
 extern void applet_main(void);
 
+extern uint32_t applet_handle_cmd_init_slots(uint32_t cmd, uint32_t *args);
+
+extern uint32_t applet_handle_cmd_run_slots(uint32_t cmd, uint32_t *args);
+
+extern uint32_t applet_handle_cmd_hash_pages(uint32_t cmd, uint32_t *args);
+
+extern uint32_t applet_handle_cmd_update_pages(uint32_t cmd, uint32_t *args);
+
+extern uint32_t applet_handle_cmd_write_stream(uint32_t cmd, uint32_t *args);
+
 #endif /* _APPLET_H_ */
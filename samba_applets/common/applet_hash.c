@@ -0,0 +1,470 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "applet.h"
+#include "compiler.h"
+#include "crc32.h"
+#include "intmath.h"
+#include "trace.h"
+
+#ifdef CONFIG_HAVE_SHA
+#include "crypto/shad.h"
+#endif
+
+#include <assert.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define SHA256_SIZE 32
+
+struct hash_ctx {
+	uint32_t algo;
+	uint32_t crc;
+#ifndef CONFIG_HAVE_SHA
+	uint32_t state[8];
+	uint32_t length;
+	uint32_t used;
+	uint8_t block[64];
+#endif
+};
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+#ifdef CONFIG_HAVE_SHA
+static struct _shad_desc shad;
+static bool shad_initialized;
+#else
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+#endif
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+#ifndef CONFIG_HAVE_SHA
+
+/* software SHA-256, for the devices without SHA peripheral */
+
+#define ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_block(uint32_t *state, const uint8_t *data)
+{
+	uint32_t w[64], s[8];
+	int i;
+
+	for (i = 0; i < 16; i++)
+		w[i] = ((uint32_t)data[4 * i] << 24) | (data[4 * i + 1] << 16) |
+			(data[4 * i + 2] << 8) | data[4 * i + 3];
+	for (i = 16; i < 64; i++) {
+		uint32_t s0 = ROR(w[i - 15], 7) ^ ROR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		uint32_t s1 = ROR(w[i - 2], 17) ^ ROR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	memcpy(s, state, sizeof(s));
+	for (i = 0; i < 64; i++) {
+		uint32_t t1 = s[7] + (ROR(s[4], 6) ^ ROR(s[4], 11) ^ ROR(s[4], 25)) +
+			((s[4] & s[5]) ^ (~s[4] & s[6])) + sha256_k[i] + w[i];
+		uint32_t t2 = (ROR(s[0], 2) ^ ROR(s[0], 13) ^ ROR(s[0], 22)) +
+			((s[0] & s[1]) ^ (s[0] & s[2]) ^ (s[1] & s[2]));
+		memmove(&s[1], &s[0], 7 * sizeof(uint32_t));
+		s[4] += t1;
+		s[0] = t1 + t2;
+	}
+	for (i = 0; i < 8; i++)
+		state[i] += s[i];
+}
+
+static void sha256_update(struct hash_ctx *ctx, const uint8_t *data,
+		uint32_t len)
+{
+	ctx->length += len;
+	while (len) {
+		uint32_t n = min_u32(len, 64 - ctx->used);
+
+		memcpy(&ctx->block[ctx->used], data, n);
+		ctx->used += n;
+		data += n;
+		len -= n;
+		if (ctx->used == 64) {
+			sha256_block(ctx->state, ctx->block);
+			ctx->used = 0;
+		}
+	}
+}
+
+static void sha256_finish(struct hash_ctx *ctx, uint8_t *digest)
+{
+	uint32_t bits = ctx->length << 3;
+	uint8_t pad[72];
+	uint32_t pad_len = (ctx->used < 56 ? 56 : 120) - ctx->used;
+	int i;
+
+	memset(pad, 0, sizeof(pad));
+	pad[0] = 0x80;
+	pad[pad_len + 3] = ctx->length >> 29;
+	pad[pad_len + 4] = bits >> 24;
+	pad[pad_len + 5] = bits >> 16;
+	pad[pad_len + 6] = bits >> 8;
+	pad[pad_len + 7] = bits;
+	sha256_update(ctx, pad, pad_len + 8);
+
+	for (i = 0; i < 8; i++) {
+		digest[4 * i] = ctx->state[i] >> 24;
+		digest[4 * i + 1] = ctx->state[i] >> 16;
+		digest[4 * i + 2] = ctx->state[i] >> 8;
+		digest[4 * i + 3] = ctx->state[i];
+	}
+}
+
+#endif /* !CONFIG_HAVE_SHA */
+
+static uint32_t hash_size(uint32_t algo)
+{
+	return algo == APPLET_HASH_SHA256 ? SHA256_SIZE : sizeof(uint32_t);
+}
+
+static void hash_start(struct hash_ctx *ctx, uint32_t algo)
+{
+	ctx->algo = algo;
+	ctx->crc = 0;
+	if (algo != APPLET_HASH_SHA256)
+		return;
+#ifdef CONFIG_HAVE_SHA
+	if (!shad_initialized) {
+		shad_init(&shad);
+		shad_initialized = true;
+	}
+	shad.cfg.transfer_mode = SHAD_TRANS_POLLING;
+	shad.cfg.algo = ALGO_SHA_256;
+	shad_start(&shad);
+#else
+	ctx->state[0] = 0x6a09e667;
+	ctx->state[1] = 0xbb67ae85;
+	ctx->state[2] = 0x3c6ef372;
+	ctx->state[3] = 0xa54ff53a;
+	ctx->state[4] = 0x510e527f;
+	ctx->state[5] = 0x9b05688c;
+	ctx->state[6] = 0x1f83d9ab;
+	ctx->state[7] = 0x5be0cd19;
+	ctx->length = 0;
+	ctx->used = 0;
+#endif
+}
+
+static void hash_update(struct hash_ctx *ctx, uint8_t *data, uint32_t len)
+{
+	if (ctx->algo != APPLET_HASH_SHA256) {
+		ctx->crc = crc32_update(ctx->crc, data, len);
+		return;
+	}
+#ifdef CONFIG_HAVE_SHA
+	{
+		struct _buffer buf = { .data = data, .size = len };
+
+		shad_update(&shad, &buf, NULL);
+		shad_wait_completion(&shad);
+	}
+#else
+	sha256_update(ctx, data, len);
+#endif
+}
+
+static void hash_finish(struct hash_ctx *ctx, uint8_t *digest)
+{
+	if (ctx->algo != APPLET_HASH_SHA256) {
+		memcpy(digest, &ctx->crc, sizeof(ctx->crc));
+		return;
+	}
+#ifdef CONFIG_HAVE_SHA
+	{
+		struct _buffer buf = { .data = digest, .size = SHA256_SIZE };
+
+		shad_finish(&shad, &buf, NULL);
+		shad_wait_completion(&shad);
+	}
+#else
+	sha256_finish(ctx, digest);
+#endif
+}
+
+/** Compare 'length' pages of media with 'data', using 'scratch' to read */
+static uint32_t compare_pages(const uint8_t *data, uint32_t offset,
+		uint32_t length, uint8_t *scratch, uint32_t scratch_pages,
+		uint32_t page_size, bool *identical)
+{
+	uint32_t done, count, pages, status;
+
+	*identical = true;
+	for (done = 0; done < length; done += count) {
+		count = min_u32(length - done, scratch_pages);
+		status = applet_media_ops.read(scratch, offset + done, count,
+				&pages);
+		if (status != APPLET_SUCCESS)
+			return status;
+		if (memcmp(scratch, data + done * page_size,
+					count * page_size)) {
+			*identical = false;
+			break;
+		}
+	}
+	return APPLET_SUCCESS;
+}
+
+/** Erase and write 'count' units of 'unit' pages */
+static uint32_t program_units(const uint8_t *data, uint32_t offset,
+		uint32_t count, uint32_t unit, bool erase, uint32_t *written)
+{
+	union read_write_erase_pages_mailbox mbx;
+	applet_command_handler_t handler;
+	uint32_t i, status;
+
+	*written = 0;
+	if (erase) {
+		handler = get_applet_command_handler(APPLET_CMD_ERASE_PAGES);
+		if (!handler)
+			return APPLET_FAIL;
+		for (i = 0; i < count; i++) {
+			mbx.in.offset = offset + i * unit;
+			mbx.in.length = unit;
+			status = handler(APPLET_CMD_ERASE_PAGES, (uint32_t*)&mbx);
+			if (status != APPLET_SUCCESS)
+				return status;
+		}
+	}
+
+	return applet_media_ops.write((uint8_t*)data, offset, count * unit,
+			written);
+}
+
+/*----------------------------------------------------------------------------
+ *         Public functions
+ *----------------------------------------------------------------------------*/
+
+uint32_t applet_handle_cmd_hash_pages(uint32_t cmd, uint32_t *args)
+{
+	union hash_pages_mailbox *mbx = (union hash_pages_mailbox*)args;
+	uint32_t offset = mbx->in.offset;
+	uint32_t length = mbx->in.length;
+	uint32_t algo = mbx->in.algo;
+	uint32_t block = mbx->in.block;
+	union initialize_mailbox info;
+	uint8_t digest[SHA256_SIZE];
+	uint8_t *list, *scratch, *end;
+	uint32_t page_size, size, count, done, i;
+	struct hash_ctx ctx;
+
+	assert(cmd == APPLET_CMD_HASH_PAGES);
+
+	if (algo != APPLET_HASH_CRC32 && algo != APPLET_HASH_SHA256) {
+		trace_error("Unsupported hash algorithm %u\r\n",
+				(unsigned)algo);
+		return APPLET_FAIL;
+	}
+
+	if (!applet_get_info(&info))
+		return APPLET_FAIL;
+	page_size = info.out.page_size;
+	size = hash_size(algo);
+
+	/* the hash list, if any, is followed by the read buffer */
+	list = (uint8_t*)info.out.buf_addr;
+	end = list + info.out.buf_size;
+	count = block ? (length + block - 1) / block : 1;
+	scratch = list;
+	if (block)
+		scratch += ROUND_UP_MULT(count * size, page_size);
+	if (scratch + page_size > end) {
+		trace_error("Buffer overflow\r\n");
+		return APPLET_FAIL;
+	}
+
+	for (i = 0, done = 0; i < count; i++) {
+		uint32_t blk = block ? min_u32(block, length - done) : length;
+		uint32_t n, chunk, pages, status;
+
+		hash_start(&ctx, algo);
+		for (n = 0; n < blk; n += chunk) {
+			chunk = min_u32(blk - n, (end - scratch) / page_size);
+			status = applet_media_ops.read(scratch, offset + done + n,
+					chunk, &pages);
+			if (status != APPLET_SUCCESS) {
+				mbx->out.pages = done + n;
+				mbx->out.count = i;
+				return status;
+			}
+			hash_update(&ctx, scratch, chunk * page_size);
+		}
+		hash_finish(&ctx, digest);
+		done += blk;
+
+		if (block) {
+			memcpy(list + i * size, digest, size);
+		} else {
+			memset(mbx->out.hash, 0, sizeof(mbx->out.hash));
+			memcpy(mbx->out.hash, digest, size);
+		}
+	}
+
+	trace_info_wp("Hashed %u bytes at offset 0x%08x\r\n",
+			(unsigned)(length * page_size),
+			(unsigned)(offset * page_size));
+
+	mbx->out.pages = length;
+	mbx->out.count = count;
+
+	return APPLET_SUCCESS;
+}
+
+uint32_t applet_handle_cmd_update_pages(uint32_t cmd, uint32_t *args)
+{
+	union update_pages_mailbox *mbx = (union update_pages_mailbox*)args;
+	uint32_t offset = mbx->in.offset;
+	uint32_t length = mbx->in.length;
+	union initialize_mailbox info;
+	uint32_t page_size, unit, scratch_pages, written, skipped;
+	uint32_t run, pos, pages, status, ahead_start, ahead_end;
+	uint8_t *data, *scratch;
+	bool erase, identical;
+
+	assert(cmd == APPLET_CMD_UPDATE_PAGES);
+
+	if (!applet_get_info(&info))
+		return APPLET_FAIL;
+	page_size = info.out.page_size;
+	data = (uint8_t*)info.out.buf_addr;
+
+	/* compare and program by smallest erase units, or by page for
+	 * media without erase */
+	erase = info.out.erase_support != 0;
+	unit = erase ? info.out.erase_support & -info.out.erase_support : 1;
+	if ((offset % unit) || (length % unit)) {
+		trace_error("Update must be aligned on %u pages\r\n",
+				(unsigned)unit);
+		return APPLET_ALIGN_ERROR;
+	}
+
+	/* media content is read in the buffer space left after the data */
+	if ((length + 1) * page_size > info.out.buf_size) {
+		trace_error("Buffer overflow\r\n");
+		return APPLET_FAIL;
+	}
+	scratch = data + length * page_size;
+	scratch_pages = info.out.buf_size / page_size - length;
+	if (erase)
+		scratch_pages = min_u32(scratch_pages, unit);
+
+	written = 0;
+	skipped = 0;
+	run = 0;
+	ahead_start = ahead_end = 0;
+	for (pos = 0; pos <= length; pos += unit) {
+		if (pos < length && erase) {
+			status = compare_pages(data + pos * page_size,
+					offset + pos, unit, scratch,
+					scratch_pages, page_size, &identical);
+			if (status != APPLET_SUCCESS)
+				goto out;
+		} else if (pos < length) {
+			/* without erase, the media is read in chunks as large
+			 * as the free buffer space and compared by page */
+			if (pos >= ahead_end) {
+				ahead_start = pos;
+				ahead_end = pos + min_u32(length - pos,
+						scratch_pages);
+				status = applet_media_ops.read(scratch,
+						offset + pos, ahead_end - pos,
+						&pages);
+				if (status != APPLET_SUCCESS)
+					goto out;
+			}
+			identical = !memcmp(scratch +
+					(pos - ahead_start) * page_size,
+					data + pos * page_size, page_size);
+		}
+		if (pos < length) {
+			if (!identical) {
+				run++;
+				continue;
+			}
+			skipped += unit;
+		}
+
+		/* end of a run of modified units */
+		if (run) {
+			uint32_t start = pos - run * unit;
+
+			status = program_units(data + start * page_size,
+					offset + start, run, unit, erase,
+					&pages);
+			written += pages;
+			if (status != APPLET_SUCCESS)
+				goto out;
+			run = 0;
+		}
+	}
+	status = APPLET_SUCCESS;
+
+	trace_info_wp("Updated %u bytes at offset 0x%08x, %u bytes unchanged\r\n",
+			(unsigned)(written * page_size),
+			(unsigned)(offset * page_size),
+			(unsigned)(skipped * page_size));
+
+out:
+	mbx->out.pages = written;
+	mbx->out.skipped = skipped;
+
+	return status;
+}
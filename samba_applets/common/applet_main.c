@@ -206,6 +206,16 @@ applet_command_handler_t get_applet_command_handler(uint8_t cmd)
 	return NULL;
 }
 
+bool applet_get_info(union initialize_mailbox* info)
+{
+	applet_command_handler_t handler;
+
+	handler = get_applet_command_handler(APPLET_CMD_READ_INFO);
+	if (!handler)
+		return false;
+	return handler(APPLET_CMD_READ_INFO, (uint32_t*)info) == APPLET_SUCCESS;
+}
+
 /**
  * \brief  Applet main entry. This function decodes received command and
  * executes it.
@@ -0,0 +1,210 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "applet.h"
+#include "barriers.h"
+#include "timer.h"
+#include "trace.h"
+
+#include <assert.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+/* the slot table is always sized for the maximum number of slots, so that
+ * the slot data addresses only depend on the slot count */
+#define SLOT_TABLE_SIZE (APPLET_MAX_SLOTS * sizeof(struct applet_slot))
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct applet_slot *slot_table;
+static uint8_t *slot_data;
+static uint32_t slot_count;
+static uint32_t slot_pages;
+static uint32_t slot_size;
+static uint32_t slot_next;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t process_slot(uint32_t index, uint32_t request)
+{
+	struct applet_slot *slot = &slot_table[index];
+	uint8_t *buf = slot_data + index * slot_size;
+	uint32_t status;
+
+	slot->status = APPLET_SLOT_BUSY;
+	slot->pages = 0;
+
+	/* slot content was written by the host before the request */
+	dmb();
+
+	if (slot->length > slot_pages) {
+		trace_error("Slot %u overflow\r\n", (unsigned)index);
+		status = APPLET_FAIL;
+	} else if (request == APPLET_SLOT_WRITE) {
+		status = applet_media_ops.write(buf, slot->offset,
+				slot->length, &slot->pages);
+	} else {
+		status = applet_media_ops.read(buf, slot->offset,
+				slot->length, &slot->pages);
+	}
+	slot->error = status;
+
+	/* make results visible before the state change */
+	dmb();
+
+	slot->status = (status == APPLET_SUCCESS) ?
+		APPLET_SLOT_DONE : APPLET_SLOT_ERROR;
+	return status;
+}
+
+/*----------------------------------------------------------------------------
+ *         Public functions
+ *----------------------------------------------------------------------------*/
+
+uint32_t applet_handle_cmd_init_slots(uint32_t cmd, uint32_t *args)
+{
+	union init_slots_mailbox *mbx = (union init_slots_mailbox*)args;
+	union initialize_mailbox info;
+	uint32_t buf_size, page_size, count, i;
+
+	assert(cmd == APPLET_CMD_INIT_SLOTS);
+
+	slot_count = 0;
+
+	count = mbx->in.count;
+	if (count < 2 || count > APPLET_MAX_SLOTS) {
+		trace_error("Invalid slot count %u\r\n", (unsigned)count);
+		return APPLET_FAIL;
+	}
+
+	if (!applet_get_info(&info))
+		return APPLET_FAIL;
+	buf_size = info.out.buf_size;
+	page_size = info.out.page_size;
+
+	if (buf_size <= SLOT_TABLE_SIZE ||
+	    (buf_size - SLOT_TABLE_SIZE) / count < page_size) {
+		trace_error("Not enough memory for %u slots\r\n",
+				(unsigned)count);
+		return APPLET_FAIL;
+	}
+
+	slot_table = (struct applet_slot*)info.out.buf_addr;
+	slot_data = (uint8_t*)info.out.buf_addr + SLOT_TABLE_SIZE;
+	slot_pages = (buf_size - SLOT_TABLE_SIZE) / count / page_size;
+	slot_size = slot_pages * page_size;
+	slot_count = count;
+	slot_next = 0;
+	memset(slot_table, 0, SLOT_TABLE_SIZE);
+
+	trace_info_wp("Buffer split in %u slots of %u bytes\r\n",
+			(unsigned)slot_count, (unsigned)slot_size);
+
+	mbx->out.table_addr = (uint32_t)slot_table;
+	mbx->out.count = slot_count;
+	mbx->out.slot_pages = slot_pages;
+	for (i = 0; i < APPLET_MAX_SLOTS; i++)
+		mbx->out.slot_addr[i] = i < slot_count ?
+			(uint32_t)(slot_data + i * slot_size) : 0;
+
+	return APPLET_SUCCESS;
+}
+
+uint32_t applet_handle_cmd_run_slots(uint32_t cmd, uint32_t *args)
+{
+	union run_slots_mailbox *mbx = (union run_slots_mailbox*)args;
+	uint32_t count = mbx->in.count;
+	uint32_t timeout_ms = mbx->in.timeout;
+	uint32_t processed = 0, pages = 0;
+	uint32_t status = APPLET_SUCCESS;
+	struct _timeout timeout;
+
+	assert(cmd == APPLET_CMD_RUN_SLOTS);
+
+	if (!slot_count) {
+		trace_error("Slots not initialized\r\n");
+		return APPLET_FAIL;
+	}
+
+	timer_start_timeout(&timeout, timeout_ms);
+	while (count == 0 || processed < count) {
+		struct applet_slot *slot = &slot_table[slot_next];
+		uint32_t request = slot->status;
+
+		if (request == APPLET_SLOT_WRITE || request == APPLET_SLOT_READ) {
+			status = process_slot(slot_next, request);
+			pages += slot->pages;
+			processed++;
+			slot_next = (slot_next + 1) % slot_count;
+			if (status != APPLET_SUCCESS)
+				break;
+			timer_start_timeout(&timeout, timeout_ms);
+		} else if (request == APPLET_SLOT_STOP) {
+			/* the slot is not consumed: the next request will be
+			 * expected in this slot */
+			slot->status = APPLET_SLOT_FREE;
+			break;
+		} else if (request == APPLET_SLOT_FREE ||
+			   request == APPLET_SLOT_DONE ||
+			   request == APPLET_SLOT_ERROR) {
+			/* waiting for the host */
+			if (timeout_ms && timer_timeout_reached(&timeout)) {
+				trace_error("Timeout waiting for slot %u\r\n",
+						(unsigned)slot_next);
+				status = APPLET_FAIL;
+				break;
+			}
+		} else {
+			trace_error("Invalid status 0x%08x in slot %u\r\n",
+					(unsigned)request, (unsigned)slot_next);
+			status = APPLET_FAIL;
+			break;
+		}
+	}
+
+	trace_info_wp("Processed %u slots, %u pages\r\n",
+			(unsigned)processed, (unsigned)pages);
+
+	mbx->out.count = processed;
+	mbx->out.pages = pages;
+	mbx->out.next = slot_next;
+
+	return status;
+}
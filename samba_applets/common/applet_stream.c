@@ -0,0 +1,1266 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Streaming image writer for the 'write stream' command.
+ *
+ * The host sends the image in buffer-sized pieces of any length. Each piece
+ * goes through a chain of incremental decoders that keep their state
+ * between commands:
+ *
+ * - LZ4 frames (optional): decoded through a 64KB history window placed at
+ *   the end of the applet buffer. Linked and independent blocks, stored
+ *   blocks, skippable frames and all xxHash32 checksums are supported,
+ *   dictionaries are not.
+ * - Android sparse image (optional): raw chunks are written, "don't care"
+ *   chunks are skipped and fill chunks of 0xFFFFFFFF are only erased on
+ *   media that support erase. Other fills are written.
+ * - Media writer: gathers the image into page-aligned writes. On media that
+ *   support erase, each erase unit is erased the first time the stream
+ *   enters it, so the stream must start on an erase unit boundary.
+ *
+ * Data that is neither LZ4 nor sparse (at the LZ4 frame content level too)
+ * is written as is, so "sparse", "LZ4", "LZ4 of sparse" and plain images can
+ * all be streamed.
+ */
+
+/*----------------------------------------------------------------------------
+ *         Headers
+ *----------------------------------------------------------------------------*/
+
+#include "applet.h"
+#include "compiler.h"
+#include "intmath.h"
+#include "trace.h"
+
+#include <assert.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *         Local definitions
+ *----------------------------------------------------------------------------*/
+
+#define SPARSE_MAGIC            0xed26ff3a
+#define SPARSE_HEADER_SIZE      28
+#define SPARSE_CHUNK_SIZE       12
+#define SPARSE_CHUNK_RAW        0xcac1
+#define SPARSE_CHUNK_FILL       0xcac2
+#define SPARSE_CHUNK_DONT_CARE  0xcac3
+#define SPARSE_CHUNK_CRC32      0xcac4
+
+#define LZ4_MAGIC               0x184d2204
+#define LZ4_SKIP_MAGIC          0x184d2a50
+#define LZ4_SKIP_MASK           0xfffffff0
+#define LZ4_DESCRIPTOR_MAX      15
+#define LZ4_FLG_VERSION_MASK    0xc0
+#define LZ4_FLG_VERSION         0x40
+#define LZ4_FLG_INDEPENDENT     0x20
+#define LZ4_FLG_BLOCK_CHECKSUM  0x10
+#define LZ4_FLG_CONTENT_SIZE    0x08
+#define LZ4_FLG_CONTENT_CHECKSUM 0x04
+#define LZ4_FLG_RESERVED        0x02
+#define LZ4_FLG_DICT_ID         0x01
+#define LZ4_BD_MASK             0x70
+#define LZ4_BLOCK_STORED        0x80000000
+#define LZ4_MIN_MATCH           4
+#define LZ4_WINDOW_SIZE         (64 * 1024)
+
+/* upper bound for the media write granularity */
+#define STAGING_MAX             (64 * 1024)
+
+#define XXH_PRIME1              0x9e3779b1u
+#define XXH_PRIME2              0x85ebca77u
+#define XXH_PRIME3              0xc2b2ae3du
+#define XXH_PRIME4              0x27d4eb2fu
+#define XXH_PRIME5              0x165667b1u
+
+enum stream_format {
+	FORMAT_UNKNOWN,
+	FORMAT_LZ4,
+	FORMAT_SPARSE,
+	FORMAT_RAW,
+};
+
+enum sparse_state {
+	SPARSE_HEADER,
+	SPARSE_CHUNK,
+	SPARSE_RAW,
+	SPARSE_FILL,
+	SPARSE_CRC32,
+	SPARSE_DONE,
+};
+
+enum lz4_state {
+	LZ4_MAGIC_NUMBER,
+	LZ4_DESCRIPTOR,
+	LZ4_SKIP_SIZE,
+	LZ4_SKIP,
+	LZ4_BLOCK_SIZE,
+	LZ4_BLOCK,
+	LZ4_BLOCK_CHECKSUM,
+	LZ4_CONTENT_CHECKSUM,
+};
+
+enum lz4_sequence {
+	SEQ_TOKEN,
+	SEQ_LITERAL_LENGTH,
+	SEQ_LITERALS,
+	SEQ_OFFSET,
+	SEQ_MATCH_LENGTH,
+};
+
+struct xxh32 {
+	uint32_t v[4];
+	uint32_t total;
+	bool large;
+	uint8_t mem[16];
+	uint32_t used;
+};
+
+/** Media writer */
+struct stream_out {
+	uint8_t *buf;           /* staging area */
+	uint32_t size;          /* staging size (in bytes, page multiple) */
+	uint32_t used;          /* bytes in the staging area */
+	uint32_t page;          /* media page of the staging area start */
+	uint32_t mem_size;      /* media size (in pages) */
+	uint32_t page_size;
+	uint32_t erase_support; /* erase sizes (in pages), 0 if none */
+	uint32_t erase_end;     /* first page not erased by the stream */
+	uint32_t written;       /* pages written */
+	uint32_t erased;        /* pages erased */
+};
+
+/** Android sparse image parser */
+struct stream_sparse {
+	uint8_t state;
+	uint8_t hdr[SPARSE_HEADER_SIZE];
+	uint32_t have;          /* header bytes gathered */
+	uint32_t skip;          /* header bytes to ignore */
+	uint32_t chunk_hdr_size;
+	uint32_t block_size;
+	uint32_t blocks;        /* blocks in the image */
+	uint32_t chunks;        /* chunks left */
+	uint32_t done;          /* blocks output */
+	uint32_t chunk_blocks;
+	uint64_t remaining;     /* raw chunk bytes left */
+};
+
+/** LZ4 frame decoder */
+struct stream_lz4 {
+	uint8_t state;
+	uint8_t seq;
+	uint8_t flags;
+	uint8_t token;
+	uint8_t hdr[LZ4_DESCRIPTOR_MAX];
+	uint32_t have;          /* header bytes gathered */
+	uint32_t need;          /* header bytes needed */
+	uint32_t skip;          /* skippable frame bytes left */
+	uint32_t block_max;     /* maximum block size */
+	uint32_t block_left;    /* block bytes left */
+	uint32_t block_out;     /* bytes output by the current block */
+	bool stored;            /* current block is not compressed */
+	uint32_t length;        /* literal or match bytes left */
+	uint32_t offset;        /* match offset */
+	uint64_t content_size;  /* frame content size, 0 if unknown */
+	uint64_t content_out;   /* bytes output by the current frame */
+	struct xxh32 block_hash;
+	struct xxh32 content_hash;
+	uint8_t *window;
+	uint32_t wpos;          /* window write position */
+	uint32_t fpos;          /* first window byte not passed on */
+	uint32_t history;       /* valid bytes behind wpos */
+};
+
+struct stream {
+	bool active;
+	uint8_t format;         /* format of the received stream */
+	uint8_t image;          /* format of the (decoded) image */
+	uint8_t head[4];
+	uint32_t have;          /* head bytes gathered */
+	uint8_t image_head[4];
+	uint32_t image_have;    /* image head bytes gathered */
+	uint8_t *input;         /* stream data from the host */
+	uint32_t input_size;
+	struct stream_out out;
+	struct stream_sparse sparse;
+	struct stream_lz4 lz4;
+};
+
+/*----------------------------------------------------------------------------
+ *         Local variables
+ *----------------------------------------------------------------------------*/
+
+static struct stream stream;
+
+/*----------------------------------------------------------------------------
+ *         Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t get_le16(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/** Accumulate input in 'hdr' until it holds 'need' bytes */
+static bool gather(uint8_t *hdr, uint32_t *have, uint32_t need,
+		const uint8_t **p, uint32_t *len)
+{
+	uint32_t n = min_u32(need - *have, *len);
+
+	memcpy(hdr + *have, *p, n);
+	*have += n;
+	*p += n;
+	*len -= n;
+	if (*have < need)
+		return false;
+	*have = 0;
+	return true;
+}
+
+static uint32_t rotl32(uint32_t x, uint32_t r)
+{
+	return (x << r) | (x >> (32 - r));
+}
+
+static uint32_t xxh32_round(uint32_t acc, const uint8_t *p)
+{
+	acc += get_le32(p) * XXH_PRIME2;
+	return rotl32(acc, 13) * XXH_PRIME1;
+}
+
+static void xxh32_start(struct xxh32 *x)
+{
+	x->v[0] = XXH_PRIME1 + XXH_PRIME2;
+	x->v[1] = XXH_PRIME2;
+	x->v[2] = 0;
+	x->v[3] = -XXH_PRIME1;
+	x->total = 0;
+	x->large = false;
+	x->used = 0;
+}
+
+static void xxh32_update(struct xxh32 *x, const uint8_t *p, uint32_t len)
+{
+	uint32_t n;
+
+	x->total += len;
+	x->large |= len >= 16 || x->total >= 16;
+
+	if (x->used) {
+		n = min_u32(16 - x->used, len);
+		memcpy(x->mem + x->used, p, n);
+		x->used += n;
+		p += n;
+		len -= n;
+		if (x->used < 16)
+			return;
+		x->v[0] = xxh32_round(x->v[0], x->mem);
+		x->v[1] = xxh32_round(x->v[1], x->mem + 4);
+		x->v[2] = xxh32_round(x->v[2], x->mem + 8);
+		x->v[3] = xxh32_round(x->v[3], x->mem + 12);
+		x->used = 0;
+	}
+
+	for (; len >= 16; p += 16, len -= 16) {
+		x->v[0] = xxh32_round(x->v[0], p);
+		x->v[1] = xxh32_round(x->v[1], p + 4);
+		x->v[2] = xxh32_round(x->v[2], p + 8);
+		x->v[3] = xxh32_round(x->v[3], p + 12);
+	}
+
+	memcpy(x->mem, p, len);
+	x->used = len;
+}
+
+static uint32_t xxh32_digest(const struct xxh32 *x)
+{
+	const uint8_t *p = x->mem;
+	uint32_t len = x->used;
+	uint32_t h;
+
+	if (x->large)
+		h = rotl32(x->v[0], 1) + rotl32(x->v[1], 7) +
+			rotl32(x->v[2], 12) + rotl32(x->v[3], 18);
+	else
+		h = x->v[2] + XXH_PRIME5;
+	h += x->total;
+
+	for (; len >= 4; p += 4, len -= 4)
+		h = rotl32(h + get_le32(p) * XXH_PRIME3, 17) * XXH_PRIME4;
+	for (; len; p++, len--)
+		h = rotl32(h + *p * XXH_PRIME5, 11) * XXH_PRIME1;
+
+	h ^= h >> 15;
+	h *= XXH_PRIME2;
+	h ^= h >> 13;
+	h *= XXH_PRIME3;
+	h ^= h >> 16;
+	return h;
+}
+
+/*
+ * Media writer
+ */
+
+/** Erase 'pages' pages from 'page' using the largest aligned erase sizes */
+static uint32_t out_erase(uint32_t page, uint32_t pages)
+{
+	struct stream_out *out = &stream.out;
+	union read_write_erase_pages_mailbox mbx;
+	applet_command_handler_t handler;
+	uint32_t size, status;
+
+	handler = get_applet_command_handler(APPLET_CMD_ERASE_PAGES);
+	if (!handler)
+		return APPLET_FAIL;
+
+	if (pages > out->mem_size || page > out->mem_size - pages) {
+		trace_error("Stream exceeds the media size\r\n");
+		return APPLET_FAIL;
+	}
+
+	while (pages) {
+		for (size = 1u << 31; size; size >>= 1)
+			if ((out->erase_support & size) && size <= pages &&
+					(page % size) == 0)
+				break;
+		assert(size);
+
+		mbx.in.offset = page;
+		mbx.in.length = size;
+		status = handler(APPLET_CMD_ERASE_PAGES, (uint32_t*)&mbx);
+		if (status != APPLET_SUCCESS)
+			return status;
+		page += size;
+		out->erased += size;
+		pages -= size;
+	}
+	return APPLET_SUCCESS;
+}
+
+/** Erase the erase units entered for the first time by the pages from the
+ * current one up to 'end'. Units skipped over are left untouched. */
+static uint32_t out_enter(uint32_t end)
+{
+	struct stream_out *out = &stream.out;
+	uint32_t unit, start, status;
+
+	if (!out->erase_support)
+		return APPLET_SUCCESS;
+
+	unit = out->erase_support & -out->erase_support;
+	start = max_u32(out->erase_end, out->page - out->page % unit);
+	end = ROUND_UP_MULT(end, unit);
+	if (end <= start)
+		return APPLET_SUCCESS;
+	status = out_erase(start, end - start);
+	if (status != APPLET_SUCCESS)
+		return status;
+	out->erase_end = end;
+	return APPLET_SUCCESS;
+}
+
+static uint32_t out_write(uint8_t *buf, uint32_t pages)
+{
+	struct stream_out *out = &stream.out;
+	uint32_t written, status;
+
+	if (pages > out->mem_size || out->page > out->mem_size - pages) {
+		trace_error("Stream exceeds the media size\r\n");
+		return APPLET_FAIL;
+	}
+
+	status = out_enter(out->page + pages);
+	if (status != APPLET_SUCCESS)
+		return status;
+	status = applet_media_ops.write(buf, out->page, pages, &written);
+	if (status != APPLET_SUCCESS)
+		return status;
+	out->page += pages;
+	out->written += pages;
+	return APPLET_SUCCESS;
+}
+
+/** Write the complete pages of the staging area, and the last partial
+ * page padded with 0xFF if 'final' is set */
+static uint32_t out_flush(bool final)
+{
+	struct stream_out *out = &stream.out;
+	uint32_t pages, rest, status;
+
+	if (final && (out->used % out->page_size)) {
+		rest = out->page_size - out->used % out->page_size;
+		memset(out->buf + out->used, 0xff, rest);
+		out->used += rest;
+	}
+
+	pages = out->used / out->page_size;
+	if (pages == 0)
+		return APPLET_SUCCESS;
+	status = out_write(out->buf, pages);
+	if (status != APPLET_SUCCESS)
+		return status;
+
+	rest = out->used - pages * out->page_size;
+	memmove(out->buf, out->buf + pages * out->page_size, rest);
+	out->used = rest;
+	return APPLET_SUCCESS;
+}
+
+static uint32_t out_data(const uint8_t *p, uint32_t len)
+{
+	struct stream_out *out = &stream.out;
+	uint32_t n, status;
+
+	while (len) {
+		n = min_u32(out->size - out->used, len);
+		memcpy(out->buf + out->used, p, n);
+		out->used += n;
+		p += n;
+		len -= n;
+		if (out->used == out->size) {
+			status = out_flush(false);
+			if (status != APPLET_SUCCESS)
+				return status;
+		}
+	}
+	return APPLET_SUCCESS;
+}
+
+/** Stage 'len' bytes of a 32-bit pattern. Fills always start on a 4-byte
+ * boundary of the image, so the pattern phase follows the staging offset. */
+static uint32_t out_pattern(uint32_t pattern, uint32_t len)
+{
+	struct stream_out *out = &stream.out;
+	uint32_t n, i, status;
+
+	while (len) {
+		n = min_u32(out->size - out->used, len);
+		for (i = out->used; i < out->used + n; i++)
+			out->buf[i] = pattern >> (8 * (i & 3));
+		out->used += n;
+		len -= n;
+		if (out->used == out->size) {
+			status = out_flush(false);
+			if (status != APPLET_SUCCESS)
+				return status;
+		}
+	}
+	return APPLET_SUCCESS;
+}
+
+/** Write 'pages' full pages of a pattern, the staging area being empty */
+static uint32_t out_pattern_pages(uint32_t pattern, uint32_t pages)
+{
+	struct stream_out *out = &stream.out;
+	uint32_t fill, n, status;
+
+	if (pages == 0)
+		return APPLET_SUCCESS;
+
+	/* the pattern is staged once and written as many times as needed */
+	fill = min_u32(pages, out->size / out->page_size);
+	status = out_pattern(pattern, fill * out->page_size);
+	if (status != APPLET_SUCCESS)
+		return status;
+	for (pages -= fill; pages; pages -= n) {
+		n = min_u32(pages, fill);
+		status = out_write(out->buf, n);
+		if (status != APPLET_SUCCESS)
+			return status;
+	}
+	return out_flush(false);
+}
+
+/**
+ * Output 'len' bytes of a fill pattern, or of unspecified content if
+ * 'dont_care' is set. Whole pages of "don't care" are skipped and whole
+ * pages of 0xFFFFFFFF are only erased, the rest is written.
+ */
+static uint32_t out_fill(uint32_t pattern, uint64_t len, bool dont_care)
+{
+	struct stream_out *out = &stream.out;
+	uint32_t head, pages, status;
+
+	if (dont_care)
+		pattern = 0xffffffff;
+
+	/* complete the current page */
+	head = (out->page_size - out->used % out->page_size) % out->page_size;
+	head = (uint32_t)min_u64(head, len);
+	status = out_pattern(pattern, head);
+	if (status != APPLET_SUCCESS)
+		return status;
+	len -= head;
+
+	if (len >= out->page_size) {
+		status = out_flush(false);
+		if (status != APPLET_SUCCESS)
+			return status;
+		assert(out->used == 0);
+
+		if (len / out->page_size > out->mem_size) {
+			trace_error("Stream exceeds the media size\r\n");
+			return APPLET_FAIL;
+		}
+		pages = (uint32_t)(len / out->page_size);
+		len -= (uint64_t)pages * out->page_size;
+
+		if (out->page > out->mem_size - pages) {
+			trace_error("Stream exceeds the media size\r\n");
+			return APPLET_FAIL;
+		}
+		if (dont_care) {
+			out->page += pages;
+		} else if (pattern == 0xffffffff && out->erase_support) {
+			/* the pages ahead of the stream in the units already
+			 * entered are still erased */
+			status = out_enter(out->page + pages);
+			if (status != APPLET_SUCCESS)
+				return status;
+			out->page += pages;
+		} else {
+			status = out_pattern_pages(pattern, pages);
+			if (status != APPLET_SUCCESS)
+				return status;
+		}
+	}
+
+	return out_pattern(pattern, (uint32_t)len);
+}
+
+/*
+ * Android sparse image
+ */
+
+static uint32_t sparse_next_chunk(void)
+{
+	struct stream_sparse *sp = &stream.sparse;
+
+	if (--sp->chunks) {
+		sp->state = SPARSE_CHUNK;
+		return APPLET_SUCCESS;
+	}
+
+	sp->state = SPARSE_DONE;
+	if (sp->done != sp->blocks) {
+		trace_error("Sparse image has %u blocks instead of %u\r\n",
+				(unsigned)sp->done, (unsigned)sp->blocks);
+		return APPLET_FAIL;
+	}
+	return APPLET_SUCCESS;
+}
+
+static uint32_t sparse_header(void)
+{
+	struct stream_sparse *sp = &stream.sparse;
+	uint32_t file_hdr_size = get_le16(sp->hdr + 8);
+
+	sp->chunk_hdr_size = get_le16(sp->hdr + 10);
+	sp->block_size = get_le32(sp->hdr + 12);
+	sp->blocks = get_le32(sp->hdr + 16);
+	sp->chunks = get_le32(sp->hdr + 20);
+	sp->done = 0;
+
+	if (get_le32(sp->hdr) != SPARSE_MAGIC || get_le16(sp->hdr + 4) != 1 ||
+	    file_hdr_size < SPARSE_HEADER_SIZE ||
+	    sp->chunk_hdr_size < SPARSE_CHUNK_SIZE ||
+	    sp->block_size == 0 || (sp->block_size & 3)) {
+		trace_error("Invalid sparse image header\r\n");
+		return APPLET_FAIL;
+	}
+
+	trace_info_wp("Sparse image: %u blocks of %u bytes, %u chunks\r\n",
+			(unsigned)sp->blocks, (unsigned)sp->block_size,
+			(unsigned)sp->chunks);
+
+	sp->skip = file_hdr_size - SPARSE_HEADER_SIZE;
+	sp->state = SPARSE_CHUNK;
+	if (sp->chunks == 0) {
+		sp->chunks = 1;
+		return sparse_next_chunk();
+	}
+	return APPLET_SUCCESS;
+}
+
+static uint32_t sparse_chunk(void)
+{
+	struct stream_sparse *sp = &stream.sparse;
+	uint32_t type = get_le16(sp->hdr);
+	uint32_t total = get_le32(sp->hdr + 8);
+	uint64_t payload;
+	uint32_t status;
+
+	sp->chunk_blocks = get_le32(sp->hdr + 4);
+	sp->skip = sp->chunk_hdr_size - SPARSE_CHUNK_SIZE;
+	payload = (uint64_t)total - sp->chunk_hdr_size;
+
+	if (total < sp->chunk_hdr_size ||
+	    sp->chunk_blocks > sp->blocks - sp->done)
+		goto invalid;
+	if (type != SPARSE_CHUNK_CRC32)
+		sp->done += sp->chunk_blocks;
+
+	switch (type) {
+	case SPARSE_CHUNK_RAW:
+		sp->remaining = (uint64_t)sp->chunk_blocks * sp->block_size;
+		if (payload != sp->remaining)
+			goto invalid;
+		sp->state = SPARSE_RAW;
+		if (sp->remaining == 0)
+			return sparse_next_chunk();
+		return APPLET_SUCCESS;
+	case SPARSE_CHUNK_FILL:
+		if (payload != 4)
+			goto invalid;
+		sp->state = SPARSE_FILL;
+		return APPLET_SUCCESS;
+	case SPARSE_CHUNK_DONT_CARE:
+		if (payload != 0)
+			goto invalid;
+		status = out_fill(0, (uint64_t)sp->chunk_blocks *
+				sp->block_size, true);
+		if (status != APPLET_SUCCESS)
+			return status;
+		return sparse_next_chunk();
+	case SPARSE_CHUNK_CRC32:
+		/* the CRC covers "don't care" areas the applet did not
+		 * write, it cannot be checked here */
+		if (payload != 4)
+			goto invalid;
+		sp->state = SPARSE_CRC32;
+		return APPLET_SUCCESS;
+	}
+
+invalid:
+	trace_error("Invalid sparse chunk %u (type 0x%04x)\r\n",
+			(unsigned)sp->chunks, (unsigned)type);
+	return APPLET_FAIL;
+}
+
+static uint32_t sparse_feed(const uint8_t *p, uint32_t len)
+{
+	struct stream_sparse *sp = &stream.sparse;
+	uint32_t n, status = APPLET_SUCCESS;
+
+	while (len && status == APPLET_SUCCESS) {
+		if (sp->skip) {
+			n = min_u32(sp->skip, len);
+			sp->skip -= n;
+			p += n;
+			len -= n;
+			continue;
+		}
+
+		switch (sp->state) {
+		case SPARSE_HEADER:
+			if (gather(sp->hdr, &sp->have, SPARSE_HEADER_SIZE,
+						&p, &len))
+				status = sparse_header();
+			break;
+		case SPARSE_CHUNK:
+			if (gather(sp->hdr, &sp->have, SPARSE_CHUNK_SIZE,
+						&p, &len))
+				status = sparse_chunk();
+			break;
+		case SPARSE_RAW:
+			n = (uint32_t)min_u64(sp->remaining, len);
+			status = out_data(p, n);
+			sp->remaining -= n;
+			p += n;
+			len -= n;
+			if (status == APPLET_SUCCESS && sp->remaining == 0)
+				status = sparse_next_chunk();
+			break;
+		case SPARSE_FILL:
+			if (gather(sp->hdr, &sp->have, 4, &p, &len)) {
+				status = out_fill(get_le32(sp->hdr),
+						(uint64_t)sp->chunk_blocks *
+						sp->block_size, false);
+				if (status == APPLET_SUCCESS)
+					status = sparse_next_chunk();
+			}
+			break;
+		case SPARSE_CRC32:
+			if (gather(sp->hdr, &sp->have, 4, &p, &len))
+				status = sparse_next_chunk();
+			break;
+		default:
+			trace_error("Data after the end of the sparse image\r\n");
+			status = APPLET_FAIL;
+			break;
+		}
+	}
+	return status;
+}
+
+/*
+ * Decoded image: sparse image or raw data
+ */
+
+static uint32_t image_feed(const uint8_t *p, uint32_t len)
+{
+	uint32_t status;
+
+	if (stream.image == FORMAT_UNKNOWN) {
+		if (!gather(stream.image_head, &stream.image_have, 4, &p, &len))
+			return APPLET_SUCCESS;
+		if (get_le32(stream.image_head) == SPARSE_MAGIC) {
+			stream.image = FORMAT_SPARSE;
+			status = sparse_feed(stream.image_head, 4);
+		} else {
+			stream.image = FORMAT_RAW;
+			status = out_data(stream.image_head, 4);
+		}
+		if (status != APPLET_SUCCESS)
+			return status;
+	}
+
+	if (stream.image == FORMAT_SPARSE)
+		return sparse_feed(p, len);
+	else
+		return out_data(p, len);
+}
+
+static uint32_t image_finish(void)
+{
+	struct stream_sparse *sp = &stream.sparse;
+
+	if (stream.image == FORMAT_UNKNOWN)
+		return out_data(stream.image_head, stream.image_have);
+
+	if (stream.image == FORMAT_SPARSE &&
+	    (sp->state != SPARSE_DONE || sp->skip)) {
+		trace_error("Truncated sparse image\r\n");
+		return APPLET_FAIL;
+	}
+	return APPLET_SUCCESS;
+}
+
+/*
+ * LZ4 frames
+ */
+
+/** Pass the window bytes not yet handled to the image */
+static uint32_t lz4_flush(void)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	uint32_t len = lz->wpos - lz->fpos;
+	uint8_t *p = lz->window + lz->fpos;
+
+	if (len == 0)
+		return APPLET_SUCCESS;
+	lz->fpos = lz->wpos % LZ4_WINDOW_SIZE;
+	lz->wpos = lz->fpos;
+	if (lz->flags & LZ4_FLG_CONTENT_CHECKSUM)
+		xxh32_update(&lz->content_hash, p, len);
+	return image_feed(p, len);
+}
+
+static uint32_t lz4_advance(uint32_t len)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+
+	lz->wpos += len;
+	lz->history = min_u32(lz->history + len, LZ4_WINDOW_SIZE);
+	lz->block_out += len;
+	lz->content_out += len;
+	if (lz->wpos == LZ4_WINDOW_SIZE)
+		return lz4_flush();
+	return APPLET_SUCCESS;
+}
+
+static uint32_t lz4_literals(const uint8_t *p, uint32_t len)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	uint32_t n, status;
+
+	while (len) {
+		n = min_u32(LZ4_WINDOW_SIZE - lz->wpos, len);
+		memcpy(lz->window + lz->wpos, p, n);
+		p += n;
+		len -= n;
+		status = lz4_advance(n);
+		if (status != APPLET_SUCCESS)
+			return status;
+	}
+	return APPLET_SUCCESS;
+}
+
+static uint32_t lz4_match(void)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	uint32_t offset = lz->offset;
+	uint32_t len = lz->length;
+	uint32_t src, n, status;
+
+	if (lz->block_out + len > lz->block_max) {
+		trace_error("LZ4 block too large\r\n");
+		return APPLET_FAIL;
+	}
+
+	while (len) {
+		src = (lz->wpos - offset) % LZ4_WINDOW_SIZE;
+		n = min_u32(len, LZ4_WINDOW_SIZE - lz->wpos);
+		n = min_u32(n, LZ4_WINDOW_SIZE - src);
+		if (offset == 1) {
+			memset(lz->window + lz->wpos, lz->window[src], n);
+		} else {
+			/* overlapping matches repeat the last 'offset' bytes;
+			 * a source wrapped behind the write position is read
+			 * ahead of it */
+			n = min_u32(n, offset);
+			memmove(lz->window + lz->wpos, lz->window + src, n);
+		}
+		len -= n;
+		status = lz4_advance(n);
+		if (status != APPLET_SUCCESS)
+			return status;
+	}
+	return APPLET_SUCCESS;
+}
+
+/** Decode 'len' bytes of a compressed block, 'last' is set if they end
+ * the block */
+static uint32_t lz4_sequences(const uint8_t *p, uint32_t len, bool last)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	const uint8_t *end = p + len;
+	uint32_t n, status = APPLET_SUCCESS;
+
+	while (p < end && status == APPLET_SUCCESS) {
+		switch (lz->seq) {
+		case SEQ_TOKEN:
+			lz->token = *p++;
+			lz->length = lz->token >> 4;
+			lz->seq = lz->length == 15 ?
+				SEQ_LITERAL_LENGTH : SEQ_LITERALS;
+			break;
+		case SEQ_LITERAL_LENGTH:
+			lz->length += *p;
+			if (*p++ != 255)
+				lz->seq = SEQ_LITERALS;
+			break;
+		case SEQ_LITERALS:
+			if (lz->block_out + lz->length > lz->block_max) {
+				trace_error("LZ4 block too large\r\n");
+				return APPLET_FAIL;
+			}
+			n = min_u32(lz->length, end - p);
+			status = lz4_literals(p, n);
+			lz->length -= n;
+			p += n;
+			if (lz->length == 0) {
+				lz->seq = SEQ_OFFSET;
+				lz->have = 0;
+			}
+			break;
+		case SEQ_OFFSET:
+			if (lz->have++ == 0) {
+				lz->offset = *p++;
+				break;
+			}
+			lz->offset |= *p++ << 8;
+			if (lz->offset == 0 || lz->offset > lz->history) {
+				trace_error("Invalid LZ4 match offset\r\n");
+				return APPLET_FAIL;
+			}
+			lz->length = (lz->token & 15) + LZ4_MIN_MATCH;
+			if ((lz->token & 15) == 15) {
+				lz->seq = SEQ_MATCH_LENGTH;
+			} else {
+				status = lz4_match();
+				lz->seq = SEQ_TOKEN;
+			}
+			break;
+		case SEQ_MATCH_LENGTH:
+			lz->length += *p;
+			if (lz->length > lz->block_max) {
+				trace_error("LZ4 block too large\r\n");
+				return APPLET_FAIL;
+			}
+			if (*p++ != 255) {
+				status = lz4_match();
+				lz->seq = SEQ_TOKEN;
+			}
+			break;
+		}
+	}
+	if (status != APPLET_SUCCESS || !last)
+		return status;
+
+	/* the last sequence of a block only has literals */
+	if (!(lz->seq == SEQ_OFFSET && lz->have == 0) &&
+	    !(lz->seq == SEQ_LITERALS && lz->length == 0)) {
+		trace_error("Truncated LZ4 block\r\n");
+		return APPLET_FAIL;
+	}
+	return APPLET_SUCCESS;
+}
+
+static uint32_t lz4_descriptor(void)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	struct xxh32 x;
+
+	/* the descriptor size is known from its first byte */
+	if (lz->need == 2) {
+		lz->flags = lz->hdr[0];
+		if ((lz->flags & LZ4_FLG_VERSION_MASK) != LZ4_FLG_VERSION ||
+		    (lz->flags & (LZ4_FLG_RESERVED | LZ4_FLG_DICT_ID)) ||
+		    (lz->hdr[1] & ~LZ4_BD_MASK) ||
+		    ((lz->hdr[1] & LZ4_BD_MASK) >> 4) < 4) {
+			trace_error("Unsupported LZ4 frame descriptor\r\n");
+			return APPLET_FAIL;
+		}
+		lz->need = 3;
+		if (lz->flags & LZ4_FLG_CONTENT_SIZE)
+			lz->need += 8;
+		lz->have = 2;
+		lz->state = LZ4_DESCRIPTOR;
+		return APPLET_SUCCESS;
+	}
+
+	xxh32_start(&x);
+	xxh32_update(&x, lz->hdr, lz->need - 1);
+	if (((xxh32_digest(&x) >> 8) & 0xff) != lz->hdr[lz->need - 1]) {
+		trace_error("Bad LZ4 header checksum\r\n");
+		return APPLET_FAIL;
+	}
+
+	lz->block_max = 1 << (8 + 2 * ((lz->hdr[1] & LZ4_BD_MASK) >> 4));
+	lz->content_size = 0;
+	if (lz->flags & LZ4_FLG_CONTENT_SIZE)
+		lz->content_size = get_le32(lz->hdr + 2) |
+			((uint64_t)get_le32(lz->hdr + 6) << 32);
+	lz->content_out = 0;
+	lz->history = 0;
+	xxh32_start(&lz->content_hash);
+	lz->state = LZ4_BLOCK_SIZE;
+	return APPLET_SUCCESS;
+}
+
+static uint32_t lz4_end_frame(void)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	uint32_t status;
+
+	status = lz4_flush();
+	if (status != APPLET_SUCCESS)
+		return status;
+
+	if ((lz->flags & LZ4_FLG_CONTENT_SIZE) &&
+	    lz->content_out != lz->content_size) {
+		trace_error("LZ4 frame content size mismatch\r\n");
+		return APPLET_FAIL;
+	}
+	lz->state = (lz->flags & LZ4_FLG_CONTENT_CHECKSUM) ?
+		LZ4_CONTENT_CHECKSUM : LZ4_MAGIC_NUMBER;
+	return APPLET_SUCCESS;
+}
+
+static uint32_t lz4_block_size(void)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	uint32_t size = get_le32(lz->hdr);
+
+	if (size == 0)
+		return lz4_end_frame();
+
+	lz->stored = (size & LZ4_BLOCK_STORED) != 0;
+	lz->block_left = size & ~LZ4_BLOCK_STORED;
+	if (lz->block_left > lz->block_max) {
+		trace_error("LZ4 block too large\r\n");
+		return APPLET_FAIL;
+	}
+	lz->block_out = 0;
+	lz->seq = SEQ_TOKEN;
+	if (lz->flags & LZ4_FLG_INDEPENDENT)
+		lz->history = 0;
+	xxh32_start(&lz->block_hash);
+	lz->state = LZ4_BLOCK;
+	return APPLET_SUCCESS;
+}
+
+static uint32_t lz4_feed(const uint8_t *p, uint32_t len)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	uint32_t n, magic, status = APPLET_SUCCESS;
+
+	while (len && status == APPLET_SUCCESS) {
+		switch (lz->state) {
+		case LZ4_MAGIC_NUMBER:
+			if (!gather(lz->hdr, &lz->have, 4, &p, &len))
+				break;
+			magic = get_le32(lz->hdr);
+			if (magic == LZ4_MAGIC) {
+				lz->need = 2;
+				lz->state = LZ4_DESCRIPTOR;
+			} else if ((magic & LZ4_SKIP_MASK) == LZ4_SKIP_MAGIC) {
+				lz->state = LZ4_SKIP_SIZE;
+			} else {
+				trace_error("Invalid LZ4 frame magic\r\n");
+				status = APPLET_FAIL;
+			}
+			break;
+		case LZ4_DESCRIPTOR:
+			if (gather(lz->hdr, &lz->have, lz->need, &p, &len))
+				status = lz4_descriptor();
+			break;
+		case LZ4_SKIP_SIZE:
+			if (gather(lz->hdr, &lz->have, 4, &p, &len)) {
+				lz->skip = get_le32(lz->hdr);
+				lz->state = lz->skip ? LZ4_SKIP : LZ4_MAGIC_NUMBER;
+			}
+			break;
+		case LZ4_SKIP:
+			n = min_u32(lz->skip, len);
+			lz->skip -= n;
+			p += n;
+			len -= n;
+			if (lz->skip == 0)
+				lz->state = LZ4_MAGIC_NUMBER;
+			break;
+		case LZ4_BLOCK_SIZE:
+			if (gather(lz->hdr, &lz->have, 4, &p, &len))
+				status = lz4_block_size();
+			break;
+		case LZ4_BLOCK:
+			n = min_u32(lz->block_left, len);
+			if (lz->flags & LZ4_FLG_BLOCK_CHECKSUM)
+				xxh32_update(&lz->block_hash, p, n);
+			lz->block_left -= n;
+			if (lz->stored) {
+				status = lz4_literals(p, n);
+			} else {
+				status = lz4_sequences(p, n,
+						lz->block_left == 0);
+			}
+			p += n;
+			len -= n;
+			if (lz->block_left == 0)
+				lz->state = (lz->flags & LZ4_FLG_BLOCK_CHECKSUM) ?
+					LZ4_BLOCK_CHECKSUM : LZ4_BLOCK_SIZE;
+			break;
+		case LZ4_BLOCK_CHECKSUM:
+			if (!gather(lz->hdr, &lz->have, 4, &p, &len))
+				break;
+			if (get_le32(lz->hdr) != xxh32_digest(&lz->block_hash)) {
+				trace_error("Bad LZ4 block checksum\r\n");
+				status = APPLET_FAIL;
+			}
+			lz->state = LZ4_BLOCK_SIZE;
+			break;
+		case LZ4_CONTENT_CHECKSUM:
+			if (!gather(lz->hdr, &lz->have, 4, &p, &len))
+				break;
+			if (get_le32(lz->hdr) != xxh32_digest(&lz->content_hash)) {
+				trace_error("Bad LZ4 content checksum\r\n");
+				status = APPLET_FAIL;
+			}
+			lz->state = LZ4_MAGIC_NUMBER;
+			break;
+		}
+	}
+	if (status != APPLET_SUCCESS)
+		return status;
+
+	/* hand the decoded data over, so that the image progresses with
+	 * each command */
+	return lz4_flush();
+}
+
+/*
+ * Stream
+ */
+
+static uint32_t stream_start(uint32_t offset)
+{
+	union initialize_mailbox info;
+	struct stream_out *out = &stream.out;
+	uint32_t page_size, size;
+	uint8_t *buf;
+
+	memset(&stream, 0, sizeof(stream));
+
+	if (!applet_get_info(&info))
+		return APPLET_FAIL;
+	page_size = info.out.page_size;
+	buf = (uint8_t*)info.out.buf_addr;
+	size = info.out.buf_size;
+
+	if (offset > info.out.mem_size) {
+		trace_error("Invalid stream offset %u\r\n", (unsigned)offset);
+		return APPLET_FAIL;
+	}
+	if (info.out.erase_support &&
+	    offset % (info.out.erase_support & -info.out.erase_support)) {
+		trace_error("Stream must start on an erase unit boundary\r\n");
+		return APPLET_ALIGN_ERROR;
+	}
+
+	/* buffer layout: input data, staging area, LZ4 window (if the
+	 * buffer is large enough) */
+	out->page_size = page_size;
+	out->size = min_u32(max_u32((size / 4) & ~(page_size - 1), page_size),
+			max_u32(STAGING_MAX, page_size));
+	if (size < out->size + page_size) {
+		trace_error("Buffer too small for streaming\r\n");
+		return APPLET_FAIL;
+	}
+	size -= out->size;
+	if (size >= LZ4_WINDOW_SIZE + page_size) {
+		size -= LZ4_WINDOW_SIZE;
+		stream.lz4.window = buf + size + out->size;
+	}
+	out->buf = buf + size;
+	out->page = offset;
+	out->mem_size = info.out.mem_size;
+	out->erase_support = info.out.erase_support;
+	out->erase_end = offset;
+	stream.input = buf;
+	stream.input_size = size;
+	stream.active = true;
+
+	trace_info_wp("Stream to offset 0x%08x, %u bytes per command\r\n",
+			(unsigned)(offset * page_size), (unsigned)size);
+	return APPLET_SUCCESS;
+}
+
+static uint32_t stream_feed(const uint8_t *p, uint32_t len)
+{
+	uint32_t status;
+
+	if (stream.format == FORMAT_UNKNOWN) {
+		if (!gather(stream.head, &stream.have, 4, &p, &len))
+			return APPLET_SUCCESS;
+		if (get_le32(stream.head) == LZ4_MAGIC ||
+		    (get_le32(stream.head) & LZ4_SKIP_MASK) == LZ4_SKIP_MAGIC) {
+			if (!stream.lz4.window) {
+				trace_error("Buffer too small for LZ4\r\n");
+				return APPLET_FAIL;
+			}
+			stream.format = FORMAT_LZ4;
+			status = lz4_feed(stream.head, 4);
+		} else {
+			stream.format = FORMAT_RAW;
+			status = image_feed(stream.head, 4);
+		}
+		if (status != APPLET_SUCCESS)
+			return status;
+	}
+
+	if (stream.format == FORMAT_LZ4)
+		return lz4_feed(p, len);
+	else
+		return image_feed(p, len);
+}
+
+static uint32_t stream_finish(void)
+{
+	struct stream_lz4 *lz = &stream.lz4;
+	uint32_t status;
+
+	if (stream.format == FORMAT_UNKNOWN) {
+		status = image_feed(stream.head, stream.have);
+	} else if (stream.format == FORMAT_LZ4 &&
+		   (lz->state != LZ4_MAGIC_NUMBER || lz->have)) {
+		trace_error("Truncated LZ4 frame\r\n");
+		status = APPLET_FAIL;
+	} else {
+		status = APPLET_SUCCESS;
+	}
+
+	if (status == APPLET_SUCCESS)
+		status = image_finish();
+	if (status == APPLET_SUCCESS)
+		status = out_flush(true);
+	return status;
+}
+
+/*----------------------------------------------------------------------------
+ *         Public functions
+ *----------------------------------------------------------------------------*/
+
+uint32_t applet_handle_cmd_write_stream(uint32_t cmd, uint32_t *args)
+{
+	union write_stream_mailbox *mbx = (union write_stream_mailbox*)args;
+	uint32_t flags = mbx->in.flags;
+	uint32_t offset = mbx->in.offset;
+	uint32_t length = mbx->in.length;
+	uint32_t status;
+
+	assert(cmd == APPLET_CMD_WRITE_STREAM);
+
+	if (flags & APPLET_STREAM_START) {
+		status = stream_start(offset);
+		if (status != APPLET_SUCCESS)
+			return status;
+	} else if (!stream.active) {
+		trace_error("No stream in progress\r\n");
+		return APPLET_FAIL;
+	}
+
+	if (length > stream.input_size) {
+		trace_error("Buffer overflow\r\n");
+		status = APPLET_FAIL;
+	} else {
+		status = stream_feed(stream.input, length);
+	}
+	if (status == APPLET_SUCCESS && (flags & APPLET_STREAM_END)) {
+		status = stream_finish();
+		if (status == APPLET_SUCCESS)
+			trace_info_wp("Stream done: %u pages written, "
+					"%u erased, next offset 0x%08x\r\n",
+					(unsigned)stream.out.written,
+					(unsigned)stream.out.erased,
+					(unsigned)(stream.out.page *
+						stream.out.page_size));
+		stream.active = false;
+	}
+
+	/* a failed stream must be restarted */
+	if (status != APPLET_SUCCESS)
+		stream.active = false;
+
+	mbx->out.buf_size = stream.input_size;
+	mbx->out.pages = stream.out.written;
+	mbx->out.erased = stream.out.erased;
+	mbx->out.next = stream.out.page;
+
+	return status;
+}
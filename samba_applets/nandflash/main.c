@@ -75,6 +75,9 @@
 
 #define NAND_HEADER_KEY  (0x0cu)
 
+/* Maximum number of bad blocks skipped by a 'program blocks' sequence */
+#define PROGRAM_MAX_SKIPPED  128
+
 /* Header inserted at beginning of NAND flash.
  * Used by ROM-code to know how to configure NAND & PMECC */
 union _nand_header
@@ -104,6 +107,19 @@ static struct _nand_flash nand;
 static uint32_t page_size;
 static uint32_t block_size;
 
+/* 'program blocks' sequence */
+static struct {
+	bool active;
+	bool strict;          /* fail on bad blocks */
+	bool cache;           /* use cache program */
+	uint16_t first;       /* first physical block */
+	uint16_t next;        /* next physical block */
+	uint16_t limit;       /* first block after the partition */
+	uint32_t blocks;      /* blocks written */
+	uint32_t skipped;     /* bad blocks skipped */
+	uint16_t skip_list[PROGRAM_MAX_SKIPPED];
+} program;
+
 static uint8_t ecc_bit_req_2_tt[] = {
 	2, 4, 8, 12, 24, 32
 };
@@ -403,26 +419,22 @@ static uint32_t handle_cmd_read_info(uint32_t cmd, uint32_t *mailbox)
 /*
 	Write data to NAND flash.
 */
-static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
+static uint32_t write_pages(uint8_t *buf, uint32_t offset, uint32_t length,
+		uint32_t *pages)
 {
-	union read_write_erase_pages_mailbox *mbx =
-		(union read_write_erase_pages_mailbox*)mailbox;
 	uint32_t i;
-	uint8_t *buf;
 	uint16_t block, page;
 
-	assert(cmd == APPLET_CMD_WRITE_PAGES);
-
 	/* check that requested size does not overflow buffer */
-	if (mbx->in.length > buffer_size) {
+	if (length > buffer_size) {
 		trace_error("Buffer overflow\r\n");
 		return APPLET_FAIL;
 	}
 
-	block = mbx->in.offset / block_size;
-	page = mbx->in.offset - block * block_size;
+	block = offset / block_size;
+	page = offset - block * block_size;
 
-	for (i = 0, buf = buffer; i < mbx->in.length; i++, buf += page_size) {
+	for (i = 0; i < length; i++, buf += page_size) {
 		trace_debug_wp("Writing %u bytes at block %u page %u (offset 0x%08x)\r\n",
 				(unsigned)page_size, block, page,
 				(unsigned)((block * block_size + page) * page_size));
@@ -430,12 +442,12 @@ static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
 		if (status == NAND_ERROR_BADBLOCK) {
 			trace_error("Cannot write bad block %u (page %u)\r\n",
 					block, page);
-			mbx->out.pages = i;
+			*pages = i;
 			return APPLET_BAD_BLOCK;
 		} else if (status != 0) {
 			trace_error("Write error at block %u, page %u\r\n",
 					block, page);
-			mbx->out.pages = 0;
+			*pages = 0;
 			return APPLET_WRITE_FAIL;
 		}
 
@@ -448,10 +460,10 @@ static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
 
 
 	trace_info_wp("Wrote %u bytes at offset 0x%08x\r\n",
-			(unsigned)(mbx->in.length * page_size),
-			(unsigned)(mbx->in.offset * page_size));
+			(unsigned)(length * page_size),
+			(unsigned)(offset * page_size));
 
-	mbx->out.pages = mbx->in.length;
+	*pages = length;
 
 	return APPLET_SUCCESS;
 }
@@ -459,35 +471,31 @@ static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
 /*
 	Read data from NAND flash.
 */
-static uint32_t handle_cmd_read_pages(uint32_t cmd, uint32_t *mailbox)
+static uint32_t read_pages(uint8_t *buf, uint32_t offset, uint32_t length,
+		uint32_t *pages)
 {
-	union read_write_erase_pages_mailbox *mbx =
-		(union read_write_erase_pages_mailbox*)mailbox;
 	uint32_t i;
-	uint8_t *buf;
 	uint16_t block, page;
 
-	assert(cmd == APPLET_CMD_READ_PAGES);
-
 	/* check that requested size does not overflow buffer */
-	if (mbx->in.length > buffer_size) {
+	if (length > buffer_size) {
 		trace_error("Buffer overflow\r\n");
 		return APPLET_FAIL;
 	}
 
-	block = mbx->in.offset / block_size;
-	page = mbx->in.offset - block * block_size;
+	block = offset / block_size;
+	page = offset - block * block_size;
 
-	for (i = 0, buf = buffer; i < mbx->in.length; i++, buf += page_size) {
+	for (i = 0; i < length; i++, buf += page_size) {
 		uint8_t status = nand_skipblock_read_page(&nand, block, page, buf, NULL);
 		if (status == NAND_ERROR_BADBLOCK) {
 			trace_error("Cannot read bad block %u\r\n", block);
-			mbx->out.pages = i;
+			*pages = i;
 			return APPLET_BAD_BLOCK;
 		} else if (status != 0) {
 			trace_error("Read error at block %u, page %u\r\n",
 					block, page);
-			mbx->out.pages = 0;
+			*pages = 0;
 			return APPLET_READ_FAIL;
 		}
 
@@ -499,14 +507,36 @@ static uint32_t handle_cmd_read_pages(uint32_t cmd, uint32_t *mailbox)
 	}
 
 	trace_info_wp("Read %u bytes at offset 0x%08x\r\n",
-			(unsigned)(mbx->in.length * page_size),
-			(unsigned)(mbx->in.offset * page_size));
+			(unsigned)(length * page_size),
+			(unsigned)(offset * page_size));
 
-	mbx->out.pages = mbx->in.length;
+	*pages = length;
 
 	return APPLET_SUCCESS;
 }
 
+static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
+{
+	union read_write_erase_pages_mailbox *mbx =
+		(union read_write_erase_pages_mailbox*)mailbox;
+
+	assert(cmd == APPLET_CMD_WRITE_PAGES);
+
+	return write_pages(buffer, mbx->in.offset, mbx->in.length,
+			&mbx->out.pages);
+}
+
+static uint32_t handle_cmd_read_pages(uint32_t cmd, uint32_t *mailbox)
+{
+	union read_write_erase_pages_mailbox *mbx =
+		(union read_write_erase_pages_mailbox*)mailbox;
+
+	assert(cmd == APPLET_CMD_READ_PAGES);
+
+	return read_pages(buffer, mbx->in.offset, mbx->in.length,
+			&mbx->out.pages);
+}
+
 /*
 	Erase blocks from NAND flash.
 */
@@ -552,6 +582,190 @@ static uint32_t handle_cmd_erase_pages(uint32_t cmd, uint32_t *mailbox)
 	return APPLET_SUCCESS;
 }
 
+/*
+	Write the pages of an erased block, using cache program if possible so that
+	the transfer and PMECC computation of a page overlap with the programming
+	of the previous one.
+*/
+static uint8_t program_block_pages(uint16_t block, uint8_t *data,
+		uint32_t length)
+{
+	uint16_t page;
+	uint8_t status;
+
+	for (page = 0; page < length; page++, data += page_size) {
+		if (program.cache)
+			status = nand_raw_write_page_cache(&nand, block, page,
+					data, page == length - 1);
+		else
+			status = nand_ecc_write_page(&nand, block, page,
+					data, NULL);
+		if (status) {
+			trace_error("Write error at block %u, page %u\r\n",
+					block, page);
+			return status;
+		}
+	}
+	return 0;
+}
+
+/*
+	Erase and program the next good block of the partition. Blocks marked bad
+	and blocks that fail erase or program are skipped (and marked bad) unless
+	the sequence is strict.
+*/
+static uint32_t program_next_block(uint8_t *data, uint32_t length)
+{
+	uint16_t block;
+	uint8_t status;
+
+	while (program.next < program.limit) {
+		block = program.next++;
+
+		status = nand_skipblock_check_block(&nand, block);
+		if (status == GOODBLOCK) {
+			status = nand_raw_erase_block(&nand, block);
+			if (status == 0)
+				status = program_block_pages(block, data, length);
+			if (status == 0) {
+				program.blocks++;
+				return APPLET_SUCCESS;
+			}
+
+			/* abort a pending cache program, then retire the
+			 * block */
+			if (program.cache)
+				nand_raw_reset(&nand);
+			nand_raw_erase_block(&nand, block);
+			nand_skipblock_mark_bad_block(&nand, block);
+			trace_warning("Block %u failed, marked bad\r\n", block);
+		} else if (status != BADBLOCK) {
+			trace_error("Cannot check block %u\r\n", block);
+			return APPLET_READ_FAIL;
+		}
+
+		if (program.strict) {
+			trace_error("Bad block %u\r\n", block);
+			return APPLET_BAD_BLOCK;
+		}
+		if (program.skipped == PROGRAM_MAX_SKIPPED) {
+			trace_error("Too many bad blocks\r\n");
+			return APPLET_BAD_BLOCK;
+		}
+		trace_info_wp("Skipping bad block %u\r\n", block);
+		program.skip_list[program.skipped++] = block;
+	}
+
+	trace_error("No good block left in partition\r\n");
+	return APPLET_BAD_BLOCK;
+}
+
+/*
+	Write the logical to physical block map at the start of the buffer.
+*/
+static uint32_t program_write_map(void)
+{
+	uint32_t *map = (uint32_t*)buffer;
+	uint32_t count, skip, i;
+	uint16_t block;
+
+	count = min_u32(program.blocks, buffer_size / sizeof(uint32_t));
+	if (count < program.blocks)
+		trace_warning("Block map truncated to %u entries\r\n",
+				(unsigned)count);
+
+	block = program.first;
+	for (i = 0, skip = 0; i < count; i++, block++) {
+		/* the skip list is in ascending order */
+		while (skip < program.skipped &&
+		       program.skip_list[skip] == block) {
+			skip++;
+			block++;
+		}
+		map[i] = block * block_size;
+	}
+	return count;
+}
+
+static uint32_t handle_cmd_program_blocks(uint32_t cmd, uint32_t *mailbox)
+{
+	union program_blocks_mailbox *mbx =
+		(union program_blocks_mailbox*)mailbox;
+	uint32_t flags = mbx->in.flags;
+	uint32_t offset = mbx->in.offset;
+	uint32_t length = mbx->in.length;
+	uint32_t limit = mbx->in.limit;
+	uint32_t mem_size = nand_model_get_device_size_in_pages(&nand.model);
+	uint32_t done, count, status = APPLET_SUCCESS;
+
+	assert(cmd == APPLET_CMD_PROGRAM_BLOCKS);
+
+	if (flags & APPLET_PROGRAM_START) {
+		if (limit == 0)
+			limit = mem_size;
+		if ((offset & (block_size - 1)) || (limit & (block_size - 1))) {
+			trace_error("Unaligned partition: 0x%08x-0x%08x (block size %u bytes)\r\n",
+					(unsigned)(offset * page_size),
+					(unsigned)(limit * page_size),
+					(unsigned)(block_size * page_size));
+			return APPLET_ALIGN_ERROR;
+		}
+		if (offset >= limit || limit > mem_size) {
+			trace_error("Invalid partition\r\n");
+			return APPLET_FAIL;
+		}
+		memset(&program, 0, sizeof(program));
+		program.active = true;
+		program.strict = (flags & APPLET_PROGRAM_STRICT) != 0;
+		/* software ECC needs the spare area of each page, which
+		 * cache program does not write */
+		program.cache = !(flags & APPLET_PROGRAM_NO_CACHE) &&
+			!nand_is_using_software_ecc() &&
+			nand_onfi_has_cache_program();
+		program.first = offset / block_size;
+		program.next = program.first;
+		program.limit = limit / block_size;
+		trace_info_wp("Programming blocks %u-%u%s%s\r\n",
+				program.first, program.limit - 1,
+				program.strict ? ", strict" : "",
+				program.cache ? ", cache program" : "");
+	} else if (!program.active) {
+		trace_error("No block programming in progress\r\n");
+		return APPLET_FAIL;
+	}
+
+	if (length * page_size > buffer_size) {
+		trace_error("Buffer overflow\r\n");
+		status = APPLET_FAIL;
+	} else if (!(flags & APPLET_PROGRAM_END) && (length & (block_size - 1))) {
+		trace_error("Length must be a multiple of the block size\r\n");
+		status = APPLET_ALIGN_ERROR;
+	}
+
+	mbx->out.pages = 0;
+	for (done = 0; status == APPLET_SUCCESS && done < length; done += count) {
+		count = min_u32(length - done, block_size);
+		status = program_next_block(buffer + done * page_size, count);
+		if (status == APPLET_SUCCESS)
+			mbx->out.pages += count;
+	}
+
+	if (status == APPLET_SUCCESS)
+		trace_info_wp("Wrote %u bytes, next block %u\r\n",
+				(unsigned)(length * page_size), program.next);
+
+	mbx->out.blocks = program.blocks;
+	mbx->out.skipped = program.skipped;
+	mbx->out.next = program.next * block_size;
+	mbx->out.map_count = 0;
+	if (status != APPLET_SUCCESS || (flags & APPLET_PROGRAM_END)) {
+		mbx->out.map_count = program_write_map();
+		program.active = false;
+	}
+
+	return status;
+}
+
 /*----------------------------------------------------------------------------
  *         Commands list
  *----------------------------------------------------------------------------*/
@@ -562,5 +776,16 @@ const struct applet_command applet_commands[] = {
 	{ APPLET_CMD_ERASE_PAGES, handle_cmd_erase_pages },
 	{ APPLET_CMD_READ_PAGES, handle_cmd_read_pages },
 	{ APPLET_CMD_WRITE_PAGES, handle_cmd_write_pages },
+	{ APPLET_CMD_INIT_SLOTS, applet_handle_cmd_init_slots },
+	{ APPLET_CMD_RUN_SLOTS, applet_handle_cmd_run_slots },
+	{ APPLET_CMD_HASH_PAGES, applet_handle_cmd_hash_pages },
+	{ APPLET_CMD_UPDATE_PAGES, applet_handle_cmd_update_pages },
+	{ APPLET_CMD_WRITE_STREAM, applet_handle_cmd_write_stream },
+	{ APPLET_CMD_PROGRAM_BLOCKS, handle_cmd_program_blocks },
 	{ 0, NULL }
 };
+
+const struct applet_media_ops applet_media_ops = {
+	.read = read_pages,
+	.write = write_pages,
+};
@@ -444,15 +444,9 @@ static uint32_t handle_cmd_read_info(uint32_t cmd, uint32_t *mailbox)
 	return APPLET_SUCCESS;
 }
 
-static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
+static uint32_t write_pages(uint8_t *buf, uint32_t offset, uint32_t length,
+		uint32_t *pages)
 {
-	union read_write_erase_pages_mailbox *mbx =
-		(union read_write_erase_pages_mailbox*)mailbox;
-	uint32_t offset = mbx->in.offset;
-	uint32_t length = mbx->in.length;
-
-	assert(cmd == APPLET_CMD_WRITE_PAGES);
-
 	/* check that requested size does not overflow buffer */
 	if ((length * BLOCK_SIZE) > buffer_size) {
 		trace_error("Buffer overflow\r\n");
@@ -465,31 +459,25 @@ static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
 		return APPLET_FAIL;
 	}
 
-	if (SD_Write(&lib, offset, buffer, length, NULL, NULL) != SDMMC_OK) {
+	if (SD_Write(&lib, offset, buf, length, NULL, NULL) != SDMMC_OK) {
 		trace_error("Error while writing %u bytes at offset 0x%08x\r\n",
-				(unsigned)(mbx->in.length * BLOCK_SIZE),
-				(unsigned)(mbx->in.offset * BLOCK_SIZE));
-		mbx->out.pages = 0;
+				(unsigned)(length * BLOCK_SIZE),
+				(unsigned)(offset * BLOCK_SIZE));
+		*pages = 0;
 		return APPLET_READ_FAIL;
 	}
 
 	trace_info_wp("Wrote %u bytes at offset 0x%08x\r\n",
-			(unsigned)(mbx->in.length * BLOCK_SIZE),
-			(unsigned)(mbx->in.offset * BLOCK_SIZE));
-	mbx->out.pages = mbx->in.length;
+			(unsigned)(length * BLOCK_SIZE),
+			(unsigned)(offset * BLOCK_SIZE));
+	*pages = length;
 
 	return APPLET_SUCCESS;
 }
 
-static uint32_t handle_cmd_read_pages(uint32_t cmd, uint32_t *mailbox)
+static uint32_t read_pages(uint8_t *buf, uint32_t offset, uint32_t length,
+		uint32_t *pages)
 {
-	union read_write_erase_pages_mailbox *mbx =
-		(union read_write_erase_pages_mailbox*)mailbox;
-	uint32_t offset = mbx->in.offset;
-	uint32_t length = mbx->in.length;
-
-	assert(cmd == APPLET_CMD_READ_PAGES);
-
 	/* check that requested size does not overflow buffer */
 	if ((length * BLOCK_SIZE) > buffer_size) {
 		trace_error("Buffer overflow\r\n");
@@ -502,22 +490,44 @@ static uint32_t handle_cmd_read_pages(uint32_t cmd, uint32_t *mailbox)
 		return APPLET_FAIL;
 	}
 
-	if (SD_Read(&lib, offset, buffer, length, NULL, NULL) != SDMMC_OK) {
+	if (SD_Read(&lib, offset, buf, length, NULL, NULL) != SDMMC_OK) {
 		trace_error("Error while reading %u bytes at offset 0x%08x\r\n",
-				(unsigned)(mbx->in.length * BLOCK_SIZE),
-				(unsigned)(mbx->in.offset * BLOCK_SIZE));
-		mbx->out.pages = 0;
+				(unsigned)(length * BLOCK_SIZE),
+				(unsigned)(offset * BLOCK_SIZE));
+		*pages = 0;
 		return APPLET_READ_FAIL;
 	}
 
 	trace_info_wp("Read %u bytes at offset 0x%08x\r\n",
-			(unsigned)(mbx->in.length * BLOCK_SIZE),
-			(unsigned)(mbx->in.offset * BLOCK_SIZE));
-	mbx->out.pages = mbx->in.length;
+			(unsigned)(length * BLOCK_SIZE),
+			(unsigned)(offset * BLOCK_SIZE));
+	*pages = length;
 
 	return APPLET_SUCCESS;
 }
 
+static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
+{
+	union read_write_erase_pages_mailbox *mbx =
+		(union read_write_erase_pages_mailbox*)mailbox;
+
+	assert(cmd == APPLET_CMD_WRITE_PAGES);
+
+	return write_pages(buffer, mbx->in.offset, mbx->in.length,
+			&mbx->out.pages);
+}
+
+static uint32_t handle_cmd_read_pages(uint32_t cmd, uint32_t *mailbox)
+{
+	union read_write_erase_pages_mailbox *mbx =
+		(union read_write_erase_pages_mailbox*)mailbox;
+
+	assert(cmd == APPLET_CMD_READ_PAGES);
+
+	return read_pages(buffer, mbx->in.offset, mbx->in.length,
+			&mbx->out.pages);
+}
+
 
 /*----------------------------------------------------------------------------
  *         Commands list
@@ -528,5 +538,15 @@ const struct applet_command applet_commands[] = {
 	{ APPLET_CMD_READ_INFO, handle_cmd_read_info },
 	{ APPLET_CMD_WRITE_PAGES, handle_cmd_write_pages },
 	{ APPLET_CMD_READ_PAGES, handle_cmd_read_pages },
+	{ APPLET_CMD_INIT_SLOTS, applet_handle_cmd_init_slots },
+	{ APPLET_CMD_RUN_SLOTS, applet_handle_cmd_run_slots },
+	{ APPLET_CMD_HASH_PAGES, applet_handle_cmd_hash_pages },
+	{ APPLET_CMD_UPDATE_PAGES, applet_handle_cmd_update_pages },
+	{ APPLET_CMD_WRITE_STREAM, applet_handle_cmd_write_stream },
 	{ 0, NULL }
 };
+
+const struct applet_media_ops applet_media_ops = {
+	.read = read_pages,
+	.write = write_pages,
+};
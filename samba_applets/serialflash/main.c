@@ -243,67 +243,83 @@ static uint32_t handle_cmd_read_info(uint32_t cmd, uint32_t *mailbox)
 	return APPLET_SUCCESS;
 }
 
-static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
+static uint32_t write_pages(uint8_t *buf, uint32_t offset, uint32_t length,
+		uint32_t *pages)
 {
-	union read_write_erase_pages_mailbox *mbx =
-		(union read_write_erase_pages_mailbox*)mailbox;
-	uint32_t offset = mbx->in.offset * at25drv.desc->page_size;
-	uint32_t length = mbx->in.length * at25drv.desc->page_size;
-
-	assert(cmd == APPLET_CMD_WRITE_PAGES);
+	uint32_t offset_bytes = offset * at25drv.desc->page_size;
+	uint32_t length_bytes = length * at25drv.desc->page_size;
 
 	/* check that requested size does not overflow buffer */
-	if (length > buffer_size) {
+	if (length_bytes > buffer_size) {
 		trace_error("Buffer overflow\r\n");
 		return APPLET_FAIL;
 	}
 
 	/* perform the write operation */
-	if (at25_write(&at25drv, offset, buffer, length) < 0) {
+	if (at25_write(&at25drv, offset_bytes, buf, length_bytes) < 0) {
 		trace_error("Write error\r\n");
-		mbx->out.pages = 0;
+		*pages = 0;
 		return APPLET_WRITE_FAIL;
 	}
 	at25_wait(&at25drv);
 
 	trace_info_wp("Wrote %u bytes at 0x%08x\r\n",
-			(unsigned)length, (unsigned)offset);
+			(unsigned)length_bytes, (unsigned)offset_bytes);
 
-	mbx->out.pages = mbx->in.length;
+	*pages = length;
 
 	return APPLET_SUCCESS;
 }
 
-static uint32_t handle_cmd_read_pages(uint32_t cmd, uint32_t *mailbox)
+static uint32_t read_pages(uint8_t *buf, uint32_t offset, uint32_t length,
+		uint32_t *pages)
 {
-	union read_write_erase_pages_mailbox *mbx =
-		(union read_write_erase_pages_mailbox*)mailbox;
-	uint32_t offset = mbx->in.offset * at25drv.desc->page_size;
-	uint32_t length = mbx->in.length * at25drv.desc->page_size;
-
-	assert(cmd == APPLET_CMD_READ_PAGES);
+	uint32_t offset_bytes = offset * at25drv.desc->page_size;
+	uint32_t length_bytes = length * at25drv.desc->page_size;
 
 	/* check that requested size does not overflow buffer */
-	if (length > buffer_size) {
+	if (length_bytes > buffer_size) {
 		trace_error("Buffer overflow\r\n");
 		return APPLET_FAIL;
 	}
 
 	/* perform the read operation */
-	if (at25_read(&at25drv, offset, buffer, length) < 0) {
+	if (at25_read(&at25drv, offset_bytes, buf, length_bytes) < 0) {
 		trace_error("Read error\r\n");
-		mbx->out.pages = 0;
+		*pages = 0;
 		return APPLET_READ_FAIL;
 	}
 
 	trace_info_wp("Read %u bytes at 0x%08x\r\n",
-			(unsigned)length, (unsigned)offset);
+			(unsigned)length_bytes, (unsigned)offset_bytes);
 
-	mbx->out.pages = mbx->in.length;
+	*pages = length;
 
 	return APPLET_SUCCESS;
 }
 
+static uint32_t handle_cmd_write_pages(uint32_t cmd, uint32_t *mailbox)
+{
+	union read_write_erase_pages_mailbox *mbx =
+		(union read_write_erase_pages_mailbox*)mailbox;
+
+	assert(cmd == APPLET_CMD_WRITE_PAGES);
+
+	return write_pages(buffer, mbx->in.offset, mbx->in.length,
+			&mbx->out.pages);
+}
+
+static uint32_t handle_cmd_read_pages(uint32_t cmd, uint32_t *mailbox)
+{
+	union read_write_erase_pages_mailbox *mbx =
+		(union read_write_erase_pages_mailbox*)mailbox;
+
+	assert(cmd == APPLET_CMD_READ_PAGES);
+
+	return read_pages(buffer, mbx->in.offset, mbx->in.length,
+			&mbx->out.pages);
+}
+
 static uint32_t handle_cmd_erase_pages(uint32_t cmd, uint32_t *mailbox)
 {
 	union read_write_erase_pages_mailbox *mbx =
@@ -359,5 +375,15 @@ const struct applet_command applet_commands[] = {
 	{ APPLET_CMD_ERASE_PAGES, handle_cmd_erase_pages },
 	{ APPLET_CMD_READ_PAGES, handle_cmd_read_pages },
 	{ APPLET_CMD_WRITE_PAGES, handle_cmd_write_pages },
+	{ APPLET_CMD_INIT_SLOTS, applet_handle_cmd_init_slots },
+	{ APPLET_CMD_RUN_SLOTS, applet_handle_cmd_run_slots },
+	{ APPLET_CMD_HASH_PAGES, applet_handle_cmd_hash_pages },
+	{ APPLET_CMD_UPDATE_PAGES, applet_handle_cmd_update_pages },
+	{ APPLET_CMD_WRITE_STREAM, applet_handle_cmd_write_stream },
 	{ 0, NULL }
 };
+
+const struct applet_media_ops applet_media_ops = {
+	.read = read_pages,
+	.write = write_pages,
+};
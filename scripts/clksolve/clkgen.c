@@ -0,0 +1,275 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host tool generating clock configuration tables with the clock-tree solver
+ * (drivers/power/clksolve.c). Build it with the host compiler:
+ *
+ *   cc -DCLKSOLVE_HOST -I../../drivers -o clkgen clkgen.c ../../drivers/power/clksolve.c
+ *
+ * Usage: clkgen [-s soc] [-m main_hz] [-t tolerance_ppm] spec...
+ *
+ *   cpu:NAME:PCK[:MCK]    struct pck_mck_cfg NAME using PLLA
+ *   audio:NAME:PMC[:PAD]  struct _pmc_audio_cfg NAME (PMC or PAD may be 0)
+ *   gck:NAME:FREQ[:MAX]   NAME_GCK_SOURCE/NAME_GCK_DIV macros, selecting
+ *                         among the slow, main and UPLL clocks and the PLLA,
+ *                         master and audio clocks of the previous specs
+ *
+ * Example, for the CLASSD DSP clocks of the 48 kHz and 44.1 kHz families
+ * and a 12.288 MHz I2S master clock on SAMA5D2:
+ *
+ *   ./clkgen -s sama5d2 -t 10 cpu:clk_498:498000000:166000000 \
+ *       audio:audio_48k:98304000:12288000 gck:i2s:12288000 \
+ *       audio:audio_44k1:90316800
+ *
+ * The C source is written on stdout. The frequencies are recomputed from the
+ * emitted register values, the same way as the PMC driver does, and the tool
+ * fails if one of them is not within the tolerance.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "power/clksolve.h"
+
+#define SLOW_CLOCK 32768
+#define UPLL_CLOCK 480000000
+
+static const char* _gck_sources[CLKSOLVE_GCK_SOURCES] = {
+	"PMC_PCR_GCKCSS_SLOW_CLK", "PMC_PCR_GCKCSS_MAIN_CLK",
+	"PMC_PCR_GCKCSS_PLLA_CLK", "PMC_PCR_GCKCSS_UPLL_CLK",
+	"PMC_PCR_GCKCSS_MCK_CLK", "PMC_PCR_GCKCSS_AUDIO_CLK",
+};
+
+static const char* _pres_name(uint32_t pres)
+{
+	switch (pres) {
+	case 2: return "PMC_MCKR_PRES_CLOCK_DIV2";
+	case 3: return "PMC_MCKR_PRES_CLOCK_DIV3";
+	case 4: return "PMC_MCKR_PRES_CLOCK_DIV4";
+	case 8: return "PMC_MCKR_PRES_CLOCK_DIV8";
+	case 16: return "PMC_MCKR_PRES_CLOCK_DIV16";
+	case 32: return "PMC_MCKR_PRES_CLOCK_DIV32";
+	case 64: return "PMC_MCKR_PRES_CLOCK_DIV64";
+	default: return "PMC_MCKR_PRES_CLOCK";
+	}
+}
+
+static const char* _mdiv_name(uint32_t mdiv)
+{
+	switch (mdiv) {
+	case 2: return "PMC_MCKR_MDIV_PCK_DIV2";
+	case 3: return "PMC_MCKR_MDIV_PCK_DIV3";
+	case 4: return "PMC_MCKR_MDIV_PCK_DIV4";
+	default: return "PMC_MCKR_MDIV_EQ_PCK";
+	}
+}
+
+static int _check(const char* name, const char* clock, uint64_t freq,
+		uint32_t target, uint32_t tolerance)
+{
+	uint32_t err;
+
+	if (target == 0)
+		return 0;
+	err = clksolve_error_ppm(freq, target);
+	if (err <= tolerance)
+		return 0;
+	fprintf(stderr, "%s: %s %llu Hz is %u ppm from %u Hz (tolerance %u ppm)\n",
+		name, clock, (unsigned long long)freq, err, target, tolerance);
+	return -ERANGE;
+}
+
+static void _upper(char* dst, const char* src, size_t size)
+{
+	size_t i;
+
+	for (i = 0; src[i] && i < size - 1; i++)
+		dst[i] = (src[i] >= 'a' && src[i] <= 'z') ? src[i] - 'a' + 'A' : src[i];
+	dst[i] = 0;
+}
+
+int main(int argc, char** argv)
+{
+	const struct _clksolve_soc* soc = clksolve_get_soc("sama5d2");
+	uint32_t main_freq = 12000000;
+	uint32_t tolerance = 0;
+	uint32_t sources[CLKSOLVE_GCK_SOURCES] = { SLOW_CLOCK, 0, 0, UPLL_CLOCK, 0, 0 };
+	int opt, i, err = 0;
+
+	for (opt = 1; opt < argc && argv[opt][0] == '-'; opt += 2) {
+		if (opt + 1 >= argc)
+			break;
+		if (!strcmp(argv[opt], "-s")) {
+			soc = clksolve_get_soc(argv[opt + 1]);
+			if (!soc) {
+				fprintf(stderr, "unknown device '%s'\n", argv[opt + 1]);
+				return 2;
+			}
+		} else if (!strcmp(argv[opt], "-m")) {
+			main_freq = strtoul(argv[opt + 1], NULL, 0);
+		} else if (!strcmp(argv[opt], "-t")) {
+			tolerance = strtoul(argv[opt + 1], NULL, 0);
+		} else {
+			break;
+		}
+	}
+	if (opt >= argc) {
+		fprintf(stderr, "usage: %s [-s soc] [-m main_hz] [-t tolerance_ppm] "
+			"cpu:NAME:PCK[:MCK] audio:NAME:PMC[:PAD] gck:NAME:FREQ[:MAX]...\n", argv[0]);
+		return 2;
+	}
+	sources[1] = main_freq;
+
+	printf("/* Generated by scripts/clksolve/clkgen for %s, main clock %u Hz */\n\n",
+	       soc->name, main_freq);
+
+	for (i = opt; i < argc; i++) {
+		char spec[128], macro[64];
+		char* kind = strtok(strncpy(spec, argv[i], sizeof(spec) - 1), ":");
+		char* name = strtok(NULL, ":");
+		char* f1 = strtok(NULL, ":");
+		char* f2 = strtok(NULL, ":");
+		uint32_t t1 = f1 ? strtoul(f1, NULL, 0) : 0;
+		uint32_t t2 = f2 ? strtoul(f2, NULL, 0) : 0;
+
+		spec[sizeof(spec) - 1] = 0;
+		if (!kind || !name || !f1) {
+			fprintf(stderr, "invalid spec '%s'\n", argv[i]);
+			return 2;
+		}
+
+		if (!strcmp(kind, "cpu")) {
+			struct _clksolve_cpu sol;
+			uint64_t pll, pck, mck;
+
+			if (clksolve_cpu(&soc->cpu, main_freq, t1, t2, tolerance, &sol) < 0) {
+				fprintf(stderr, "%s: no PLLA setting within %u ppm\n", name, tolerance);
+				err = 1;
+				continue;
+			}
+
+			/* recompute from the register values */
+			pll = (uint64_t)main_freq * (sol.mul + 1) / sol.div;
+			pck = pll / (sol.div2 ? 2 : 1) / sol.pres;
+			mck = pck / sol.mdiv;
+			if (pll < soc->cpu.pll_min || pll > soc->cpu.pll_max ||
+			    pck > soc->cpu.pck_max || mck > soc->cpu.mck_max) {
+				fprintf(stderr, "%s: solution out of the device limits\n", name);
+				err = 1;
+			}
+			if (_check(name, "PCK", pck, t1, tolerance) ||
+			    _check(name, "MCK", mck, t2, tolerance))
+				err = 1;
+
+			printf("/* PLLA = %u * %u / %u = %llu Hz, PCK = %llu Hz (%u ppm), MCK = %llu Hz (%u ppm) */\n",
+			       main_freq, sol.mul + 1, sol.div, (unsigned long long)pll,
+			       (unsigned long long)pck, sol.pck_error,
+			       (unsigned long long)mck, sol.mck_error);
+			printf("const struct pck_mck_cfg %s = {\n", name);
+			printf("\t.pck_input = PMC_MCKR_CSS_PLLA_CLK,\n");
+			printf("\t.ext12m = true,\n");
+			printf("\t.plla = {\n");
+			printf("\t\t.mul = %u,\n\t\t.div = %u,\n\t\t.count = 0x3f,\n", sol.mul, sol.div);
+			printf("#ifdef CONFIG_HAVE_PMC_PLLA_CHARGE_PUMP\n\t\t.icp = 3,\n#endif\n");
+			printf("\t},\n");
+			printf("\t.pck_pres = %s,\n", _pres_name(sol.pres));
+			printf("\t.mck_div = %s,\n", _mdiv_name(sol.mdiv));
+			printf("#ifdef CONFIG_HAVE_PMC_PLLADIV2\n\t.plla_div2 = %s,\n#endif\n",
+			       sol.div2 ? "true" : "false");
+			printf("#ifdef CONFIG_HAVE_PMC_H32MXDIV\n\t.h32mx_div2 = %s,\n#endif\n",
+			       sol.h32mx_div2 ? "true" : "false");
+			printf("};\n\n");
+
+			sources[2] = (uint32_t)(pll / (sol.div2 ? 2 : 1));
+			sources[4] = (uint32_t)mck;
+		} else if (!strcmp(kind, "audio")) {
+			struct _clksolve_audio sol;
+			uint64_t vco, pmc, pad;
+
+			if (!soc->audio) {
+				fprintf(stderr, "%s: %s has no audio PLL\n", name, soc->name);
+				return 2;
+			}
+			if (clksolve_audio(soc->audio, main_freq, t1, t2, tolerance, &sol) < 0) {
+				fprintf(stderr, "%s: no audio PLL setting within %u ppm\n", name, tolerance);
+				err = 1;
+				continue;
+			}
+
+			/* same computation as pmc_get_audio_pmc_clock() */
+			vco = ((uint64_t)main_freq * (((uint64_t)(sol.nd + 1) << CLKSOLVE_AUDIO_FRACR_BITS) + sol.fracr))
+				>> CLKSOLVE_AUDIO_FRACR_BITS;
+			pmc = vco / (sol.qdpmc + 1);
+			pad = sol.qdaudio ? vco / (sol.div * sol.qdaudio) : 0;
+			if (vco < soc->audio->vco_min || vco > soc->audio->vco_max) {
+				fprintf(stderr, "%s: VCO out of range\n", name);
+				err = 1;
+			}
+			if (_check(name, "PMC clock", pmc, t1, tolerance) ||
+			    _check(name, "pad clock", pad, t2, tolerance))
+				err = 1;
+
+			printf("/* VCO = %llu Hz, PMC = %llu Hz (%u ppm), pad = %llu Hz (%u ppm) */\n",
+			       (unsigned long long)vco, (unsigned long long)pmc, sol.pmc_error,
+			       (unsigned long long)pad, sol.pad_error);
+			printf("#ifdef CONFIG_HAVE_PMC_AUDIO_CLOCK\n");
+			printf("const struct _pmc_audio_cfg %s = {\n", name);
+			printf("\t.nd = %u,\n\t.fracr = %u,\n\t.qdpmc = %u,\n\t.div = %u,\n\t.qdaudio = %u,\n",
+			       sol.nd, sol.fracr, sol.qdpmc, sol.div, sol.qdaudio);
+			printf("};\n#endif\n\n");
+
+			sources[5] = (uint32_t)pmc;
+		} else if (!strcmp(kind, "gck")) {
+			struct _clksolve_gck sol;
+			uint32_t max = t2 ? t2 : UINT32_MAX;
+
+			if (clksolve_gck(sources, max, t1, tolerance, &sol) < 0) {
+				fprintf(stderr, "%s: no generated clock setting within %u ppm\n", name, tolerance);
+				err = 1;
+				continue;
+			}
+			if (_check(name, "GCK", sources[sol.source] / sol.div, t1, tolerance))
+				err = 1;
+
+			_upper(macro, name, sizeof(macro));
+			printf("/* GCK = %u / %u = %u Hz (%u ppm) */\n",
+			       sources[sol.source], sol.div, sol.freq, sol.error);
+			printf("#define %s_GCK_SOURCE %s\n", macro, _gck_sources[sol.source]);
+			printf("#define %s_GCK_DIV %u\n\n", macro, sol.div);
+		} else {
+			fprintf(stderr, "unknown spec kind '%s'\n", kind);
+			return 2;
+		}
+	}
+
+	return err;
+}
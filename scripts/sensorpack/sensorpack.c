@@ -0,0 +1,442 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host tool converting the struct sensor_reg arrays of an image sensor
+ * configuration file (drivers/video/xxx_config.c) into packed tables (see
+ * drivers/video/sensor_pack.h). Build it with the host compiler:
+ *
+ *   cc -I../../drivers -o sensorpack sensorpack.c ../../drivers/video/sensor_pack.c
+ *
+ * Usage: sensorpack [-r REG:VAL] [-d MS] [-f FLAGS] file.c > packed.c
+ *
+ *   -r REG:VAL  the write REG = VAL is the sensor software reset
+ *   -d MS       wait MS milliseconds after the reset, unless the table
+ *               already has a delay there
+ *   -f FLAGS    flags of the sensor profile (default
+ *               "SENSOR_FLAG_BURST | SENSOR_FLAG_DIFF")
+ *
+ * The file is copied to stdout with each array replaced by a packed table:
+ * consecutive registers are merged into SENSOR_SEQ records, the {0xFFFF, MS}
+ * entries become SENSOR_DELAY records and the reset write a SENSOR_RESET
+ * record. Comments and blank lines are kept. The struct sensor_output
+ * initializers ending with a table get a NULL output_setting and the table
+ * as output_packed, and the struct sensor_profile gets a flags member after
+ * its output_conf array.
+ *
+ * Each packed table is decoded again and compared with the original array;
+ * the tool fails if they do not describe the same writes, in the same
+ * order. Sizes are reported on stderr.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "video/sensor_pack.h"
+
+#define MAX_ITEMS   8192
+#define MAX_LINE    512
+#define MAX_TABLES  32
+
+#define DELAY_REG   0xFFFF
+#define TERM_REG    0xFF
+#define TERM_VAL    0xFF
+
+struct item {
+	bool text;
+	char line[MAX_LINE];
+	unsigned reg, val;
+};
+
+static struct item items[MAX_ITEMS];
+static unsigned item_count;
+
+static uint8_t packed[4 * MAX_ITEMS];
+static unsigned packed_size;
+
+static char tables[MAX_TABLES][MAX_LINE];
+static unsigned table_count;
+
+static bool has_reset;
+static unsigned reset_reg, reset_val;
+static unsigned reset_delay;
+static const char* profile_flags = "SENSOR_FLAG_BURST | SENSOR_FLAG_DIFF";
+
+static void emit_byte(uint8_t b)
+{
+	packed[packed_size++] = b;
+}
+
+static bool is_reset(const struct item* it)
+{
+	return has_reset && !it->text && it->reg == reset_reg
+		&& it->val == reset_val;
+}
+
+static bool is_special(const struct item* it)
+{
+	return it->text || it->reg == DELAY_REG || is_reset(it);
+}
+
+/* next entry after index i, or item_count */
+static unsigned next_entry(unsigned i)
+{
+	for (i++; i < item_count && items[i].text; i++);
+	return i;
+}
+
+static void print_text(const char* line)
+{
+	if (line[strspn(line, " \t")])
+		printf("%s\n", line);
+	else
+		printf("\n");
+}
+
+static void print_values(const unsigned* idx, unsigned count)
+{
+	unsigned i, col = 0;
+
+	for (i = 0; i < count; i++) {
+		const struct item* it = &items[idx[i]];
+
+		if (it->text) {
+			/* blank lines inside a run are dropped */
+			if (!it->line[strspn(it->line, " \t")])
+				continue;
+			if (col)
+				printf("\n");
+			printf("%s\n", it->line);
+			col = 0;
+			continue;
+		}
+		printf(col ? " 0x%02x," : "\t\t0x%02x,", it->val);
+		if (++col == 8) {
+			printf("\n");
+			col = 0;
+		}
+	}
+	if (col)
+		printf("\n");
+}
+
+static void pack_table(void)
+{
+	static unsigned run[MAX_ITEMS];
+	unsigned i = 0, j;
+
+	packed_size = 0;
+	while (i < item_count) {
+		struct item* it = &items[i];
+		unsigned run_len, count, last, pending;
+
+		if (it->text) {
+			print_text(it->line);
+			i++;
+			continue;
+		}
+		if (it->reg == DELAY_REG) {
+			printf("\tSENSOR_DELAY(%u),\n", it->val);
+			emit_byte(SENSOR_PACK_OP_DELAY);
+			emit_byte(it->val);
+			i++;
+			continue;
+		}
+		if (is_reset(it)) {
+			printf("\tSENSOR_RESET(0x%04x, 0x%02x),\n", it->reg, it->val);
+			emit_byte(SENSOR_PACK_OP_RESET);
+			emit_byte(it->reg >> 8);
+			emit_byte(it->reg & 0xff);
+			emit_byte(it->val);
+			j = next_entry(i);
+			if (reset_delay && (j == item_count
+					|| items[j].reg != DELAY_REG)) {
+				printf("\tSENSOR_DELAY(%u),\n", reset_delay);
+				emit_byte(SENSOR_PACK_OP_DELAY);
+				emit_byte(reset_delay);
+			}
+			i++;
+			continue;
+		}
+
+		/* sequential run, with the comments found inside */
+		run_len = 0;
+		run[run_len++] = i;
+		count = 1;
+		last = it->reg;
+		pending = 0;
+		for (j = i + 1; j < item_count && count < SENSOR_SEQ_MAX; j++) {
+			if (items[j].text) {
+				pending++;
+				continue;
+			}
+			if (is_special(&items[j]) || items[j].reg != last + 1)
+				break;
+			while (pending) {
+				run[run_len] = j - pending;
+				run_len++;
+				pending--;
+			}
+			run[run_len++] = j;
+			count++;
+			last = items[j].reg;
+		}
+
+		printf("\tSENSOR_SEQ(0x%04x, %u),", it->reg, count);
+		if (count <= 8 && run_len == count) {
+			for (j = 0; j < count; j++)
+				printf(" 0x%02x,", items[run[j]].val);
+			printf("\n");
+		} else {
+			printf("\n");
+			print_values(run, run_len);
+		}
+		emit_byte(count - 1);
+		emit_byte(it->reg >> 8);
+		emit_byte(it->reg & 0xff);
+		for (j = 0; j < run_len; j++)
+			if (!items[run[j]].text)
+				emit_byte(items[run[j]].val);
+
+		i = run[run_len - 1] + 1;
+	}
+	printf("\tSENSOR_END\n");
+	emit_byte(SENSOR_PACK_OP_END);
+}
+
+/* decode the packed table and compare it with the items */
+static bool check_table(const char* name)
+{
+	struct sensor_pack_rec rec;
+	const uint8_t* p = packed;
+	unsigned i = 0, k;
+
+	while (p) {
+		p = sensor_pack_next(p, &rec);
+		switch (rec.type) {
+		case SENSOR_PACK_SEQ:
+		case SENSOR_PACK_RESET:
+			for (k = 0; k < rec.count; k++) {
+				unsigned reg = rec.reg + k;
+
+				while (i < item_count && items[i].text)
+					i++;
+				if (i == item_count || items[i].reg != reg
+				    || items[i].val != rec.data[k]
+				    || is_reset(&items[i])
+					!= (rec.type == SENSOR_PACK_RESET)) {
+					fprintf(stderr, "%s: mismatch at register 0x%04x\n",
+						name, reg);
+					return false;
+				}
+				i++;
+			}
+			break;
+		case SENSOR_PACK_DELAY:
+			while (i < item_count && items[i].text)
+				i++;
+			if (i < item_count && items[i].reg == DELAY_REG
+			    && items[i].val == rec.count) {
+				i++;
+				break;
+			}
+			/* inserted after the reset */
+			if (i && rec.count == reset_delay)
+				break;
+			fprintf(stderr, "%s: unexpected delay\n", name);
+			return false;
+		default:
+			break;
+		}
+	}
+	while (i < item_count && items[i].text)
+		i++;
+	if (i != item_count) {
+		fprintf(stderr, "%s: missing writes\n", name);
+		return false;
+	}
+	if (sensor_pack_size(packed) != packed_size) {
+		fprintf(stderr, "%s: size mismatch\n", name);
+		return false;
+	}
+
+	return true;
+}
+
+/* "{ ..., name };" initializer of a struct sensor_output: insert the NULL
+ * output_setting before the packed table */
+static bool print_output(const char* line)
+{
+	unsigned i;
+
+	for (i = 0; i < table_count; i++) {
+		const char* end = strstr(line, tables[i]);
+		size_t len = strlen(tables[i]);
+
+		if (!end || end == line || end[-1] != ' '
+		    || strncmp(end + len, " }", 2))
+			continue;
+		printf("%.*s0, %s\n", (int)(end - line), line, end);
+		return true;
+	}
+	return false;
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: sensorpack [-r REG:VAL] [-d MS] [-f FLAGS] file.c\n");
+	exit(2);
+}
+
+int main(int argc, char** argv)
+{
+	char line[MAX_LINE];
+	char name[MAX_LINE];
+	bool in_table = false;
+	bool in_profile = false;
+	unsigned entries = 0;
+	unsigned total_in = 0, total_out = 0;
+	FILE* f;
+	int i;
+
+	for (i = 1; i < argc - 1; i++) {
+		if (!strcmp(argv[i], "-r") && i + 1 < argc - 1) {
+			if (sscanf(argv[++i], "%i:%i", &reset_reg, &reset_val) != 2)
+				usage();
+			has_reset = true;
+		} else if (!strcmp(argv[i], "-d") && i + 1 < argc - 1) {
+			reset_delay = strtoul(argv[++i], NULL, 0);
+			if (!reset_delay || reset_delay > 255)
+				usage();
+		} else if (!strcmp(argv[i], "-f") && i + 1 < argc - 1) {
+			profile_flags = argv[++i];
+		} else {
+			usage();
+		}
+	}
+	if (i != argc - 1)
+		usage();
+
+	f = fopen(argv[i], "r");
+	if (!f) {
+		perror(argv[i]);
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), f)) {
+		char* start;
+		unsigned reg, val;
+		int n;
+
+		line[strcspn(line, "\r\n")] = 0;
+
+		if (!in_table) {
+			start = strstr(line, "static const struct sensor_reg ");
+			if (start && strstr(line, "[] = {")) {
+				sscanf(start, "static const struct sensor_reg %[A-Za-z0-9_]",
+					name);
+				printf("static const uint8_t %s[] = {\n", name);
+				in_table = true;
+				item_count = 0;
+				entries = 0;
+			} else if (in_profile && !strcmp(line + strspn(line, "\t "), "}")) {
+				/* end of output_conf, the last member before flags */
+				printf("%s,\n\t%s,  /* flags */\n", line, profile_flags);
+				in_profile = false;
+			} else if (!print_output(line)) {
+				if (strstr(line, "const struct sensor_profile "))
+					in_profile = true;
+				printf("%s\n", line);
+			}
+			continue;
+		}
+
+		if (!strncmp(line, "};", 2)) {
+			pack_table();
+			printf("%s\n", line);
+			if (!check_table(name))
+				return 1;
+			if (table_count == MAX_TABLES) {
+				fprintf(stderr, "%s: too many tables\n", name);
+				return 1;
+			}
+			strcpy(tables[table_count++], name);
+			fprintf(stderr, "%s: %u writes, %u bytes -> %u bytes\n",
+				name, entries, 4 * (entries + 1), packed_size);
+			total_in += 4 * (entries + 1);
+			total_out += packed_size;
+			in_table = false;
+			continue;
+		}
+
+		if (item_count == MAX_ITEMS) {
+			fprintf(stderr, "%s: too many entries\n", name);
+			return 1;
+		}
+		if (sscanf(line, " { %i , %i } %n", &reg, &val, &n) == 2) {
+			const char* rest = line + n;
+
+			if (reg == TERM_REG && val == TERM_VAL)
+				continue;
+			if (val > 0xff || (reg > 0xffff)) {
+				fprintf(stderr, "%s: value 0x%x of register 0x%x"
+					" does not fit\n", name, val, reg);
+				return 1;
+			}
+			items[item_count].text = false;
+			items[item_count].reg = reg;
+			items[item_count].val = val;
+			item_count++;
+			entries++;
+
+			/* keep a comment following the entry */
+			rest += strspn(rest, ", \t");
+			if (*rest && item_count < MAX_ITEMS) {
+				items[item_count].text = true;
+				snprintf(items[item_count].line, MAX_LINE, "\t%s", rest);
+				item_count++;
+			}
+		} else {
+			items[item_count].text = true;
+			strcpy(items[item_count].line, line);
+			item_count++;
+		}
+	}
+	fclose(f);
+
+	if (in_table) {
+		fprintf(stderr, "%s: unterminated table\n", name);
+		return 1;
+	}
+	fprintf(stderr, "total: %u bytes -> %u bytes\n", total_in, total_out);
+
+	return 0;
+}
@@ -61,6 +61,17 @@
 /* Number of buffer for TX */
 #define ETH_TX_BUFFERS  8
 
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+/* Number of GMAC priority queues */
+#define ETH_PRIO_QUEUES (GMAC_QUEUE_COUNT - 1)
+
+/* Number of buffer for RX on each priority queue */
+#define ETH_PRIO_RX_BUFFERS  8
+
+/* Number of buffer for TX on each priority queue */
+#define ETH_PRIO_TX_BUFFERS  2
+#endif
+
 #ifndef BOARD_ETH0_PHY_IDLE_TIMEOUT
 #define BOARD_ETH0_PHY_IDLE_TIMEOUT PHY_DEFAULT_TIMEOUT_IDLE
 #endif
@@ -139,6 +150,27 @@ static uint8_t eth_rx_buffer[ETH_IFACE_COUNT][ETH_RX_BUFFERS * ETH_RX_UNITSIZE];
 /** TX callbacks list */
 static ethd_callback_t eth_tx_callback[ETH_IFACE_COUNT][ETH_TX_BUFFERS];
 
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+/** TX descriptors list for priority queues */
+ALIGNED(8) NOT_CACHED
+static struct _eth_desc eth_prio_txd[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_TX_BUFFERS];
+
+/** RX descriptors list for priority queues */
+ALIGNED(8) NOT_CACHED
+static struct _eth_desc eth_prio_rxd[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_RX_BUFFERS];
+
+/** TX Buffers for priority queues */
+CACHE_ALIGNED_DDR
+static uint8_t eth_prio_tx_buffer[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_TX_BUFFERS * ETH_TX_UNITSIZE];
+
+/** RX Buffers for priority queues */
+CACHE_ALIGNED_DDR
+static uint8_t eth_prio_rx_buffer[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_RX_BUFFERS * ETH_RX_UNITSIZE];
+
+/** TX callbacks list for priority queues */
+static ethd_callback_t eth_prio_tx_callback[ETH_IFACE_COUNT][ETH_PRIO_QUEUES][ETH_PRIO_TX_BUFFERS];
+#endif
+
 /*----------------------------------------------------------------------------
  *        Local functions
  *----------------------------------------------------------------------------*/
@@ -155,6 +187,9 @@ void board_cfg_net(uint8_t iface, uint8_t* mac_addr, bool block)
 {
 #ifdef CONFIG_HAVE_ETH
 	uint8_t _eth_mac_addr[6];
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+	int i;
+#endif
 
 	/* Init ethernet interface */
 	switch (iface) {
@@ -212,6 +247,16 @@ void board_cfg_net(uint8_t iface, uint8_t* mac_addr, bool block)
 	ethd_setup_queue(&_ethd[iface], 0, ETH_RX_BUFFERS, eth_rx_buffer[iface], eth_rxd[iface],
 			 ETH_TX_BUFFERS, eth_tx_buffer[iface], eth_txd[iface], eth_tx_callback[iface]);
 	ethd_set_rx_callback(&_ethd[iface], 0, _eth_rx_callback);
+#ifdef CONFIG_HAVE_GMAC_QUEUES
+	/* Priority queues only receive frames steered by the screeners */
+	for (i = 0; i < ETH_PRIO_QUEUES; i++) {
+		ethd_setup_queue(&_ethd[iface], i + 1,
+				 ETH_PRIO_RX_BUFFERS, eth_prio_rx_buffer[iface][i], eth_prio_rxd[iface][i],
+				 ETH_PRIO_TX_BUFFERS, eth_prio_tx_buffer[iface][i], eth_prio_txd[iface][i],
+				 eth_prio_tx_callback[iface][i]);
+		ethd_set_rx_callback(&_ethd[iface], i + 1, _eth_rx_callback);
+	}
+#endif
 	ethd_set_mac_addr(&_ethd[iface], 0, _eth_mac_addr);
 	ethd_start(&_ethd[iface]);
 
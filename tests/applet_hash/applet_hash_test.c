@@ -0,0 +1,555 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of APPLET_CMD_HASH_PAGES and APPLET_CMD_UPDATE_PAGES. The
+ * applet runs on a memory-backed media: NOR-like (4 KiB and 64 KiB erase,
+ * programming can only clear bits) or without erase (pages overwritten).
+ * Hashes are checked against a bitwise CRC-32 and known SHA-256 digests,
+ * per range and per block. Updates are checked against the image written,
+ * the units erased and programmed and the mailbox counts, then alignment,
+ * buffer and media errors. Without erase, the media must be compared in
+ * chunks as large as the free buffer space.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "applet.h"
+#include "trace.h"
+
+#include "host_test.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated applet environment
+ *----------------------------------------------------------------------------*/
+
+#define PAGE_SIZE 256
+#define MEDIA_PAGES 4096
+#define BUFFER_SIZE (64 * 1024)
+
+/* 4 KiB and 64 KiB erase */
+#define NOR_ERASE (16 | 256)
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+/* applet buffer, addressable by the 32-bit mailbox fields */
+static uint8_t buffer[BUFFER_SIZE] __attribute__((aligned(4)));
+static uint32_t buffer_size = BUFFER_SIZE;
+
+static uint8_t media[MEDIA_PAGES * PAGE_SIZE];
+static uint32_t erase_support = NOR_ERASE;
+
+static unsigned reads, read_pages, writes, write_pages, erases;
+static int fail_read_at = -1, fail_write_at = -1, fail_erase_at = -1;
+
+/* stand-in for applet_main.c: the READ_INFO handler of the applet */
+bool applet_get_info(union initialize_mailbox* info)
+{
+	info->out.buf_addr = (uint32_t)buffer;
+	info->out.buf_size = buffer_size;
+	info->out.page_size = PAGE_SIZE;
+	info->out.mem_size = MEDIA_PAGES;
+	info->out.erase_support = erase_support;
+	info->out.nand_header = 0;
+	return true;
+}
+
+static uint32_t media_read(uint8_t* buf, uint32_t offset, uint32_t length,
+		uint32_t* pages)
+{
+	*pages = 0;
+	REQUIRE(offset <= MEDIA_PAGES && length <= MEDIA_PAGES - offset);
+	REQUIRE(buf >= buffer && buf + length * PAGE_SIZE <= buffer + buffer_size);
+	if ((int)reads++ == fail_read_at)
+		return APPLET_READ_FAIL;
+	memcpy(buf, media + offset * PAGE_SIZE, length * PAGE_SIZE);
+	read_pages += length;
+	*pages = length;
+	return APPLET_SUCCESS;
+}
+
+static uint32_t media_write(uint8_t* buf, uint32_t offset, uint32_t length,
+		uint32_t* pages)
+{
+	uint32_t i;
+
+	*pages = 0;
+	REQUIRE(offset <= MEDIA_PAGES && length <= MEDIA_PAGES - offset);
+	if ((int)writes++ == fail_write_at) {
+		/* half of the pages went through */
+		length /= 2;
+		memcpy(media + offset * PAGE_SIZE, buf, length * PAGE_SIZE);
+		*pages = length;
+		return APPLET_WRITE_FAIL;
+	}
+	for (i = 0; i < length * PAGE_SIZE; i++) {
+		if (erase_support)
+			media[offset * PAGE_SIZE + i] &= buf[i];
+		else
+			media[offset * PAGE_SIZE + i] = buf[i];
+	}
+	write_pages += length;
+	*pages = length;
+	return APPLET_SUCCESS;
+}
+
+const struct applet_media_ops applet_media_ops = {
+	.read = media_read,
+	.write = media_write,
+};
+
+static uint32_t handle_cmd_erase_pages(uint32_t cmd, uint32_t *args)
+{
+	union read_write_erase_pages_mailbox *mbx =
+		(union read_write_erase_pages_mailbox*)args;
+
+	REQUIRE(cmd == APPLET_CMD_ERASE_PAGES);
+	REQUIRE(mbx->in.length & erase_support);
+	REQUIRE(mbx->in.offset % mbx->in.length == 0);
+	REQUIRE(mbx->in.offset + mbx->in.length <= MEDIA_PAGES);
+	if ((int)erases++ == fail_erase_at)
+		return APPLET_ERASE_FAIL;
+	memset(media + mbx->in.offset * PAGE_SIZE, 0xff,
+			mbx->in.length * PAGE_SIZE);
+	mbx->out.pages = mbx->in.length;
+	return APPLET_SUCCESS;
+}
+
+applet_command_handler_t get_applet_command_handler(uint8_t cmd)
+{
+	return cmd == APPLET_CMD_ERASE_PAGES ? handle_cmd_erase_pages : NULL;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static uint8_t pattern(uint32_t addr)
+{
+	return (uint8_t)(addr * 31 + (addr >> 8));
+}
+
+static void fill_pattern(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < sizeof(media); i++)
+		media[i] = pattern(i);
+}
+
+static void reset_counts(void)
+{
+	reads = read_pages = writes = write_pages = erases = 0;
+	fail_read_at = fail_write_at = fail_erase_at = -1;
+}
+
+/* bitwise CRC-32 (IEEE 802.3) */
+static uint32_t ref_crc32(const uint8_t* data, uint32_t len)
+{
+	uint32_t crc = 0xffffffff;
+	int k;
+
+	while (len--) {
+		crc ^= *data++;
+		for (k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+	}
+	return ~crc;
+}
+
+static uint32_t media_crc(uint32_t offset, uint32_t length)
+{
+	return ref_crc32(media + offset * PAGE_SIZE, length * PAGE_SIZE);
+}
+
+static uint32_t hash_pages(union hash_pages_mailbox* mbx, uint32_t offset,
+		uint32_t length, uint32_t algo, uint32_t block)
+{
+	memset(mbx, 0xa5, sizeof(*mbx));
+	mbx->in.offset = offset;
+	mbx->in.length = length;
+	mbx->in.algo = algo;
+	mbx->in.block = block;
+	return applet_handle_cmd_hash_pages(APPLET_CMD_HASH_PAGES,
+			(uint32_t*)mbx);
+}
+
+static uint32_t update_pages(union update_pages_mailbox* mbx,
+		const uint8_t* image, uint32_t offset, uint32_t length)
+{
+	memcpy(buffer, image + offset * PAGE_SIZE, length * PAGE_SIZE);
+	memset(mbx, 0xa5, sizeof(*mbx));
+	mbx->in.offset = offset;
+	mbx->in.length = length;
+	return applet_handle_cmd_update_pages(APPLET_CMD_UPDATE_PAGES,
+			(uint32_t*)mbx);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_hash_crc32(void)
+{
+	union hash_pages_mailbox mbx;
+	int i;
+
+	fill_pattern();
+	for (i = 0; i < 200; i++) {
+		uint32_t length = 1 + rnd() % (i % 10 ? 40 : 1024);
+		uint32_t offset = rnd() % (MEDIA_PAGES - length + 1);
+
+		/* down to a single page of buffer */
+		buffer_size = PAGE_SIZE * (1 + rnd() % (BUFFER_SIZE / PAGE_SIZE));
+		reset_counts();
+		CHECK(hash_pages(&mbx, offset, length, APPLET_HASH_CRC32, 0) ==
+				APPLET_SUCCESS);
+		CHECK(mbx.out.pages == length);
+		CHECK(mbx.out.count == 1);
+		CHECK(mbx.out.hash[0] == media_crc(offset, length));
+		CHECK(mbx.out.hash[1] == 0 && mbx.out.hash[7] == 0);
+		CHECK(read_pages == length);
+		CHECK(reads == (length + buffer_size / PAGE_SIZE - 1) /
+				(buffer_size / PAGE_SIZE));
+	}
+	buffer_size = BUFFER_SIZE;
+}
+
+static void test_hash_sha256(void)
+{
+	static const struct {
+		uint32_t offset, length;
+		const char* digest;
+	} vectors[] = {
+		{ 3, 5, "98ad89eabb11b835c908bef0bb441b6e"
+			"8a543103e9ce34bb2e151065a76d5b04" },
+		{ 0, 64, "83a5ee9c1db0b82ae94961fee75a195f"
+			"6104c65235c07590569657709c1316e8" },
+		{ 100, 1, "4acfbabdf531f6449d76a99bfe618be0"
+			"62a6be0f54cd366ddcdf5fe7e7e2a9ba" },
+	};
+	union hash_pages_mailbox mbx;
+	unsigned i, k;
+
+	fill_pattern();
+	for (i = 0; i < ARRAY_SIZE(vectors); i++) {
+		uint8_t digest[32];
+
+		for (k = 0; k < 32; k++) {
+			unsigned byte;
+
+			sscanf(vectors[i].digest + 2 * k, "%2x", &byte);
+			digest[k] = byte;
+		}
+		/* whole buffer, then a few pages at a time */
+		buffer_size = BUFFER_SIZE;
+		CHECK(hash_pages(&mbx, vectors[i].offset, vectors[i].length,
+				APPLET_HASH_SHA256, 0) == APPLET_SUCCESS);
+		CHECK(memcmp(mbx.out.hash, digest, 32) == 0);
+		buffer_size = 3 * PAGE_SIZE;
+		CHECK(hash_pages(&mbx, vectors[i].offset, vectors[i].length,
+				APPLET_HASH_SHA256, 0) == APPLET_SUCCESS);
+		CHECK(memcmp(mbx.out.hash, digest, 32) == 0);
+		CHECK(mbx.out.pages == vectors[i].length);
+	}
+	buffer_size = BUFFER_SIZE;
+}
+
+static void test_hash_blocks(void)
+{
+	union hash_pages_mailbox mbx, whole;
+	uint32_t i, n;
+
+	fill_pattern();
+	for (i = 0; i < 100; i++) {
+		uint32_t algo = i & 1 ? APPLET_HASH_SHA256 : APPLET_HASH_CRC32;
+		uint32_t size = algo == APPLET_HASH_SHA256 ? 32 : 4;
+		uint32_t length = 1 + rnd() % 600;
+		uint32_t offset = rnd() % (MEDIA_PAGES - length + 1);
+		uint32_t block = 1 + rnd() % (i % 4 ? 20 : 700);
+		uint32_t count = (length + block - 1) / block;
+		uint8_t list[600 * 32];
+
+		buffer_size = PAGE_SIZE * (8 + rnd() % 100);
+		if (count * size + PAGE_SIZE > buffer_size)
+			buffer_size = (count * size / PAGE_SIZE + 2) * PAGE_SIZE;
+		memset(buffer, 0x5a, sizeof(buffer));
+		CHECK(hash_pages(&mbx, offset, length, algo, block) ==
+				APPLET_SUCCESS);
+		CHECK(mbx.out.pages == length);
+		CHECK(mbx.out.count == count);
+		memcpy(list, buffer, count * size);
+
+		/* each entry is the hash of its block alone, the last
+		 * block being partial */
+		buffer_size = BUFFER_SIZE;
+		for (n = 0; n < count; n++) {
+			uint32_t blk = n < count - 1 ? block :
+				length - (count - 1) * block;
+
+			CHECK(hash_pages(&whole, offset + n * block, blk, algo,
+					0) == APPLET_SUCCESS);
+			CHECK(memcmp(list + n * size, whole.out.hash, size) == 0);
+		}
+	}
+	buffer_size = BUFFER_SIZE;
+}
+
+static void test_hash_errors(void)
+{
+	union hash_pages_mailbox mbx;
+
+	fill_pattern();
+	reset_counts();
+	CHECK(hash_pages(&mbx, 0, 16, 2, 0) == APPLET_FAIL);
+	CHECK(reads == 0);
+
+	/* no room for a page after a list of more than 4 KiB */
+	buffer_size = 17 * PAGE_SIZE;
+	CHECK(hash_pages(&mbx, 0, 1024, APPLET_HASH_CRC32, 1) == APPLET_SUCCESS);
+	CHECK(mbx.out.count == 1024);
+	CHECK(hash_pages(&mbx, 0, 1025, APPLET_HASH_CRC32, 1) == APPLET_FAIL);
+	CHECK(hash_pages(&mbx, 0, 128, APPLET_HASH_SHA256, 1) == APPLET_SUCCESS);
+	CHECK(hash_pages(&mbx, 0, 129, APPLET_HASH_SHA256, 1) == APPLET_FAIL);
+	buffer_size = PAGE_SIZE - 4;
+	CHECK(hash_pages(&mbx, 0, 1, APPLET_HASH_CRC32, 0) == APPLET_FAIL);
+	CHECK(reads == 1024 + 128);
+
+	/* read error: pages and hashes done before it */
+	buffer_size = 4 * PAGE_SIZE;
+	reset_counts();
+	fail_read_at = 5;
+	CHECK(hash_pages(&mbx, 10, 40, APPLET_HASH_CRC32, 6) ==
+			APPLET_READ_FAIL);
+	CHECK(mbx.out.pages == 12 + 3);
+	CHECK(mbx.out.count == 2);
+	reset_counts();
+	fail_read_at = 2;
+	CHECK(hash_pages(&mbx, 10, 40, APPLET_HASH_SHA256, 0) ==
+			APPLET_READ_FAIL);
+	CHECK(mbx.out.pages == 8);
+	CHECK(mbx.out.count == 0);
+	buffer_size = BUFFER_SIZE;
+}
+
+static void test_update_erase(void)
+{
+	static uint8_t image[MEDIA_PAGES * PAGE_SIZE];
+	union update_pages_mailbox mbx;
+	uint32_t off, len, i, written, skipped, changed;
+
+	erase_support = NOR_ERASE;
+	fill_pattern();
+	memcpy(image, media, sizeof(image));
+
+	/* a sector changed, a page in another one, a bit in a third */
+	image[20 * 4096 + 100] ^= 0x5a;
+	for (i = 0; i < 4096; i++)
+		image[33 * 4096 + i] = ~image[33 * 4096 + i];
+	image[34 * 4096 + 4095] ^= 1;
+	/* random changes over the second half */
+	for (i = 0; i < 40; i++)
+		image[(128 + rnd() % 128) * 4096 + rnd() % 4096] ^= 0x80;
+	for (i = 0, changed = 0; i < MEDIA_PAGES / 16; i++)
+		if (memcmp(media + i * 4096, image + i * 4096, 4096))
+			changed++;
+
+	/* update by 240 pages (15 sectors), the last chunk partial */
+	reset_counts();
+	written = skipped = 0;
+	for (off = 0; off < MEDIA_PAGES; off += len) {
+		len = MEDIA_PAGES - off < 240 ? MEDIA_PAGES - off : 240;
+		CHECK(update_pages(&mbx, image, off, len) == APPLET_SUCCESS);
+		CHECK(mbx.out.pages + mbx.out.skipped == len);
+		written += mbx.out.pages;
+		skipped += mbx.out.skipped;
+	}
+	CHECK(memcmp(media, image, sizeof(image)) == 0);
+	CHECK(erases == changed);
+	CHECK(written == changed * 16);
+	CHECK(write_pages == written);
+	CHECK(skipped == MEDIA_PAGES - written);
+	/* consecutive changed sectors are written at once */
+	CHECK(writes < changed);
+
+	/* nothing left to do */
+	reset_counts();
+	for (off = 0; off < MEDIA_PAGES; off += len) {
+		len = MEDIA_PAGES - off < 240 ? MEDIA_PAGES - off : 240;
+		CHECK(update_pages(&mbx, image, off, len) == APPLET_SUCCESS);
+		CHECK(mbx.out.pages == 0 && mbx.out.skipped == len);
+	}
+	CHECK(erases == 0 && writes == 0);
+	CHECK(read_pages == MEDIA_PAGES);
+
+	/* a compare with less than a sector of free buffer space reads the
+	 * sector in several chunks */
+	buffer_size = 16 * PAGE_SIZE + 3 * PAGE_SIZE;
+	reset_counts();
+	CHECK(update_pages(&mbx, image, 32, 16) == APPLET_SUCCESS);
+	CHECK(mbx.out.pages == 0 && mbx.out.skipped == 16);
+	CHECK(reads == 6 && read_pages == 16);
+	image[2 * 4096 + 4000] ^= 4;
+	CHECK(update_pages(&mbx, image, 32, 16) == APPLET_SUCCESS);
+	CHECK(mbx.out.pages == 16 && mbx.out.skipped == 0);
+	CHECK(memcmp(media, image, sizeof(image)) == 0);
+	buffer_size = BUFFER_SIZE;
+}
+
+static void test_update_no_erase(void)
+{
+	static uint8_t image[MEDIA_PAGES * PAGE_SIZE];
+	union update_pages_mailbox mbx;
+	uint32_t i, n, length, offset, free_pages, expected;
+	bool diff[200];
+
+	erase_support = 0;
+	for (n = 0; n < 300; n++) {
+		length = 1 + rnd() % 200;
+		offset = rnd() % (MEDIA_PAGES - length + 1);
+		buffer_size = PAGE_SIZE * (length + 1 + rnd() % (n % 3 ? 16 : 256));
+		if (buffer_size > BUFFER_SIZE)
+			buffer_size = BUFFER_SIZE;
+		free_pages = buffer_size / PAGE_SIZE - length;
+
+		fill_pattern();
+		memcpy(image, media, sizeof(image));
+		expected = 0;
+		for (i = 0; i < length; i++) {
+			diff[i] = rnd() % 4 == 0 || (n % 5 == 0 && rnd() % 2);
+			if (diff[i]) {
+				image[(offset + i) * PAGE_SIZE + rnd() % PAGE_SIZE] ^=
+					1 + rnd() % 255;
+				expected++;
+			}
+		}
+
+		reset_counts();
+		CHECK(update_pages(&mbx, image, offset, length) ==
+				APPLET_SUCCESS);
+		CHECK(memcmp(media, image, sizeof(image)) == 0);
+		CHECK(mbx.out.pages == expected);
+		CHECK(mbx.out.skipped == length - expected);
+		CHECK(write_pages == expected);
+		CHECK(erases == 0);
+		/* the media is read once, in chunks filling the free space */
+		CHECK(read_pages == length);
+		CHECK(reads == (length + free_pages - 1) / free_pages);
+		/* one write per run of changed pages */
+		for (i = 0, expected = 0; i < length; i++)
+			if (diff[i] && (i == 0 || !diff[i - 1]))
+				expected++;
+		CHECK(writes == expected);
+	}
+	buffer_size = BUFFER_SIZE;
+	erase_support = NOR_ERASE;
+}
+
+static void test_update_errors(void)
+{
+	static uint8_t image[MEDIA_PAGES * PAGE_SIZE];
+	union update_pages_mailbox mbx;
+
+	erase_support = NOR_ERASE;
+	fill_pattern();
+	memcpy(image, media, sizeof(image));
+	reset_counts();
+
+	CHECK(update_pages(&mbx, image, 8, 16) == APPLET_ALIGN_ERROR);
+	CHECK(update_pages(&mbx, image, 16, 24) == APPLET_ALIGN_ERROR);
+	/* no room for a page after the data */
+	CHECK(update_pages(&mbx, image, 0, 256) == APPLET_FAIL);
+	CHECK(update_pages(&mbx, image, 0, 240) == APPLET_SUCCESS);
+	CHECK(writes == 0 && erases == 0);
+
+	/* sectors 1 and 2 changed: erase error on the second one */
+	image[1 * 4096] ^= 1;
+	image[2 * 4096] ^= 1;
+	reset_counts();
+	fail_erase_at = 1;
+	CHECK(update_pages(&mbx, image, 0, 64) == APPLET_ERASE_FAIL);
+	CHECK(mbx.out.pages == 0 && mbx.out.skipped == 32);
+	reset_counts();
+	fail_write_at = 0;
+	CHECK(update_pages(&mbx, image, 0, 64) == APPLET_WRITE_FAIL);
+	CHECK(mbx.out.pages == 16 && mbx.out.skipped == 32);
+	reset_counts();
+	fail_read_at = 3;
+	CHECK(update_pages(&mbx, image, 0, 64) == APPLET_READ_FAIL);
+	CHECK(mbx.out.pages == 0 && mbx.out.skipped == 32);
+	CHECK(update_pages(&mbx, image, 0, 64) == APPLET_SUCCESS);
+	CHECK(memcmp(media, image, sizeof(image)) == 0);
+
+	/* without erase, read and write errors */
+	erase_support = 0;
+	image[5 * PAGE_SIZE] ^= 1;
+	image[6 * PAGE_SIZE] ^= 1;
+	image[9 * PAGE_SIZE] ^= 1;
+	image[10 * PAGE_SIZE] ^= 1;
+	buffer_size = 16 * PAGE_SIZE;
+	reset_counts();
+	fail_read_at = 2;
+	CHECK(update_pages(&mbx, image, 0, 12) == APPLET_READ_FAIL);
+	CHECK(mbx.out.pages == 2 && mbx.out.skipped == 6);
+	reset_counts();
+	fail_write_at = 0;
+	CHECK(update_pages(&mbx, image, 0, 12) == APPLET_WRITE_FAIL);
+	CHECK(mbx.out.pages == 1 && mbx.out.skipped == 10);
+	CHECK(update_pages(&mbx, image, 0, 12) == APPLET_SUCCESS);
+	CHECK(mbx.out.pages == 1 && mbx.out.skipped == 11);
+	CHECK(memcmp(media, image, sizeof(image)) == 0);
+	buffer_size = BUFFER_SIZE;
+	erase_support = NOR_ERASE;
+}
+
+int main(void)
+{
+	test_hash_crc32();
+	test_hash_sha256();
+	test_hash_blocks();
+	test_hash_errors();
+	test_update_erase();
+	test_update_no_erase();
+	test_update_errors();
+	return host_test_end("applet_hash");
+}
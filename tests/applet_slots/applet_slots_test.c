@@ -0,0 +1,558 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the applet slot protocol (APPLET_CMD_INIT_SLOTS and
+ * APPLET_CMD_RUN_SLOTS). The applet runs on a memory-backed media. The
+ * host is simulated from the media accesses and from the timeout polls of
+ * the applet: it fills and posts slots while the applet programs another
+ * one, as a JTAG host would, and only ever touches FREE, DONE or ERROR
+ * slots. The test checks the image written, the order of the requests,
+ * the slot states seen by the host and the mailbox results, then batches,
+ * reads, errors, timeouts and invalid slots.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "applet.h"
+#include "timer.h"
+#include "trace.h"
+
+#include "host_test.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated applet environment
+ *----------------------------------------------------------------------------*/
+
+#define PAGE_SIZE 512
+#define MEDIA_PAGES 4096
+#define BUFFER_SIZE (64 * 1024)
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+static uint64_t now_ms;
+
+/* applet buffer, addressable by the 32-bit mailbox fields */
+static uint8_t buffer[BUFFER_SIZE] __attribute__((aligned(4)));
+static uint32_t buffer_size = BUFFER_SIZE;
+
+static uint8_t media[MEDIA_PAGES * PAGE_SIZE];
+static unsigned media_accesses;
+static int fail_at = -1;
+
+/* host side, called while the applet works or waits */
+static void (*host_step)(void);
+
+void timer_start_timeout(struct _timeout* timeout, uint64_t count)
+{
+	timeout->start = now_ms;
+	timeout->count = count;
+}
+
+uint8_t timer_timeout_reached(struct _timeout* timeout)
+{
+	now_ms++;
+	if (host_step)
+		host_step();
+	return now_ms - timeout->start >= timeout->count;
+}
+
+/* stand-in for applet_main.c: the READ_INFO handler of the applet */
+bool applet_get_info(union initialize_mailbox* info)
+{
+	info->out.buf_addr = (uint32_t)buffer;
+	info->out.buf_size = buffer_size;
+	info->out.page_size = PAGE_SIZE;
+	info->out.mem_size = MEDIA_PAGES;
+	info->out.erase_support = 0;
+	info->out.nand_header = 0;
+	return true;
+}
+
+static uint32_t media_access(uint8_t* buf, uint32_t offset, uint32_t length,
+		uint32_t* pages, bool write)
+{
+	*pages = 0;
+	if (offset > MEDIA_PAGES || length > MEDIA_PAGES - offset)
+		return APPLET_FAIL;
+	if (host_step)
+		host_step();
+	if ((int)media_accesses++ == fail_at) {
+		/* half of the pages went through */
+		*pages = length / 2;
+		return write ? APPLET_WRITE_FAIL : APPLET_READ_FAIL;
+	}
+	if (write)
+		memcpy(media + offset * PAGE_SIZE, buf, length * PAGE_SIZE);
+	else
+		memcpy(buf, media + offset * PAGE_SIZE, length * PAGE_SIZE);
+	*pages = length;
+	/* programming takes time, the host goes on meanwhile */
+	if (host_step)
+		host_step();
+	return APPLET_SUCCESS;
+}
+
+static uint32_t media_read(uint8_t* buf, uint32_t offset, uint32_t length,
+		uint32_t* pages)
+{
+	return media_access(buf, offset, length, pages, false);
+}
+
+static uint32_t media_write(uint8_t* buf, uint32_t offset, uint32_t length,
+		uint32_t* pages)
+{
+	return media_access(buf, offset, length, pages, true);
+}
+
+const struct applet_media_ops applet_media_ops = {
+	.read = media_read,
+	.write = media_write,
+};
+
+/*----------------------------------------------------------------------------
+ *        Simulated host
+ *----------------------------------------------------------------------------*/
+
+static uint32_t mailbox[32];
+
+static struct applet_slot* slots;
+static uint8_t* slot_data[APPLET_MAX_SLOTS];
+static uint32_t slot_count;
+static uint32_t slot_pages;
+
+static uint8_t image[MEDIA_PAGES * PAGE_SIZE];
+
+/* streaming state */
+static struct {
+	uint32_t pages;         /* image size */
+	uint32_t offset;        /* next page to post */
+	uint32_t next;          /* next slot to fill */
+	uint32_t posted;        /* requests posted */
+	uint32_t period;        /* host steps between two posts */
+	uint32_t wait;
+	bool stopped;
+	bool error;             /* a slot failed */
+	unsigned busy_seen;     /* steps seeing a slot busy */
+	unsigned violations;
+} host;
+
+static uint32_t init_slots(uint32_t count)
+{
+	union init_slots_mailbox* mbx = (union init_slots_mailbox*)mailbox;
+	uint32_t status, i;
+
+	memset(mailbox, 0xee, sizeof(mailbox));
+	mbx->in.count = count;
+	status = applet_handle_cmd_init_slots(APPLET_CMD_INIT_SLOTS, mailbox);
+	if (status != APPLET_SUCCESS)
+		return status;
+	slots = (struct applet_slot*)(uintptr_t)mbx->out.table_addr;
+	slot_count = mbx->out.count;
+	slot_pages = mbx->out.slot_pages;
+	for (i = 0; i < APPLET_MAX_SLOTS; i++)
+		slot_data[i] = (uint8_t*)(uintptr_t)mbx->out.slot_addr[i];
+	return status;
+}
+
+static uint32_t run_slots(uint32_t count, uint32_t timeout)
+{
+	union run_slots_mailbox* mbx = (union run_slots_mailbox*)mailbox;
+
+	memset(mailbox, 0xee, sizeof(mailbox));
+	mbx->in.count = count;
+	mbx->in.timeout = timeout;
+	return applet_handle_cmd_run_slots(APPLET_CMD_RUN_SLOTS, mailbox);
+}
+
+static bool host_can_fill(uint32_t status)
+{
+	return status == APPLET_SLOT_FREE || status == APPLET_SLOT_DONE ||
+		status == APPLET_SLOT_ERROR;
+}
+
+static void post(uint32_t index, uint32_t request, uint32_t offset,
+		uint32_t length)
+{
+	slots[index].offset = offset;
+	slots[index].length = length;
+	slots[index].status = request;
+}
+
+/* streams the image, one post every host.period steps */
+static void stream_step(void)
+{
+	struct applet_slot* s = &slots[host.next];
+	uint32_t i, busy = 0, n;
+
+	for (i = 0; i < slot_count; i++)
+		if (slots[i].status == APPLET_SLOT_BUSY)
+			busy++;
+	if (busy)
+		host.busy_seen++;
+	if (busy > 1)
+		host.violations++;
+
+	if (host.stopped || host.wait++ < host.period)
+		return;
+	host.wait = 0;
+	if (!host_can_fill(s->status))
+		return;
+	if (s->status == APPLET_SLOT_ERROR) {
+		host.error = true;
+		return;
+	}
+	if (host.offset == host.pages) {
+		/* everything posted: stop once all requests are done */
+		for (i = 0; i < slot_count; i++)
+			if (!host_can_fill(slots[i].status))
+				return;
+		s->status = APPLET_SLOT_STOP;
+		host.stopped = true;
+		return;
+	}
+	n = host.pages - host.offset;
+	if (n > slot_pages)
+		n = slot_pages;
+	memcpy(slot_data[host.next], image + host.offset * PAGE_SIZE,
+			n * PAGE_SIZE);
+	post(host.next, APPLET_SLOT_WRITE, host.offset, n);
+	host.offset += n;
+	host.posted++;
+	host.next = (host.next + 1) % slot_count;
+}
+
+static void stream_start(uint32_t pages, uint32_t period)
+{
+	memset(&host, 0, sizeof(host));
+	host.pages = pages;
+	host.period = period;
+	host_step = stream_step;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static void fill_random(uint8_t* p, uint32_t size)
+{
+	uint32_t i;
+
+	for (i = 0; i < size; i++)
+		p[i] = rnd();
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_init(void)
+{
+	union init_slots_mailbox* mbx = (union init_slots_mailbox*)mailbox;
+	uint32_t count, i, table = APPLET_MAX_SLOTS * sizeof(struct applet_slot);
+
+	CHECK(sizeof(struct applet_slot) == 32);
+	CHECK(init_slots(0) == APPLET_FAIL);
+	CHECK(init_slots(1) == APPLET_FAIL);
+	CHECK(init_slots(APPLET_MAX_SLOTS + 1) == APPLET_FAIL);
+	/* not initialized */
+	CHECK(run_slots(1, 10) == APPLET_FAIL);
+
+	for (count = 2; count <= APPLET_MAX_SLOTS; count++) {
+		memset(buffer, 0x5a, sizeof(buffer));
+		REQUIRE(init_slots(count) == APPLET_SUCCESS);
+		CHECK(mbx->out.table_addr == (uint32_t)buffer);
+		CHECK(mbx->out.count == count);
+		CHECK(slot_pages == (BUFFER_SIZE - table) / count / PAGE_SIZE);
+		for (i = 0; i < APPLET_MAX_SLOTS; i++) {
+			if (i >= count) {
+				CHECK(slot_data[i] == NULL);
+				continue;
+			}
+			/* after the table, in order, not overlapping */
+			CHECK(slot_data[i] == buffer + table + i * slot_pages * PAGE_SIZE);
+			CHECK(slot_data[i] + slot_pages * PAGE_SIZE <= buffer + BUFFER_SIZE);
+		}
+		for (i = 0; i < APPLET_MAX_SLOTS; i++)
+			CHECK(slots[i].status == APPLET_SLOT_FREE);
+	}
+
+	/* a failed initialization leaves no slots */
+	post(0, APPLET_SLOT_WRITE, 0, 1);
+	CHECK(init_slots(APPLET_MAX_SLOTS + 1) == APPLET_FAIL);
+	CHECK(run_slots(1, 10) == APPLET_FAIL);
+	CHECK(slots[0].status == APPLET_SLOT_WRITE);
+
+	/* not even a page per slot */
+	buffer_size = 4 * sizeof(struct applet_slot);
+	CHECK(init_slots(2) == APPLET_FAIL);
+	buffer_size = APPLET_MAX_SLOTS * sizeof(struct applet_slot) + 2 * PAGE_SIZE - 1;
+	CHECK(init_slots(2) == APPLET_FAIL);
+	CHECK(run_slots(1, 10) == APPLET_FAIL);
+	buffer_size = APPLET_MAX_SLOTS * sizeof(struct applet_slot) + 2 * PAGE_SIZE;
+	CHECK(init_slots(2) == APPLET_SUCCESS);
+	CHECK(slot_pages == 1);
+	buffer_size = BUFFER_SIZE;
+}
+
+static void test_stream(void)
+{
+	union run_slots_mailbox* mbx = (union run_slots_mailbox*)mailbox;
+	static const uint32_t periods[] = { 0, 1, 7 };
+	uint32_t count, p, pages;
+
+	for (count = 2; count <= APPLET_MAX_SLOTS; count++)
+		for (p = 0; p < sizeof(periods) / sizeof(periods[0]); p++) {
+			pages = MEDIA_PAGES - 1 - rnd() % 100;
+			fill_random(image, pages * PAGE_SIZE);
+			memset(media, 0xff, sizeof(media));
+			REQUIRE(init_slots(count) == APPLET_SUCCESS);
+			stream_start(pages, periods[p]);
+			media_accesses = 0;
+
+			CHECK(run_slots(0, 1000) == APPLET_SUCCESS);
+			host_step = NULL;
+			CHECK(host.stopped && !host.error);
+			CHECK(host.violations == 0);
+			/* the host worked while the applet was busy */
+			CHECK(host.busy_seen > 0);
+			CHECK(memcmp(media, image, pages * PAGE_SIZE) == 0);
+			CHECK(media[pages * PAGE_SIZE] == 0xff);
+			CHECK(mbx->out.count == host.posted);
+			CHECK(media_accesses == host.posted);
+			CHECK(mbx->out.pages == pages);
+			/* the stop slot is not consumed */
+			CHECK(mbx->out.next == host.next);
+			CHECK(slots[host.next].status == APPLET_SLOT_FREE);
+		}
+}
+
+static void test_batch(void)
+{
+	union run_slots_mailbox* mbx = (union run_slots_mailbox*)mailbox;
+	uint32_t i, k;
+
+	REQUIRE(init_slots(3) == APPLET_SUCCESS);
+	memset(media, 0xff, sizeof(media));
+	fill_random(image, 6 * slot_pages * PAGE_SIZE);
+
+	/* all slots posted before the command, no timeout needed */
+	for (k = 0; k < 2; k++) {
+		for (i = 0; i < 3; i++) {
+			uint32_t offset = (3 * k + i) * slot_pages;
+
+			memcpy(slot_data[i], image + offset * PAGE_SIZE,
+					slot_pages * PAGE_SIZE);
+			post(i, APPLET_SLOT_WRITE, offset, slot_pages);
+		}
+		now_ms = 0;
+		CHECK(run_slots(3, 0) == APPLET_SUCCESS);
+		CHECK(now_ms == 0);
+		CHECK(mbx->out.count == 3);
+		CHECK(mbx->out.pages == 3 * slot_pages);
+		CHECK(mbx->out.next == 0);
+		for (i = 0; i < 3; i++) {
+			CHECK(slots[i].status == APPLET_SLOT_DONE);
+			CHECK(slots[i].pages == slot_pages);
+			CHECK(slots[i].error == APPLET_SUCCESS);
+		}
+	}
+	CHECK(memcmp(media, image, 6 * slot_pages * PAGE_SIZE) == 0);
+
+	/* the ring goes on from one command to the next */
+	post(0, APPLET_SLOT_READ, slot_pages, 2);
+	post(1, APPLET_SLOT_READ, 4 * slot_pages, slot_pages);
+	memset(slot_data[0], 0, slot_pages * PAGE_SIZE);
+	CHECK(run_slots(1, 0) == APPLET_SUCCESS);
+	CHECK(mbx->out.count == 1 && mbx->out.pages == 2 && mbx->out.next == 1);
+	CHECK(memcmp(slot_data[0], image + slot_pages * PAGE_SIZE,
+			2 * PAGE_SIZE) == 0);
+	CHECK(slot_data[0][2 * PAGE_SIZE] == 0);
+	CHECK(slots[1].status == APPLET_SLOT_READ);
+	CHECK(run_slots(1, 0) == APPLET_SUCCESS);
+	CHECK(mbx->out.next == 2);
+	CHECK(memcmp(slot_data[1], image + 4 * slot_pages * PAGE_SIZE,
+			slot_pages * PAGE_SIZE) == 0);
+
+	/* a stop request right away */
+	post(2, APPLET_SLOT_STOP, 0, 0);
+	CHECK(run_slots(0, 0) == APPLET_SUCCESS);
+	CHECK(mbx->out.count == 0 && mbx->out.pages == 0 && mbx->out.next == 2);
+	CHECK(slots[2].status == APPLET_SLOT_FREE);
+}
+
+static void test_errors(void)
+{
+	union run_slots_mailbox* mbx = (union run_slots_mailbox*)mailbox;
+	uint32_t i;
+
+	/* write failure in the middle of a stream */
+	REQUIRE(init_slots(2) == APPLET_SUCCESS);
+	memset(media, 0xff, sizeof(media));
+	fill_random(image, MEDIA_PAGES * PAGE_SIZE);
+	stream_start(MEDIA_PAGES, 0);
+	media_accesses = 0;
+	fail_at = 5;
+	CHECK(run_slots(0, 1000) == APPLET_WRITE_FAIL);
+	host_step = NULL;
+	fail_at = -1;
+	CHECK(mbx->out.count == 6);
+	CHECK(mbx->out.pages == 5 * slot_pages + slot_pages / 2);
+	CHECK(mbx->out.next == 0);
+	CHECK(slots[1].status == APPLET_SLOT_ERROR);
+	CHECK(slots[1].error == APPLET_WRITE_FAIL);
+	CHECK(slots[1].pages == slot_pages / 2);
+	CHECK(slots[1].offset == 5 * slot_pages);
+	/* the request posted meanwhile is left to the host */
+	CHECK(slots[0].status == APPLET_SLOT_WRITE);
+	CHECK(memcmp(media, image, 5 * slot_pages * PAGE_SIZE) == 0);
+
+	/* media error */
+	REQUIRE(init_slots(2) == APPLET_SUCCESS);
+	post(0, APPLET_SLOT_READ, MEDIA_PAGES - 1, 2);
+	CHECK(run_slots(0, 10) == APPLET_FAIL);
+	CHECK(slots[0].status == APPLET_SLOT_ERROR);
+	CHECK(slots[0].error == APPLET_FAIL);
+	CHECK(mbx->out.count == 1 && mbx->out.next == 1);
+
+	/* slot overflow: the media is not accessed */
+	REQUIRE(init_slots(2) == APPLET_SUCCESS);
+	media_accesses = 0;
+	slots[0].pages = 7;
+	post(0, APPLET_SLOT_WRITE, 0, slot_pages + 1);
+	CHECK(run_slots(0, 10) == APPLET_FAIL);
+	CHECK(media_accesses == 0);
+	CHECK(slots[0].status == APPLET_SLOT_ERROR);
+	CHECK(slots[0].error == APPLET_FAIL);
+	CHECK(slots[0].pages == 0);
+	CHECK(mbx->out.count == 1 && mbx->out.pages == 0);
+
+	/* invalid status word, failing without waiting */
+	REQUIRE(init_slots(2) == APPLET_SUCCESS);
+	now_ms = 0;
+	slots[0].status = 0x1234;
+	CHECK(run_slots(0, 10) == APPLET_FAIL);
+	CHECK(mbx->out.count == 0 && mbx->out.next == 0);
+	CHECK(slots[0].status == 0x1234);
+	for (i = APPLET_SLOT_STOP + 1; i < APPLET_SLOT_BUSY; i++) {
+		slots[0].status = i;
+		CHECK(run_slots(0, 10) == APPLET_FAIL);
+	}
+	slots[0].status = APPLET_SLOT_BUSY;
+	CHECK(run_slots(0, 10) == APPLET_FAIL);
+	CHECK(now_ms == 0);
+}
+
+/* posts a stop request from another thread, as a JTAG host would */
+static void* late_stop(void* arg)
+{
+	usleep(20000);
+	slots[0].status = APPLET_SLOT_STOP;
+	return arg;
+}
+
+static void test_timeout(void)
+{
+	union run_slots_mailbox* mbx = (union run_slots_mailbox*)mailbox;
+	pthread_t thread;
+
+	/* nothing posted */
+	REQUIRE(init_slots(2) == APPLET_SUCCESS);
+	now_ms = 0;
+	CHECK(run_slots(0, 50) == APPLET_FAIL);
+	CHECK(now_ms == 50);
+	CHECK(mbx->out.count == 0);
+
+	/* DONE and ERROR slots are waited on too */
+	slots[0].status = APPLET_SLOT_DONE;
+	slots[1].status = APPLET_SLOT_ERROR;
+	now_ms = 0;
+	CHECK(run_slots(0, 20) == APPLET_FAIL);
+	CHECK(now_ms == 20);
+
+	/* the timeout is restarted by each request: a slow host posting
+	 * every 30 ms is served with a 50 ms timeout */
+	REQUIRE(init_slots(2) == APPLET_SUCCESS);
+	fill_random(image, 8 * slot_pages * PAGE_SIZE);
+	memset(media, 0xff, sizeof(media));
+	stream_start(8 * slot_pages, 30);
+	now_ms = 0;
+	CHECK(run_slots(0, 50) == APPLET_SUCCESS);
+	CHECK(now_ms > 50 * 8 / 2);
+	CHECK(mbx->out.count == 8);
+	CHECK(memcmp(media, image, 8 * slot_pages * PAGE_SIZE) == 0);
+
+	/* but not a host 60 ms late */
+	REQUIRE(init_slots(2) == APPLET_SUCCESS);
+	stream_start(8 * slot_pages, 60);
+	CHECK(run_slots(0, 50) == APPLET_FAIL);
+	CHECK(mbx->out.count == 0);
+	host_step = NULL;
+
+	/* no timeout: waits for a host running concurrently */
+	REQUIRE(init_slots(2) == APPLET_SUCCESS);
+	REQUIRE(pthread_create(&thread, NULL, late_stop, NULL) == 0);
+	CHECK(run_slots(0, 0) == APPLET_SUCCESS);
+	CHECK(mbx->out.count == 0);
+	pthread_join(thread, NULL);
+
+	/* the count is reached before the timeout */
+	REQUIRE(init_slots(4) == APPLET_SUCCESS);
+	stream_start(8 * slot_pages, 3);
+	CHECK(run_slots(5, 50) == APPLET_SUCCESS);
+	CHECK(mbx->out.count == 5);
+	CHECK(mbx->out.next == 1);
+	host_step = NULL;
+}
+
+int main(void)
+{
+	test_init();
+	test_stream();
+	test_batch();
+	test_errors();
+	test_timeout();
+	return host_test_end("applet_slots");
+}
@@ -0,0 +1,942 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of APPLET_CMD_WRITE_STREAM. Streams are fed in pieces of the
+ * buffer size, of random sizes and of 1 to 7 bytes to a memory-backed media
+ * in several configurations: NOR-like (programming clears bits), NAND-like
+ * (4 and 8 KiB pages), without erase (SD/MMC), and with buffers too small
+ * for the LZ4 window (SRAM variants). The media starts with random content
+ * and rejects programming a page that was not erased since its last write.
+ *
+ * Raw data and Android sparse images are generated here. The LZ4 frames in
+ * vec/ were made by the lz4 1.9.4 CLI from the same generated data
+ * ("make vectors"). The test checks the media content, the erased units,
+ * the pages left untouched, the mailbox counts, then errors and mutated
+ * streams.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "applet.h"
+#include "trace.h"
+
+#include "host_test.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated applet environment
+ *----------------------------------------------------------------------------*/
+
+#define MEDIA_SIZE (8 * 1024 * 1024)
+#define BUFFER_SIZE (1024 * 1024)
+#define MIN_PAGE_SIZE 256
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+struct media_cfg {
+	const char* name;
+	uint32_t page_size;
+	uint32_t erase_support;
+	uint32_t buf_size;
+};
+
+static const struct media_cfg cfgs[] = {
+	{ "nor", 256, 16 | 128 | 256, BUFFER_SIZE },
+	{ "sd", 512, 0, BUFFER_SIZE },
+	{ "nand4k", 4096, 64, BUFFER_SIZE },
+	{ "nand8k", 8192, 32, BUFFER_SIZE },
+	{ "sram-sd", 512, 0, 24 * 1024 },
+	{ "sram-nor", 256, 16, 20 * 1024 },
+};
+
+static const struct media_cfg* cfg;
+
+/* applet buffer, addressable by the 32-bit mailbox fields */
+static uint8_t buffer[BUFFER_SIZE] __attribute__((aligned(4)));
+
+static uint8_t media[MEDIA_SIZE];
+static uint8_t old[MEDIA_SIZE];
+
+/* per page: programmed since the last erase, times erased, times written */
+static uint8_t programmed[MEDIA_SIZE / MIN_PAGE_SIZE];
+static uint8_t erased[MEDIA_SIZE / MIN_PAGE_SIZE];
+static uint8_t written[MEDIA_SIZE / MIN_PAGE_SIZE];
+
+static unsigned write_pages, erase_pages, erase_cmds;
+static unsigned bad_writes, bad_erases;
+static int fail_write_at = -1, fail_erase_at = -1;
+
+static uint32_t media_pages(void)
+{
+	return MEDIA_SIZE / cfg->page_size;
+}
+
+/* stand-in for applet_main.c: the READ_INFO handler of the applet */
+bool applet_get_info(union initialize_mailbox* info)
+{
+	info->out.buf_addr = (uint32_t)buffer;
+	info->out.buf_size = cfg->buf_size;
+	info->out.page_size = cfg->page_size;
+	info->out.mem_size = media_pages();
+	info->out.erase_support = cfg->erase_support;
+	info->out.nand_header = 0;
+	return true;
+}
+
+static uint32_t media_read(uint8_t* buf, uint32_t offset, uint32_t length,
+		uint32_t* pages)
+{
+	(void)buf;
+	(void)offset;
+	(void)length;
+	(void)pages;
+	/* the stream never reads */
+	REQUIRE(false);
+	return APPLET_READ_FAIL;
+}
+
+static uint32_t media_write(uint8_t* buf, uint32_t offset, uint32_t length,
+		uint32_t* pages)
+{
+	uint32_t page_size = cfg->page_size;
+	uint32_t p, i;
+
+	*pages = 0;
+	REQUIRE(offset <= media_pages() && length <= media_pages() - offset);
+	REQUIRE(buf >= buffer && buf + length * page_size <= buffer + cfg->buf_size);
+	if (fail_write_at-- == 0)
+		return APPLET_WRITE_FAIL;
+	for (p = offset; p < offset + length; p++) {
+		uint8_t* dst = media + p * page_size;
+		const uint8_t* src = buf + (p - offset) * page_size;
+
+		if (cfg->erase_support) {
+			if (programmed[p])
+				bad_writes++;
+			for (i = 0; i < page_size; i++)
+				dst[i] &= src[i];
+		} else {
+			memcpy(dst, src, page_size);
+		}
+		programmed[p] = 1;
+		written[p]++;
+	}
+	write_pages += length;
+	*pages = length;
+	return APPLET_SUCCESS;
+}
+
+const struct applet_media_ops applet_media_ops = {
+	.read = media_read,
+	.write = media_write,
+};
+
+static uint32_t handle_cmd_erase_pages(uint32_t cmd, uint32_t *args)
+{
+	union read_write_erase_pages_mailbox *mbx =
+		(union read_write_erase_pages_mailbox*)args;
+	uint32_t offset = mbx->in.offset;
+	uint32_t length = mbx->in.length;
+	uint32_t p;
+
+	REQUIRE(cmd == APPLET_CMD_ERASE_PAGES);
+	if (!(length & cfg->erase_support) || (length & (length - 1)) ||
+	    offset % length || offset > media_pages() ||
+	    length > media_pages() - offset) {
+		bad_erases++;
+		return APPLET_ERASE_FAIL;
+	}
+	if (fail_erase_at-- == 0)
+		return APPLET_ERASE_FAIL;
+	memset(media + offset * cfg->page_size, 0xff, length * cfg->page_size);
+	for (p = offset; p < offset + length; p++) {
+		programmed[p] = 0;
+		erased[p]++;
+	}
+	erase_pages += length;
+	erase_cmds++;
+	mbx->out.pages = length;
+	return APPLET_SUCCESS;
+}
+
+applet_command_handler_t get_applet_command_handler(uint8_t cmd)
+{
+	if (cmd == APPLET_CMD_ERASE_PAGES && cfg->erase_support)
+		return handle_cmd_erase_pages;
+	return NULL;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/* content of the image bytes */
+enum {
+	DONT_CARE,
+	DATA,
+	FILL_FF,        /* 0xFFFFFFFF sparse fill */
+};
+
+struct image {
+	uint8_t* in;            /* stream */
+	size_t in_len;
+	uint8_t* img;           /* expected image */
+	uint8_t* mask;          /* DONT_CARE, DATA or FILL_FF per byte */
+	size_t len;
+	size_t in_size;
+	size_t size;
+};
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static void* xrealloc(void* p, size_t size)
+{
+	p = realloc(p, size ? size : 1);
+	REQUIRE(p);
+	return p;
+}
+
+/* semi-compressible data: words, matches at various distances, runs and
+ * random bytes */
+static void gen_data(uint8_t* buf, size_t len)
+{
+	static const char letters[] = "abcdefghij";
+	uint8_t words[64][10];
+	uint32_t lengths[64];
+	size_t pos = 0, i;
+	uint32_t r, n, d;
+
+	for (i = 0; i < 64; i++) {
+		lengths[i] = 2 + rnd() % 8;
+		for (n = 0; n < lengths[i]; n++)
+			words[i][n] = letters[rnd() % 10];
+	}
+	while (pos < len) {
+		r = rnd() % 100;
+		if (r < 50) {
+			i = rnd() % 64;
+			for (n = 0; n < lengths[i] && pos < len; n++)
+				buf[pos++] = words[i][n];
+			if (pos < len)
+				buf[pos++] = ' ';
+		} else if (r < 70 && pos > 70000) {
+			d = 1 + rnd() % 65535;
+			n = 4 + rnd() % 300;
+			for (; n && pos < len; n--, pos++)
+				buf[pos] = buf[pos - d];
+		} else if (r < 80) {
+			uint8_t c = rnd();
+
+			for (n = 1 + rnd() % 600; n && pos < len; n--)
+				buf[pos++] = c;
+		} else {
+			for (n = 1 + rnd() % 100; n && pos < len; n--)
+				buf[pos++] = rnd();
+		}
+	}
+}
+
+static void image_in(struct image* im, const void* p, size_t len)
+{
+	if (im->in_len + len > im->in_size) {
+		im->in_size = 2 * (im->in_len + len);
+		im->in = xrealloc(im->in, im->in_size);
+	}
+	memcpy(im->in + im->in_len, p, len);
+	im->in_len += len;
+}
+
+static void image_out(struct image* im, const uint8_t* p, uint8_t mask,
+		size_t len)
+{
+	if (im->len + len > im->size) {
+		im->size = 2 * (im->len + len);
+		im->img = xrealloc(im->img, im->size);
+		im->mask = xrealloc(im->mask, im->size);
+	}
+	if (!len)
+		return;
+	memcpy(im->img + im->len, p, len);
+	memset(im->mask + im->len, mask, len);
+	im->len += len;
+}
+
+static void image_free(struct image* im)
+{
+	free(im->in);
+	free(im->img);
+	free(im->mask);
+	memset(im, 0, sizeof(*im));
+}
+
+static void image_raw(struct image* im, size_t len)
+{
+	uint8_t* data = xrealloc(NULL, len);
+
+	gen_data(data, len);
+	image_in(im, data, len);
+	image_out(im, data, DATA, len);
+	free(data);
+}
+
+static void put_le16(uint8_t* p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t* p, uint32_t v)
+{
+	put_le16(p, v);
+	put_le16(p + 2, v >> 16);
+}
+
+/*
+ * Android sparse image builder. Header sizes larger than the standard ones
+ * are padded with zeros.
+ */
+
+struct sparse {
+	struct image* im;
+	uint32_t block_size;
+	uint32_t chunk_hdr_size;
+	uint32_t blocks;
+	uint32_t chunks;
+};
+
+static void sparse_start(struct sparse* sp, struct image* im,
+		uint32_t block_size, uint32_t file_hdr_size,
+		uint32_t chunk_hdr_size)
+{
+	uint8_t hdr[64] = { 0 };
+
+	sp->im = im;
+	sp->block_size = block_size;
+	sp->chunk_hdr_size = chunk_hdr_size;
+	sp->blocks = 0;
+	sp->chunks = 0;
+	put_le32(hdr, 0xed26ff3a);
+	put_le16(hdr + 4, 1);
+	put_le16(hdr + 8, file_hdr_size);
+	put_le16(hdr + 10, chunk_hdr_size);
+	put_le32(hdr + 12, block_size);
+	image_in(im, hdr, file_hdr_size);
+}
+
+static void sparse_chunk(struct sparse* sp, uint32_t type, uint32_t blocks,
+		uint32_t payload)
+{
+	uint8_t hdr[64] = { 0 };
+
+	put_le16(hdr, type);
+	put_le32(hdr + 4, blocks);
+	put_le32(hdr + 8, sp->chunk_hdr_size + payload);
+	image_in(sp->im, hdr, sp->chunk_hdr_size);
+	sp->chunks++;
+}
+
+static void sparse_raw(struct sparse* sp, uint32_t blocks)
+{
+	sparse_chunk(sp, 0xcac1, blocks, blocks * sp->block_size);
+	image_raw(sp->im, (size_t)blocks * sp->block_size);
+	sp->blocks += blocks;
+}
+
+static void sparse_fill(struct sparse* sp, uint32_t blocks, uint32_t value)
+{
+	uint8_t v[4];
+	uint32_t i;
+
+	sparse_chunk(sp, 0xcac2, blocks, 4);
+	put_le32(v, value);
+	image_in(sp->im, v, 4);
+	for (i = 0; i < blocks * sp->block_size / 4; i++)
+		image_out(sp->im, v, value == 0xffffffff ? FILL_FF : DATA, 4);
+	sp->blocks += blocks;
+}
+
+static void sparse_skip(struct sparse* sp, uint32_t blocks)
+{
+	uint8_t* ff = xrealloc(NULL, (size_t)blocks * sp->block_size);
+
+	sparse_chunk(sp, 0xcac3, blocks, 0);
+	memset(ff, 0xff, (size_t)blocks * sp->block_size);
+	image_out(sp->im, ff, DONT_CARE, (size_t)blocks * sp->block_size);
+	free(ff);
+	sp->blocks += blocks;
+}
+
+static void sparse_crc(struct sparse* sp)
+{
+	/* not checked by the applet */
+	uint8_t crc[4] = { 0x12, 0x34, 0x56, 0x78 };
+
+	sparse_chunk(sp, 0xcac4, 0, 4);
+	image_in(sp->im, crc, 4);
+}
+
+static void sparse_end(struct sparse* sp)
+{
+	put_le32(sp->im->in + 16, sp->blocks);
+	put_le32(sp->im->in + 20, sp->chunks);
+}
+
+/* random chunks, 'blocks' blocks in all */
+static void sparse_random(struct image* im, uint32_t blocks,
+		uint32_t file_hdr_size, uint32_t chunk_hdr_size)
+{
+	static const uint32_t sizes[] = { 1, 2, 3, 5, 16, 17, 40, 64 };
+	static const uint32_t fills[] = { 0, 0x12345678, 0xdeadbeef };
+	struct sparse sp;
+	uint32_t n;
+
+	sparse_start(&sp, im, 4096, file_hdr_size, chunk_hdr_size);
+	while (blocks) {
+		n = sizes[rnd() % ARRAY_SIZE(sizes)];
+		if (n > blocks)
+			n = blocks;
+		switch (rnd() % 6) {
+		case 0:
+		case 1:
+			sparse_raw(&sp, n);
+			break;
+		case 2:
+			sparse_fill(&sp, n, fills[rnd() % ARRAY_SIZE(fills)]);
+			break;
+		case 3:
+			sparse_fill(&sp, n, 0xffffffff);
+			break;
+		case 4:
+			sparse_skip(&sp, n);
+			break;
+		default:
+			sparse_crc(&sp);
+			continue;
+		}
+		blocks -= n;
+	}
+	sparse_end(&sp);
+}
+
+/* generated data, also compressed into the LZ4 vectors */
+#define PLAIN_SEED 7
+#define PLAIN_SIZE (96 * 1024 + 1234)
+#define RANDOM_SEED 8
+#define RANDOM_SIZE (20 * 1024)
+#define SPARSE_SEED 9
+
+static void make_plain(struct image* im)
+{
+	seed = PLAIN_SEED;
+	image_raw(im, PLAIN_SIZE);
+}
+
+static void make_random(struct image* im)
+{
+	uint8_t* data = xrealloc(NULL, RANDOM_SIZE);
+	uint32_t i;
+
+	seed = RANDOM_SEED;
+	for (i = 0; i < RANDOM_SIZE; i++)
+		data[i] = rnd();
+	image_in(im, data, RANDOM_SIZE);
+	image_out(im, data, DATA, RANDOM_SIZE);
+	free(data);
+}
+
+static void make_sparse(struct image* im)
+{
+	seed = SPARSE_SEED;
+	sparse_random(im, 120, 28, 12);
+}
+
+static bool load_file(const char* name, uint8_t** data, size_t* len)
+{
+	FILE* f = fopen(name, "rb");
+	long size;
+
+	if (!f)
+		return false;
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	rewind(f);
+	*data = xrealloc(NULL, size);
+	*len = fread(*data, 1, size, f);
+	fclose(f);
+	return *len == (size_t)size;
+}
+
+static void save_file(const char* dir, const char* name, const uint8_t* data,
+		size_t len)
+{
+	char path[256];
+	FILE* f;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	f = fopen(path, "wb");
+	REQUIRE(f);
+	REQUIRE(fwrite(data, 1, len, f) == len);
+	fclose(f);
+}
+
+static bool all_ff(const uint8_t* p, size_t len)
+{
+	while (len--)
+		if (*p++ != 0xff)
+			return false;
+	return true;
+}
+
+static void reset_media(const struct media_cfg* c)
+{
+	cfg = c;
+	memcpy(media, old, sizeof(media));
+	memset(programmed, 1, sizeof(programmed));
+	memset(erased, 0, sizeof(erased));
+	memset(written, 0, sizeof(written));
+	write_pages = erase_pages = erase_cmds = 0;
+	bad_writes = bad_erases = 0;
+	fail_write_at = fail_erase_at = -1;
+}
+
+static uint32_t stream_cmd(union write_stream_mailbox* mbx, uint32_t flags,
+		uint32_t offset, const uint8_t* data, uint32_t len)
+{
+	if (data)
+		memcpy(buffer, data, len);
+	memset(mbx, 0xa5, sizeof(*mbx));
+	mbx->in.flags = flags;
+	mbx->in.offset = offset;
+	mbx->in.length = len;
+	return applet_handle_cmd_write_stream(APPLET_CMD_WRITE_STREAM,
+			(uint32_t*)mbx);
+}
+
+/* pieces: 0 = buffer size, 1 = random sizes, 2 = mostly 1 to 7 bytes */
+static uint32_t run_stream(const uint8_t* in, size_t len, uint32_t offset,
+		int pieces, union write_stream_mailbox* mbx)
+{
+	size_t pos = 0, n;
+	uint32_t status, size;
+
+	status = stream_cmd(mbx, APPLET_STREAM_START, offset, NULL, 0);
+	if (status != APPLET_SUCCESS)
+		return status;
+	size = mbx->out.buf_size;
+	REQUIRE(size > 0 && size <= cfg->buf_size);
+	do {
+		if (pieces == 0)
+			n = size;
+		else if (pieces == 1)
+			n = 1 + rnd() % size;
+		else
+			n = 1 + rnd() % (rnd() % 4 ? 7 : size);
+		if (n > len - pos)
+			n = len - pos;
+		status = stream_cmd(mbx, pos + n == len ? APPLET_STREAM_END : 0,
+				0xdead, in + pos, n);
+		pos += n;
+	} while (status == APPLET_SUCCESS && pos < len);
+	return status;
+}
+
+/* check the media against the image streamed from page 'offset' */
+static void check_media(const struct image* im, uint32_t offset,
+		const union write_stream_mailbox* mbx)
+{
+	uint32_t page_size = cfg->page_size;
+	uint32_t unit = cfg->erase_support & -cfg->erase_support;
+	size_t base = (size_t)offset * page_size;
+	size_t padded = (im->len + page_size - 1) / page_size * page_size;
+	size_t end = base + padded;
+	size_t unit_end = end, i;
+	unsigned bad = 0, total_written = 0, total_erased = 0;
+	uint32_t p;
+
+	if (unit)
+		unit_end = (end + unit * page_size - 1) /
+			(unit * page_size) * (unit * page_size);
+
+	CHECK(mbx->out.next == end / page_size);
+	CHECK(bad_writes == 0);
+	CHECK(bad_erases == 0);
+
+	/* untouched around the image, erased at most up to the end of the
+	 * last erase unit */
+	CHECK(memcmp(media, old, base) == 0);
+	for (i = end; i < unit_end; i++)
+		bad += media[i] != 0xff && media[i] != old[i];
+	CHECK(memcmp(media + unit_end, old + unit_end,
+				sizeof(media) - unit_end) == 0);
+
+	for (i = 0; i < im->len; i++) {
+		if (im->mask[i] == DONT_CARE)
+			bad += media[base + i] != 0xff && media[base + i] != old[base + i];
+		else
+			bad += media[base + i] != im->img[i];
+	}
+	/* padding of the last page */
+	for (i = base + im->len; i < end; i++)
+		bad += media[i] != 0xff &&
+			!(im->mask[im->len - 1] == DONT_CARE && media[i] == old[i]);
+	CHECK(bad == 0);
+
+	for (p = 0; p < media_pages(); p++) {
+		total_written += written[p];
+		total_erased += erased[p];
+		if (erased[p] > 1 || written[p] > 1)
+			bad++;
+	}
+	CHECK(bad == 0);
+	CHECK(mbx->out.pages == total_written);
+	CHECK(mbx->out.erased == total_erased);
+	CHECK(total_written == write_pages);
+
+	if (!unit) {
+		CHECK(erase_cmds == 0);
+		return;
+	}
+	/* whole pages of 0xFF fill are erased, not written */
+	for (p = 0; p < padded / page_size; p++) {
+		const uint8_t* m = im->mask + (size_t)p * page_size;
+
+		if ((size_t)(p + 1) * page_size <= im->len &&
+		    m[0] == FILL_FF && m[page_size - 1] == FILL_FF &&
+		    !memchr(m, DATA, page_size) &&
+		    !memchr(m, DONT_CARE, page_size))
+			bad += written[offset + p] != 0;
+	}
+	CHECK(bad == 0);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+#define VECTORS 16
+
+static struct image vectors[VECTORS];
+static const char* vector_names[VECTORS];
+static unsigned vector_count;
+
+static struct image* add_vector(const char* name)
+{
+	REQUIRE(vector_count < VECTORS);
+	vector_names[vector_count] = name;
+	return &vectors[vector_count++];
+}
+
+/* LZ4 frame from vec/ with the expected image of another vector */
+static void add_lz4_vector(const char* name, const struct image* content)
+{
+	struct image* im = add_vector(name);
+	char path[256];
+
+	snprintf(path, sizeof(path), "vec/%s.lz4", name);
+	REQUIRE(load_file(path, &im->in, &im->in_len));
+	image_out(im, content->img, DATA, content->len);
+	if (content->len)
+		memcpy(im->mask, content->mask, content->len);
+}
+
+static void make_vectors(void)
+{
+	static const uint8_t tiny[] = { 'a', 'b' };
+	struct image *plain, *random, *sp, *im;
+	struct sparse s;
+
+	plain = add_vector("raw");
+	make_plain(plain);
+	random = add_vector("random");
+	make_random(random);
+	sp = add_vector("sparse");
+	make_sparse(sp);
+
+	seed = 10;
+	sparse_random(add_vector("sparse_ext"), 300, 32, 16);
+
+	/* large 0xFF fills, unaligned on the erase units */
+	im = add_vector("sparse_ff");
+	seed = 11;
+	sparse_start(&s, im, 4096, 28, 12);
+	sparse_raw(&s, 1);
+	sparse_fill(&s, 300, 0xffffffff);
+	sparse_raw(&s, 3);
+	sparse_fill(&s, 33, 0xffffffff);
+	sparse_skip(&s, 50);
+	sparse_fill(&s, 64, 0xffffffff);
+	sparse_end(&s);
+
+	im = add_vector("tiny");
+	image_in(im, tiny, sizeof(tiny));
+	image_out(im, tiny, DATA, sizeof(tiny));
+
+	add_lz4_vector("lz4_default", plain);
+	add_lz4_vector("lz4_linked", plain);
+	add_lz4_vector("lz4_independent", plain);
+	add_lz4_vector("lz4_hc", plain);
+	add_lz4_vector("lz4_nocrc", plain);
+	add_lz4_vector("lz4_fast", plain);
+	add_lz4_vector("lz4_stored", random);
+	add_lz4_vector("lz4_multi", plain);
+	add_lz4_vector("lz4_sparse", sp);
+	add_lz4_vector("lz4_empty", &(struct image){ 0 });
+}
+
+static void test_vectors(void)
+{
+	union write_stream_mailbox mbx;
+	unsigned c, v;
+	int pieces;
+
+	for (c = 0; c < ARRAY_SIZE(cfgs); c++) {
+		for (v = 0; v < vector_count; v++) {
+			const struct image* im = &vectors[v];
+			bool lz4 = !strncmp(vector_names[v], "lz4", 3);
+			uint32_t unit = cfgs[c].erase_support &
+				-cfgs[c].erase_support;
+
+			for (pieces = 0; pieces < 3; pieces++) {
+				/* start on the 3rd erase unit (or page) */
+				uint32_t offset = pieces == 2 ? 3 * (unit ? unit : 1) : 0;
+				uint32_t status;
+
+				reset_media(&cfgs[c]);
+				status = run_stream(im->in, im->in_len, offset,
+						pieces, &mbx);
+				if (lz4 && cfgs[c].buf_size < 64 * 1024) {
+					/* no room for the LZ4 window */
+					CHECK(status == APPLET_FAIL);
+					CHECK(write_pages == 0 && erase_cmds == 0);
+					continue;
+				}
+				if (status != APPLET_SUCCESS)
+					fprintf(stderr, "%s %s pieces %d: status %u\n",
+						cfgs[c].name, vector_names[v],
+						pieces, (unsigned)status);
+				CHECK(status == APPLET_SUCCESS);
+				check_media(im, offset, &mbx);
+			}
+		}
+	}
+}
+
+static void test_erase_units(void)
+{
+	struct image im = { 0 };
+	union write_stream_mailbox mbx;
+	struct sparse s;
+
+	/* 1 block of data, 301 of 0xFF, 1 of data, on 4/32/64 KiB erase:
+	 * only the data pages are written, the fill is erased with the
+	 * largest aligned sizes */
+	seed = 12;
+	sparse_start(&s, &im, 4096, 28, 12);
+	sparse_raw(&s, 1);
+	sparse_fill(&s, 301, 0xffffffff);
+	sparse_raw(&s, 1);
+	sparse_end(&s);
+	reset_media(&cfgs[0]);
+	CHECK(run_stream(im.in, im.in_len, 0, 0, &mbx) == APPLET_SUCCESS);
+	check_media(&im, 0, &mbx);
+	CHECK(mbx.out.pages == 32);
+	CHECK(mbx.out.erased == 303 * 16);
+	/* 4K, then 4K x 7, 32K, 64K x 17, 32K, 4K x 6, then 4K */
+	CHECK(erase_cmds == 1 + 7 + 1 + 17 + 1 + 6 + 1);
+	image_free(&im);
+
+	/* "don't care" units are not erased: data, 2 units skipped, data */
+	seed = 13;
+	sparse_start(&s, &im, 4096, 28, 12);
+	sparse_raw(&s, 1);
+	sparse_skip(&s, 2);
+	sparse_raw(&s, 1);
+	sparse_end(&s);
+	reset_media(&cfgs[0]);
+	CHECK(run_stream(im.in, im.in_len, 16, 1, &mbx) == APPLET_SUCCESS);
+	check_media(&im, 16, &mbx);
+	CHECK(mbx.out.erased == 32);
+	CHECK(memcmp(media + 32 * 256, old + 32 * 256, 2 * 4096) == 0);
+	image_free(&im);
+
+	/* a partial last unit is erased whole */
+	seed = 14;
+	image_raw(&im, 5000);
+	reset_media(&cfgs[2]);
+	CHECK(run_stream(im.in, im.in_len, 64, 2, &mbx) == APPLET_SUCCESS);
+	check_media(&im, 64, &mbx);
+	CHECK(mbx.out.pages == 2 && mbx.out.erased == 64);
+	CHECK(all_ff(media + 66 * 4096, 62 * 4096));
+	CHECK(memcmp(media + 128 * 4096, old + 128 * 4096, 4096) == 0);
+	image_free(&im);
+}
+
+static void test_errors(void)
+{
+	struct image im = { 0 };
+	union write_stream_mailbox mbx;
+	unsigned c;
+
+	seed = 15;
+	image_raw(&im, 100000);
+
+	/* start offset not on an erase unit */
+	for (c = 0; c < ARRAY_SIZE(cfgs); c++) {
+		reset_media(&cfgs[c]);
+		if (cfgs[c].erase_support)
+			CHECK(stream_cmd(&mbx, APPLET_STREAM_START, 8, im.in,
+						100) == APPLET_ALIGN_ERROR);
+		else
+			CHECK(stream_cmd(&mbx, APPLET_STREAM_START |
+					APPLET_STREAM_END, 8, im.in, 100) ==
+					APPLET_SUCCESS);
+	}
+	reset_media(&cfgs[0]);
+	CHECK(stream_cmd(&mbx, 0, 0, im.in, 100) == APPLET_FAIL);
+	CHECK(write_pages == 0 && erase_cmds == 0);
+
+	/* beyond the media, or of the buffer */
+	reset_media(&cfgs[0]);
+	CHECK(run_stream(im.in, im.in_len, media_pages() - 256, 0, &mbx) ==
+			APPLET_FAIL);
+	CHECK(bad_writes == 0 && bad_erases == 0);
+	CHECK(stream_cmd(&mbx, APPLET_STREAM_START, 0, NULL, 0) ==
+			APPLET_SUCCESS);
+	CHECK(stream_cmd(&mbx, 0, 0, NULL, mbx.out.buf_size + 1) ==
+			APPLET_FAIL);
+	CHECK(stream_cmd(&mbx, 0, 0, im.in, 1) == APPLET_FAIL);
+
+	/* erase and write failures stop the stream */
+	reset_media(&cfgs[0]);
+	fail_erase_at = 2;
+	CHECK(run_stream(im.in, im.in_len, 0, 1, &mbx) == APPLET_ERASE_FAIL);
+	CHECK(stream_cmd(&mbx, 0, 0, im.in, 1) == APPLET_FAIL);
+	reset_media(&cfgs[1]);
+	fail_write_at = 0;
+	CHECK(run_stream(im.in, im.in_len, 0, 1, &mbx) == APPLET_WRITE_FAIL);
+	CHECK(mbx.out.pages == 0);
+	reset_media(&cfgs[2]);
+	CHECK(run_stream(im.in, im.in_len, 0, 1, &mbx) == APPLET_SUCCESS);
+	check_media(&im, 0, &mbx);
+	image_free(&im);
+}
+
+/* mutated streams must fail or be written, without bad media accesses */
+static void test_mutations(void)
+{
+	union write_stream_mailbox mbx;
+	unsigned accepted = 0, it;
+	int k;
+
+	for (it = 0; it < 1500; it++) {
+		const struct image* im = &vectors[rnd() % vector_count];
+		size_t len = im->in_len, p;
+		uint8_t* in;
+
+		if (len > 50000 && rnd() % 2)
+			len = 50000 + rnd() % 1000;
+		in = xrealloc(NULL, len + 64);
+		memcpy(in, im->in, len);
+		for (k = 1 + rnd() % 8; k && len; k--) {
+			uint32_t r = rnd() % 10;
+
+			p = rnd() % len;
+			if (r < 6) {
+				in[p] ^= 1 << (rnd() % 8);
+			} else if (r < 8) {
+				in[p] = rnd();
+			} else if (r < 9) {
+				len = p;
+			} else if (len + 4 <= im->in_len + 64) {
+				memmove(in + p + 4, in + p, len - p);
+				in[p] = rnd();
+				len += 4;
+			}
+		}
+		reset_media(&cfgs[rnd() % ARRAY_SIZE(cfgs)]);
+		if (run_stream(in, len, 0, 1 + rnd() % 2, &mbx) ==
+				APPLET_SUCCESS)
+			accepted++;
+		CHECK(bad_writes == 0 && bad_erases == 0);
+		free(in);
+	}
+	CHECK(accepted > 0 && accepted < it);
+}
+
+/* write the generated data compressed into the LZ4 vectors */
+static int generate(const char* dir)
+{
+	struct image im = { 0 };
+
+	make_plain(&im);
+	save_file(dir, "plain.bin", im.in, im.in_len);
+	image_free(&im);
+	make_random(&im);
+	save_file(dir, "random.bin", im.in, im.in_len);
+	image_free(&im);
+	make_sparse(&im);
+	save_file(dir, "sparse.bin", im.in, im.in_len);
+	image_free(&im);
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned i;
+
+	if (argc > 2 && strcmp(argv[1], "-g") == 0)
+		return generate(argv[2]);
+
+	seed = 1;
+	for (i = 0; i < sizeof(old); i++)
+		old[i] = rnd();
+
+	make_vectors();
+	test_vectors();
+	test_erase_units();
+	test_errors();
+	test_mutations();
+	for (i = 0; i < vector_count; i++)
+		image_free(&vectors[i]);
+	return host_test_end("applet_stream");
+}
@@ -0,0 +1,422 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the AT24 EEPROM driver. The bus stand-in simulates an
+ * EEPROM that does not acknowledge its address during a random 3-5 ms
+ * write cycle and rolls page writes over within the page, like the real
+ * device. Random writes and reads are checked against a reference image,
+ * with and without the write-combining cache, on devices with 1-byte,
+ * 2-byte and 2-byte plus device-address memory addressing. The bus must be
+ * released between ACK polls and a write must never cross a page.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "nvm/i2c/at24.h"
+#include "peripherals/bus.h"
+#include "timer.h"
+#include "trace.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated EEPROM
+ *----------------------------------------------------------------------------*/
+
+#define MAX_SIZE (256 * 1024)
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+static uint64_t now_us;
+
+static struct {
+	uint8_t mem[MAX_SIZE];
+	uint32_t size;
+	uint16_t page_size;
+	uint8_t addr;         /* device address, without memory address bits */
+	uint8_t addr_bits;    /* memory address bits in the device address */
+	uint8_t offset_bytes; /* memory address bytes */
+
+	uint64_t busy_until;
+	bool stuck;           /* never completes its write cycle */
+
+	bool in_transaction;
+	uint32_t transfers;   /* in the current transaction */
+	uint32_t max_transfers;
+	uint32_t page_writes;
+	uint32_t bytes_written;
+	uint32_t crossings;   /* writes rolled over within the page */
+	uint32_t errors;      /* malformed or misaddressed transfers */
+} eeprom;
+
+static void eeprom_init(uint32_t size, uint16_t page_size, uint8_t addr)
+{
+	memset(&eeprom, 0, sizeof(eeprom));
+	memset(eeprom.mem, 0xff, sizeof(eeprom.mem));
+	eeprom.size = size;
+	eeprom.page_size = page_size;
+	eeprom.addr_bits = size > 0x20000 ? 2 : size > 0x10000 ? 1 : 0;
+	eeprom.addr = addr & ~((1 << eeprom.addr_bits) - 1);
+	eeprom.offset_bytes = size > 256 ? 2 : 1;
+}
+
+static bool eeprom_busy(void)
+{
+	return eeprom.stuck || now_us < eeprom.busy_until;
+}
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+int bus_start_transaction(uint8_t bus_id)
+{
+	if (eeprom.in_transaction)
+		eeprom.errors++;
+	eeprom.in_transaction = true;
+	eeprom.transfers = 0;
+	return 0;
+}
+
+int bus_stop_transaction(uint8_t bus_id)
+{
+	if (!eeprom.in_transaction)
+		eeprom.errors++;
+	eeprom.in_transaction = false;
+	return 0;
+}
+
+int bus_transfer(uint8_t bus_id, uint16_t remote, struct _buffer* buf, uint16_t buffers, struct _callback* cb)
+{
+	uint32_t offset, bytes, i;
+
+	if (!eeprom.in_transaction)
+		eeprom.errors++;
+	if (++eeprom.transfers > eeprom.max_transfers)
+		eeprom.max_transfers = eeprom.transfers;
+
+	bytes = 0;
+	for (i = 0; i < buffers; i++)
+		bytes += buf[i].size;
+	now_us += 100 + 25 * bytes;
+
+	if ((remote & ~((1 << eeprom.addr_bits) - 1)) != eeprom.addr) {
+		eeprom.errors++;
+		return -ECONNABORTED;
+	}
+	if (eeprom_busy())
+		return -ECONNABORTED;
+
+	/* ACK poll */
+	if (buffers == 1)
+		return 0;
+
+	if (buffers != 2 || buf[0].size != eeprom.offset_bytes) {
+		eeprom.errors++;
+		return -EINVAL;
+	}
+	offset = (remote & ((1 << eeprom.addr_bits) - 1)) << 16;
+	if (eeprom.offset_bytes == 2)
+		offset |= (buf[0].data[0] << 8) | buf[0].data[1];
+	else
+		offset |= buf[0].data[0];
+
+	if (buf[1].attr & BUS_BUF_ATTR_RX) {
+		/* sequential read, rolls over at the end of the memory */
+		for (i = 0; i < buf[1].size; i++)
+			buf[1].data[i] = eeprom.mem[(offset + i) % eeprom.size];
+	} else {
+		uint32_t page = offset - offset % eeprom.page_size;
+
+		if (offset % eeprom.page_size + buf[1].size > eeprom.page_size)
+			eeprom.crossings++;
+		for (i = 0; i < buf[1].size; i++)
+			eeprom.mem[page + (offset + i) % eeprom.page_size] = buf[1].data[i];
+		eeprom.busy_until = now_us + 3000 + rnd() % 2000;
+		eeprom.page_writes++;
+		eeprom.bytes_written += buf[1].size;
+	}
+	return 0;
+}
+
+int bus_wait_transfer(uint8_t bus_id)
+{
+	return 0;
+}
+
+uint64_t timer_get_us(void)
+{
+	return now_us;
+}
+
+void timer_start_timeout(struct _timeout* timeout, uint64_t count)
+{
+	timeout->start = now_us / 1000;
+	timeout->count = count;
+}
+
+uint8_t timer_timeout_reached(struct _timeout* timeout)
+{
+	return now_us / 1000 - timeout->start >= timeout->count;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint8_t ref[MAX_SIZE];
+static uint8_t cache_buf[AT24_CACHE_LINES * 256];
+
+static void setup(struct _at24* at24, enum _at24_model model, uint8_t addr,
+		uint32_t size, uint16_t page_size)
+{
+	const struct _at24_config cfg = { .bus = 0, .addr = addr, .model = model };
+
+	eeprom_init(size, page_size, addr);
+	memcpy(ref, eeprom.mem, size);
+	REQUIRE(at24_configure(at24, &cfg) == 0);
+}
+
+static void fill(uint8_t* data, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+		data[i] = rnd();
+}
+
+static void write_ref(struct _at24* at24, uint32_t offset, uint16_t len)
+{
+	uint8_t data[1024];
+
+	fill(data, len);
+	CHECK(at24_write(at24, offset, data, len) == 0);
+	memcpy(ref + offset, data, len);
+}
+
+static bool read_matches(struct _at24* at24, uint32_t offset, uint16_t len)
+{
+	uint8_t data[1024];
+
+	if (at24_read(at24, offset, data, len) != 0)
+		return false;
+	return memcmp(data, ref + offset, len) == 0;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_configure(void)
+{
+	struct _at24 at24;
+	struct _at24_config cfg = { .bus = 0 };
+	uint8_t small[16];
+
+	cfg.model = (enum _at24_model)99;
+	cfg.addr = 0x50;
+	CHECK(at24_configure(&at24, &cfg) == -ENOTSUP);
+
+	cfg.model = AT24C64;
+	cfg.addr = 0x57;
+	CHECK(at24_configure(&at24, &cfg) == 0);
+	cfg.addr = 0x58;
+	CHECK(at24_configure(&at24, &cfg) == -ENODEV);
+
+	/* A17:A16 in the device address, only A2 is a pin */
+	cfg.model = AT24CM02;
+	cfg.addr = 0x54;
+	CHECK(at24_configure(&at24, &cfg) == 0);
+	cfg.addr = 0x51;
+	CHECK(at24_configure(&at24, &cfg) == -ENODEV);
+
+	cfg.model = AT24C64;
+	cfg.addr = 0x50;
+	REQUIRE(at24_configure(&at24, &cfg) == 0);
+	CHECK(at24_enable_cache(&at24, small, sizeof(small)) == -EINVAL);
+}
+
+/* Random writes and reads against the reference image */
+static void test_random(enum _at24_model model, uint8_t addr, uint32_t size,
+		uint16_t page_size, bool cached)
+{
+	struct _at24 at24;
+	struct _at24_stats stats;
+	uint32_t bytes = 0, writes = 0;
+	/* small writes to a small area to give the cache some hits */
+	uint32_t area = cached ? 5 * page_size : size;
+	uint16_t max_len = cached ? page_size / 4 : 2 * page_size + 10;
+	int i;
+
+	setup(&at24, model, addr, size, page_size);
+	if (cached)
+		REQUIRE(at24_enable_cache(&at24, cache_buf, AT24_CACHE_LINES * page_size) == 0);
+
+	for (i = 0; i < 2000; i++) {
+		uint32_t offset = rnd() % area;
+		uint16_t len = 1 + rnd() % max_len;
+
+		if (offset + len > size)
+			len = size - offset;
+		write_ref(&at24, offset, len);
+		bytes += len;
+		writes++;
+
+		/* the write cycle is left running */
+		if (!cached)
+			CHECK(eeprom_busy());
+
+		if (rnd() % 8 == 0) {
+			offset = rnd() % area;
+			len = 1 + rnd() % (2 * page_size);
+			if (offset + len > size)
+				len = size - offset;
+			CHECK(read_matches(&at24, offset, len));
+		}
+	}
+	CHECK(at24_flush(&at24) == 0);
+	CHECK(!eeprom_busy());
+	CHECK(memcmp(eeprom.mem, ref, size) == 0);
+
+	CHECK(eeprom.crossings == 0);
+	CHECK(eeprom.errors == 0);
+	/* one transfer per transaction, the bus is released between polls */
+	CHECK(eeprom.max_transfers == 1);
+
+	at24_get_stats(&at24, &stats);
+	CHECK(stats.page_writes == eeprom.page_writes);
+	CHECK(stats.bytes_written == eeprom.bytes_written);
+	CHECK(stats.timeouts == 0);
+	CHECK(stats.polls > 0);
+	CHECK(stats.cycle_max >= 3000 && stats.cycle_max < 5000 + 1000);
+	CHECK(stats.cycle_total >= 3000ull * stats.page_writes);
+	if (cached) {
+		CHECK(stats.cache_hits > 0);
+		CHECK(stats.page_writes < writes / 2);
+	} else {
+		CHECK(stats.bytes_written == bytes);
+		CHECK(stats.cache_hits == 0 && stats.cache_misses == 0);
+	}
+}
+
+/* A device that never completes its write cycle */
+static void test_timeout(void)
+{
+	struct _at24 at24;
+	struct _at24_stats stats;
+	uint8_t data[4] = { 1, 2, 3, 4 };
+	uint64_t start;
+
+	setup(&at24, AT24C64, 0x50, 8192, 32);
+	CHECK(at24_write(&at24, 0, data, sizeof(data)) == 0);
+	eeprom.stuck = true;
+
+	start = now_us;
+	CHECK(at24_write(&at24, 32, data, sizeof(data)) == -ETIMEDOUT);
+	CHECK(now_us - start >= AT24_WRITE_CYCLE_TIMEOUT * 1000 - 1000);
+	CHECK(now_us - start < AT24_WRITE_CYCLE_TIMEOUT * 1000 + 1000);
+	at24_get_stats(&at24, &stats);
+	CHECK(stats.timeouts == 1);
+	CHECK(stats.page_writes == 1);
+	CHECK(eeprom.max_transfers == 1);
+
+	/* recovers once the device answers again */
+	eeprom.stuck = false;
+	CHECK(at24_write(&at24, 32, data, sizeof(data)) == 0);
+	CHECK(at24_flush(&at24) == 0);
+	CHECK(memcmp(eeprom.mem + 32, data, sizeof(data)) == 0);
+}
+
+/* Cache hits, read overlay, round-robin eviction and full-page bypass */
+static void test_cache(void)
+{
+	struct _at24 at24;
+	struct _at24_stats stats;
+
+	setup(&at24, AT24C64, 0x50, 8192, 32);
+	REQUIRE(at24_enable_cache(&at24, cache_buf, 2 * 32) == 0);
+
+	write_ref(&at24, 3, 2);
+	write_ref(&at24, 10, 4);
+	at24_get_stats(&at24, &stats);
+	CHECK(stats.cache_misses == 1 && stats.cache_hits == 1);
+	CHECK(stats.page_writes == 0);
+	CHECK(eeprom.mem[3] == 0xff && eeprom.mem[10] == 0xff);
+	CHECK(read_matches(&at24, 0, 64));
+
+	/* full page: programmed directly, not cached */
+	write_ref(&at24, 64, 32);
+	at24_get_stats(&at24, &stats);
+	CHECK(stats.page_writes == 1 && stats.cache_misses == 1);
+
+	/* third partial page evicts the first one: bytes 3..13 programmed */
+	write_ref(&at24, 32 + 5, 1);
+	write_ref(&at24, 96 + 7, 1);
+	at24_get_stats(&at24, &stats);
+	CHECK(stats.cache_misses == 3);
+	CHECK(stats.page_writes == 2);
+	CHECK(stats.bytes_written == 32 + 11);
+	CHECK(memcmp(eeprom.mem, ref, 32) == 0);
+	CHECK(read_matches(&at24, 0, 128));
+
+	CHECK(at24_flush(&at24) == 0);
+	CHECK(memcmp(eeprom.mem, ref, 8192) == 0);
+	at24_get_stats(&at24, &stats);
+	CHECK(stats.page_writes == 4);
+
+	/* nothing left to program */
+	CHECK(at24_flush(&at24) == 0);
+	at24_get_stats(&at24, &stats);
+	CHECK(stats.page_writes == 4);
+}
+
+int main(void)
+{
+	test_configure();
+	test_random(AT24C02, 0x53, 256, 8, false);
+	test_random(AT24C02, 0x53, 256, 8, true);
+	test_random(AT24C64, 0x50, 8192, 32, false);
+	test_random(AT24C64, 0x50, 8192, 32, true);
+	test_random(AT24CM02, 0x54, 256 * 1024, 256, false);
+	test_random(AT24CM02, 0x54, 256 * 1024, 256, true);
+	test_timeout();
+	test_cache();
+	return host_test_end("at24");
+}
@@ -0,0 +1,215 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of lwip_arch_chksum() and lwip_arch_chksum_copy(). Their
+ * results are compared with lwIP's portable algorithm #2 over random
+ * lengths (up to 64 KiB) and source/destination alignments. The copy must
+ * not touch the bytes around the destination.
+ *
+ * With -b, both routines are also timed against the portable code (memcpy
+ * plus checksum for the copy variant). Build without sanitizers for
+ * meaningful numbers:
+ *
+ *   make clean check SANITIZE= CFLAGS=-O2 ARGS=-b
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lwip/opt.h"
+
+#include "host_test.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/* lwip_standard_chksum(), LWIP_CHKSUM_ALGORITHM 2 (core/inet_chksum.c) */
+static uint16_t ref_chksum(const void* dataptr, int len)
+{
+	const uint8_t* pb = (const uint8_t*)dataptr;
+	const uint16_t* ps;
+	uint16_t t = 0;
+	uint32_t sum = 0;
+	int odd = ((uintptr_t)pb & 1);
+
+	if (odd && len > 0) {
+		((uint8_t*)&t)[1] = *pb++;
+		len--;
+	}
+	ps = (const uint16_t*)(const void*)pb;
+	while (len > 1) {
+		sum += *ps++;
+		len -= 2;
+	}
+	if (len > 0)
+		((uint8_t*)&t)[0] = *(const uint8_t*)ps;
+	sum += t;
+	sum = (sum >> 16) + (sum & 0xffff);
+	sum = (sum >> 16) + (sum & 0xffff);
+	if (odd)
+		sum = ((sum & 0xff) << 8) | ((sum & 0xff00) >> 8);
+	return (uint16_t)sum;
+}
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#define MAX_LEN 65536
+#define SLACK 16
+
+static uint8_t src[MAX_LEN + SLACK] __attribute__((aligned(8)));
+static uint8_t dst[MAX_LEN + SLACK] __attribute__((aligned(8)));
+
+static void check_one(int src_off, int dst_off, int len)
+{
+	uint16_t expected = ref_chksum(src + src_off, len);
+	int i;
+
+	CHECK(lwip_arch_chksum(src + src_off, len) == expected);
+
+	memset(dst, 0x5a, sizeof(dst));
+	CHECK(lwip_arch_chksum_copy(dst + dst_off, src + src_off, len) == expected);
+	CHECK(memcmp(dst + dst_off, src + src_off, len) == 0);
+	for (i = 0; i < dst_off; i++)
+		CHECK(dst[i] == 0x5a);
+	for (i = dst_off + len; i < dst_off + len + 8; i++)
+		CHECK(dst[i] == 0x5a);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_lengths(void)
+{
+	int src_off, dst_off, len;
+
+	for (len = 0; len < 80; len++)
+		for (src_off = 0; src_off < 8; src_off++)
+			for (dst_off = 0; dst_off < 8; dst_off++) {
+				int i;
+
+				for (i = 0; i < len + src_off; i++)
+					src[i] = rnd();
+				check_one(src_off, dst_off, len);
+			}
+}
+
+static void test_random(void)
+{
+	int i, k;
+
+	for (i = 0; i < 20000; i++) {
+		int src_off = rnd() % 8;
+		int dst_off = rnd() % 8;
+		int len = rnd() % (i % 10 == 0 ? MAX_LEN : 1600);
+
+		if (i % 50 == 0) {
+			/* Carries out of every 16-bit addition */
+			memset(src + src_off, 0xff, len);
+		} else {
+			for (k = 0; k < len + src_off; k++)
+				src[k] = rnd();
+		}
+		check_one(src_off, dst_off, len);
+	}
+}
+
+static void benchmark(void)
+{
+	static const int lengths[] = { 64, 1460 };
+	const int total = 60000000;
+	volatile uint32_t sink = 0;
+	double t0, t_ref, t_arch, t_ref_copy, t_arch_copy;
+	unsigned i;
+	int n;
+
+	for (i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+		int len = lengths[i];
+		int count = total / len;
+
+		t0 = now();
+		for (n = 0; n < count; n++)
+			sink += ref_chksum(src + (n & 1), len);
+		t_ref = now() - t0;
+
+		t0 = now();
+		for (n = 0; n < count; n++)
+			sink += lwip_arch_chksum(src + (n & 1), len);
+		t_arch = now() - t0;
+
+		t0 = now();
+		for (n = 0; n < count; n++) {
+			memcpy(dst, src + (n & 1), len);
+			sink += ref_chksum(dst, len);
+		}
+		t_ref_copy = now() - t0;
+
+		t0 = now();
+		for (n = 0; n < count; n++)
+			sink += lwip_arch_chksum_copy(dst, src + (n & 1), len);
+		t_arch_copy = now() - t0;
+
+		printf("%4d bytes: chksum %.0f MB/s (generic %.0f MB/s), "
+		       "copy %.0f MB/s (memcpy + generic %.0f MB/s)\n", len,
+		       total / t_arch / 1e6, total / t_ref / 1e6,
+		       total / t_arch_copy / 1e6, total / t_ref_copy / 1e6);
+	}
+	(void)sink;
+}
+
+int main(int argc, char* argv[])
+{
+	test_lengths();
+	test_random();
+	if (argc > 1 && strcmp(argv[1], "-b") == 0)
+		benchmark();
+	return host_test_end("chksum");
+}
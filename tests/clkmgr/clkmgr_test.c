@@ -0,0 +1,290 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the peripheral clock manager. The PMC is simulated as two
+ * arrays of clock gates; every gate change is counted and must happen with
+ * interrupts masked. Time is a fake millisecond tick.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "irqflags.h"
+#include "peripherals/pmc.h"
+#include "power/clkmgr.h"
+#include "timer.h"
+
+#include "host_test.h"
+
+#include <stdint.h>
+#include <string.h>
+
+bool host_irq_enabled = true;
+
+/*----------------------------------------------------------------------------
+ *        Simulated PMC and time
+ *----------------------------------------------------------------------------*/
+
+static struct {
+	bool periph[ID_PERIPH_COUNT];
+	bool gck[ID_PERIPH_COUNT];
+	unsigned writes;         /* gate changes */
+	unsigned unmasked_writes; /* ... with interrupts enabled */
+} pmc;
+
+static uint64_t now_ms;
+
+static void pmc_write(void)
+{
+	pmc.writes++;
+	if (host_irq_enabled)
+		pmc.unmasked_writes++;
+}
+
+void pmc_enable_peripheral(uint32_t id)
+{
+	REQUIRE(id < ID_PERIPH_COUNT);
+	pmc.periph[id] = true;
+	pmc_write();
+}
+
+void pmc_disable_peripheral(uint32_t id)
+{
+	REQUIRE(id < ID_PERIPH_COUNT);
+	/* GCK must be stopped before the peripheral clock */
+	CHECK(!pmc.gck[id]);
+	pmc.periph[id] = false;
+	pmc_write();
+}
+
+bool pmc_is_peripheral_enabled(uint32_t id)
+{
+	return pmc.periph[id];
+}
+
+void pmc_enable_gck(uint32_t id)
+{
+	REQUIRE(id < ID_PERIPH_COUNT);
+	CHECK(pmc.periph[id]);
+	pmc.gck[id] = true;
+	pmc_write();
+}
+
+void pmc_disable_gck(uint32_t id)
+{
+	REQUIRE(id < ID_PERIPH_COUNT);
+	pmc.gck[id] = false;
+	pmc_write();
+}
+
+bool pmc_is_gck_enabled(uint32_t id)
+{
+	return pmc.gck[id];
+}
+
+uint64_t timer_get_tick(void)
+{
+	return now_ms;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+/* Peripheral IDs, each test uses its own as the manager keeps state */
+enum { ID_UNMANAGED, ID_GATED, ID_NESTED, ID_PRE_ENABLED, ID_GCK, ID_NOW };
+
+static void test_timeout(void)
+{
+	struct _clkmgr_stats stats;
+
+	clkmgr_set_timeout(CLKMGR_DEFAULT_TIMEOUT);
+	now_ms = 1000;
+
+	/* Only managed peripherals are gated */
+	pmc.periph[ID_UNMANAGED] = true;
+	CHECK(clkmgr_poll() == 0);
+	CHECK(pmc.periph[ID_UNMANAGED]);
+	clkmgr_get_stats(ID_UNMANAGED, &stats);
+	CHECK(!stats.managed);
+
+	clkmgr_get(ID_GATED);
+	CHECK(pmc.periph[ID_GATED]);
+	clkmgr_get_stats(ID_GATED, &stats);
+	CHECK(stats.managed && stats.enabled && stats.refcount == 1);
+
+	now_ms += 5;
+	clkmgr_put(ID_GATED);
+	CHECK(pmc.periph[ID_GATED]);
+
+	/* Idle, but not for long enough */
+	now_ms += CLKMGR_DEFAULT_TIMEOUT - 1;
+	CHECK(clkmgr_poll() == 0);
+	CHECK(pmc.periph[ID_GATED]);
+
+	now_ms += 1;
+	CHECK(clkmgr_poll() == 1);
+	CHECK(!pmc.periph[ID_GATED]);
+	CHECK(pmc.periph[ID_UNMANAGED]);
+	CHECK(clkmgr_poll() == 0);
+
+	clkmgr_get_stats(ID_GATED, &stats);
+	CHECK(!stats.enabled && stats.refcount == 0);
+	CHECK(stats.gate_count == 1);
+	CHECK(stats.on_time == 5 + CLKMGR_DEFAULT_TIMEOUT);
+
+	/* Gated time is not counted */
+	now_ms += 100;
+	clkmgr_get(ID_GATED);
+	CHECK(pmc.periph[ID_GATED]);
+	now_ms += 7;
+	clkmgr_get_stats(ID_GATED, &stats);
+	CHECK(stats.on_time == 5 + CLKMGR_DEFAULT_TIMEOUT + 7);
+
+	/* A new reference before the timeout keeps the clock on */
+	clkmgr_put(ID_GATED);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT - 1;
+	clkmgr_get(ID_GATED);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 0);
+	clkmgr_put(ID_GATED);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 1);
+	clkmgr_get_stats(ID_GATED, &stats);
+	CHECK(stats.gate_count == 2);
+}
+
+static void test_references(void)
+{
+	struct _clkmgr_stats stats;
+	unsigned writes;
+
+	clkmgr_set_timeout(CLKMGR_DEFAULT_TIMEOUT);
+
+	clkmgr_get(ID_NESTED);
+	writes = pmc.writes;
+	clkmgr_get(ID_NESTED);
+	CHECK(pmc.writes == writes);
+	clkmgr_put(ID_NESTED);
+	now_ms += 10 * CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 0);
+	CHECK(pmc.periph[ID_NESTED]);
+	clkmgr_get_stats(ID_NESTED, &stats);
+	CHECK(stats.refcount == 1);
+	clkmgr_put(ID_NESTED);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 1);
+
+	/* Enabled by pmc_configure_peripheral() before being managed: no
+	 * write, but gated like the others once idle */
+	pmc.periph[ID_PRE_ENABLED] = true;
+	writes = pmc.writes;
+	clkmgr_get(ID_PRE_ENABLED);
+	CHECK(pmc.writes == writes);
+	clkmgr_get_stats(ID_PRE_ENABLED, &stats);
+	CHECK(stats.managed && stats.enabled && stats.on_time == 0);
+	clkmgr_put(ID_PRE_ENABLED);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 1);
+	CHECK(!pmc.periph[ID_PRE_ENABLED]);
+}
+
+/* The generated clock is stopped with the peripheral clock and restored */
+static void test_gck(void)
+{
+	clkmgr_set_timeout(CLKMGR_DEFAULT_TIMEOUT);
+
+	clkmgr_get(ID_GCK);
+	pmc_enable_gck(ID_GCK);
+	clkmgr_put(ID_GCK);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 1);
+	CHECK(!pmc.periph[ID_GCK] && !pmc.gck[ID_GCK]);
+
+	clkmgr_get(ID_GCK);
+	CHECK(pmc.periph[ID_GCK] && pmc.gck[ID_GCK]);
+
+	/* Disabled meanwhile by the driver: not restored */
+	pmc_disable_gck(ID_GCK);
+	clkmgr_put(ID_GCK);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 1);
+	clkmgr_get(ID_GCK);
+	CHECK(pmc.periph[ID_GCK] && !pmc.gck[ID_GCK]);
+	clkmgr_put(ID_GCK);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 1);
+}
+
+static void test_no_timeout(void)
+{
+	struct _clkmgr_stats stats;
+
+	clkmgr_set_timeout(0);
+	clkmgr_get(ID_NOW);
+	clkmgr_get(ID_NOW);
+	clkmgr_put(ID_NOW);
+	CHECK(pmc.periph[ID_NOW]);
+	clkmgr_put(ID_NOW);
+	CHECK(!pmc.periph[ID_NOW]);
+	clkmgr_get_stats(ID_NOW, &stats);
+	CHECK(stats.gate_count == 1);
+	clkmgr_set_timeout(CLKMGR_DEFAULT_TIMEOUT);
+}
+
+/* Gates change with interrupts masked, and the caller's state is kept */
+static void test_irq(void)
+{
+	pmc.unmasked_writes = 0;
+	host_irq_enabled = false;
+	clkmgr_get(ID_GATED);
+	CHECK(!host_irq_enabled);
+	clkmgr_put(ID_GATED);
+	CHECK(!host_irq_enabled);
+	host_irq_enabled = true;
+	clkmgr_get(ID_GATED);
+	clkmgr_put(ID_GATED);
+	now_ms += CLKMGR_DEFAULT_TIMEOUT;
+	CHECK(clkmgr_poll() == 1);
+	CHECK(host_irq_enabled);
+}
+
+int main(void)
+{
+	test_timeout();
+	test_references();
+	test_gck();
+	test_no_timeout();
+	test_irq();
+	CHECK(pmc.unmasked_writes == 0);
+	return host_test_end("clkmgr");
+}
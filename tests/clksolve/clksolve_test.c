@@ -0,0 +1,363 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the clock-tree solver. Solutions are recomputed from their
+ * register fields and checked against the device limits and the requested
+ * tolerance. For the processor and generated clocks, an exhaustive search
+ * over all the register values must not find a smaller error.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "power/clksolve.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+#define MAIN_FREQ 12000000u
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static uint64_t error_ppb(uint64_t freq, uint64_t target)
+{
+	uint64_t diff = freq > target ? freq - target : target - freq;
+
+	return diff * 1000000000ull / target;
+}
+
+/* Recompute a CPU solution from its fields and check it */
+static void check_cpu(const struct _clksolve_cpu_limits* limits,
+		const struct _clksolve_cpu* sol, uint32_t pck, uint32_t mck,
+		uint32_t tolerance)
+{
+	uint64_t pll = (uint64_t)MAIN_FREQ * (sol->mul + 1) / sol->div;
+	uint64_t freq = pll / (sol->div2 ? 2 : 1) / sol->pres;
+
+	CHECK(sol->mul >= 1 && sol->mul <= limits->mul_max);
+	CHECK(sol->div >= 1 && sol->div <= limits->div_max);
+	CHECK(sol->mdiv >= 1 && sol->mdiv <= 4);
+	CHECK(sol->pres != 3 || limits->has_pres3);
+	CHECK(!sol->div2 || limits->has_div2);
+	CHECK(pll == sol->pll);
+	CHECK(pll >= limits->pll_min && pll <= limits->pll_max);
+	CHECK(freq == sol->pck && sol->pck <= limits->pck_max);
+	CHECK(sol->mck == sol->pck / sol->mdiv && sol->mck <= limits->mck_max);
+	if (limits->h32mx_max)
+		CHECK((sol->h32mx_div2 ? sol->mck / 2 : sol->mck) <= limits->h32mx_max);
+	else
+		CHECK(!sol->h32mx_div2);
+	CHECK(sol->pck_error == clksolve_error_ppm(sol->pck, pck));
+	CHECK(sol->pck_error <= tolerance);
+	if (mck)
+		CHECK(sol->mck_error == clksolve_error_ppm(sol->mck, mck) &&
+		      sol->mck_error <= tolerance);
+}
+
+/* Smallest processor clock error reachable, over all register values */
+static uint64_t best_cpu_error(const struct _clksolve_cpu_limits* limits,
+		uint32_t pck)
+{
+	static const uint32_t prescalers[] = { 1, 2, 3, 4, 8, 16, 32, 64 };
+	uint64_t best = UINT64_MAX;
+	uint32_t mul, div, d2, p, mdiv;
+
+	for (div = 1; div <= limits->div_max; div++) {
+		for (mul = 1; mul <= limits->mul_max; mul++) {
+			uint64_t pll = (uint64_t)MAIN_FREQ * (mul + 1) / div;
+
+			if (pll < limits->pll_min || pll > limits->pll_max)
+				continue;
+			for (d2 = 1; d2 <= (limits->has_div2 ? 2u : 1u); d2++) {
+				for (p = 0; p < 8; p++) {
+					uint64_t freq = pll / d2 / prescalers[p];
+					bool fits = false;
+
+					if (prescalers[p] == 3 && !limits->has_pres3)
+						continue;
+					if (freq > limits->pck_max)
+						continue;
+					/* some divider must give a valid MCK */
+					for (mdiv = 1; mdiv <= 4; mdiv++) {
+						uint64_t mck = freq / mdiv;
+
+						if (mck > limits->mck_max)
+							continue;
+						if (limits->h32mx_max &&
+						    mck / 2 > limits->h32mx_max)
+							continue;
+						fits = true;
+					}
+					if (fits && error_ppb(freq, pck) < best)
+						best = error_ppb(freq, pck);
+				}
+			}
+		}
+	}
+	return best;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_error_ppm(void)
+{
+	CHECK(clksolve_error_ppm(1000000, 1000000) == 0);
+	CHECK(clksolve_error_ppm(1000001, 1000000) == 1);
+	CHECK(clksolve_error_ppm(999999, 1000000) == 1);
+	/* rounded up */
+	CHECK(clksolve_error_ppm(100000001, 100000000) == 1);
+	CHECK(clksolve_error_ppm(1010000, 1000000) == 10000);
+	CHECK(clksolve_error_ppm(0, 0) == 0);
+	CHECK(clksolve_error_ppm(1, 0) == UINT32_MAX);
+}
+
+static void test_socs(void)
+{
+	static const char* const names[] = {
+		"sama5d2", "sama5d3", "sama5d4", "sam9xx5",
+	};
+	unsigned i;
+
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+		const struct _clksolve_soc* soc = clksolve_get_soc(names[i]);
+
+		REQUIRE(soc != NULL);
+		CHECK(strcmp(soc->name, names[i]) == 0);
+		CHECK(soc->cpu.pll_min < soc->cpu.pll_max);
+	}
+	CHECK(clksolve_get_soc("sama5d2")->audio != NULL);
+	CHECK(clksolve_get_soc("foo") == NULL);
+}
+
+static void test_cpu_known(void)
+{
+	const struct _clksolve_soc* soc = clksolve_get_soc("sama5d2");
+	struct _clksolve_cpu sol;
+
+	/* Board default: PLLA 996MHz / 2, MCK / 3, H32MX / 2 */
+	REQUIRE(clksolve_cpu(&soc->cpu, MAIN_FREQ, 498000000, 166000000, 0, &sol) == 0);
+	CHECK(sol.mul == 82 && sol.div == 1 && sol.div2);
+	CHECK(sol.pres == 1 && sol.mdiv == 3 && sol.h32mx_div2);
+	CHECK(sol.pck == 498000000 && sol.mck == 166000000);
+	CHECK(sol.pck_error == 0 && sol.mck_error == 0);
+	check_cpu(&soc->cpu, &sol, 498000000, 166000000, 0);
+
+	/* Highest MCK allowed when not given */
+	REQUIRE(clksolve_cpu(&soc->cpu, MAIN_FREQ, 498000000, 0, 0, &sol) == 0);
+	CHECK(sol.mck == 166000000);
+
+	CHECK(clksolve_cpu(&soc->cpu, MAIN_FREQ, 498000001, 0, 0, &sol) == -ERANGE);
+	CHECK(clksolve_cpu(&soc->cpu, MAIN_FREQ, 600000000, 0, 100000, &sol) == -ERANGE);
+	CHECK(clksolve_cpu(&soc->cpu, MAIN_FREQ, 0, 0, 0, &sol) == -EINVAL);
+	CHECK(clksolve_cpu(&soc->cpu, 0, 498000000, 0, 0, &sol) == -EINVAL);
+}
+
+static void test_cpu_random(void)
+{
+	static const struct {
+		const char* soc;
+		int count;
+	} runs[] = {
+		{ "sama5d2", 300 },
+		{ "sama5d3", 300 },
+		{ "sama5d4", 300 },
+		/* DIVA makes the exhaustive search much longer */
+		{ "sam9xx5", 10 },
+	};
+	unsigned r;
+	int i, found = 0;
+
+	for (r = 0; r < sizeof(runs) / sizeof(runs[0]); r++) {
+		const struct _clksolve_soc* soc = clksolve_get_soc(runs[r].soc);
+
+		for (i = 0; i < runs[r].count; i++) {
+			struct _clksolve_cpu sol;
+			uint32_t pck = 50000000 + rnd() % (soc->cpu.pck_max - 50000000);
+			uint32_t tolerance = rnd() % 20000;
+			uint64_t best = best_cpu_error(&soc->cpu, pck);
+			int err = clksolve_cpu(&soc->cpu, MAIN_FREQ, pck, 0,
+					tolerance, &sol);
+
+			if (err == 0) {
+				found++;
+				check_cpu(&soc->cpu, &sol, pck, 0, tolerance);
+				CHECK(error_ppb(sol.pck, pck) == best);
+			} else {
+				CHECK(err == -ERANGE);
+				CHECK(best == UINT64_MAX ||
+				      (best + 999) / 1000 > tolerance);
+			}
+		}
+	}
+	/* Most targets have a solution */
+	CHECK(found > 500);
+}
+
+/* Recompute an audio solution from its fields and check it */
+static void check_audio(const struct _clksolve_audio_limits* limits,
+		const struct _clksolve_audio* sol, uint32_t pmc, uint32_t pad,
+		uint32_t tolerance)
+{
+	uint64_t vco = ((uint64_t)MAIN_FREQ *
+		(((uint64_t)(sol->nd + 1) << CLKSOLVE_AUDIO_FRACR_BITS) + sol->fracr))
+		>> CLKSOLVE_AUDIO_FRACR_BITS;
+
+	CHECK(sol->nd <= limits->nd_max);
+	CHECK(sol->fracr < (1u << CLKSOLVE_AUDIO_FRACR_BITS));
+	CHECK(sol->qdpmc <= limits->qdpmc_max);
+	CHECK(vco == sol->vco);
+	CHECK(vco >= limits->vco_min && vco <= limits->vco_max);
+	CHECK(sol->pmc == vco / (sol->qdpmc + 1));
+	CHECK(sol->pmc <= limits->pmc_max);
+	if (pmc)
+		CHECK(sol->pmc_error == clksolve_error_ppm(sol->pmc, pmc) &&
+		      sol->pmc_error <= tolerance);
+	if (pad) {
+		CHECK(sol->div == 2 || sol->div == 3);
+		CHECK(sol->qdaudio >= 1 && sol->qdaudio <= limits->qdaudio_max);
+		CHECK(sol->pad == vco / (sol->div * sol->qdaudio));
+		CHECK(sol->pad >= limits->pad_min && sol->pad <= limits->pad_max);
+		CHECK(sol->pad_error == clksolve_error_ppm(sol->pad, pad) &&
+		      sol->pad_error <= tolerance);
+	} else {
+		CHECK(sol->qdaudio == 0);
+	}
+}
+
+static void test_audio(void)
+{
+	const struct _clksolve_audio_limits* limits =
+		clksolve_get_soc("sama5d2")->audio;
+	struct _clksolve_audio sol;
+	int i, found = 0;
+
+	/* 48kHz family: 98.304MHz PMC clock, 12.288MHz I2S master clock */
+	REQUIRE(clksolve_audio(limits, MAIN_FREQ, 98304000, 12288000, 1, &sol) == 0);
+	check_audio(limits, &sol, 98304000, 12288000, 1);
+	REQUIRE(clksolve_audio(limits, MAIN_FREQ, 0, 11289600, 1, &sol) == 0);
+	check_audio(limits, &sol, 0, 11289600, 1);
+	CHECK(sol.qdpmc == limits->qdpmc_max);
+
+	CHECK(clksolve_audio(limits, MAIN_FREQ, 0, 0, 50, &sol) == -EINVAL);
+	CHECK(clksolve_audio(limits, MAIN_FREQ, 200000000, 0, 50, &sol) == -ERANGE);
+	CHECK(clksolve_audio(limits, MAIN_FREQ, 0, 60000000, 50, &sol) == -ERANGE);
+
+	for (i = 0; i < 2000; i++) {
+		uint32_t pmc = 24000000 + rnd() % 100000000;
+		uint32_t pad = rnd() % 2 ? 8000000 + rnd() % 40000000 : 0;
+
+		if (clksolve_audio(limits, MAIN_FREQ, pmc, pad, 50, &sol) == 0) {
+			found++;
+			check_audio(limits, &sol, pmc, pad, 50);
+		}
+	}
+	CHECK(found > 1000);
+}
+
+static void test_gck(void)
+{
+	static const uint32_t sources[CLKSOLVE_GCK_SOURCES] = {
+		32768, 12000000, 0, 166000000, 480000000, 83000000,
+	};
+	struct _clksolve_gck sol;
+	int i;
+
+	/* Slowest source on equal errors */
+	REQUIRE(clksolve_gck(sources, 100000000, 12000000, 0, &sol) == 0);
+	CHECK(sol.source == 1 && sol.div == 1 && sol.freq == 12000000);
+	REQUIRE(clksolve_gck(sources, 100000000, 32768, 0, &sol) == 0);
+	CHECK(sol.source == 0 && sol.div == 1);
+	REQUIRE(clksolve_gck(sources, 100000000, 41500000, 0, &sol) == 0);
+	CHECK(sol.source == 5 && sol.div == 2);
+
+	CHECK(clksolve_gck(sources, 100000000, 0, 0, &sol) == -EINVAL);
+	CHECK(clksolve_gck(sources, 100000000, 120000000, 1000, &sol) == -ERANGE);
+
+	for (i = 0; i < 2000; i++) {
+		uint32_t target = 100000 + rnd() % 99900000;
+		uint32_t max = 100000000;
+		uint64_t best = UINT64_MAX;
+		uint32_t best_freq = 0;
+		unsigned src, d;
+
+		for (src = 0; src < CLKSOLVE_GCK_SOURCES; src++) {
+			if (!sources[src])
+				continue;
+			for (d = 1; d <= 256; d++) {
+				uint32_t out = sources[src] / d;
+
+				if (out > max)
+					continue;
+				if (error_ppb(out, target) < best) {
+					best = error_ppb(out, target);
+					best_freq = sources[src];
+				} else if (error_ppb(out, target) == best &&
+					   sources[src] < best_freq) {
+					best_freq = sources[src];
+				}
+			}
+		}
+
+		REQUIRE(clksolve_gck(sources, max, target, UINT32_MAX, &sol) == 0);
+		CHECK(sol.div >= 1 && sol.div <= 256);
+		CHECK(sol.freq == sources[sol.source] / sol.div);
+		CHECK(sol.freq <= max);
+		CHECK(sol.error == clksolve_error_ppm(sol.freq, target));
+		CHECK(error_ppb(sol.freq, target) == best);
+		CHECK(sources[sol.source] == best_freq);
+	}
+}
+
+int main(void)
+{
+	test_error_ppm();
+	test_socs();
+	test_cpu_known();
+	test_cpu_random();
+	test_audio();
+	test_gck();
+	return host_test_end("clksolve");
+}
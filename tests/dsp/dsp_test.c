@@ -0,0 +1,713 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the signal processing library: the biquad cascade against a
+ * double precision model using the same coefficients, the block kernels
+ * against direct computations, the voice activity detector and the AGC on
+ * synthetic signals, and the voice front end against the cascade followed
+ * by decimation.
+ *
+ * The outputs of the kernels are also written to a file with -o, or
+ * compared with such a file with -c: the Makefile uses this to check that
+ * the portable and the SIMD variants give the same results.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "dsp/dsp.h"
+#include "dsp/biquad.h"
+#include "dsp/frontend.h"
+
+#include "host_test.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated cycle counter
+ *----------------------------------------------------------------------------*/
+
+uint32_t host_cycles;
+uint32_t host_cycle_step;
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+#ifdef DSP_EMULATE_SIMD32
+#define TEST_NAME "dsp (simd)"
+#else
+#define TEST_NAME "dsp"
+#endif
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+/* uniform in [-1, 1) */
+static double rnd_unit(void)
+{
+	return (double)(rnd() & 0xffff) / 32768.0 - 1.0;
+}
+
+static int16_t clamp16(double v)
+{
+	v = floor(v + 0.5);
+	return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+static FILE* out_file;
+static FILE* cmp_file;
+static unsigned cmp_mismatches;
+
+/* Write the output of a kernel with -o, compare it with -c */
+static void record(const void* data, size_t size)
+{
+	static uint8_t ref[65536];
+
+	if (out_file)
+		fwrite(data, 1, size, out_file);
+	if (cmp_file) {
+		if (size > sizeof(ref) || fread(ref, 1, size, cmp_file) != size ||
+		    memcmp(ref, data, size) != 0)
+			cmp_mismatches++;
+	}
+}
+
+static double rms(const int16_t* x, uint32_t count)
+{
+	double sum = 0;
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		sum += (double)x[i] * x[i];
+	return count ? sqrt(sum / count) : 0;
+}
+
+/* Direct form I model with the same Q14 coefficients, without rounding */
+struct ref_stage {
+	double x1, x2, y1, y2;
+};
+
+static double ref_stage_run(const struct _dsp_biquad_coef* c,
+		struct ref_stage* st, double x0)
+{
+	double y = (c->b0 * x0 + c->b1 * st->x1 + c->b2 * st->x2 +
+		    c->a1 * st->y1 + c->a2 * st->y2) / 16384.0;
+
+	st->x2 = st->x1;
+	st->x1 = x0;
+	st->y2 = st->y1;
+	st->y1 = y;
+	return y;
+}
+
+/* Magnitude of the response of a stage at f / fs */
+static double stage_gain(const struct _dsp_biquad_coef* c, double f)
+{
+	double w = 2 * M_PI * f;
+	double nr = c->b0 + c->b1 * cos(w) + c->b2 * cos(2 * w);
+	double ni = -c->b1 * sin(w) - c->b2 * sin(2 * w);
+	double dr = 16384.0 - c->a1 * cos(w) - c->a2 * cos(2 * w);
+	double di = c->a1 * sin(w) + c->a2 * sin(2 * w);
+
+	return sqrt((nr * nr + ni * ni) / (dr * dr + di * di));
+}
+
+/* A vowel-like tone: two harmonics of 220 Hz modulated at 4 Hz */
+static double voice(double t)
+{
+	return (sin(2 * M_PI * 220 * t) + 0.5 * sin(2 * M_PI * 660 * t)) *
+		(0.6 + 0.4 * sin(2 * M_PI * 4 * t));
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_biquad_design(void)
+{
+	static const float fcs[] = { 50, 100, 300, 1000, 4000, 7000 };
+	struct _dsp_biquad_coef c;
+	unsigned i;
+
+	for (i = 0; i < sizeof(fcs) / sizeof(fcs[0]); i++) {
+		double fc = fcs[i] / 16000.0;
+
+		dsp_biquad_highpass(&c, 16000, fcs[i], 0.7071f);
+		/* the zeros are exactly at DC */
+		CHECK(c.b0 + c.b1 + c.b2 == 0);
+		CHECK(fabs(stage_gain(&c, 0.499) - 1) < 0.01);
+		CHECK(fabs(stage_gain(&c, fc) - M_SQRT1_2) < 0.03);
+		CHECK(stage_gain(&c, fc / 2) < 0.3);
+		record(&c, sizeof(c));
+
+		/* the Q14 low-pass coefficients lack resolution at low
+		 * cutoffs */
+		if (fcs[i] < 300)
+			continue;
+		dsp_biquad_lowpass(&c, 16000, fcs[i], 0.7071f);
+		CHECK(fabs(stage_gain(&c, 0) - 1) < 0.01);
+		CHECK(fabs(stage_gain(&c, fc) - M_SQRT1_2) < 0.03);
+		if (fc < 0.25)
+			CHECK(stage_gain(&c, fc * 2) < 0.3);
+		record(&c, sizeof(c));
+	}
+}
+
+static void test_biquad_reference(void)
+{
+	enum { N = 32000 };
+	static int16_t x[N], y[N], z[N];
+	struct _dsp_biquad_coef c[2];
+	struct _dsp_biquad_state s[2];
+	struct ref_stage ref[2];
+	struct _dsp_biquad bq;
+	double max_err = 0, dc = 0;
+	uint32_t i, n;
+
+	/* HP 100 Hz + LP 4 kHz at 16 kHz on a tone with noise and DC */
+	dsp_biquad_highpass(&c[0], 16000, 100, 0.7071f);
+	dsp_biquad_lowpass(&c[1], 16000, 4000, 0.7071f);
+	for (i = 0; i < N; i++)
+		x[i] = clamp16(8000 * sin(2 * M_PI * 1000 * i / 16000.0) +
+			       3000 + 2000 * rnd_unit());
+
+	/* In place, in blocks of random sizes (including empty ones) */
+	dsp_biquad_init(&bq, c, s, 2);
+	memcpy(y, x, sizeof(x));
+	for (i = 0; i < N; i += n) {
+		n = rnd() % 300;
+		if (n > N - i)
+			n = N - i;
+		dsp_biquad_process(&bq, y + i, y + i, n);
+	}
+	record(y, sizeof(y));
+
+	/* In one block, to another buffer: the same result */
+	memset(s, 0x5a, sizeof(s));
+	dsp_biquad_init(&bq, c, s, 2);
+	dsp_biquad_process(&bq, x, z, N);
+	CHECK(memcmp(y, z, sizeof(y)) == 0);
+
+	memset(ref, 0, sizeof(ref));
+	for (i = 0; i < N; i++) {
+		double v = ref_stage_run(&c[0], &ref[0], x[i]);
+
+		v = ref_stage_run(&c[1], &ref[1], v);
+		if (fabs(v - y[i]) > max_err)
+			max_err = fabs(v - y[i]);
+		if (i >= N / 2)
+			dc += y[i];
+	}
+	CHECK(max_err <= 8);
+	/* the 3000 LSB of DC are removed */
+	CHECK(fabs(dc / (N / 2)) < 1);
+}
+
+static void test_biquad_dc_removal(void)
+{
+	static const float fcs[] = { 20, 50, 100 };
+	struct _dsp_biquad_coef c;
+	struct _dsp_biquad_state s;
+	struct _dsp_biquad bq;
+	int16_t x[1000];
+	unsigned i, k, block;
+	int max_tail;
+
+	/* Constant input through low cutoff high-pass filters at 16 kHz: the
+	 * output settles to zero, without an offset or limit cycles */
+	for (i = 0; i < sizeof(fcs) / sizeof(fcs[0]); i++) {
+		dsp_biquad_highpass(&c, 16000, fcs[i], 0.7071f);
+		dsp_biquad_init(&bq, &c, &s, 1);
+		max_tail = 0;
+		for (block = 0; block < 64; block++) {
+			for (k = 0; k < 1000; k++)
+				x[k] = -12345;
+			dsp_biquad_process(&bq, x, x, 1000);
+			if (block >= 48)
+				for (k = 0; k < 1000; k++)
+					if (abs(x[k]) > max_tail)
+						max_tail = abs(x[k]);
+			record(x, sizeof(x));
+		}
+		CHECK(max_tail == 0);
+	}
+}
+
+static void test_biquad_saturation(void)
+{
+	struct _dsp_biquad_coef c;
+	struct _dsp_biquad_state s;
+	struct _dsp_biquad bq;
+	int16_t x[400];
+	int16_t min = 0, max = 0;
+	unsigned i;
+
+	/* A resonant low-pass stage overshoots on full scale steps: the output
+	 * saturates instead of wrapping */
+	dsp_biquad_lowpass(&c, 16000, 1000, 4.0f);
+	dsp_biquad_init(&bq, &c, &s, 1);
+	for (i = 0; i < 400; i++)
+		x[i] = (i / 100) % 2 ? -32768 : 32767;
+	dsp_biquad_process(&bq, x, x, 400);
+	record(x, sizeof(x));
+	for (i = 0; i < 400; i++) {
+		if (x[i] < min)
+			min = x[i];
+		if (x[i] > max)
+			max = x[i];
+		/* no wrap: the sign follows the step once past the start */
+		if (i % 100 >= 10)
+			CHECK((x[i] < 0) == ((i / 100) % 2 == 1));
+	}
+	CHECK(max == 32767);
+	CHECK(min == -32768);
+}
+
+static void test_energy(void)
+{
+	static int16_t buf[1030];
+	uint64_t ref, energy;
+	unsigned i, k, len, off;
+
+	for (i = 0; i < 3000; i++) {
+		len = i < 64 ? i : rnd() % 1025;
+		off = rnd() % 4;
+		for (k = 0; k < len; k++)
+			buf[off + k] = i % 10 == 0 ? -32768 : (int16_t)rnd();
+		ref = 0;
+		for (k = 0; k < len; k++)
+			ref += (uint64_t)((int64_t)buf[off + k] * buf[off + k]);
+		energy = dsp_energy_q15(buf + off, len);
+		CHECK(energy == ref);
+		record(&energy, sizeof(energy));
+	}
+}
+
+static void test_zero_crossings(void)
+{
+	int16_t buf[300];
+	int16_t last = 0, prev = 0;
+	uint32_t total = 0, ref = 0;
+	unsigned i, k, len;
+
+	for (i = 0; i < 1000; i++) {
+		len = rnd() % 300;
+		for (k = 0; k < len; k++) {
+			switch (rnd() % 4) {
+			case 0:
+				buf[k] = 0;
+				break;
+			case 1:
+				buf[k] = -1;
+				break;
+			default:
+				buf[k] = (int16_t)rnd();
+			}
+			/* zero counts as positive */
+			ref += (prev < 0) != (buf[k] < 0);
+			prev = buf[k];
+		}
+		total += dsp_zero_crossings(buf, len, &last);
+		CHECK(last == prev);
+	}
+	CHECK(total == ref);
+}
+
+static void test_isqrt(void)
+{
+	static const uint64_t values[] = {
+		0, 1, 2, 3, 4, 15, 16, 17, 1ull << 60, (1ull << 62) - 1,
+		1ull << 62, 0xfffffffe00000001ull, 0xfffffffe00000000ull,
+		UINT64_MAX,
+	};
+	unsigned i;
+
+	CHECK(dsp_isqrt64(1ull << 60) == 1u << 30);
+	CHECK(dsp_isqrt64(UINT64_MAX) == 0xffffffffu);
+	CHECK(dsp_isqrt64(0xfffffffe00000001ull) == 0xffffffffu);
+	CHECK(dsp_isqrt64(0xfffffffe00000000ull) == 0xfffffffeu);
+
+	for (i = 0; i < sizeof(values) / sizeof(values[0]) + 100000; i++) {
+		uint64_t x, r;
+
+		if (i < sizeof(values) / sizeof(values[0]))
+			x = values[i];
+		else
+			x = (((uint64_t)rnd() << 40) ^ ((uint64_t)rnd() << 16) ^
+			     rnd()) >> (rnd() % 64);
+		r = dsp_isqrt64(x);
+		/* r = floor(sqrt(x)) */
+		CHECK(r * r <= x);
+		CHECK(r == 0xffffffffu || (r + 1) * (r + 1) > x);
+	}
+}
+
+static void fill_block(int16_t* x, uint32_t count, uint32_t start,
+		double fs, double voice_amp, double noise_amp, double hiss_amp)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		double t = (start + i) / fs;
+
+		x[i] = clamp16(voice_amp * voice(t) + noise_amp * rnd_unit() +
+			       hiss_amp * ((start + i) % 2 ? 1 : -1));
+	}
+}
+
+static void fill_tone(int16_t* x, uint32_t count, uint32_t start,
+		double amp)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		x[i] = clamp16(amp * sin(2 * M_PI * 440 * (start + i) / 16000.0));
+}
+
+static void test_vad(void)
+{
+	struct _dsp_vad vad;
+	int16_t x[160];
+	uint32_t pos = 0;
+	unsigned b, active;
+
+	dsp_vad_init(&vad, 100, 4 << 8, 90, 300, 10);
+
+	/* Quiet background: below the absolute floor */
+	for (b = 0; b < 50; b++, pos += 160) {
+		fill_block(x, 160, pos, 16000, 0, 10, 0);
+		CHECK(!dsp_vad_process(&vad, x, 160, dsp_energy_q15(x, 160)));
+	}
+
+	/* Background at about 40 dB below the voice */
+	for (b = 0; b < 50; b++, pos += 160) {
+		fill_block(x, 160, pos, 16000, 0, 60, 0);
+		CHECK(!dsp_vad_process(&vad, x, 160, dsp_energy_q15(x, 160)));
+	}
+
+	/* A word: detected from the first block */
+	for (b = 0; b < 10; b++, pos += 160) {
+		fill_block(x, 160, pos, 16000, 3000, 60, 0);
+		CHECK(dsp_vad_process(&vad, x, 160, dsp_energy_q15(x, 160)));
+		CHECK(vad.speech);
+	}
+
+	/* Held for exactly the hangover after the voice stops, empty blocks
+	 * keeping the state */
+	for (b = 0; b < 30; b++, pos += 160) {
+		bool a;
+
+		fill_block(x, 160, pos, 16000, 0, 60, 0);
+		a = dsp_vad_process(&vad, x, 160, dsp_energy_q15(x, 160));
+		CHECK(!vad.speech);
+		CHECK(a == (b < 10));
+		CHECK(dsp_vad_process(&vad, x, 0, 0) == a);
+	}
+
+	/* Loud hiss crosses zero too often to be voice */
+	for (b = 0; b < 30; b++, pos += 160) {
+		fill_block(x, 160, pos, 16000, 0, 60, 3000);
+		CHECK(!dsp_vad_process(&vad, x, 160, dsp_energy_q15(x, 160)));
+	}
+
+	/* A steady tone starting in silence becomes background as the noise
+	 * floor rises to it */
+	dsp_vad_init(&vad, 100, 4 << 8, 90, 300, 10);
+	active = 0;
+	for (b = 0; b < 2000; b++, pos += 160) {
+		fill_tone(x, 160, pos, 1000);
+		active += dsp_vad_process(&vad, x, 160,
+					  dsp_energy_q15(x, 160));
+	}
+	CHECK(active > 10);
+	CHECK(active < 1000);
+	CHECK(!vad.active);
+
+	/* After digital silence, a faint tone under the absolute floor is not
+	 * voice, even far above the noise floor. The noise floor creeps up to
+	 * it, so that a tone just above the absolute floor is not voice
+	 * either */
+	dsp_vad_init(&vad, 100, 4 << 8, 90, 300, 10);
+	memset(x, 0, sizeof(x));
+	for (b = 0; b < 10; b++)
+		CHECK(!dsp_vad_process(&vad, x, 160, 0));
+	CHECK(vad.noise == 1);
+	for (b = 0; b < 200; b++, pos += 160) {
+		fill_tone(x, 160, pos, 10);
+		CHECK(!dsp_vad_process(&vad, x, 160,
+				       dsp_energy_q15(x, 160)));
+	}
+	CHECK(vad.noise > 40);
+	for (b = 0; b < 10; b++, pos += 160) {
+		fill_tone(x, 160, pos, 17);
+		CHECK(!dsp_vad_process(&vad, x, 160,
+				       dsp_energy_q15(x, 160)));
+	}
+}
+
+static void test_agc(void)
+{
+	static const double levels[] = { 300, 2000, 12000 };
+	const int16_t target = DSP_Q15(0.1);
+	struct _dsp_agc agc;
+	int16_t x[160];
+	uint32_t pos = 0;
+	unsigned l, b, i;
+
+	/* Steady tones 32 dB apart are brought to the target level */
+	dsp_agc_init(&agc, target, DSP_Q15(0.5), DSP_Q15(0.05),
+		     DSP_AGC_GAIN(0.25), DSP_AGC_GAIN(32));
+	for (l = 0; l < sizeof(levels) / sizeof(levels[0]); l++) {
+		double out = 0;
+
+		for (b = 0; b < 300; b++, pos += 160) {
+			fill_tone(x, 160, pos, levels[l]);
+			dsp_agc_update(&agc, dsp_energy_q15(x, 160), 160);
+			dsp_agc_apply(&agc, x, 160);
+			record(x, sizeof(x));
+			if (b >= 200)
+				out += rms(x, 160);
+		}
+		out /= 100;
+		CHECK(fabs(20 * log10(out / target)) < 0.2);
+	}
+
+	/* The gain is bounded */
+	for (b = 0; b < 300; b++, pos += 160) {
+		fill_tone(x, 160, pos, 30);
+		dsp_agc_update(&agc, dsp_energy_q15(x, 160), 160);
+		dsp_agc_apply(&agc, x, 160);
+	}
+	CHECK(agc.gain == DSP_AGC_GAIN(32));
+	for (b = 0; b < 300; b++, pos += 160) {
+		fill_tone(x, 160, pos, 32767);
+		dsp_agc_update(&agc, dsp_energy_q15(x, 160), 160);
+		dsp_agc_apply(&agc, x, 160);
+	}
+	CHECK(agc.gain == DSP_AGC_GAIN(0.25));
+
+	/* The gain ramps over the block: on a constant input, the output
+	 * moves monotonically from the previous gain to the new one */
+	dsp_agc_init(&agc, target, 32767, 32767, DSP_AGC_GAIN(0.25),
+		     DSP_AGC_GAIN(32));
+	for (i = 0; i < 160; i++)
+		x[i] = target / 4;
+	dsp_agc_update(&agc, dsp_energy_q15(x, 160), 160);
+	CHECK(agc.next_gain > DSP_AGC_GAIN(3.9));
+	CHECK(agc.next_gain < DSP_AGC_GAIN(4.1));
+	dsp_agc_apply(&agc, x, 160);
+	CHECK(agc.gain == agc.next_gain);
+	CHECK(abs(x[0] - target / 4) <= 30);
+	CHECK(abs(x[159] - target) <= 30);
+	for (i = 1; i < 160; i++)
+		CHECK(x[i] >= x[i - 1] && x[i] - x[i - 1] <= 30);
+
+	/* Saturated, not wrapped */
+	dsp_agc_init(&agc, 30000, 32767, 32767, DSP_AGC_GAIN(8),
+		     DSP_AGC_GAIN(8));
+	for (i = 0; i < 160; i++)
+		x[i] = i % 2 ? 20000 : -20000;
+	dsp_agc_update(&agc, dsp_energy_q15(x, 160), 160);
+	dsp_agc_apply(&agc, x, 160);
+	dsp_agc_apply(&agc, x, 160);
+	for (i = 0; i < 160; i++)
+		CHECK(x[i] == (i % 2 ? 32767 : -32768));
+
+	/* Empty blocks are ignored */
+	dsp_agc_update(&agc, 0, 0);
+	dsp_agc_apply(&agc, x, 0);
+	CHECK(agc.gain == DSP_AGC_GAIN(8));
+}
+
+static void test_frontend_decimation(void)
+{
+	enum { N = 48000 };
+	static int16_t x[N], y[N], ref[N / 3];
+	struct _dsp_biquad_coef c[3];
+	struct _dsp_biquad_state s[3], rs[3];
+	struct _dsp_frontend fe;
+	struct _dsp_frontend_stats stats;
+	struct _dsp_biquad bq;
+	uint32_t i, n, count, out = 0, blocks = 0, max = 0;
+	uint64_t total = 0;
+
+	dsp_biquad_highpass(&c[0], 48000, 80, 0.7071f);
+	dsp_biquad_lowpass(&c[1], 48000, 6500, 0.5412f);
+	dsp_biquad_lowpass(&c[2], 48000, 6500, 1.3066f);
+	for (i = 0; i < N; i++)
+		x[i] = clamp16(5000 * voice(i / 48000.0) + 4000 +
+			       3000 * rnd_unit());
+
+	/* The cascade then one sample out of 3 */
+	dsp_biquad_init(&bq, c, rs, 3);
+	dsp_biquad_process(&bq, x, y, N);
+	for (i = 0; i < N; i += 3)
+		ref[i / 3] = y[i];
+
+	/* The front end on blocks of any size, with a unity gain AGC; the
+	 * simulated counter advances by the block size at each read */
+	dsp_frontend_init(&fe, c, s, 3, 3);
+	dsp_vad_init(&fe.vad, 100, 4 << 8, 90, 300, 10);
+	dsp_agc_init(&fe.agc, DSP_Q15(0.1), DSP_Q15(0.5), DSP_Q15(0.05),
+		     DSP_AGC_GAIN(1), DSP_AGC_GAIN(1));
+	for (i = 0; i < N; i += n) {
+		n = i < 10 ? 1 : rnd() % 700;
+		if (n > N - i)
+			n = N - i;
+		memcpy(y, x + i, n * sizeof(x[0]));
+		host_cycle_step = n;
+		count = dsp_frontend_process(&fe, y, n, NULL);
+		/* the outputs are the input samples 0, 3, 6... of the stream */
+		REQUIRE(count == (i + n + 2) / 3 - (i + 2) / 3);
+		CHECK(memcmp(y, ref + out, count * sizeof(y[0])) == 0);
+		record(y, count * sizeof(y[0]));
+		out += count;
+		blocks++;
+		total += n;
+		if (n > max)
+			max = n;
+		CHECK(fe.stats.cycles_last == n);
+	}
+	CHECK(out == N / 3);
+
+	dsp_frontend_get_stats(&fe, &stats);
+	CHECK(stats.blocks == blocks);
+	CHECK(stats.active_blocks > 0);
+	CHECK(stats.active_blocks < blocks);
+	CHECK(stats.cycles_total == total);
+	CHECK(stats.cycles_max == max);
+	host_cycle_step = 0;
+}
+
+static void test_frontend_voice(void)
+{
+	struct _dsp_biquad_coef c[3];
+	struct _dsp_biquad_state s[3];
+	struct _dsp_frontend fe;
+	int16_t x[480];
+	unsigned b, speech_blocks = 0, speech_active = 0, noise_active = 0;
+	double out[2] = { 0, 0 };
+	unsigned out_blocks[2] = { 0, 0 };
+	bool active;
+
+	/* 48 kHz to 16 kHz with DC, background noise and bursts of voice,
+	 * 16 dB louder in the first half */
+	dsp_biquad_highpass(&c[0], 48000, 80, 0.7071f);
+	dsp_biquad_lowpass(&c[1], 48000, 6500, 0.5412f);
+	dsp_biquad_lowpass(&c[2], 48000, 6500, 1.3066f);
+	dsp_frontend_init(&fe, c, s, 3, 3);
+	dsp_vad_init(&fe.vad, 100, 4 << 8, 90, 300, 10);
+	dsp_agc_init(&fe.agc, DSP_Q15(0.1), DSP_Q15(0.5), DSP_Q15(0.05),
+		     DSP_AGC_GAIN(0.25), DSP_AGC_GAIN(32));
+
+	for (b = 0; b < 1000; b++) {
+		bool speech = (b / 100) % 2 == 1;
+		double amp = speech ? (b < 500 ? 2000 : 300) : 0;
+		uint32_t count, i;
+		int32_t gain = fe.agc.gain;
+
+		fill_block(x, 480, b * 480, 48000, amp, 60, 0);
+		for (i = 0; i < 480; i++)
+			x[i] = clamp16(x[i] + 4000);
+		count = dsp_frontend_process(&fe, x, 480, &active);
+		CHECK(count == 160);
+		record(x, count * sizeof(x[0]));
+
+		if (speech) {
+			speech_blocks++;
+			speech_active += active;
+			if (b % 100 > 30) {
+				out[b >= 500] += rms(x, count);
+				out_blocks[b >= 500]++;
+			}
+		} else {
+			/* the gain is frozen without voice */
+			if (!active)
+				CHECK(fe.agc.gain == gain);
+			if (b % 100 > 15)
+				noise_active += active;
+		}
+	}
+
+	CHECK(speech_active >= speech_blocks * 9 / 10);
+	CHECK(noise_active == 0);
+	/* Both voice levels give the same output, a bit below the target as
+	 * the envelope follows the syllable peaks */
+	out[0] /= out_blocks[0];
+	out[1] /= out_blocks[1];
+	CHECK(fabs(20 * log10(out[0] / out[1])) < 0.5);
+	CHECK(out[0] < DSP_Q15(0.1));
+	CHECK(out[0] > DSP_Q15(0.1) / 2);
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 2 && strcmp(argv[1], "-o") == 0) {
+		out_file = fopen(argv[2], "wb");
+		REQUIRE(out_file);
+	} else if (argc > 2 && strcmp(argv[1], "-c") == 0) {
+		cmp_file = fopen(argv[2], "rb");
+		REQUIRE(cmp_file);
+	}
+
+	test_biquad_design();
+	test_biquad_reference();
+	test_biquad_dc_removal();
+	test_biquad_saturation();
+	test_energy();
+	test_zero_crossings();
+	test_isqrt();
+	test_vad();
+	test_agc();
+	test_frontend_decimation();
+	test_frontend_voice();
+
+	if (out_file)
+		fclose(out_file);
+	if (cmp_file) {
+		/* same outputs, and no more */
+		CHECK(cmp_mismatches == 0);
+		CHECK(fgetc(cmp_file) == EOF);
+		fclose(cmp_file);
+	}
+	return host_test_end(TEST_NAME);
+}
@@ -0,0 +1,570 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the frequency scaling driver. The PMC is simulated: it
+ * computes the processor, master and H32MX clocks after each change so that
+ * every transition between the operating points below can be checked for
+ * its final clocks, the highest intermediate clocks, PLL reprogramming while
+ * it feeds MCK, and the interrupt mask. The governor runs on a fake clock
+ * advanced by cpu_idle().
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "cpuidle.h"
+#include "irqflags.h"
+#include "peripherals/pmc.h"
+#include "power/dvfs.h"
+#include "timer.h"
+#include "trace.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+bool host_irq_enabled = true;
+
+/*----------------------------------------------------------------------------
+ *        Simulated PMC
+ *----------------------------------------------------------------------------*/
+
+#define MAIN_FREQ  12000000u
+#define UPLL_FREQ  480000000u
+#define H32MX_MAX  83000000u
+
+static struct {
+	uint32_t css;
+	uint32_t pres;
+	uint32_t mdiv;
+	bool h32mx_div2;
+	bool plla_enabled;
+	struct _pmc_plla_cfg plla;
+	bool upll_enabled;
+
+	/* Recorded since the last pmc_reset_record() */
+	unsigned calls;          /* clock changes */
+	unsigned unmasked_calls; /* clock changes with interrupts enabled */
+	unsigned plla_changes;   /* PLLA reprogrammed or disabled */
+	unsigned plla_errors;    /* ... while it fed the master clock */
+	uint32_t pck_peak;
+	uint32_t mck_peak;
+	uint32_t h32mx_peak;
+} pmc;
+
+static uint32_t pmc_pck(void)
+{
+	uint32_t freq;
+
+	switch (pmc.css) {
+	case PMC_MCKR_CSS_MAIN_CLK:
+		freq = MAIN_FREQ;
+		break;
+	case PMC_MCKR_CSS_PLLA_CLK:
+		if (!pmc.plla_enabled)
+			return 0;
+		freq = MAIN_FREQ / pmc.plla.div * (pmc.plla.mul + 1);
+		break;
+	case PMC_MCKR_CSS_UPLL_CLK:
+		freq = pmc.upll_enabled ? UPLL_FREQ : 0;
+		break;
+	default:
+		freq = 32768;
+		break;
+	}
+	return freq >> pmc.pres;
+}
+
+static uint32_t pmc_mck(void)
+{
+	return pmc_pck() / pmc.mdiv;
+}
+
+static uint32_t pmc_h32mx(void)
+{
+	return pmc.h32mx_div2 ? pmc_mck() / 2 : pmc_mck();
+}
+
+static void pmc_changed(void)
+{
+	pmc.calls++;
+	if (host_irq_enabled)
+		pmc.unmasked_calls++;
+	if (pmc_pck() > pmc.pck_peak)
+		pmc.pck_peak = pmc_pck();
+	if (pmc_mck() > pmc.mck_peak)
+		pmc.mck_peak = pmc_mck();
+	if (pmc_h32mx() > pmc.h32mx_peak)
+		pmc.h32mx_peak = pmc_h32mx();
+}
+
+static void pmc_reset_record(void)
+{
+	pmc.calls = 0;
+	pmc.unmasked_calls = 0;
+	pmc.plla_changes = 0;
+	pmc.plla_errors = 0;
+	pmc.pck_peak = pmc_pck();
+	pmc.mck_peak = pmc_mck();
+	pmc.h32mx_peak = pmc_h32mx();
+}
+
+void pmc_switch_mck_to_main(void)
+{
+	pmc.css = PMC_MCKR_CSS_MAIN_CLK;
+	pmc_changed();
+}
+
+void pmc_switch_mck_to_new_source(uint32_t mckr_css)
+{
+	pmc.css = mckr_css;
+	pmc_changed();
+}
+
+void pmc_set_mck_prescaler(uint32_t prescaler)
+{
+	pmc.pres = prescaler;
+	pmc_changed();
+}
+
+void pmc_set_mck_divider(uint32_t divider)
+{
+	pmc.mdiv = divider;
+	pmc_changed();
+}
+
+void pmc_set_mck_h32mxdiv(bool div2)
+{
+	pmc.h32mx_div2 = div2;
+	pmc_changed();
+}
+
+void pmc_configure_plla(const struct _pmc_plla_cfg* plla)
+{
+	pmc.plla_changes++;
+	if (pmc.css == PMC_MCKR_CSS_PLLA_CLK)
+		pmc.plla_errors++;
+	pmc.plla = *plla;
+	pmc.plla_enabled = true;
+	pmc_changed();
+}
+
+void pmc_disable_plla(void)
+{
+	pmc.plla_changes++;
+	if (pmc.css == PMC_MCKR_CSS_PLLA_CLK)
+		pmc.plla_errors++;
+	pmc.plla_enabled = false;
+	pmc_changed();
+}
+
+bool pmc_is_upll_clock_enabled(void)
+{
+	return pmc.upll_enabled;
+}
+
+void pmc_enable_upll_clock(void)
+{
+	pmc.upll_enabled = true;
+	pmc_changed();
+}
+
+uint32_t pmc_get_master_clock(void)
+{
+	return pmc_mck();
+}
+
+/* Put the PMC at an operating point, as after reset and clock setup */
+static void pmc_set_state(const struct _dvfs_opp* opp)
+{
+	memset(&pmc, 0, sizeof(pmc));
+	pmc.css = opp->cfg.pck_input;
+	pmc.pres = opp->cfg.pck_pres;
+	pmc.mdiv = opp->cfg.mck_div;
+	pmc.h32mx_div2 = opp->cfg.h32mx_div2;
+	if (opp->cfg.pck_input == PMC_MCKR_CSS_PLLA_CLK) {
+		pmc.plla = opp->cfg.plla;
+		pmc.plla_enabled = true;
+	}
+	pmc.upll_enabled = opp->cfg.pck_input == PMC_MCKR_CSS_UPLL_CLK;
+	pmc_reset_record();
+}
+
+/*----------------------------------------------------------------------------
+ *        Fake time
+ *----------------------------------------------------------------------------*/
+
+static uint64_t now_us;
+static uint64_t idle_us; /* time spent in each cpu_idle() call */
+
+uint64_t timer_get_us(void)
+{
+	return now_us;
+}
+
+void cpu_idle(void)
+{
+	now_us += idle_us;
+}
+
+/*----------------------------------------------------------------------------
+ *        Operating points
+ *----------------------------------------------------------------------------*/
+
+#define OPP(_name, _input, _mul, _pres, _div, _h32mx_div2, _pck, _mck) \
+	{ .name = _name, \
+	  .cfg = { .pck_input = _input, .plla = { _mul, 1, 0x3f }, \
+		   .pck_pres = _pres, .mck_div = _div, \
+		   .h32mx_div2 = _h32mx_div2 }, \
+	  .pck = _pck, .mck = _mck }
+
+/* PLLA at 996MHz */
+static const struct _dvfs_opp opps[] = {
+	OPP("main", PMC_MCKR_CSS_MAIN_CLK, 0, 0, 1, false, 12000000, 12000000),
+	OPP("low", PMC_MCKR_CSS_PLLA_CLK, 82, 2, 3, false, 249000000, 83000000),
+	OPP("upll", PMC_MCKR_CSS_UPLL_CLK, 0, 0, 3, true, 480000000, 160000000),
+	OPP("mid", PMC_MCKR_CSS_PLLA_CLK, 82, 1, 4, true, 498000000, 124500000),
+	OPP("high", PMC_MCKR_CSS_PLLA_CLK, 82, 1, 3, true, 498000000, 166000000),
+};
+
+#define OPP_COUNT ((int)(sizeof(opps) / sizeof(opps[0])))
+
+enum { MAIN, LOW, UPLL, MID, HIGH };
+
+static const struct _dvfs_limits limits = {
+	.pck_max = 500000000,
+	.mck_max = 166000000,
+	.mck_min = 10000000,
+	.allow_relock = true,
+};
+
+/*----------------------------------------------------------------------------
+ *        Notifiers
+ *----------------------------------------------------------------------------*/
+
+struct notifier_log {
+	unsigned events[3];
+	unsigned bad_clock;  /* POST_CHANGE with MCK not at the new point */
+	unsigned unmasked;   /* POST_CHANGE with interrupts enabled */
+	int refuse;          /* returned on DVFS_PRE_CHANGE */
+};
+
+static int notifier(enum _dvfs_event event,
+		const struct _dvfs_transition* transition, void* arg)
+{
+	struct notifier_log* log = arg;
+
+	log->events[event]++;
+	if (event == DVFS_POST_CHANGE) {
+		if (pmc_get_master_clock() != transition->to->mck)
+			log->bad_clock++;
+		if (host_irq_enabled)
+			log->unmasked++;
+	}
+	return event == DVFS_PRE_CHANGE ? log->refuse : 0;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_checks(void)
+{
+	struct _dvfs_limits no_relock = limits;
+	struct _dvfs_opp opp;
+	struct _dvfs_opp unsorted[2] = { opps[LOW], opps[MAIN] };
+	int i;
+
+	for (i = 0; i < OPP_COUNT; i++)
+		CHECK(dvfs_check_opp(&limits, &opps[i]) == 0);
+
+	opp = opps[HIGH];
+	opp.pck = 600000000;
+	CHECK(dvfs_check_opp(&limits, &opp) == -EINVAL);
+	opp = opps[HIGH];
+	opp.mck = 200000000;
+	CHECK(dvfs_check_opp(&limits, &opp) == -EINVAL);
+	opp = opps[MAIN];
+	opp.pck = opp.mck = 4000000;
+	CHECK(dvfs_check_opp(&limits, &opp) == -EINVAL);
+	opp = opps[LOW];
+	opp.mck = opp.pck / 5;
+	CHECK(dvfs_check_opp(&limits, &opp) == -EINVAL);
+	opp = opps[LOW];
+	opp.cfg.plla.mul = 0;
+	CHECK(dvfs_check_opp(&limits, &opp) == -EINVAL);
+	opp = opps[MAIN];
+	opp.cfg.pck_input = PMC_MCKR_CSS_SLOW_CLK;
+	CHECK(dvfs_check_opp(&limits, &opp) == -EINVAL);
+
+	CHECK(dvfs_init(opps, OPP_COUNT, &limits, OPP_COUNT) == -EINVAL);
+	CHECK(dvfs_init(opps, 0, &limits, -1) == -EINVAL);
+	CHECK(dvfs_init(unsorted, 2, &limits, -1) == -EINVAL);
+	CHECK(dvfs_init(opps, OPP_COUNT, &limits, -1) == 0);
+	CHECK(dvfs_get_opp() == -1);
+
+	CHECK(dvfs_needs_relock(NULL, &opps[LOW]));
+	CHECK(dvfs_needs_relock(&opps[MAIN], &opps[LOW]));
+	CHECK(dvfs_needs_relock(&opps[UPLL], &opps[MID]));
+	CHECK(!dvfs_needs_relock(&opps[LOW], &opps[HIGH]));
+	CHECK(!dvfs_needs_relock(&opps[HIGH], &opps[MID]));
+
+	CHECK(dvfs_prescaler_first(NULL, &opps[LOW]));
+	CHECK(dvfs_prescaler_first(&opps[HIGH], &opps[LOW]));
+	CHECK(!dvfs_prescaler_first(&opps[LOW], &opps[HIGH]));
+
+	no_relock.allow_relock = false;
+	CHECK(dvfs_check_transition(&no_relock, &opps[MAIN], &opps[LOW]) == -EPERM);
+	CHECK(dvfs_check_transition(&no_relock, NULL, &opps[LOW]) == -EPERM);
+	CHECK(dvfs_check_transition(&no_relock, &opps[LOW], &opps[HIGH]) == 0);
+	CHECK(dvfs_check_transition(&limits, &opps[MAIN], &opps[LOW]) == 0);
+}
+
+/* Every transition: final clocks, intermediate clocks, PLL and interrupts */
+static void test_transitions(void)
+{
+	struct notifier_log log;
+	struct _dvfs_notifier n = { .fn = notifier, .arg = &log };
+	struct _dvfs_stats stats;
+	int from, to, count = 0;
+	bool irq;
+
+	dvfs_register_notifier(&n);
+	for (from = 0; from < OPP_COUNT; from++) {
+		for (to = 0; to < OPP_COUNT; to++) {
+			if (from == to)
+				continue;
+			REQUIRE(dvfs_init(opps, OPP_COUNT, &limits, from) == 0);
+			pmc_set_state(&opps[from]);
+			memset(&log, 0, sizeof(log));
+
+			/* Interrupts are left as they were */
+			irq = (from + to) & 1;
+			host_irq_enabled = irq;
+			CHECK(dvfs_set_opp(to) == 0);
+			CHECK(host_irq_enabled == irq);
+			CHECK(dvfs_get_opp() == to);
+
+			CHECK(pmc_pck() == opps[to].pck);
+			CHECK(pmc_mck() == opps[to].mck);
+			CHECK(pmc.h32mx_div2 == opps[to].cfg.h32mx_div2);
+			CHECK(pmc.unmasked_calls == 0);
+			CHECK(pmc.plla_errors == 0);
+			CHECK(pmc.h32mx_peak <= H32MX_MAX);
+			CHECK(pmc.pck_peak <= opps[from].pck ||
+			      pmc.pck_peak <= opps[to].pck);
+			CHECK(pmc.mck_peak <= opps[from].mck ||
+			      pmc.mck_peak <= opps[to].mck);
+			if (!dvfs_needs_relock(&opps[from], &opps[to]))
+				CHECK(pmc.plla_changes == 0 &&
+				      pmc.css == opps[from].cfg.pck_input);
+
+			CHECK(log.events[DVFS_PRE_CHANGE] == 1);
+			CHECK(log.events[DVFS_POST_CHANGE] == 1);
+			CHECK(log.events[DVFS_ABORT_CHANGE] == 0);
+			CHECK(log.bad_clock == 0 && log.unmasked == 0);
+
+			dvfs_get_stats(&stats);
+			CHECK(stats.transitions == 1);
+			count++;
+		}
+	}
+	CHECK(count == OPP_COUNT * (OPP_COUNT - 1));
+
+	/* Same point: nothing to do */
+	memset(&log, 0, sizeof(log));
+	pmc_reset_record();
+	CHECK(dvfs_set_opp(dvfs_get_opp()) == 0);
+	CHECK(pmc.calls == 0 && log.events[DVFS_PRE_CHANGE] == 0);
+	CHECK(dvfs_set_opp(OPP_COUNT) == -EINVAL);
+	CHECK(dvfs_set_opp(-1) == -EINVAL);
+
+	/* Unknown current point: full reconfiguration */
+	REQUIRE(dvfs_init(opps, OPP_COUNT, &limits, -1) == 0);
+	pmc_set_state(&opps[MAIN]);
+	CHECK(dvfs_set_opp(LOW) == 0);
+	CHECK(pmc_mck() == opps[LOW].mck && pmc.plla_changes > 0);
+
+	dvfs_unregister_notifier(&n);
+	host_irq_enabled = true;
+}
+
+static void test_notifiers(void)
+{
+	struct notifier_log log1, log2, veto;
+	struct _dvfs_notifier n1 = { .fn = notifier, .arg = &log1 };
+	struct _dvfs_notifier n2 = { .fn = notifier, .arg = &log2 };
+	struct _dvfs_notifier nv = { .fn = notifier, .arg = &veto };
+	struct _dvfs_stats stats;
+
+	memset(&log1, 0, sizeof(log1));
+	memset(&log2, 0, sizeof(log2));
+	memset(&veto, 0, sizeof(veto));
+	REQUIRE(dvfs_init(opps, OPP_COUNT, &limits, HIGH) == 0);
+	pmc_set_state(&opps[HIGH]);
+
+	/* The chain is called newest first: the veto comes last */
+	dvfs_register_notifier(&nv);
+	dvfs_register_notifier(&n1);
+	dvfs_register_notifier(&n2);
+	dvfs_register_notifier(&n1);
+
+	CHECK(dvfs_set_opp(LOW) == 0);
+	CHECK(log1.events[DVFS_PRE_CHANGE] == 1 && log1.events[DVFS_POST_CHANGE] == 1);
+	CHECK(log2.events[DVFS_PRE_CHANGE] == 1 && log2.events[DVFS_POST_CHANGE] == 1);
+	CHECK(veto.events[DVFS_PRE_CHANGE] == 1 && veto.events[DVFS_POST_CHANGE] == 1);
+
+	/* Refused: the notifiers already called are told, clocks untouched */
+	veto.refuse = -EBUSY;
+	pmc_reset_record();
+	CHECK(dvfs_set_opp(MID) == -EBUSY);
+	CHECK(dvfs_get_opp() == LOW);
+	CHECK(pmc.calls == 0);
+	CHECK(log1.events[DVFS_ABORT_CHANGE] == 1);
+	CHECK(log2.events[DVFS_ABORT_CHANGE] == 1);
+	CHECK(veto.events[DVFS_ABORT_CHANGE] == 0);
+	CHECK(log1.events[DVFS_POST_CHANGE] == 1);
+	dvfs_get_stats(&stats);
+	CHECK(stats.transitions == 1 && stats.refused == 1);
+
+	/* Refused by the first notifier called: nobody to tell */
+	veto.refuse = 0;
+	log2.refuse = -EBUSY;
+	CHECK(dvfs_set_opp(MID) == -EBUSY);
+	CHECK(log1.events[DVFS_PRE_CHANGE] == 2);
+	CHECK(log1.events[DVFS_ABORT_CHANGE] == 1);
+	log2.refuse = 0;
+
+	dvfs_unregister_notifier(&n1);
+	dvfs_unregister_notifier(&n1);
+	CHECK(dvfs_set_opp(MID) == 0);
+	CHECK(log1.events[DVFS_PRE_CHANGE] == 2);
+	CHECK(log2.events[DVFS_POST_CHANGE] == 2);
+	CHECK(veto.events[DVFS_POST_CHANGE] == 2);
+
+	dvfs_unregister_notifier(&n2);
+	dvfs_unregister_notifier(&nv);
+}
+
+static void test_governor_select(void)
+{
+	const struct _dvfs_governor g = {
+		.period = 100, .up_threshold = 80, .down_threshold = 30,
+	};
+
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, LOW, 90) == HIGH);
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, HIGH, 81) == HIGH);
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, HIGH, 80) == HIGH);
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, HIGH, 50) == HIGH);
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, LOW, 30) == LOW);
+	/* 498MHz at 20% is 124.5MHz at 80% */
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, HIGH, 20) == LOW);
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, HIGH, 1) == MAIN);
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, UPLL, 29) == LOW);
+	/* Nothing slower keeps the load under up_threshold */
+	CHECK(dvfs_governor_select(&g, opps, OPP_COUNT, LOW, 10) == LOW);
+}
+
+/* Run for a period: busy_us then idle_us, count times */
+static void run(int count, uint64_t busy, uint64_t idle)
+{
+	int i;
+
+	idle_us = idle;
+	for (i = 0; i < count; i++) {
+		now_us += busy;
+		dvfs_idle();
+	}
+}
+
+static void test_governor(void)
+{
+	const struct _dvfs_governor g = {
+		.period = 100, .up_threshold = 80, .down_threshold = 30,
+	};
+	struct _dvfs_stats stats;
+
+	REQUIRE(dvfs_init(opps, OPP_COUNT, &limits, MAIN) == 0);
+	pmc_set_state(&opps[MAIN]);
+	now_us = 1000000;
+	dvfs_governor_start(&g);
+
+	/* 50%: stays at the slowest point */
+	run(5, 10000, 10000);
+	dvfs_get_stats(&stats);
+	CHECK(stats.load == 50);
+	CHECK(dvfs_get_opp() == MAIN);
+
+	/* 90%: fastest point */
+	run(10, 9000, 1000);
+	dvfs_get_stats(&stats);
+	CHECK(stats.load == 90);
+	CHECK(dvfs_get_opp() == HIGH);
+	CHECK(pmc_mck() == opps[HIGH].mck);
+
+	/* 10% at 498MHz: 62MHz would be enough */
+	run(10, 1000, 9000);
+	dvfs_get_stats(&stats);
+	CHECK(stats.load == 10);
+	CHECK(dvfs_get_opp() == LOW);
+
+	/* Before the end of a period, nothing changes */
+	run(5, 10000, 0);
+	CHECK(dvfs_get_opp() == LOW);
+
+	/* Stopped: load is no longer evaluated */
+	dvfs_governor_stop();
+	run(20, 10000, 0);
+	CHECK(dvfs_get_opp() == LOW);
+
+	/* dvfs_idle() leaves interrupts as they were */
+	host_irq_enabled = false;
+	dvfs_idle();
+	CHECK(!host_irq_enabled);
+	host_irq_enabled = true;
+	dvfs_idle();
+	CHECK(host_irq_enabled);
+}
+
+int main(void)
+{
+	test_checks();
+	test_transitions();
+	test_notifiers();
+	test_governor_select();
+	test_governor();
+	return host_test_end("dvfs");
+}
@@ -0,0 +1,79 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host stand-in for the PMC driver header: the master clock functions used
+ * by DVFS, implemented by the simulated PMC of the test.
+ *
+ * The fields keep their names but not the register encoding: pck_pres is
+ * the prescaler as a power of two and mck_div the divider itself.
+ */
+
+#ifndef _PMC_H_
+#define _PMC_H_
+
+#include "chip.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PMC_MCKR_CSS_SLOW_CLK 0
+#define PMC_MCKR_CSS_MAIN_CLK 1
+#define PMC_MCKR_CSS_PLLA_CLK 2
+#define PMC_MCKR_CSS_UPLL_CLK 3
+
+struct _pmc_plla_cfg {
+	uint32_t mul;
+	uint32_t div;
+	uint32_t count;
+};
+
+struct pck_mck_cfg {
+	uint32_t pck_input;
+	bool ext12m;
+	bool ext_bypass;
+	bool ext32k;
+	struct _pmc_plla_cfg plla;
+	uint32_t pck_pres;
+	uint32_t mck_div;
+	bool h32mx_div2;
+};
+
+extern void pmc_switch_mck_to_main(void);
+extern void pmc_switch_mck_to_new_source(uint32_t mckr_css);
+extern void pmc_set_mck_prescaler(uint32_t prescaler);
+extern void pmc_set_mck_divider(uint32_t divider);
+extern void pmc_set_mck_h32mxdiv(bool div2);
+extern void pmc_configure_plla(const struct _pmc_plla_cfg* plla);
+extern void pmc_disable_plla(void);
+extern bool pmc_is_upll_clock_enabled(void);
+extern void pmc_enable_upll_clock(void);
+extern uint32_t pmc_get_master_clock(void);
+
+#endif /* _PMC_H_ */
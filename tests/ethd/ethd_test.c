@@ -0,0 +1,650 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the ETH driver layer. The MAC is simulated: it fills the RX
+ * descriptor rings like the GMAC does (128-byte buffers, SOF/EOF, length and
+ * checksum status on the last buffer) and sends the frames queued in the TX
+ * ring when asked to.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "trace.h"
+#include "network/ethd.h"
+
+#include "host_test.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated MAC
+ *----------------------------------------------------------------------------*/
+
+#define RX_BUFFERS 16
+#define TX_BUFFERS 8
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+/* memcpy() calls with the same source and destination */
+static unsigned self_copies;
+
+void* __real_memcpy(void* dst, const void* src, size_t size);
+
+void* __wrap_memcpy(void* dst, const void* src, size_t size)
+{
+	if (dst == src)
+		self_copies++;
+	return __real_memcpy(dst, src, size);
+}
+
+/* Static buffers: descriptors hold 32-bit addresses */
+static struct _eth_desc rx_desc[ETH_QUEUE_COUNT][RX_BUFFERS] __attribute__((aligned(8)));
+static struct _eth_desc tx_desc[ETH_QUEUE_COUNT][TX_BUFFERS] __attribute__((aligned(8)));
+static uint8_t rx_buffer[ETH_QUEUE_COUNT][RX_BUFFERS * ETH_RX_UNITSIZE] __attribute__((aligned(32)));
+static uint8_t tx_buffer[ETH_QUEUE_COUNT][TX_BUFFERS * ETH_TX_UNITSIZE] __attribute__((aligned(32)));
+static ethd_callback_t tx_callbacks[ETH_QUEUE_COUNT][TX_BUFFERS];
+
+static struct {
+	uint16_t rx_index[ETH_QUEUE_COUNT]; /* next RX descriptor to fill */
+	uint16_t tx_index[ETH_QUEUE_COUNT]; /* next TX descriptor to send */
+	unsigned start_count;               /* start_transmission() calls */
+	unsigned sent[ETH_QUEUE_COUNT];     /* frames sent */
+	bool rx_it[ETH_QUEUE_COUNT];        /* RX interrupts enabled */
+	bool tx_it[ETH_QUEUE_COUNT];        /* TX completion interrupts enabled */
+	unsigned reclaims[ETH_QUEUE_COUNT]; /* tx_reclaim() calls */
+	/* frame received while RX interrupts get unmasked, if any */
+	uint32_t race_size;
+	uint8_t race_queue;
+	uint8_t last_frame[ETH_MAX_FRAME_LENGTH];
+	uint32_t last_size;
+} mac;
+
+static uint32_t addr32(const void* ptr)
+{
+	uintptr_t addr = (uintptr_t)ptr;
+
+	REQUIRE(addr <= UINT32_MAX);
+	return (uint32_t)addr;
+}
+
+static uint8_t fake_setup_queue(void* drv, uint8_t queue,
+		uint16_t rx_size, uint8_t* rx_buf, struct _eth_desc* rx_d,
+		uint16_t tx_size, uint8_t* tx_buf, struct _eth_desc* tx_d,
+		ethd_callback_t *tx_cb)
+{
+	struct _ethd* ethd = drv;
+	struct _ethd_queue* q = &ethd->queues[queue];
+	int i;
+
+	q->rx_buffer = rx_buf;
+	q->rx_desc = rx_d;
+	q->rx_size = rx_size;
+	q->rx_head = 0;
+	q->rx_callback = NULL;
+	q->rx_budget = ETH_RX_DEFAULT_BUDGET;
+	for (i = 0; i < rx_size; i++) {
+		rx_d[i].addr = addr32(rx_buf + i * ETH_RX_UNITSIZE);
+		rx_d[i].status = 0;
+	}
+	rx_d[rx_size - 1].addr |= ETH_RX_ADDR_WRAP;
+
+	q->tx_buffer = tx_buf;
+	q->tx_desc = tx_d;
+	q->tx_size = tx_size;
+	q->tx_head = q->tx_tail = 0;
+	q->tx_callbacks = tx_cb;
+	q->tx_wakeup_callback = NULL;
+	for (i = 0; i < tx_size; i++) {
+		tx_d[i].addr = addr32(tx_buf + i * ETH_TX_UNITSIZE);
+		tx_d[i].status = ETH_TX_STATUS_USED;
+	}
+	tx_d[tx_size - 1].status |= ETH_TX_STATUS_WRAP;
+
+	mac.rx_index[queue] = 0;
+	mac.tx_index[queue] = 0;
+	return ETH_OK;
+}
+
+static void fake_start_transmission(void* eth)
+{
+	(void)eth;
+	mac.start_count++;
+}
+
+static bool mac_receive(struct _ethd* ethd, uint8_t queue,
+		const uint8_t* frame, uint32_t size, uint32_t csum);
+
+static void fake_set_rx_it(void* drv, uint8_t queue, bool enable)
+{
+	static const uint8_t frame[ETH_MAX_FRAME_LENGTH];
+
+	mac.rx_it[queue] = enable;
+	if (enable && mac.race_size && mac.race_queue == queue) {
+		REQUIRE(mac_receive(drv, queue, frame, mac.race_size, 0));
+		mac.race_size = 0;
+	}
+}
+
+static void fake_set_tx_complete_it(void* drv, uint8_t queue, bool enable)
+{
+	(void)drv;
+	mac.tx_it[queue] = enable;
+}
+
+/* Same walk as the TX complete handlers of gmacd and emacd */
+static void fake_tx_reclaim(void* drv, uint8_t queue)
+{
+	struct _ethd* ethd = drv;
+	struct _ethd_queue* q = &ethd->queues[queue];
+
+	mac.reclaims[queue]++;
+	while (q->tx_head != q->tx_tail) {
+		struct _eth_desc* desc = &q->tx_desc[q->tx_tail];
+
+		if ((desc->status & ETH_TX_STATUS_USED) == 0)
+			break;
+		while ((desc->status & ETH_TX_STATUS_LASTBUF) == 0) {
+			q->tx_tail = (q->tx_tail + 1) % q->tx_size;
+			desc = &q->tx_desc[q->tx_tail];
+		}
+		if (q->tx_callbacks && q->tx_callbacks[q->tx_tail])
+			q->tx_callbacks[q->tx_tail](queue, 0);
+		q->tx_tail = (q->tx_tail + 1) % q->tx_size;
+	}
+}
+
+static const struct _ethd_op fake_op = {
+	.setup_queue = fake_setup_queue,
+	.start_transmission = fake_start_transmission,
+	.set_rx_it = fake_set_rx_it,
+	.set_tx_complete_it = fake_set_tx_complete_it,
+	.tx_reclaim = fake_tx_reclaim,
+};
+
+/* Receive a frame on a queue, as the MAC would. Returns false when the
+ * ring has no room for it. */
+static bool mac_receive(struct _ethd* ethd, uint8_t queue,
+		const uint8_t* frame, uint32_t size, uint32_t csum)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+	uint32_t count = (size + ETH_RX_UNITSIZE - 1) / ETH_RX_UNITSIZE;
+	uint32_t i, offset;
+	uint16_t idx = mac.rx_index[queue];
+
+	for (i = 0; i < count; i++)
+		if (q->rx_desc[(idx + i) % q->rx_size].addr & ETH_RX_ADDR_OWN)
+			return false;
+
+	for (i = 0, offset = 0; i < count; i++, offset += ETH_RX_UNITSIZE) {
+		struct _eth_desc* desc = &q->rx_desc[idx];
+		uint32_t len = size - offset;
+		uint32_t status = 0;
+
+		if (len > ETH_RX_UNITSIZE)
+			len = ETH_RX_UNITSIZE;
+		memcpy((void*)(uintptr_t)(desc->addr & ETH_RX_ADDR_MASK),
+		       frame + offset, len);
+		if (i == 0)
+			status |= ETH_RX_STATUS_SOF;
+		if (i == count - 1)
+			status |= ETH_RX_STATUS_EOF | size | csum;
+		desc->status = status;
+		desc->addr |= ETH_RX_ADDR_OWN;
+		idx = (idx + 1) % q->rx_size;
+	}
+	mac.rx_index[queue] = idx;
+	return true;
+}
+
+/* Send the frames queued on a queue, as the MAC would: copy them, then set
+ * the USED bit of their first descriptor */
+static void mac_transmit(struct _ethd* ethd, uint8_t queue)
+{
+	struct _ethd_queue* q = &ethd->queues[queue];
+	uint16_t idx = mac.tx_index[queue];
+
+	while (idx != q->tx_head) {
+		uint16_t first = idx;
+
+		mac.last_size = 0;
+		for (;;) {
+			struct _eth_desc* desc = &q->tx_desc[idx];
+			uint32_t len = desc->status & ETH_RX_STATUS_LENGTH_MASK;
+
+			CHECK((desc->status & ETH_TX_STATUS_USED) == 0);
+			REQUIRE(mac.last_size + len <= sizeof(mac.last_frame));
+			memcpy(mac.last_frame + mac.last_size,
+			       (void*)(uintptr_t)desc->addr, len);
+			mac.last_size += len;
+			idx = (idx + 1) % q->tx_size;
+			if (desc->status & ETH_TX_STATUS_LASTBUF)
+				break;
+		}
+		q->tx_desc[first].status |= ETH_TX_STATUS_USED;
+		mac.sent[queue]++;
+	}
+	mac.tx_index[queue] = idx;
+}
+
+static void setup(struct _ethd* ethd)
+{
+	int i;
+
+	memset(&mac, 0, sizeof(mac));
+	/* No MAC driver is built, ethd_configure() only resets the state */
+	CHECK(!ethd_configure(ethd, ETH_TYPE_GMAC, NULL, 0, 0));
+	ethd->op = &fake_op;
+	for (i = 0; i < ETH_QUEUE_COUNT; i++) {
+		ethd_setup_queue(ethd, i, RX_BUFFERS, rx_buffer[i], rx_desc[i],
+				TX_BUFFERS, tx_buffer[i], tx_desc[i],
+				tx_callbacks[i]);
+		mac.rx_it[i] = true;
+		mac.tx_it[i] = true;
+	}
+}
+
+static void fill_frame(uint8_t* frame, uint32_t size, uint8_t seed)
+{
+	uint32_t i;
+
+	for (i = 0; i < size; i++)
+		frame[i] = (uint8_t)(seed + i * 7);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+/* Checksum offload: the status of the last RX buffer is reported only when
+ * RX offload is enabled, and frames are counted by kind */
+static void test_rx_csum(void)
+{
+	static const struct {
+		uint32_t size;
+		uint32_t status;
+	} frames[] = {
+		{ 60, ETH_RX_STATUS_CSUM_IP_TCP },
+		{ 300, ETH_RX_STATUS_CSUM_IP_UDP },
+		{ 128, ETH_RX_STATUS_CSUM_IP },
+		{ 1514, ETH_RX_STATUS_CSUM_NONE },
+		{ 129, ETH_RX_STATUS_CSUM_IP_TCP },
+	};
+	struct _ethd ethd;
+	struct _ethd_csum_stats stats;
+	uint8_t frame[ETH_MAX_FRAME_LENGTH], buffer[ETH_MAX_FRAME_LENGTH];
+	uint32_t size, csum;
+	int pass, i;
+
+	for (pass = 0; pass < 2; pass++) {
+		setup(&ethd);
+		if (pass)
+			ethd.csum_offload = ETH_CSUM_RX;
+		CHECK(ethd_get_csum_offload(&ethd) == (pass ? ETH_CSUM_RX : 0));
+
+		for (i = 0; i < (int)(sizeof(frames) / sizeof(frames[0])); i++) {
+			fill_frame(frame, frames[i].size, i);
+			REQUIRE(mac_receive(&ethd, 0, frame, frames[i].size,
+					frames[i].status));
+			CHECK(ethd_poll_csum(&ethd, 0, buffer, sizeof(buffer),
+					&size, &csum) == ETH_OK);
+			CHECK(size == frames[i].size);
+			CHECK(memcmp(buffer, frame, size) == 0);
+			CHECK(csum == (pass ? frames[i].status : ETH_RX_STATUS_CSUM_NONE));
+		}
+		CHECK(ethd_poll_csum(&ethd, 0, buffer, sizeof(buffer),
+				&size, &csum) == ETH_RX_NULL);
+
+		ethd_get_csum_stats(&ethd, &stats);
+		CHECK(stats.rx_offloaded == (pass ? 3 : 0));
+		CHECK(stats.rx_ip_only == (pass ? 1 : 0));
+		CHECK(stats.rx_software == (pass ? 1 : 5));
+
+		ethd_clear_csum_stats(&ethd);
+		ethd_get_csum_stats(&ethd, &stats);
+		CHECK(stats.rx_offloaded == 0 && stats.rx_ip_only == 0 &&
+		      stats.rx_software == 0);
+	}
+}
+
+/* Frames sent are counted as hardware or software checksummed depending on
+ * TX offload */
+static void test_tx_csum(void)
+{
+	struct _ethd ethd;
+	struct _ethd_csum_stats stats;
+	uint8_t frame[ETH_MAX_FRAME_LENGTH];
+	int pass, i;
+
+	for (pass = 0; pass < 2; pass++) {
+		setup(&ethd);
+		ethd.csum_offload = pass ? ETH_CSUM_RX | ETH_CSUM_TX : ETH_CSUM_RX;
+
+		for (i = 0; i < 3; i++) {
+			fill_frame(frame, 100 + i, i);
+			CHECK(ethd_send(&ethd, 1, frame, 100 + i, NULL) == ETH_OK);
+			mac_transmit(&ethd, 1);
+			CHECK(mac.last_size == 100u + i);
+			CHECK(memcmp(mac.last_frame, frame, 100 + i) == 0);
+		}
+		CHECK(mac.sent[1] == 3);
+		CHECK(mac.start_count == 3);
+
+		ethd_get_csum_stats(&ethd, &stats);
+		CHECK(stats.tx_offloaded == (pass ? 3 : 0));
+		CHECK(stats.tx_software == (pass ? 0 : 3));
+	}
+}
+
+/* Frames built in place in the TX descriptor buffer are sent as is, without
+ * copying them over themselves */
+static void test_tx_in_place(void)
+{
+	struct _ethd ethd;
+	uint8_t frame[ETH_MAX_FRAME_LENGTH];
+	uint8_t* buf;
+	int i;
+
+	setup(&ethd);
+
+	/* Go around the ring a few times */
+	for (i = 0; i < 3 * TX_BUFFERS; i++) {
+		uint32_t size = 60 + i * 50;
+
+		buf = ethd_get_tx_buffer(&ethd, 1);
+		REQUIRE(buf != NULL);
+		CHECK((uintptr_t)buf ==
+		      ethd.queues[1].tx_desc[ethd.queues[1].tx_head].addr);
+		fill_frame(buf, size, i);
+		fill_frame(frame, size, i);
+		CHECK(ethd_send(&ethd, 1, buf, size, NULL) == ETH_OK);
+		mac_transmit(&ethd, 1);
+		CHECK(mac.last_size == size);
+		CHECK(memcmp(mac.last_frame, frame, size) == 0);
+		ethd_tx_reclaim(&ethd, 1);
+		CHECK(ethd_get_tx_load(&ethd, 1) == 0);
+	}
+	CHECK(mac.sent[1] == 3 * TX_BUFFERS);
+	CHECK(self_copies == 0);
+
+	/* No buffer once the ring is full, until frames are reclaimed */
+	for (i = 0; i < TX_BUFFERS; i++) {
+		buf = ethd_get_tx_buffer(&ethd, 1);
+		if (!buf)
+			break;
+		CHECK(ethd_send(&ethd, 1, buf, 60, NULL) == ETH_OK);
+	}
+	CHECK(i == TX_BUFFERS - 1);
+	CHECK(ethd_send(&ethd, 1, frame, 60, NULL) == ETH_TX_BUSY);
+	mac_transmit(&ethd, 1);
+	CHECK(ethd_get_tx_buffer(&ethd, 1) == NULL);
+	ethd_tx_reclaim(&ethd, 1);
+	CHECK(ethd_get_tx_buffer(&ethd, 1) != NULL);
+	CHECK(ethd_get_tx_buffer(&ethd, 0) != NULL);
+}
+
+/* Frames seen by the NAPI handler */
+static struct {
+	unsigned count;
+	uint8_t queue[32];
+	uint32_t size[32];
+} rx_log;
+
+static void napi_handler(void* arg, uint8_t queue, uint8_t* frame,
+		uint32_t size, uint32_t csum_status)
+{
+	(void)frame;
+	(void)csum_status;
+	CHECK(arg == &rx_log);
+	REQUIRE(rx_log.count < 32);
+	rx_log.queue[rx_log.count] = queue;
+	rx_log.size[rx_log.count] = size;
+	rx_log.count++;
+}
+
+static unsigned tx_done;
+
+static void tx_done_callback(uint8_t queue, uint32_t status)
+{
+	(void)queue;
+	(void)status;
+	tx_done++;
+}
+
+static void receive_frames(struct _ethd* ethd, uint8_t queue, int count,
+		uint32_t size)
+{
+	uint8_t frame[ETH_MAX_FRAME_LENGTH];
+	int i;
+
+	for (i = 0; i < count; i++) {
+		fill_frame(frame, size, i);
+		REQUIRE(mac_receive(ethd, queue, frame, size, 0));
+	}
+}
+
+/* Hybrid mode: queues are polled highest priority first within the budget,
+ * and RX interrupts come back only once a queue is drained */
+static void test_napi_budget(void)
+{
+	struct _ethd ethd;
+	uint8_t buffer[ETH_MAX_FRAME_LENGTH];
+	uint32_t hist[ETH_NAPI_HIST_SIZE];
+	int i;
+
+	setup(&ethd);
+	ethd_set_rx_budget(&ethd, 0, 8);
+	ethd_set_rx_budget(&ethd, 1, 8);
+	CHECK(ethd_get_rx_budget(&ethd, 1) == 8);
+	ethd_set_napi(&ethd, true);
+	for (i = 0; i < ETH_QUEUE_COUNT; i++) {
+		CHECK(!mac.rx_it[i]);
+		CHECK(!mac.tx_it[i]);
+	}
+	CHECK(ethd_napi_pending(&ethd));
+
+	/* The first poll drains the empty queues and unmasks them */
+	memset(&rx_log, 0, sizeof(rx_log));
+	CHECK(ethd_napi_poll(&ethd, 4, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 0);
+	CHECK(!ethd_napi_pending(&ethd));
+	CHECK(mac.rx_it[0] && mac.rx_it[1]);
+
+	/* The interrupt handler masks RX and schedules the poll */
+	receive_frames(&ethd, 0, 3, 200);
+	receive_frames(&ethd, 1, 2, 64);
+	for (i = 0; i < ETH_QUEUE_COUNT; i++) {
+		fake_set_rx_it(&ethd, i, false);
+		ethd.queues[i].rx_napi_pending = 1;
+	}
+
+	CHECK(ethd_napi_poll(&ethd, 4, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 4);
+	REQUIRE(rx_log.count == 4);
+	CHECK(rx_log.queue[0] == 1 && rx_log.queue[1] == 1);
+	CHECK(rx_log.queue[2] == 0 && rx_log.queue[3] == 0);
+	CHECK(rx_log.size[0] == 64 && rx_log.size[2] == 200);
+	/* Queue 1 is drained, queue 0 still has a frame */
+	CHECK(mac.rx_it[1] && !ethd.queues[1].rx_napi_pending);
+	CHECK(!mac.rx_it[0] && ethd.queues[0].rx_napi_pending);
+	CHECK(ethd_napi_pending(&ethd));
+
+	CHECK(ethd_napi_poll(&ethd, 4, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 1);
+	CHECK(rx_log.count == 5 && rx_log.queue[4] == 0);
+	CHECK(mac.rx_it[0] && !ethd_napi_pending(&ethd));
+
+	/* Polls of 0, 4 and 1 frames */
+	ethd_get_napi_histogram(&ethd, hist);
+	CHECK(hist[0] == 1 && hist[1] == 1 && hist[3] == 1);
+	ethd_clear_napi_histogram(&ethd);
+	ethd_get_napi_histogram(&ethd, hist);
+	for (i = 0; i < ETH_NAPI_HIST_SIZE; i++)
+		CHECK(hist[i] == 0);
+
+	/* Polls of 4 to 7 frames share a bucket */
+	for (i = 4; i < 8; i++) {
+		receive_frames(&ethd, 0, i, 60);
+		ethd.queues[0].rx_napi_pending = 1;
+		rx_log.count = 0;
+		CHECK(ethd_napi_poll(&ethd, 100, buffer, sizeof(buffer),
+				napi_handler, &rx_log) == i);
+	}
+	ethd_get_napi_histogram(&ethd, hist);
+	CHECK(hist[3] == 4);
+
+	/* Each queue is limited to its own budget, lower priority queues get
+	 * their turn within the same poll */
+	ethd_set_rx_budget(&ethd, 1, 2);
+	receive_frames(&ethd, 1, 5, 80);
+	receive_frames(&ethd, 0, 3, 90);
+	ethd.queues[0].rx_napi_pending = 1;
+	ethd.queues[1].rx_napi_pending = 1;
+	fake_set_rx_it(&ethd, 0, false);
+	fake_set_rx_it(&ethd, 1, false);
+	rx_log.count = 0;
+	CHECK(ethd_napi_poll(&ethd, 100, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 5);
+	REQUIRE(rx_log.count == 5);
+	CHECK(rx_log.queue[0] == 1 && rx_log.queue[1] == 1);
+	for (i = 2; i < 5; i++)
+		CHECK(rx_log.queue[i] == 0);
+	CHECK(mac.rx_it[0] && !ethd.queues[0].rx_napi_pending);
+	CHECK(!mac.rx_it[1] && ethd_napi_pending(&ethd));
+
+	/* The poll budget still applies when lower than the queue budget */
+	CHECK(ethd_napi_poll(&ethd, 1, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 1);
+	CHECK(ethd_napi_poll(&ethd, 100, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 2);
+	CHECK(rx_log.count == 8 && rx_log.queue[7] == 1);
+	CHECK(!mac.rx_it[1] && ethd_napi_pending(&ethd));
+	CHECK(ethd_napi_poll(&ethd, 100, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 0);
+	CHECK(mac.rx_it[1] && !ethd_napi_pending(&ethd));
+}
+
+/* A frame received just before RX interrupts are unmasked would raise no
+ * interrupt: the queue must stay scheduled */
+static void test_napi_race(void)
+{
+	struct _ethd ethd;
+	uint8_t buffer[ETH_MAX_FRAME_LENGTH];
+
+	setup(&ethd);
+	ethd_set_rx_budget(&ethd, 0, 8);
+	ethd_set_rx_budget(&ethd, 1, 8);
+	ethd_set_napi(&ethd, true);
+	receive_frames(&ethd, 0, 2, 100);
+
+	memset(&rx_log, 0, sizeof(rx_log));
+	mac.race_queue = 0;
+	mac.race_size = 90;
+	CHECK(ethd_napi_poll(&ethd, 8, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 2);
+	CHECK(mac.race_size == 0);
+	CHECK(!mac.rx_it[0] && ethd.queues[0].rx_napi_pending);
+
+	CHECK(ethd_napi_poll(&ethd, 8, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 1);
+	CHECK(rx_log.count == 3 && rx_log.size[2] == 90);
+	CHECK(mac.rx_it[0] && !ethd_napi_pending(&ethd));
+}
+
+/* Queues without budget are left alone, sent frames are reclaimed by the
+ * polls and when leaving the hybrid mode */
+static void test_napi_tx_reclaim(void)
+{
+	struct _ethd ethd;
+	uint8_t frame[ETH_MAX_FRAME_LENGTH], buffer[ETH_MAX_FRAME_LENGTH];
+	uint32_t hist[ETH_NAPI_HIST_SIZE];
+	int i;
+
+	setup(&ethd);
+	ethd_set_rx_budget(&ethd, 0, 0);
+	ethd_set_rx_budget(&ethd, 1, 4);
+	ethd_set_napi(&ethd, true);
+	CHECK(mac.rx_it[0] && mac.tx_it[0] && !ethd.queues[0].rx_napi_pending);
+	CHECK(!mac.rx_it[1] && !mac.tx_it[1]);
+
+	tx_done = 0;
+	for (i = 0; i < 5; i++) {
+		fill_frame(frame, 60 + i, i);
+		CHECK(ethd_send(&ethd, 1, frame, 60 + i, tx_done_callback) == ETH_OK);
+	}
+	mac_transmit(&ethd, 1);
+	CHECK(mac.sent[1] == 5);
+	CHECK(ethd_get_tx_load(&ethd, 1) == 5);
+	CHECK(tx_done == 0);
+
+	CHECK(ethd_napi_poll(&ethd, 4, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 0);
+	CHECK(tx_done == 5);
+	CHECK(ethd_get_tx_load(&ethd, 1) == 0);
+	CHECK(mac.reclaims[0] == 0 && mac.reclaims[1] == 1);
+
+	/* Reclaim alone: no RX processing, no poll accounted */
+	CHECK(ethd_send(&ethd, 1, frame, 60, tx_done_callback) == ETH_OK);
+	mac_transmit(&ethd, 1);
+	receive_frames(&ethd, 1, 1, 60);
+	ethd.queues[1].rx_napi_pending = 1;
+	ethd_clear_napi_histogram(&ethd);
+	rx_log.count = 0;
+	ethd_tx_reclaim(&ethd, 1);
+	CHECK(tx_done == 6);
+	CHECK(ethd_get_tx_load(&ethd, 1) == 0);
+	CHECK(rx_log.count == 0 && ethd.queues[1].rx_napi_pending);
+	ethd_get_napi_histogram(&ethd, hist);
+	for (i = 0; i < ETH_NAPI_HIST_SIZE; i++)
+		CHECK(hist[i] == 0);
+	CHECK(ethd_napi_poll(&ethd, 4, buffer, sizeof(buffer),
+			napi_handler, &rx_log) == 1);
+
+	CHECK(ethd_send(&ethd, 1, frame, 60, tx_done_callback) == ETH_OK);
+	mac_transmit(&ethd, 1);
+	ethd_set_napi(&ethd, false);
+	CHECK(tx_done == 7);
+	CHECK(mac.rx_it[1] && mac.tx_it[1]);
+	CHECK(!ethd_napi_pending(&ethd));
+}
+
+int main(void)
+{
+	test_rx_csum();
+	test_tx_csum();
+	test_tx_in_place();
+	test_napi_budget();
+	test_napi_race();
+	test_napi_tx_reclaim();
+	return host_test_end("ethd");
+}
@@ -0,0 +1,606 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the fixed-point FFT: the complex and real transforms, Q15
+ * and Q31, against a double precision DFT for every size, with saturating
+ * inputs, plus the magnitude helpers, the sine, the windows and their load
+ * helpers, and the Goertzel detector.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "dsp/dsp.h"
+#include "dsp/fft.h"
+#include "dsp/goertzel.h"
+#include "dsp/window.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+#if DSP_FFT_MAX_LOG2 == 12
+#define TEST_NAME "fft"
+#else
+#define TEST_NAME "fft (small table)"
+#endif
+
+#define N_MAX DSP_FFT_MAX_SIZE
+
+/* error of the sine interpolation, (2 pi / N_MAX)^3 / 6, plus rounding */
+#define SINE_MAX_ERROR \
+	((2 * M_PI / N_MAX) * (2 * M_PI / N_MAX) * (2 * M_PI / N_MAX) / 6 + 2e-9)
+
+/* Transform error bounds in LSB: worst value, and range of the mean
+ * error (rounding half up makes it slightly positive) */
+#define MAX_ERROR 1.75
+#define CHECK_BIAS(bias) CHECK((bias) > -0.05 && (bias) < 0.35)
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static int16_t rnd16(void)
+{
+	return (int16_t)(rnd() & 0xffff);
+}
+
+static double ref_cos[N_MAX], ref_sin[N_MAX];
+
+/* DFT(x) / N of N complex values */
+static void dft(const double* x, double* y, uint32_t n)
+{
+	uint32_t i, k;
+
+	for (i = 0; i < n; i++) {
+		ref_cos[i] = cos(2 * M_PI * i / n);
+		ref_sin[i] = sin(2 * M_PI * i / n);
+	}
+	for (k = 0; k < n; k++) {
+		double re = 0, im = 0;
+
+		for (i = 0; i < n; i++) {
+			uint32_t t = (uint32_t)(((uint64_t)k * i) % n);
+
+			re += x[2 * i] * ref_cos[t] + x[2 * i + 1] * ref_sin[t];
+			im += x[2 * i + 1] * ref_cos[t] - x[2 * i] * ref_sin[t];
+		}
+		y[2 * k] = re / n;
+		y[2 * k + 1] = im / n;
+	}
+}
+
+/* Bin k of a packed real spectrum, scaled to [-1, 1) */
+static void real_bin_q15(const int16_t* x, uint32_t n, uint32_t k,
+		double* re, double* im)
+{
+	if (k == 0) {
+		*re = x[0] / 32768.0;
+		*im = 0;
+	} else if (k == n / 2) {
+		*re = x[1] / 32768.0;
+		*im = 0;
+	} else {
+		*re = x[2 * k] / 32768.0;
+		*im = x[2 * k + 1] / 32768.0;
+	}
+}
+
+static void real_bin_q31(const int32_t* x, uint32_t n, uint32_t k,
+		double* re, double* im)
+{
+	if (k == 0) {
+		*re = x[0] / 2147483648.0;
+		*im = 0;
+	} else if (k == n / 2) {
+		*re = x[1] / 2147483648.0;
+		*im = 0;
+	} else {
+		*re = x[2 * k] / 2147483648.0;
+		*im = x[2 * k + 1] / 2147483648.0;
+	}
+}
+
+static double db(double ratio)
+{
+	return 20 * log10(ratio);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static int16_t x16[2 * N_MAX];
+static int32_t x32[2 * N_MAX];
+static double xd[2 * N_MAX], yd[2 * N_MAX];
+
+static void test_complex(void)
+{
+	uint32_t log2n, n, i, trial, trials;
+
+	/* The bias is averaged over 4096 values at least */
+	for (log2n = 1; log2n <= DSP_FFT_MAX_LOG2; log2n++) {
+		double e15 = 0, e31 = 0, bias15 = 0, bias31 = 0;
+
+		n = 1u << log2n;
+		trials = (2048 + n - 1) / n;
+		for (trial = 0; trial < trials; trial++) {
+			/* |re + j im| <= 1 */
+			for (i = 0; i < 2 * n; i++) {
+				x16[i] = (int16_t)(rnd16() * 7 / 10);
+				x32[i] = (int32_t)((uint32_t)x16[i] << 16 |
+						   (rnd() & 0xffff));
+				xd[i] = x32[i] / 2147483648.0;
+			}
+			dft(xd, yd, n);
+			CHECK(dsp_fft_cq15(x16, log2n) == 0);
+			CHECK(dsp_fft_cq31(x32, log2n) == 0);
+			for (i = 0; i < 2 * n; i++) {
+				double d15 = x16[i] / 32768.0 - yd[i];
+				double d31 = x32[i] / 2147483648.0 - yd[i];
+
+				bias15 += d15;
+				bias31 += d31;
+				if (fabs(d15) > e15)
+					e15 = fabs(d15);
+				if (fabs(d31) > e31)
+					e31 = fabs(d31);
+			}
+		}
+		CHECK(e15 * 32768 <= MAX_ERROR);
+		CHECK(e31 * 2147483648.0 <= MAX_ERROR);
+		CHECK_BIAS(bias15 / (2 * n * trials) * 32768);
+		CHECK_BIAS(bias31 / (2 * n * trials) * 2147483648.0);
+	}
+
+	/* Impulses: flat spectra with a linear phase */
+	for (log2n = 1; log2n <= DSP_FFT_MAX_LOG2; log2n++) {
+		uint32_t pos;
+
+		n = 1u << log2n;
+		pos = rnd() % n;
+		memset(x32, 0, 2 * n * sizeof(x32[0]));
+		x32[2 * pos] = INT32_MAX;
+		CHECK(dsp_fft_cq31(x32, log2n) == 0);
+		for (i = 0; i < n; i++) {
+			double a = -2 * M_PI * (double)((uint64_t)i * pos % n) / n;
+			double scale = 2147483648.0 / n;
+
+			CHECK(fabs(x32[2 * i] - cos(a) * scale) <= 2);
+			CHECK(fabs(x32[2 * i + 1] - sin(a) * scale) <= 2);
+		}
+	}
+
+	/* Invalid sizes */
+	CHECK(dsp_fft_cq15(x16, 0) == -EINVAL);
+	CHECK(dsp_fft_cq15(x16, DSP_FFT_MAX_LOG2 + 1) == -EINVAL);
+	CHECK(dsp_fft_cq31(x32, 0) == -EINVAL);
+	CHECK(dsp_fft_cq31(x32, DSP_FFT_MAX_LOG2 + 1) == -EINVAL);
+}
+
+static void test_real(void)
+{
+	uint32_t log2n, n, i, k, trial, trials;
+
+	for (log2n = 2; log2n <= DSP_FFT_MAX_LOG2; log2n++) {
+		double e15 = 0, e31 = 0, bias15 = 0, bias31 = 0;
+
+		n = 1u << log2n;
+		trials = (4096 + n - 1) / n;
+		for (trial = 0; trial < trials; trial++) {
+			for (i = 0; i < n; i++) {
+				x16[i] = rnd16();
+				x32[i] = (int32_t)(rnd() << 8 | (rnd() & 0xff));
+				xd[2 * i] = x16[i] / 32768.0;
+				xd[2 * i + 1] = 0;
+			}
+			dft(xd, yd, n);
+			CHECK(dsp_fft_rq15(x16, log2n) == 0);
+			for (k = 0; k <= n / 2; k++) {
+				double re, im;
+
+				real_bin_q15(x16, n, k, &re, &im);
+				re -= yd[2 * k];
+				im -= yd[2 * k + 1];
+				bias15 += re + im;
+				if (hypot(re, im) > e15)
+					e15 = hypot(re, im);
+			}
+
+			for (i = 0; i < n; i++) {
+				xd[2 * i] = x32[i] / 2147483648.0;
+				xd[2 * i + 1] = 0;
+			}
+			dft(xd, yd, n);
+			CHECK(dsp_fft_rq31(x32, log2n) == 0);
+			for (k = 0; k <= n / 2; k++) {
+				double re, im;
+
+				real_bin_q31(x32, n, k, &re, &im);
+				re -= yd[2 * k];
+				im -= yd[2 * k + 1];
+				bias31 += re + im;
+				if (hypot(re, im) > e31)
+					e31 = hypot(re, im);
+			}
+		}
+		/* n values per transform: n / 2 + 1 real parts, n / 2 - 1
+		 * imaginary ones */
+		CHECK(e15 * 32768 <= MAX_ERROR);
+		CHECK(e31 * 2147483648.0 <= MAX_ERROR);
+		CHECK_BIAS(bias15 / (n * trials) * 32768);
+		CHECK_BIAS(bias31 / (n * trials) * 2147483648.0);
+	}
+
+	CHECK(dsp_fft_rq15(x16, 1) == -EINVAL);
+	CHECK(dsp_fft_rq15(x16, DSP_FFT_MAX_LOG2 + 1) == -EINVAL);
+	CHECK(dsp_fft_rq31(x32, 1) == -EINVAL);
+	CHECK(dsp_fft_rq31(x32, DSP_FFT_MAX_LOG2 + 1) == -EINVAL);
+}
+
+static void test_full_scale(void)
+{
+	static uint16_t mag16[N_MAX];
+	static uint32_t mag32[N_MAX];
+	uint32_t log2n, n, i, k;
+
+	/* Constant full scale inputs: all the energy in bin 0, exactly */
+	for (log2n = 1; log2n <= DSP_FFT_MAX_LOG2; log2n++) {
+		n = 1u << log2n;
+		for (i = 0; i < 2 * n; i++) {
+			x16[i] = (i & 1) ? 0 : -32768;
+			x32[i] = (i & 1) ? 0 : INT32_MIN;
+		}
+		CHECK(dsp_fft_cq15(x16, log2n) == 0);
+		CHECK(dsp_fft_cq31(x32, log2n) == 0);
+		/* Q31 loses up to an LSB to the rounding of each pass */
+		CHECK(x16[0] == -32768 && x16[1] == 0);
+		CHECK(x32[0] - INT32_MIN <= (int32_t)log2n && x32[1] == 0);
+		for (i = 2; i < 2 * n; i++) {
+			CHECK(x16[i] == 0);
+			CHECK(abs(x32[i]) <= 1);
+		}
+		dsp_fft_cmag_q15(x16, mag16, n);
+		dsp_fft_cmag_q31(x32, mag32, n);
+		CHECK(mag16[0] == 32768);
+		CHECK(0x80000000u - mag32[0] <= log2n);
+
+		if (log2n < 2)
+			continue;
+		for (i = 0; i < n; i++) {
+			x16[i] = -32768;
+			x32[i] = INT32_MIN;
+		}
+		CHECK(dsp_fft_rq15(x16, log2n) == 0);
+		CHECK(dsp_fft_rq31(x32, log2n) == 0);
+		dsp_fft_rmag_q15(x16, mag16, log2n);
+		dsp_fft_rmag_q31(x32, mag32, log2n);
+		CHECK(mag16[0] == 32768);
+		CHECK(0x80000000u - mag32[0] <= log2n);
+		for (k = 1; k <= n / 2; k++) {
+			CHECK(mag16[k] <= 1);
+			CHECK(mag32[k] <= 2);
+		}
+
+		/* Full scale at the Nyquist frequency: in the packed bin */
+		for (i = 0; i < n; i++) {
+			x16[i] = (i & 1) ? -32768 : 32767;
+			x32[i] = (i & 1) ? INT32_MIN : INT32_MAX;
+		}
+		CHECK(dsp_fft_rq15(x16, log2n) == 0);
+		CHECK(dsp_fft_rq31(x32, log2n) == 0);
+		dsp_fft_rmag_q15(x16, mag16, log2n);
+		dsp_fft_rmag_q31(x32, mag32, log2n);
+		CHECK(mag16[n / 2] >= 32766);
+		CHECK(0x7fffffffu - mag32[n / 2] <= log2n);
+		for (k = 0; k < n / 2; k++) {
+			CHECK(mag16[k] <= 1);
+			CHECK(mag32[k] <= 2);
+		}
+	}
+
+	/* Random full scale complex values overflow in no pass: the sanitizer
+	 * checks the arithmetic, the output is in range by type */
+	for (log2n = 1; log2n <= DSP_FFT_MAX_LOG2; log2n++) {
+		n = 1u << log2n;
+		for (i = 0; i < 2 * n; i++) {
+			x16[i] = (i & 1) ? 0 : (rnd() & 1 ? 32767 : -32768);
+			x32[i] = (i & 1) ? 0 : (rnd() & 1 ? INT32_MAX : INT32_MIN);
+		}
+		CHECK(dsp_fft_cq15(x16, log2n) == 0);
+		CHECK(dsp_fft_cq31(x32, log2n) == 0);
+	}
+}
+
+static void test_magnitude(void)
+{
+	int16_t c16[2 * 256];
+	int32_t c32[2 * 256];
+	uint16_t m16[256];
+	uint32_t m32[256];
+	uint32_t i;
+
+	for (i = 0; i < 256; i++) {
+		c16[2 * i] = i < 4 ? (i & 1 ? 32767 : -32768) : rnd16();
+		c16[2 * i + 1] = i < 4 ? (i & 2 ? 32767 : -32768) : rnd16();
+		c32[2 * i] = i < 4 ? (i & 1 ? INT32_MAX : INT32_MIN) :
+			(int32_t)(rnd() << 8);
+		c32[2 * i + 1] = i < 4 ? (i & 2 ? INT32_MAX : INT32_MIN) :
+			(int32_t)(rnd() << 8);
+	}
+	dsp_fft_cmag_q15(c16, m16, 256);
+	dsp_fft_cmag_q31(c32, m32, 256);
+	for (i = 0; i < 256; i++) {
+		double r16 = hypot(c16[2 * i], c16[2 * i + 1]);
+		double r32 = hypot(c32[2 * i], c32[2 * i + 1]);
+
+		CHECK(m16[i] == (uint16_t)floor(r16));
+		CHECK(fabs(m32[i] - r32) <= 1);
+	}
+}
+
+static void test_sine(void)
+{
+	double max_err = 0;
+	uint64_t p;
+	uint32_t q;
+
+	for (p = 0; p < (1ull << 32); p += 12345677) {
+		double a = 2 * M_PI * p / 4294967296.0;
+		double es = fabs(dsp_sin_q31((uint32_t)p) / 2147483648.0 - sin(a));
+		double ec = fabs(dsp_cos_q31((uint32_t)p) / 2147483648.0 - cos(a));
+
+		if (es > max_err)
+			max_err = es;
+		if (ec > max_err)
+			max_err = ec;
+	}
+	CHECK(max_err < SINE_MAX_ERROR);
+
+	for (q = 0; q < 4; q++) {
+		static const int32_t sines[] = { 0, INT32_MAX, 0, -INT32_MAX };
+
+		CHECK(dsp_sin_q31(q << 30) == sines[q]);
+		CHECK(dsp_cos_q31(q << 30) == sines[(q + 1) % 4]);
+	}
+}
+
+static void test_windows(void)
+{
+	static const double gains[] = {
+		[DSP_WINDOW_RECTANGLE] = 1, [DSP_WINDOW_HANN] = 0.5,
+		[DSP_WINDOW_HAMMING] = 0.54, [DSP_WINDOW_BLACKMAN] = 0.42659,
+		[DSP_WINDOW_FLAT_TOP] = 0.21558,
+	};
+	/* leakage more than 8 bins away from a tone, dB */
+	static const double leakage[] = {
+		[DSP_WINDOW_RECTANGLE] = -20, [DSP_WINDOW_HANN] = -55,
+		[DSP_WINDOW_HAMMING] = -42, [DSP_WINDOW_BLACKMAN] = -65,
+		[DSP_WINDOW_FLAT_TOP] = -60,
+	};
+	static int16_t w[N_MAX];
+	static uint16_t mag[N_MAX / 2 + 1];
+	uint32_t log2n = DSP_FFT_MAX_LOG2 < 10 ? DSP_FFT_MAX_LOG2 : 10;
+	uint32_t n = 1u << log2n, i, k, peak;
+	int t;
+
+	for (t = DSP_WINDOW_RECTANGLE; t <= DSP_WINDOW_FLAT_TOP; t++) {
+		double gain, amp, far = 0;
+		double f = n / 8 + 0.37;
+
+		CHECK(dsp_window_init(w, log2n, t) == 0);
+		/* periodic: symmetric around N / 2 */
+		for (i = 1; i < n / 2; i++)
+			CHECK(w[i] == w[n - i]);
+		gain = dsp_window_gain(w, n) / 32768.0;
+		CHECK(fabs(gain - gains[t]) < 0.001);
+
+		/* Amplitude of a tone between two bins, and leakage far from
+		 * it */
+		for (i = 0; i < n; i++)
+			x16[i] = (int16_t)lround(16384 * sin(2 * M_PI * f * i / n));
+		dsp_window_apply_q15(x16, w, n);
+		CHECK(dsp_fft_rq15(x16, log2n) == 0);
+		dsp_fft_rmag_q15(x16, mag, log2n);
+		peak = 0;
+		for (k = 1; k <= n / 2; k++)
+			if (mag[k] > mag[peak])
+				peak = k;
+		CHECK(peak == n / 8);
+		amp = 2.0 * mag[peak] / dsp_window_gain(w, n);
+		if (t == DSP_WINDOW_FLAT_TOP)
+			CHECK(fabs(db(amp / 0.5)) < 0.05);
+		else
+			CHECK(db(amp / 0.5) < 0.05 && db(amp / 0.5) > -4);
+		for (k = 0; k <= n / 2; k++)
+			if ((k < peak ? peak - k : k - peak) > 8 && mag[k] > far)
+				far = mag[k];
+		if (n >= 256)
+			CHECK(db(far / mag[peak]) < leakage[t]);
+	}
+
+	/* Ends and middle */
+	CHECK(dsp_window_init(w, log2n, DSP_WINDOW_HANN) == 0);
+	CHECK(w[0] == 0);
+	CHECK(w[n / 2] == 32767);
+	CHECK(dsp_window_init(w, log2n, DSP_WINDOW_HAMMING) == 0);
+	CHECK(abs(w[0] - 2621) <= 1);
+	CHECK(w[n / 2] == 32767);
+	CHECK(dsp_window_init(w, log2n, DSP_WINDOW_BLACKMAN) == 0);
+	CHECK(abs(w[0] - 225) <= 1);
+	CHECK(w[n / 2] == 32767);
+
+	CHECK(dsp_window_init(w, 0, DSP_WINDOW_HANN) == -EINVAL);
+	CHECK(dsp_window_init(w, DSP_FFT_MAX_LOG2 + 1, DSP_WINDOW_HANN) ==
+	      -EINVAL);
+	CHECK(dsp_window_init(w, log2n, DSP_WINDOW_FLAT_TOP + 1) == -EINVAL);
+	CHECK(dsp_window_gain(w, 0) == 0);
+}
+
+static void test_load(void)
+{
+	int16_t w[16], frames16[16 * 3], d16[16], e16[16];
+	int32_t frames32[16 * 2], d32[16], e32[16];
+	uint16_t adc[16 * 2];
+	int16_t dadc[16];
+	uint32_t i;
+
+	CHECK(dsp_window_init(w, 4, DSP_WINDOW_HAMMING) == 0);
+	for (i = 0; i < 16 * 3; i++)
+		frames16[i] = i == 3 ? -32768 : rnd16();
+	for (i = 0; i < 16 * 2; i++)
+		frames32[i] = i == 2 ? INT32_MIN : (int32_t)(rnd() << 8);
+
+	/* One channel of the frames, without and with the window */
+	dsp_window_load_q15(d16, frames16, 3, NULL, 16);
+	dsp_window_load_q31(d32, frames32, 2, NULL, 16);
+	for (i = 0; i < 16; i++) {
+		CHECK(d16[i] == frames16[3 * i]);
+		CHECK(d32[i] == frames32[2 * i]);
+		e16[i] = d16[i];
+		e32[i] = d32[i];
+	}
+	dsp_window_apply_q15(e16, w, 16);
+	dsp_window_apply_q31(e32, w, 16);
+	dsp_window_load_q15(d16, frames16, 3, w, 16);
+	dsp_window_load_q31(d32, frames32, 2, w, 16);
+	CHECK(memcmp(d16, e16, sizeof(d16)) == 0);
+	CHECK(memcmp(d32, e32, sizeof(d32)) == 0);
+	for (i = 0; i < 16; i++) {
+		CHECK(abs(e16[i] - frames16[3 * i] * w[i] / 32768.0) <= 1);
+		CHECK(fabs(e32[i] - (double)frames32[2 * i] * w[i] / 32768.0) <= 1);
+	}
+
+	/* ADC results: 12 bits with a channel tag above, mid-scale is 0 */
+	for (i = 0; i < 16; i++) {
+		adc[2 * i] = (uint16_t)((5u << 12) | (i * 273));
+		adc[2 * i + 1] = 0xffff;
+	}
+	adc[0] = (5u << 12) | 0x800;
+	adc[2] = (5u << 12) | 0xfff;
+	adc[4] = 5u << 12;
+	dsp_window_load_adc(dadc, adc, 2, 12, NULL, 16);
+	CHECK(dadc[0] == 0);
+	CHECK(dadc[1] == 32752);
+	CHECK(dadc[2] == -32768);
+	for (i = 3; i < 16; i++)
+		CHECK(dadc[i] == ((int32_t)(i * 273) - 2048) * 16);
+	dsp_window_load_adc(d16, adc, 2, 12, w, 16);
+	for (i = 0; i < 16; i++)
+		CHECK(d16[i] == ((dadc[i] * w[i] + 0x4000) >> 15));
+
+	/* 16 bits: full range */
+	adc[0] = 0;
+	adc[2] = 0xffff;
+	dsp_window_load_adc(dadc, adc, 2, 16, NULL, 2);
+	CHECK(dadc[0] == -32768);
+	CHECK(dadc[1] == 32767);
+}
+
+static void test_goertzel(void)
+{
+	static const uint32_t freqs[] = { 50, 697, 1209, 1633, 10000, 23000 };
+	static int16_t frames[2 * 4800];
+	const uint32_t rate = 48000, n = 4800;
+	struct _dsp_goertzel g, g2, off;
+	uint32_t t, i;
+
+	for (t = 0; t < sizeof(freqs) / sizeof(freqs[0]); t++) {
+		/* a tone at a quarter of full scale, with another tone, on
+		 * the first channel of stereo frames */
+		for (i = 0; i < n; i++) {
+			frames[2 * i] = (int16_t)lround(
+				8192 * sin(2 * M_PI * freqs[t] * i / rate) +
+				3277 * sin(2 * M_PI * 3000.0 * i / rate));
+			frames[2 * i + 1] = 12345;
+		}
+
+		/* in two calls of any size, or in one */
+		dsp_goertzel_init(&g, freqs[t], rate);
+		dsp_goertzel_process(&g, frames, 2, 1000);
+		dsp_goertzel_process(&g, frames + 2000, 2, n - 1000);
+		dsp_goertzel_init(&g2, freqs[t], rate);
+		dsp_goertzel_process(&g2, frames, 2, n);
+		CHECK(g.count == n);
+		CHECK(dsp_goertzel_amplitude(&g) == dsp_goertzel_amplitude(&g2));
+		/* the smallest table is too coarse for the coefficient */
+		if (DSP_FFT_MAX_LOG2 >= 10) {
+			CHECK(fabs(dsp_goertzel_amplitude(&g) / 8192.0 - 1) <
+			      0.001);
+
+			/* 300 Hz away: not there */
+			dsp_goertzel_init(&off, freqs[t] + 300, rate);
+			dsp_goertzel_process(&off, frames, 2, n);
+			CHECK(dsp_goertzel_amplitude(&off) < 100);
+		}
+
+		/* reset */
+		dsp_goertzel_reset(&g);
+		CHECK(dsp_goertzel_amplitude(&g) == 0);
+		dsp_goertzel_process(&g, frames, 2, n);
+		CHECK(dsp_goertzel_amplitude(&g) == dsp_goertzel_amplitude(&g2));
+	}
+
+	/* Long block of full scale DC at a low frequency: the state grows to
+	 * the 64-bit range without overflowing */
+	for (i = 0; i < n; i++)
+		frames[i] = 32767;
+	dsp_goertzel_init(&g, 1, rate);
+	for (i = 0; i < 100; i++)
+		dsp_goertzel_process(&g, frames, 1, 4096);
+	CHECK(dsp_goertzel_amplitude(&g) > 0);
+}
+
+int main(void)
+{
+	test_complex();
+	test_real();
+	test_full_scale();
+	test_magnitude();
+	test_sine();
+	test_windows();
+	test_load();
+	test_goertzel();
+	return host_test_end(TEST_NAME);
+}
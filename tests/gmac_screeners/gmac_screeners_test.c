@@ -0,0 +1,276 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the GMAC screening rules packing. gmac_pack_screeners() is
+ * checked against register values worked out by hand from the SAMA5D2
+ * datasheet, and gmac_set_screeners() against a GMAC register block in RAM.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "timer.h"
+#include "trace.h"
+#include "network/gmac.h"
+#include "peripherals/pmc.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Platform stubs
+ *----------------------------------------------------------------------------*/
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+uint32_t get_gmac_id_from_addr(const Gmac* addr)
+{
+	(void)addr;
+	return 0;
+}
+
+void pmc_configure_peripheral(uint32_t id, const struct _pmc_periph_cfg* cfg, bool enable)
+{
+	(void)id;
+	(void)cfg;
+	(void)enable;
+}
+
+uint32_t pmc_get_peripheral_clock(uint32_t id)
+{
+	(void)id;
+	return 83000000;
+}
+
+void timer_start_timeout(struct _timeout* timeout, uint64_t count)
+{
+	timeout->start = 0;
+	timeout->count = count;
+}
+
+uint8_t timer_timeout_reached(struct _timeout* timeout)
+{
+	(void)timeout;
+	return 1;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+/* Register values, bit by bit:
+ * ST1RPQ: QNB 2:0, DSTCM 11:4, UDPM 27:12, DSTCE 28, UDPE 29
+ * ST2RPQ: QNB 2:0, VLANP 6:4, VLANE 8, I2ETH 11:9, ETHE 12 */
+static void test_layout(void)
+{
+	static const struct _gmac_st1_rule st1[] = {
+		{ .queue = 2, .dstc_enable = true, .dstc = 0x2e },
+		{ .queue = 1, .dstc = 0x11, .udp_enable = true, .udp_port = 319 },
+		{ .queue = 2, .dstc_enable = true, .dstc = 0xff,
+		  .udp_enable = true, .udp_port = 0xffff },
+		/* values of disabled matches are not packed */
+		{ .queue = 0, .dstc_enable = true, .dstc = 0x01,
+		  .udp_port = 0x1234 },
+	};
+	static const struct _gmac_st2_rule st2[] = {
+		{ .queue = 1, .vlan_enable = true, .vlan_priority = 5 },
+		{ .queue = 2, .ethertype_enable = true, .ethertype = 0x88f7 },
+		{ .queue = 2, .vlan_enable = true, .vlan_priority = 7,
+		  .ethertype_enable = true, .ethertype = 0x0800 },
+		{ .queue = 0, .ethertype_enable = true, .ethertype = 0x86dd,
+		  .vlan_priority = 3 },
+	};
+	static const uint32_t st1rpq[GMAC_ST1_COUNT] = {
+		0x100002e2, 0x2013f001, 0x3ffffff2, 0x10000010,
+	};
+	static const uint32_t st2rpq[GMAC_ST2_COUNT] = {
+		0x00000151, 0x00001002, 0x00001372, 0x00001400,
+	};
+	static const uint32_t st2er[GMAC_ST2ER_COUNT] = {
+		0x88f7, 0x0800, 0x86dd, 0,
+	};
+	struct _gmac_screeners scr;
+	int i;
+
+	memset(&scr, 0xa5, sizeof(scr));
+	CHECK(gmac_pack_screeners(st1, 4, st2, 4, &scr) == 0);
+	for (i = 0; i < GMAC_ST1_COUNT; i++)
+		CHECK(scr.st1rpq[i] == st1rpq[i]);
+	for (i = 0; i < GMAC_ST2_COUNT; i++)
+		CHECK(scr.st2rpq[i] == st2rpq[i]);
+	for (i = 0; i < GMAC_ST2ER_COUNT; i++)
+		CHECK(scr.st2er[i] == st2er[i]);
+
+	/* No rule at all clears everything */
+	memset(&scr, 0xa5, sizeof(scr));
+	CHECK(gmac_pack_screeners(NULL, 0, NULL, 0, &scr) == 0);
+	for (i = 0; i < GMAC_ST1_COUNT; i++)
+		CHECK(scr.st1rpq[i] == 0);
+	for (i = 0; i < GMAC_ST2_COUNT; i++)
+		CHECK(scr.st2rpq[i] == 0);
+	for (i = 0; i < GMAC_ST2ER_COUNT; i++)
+		CHECK(scr.st2er[i] == 0);
+}
+
+/* Rules matching the same EtherType share its compare register, in the
+ * order the EtherTypes first appear */
+static void test_ethertype_sharing(void)
+{
+	static const uint16_t types[GMAC_ST2_COUNT] = {
+		0x88f7, 0x0800, 0x88f7, 0x86dd, 0x0800, 0x88cc, 0x86dd, 0x88cc,
+	};
+	static const uint8_t index[GMAC_ST2_COUNT] = {
+		0, 1, 0, 2, 1, 3, 2, 3,
+	};
+	struct _gmac_st2_rule st2[GMAC_ST2_COUNT];
+	struct _gmac_screeners scr;
+	int i;
+
+	memset(st2, 0, sizeof(st2));
+	for (i = 0; i < GMAC_ST2_COUNT; i++) {
+		st2[i].queue = i % GMAC_QUEUE_COUNT;
+		st2[i].ethertype_enable = true;
+		st2[i].ethertype = types[i];
+	}
+	CHECK(gmac_pack_screeners(NULL, 0, st2, GMAC_ST2_COUNT, &scr) == 0);
+	CHECK(scr.st2er[0] == 0x88f7 && scr.st2er[1] == 0x0800);
+	CHECK(scr.st2er[2] == 0x86dd && scr.st2er[3] == 0x88cc);
+	for (i = 0; i < GMAC_ST2_COUNT; i++)
+		CHECK(scr.st2rpq[i] == (GMAC_ST2RPQ_ETHE |
+				((uint32_t)index[i] << 9) |
+				(uint32_t)(i % GMAC_QUEUE_COUNT)));
+
+	/* A fifth EtherType does not fit, even with registers shared */
+	st2[7].ethertype = 0x8100;
+	CHECK(gmac_pack_screeners(NULL, 0, st2, GMAC_ST2_COUNT, &scr) == -ENOSPC);
+	/* Unless the rule does not match the EtherType */
+	st2[7].ethertype_enable = false;
+	st2[7].vlan_enable = true;
+	CHECK(gmac_pack_screeners(NULL, 0, st2, GMAC_ST2_COUNT, &scr) == 0);
+	CHECK(scr.st2er[3] == 0x88cc);
+	CHECK(scr.st2rpq[7] == (GMAC_ST2RPQ_VLANE | 1));
+}
+
+/* Queue numbers, VLAN priorities and empty rules are rejected, and so are
+ * more rules than registers */
+static void test_errors(void)
+{
+	struct _gmac_st1_rule st1[GMAC_ST1_COUNT + 1];
+	struct _gmac_st2_rule st2[GMAC_ST2_COUNT + 1];
+	struct _gmac_screeners scr;
+	int i;
+
+	memset(st1, 0, sizeof(st1));
+	for (i = 0; i < GMAC_ST1_COUNT + 1; i++) {
+		st1[i].queue = GMAC_QUEUE_COUNT - 1;
+		st1[i].udp_enable = true;
+		st1[i].udp_port = 5000 + i;
+	}
+	memset(st2, 0, sizeof(st2));
+	for (i = 0; i < GMAC_ST2_COUNT + 1; i++) {
+		st2[i].queue = GMAC_QUEUE_COUNT - 1;
+		st2[i].vlan_enable = true;
+		st2[i].vlan_priority = i % 8;
+	}
+
+	/* Full tables fit, one more rule does not */
+	CHECK(gmac_pack_screeners(st1, GMAC_ST1_COUNT, st2, GMAC_ST2_COUNT, &scr) == 0);
+	CHECK(gmac_pack_screeners(st1, GMAC_ST1_COUNT + 1, st2, 0, &scr) == -ENOSPC);
+	CHECK(gmac_pack_screeners(st1, 0, st2, GMAC_ST2_COUNT + 1, &scr) == -ENOSPC);
+
+	/* Queue numbers */
+	st1[3].queue = GMAC_QUEUE_COUNT;
+	CHECK(gmac_pack_screeners(st1, GMAC_ST1_COUNT, st2, 0, &scr) == -EINVAL);
+	CHECK(gmac_pack_screeners(st1, 3, st2, 0, &scr) == 0);
+	st1[3].queue = GMAC_QUEUE_COUNT - 1;
+	st2[5].queue = GMAC_QUEUE_COUNT;
+	CHECK(gmac_pack_screeners(st1, 0, st2, GMAC_ST2_COUNT, &scr) == -EINVAL);
+	st2[5].queue = 0xff;
+	CHECK(gmac_pack_screeners(st1, 0, st2, GMAC_ST2_COUNT, &scr) == -EINVAL);
+	st2[5].queue = GMAC_QUEUE_COUNT - 1;
+
+	/* VLAN priorities */
+	st2[6].vlan_priority = 8;
+	CHECK(gmac_pack_screeners(st1, 0, st2, GMAC_ST2_COUNT, &scr) == -EINVAL);
+	st2[6].vlan_priority = 7;
+	CHECK(gmac_pack_screeners(st1, 0, st2, GMAC_ST2_COUNT, &scr) == 0);
+	CHECK(scr.st2rpq[6] == (GMAC_ST2RPQ_VLANE | (7 << 4) |
+			(GMAC_QUEUE_COUNT - 1)));
+
+	/* Rules matching nothing */
+	st1[0].udp_enable = false;
+	CHECK(gmac_pack_screeners(st1, 1, st2, 0, &scr) == -EINVAL);
+	st1[0].udp_enable = true;
+	st2[0].vlan_enable = false;
+	CHECK(gmac_pack_screeners(st1, 0, st2, 1, &scr) == -EINVAL);
+}
+
+/* The packed values land in the screening registers */
+static void test_set_screeners(void)
+{
+	static Gmac gmac;
+	static const struct _gmac_st1_rule st1[] = {
+		{ .queue = 1, .dstc_enable = true, .dstc = 0xb8 },
+	};
+	static const struct _gmac_st2_rule st2[] = {
+		{ .queue = 2, .ethertype_enable = true, .ethertype = 0x88f7 },
+		{ .queue = 1, .vlan_enable = true, .vlan_priority = 6 },
+	};
+	struct _gmac_screeners scr;
+	int i;
+
+	memset((void*)&gmac, 0xa5, sizeof(gmac));
+	REQUIRE(gmac_pack_screeners(st1, 1, st2, 2, &scr) == 0);
+	gmac_set_screeners(&gmac, &scr);
+	CHECK(gmac.GMAC_ST1RPQ[0] == 0x10000b81);
+	for (i = 1; i < GMAC_ST1_COUNT; i++)
+		CHECK(gmac.GMAC_ST1RPQ[i] == 0);
+	CHECK(gmac.GMAC_ST2RPQ[0] == 0x00001002);
+	CHECK(gmac.GMAC_ST2RPQ[1] == 0x00000161);
+	for (i = 2; i < GMAC_ST2_COUNT; i++)
+		CHECK(gmac.GMAC_ST2RPQ[i] == 0);
+	CHECK(gmac.GMAC_ST2ER[0] == 0x88f7);
+	for (i = 1; i < GMAC_ST2ER_COUNT; i++)
+		CHECK(gmac.GMAC_ST2ER[i] == 0);
+}
+
+int main(void)
+{
+	test_layout();
+	test_ethertype_sharing();
+	test_errors();
+	test_set_screeners();
+	return host_test_end("gmac_screeners");
+}
@@ -0,0 +1,349 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the GPIO event subsystem: debouncer, quadrature decoder and
+ * event queue, then buttons and encoders attached to simulated PIO inputs
+ * whose interrupt handlers are called by the test when an input changes.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "gpio/gpio_event.h"
+#include "gpio/pio.h"
+#include "irqflags.h"
+#include "timer.h"
+
+#include "host_test.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated PIO
+ *----------------------------------------------------------------------------*/
+
+#define MAX_HANDLERS 8
+
+bool host_irq_enabled = true;
+
+static uint64_t now_us;
+
+static struct {
+	uint32_t levels[PIO_GROUP_LENGTH];
+	uint32_t it_enabled[PIO_GROUP_LENGTH];
+	struct {
+		uint32_t group;
+		uint32_t mask;
+		pio_handler_t handler;
+		void* arg;
+	} handlers[MAX_HANDLERS];
+	int count;
+	uint32_t unmasked_reads;  /* pio_get() outside of an interrupt */
+	bool in_irq;
+} pio;
+
+uint32_t pio_get(const struct _pin* pin)
+{
+	if (!pio.in_irq && host_irq_enabled)
+		pio.unmasked_reads++;
+	return pio.levels[pin->group] & pin->mask;
+}
+
+void pio_add_handler_to_group(uint32_t group, uint32_t mask, pio_handler_t handler, void* user_arg)
+{
+	REQUIRE(pio.count < MAX_HANDLERS);
+	pio.handlers[pio.count].group = group;
+	pio.handlers[pio.count].mask = mask;
+	pio.handlers[pio.count].handler = handler;
+	pio.handlers[pio.count].arg = user_arg;
+	pio.count++;
+}
+
+void pio_enable_it(const struct _pin* pin)
+{
+	pio.it_enabled[pin->group] |= pin->mask;
+}
+
+uint64_t timer_get_us(void)
+{
+	return now_us;
+}
+
+/* Change the level of a pin at a given time, and run its handlers */
+static void set_level(const struct _pin* pin, uint32_t time, uint8_t level)
+{
+	int i;
+
+	now_us = time;
+	if (level)
+		pio.levels[pin->group] |= pin->mask;
+	else
+		pio.levels[pin->group] &= ~pin->mask;
+
+	if (!(pio.it_enabled[pin->group] & pin->mask))
+		return;
+	pio.in_irq = true;
+	for (i = 0; i < pio.count; i++) {
+		if (pio.handlers[i].group == pin->group && (pio.handlers[i].mask & pin->mask))
+			pio.handlers[i].handler(pin->group, pin->mask, pio.handlers[i].arg);
+	}
+	pio.in_irq = false;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/* Forward sequence of the A/B levels */
+static const uint8_t quad_seq[4] = { 0, 2, 3, 1 };
+
+static int quad_move(struct _gpio_quad* quad, int* pos, int dir)
+{
+	*pos = (*pos + 4 + dir) % 4;
+	return gpio_quad_update(quad, quad_seq[*pos] >> 1, quad_seq[*pos] & 1);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_debounce(void)
+{
+	struct _gpio_debounce db;
+	uint32_t t = 1000;
+	int k, edges = 0;
+	uint8_t level = 1;
+
+	/* press bouncing ten times within the lockout: one edge */
+	gpio_debounce_init(&db, 5000, 1);
+	for (k = 0; k < 10; k++) {
+		level ^= 1;
+		if (gpio_debounce_update(&db, t, level))
+			edges++;
+		t += 200;
+	}
+	CHECK(edges == 1 && db.level == 0);
+
+	/* the bounces ended high: seen once the lockout is over */
+	CHECK(!gpio_debounce_update(&db, 1000 + 4999, level));
+	CHECK(gpio_debounce_update(&db, 1000 + 5000, level) && db.level == 1);
+	CHECK(!gpio_debounce_update(&db, 20000, 1));
+	CHECK(gpio_debounce_update(&db, 20001, 0) && db.level == 0);
+	CHECK(db.since == 20001);
+
+	/* any non-zero level is high */
+	CHECK(gpio_debounce_update(&db, 30000, 0x80) && db.level == 1);
+
+	/* lockout across the wrap-around of the timestamps */
+	gpio_debounce_init(&db, 5000, 0);
+	CHECK(gpio_debounce_update(&db, 0xfffff000u, 1));
+	CHECK(!gpio_debounce_update(&db, 0x100, 0));
+	CHECK(gpio_debounce_update(&db, 0x1000, 0));
+}
+
+static void test_quad(void)
+{
+	static const uint8_t steps[] = { 1, 2, 4 };
+	struct _gpio_quad quad;
+	unsigned i;
+	int k, pos, total;
+
+	for (i = 0; i < sizeof(steps); i++) {
+		pos = 0;
+		total = 0;
+		gpio_quad_init(&quad, steps[i], 0, 0);
+		for (k = 0; k < 400; k++)
+			total += quad_move(&quad, &pos, 1);
+		CHECK(total == 400 / steps[i]);
+		for (k = 0; k < 40; k++)
+			total += quad_move(&quad, &pos, -1);
+		CHECK(total == 360 / steps[i]);
+		CHECK(quad.errors == 0);
+	}
+
+	/* jitter on one edge does not reach a detent */
+	gpio_quad_init(&quad, 4, 0, 0);
+	pos = 0;
+	total = 0;
+	for (k = 0; k < 100; k++) {
+		total += quad_move(&quad, &pos, 1);
+		total += quad_move(&quad, &pos, -1);
+	}
+	CHECK(total == 0 && quad.count == 0);
+
+	/* both inputs changed: counted and ignored */
+	total += quad_move(&quad, &pos, 2);
+	CHECK(total == 0 && quad.errors == 1 && quad.count == 0);
+	for (k = 0; k < 4; k++)
+		total += quad_move(&quad, &pos, 1);
+	CHECK(total == 1);
+
+	/* every transition from every state */
+	for (i = 0; i < 4; i++) {
+		for (k = 0; k < 4; k++) {
+			gpio_quad_init(&quad, 1, quad_seq[i] >> 1, quad_seq[i] & 1);
+			pos = i;
+			total = quad_move(&quad, &pos, k);
+			CHECK(total == (k == 1 ? 1 : k == 3 ? -1 : 0));
+			CHECK(quad.errors == (k == 2));
+		}
+	}
+
+	/* no steps means one transition per detent */
+	gpio_quad_init(&quad, 0, 1, 1);
+	CHECK(quad.steps == 1 && quad.state == 3);
+}
+
+static void test_queue(void)
+{
+	struct _gpio_event events[8], e;
+	struct _gpio_event_queue queue;
+	int i, pushed = 0, popped = 0;
+
+	gpio_event_queue_init(&queue, events, 8);
+	for (i = 0; i < 10; i++) {
+		memset(&e, 0, sizeof(e));
+		e.id = i;
+		CHECK(gpio_event_queue_push(&queue, &e) == (i < 7));
+	}
+	CHECK(queue.overflows == 3);
+	for (i = 0; i < 7; i++)
+		CHECK(gpio_event_queue_pop(&queue, &e) && e.id == i);
+	CHECK(!gpio_event_queue_pop(&queue, &e));
+
+	/* FIFO order over many wrap-arounds */
+	for (i = 0; i < 1000; i++) {
+		int n = i % 5;
+
+		while (n--) {
+			e.id = pushed;
+			if (gpio_event_queue_push(&queue, &e))
+				pushed++;
+		}
+		n = i % 4;
+		while (n-- && gpio_event_queue_pop(&queue, &e))
+			CHECK(e.id == (uint8_t)popped++);
+	}
+	while (gpio_event_queue_pop(&queue, &e))
+		CHECK(e.id == (uint8_t)popped++);
+	CHECK(popped == pushed);
+}
+
+static void test_sources(void)
+{
+	static const struct _pin button = { PIO_GROUP_A, 1u << 3, PIO_INPUT, PIO_IT_BOTH_EDGE };
+	static const struct _pin enc_a = { PIO_GROUP_B, 1u << 0, PIO_INPUT, PIO_IT_BOTH_EDGE };
+	static const struct _pin enc_b = { PIO_GROUP_B, 1u << 1, PIO_INPUT, PIO_IT_BOTH_EDGE };
+	static const struct _pin enc2_a = { PIO_GROUP_C, 1u << 7, PIO_INPUT, PIO_IT_BOTH_EDGE };
+	static const struct _pin enc2_b = { PIO_GROUP_D, 1u << 9, PIO_INPUT, PIO_IT_BOTH_EDGE };
+	struct _gpio_event_source sources[3];
+	struct _gpio_event events[8], e;
+	const struct _pin* enc[2][2] = { { &enc_a, &enc_b }, { &enc2_a, &enc2_b } };
+	int i, k, pos;
+
+	memset(&pio, 0, sizeof(pio));
+	pio.levels[PIO_GROUP_A] = button.mask;
+	gpio_event_init(events, 8);
+	gpio_event_add_button(&sources[0], 10, &button, 5000);
+	gpio_event_add_encoder(&sources[1], 11, &enc_a, &enc_b, 4);
+	gpio_event_add_encoder(&sources[2], 12, &enc2_a, &enc2_b, 2);
+	CHECK(sources[0].debounce.level == 1);
+	pio.unmasked_reads = 0;
+
+	/* pins of the same PIO group share a handler */
+	CHECK(pio.count == 4);
+	CHECK(pio.handlers[1].group == PIO_GROUP_B && pio.handlers[1].mask == 3);
+	CHECK(pio.it_enabled[PIO_GROUP_B] == 3);
+	CHECK(pio.it_enabled[PIO_GROUP_C] == enc2_a.mask);
+	CHECK(pio.it_enabled[PIO_GROUP_D] == enc2_b.mask);
+
+	/* press bouncing, released during the lockout */
+	set_level(&button, 1000, 0);
+	set_level(&button, 1100, 1);
+	set_level(&button, 1200, 0);
+	set_level(&button, 3000, 1);
+	CHECK(gpio_event_get(&e));
+	CHECK(e.id == 10 && e.type == GPIO_EVENT_EDGE && e.value == 0 && e.timestamp == 1000);
+	CHECK(!gpio_event_get(&e));
+
+	now_us = 5999;
+	gpio_event_poll();
+	CHECK(!gpio_event_get(&e));
+	now_us = 6000;
+	gpio_event_poll();
+	CHECK(gpio_event_get(&e));
+	CHECK(e.id == 10 && e.value == 1 && e.timestamp == 6000);
+	CHECK(host_irq_enabled);
+	CHECK(pio.unmasked_reads == 0);
+
+	/* nothing pending once the lockout is over */
+	now_us = 20000;
+	gpio_event_poll();
+	CHECK(!gpio_event_get(&e));
+
+	/* one detent forward on the first encoder, two back on the second */
+	for (i = 0, pos = 0; i < 4; i++) {
+		pos = (pos + 1) % 4;
+		set_level(enc[0][0], 30000 + i, quad_seq[pos] >> 1);
+		set_level(enc[0][1], 30000 + i, quad_seq[pos] & 1);
+	}
+	for (i = 0, pos = 0; i < 4; i++) {
+		pos = (pos + 3) % 4;
+		for (k = 0; k < 2; k++)
+			set_level(enc[1][k], 40000 + i, k ? quad_seq[pos] & 1 : quad_seq[pos] >> 1);
+	}
+	CHECK(gpio_event_get(&e));
+	CHECK(e.id == 11 && e.type == GPIO_EVENT_STEP && e.value == 1 && e.timestamp == 30003);
+	CHECK(gpio_event_get(&e));
+	CHECK(e.id == 12 && e.value == -1 && e.timestamp == 40001);
+	CHECK(gpio_event_get(&e));
+	CHECK(e.id == 12 && e.value == -1 && e.timestamp == 40003);
+	CHECK(!gpio_event_get(&e));
+	CHECK(sources[1].quad.errors == 0 && sources[2].quad.errors == 0);
+
+	/* full queue */
+	for (i = 0; i < 10; i++)
+		set_level(&button, 100000 + i * 10000, i & 1);
+	CHECK(gpio_event_get_overflows() == 3);
+	for (i = 0; i < 7; i++)
+		CHECK(gpio_event_get(&e) && e.value == (i & 1));
+	CHECK(!gpio_event_get(&e));
+}
+
+int main(void)
+{
+	test_debounce();
+	test_quad();
+	test_queue();
+	test_sources();
+	return host_test_end("gpio_event");
+}
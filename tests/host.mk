@@ -0,0 +1,76 @@
+# ----------------------------------------------------------------------------
+#         SAM Software Package License
+# ----------------------------------------------------------------------------
+# Copyright (c) 2017, Atmel Corporation
+#
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# - Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the disclaimer below.
+#
+# Atmel's name may not be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+# IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+# DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+# OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+# LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+# NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+# EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+# ----------------------------------------------------------------------------
+
+# Common rules for the host tests, included by tests/*/Makefile after
+# setting:
+#   TEST        name of the test program
+#   SRCS        sources, relative to TOP for the package sources
+#   CPPFLAGS    defines (CONFIG_* and the like) and extra include paths
+#   ARGS        arguments given to the test program by "make check"
+#
+# Tests are built with AddressSanitizer and UndefinedBehaviorSanitizer
+# unless SANITIZE is set empty. They are linked as position dependent
+# executables so that static buffers are addressable by the 32-bit DMA
+# descriptors and registers of the drivers.
+
+TOP ?= ../..
+BUILDDIR ?= build
+
+CC ?= cc
+CFLAGS ?= -O1 -g
+SANITIZE ?= -fsanitize=address,undefined -fno-sanitize-recover=all
+
+HOST_CFLAGS := -std=gnu99 -Wall -Wno-int-to-pointer-cast -Wno-pointer-to-int-cast \
+	-fno-pie $(SANITIZE)
+HOST_LDFLAGS := -no-pie $(SANITIZE)
+HOST_CPPFLAGS := -I. -I$(TOP)/tests/include -I$(TOP)/utils -I$(TOP)/drivers
+
+OBJS := $(addprefix $(BUILDDIR)/,$(notdir $(SRCS:.c=.o)))
+
+vpath %.c $(sort $(dir $(SRCS)))
+
+.PHONY: all check clean
+
+all: $(BUILDDIR)/$(TEST)
+
+check: $(BUILDDIR)/$(TEST)
+	$(BUILDDIR)/$(TEST) $(ARGS)
+
+clean:
+	rm -rf $(BUILDDIR)
+
+$(BUILDDIR)/$(TEST): $(OBJS)
+	$(CC) $(HOST_LDFLAGS) $(LDFLAGS) -o $@ $^ $(LDLIBS) -lm
+
+$(BUILDDIR)/%.o: %.c | $(BUILDDIR)
+	$(CC) $(HOST_CFLAGS) $(CFLAGS) $(HOST_CPPFLAGS) $(CPPFLAGS) -MMD -MP -c -o $@ $<
+
+$(BUILDDIR):
+	mkdir -p $@
+
+-include $(OBJS:.o=.d)
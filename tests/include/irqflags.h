@@ -0,0 +1,66 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host stand-in for arch/irqflags.h: the interrupt mask is a flag that the
+ * tests check. Tests using it define host_irq_enabled.
+ */
+
+#ifndef IRQFLAGS_H_
+#define IRQFLAGS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+extern bool host_irq_enabled;
+
+static inline void arch_irq_enable(void)
+{
+	host_irq_enabled = true;
+}
+
+static inline void arch_irq_disable(void)
+{
+	host_irq_enabled = false;
+}
+
+static inline uint32_t arch_irq_save(void)
+{
+	uint32_t flags = host_irq_enabled;
+
+	host_irq_enabled = false;
+	return flags;
+}
+
+static inline void arch_irq_restore(uint32_t flags)
+{
+	host_irq_enabled = flags != 0;
+}
+
+#endif /* IRQFLAGS_H_ */
@@ -0,0 +1,61 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host stand-in for drivers/mm/cache.h: host memory is coherent, cache
+ * maintenance does nothing.
+ */
+
+#ifndef CACHE_H_
+#define CACHE_H_
+
+#include <stdint.h>
+
+#define L1_CACHE_BYTES 32
+
+#define NOT_CACHED __attribute__((__aligned__(L1_CACHE_BYTES)))
+#define CACHE_ALIGNED __attribute__((__aligned__(L1_CACHE_BYTES)))
+#define CACHE_ALIGNED_CONST __attribute__((__aligned__(L1_CACHE_BYTES)))
+#define CACHE_ALIGNED_DDR __attribute__((__aligned__(L1_CACHE_BYTES)))
+
+#define IS_CACHE_ALIGNED(x) ((((uintptr_t)(x)) & (L1_CACHE_BYTES - 1)) == 0)
+
+static inline void cache_invalidate_region(void *start, uint32_t length)
+{
+	(void)start;
+	(void)length;
+}
+
+static inline void cache_clean_region(const void *start, uint32_t length)
+{
+	(void)start;
+	(void)length;
+}
+
+#endif /* CACHE_H_ */
@@ -0,0 +1,864 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the nandflash applet 'program blocks' command
+ * (APPLET_CMD_PROGRAM_BLOCKS). The applet runs on the raw, skip block and
+ * spare scheme drivers over a simulated NAND bus: the simulator decodes the
+ * commands, addresses and data cycles, programs pages by ANDing them into
+ * the array, and reports RDY/ARDY/FAIL/FAILC with tR, tPROG, tCBSY and
+ * tBERS on a simulated clock. It counts NOP and in-block order violations,
+ * and injects factory bad blocks and program/erase failures. Its ONFI
+ * parameter page tells the ONFI driver whether cache program is supported.
+ *
+ * The test checks the data, the PMECC bytes and the block map returned for
+ * a partition with bad blocks, with and without cache program and PMECC and
+ * for several chunk sizes, then strict mode, errors and session handling.
+ * Cache program must be faster than page program, itself faster than
+ * per-page 'write pages' on the simulated clock. With -b, the simulated
+ * throughputs are printed.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+/* the applet, for its static 'program blocks' handler and state */
+#include "main.c"
+
+#include "nvm/nand/nand_flash_commands.h"
+
+#include "host_test.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated NAND flash
+ *----------------------------------------------------------------------------*/
+
+#define PAGE 2048
+#define SPARE 64
+#define PPB 64
+#define NBLK 64
+#define NPAGES (PPB * NBLK)
+
+/* timings in ns */
+#define T_CYCLE 25
+#define T_R 25000
+#define T_PROG 300000
+#define T_CBSY 3000
+#define T_BERS 2000000
+#define T_RST 5000
+#define T_PMECC 1000
+
+/* PMECC: 4 sectors of 512 bytes, 7 ECC bytes each */
+#define ECC_START 36
+#define ECC_BYTES 28
+
+static uint64_t now;
+static uint8_t flash[NPAGES][PAGE + SPARE];
+static uint8_t nprog[NPAGES];
+static int last_prog_page[NBLK];
+static bool erase_fail[NBLK];
+static int prog_fail_page[NBLK];
+static unsigned violations;
+static unsigned n_prog, n_cache, n_erase, n_reset;
+
+static enum { IDLE, ADDR, DIN, DOUT, STATUS } mode;
+static uint8_t cmd;
+static uint8_t addr[8];
+static int naddr;
+static uint32_t col, row;
+static uint8_t reg[PAGE + SPARE];
+static uint64_t array_until, rdy_until;
+static bool fail_last, fail_prev;
+
+static uint8_t param_page[256];
+
+static bool ecc_pmecc;
+static uint8_t pm_ecc[4][7];
+
+static uint64_t max_u64(uint64_t a, uint64_t b)
+{
+	return a > b ? a : b;
+}
+
+static void put_le(uint8_t *p, uint32_t value, int size)
+{
+	int i;
+
+	for (i = 0; i < size; i++)
+		p[i] = value >> (8 * i);
+}
+
+/* reset the array and detect it with or without cache program */
+static void sim_reset(bool cache)
+{
+	int i;
+
+	memset(param_page, 0, sizeof(param_page));
+	memcpy(param_page, "ONFI", 4);
+	put_le(&param_page[8], cache ? ONFI_OPT_CMD_CACHE_PROGRAM : 0, 2);
+	param_page[64] = 0x98;
+	put_le(&param_page[80], PAGE, 4);
+	put_le(&param_page[84], SPARE, 2);
+	put_le(&param_page[92], PPB, 4);
+	put_le(&param_page[96], NBLK, 4);
+	param_page[100] = 1;
+	param_page[112] = 4;
+	REQUIRE(nand_onfi_device_detect(&nand));
+
+	memset(flash, 0xff, sizeof(flash));
+	memset(nprog, 0, sizeof(nprog));
+	for (i = 0; i < NBLK; i++) {
+		last_prog_page[i] = -1;
+		erase_fail[i] = false;
+		prog_fail_page[i] = -1;
+	}
+	violations = 0;
+	now = array_until = rdy_until = 0;
+	fail_last = fail_prev = false;
+	mode = IDLE;
+	n_prog = n_cache = n_erase = n_reset = 0;
+	ecc_pmecc = true;
+}
+
+static void factory_bad(int block)
+{
+	flash[block * PPB][PAGE] = 0x00;
+}
+
+static bool marked_bad(int block)
+{
+	return flash[block * PPB][PAGE] != 0xff ||
+		flash[block * PPB + 1][PAGE] != 0xff;
+}
+
+static void decode_addr(bool has_col, bool has_row)
+{
+	int i = 0, k;
+
+	if (has_col) {
+		col = addr[0] | (addr[1] << 8);
+		i = 2;
+	}
+	if (has_row) {
+		row = 0;
+		for (k = 0; i < naddr; i++, k++)
+			row |= addr[i] << (8 * k);
+		REQUIRE(row < NPAGES);
+	}
+}
+
+static void start_program(bool cache)
+{
+	uint64_t start = max_u64(now, array_until);
+	int block = row / PPB, page = row % PPB;
+	bool fail = prog_fail_page[block] == page;
+	int i;
+
+	for (i = 0; i < PAGE && reg[i] == 0xff; i++);
+	if (i < PAGE) {
+		if (nprog[row]++)
+			violations++;
+		if (page <= last_prog_page[block])
+			violations++;
+		last_prog_page[block] = page;
+	}
+	for (i = 0; i < PAGE + SPARE; i++)
+		flash[row][i] &= reg[i];
+	if (fail)
+		memset(flash[row], 0x5a, 16);
+	fail_prev = fail_last;
+	fail_last = fail;
+	if (cache) {
+		rdy_until = start + T_CBSY;
+		array_until = rdy_until + T_PROG;
+		n_cache++;
+	} else {
+		array_until = rdy_until = start + T_PROG;
+		n_prog++;
+	}
+	mode = IDLE;
+}
+
+static void start_erase(void)
+{
+	uint64_t start = max_u64(now, array_until);
+	int block;
+
+	decode_addr(false, true);
+	block = row / PPB;
+	fail_prev = fail_last;
+	fail_last = erase_fail[block];
+	if (!fail_last) {
+		memset(flash[block * PPB], 0xff, PPB * sizeof(flash[0]));
+		memset(&nprog[block * PPB], 0, PPB);
+		last_prog_page[block] = -1;
+	}
+	array_until = rdy_until = start + T_BERS;
+	mode = IDLE;
+	n_erase++;
+}
+
+void nand_write_command(const struct _nand_flash *nand, uint8_t c)
+{
+	now += T_CYCLE;
+	switch (c) {
+	case NAND_CMD_RESET:
+		array_until = rdy_until = now + T_RST;
+		fail_last = fail_prev = false;
+		mode = IDLE;
+		n_reset++;
+		break;
+	case NAND_CMD_STATUS:
+		mode = STATUS;
+		break;
+	case NAND_CMD_READ_1:
+		if (mode == STATUS && (cmd == NAND_CMD_READ_2 ||
+				cmd == NAND_CMD_READ_PARAM_PAGE)) {
+			/* back to data output after a status read */
+			mode = DOUT;
+			break;
+		}
+		naddr = 0;
+		mode = ADDR;
+		break;
+	case NAND_CMD_READ_2:
+		REQUIRE(cmd == NAND_CMD_READ_1 && mode == ADDR);
+		decode_addr(true, true);
+		now = max_u64(now, array_until);
+		memcpy(reg, flash[row], sizeof(reg));
+		array_until = rdy_until = now + T_R;
+		mode = DOUT;
+		break;
+	case NAND_CMD_WRITE_1:
+		naddr = 0;
+		mode = ADDR;
+		memset(reg, 0xff, sizeof(reg));
+		break;
+	case NAND_CMD_RANDOM_IN:
+		REQUIRE(cmd == NAND_CMD_WRITE_1);
+		naddr = 0;
+		mode = ADDR;
+		break;
+	case NAND_CMD_WRITE_2:
+	case NAND_CMD_WRITE_CACHE:
+		REQUIRE(cmd == NAND_CMD_WRITE_1 || cmd == NAND_CMD_RANDOM_IN);
+		REQUIRE(now >= rdy_until);
+		start_program(c == NAND_CMD_WRITE_CACHE);
+		break;
+	case NAND_CMD_READID:
+	case NAND_CMD_READ_PARAM_PAGE:
+	case NAND_CMD_ERASE_1:
+		naddr = 0;
+		mode = ADDR;
+		break;
+	case NAND_CMD_ERASE_2:
+		REQUIRE(cmd == NAND_CMD_ERASE_1);
+		start_erase();
+		break;
+	default:
+		REQUIRE(false);
+	}
+	if (mode != STATUS)
+		cmd = c;
+}
+
+void nand_write_command16(const struct _nand_flash *nand, uint16_t c)
+{
+	nand_write_command(nand, c);
+}
+
+void nand_write_address(const struct _nand_flash *nand, uint8_t a)
+{
+	REQUIRE(mode == ADDR && naddr < 8);
+	now += T_CYCLE;
+	addr[naddr++] = a;
+	if (cmd == NAND_CMD_READID) {
+		static const uint8_t id[] = { 0x98, 0xf1, 0x80, 0x15 };
+
+		memset(reg, 0, sizeof(reg));
+		memcpy(reg, a == 0x20 ? param_page : id, 4);
+		col = 0;
+		mode = DOUT;
+	} else if (cmd == NAND_CMD_READ_PARAM_PAGE) {
+		memset(reg, 0, sizeof(reg));
+		memcpy(reg, param_page, sizeof(param_page));
+		col = 0;
+		rdy_until = array_until = max_u64(now, array_until) + T_R;
+		mode = DOUT;
+	}
+}
+
+void nand_write_address16(const struct _nand_flash *nand, uint16_t a)
+{
+	nand_write_address(nand, a);
+}
+
+static void data_in(const uint8_t *src, uint32_t size)
+{
+	if (mode == ADDR) {
+		if (cmd == NAND_CMD_RANDOM_IN) {
+			decode_addr(true, false);
+			cmd = NAND_CMD_WRITE_1;
+		} else {
+			REQUIRE(cmd == NAND_CMD_WRITE_1);
+			decode_addr(true, true);
+		}
+		mode = DIN;
+	}
+	REQUIRE(mode == DIN && col + size <= sizeof(reg));
+	memcpy(reg + col, src, size);
+	col += size;
+	now += (uint64_t)size * T_CYCLE;
+}
+
+static void data_out(uint8_t *dst, uint32_t size)
+{
+	REQUIRE(mode == DOUT && col + size <= sizeof(reg));
+	memcpy(dst, reg + col, size);
+	col += size;
+	now += (uint64_t)size * T_CYCLE;
+}
+
+void nand_write_data(const struct _nand_flash *nand, uint8_t d)
+{
+	data_in(&d, 1);
+}
+
+void nand_write_data16(const struct _nand_flash *nand, uint16_t d)
+{
+	/* 8-bit device */
+	REQUIRE(false);
+}
+
+uint8_t nand_read_data(const struct _nand_flash *nand)
+{
+	uint8_t d;
+
+	now += T_CYCLE;
+	if (mode == STATUS) {
+		if (now < rdy_until) {
+			/* busy: the next poll sees the end of the operation */
+			now = rdy_until;
+			return 0x80;
+		}
+		d = 0x80 | NAND_STATUS_RDY;
+		if (now >= array_until)
+			d |= NAND_STATUS_ARDY;
+		if (fail_last)
+			d |= NAND_STATUS_FAIL;
+		if (fail_prev)
+			d |= NAND_STATUS_FAILC;
+		return d;
+	}
+	data_out(&d, 1);
+	return d;
+}
+
+uint16_t nand_read_data16(const struct _nand_flash *nand)
+{
+	return nand_read_data(nand);
+}
+
+uint8_t nand_dma_write(uint32_t src, uint32_t dst, uint32_t size)
+{
+	data_in((const uint8_t*)(uintptr_t)src, size);
+	return 0;
+}
+
+uint8_t nand_dma_read(uint32_t src, uint32_t dst, uint32_t size)
+{
+	data_out((uint8_t*)(uintptr_t)dst, size);
+	return 0;
+}
+
+/* PMECC with a simple checksum of each sector of the transferred page */
+
+void pmecc_reset(void)
+{
+	memset(pm_ecc, 0, sizeof(pm_ecc));
+}
+
+void pmecc_wait_ready(void)
+{
+	int s, i;
+
+	for (s = 0; s < 4; s++)
+		for (i = 0; i < 512; i++)
+			pm_ecc[s][i % 7] ^= reg[s * 512 + i] + i;
+	now += T_PMECC;
+}
+
+uint8_t pmecc_value(uint32_t sector_index, uint32_t byte_index)
+{
+	return pm_ecc[sector_index][byte_index];
+}
+
+uint32_t pmecc_get_sectors_per_page(void)
+{
+	return 4;
+}
+
+uint32_t pmecc_get_ecc_bytes_per_page(void)
+{
+	return ECC_BYTES;
+}
+
+uint32_t pmecc_get_ecc_start_address(void)
+{
+	return ECC_START;
+}
+
+uint32_t pmecc_get_ecc_end_address(void)
+{
+	return ECC_START + ECC_BYTES;
+}
+
+void pmecc_enable_write(void) {}
+void pmecc_enable_read(void) {}
+void pmecc_start_data_phase(void) {}
+void pmecc_disable(void) {}
+void pmecc_auto_enable(void) {}
+void pmecc_auto_disable(void) {}
+
+bool pmecc_auto_spare_en(void)
+{
+	return false;
+}
+
+uint32_t pmecc_error_status(void)
+{
+	return 0;
+}
+
+uint32_t pmecc_correction(uint32_t pmecc_status, uint32_t page_buffer)
+{
+	return 0;
+}
+
+/*----------------------------------------------------------------------------
+ *        Simulated applet environment
+ *----------------------------------------------------------------------------*/
+
+#define BUFFER_SIZE (4 * PPB * PAGE)
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+/* applet buffer, addressable by the 32-bit DMA and mailbox fields */
+static uint8_t buffer_mem[BUFFER_SIZE] __attribute__((aligned(32)));
+
+uint8_t *applet_buffer = buffer_mem;
+uint32_t applet_buffer_size = BUFFER_SIZE;
+
+bool nand_is_dma_enabled(void)
+{
+	return true;
+}
+
+bool nand_is_using_pmecc(void)
+{
+	return ecc_pmecc;
+}
+
+bool nand_is_using_software_ecc(void)
+{
+	return false;
+}
+
+bool nand_is_using_hsiao_ecc(void)
+{
+	return false;
+}
+
+bool nand_is_using_no_ecc(void)
+{
+	return !ecc_pmecc;
+}
+
+uint8_t nand_ecc_write_page(const struct _nand_flash *nand, uint16_t block,
+		uint16_t page, void *data, void *spare)
+{
+	return nand_raw_write_page(nand, block, page, data, spare);
+}
+
+uint8_t nand_ecc_read_page(const struct _nand_flash *nand, uint16_t block,
+		uint16_t page, void *data, void *spare)
+{
+	return nand_raw_read_page(nand, block, page, data, spare);
+}
+
+/* used by the other commands of the applet only */
+
+const struct nandflash_pin_definition nandflash_pin_defs[1];
+const int num_nandflash_pin_defs = 0;
+
+bool applet_set_init_params(union initialize_mailbox* mbx)
+{
+	return false;
+}
+
+void board_cfg_matrix_for_nand(void) {}
+void smc_nand_configure(uint8_t bus_width) {}
+void pio_configure(const struct _pin *pins, uint32_t size) {}
+void nand_set_ecc_type(uint8_t ecc_type) {}
+void nand_set_dma_enabled(bool enabled) {}
+
+uint8_t nand_initialize(struct _nand_flash *nand)
+{
+	return 0;
+}
+
+uint8_t pmecc_initialize(uint8_t sector_size, uint8_t ecc_errors_per_sector,
+		uint32_t page_data_size, uint32_t page_spare_size,
+		uint16_t ecc_offset_in_spare, uint8_t spare_protected)
+{
+	return 1;
+}
+
+uint32_t applet_handle_cmd_init_slots(uint32_t cmd, uint32_t *mailbox)
+{
+	return APPLET_FAIL;
+}
+
+uint32_t applet_handle_cmd_run_slots(uint32_t cmd, uint32_t *mailbox)
+{
+	return APPLET_FAIL;
+}
+
+uint32_t applet_handle_cmd_hash_pages(uint32_t cmd, uint32_t *mailbox)
+{
+	return APPLET_FAIL;
+}
+
+uint32_t applet_handle_cmd_update_pages(uint32_t cmd, uint32_t *mailbox)
+{
+	return APPLET_FAIL;
+}
+
+uint32_t applet_handle_cmd_write_stream(uint32_t cmd, uint32_t *mailbox)
+{
+	return APPLET_FAIL;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint8_t image[NPAGES * PAGE];
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static void make_image(uint32_t pages)
+{
+	uint32_t i;
+
+	for (i = 0; i < pages * PAGE; i++)
+		image[i] = rnd();
+}
+
+static void expected_ecc(const uint8_t *data, uint8_t *ecc)
+{
+	int s, i;
+
+	memset(ecc, 0, ECC_BYTES);
+	for (s = 0; s < 4; s++)
+		for (i = 0; i < 512; i++)
+			ecc[s * 7 + i % 7] ^= data[s * 512 + i] + i;
+}
+
+static uint32_t call(uint32_t flags, uint32_t offset, uint32_t length,
+		uint32_t limit, union program_blocks_mailbox *mbx)
+{
+	mbx->in.flags = flags;
+	mbx->in.offset = offset;
+	mbx->in.length = length;
+	mbx->in.limit = limit;
+	return handle_cmd_program_blocks(APPLET_CMD_PROGRAM_BLOCKS,
+			(uint32_t*)mbx);
+}
+
+/* program the first 'pages' pages of the image in chunks of 'chunk' pages */
+static uint32_t program_image(uint32_t flags, uint32_t first, uint32_t limit,
+		uint32_t pages, uint32_t chunk, union program_blocks_mailbox *mbx)
+{
+	uint32_t done = 0, count, status;
+
+	flags |= APPLET_PROGRAM_START;
+	do {
+		count = min_u32(pages - done, chunk);
+		if (done + count == pages)
+			flags |= APPLET_PROGRAM_END;
+		memcpy(buffer, image + done * PAGE, count * PAGE);
+		status = call(flags, first, count, limit, mbx);
+		if (status != APPLET_SUCCESS)
+			return status;
+		CHECK(mbx->out.pages == count);
+		flags &= ~APPLET_PROGRAM_START;
+		done += count;
+	} while (done < pages);
+	return status;
+}
+
+/* check the array against the image through the block map in the buffer */
+static void verify(const union program_blocks_mailbox *mbx, uint32_t pages,
+		const uint32_t *blocks, uint32_t count)
+{
+	const uint32_t *map = (const uint32_t*)buffer;
+	uint8_t ecc[ECC_BYTES];
+	uint32_t i, p, phys, bad_map = 0, bad_data = 0, bad_ecc = 0, dirty = 0;
+
+	CHECK(mbx->out.map_count == count);
+	for (i = 0; i < count && i < mbx->out.map_count; i++)
+		if (map[i] != blocks[i] * PPB)
+			bad_map++;
+	CHECK(bad_map == 0);
+
+	for (p = 0; p < pages; p++) {
+		phys = blocks[p / PPB] * PPB + p % PPB;
+		if (memcmp(flash[phys], image + p * PAGE, PAGE) ||
+		    flash[phys][PAGE] != 0xff)
+			bad_data++;
+		if (ecc_pmecc) {
+			expected_ecc(image + p * PAGE, ecc);
+			if (memcmp(&flash[phys][PAGE + ECC_START], ecc,
+					ECC_BYTES))
+				bad_ecc++;
+		}
+	}
+	CHECK(bad_data == 0);
+	CHECK(bad_ecc == 0);
+
+	/* the end of the last block stays erased */
+	if (pages % PPB) {
+		phys = blocks[(pages - 1) / PPB] * PPB;
+		for (p = pages % PPB; p < PPB; p++)
+			for (i = 0; i < PAGE + SPARE; i++)
+				if (flash[phys + p][i] != 0xff)
+					dirty++;
+	}
+	CHECK(dirty == 0);
+	CHECK(violations == 0);
+}
+
+/* 'write pages' path: erase, then one skip block page write per page */
+static void write_pages_image(uint32_t first, uint32_t pages)
+{
+	uint32_t b, p, errors = 0;
+
+	for (b = 0; b < (pages + PPB - 1) / PPB; b++)
+		nand_skipblock_erase_block(&nand, first + b, NORMAL_ERASE);
+	for (p = 0; p < pages; p++) {
+		memcpy(buffer, image + p * PAGE, PAGE);
+		if (nand_skipblock_write_page(&nand, first + p / PPB, p % PPB,
+					buffer, NULL))
+			errors++;
+	}
+	CHECK(errors == 0);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+/* partition 4-39 with factory bad blocks 5, 6 and 20, a program failure in
+ * block 9 and an erase failure in block 12 */
+static void test_skip(bool cache, bool pmecc, uint32_t chunk)
+{
+	static const uint32_t blocks[] = { 4, 7, 8, 10, 11, 13, 14, 15, 16, 17,
+		18, 19, 21, 22, 23, 24, 25, 26, 27, 28, 29 };
+	union program_blocks_mailbox mbx;
+	uint32_t pages = 20 * PPB + 10;
+
+	sim_reset(cache);
+	ecc_pmecc = pmecc;
+	factory_bad(5);
+	factory_bad(6);
+	factory_bad(20);
+	prog_fail_page[9] = 17;
+	erase_fail[12] = true;
+	/* programmed pages in blocks to be erased */
+	memset(flash[4 * PPB], 0x00, 100);
+	memset(flash[29 * PPB + 30], 0x00, 100);
+	make_image(pages);
+
+	CHECK(program_image(0, 4 * PPB, 40 * PPB, pages, chunk, &mbx) ==
+			APPLET_SUCCESS);
+	CHECK(mbx.out.blocks == 21);
+	CHECK(mbx.out.skipped == 5);
+	CHECK(mbx.out.next == 30 * PPB);
+	verify(&mbx, pages, blocks, ARRAY_SIZE(blocks));
+	CHECK(marked_bad(9) && marked_bad(12));
+	CHECK(!marked_bad(30));
+	if (cache) {
+		/* a reset before retiring each of blocks 9 and 12 */
+		CHECK(n_cache > 0 && n_reset == 2);
+	} else {
+		CHECK(n_cache == 0);
+	}
+}
+
+static void test_strict(void)
+{
+	static const uint32_t blocks[] = { 4 };
+	union program_blocks_mailbox mbx;
+
+	/* factory bad block */
+	sim_reset(true);
+	factory_bad(5);
+	make_image(4 * PPB);
+	CHECK(program_image(APPLET_PROGRAM_STRICT, 4 * PPB, 0, 4 * PPB,
+				4 * PPB, &mbx) == APPLET_BAD_BLOCK);
+	CHECK(mbx.out.blocks == 1);
+	verify(&mbx, PPB, blocks, 1);
+
+	/* the error closed the sequence */
+	CHECK(call(0, 0, PPB, 0, &mbx) == APPLET_FAIL);
+
+	/* program failure on the last page */
+	sim_reset(true);
+	prog_fail_page[2] = PPB - 1;
+	make_image(2 * PPB);
+	CHECK(program_image(APPLET_PROGRAM_STRICT, PPB, 0, 2 * PPB, 2 * PPB,
+				&mbx) == APPLET_BAD_BLOCK);
+	CHECK(mbx.out.blocks == 1 && mbx.out.map_count == 1);
+	CHECK(marked_bad(2));
+}
+
+static void test_errors(void)
+{
+	union program_blocks_mailbox mbx;
+
+	sim_reset(true);
+	CHECK(call(APPLET_PROGRAM_START, 3, PPB, 0, &mbx) ==
+			APPLET_ALIGN_ERROR);
+	CHECK(call(APPLET_PROGRAM_START, 0, PPB, 100, &mbx) ==
+			APPLET_ALIGN_ERROR);
+	CHECK(call(APPLET_PROGRAM_START, 8 * PPB, PPB, 8 * PPB, &mbx) ==
+			APPLET_FAIL);
+	CHECK(call(APPLET_PROGRAM_START, 0, PPB, (NBLK + 1) * PPB, &mbx) ==
+			APPLET_FAIL);
+	CHECK(n_erase == 0);
+
+	/* partial block without END */
+	CHECK(call(APPLET_PROGRAM_START, 0, 10, 0, &mbx) ==
+			APPLET_ALIGN_ERROR);
+	CHECK(mbx.out.pages == 0 && mbx.out.map_count == 0);
+	CHECK(call(0, 0, PPB, 0, &mbx) == APPLET_FAIL);
+
+	CHECK(call(APPLET_PROGRAM_START, 0, BUFFER_SIZE / PAGE + 1, 0, &mbx) ==
+			APPLET_FAIL);
+	CHECK(n_erase == 0);
+
+	/* partition of 3 blocks, one bad, for 3 blocks of data */
+	factory_bad(1);
+	make_image(3 * PPB);
+	CHECK(program_image(0, 0, 3 * PPB, 3 * PPB, 3 * PPB, &mbx) ==
+			APPLET_BAD_BLOCK);
+	CHECK(mbx.out.pages == 2 * PPB && mbx.out.map_count == 2);
+	CHECK(mbx.out.skipped == 1 && mbx.out.next == 3 * PPB);
+
+	/* an empty END closes the sequence and returns the map */
+	sim_reset(true);
+	make_image(PPB);
+	memcpy(buffer, image, PPB * PAGE);
+	CHECK(call(APPLET_PROGRAM_START, 0, PPB, 0, &mbx) == APPLET_SUCCESS);
+	CHECK(mbx.out.map_count == 0);
+	CHECK(call(APPLET_PROGRAM_END, 0, 0, 0, &mbx) == APPLET_SUCCESS);
+	CHECK(mbx.out.pages == 0 && mbx.out.map_count == 1);
+	CHECK(call(0, 0, PPB, 0, &mbx) == APPLET_FAIL);
+}
+
+static void test_timing(bool print)
+{
+	union program_blocks_mailbox mbx;
+	uint32_t pages = 16 * PPB;
+	double t_cache, t_page, t_write;
+
+	make_image(pages);
+
+	sim_reset(true);
+	CHECK(program_image(0, 0, 0, pages, 4 * PPB, &mbx) == APPLET_SUCCESS);
+	CHECK(n_cache + n_prog == pages && n_prog == 16);
+	t_cache = now;
+
+	sim_reset(true);
+	CHECK(program_image(APPLET_PROGRAM_NO_CACHE, 0, 0, pages, 4 * PPB,
+				&mbx) == APPLET_SUCCESS);
+	CHECK(n_cache == 0 && n_prog == pages);
+	t_page = now;
+
+	sim_reset(true);
+	write_pages_image(0, pages);
+	t_write = now;
+
+	CHECK(t_cache < t_page);
+	CHECK(t_page < t_write);
+	if (print)
+		printf("16 blocks with PMECC: cache program %.2f MB/s, "
+		       "page program %.2f MB/s, write pages %.2f MB/s\n",
+		       pages * PAGE * 1e3 / t_cache,
+		       pages * PAGE * 1e3 / t_page,
+		       pages * PAGE * 1e3 / t_write);
+}
+
+int main(int argc, char* argv[])
+{
+	buffer = applet_buffer;
+	buffer_size = applet_buffer_size;
+	page_size = PAGE;
+	block_size = PPB;
+	nand.model.page_size_in_bytes = PAGE;
+	nand.model.spare_size_in_bytes = SPARE;
+	nand.model.device_size_in_mega_bytes = NBLK * PPB * PAGE >> 20;
+	nand.model.block_size_in_kbytes = PPB * PAGE >> 10;
+	nand.model.scheme = &nand_spare_scheme2048;
+
+	test_skip(false, false, 4 * PPB);
+	test_skip(false, true, 4 * PPB);
+	test_skip(true, false, 4 * PPB);
+	test_skip(true, true, 4 * PPB);
+	test_skip(false, true, PPB);
+	test_skip(true, true, PPB);
+	test_skip(true, true, 2 * PPB);
+	test_strict();
+	test_errors();
+	test_timing(argc > 1 && strcmp(argv[1], "-b") == 0);
+	return host_test_end("nand_program");
+}
@@ -0,0 +1,230 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of pio_pin_group_compile() and of the pio_pin_group_to_port()/
+ * pio_pin_group_from_port() mappings used by the PIO3 and PIO4 drivers.
+ * Random pin layouts over the PIO groups are compiled, then random values
+ * are mapped to the pins and back, and compared with the bit by bit
+ * definition: bit i of a value drives pins[i].
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "gpio/pio.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static uint32_t rnd32(void)
+{
+	return rnd() ^ (rnd() << 16);
+}
+
+static void set_pin(struct _pin* pin, uint8_t group, int bit)
+{
+	memset(pin, 0, sizeof(*pin));
+	pin->group = group;
+	pin->mask = 1u << bit;
+	pin->type = PIO_OUTPUT_0;
+}
+
+/* Map a value to the pins and back through the compiled pin group */
+static void check_mapping(const struct _pio_pin_group* pg, const struct _pin* pins, int size)
+{
+	uint32_t levels[PIO_GROUP_LENGTH];
+	uint32_t value, read;
+	int i, k;
+
+	for (k = 0; k < 20; k++) {
+		value = rnd32();
+		if (size < 32)
+			value &= (1u << size) - 1;
+
+		memset(levels, 0, sizeof(levels));
+		for (i = 0; i < pg->ports; i++) {
+			const struct _pio_pin_group_port* port = &pg->port[i];
+
+			levels[port->group] = pio_pin_group_to_port(port, value);
+			CHECK((levels[port->group] & ~port->mask) == 0);
+		}
+		for (i = 0; i < size; i++)
+			CHECK(!!(levels[pins[i].group] & pins[i].mask) == !!(value & (1u << i)));
+
+		/* the levels of the other pins must not leak into the value */
+		read = 0;
+		for (i = 0; i < pg->ports; i++) {
+			const struct _pio_pin_group_port* port = &pg->port[i];
+
+			read |= pio_pin_group_from_port(port,
+					levels[port->group] | (rnd32() & ~port->mask));
+		}
+		CHECK(read == value);
+	}
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_random(void)
+{
+	struct _pio_pin_group pg;
+	struct _pin pins[32];
+	int iter, compiled = 0;
+
+	for (iter = 0; iter < 20000; iter++) {
+		uint32_t used[PIO_GROUP_LENGTH] = { 0 };
+		int size = 1 + rnd() % 32;
+		int groups = iter % 3 ? 2 : PIO_GROUP_LENGTH;
+		int i, err;
+
+		for (i = 0; i < size; i++) {
+			int group, bit;
+
+			do {
+				group = rnd() % groups;
+				/* mostly contiguous pins one time out of four */
+				bit = iter % 4 == 0 ? (i + group * 3) % 32 : rnd() % 32;
+			} while (used[group] & (1u << bit));
+			used[group] |= 1u << bit;
+			set_pin(&pins[i], group, bit);
+		}
+
+		err = pio_pin_group_compile(&pg, pins, size);
+		if (err == -E2BIG)
+			continue;
+		CHECK(err == 0);
+		if (err)
+			continue;
+		compiled++;
+		CHECK(pg.width == size);
+		for (i = 0; i < pg.ports; i++) {
+			CHECK(pg.port[i].mask == used[pg.port[i].group]);
+			CHECK(pg.port[i].runs <= PIO_PIN_GROUP_MAX_RUNS);
+		}
+		check_mapping(&pg, pins, size);
+	}
+	CHECK(compiled > 10000);
+}
+
+static void test_layouts(void)
+{
+	struct _pio_pin_group pg;
+	struct _pin pins[32];
+	int i;
+
+	/* contiguous byte: a single shift */
+	for (i = 0; i < 8; i++)
+		set_pin(&pins[i], PIO_GROUP_C, i + 4);
+	CHECK(pio_pin_group_compile(&pg, pins, 8) == 0);
+	CHECK(pg.ports == 1 && pg.port[0].group == PIO_GROUP_C);
+	CHECK(pg.port[0].runs == 1 && pg.port[0].mask == 0xff0);
+	CHECK(pg.port[0].run[0].shift == 4 && pg.port[0].run[0].mask == 0xff);
+	check_mapping(&pg, pins, 8);
+
+	/* two contiguous halves on different PIO groups */
+	for (i = 0; i < 16; i++)
+		set_pin(&pins[i], i < 8 ? PIO_GROUP_A : PIO_GROUP_D, i < 8 ? 24 + i : i - 8);
+	CHECK(pio_pin_group_compile(&pg, pins, 16) == 0);
+	CHECK(pg.ports == 2 && pg.port[0].runs == 1 && pg.port[1].runs == 1);
+	CHECK(pg.port[0].run[0].shift == 24 && pg.port[1].run[0].shift == -8);
+	check_mapping(&pg, pins, 16);
+
+	/* full 32-bit port */
+	for (i = 0; i < 32; i++)
+		set_pin(&pins[i], PIO_GROUP_E, i);
+	CHECK(pio_pin_group_compile(&pg, pins, 32) == 0);
+	CHECK(pg.port[0].runs == 1 && pg.port[0].mask == 0xffffffff);
+	check_mapping(&pg, pins, 32);
+
+	/* reversed bits: one shift per pin */
+	for (i = 0; i < PIO_PIN_GROUP_MAX_RUNS; i++)
+		set_pin(&pins[i], PIO_GROUP_B, PIO_PIN_GROUP_MAX_RUNS - 1 - i);
+	CHECK(pio_pin_group_compile(&pg, pins, PIO_PIN_GROUP_MAX_RUNS) == 0);
+	CHECK(pg.port[0].runs == PIO_PIN_GROUP_MAX_RUNS);
+	check_mapping(&pg, pins, PIO_PIN_GROUP_MAX_RUNS);
+	for (i = 0; i <= PIO_PIN_GROUP_MAX_RUNS; i++)
+		set_pin(&pins[i], PIO_GROUP_B, PIO_PIN_GROUP_MAX_RUNS - i);
+	CHECK(pio_pin_group_compile(&pg, pins, PIO_PIN_GROUP_MAX_RUNS + 1) == -E2BIG);
+}
+
+static void test_invalid(void)
+{
+	struct _pio_pin_group pg;
+	struct _pin pins[33];
+	int i;
+
+	for (i = 0; i < 33; i++)
+		set_pin(&pins[i], i / 32, i % 32);
+
+	CHECK(pio_pin_group_compile(&pg, pins, 0) == -EINVAL);
+	CHECK(pio_pin_group_compile(&pg, pins, 33) == -EINVAL);
+	CHECK(pio_pin_group_compile(&pg, pins, 32) == 0);
+
+	/* several pins in one entry */
+	pins[3].mask = 3u << 20;
+	CHECK(pio_pin_group_compile(&pg, pins, 8) == -EINVAL);
+	/* no pin */
+	pins[3].mask = 0;
+	CHECK(pio_pin_group_compile(&pg, pins, 8) == -EINVAL);
+	/* same pin twice */
+	pins[3].mask = 1u << 4;
+	CHECK(pio_pin_group_compile(&pg, pins, 8) == -EINVAL);
+	/* no such PIO group */
+	set_pin(&pins[3], PIO_GROUP_LENGTH, 3);
+	CHECK(pio_pin_group_compile(&pg, pins, 8) == -EINVAL);
+	set_pin(&pins[3], PIO_GROUP_A, 3);
+	CHECK(pio_pin_group_compile(&pg, pins, 8) == 0);
+}
+
+int main(void)
+{
+	test_random();
+	test_layouts();
+	test_invalid();
+	return host_test_end("pio_pin_group");
+}
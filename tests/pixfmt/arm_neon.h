@@ -0,0 +1,283 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host stand-in for the NEON intrinsics used by lib/pixfmt, in plain C with
+ * the saturation and rounding of the instructions. The Makefile builds the
+ * library with __ARM_NEON defined to run its NEON paths on this file.
+ */
+
+#ifndef _ARM_NEON_H_
+#define _ARM_NEON_H_
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct { uint8_t v[8]; } uint8x8_t;
+typedef struct { uint16_t v[8]; } uint16x8_t;
+typedef struct { int16_t v[8]; } int16x8_t;
+typedef struct { uint8x8_t val[2]; } uint8x8x2_t;
+typedef struct { uint8x8_t val[4]; } uint8x8x4_t;
+
+static inline int16_t _neon_sat16(int32_t x)
+{
+	return x < INT16_MIN ? INT16_MIN : (x > INT16_MAX ? INT16_MAX : x);
+}
+
+/* loads and stores */
+
+static inline uint8x8_t vld1_u8(const uint8_t* p)
+{
+	uint8x8_t r;
+
+	memcpy(r.v, p, 8);
+	return r;
+}
+
+static inline void vst1_u8(uint8_t* p, uint8x8_t a)
+{
+	memcpy(p, a.v, 8);
+}
+
+static inline void vst1q_u16(uint16_t* p, uint16x8_t a)
+{
+	memcpy(p, a.v, 16);
+}
+
+static inline uint8x8x2_t vld2_u8(const uint8_t* p)
+{
+	uint8x8x2_t r;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		r.val[0].v[i] = p[2 * i];
+		r.val[1].v[i] = p[2 * i + 1];
+	}
+	return r;
+}
+
+static inline void vst2_u8(uint8_t* p, uint8x8x2_t a)
+{
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		p[2 * i] = a.val[0].v[i];
+		p[2 * i + 1] = a.val[1].v[i];
+	}
+}
+
+static inline uint8x8x4_t vld4_u8(const uint8_t* p)
+{
+	uint8x8x4_t r;
+	int i, j;
+
+	for (i = 0; i < 8; i++)
+		for (j = 0; j < 4; j++)
+			r.val[j].v[i] = p[4 * i + j];
+	return r;
+}
+
+static inline void vst4_u8(uint8_t* p, uint8x8x4_t a)
+{
+	int i, j;
+
+	for (i = 0; i < 8; i++)
+		for (j = 0; j < 4; j++)
+			p[4 * i + j] = a.val[j].v[i];
+}
+
+/* arithmetic */
+
+static inline uint8x8_t vdup_n_u8(uint8_t x)
+{
+	uint8x8_t r;
+
+	memset(r.v, x, 8);
+	return r;
+}
+
+static inline int16x8_t vdupq_n_s16(int16_t x)
+{
+	int16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = x;
+	return r;
+}
+
+static inline uint8x8_t vrhadd_u8(uint8x8_t a, uint8x8_t b)
+{
+	uint8x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = (uint8_t)((a.v[i] + b.v[i] + 1) >> 1);
+	return r;
+}
+
+static inline uint16x8_t vmull_u8(uint8x8_t a, uint8x8_t b)
+{
+	uint16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = (uint16_t)(a.v[i] * b.v[i]);
+	return r;
+}
+
+static inline uint16x8_t vsubl_u8(uint8x8_t a, uint8x8_t b)
+{
+	uint16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = (uint16_t)(a.v[i] - b.v[i]);
+	return r;
+}
+
+static inline uint16x8_t vshrq_n_u16(uint16x8_t a, int n)
+{
+	uint16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = a.v[i] >> n;
+	return r;
+}
+
+static inline int16x8_t vreinterpretq_s16_u16(uint16x8_t a)
+{
+	int16x8_t r;
+
+	memcpy(r.v, a.v, 16);
+	return r;
+}
+
+static inline int16x8_t vsubq_s16(int16x8_t a, int16x8_t b)
+{
+	int16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = (int16_t)(a.v[i] - b.v[i]);
+	return r;
+}
+
+static inline int16x8_t vqaddq_s16(int16x8_t a, int16x8_t b)
+{
+	int16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = _neon_sat16(a.v[i] + b.v[i]);
+	return r;
+}
+
+static inline int16x8_t vqsubq_s16(int16x8_t a, int16x8_t b)
+{
+	int16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = _neon_sat16(a.v[i] - b.v[i]);
+	return r;
+}
+
+static inline int16x8_t vmulq_n_s16(int16x8_t a, int16_t b)
+{
+	int16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = (int16_t)(a.v[i] * b);
+	return r;
+}
+
+static inline int16x8_t vmlaq_n_s16(int16x8_t c, int16x8_t a, int16_t b)
+{
+	int16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = (int16_t)(c.v[i] + a.v[i] * b);
+	return r;
+}
+
+/* rounding shift right, saturated to unsigned 8 bits */
+static inline uint8x8_t vqrshrun_n_s16(int16x8_t a, int n)
+{
+	uint8x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		int32_t x = (a.v[i] + (1 << (n - 1))) >> n;
+
+		r.v[i] = x < 0 ? 0 : (x > 255 ? 255 : (uint8_t)x);
+	}
+	return r;
+}
+
+/* permutations and bit fields */
+
+static inline uint8x8x2_t vzip_u8(uint8x8_t a, uint8x8_t b)
+{
+	uint8x8x2_t r;
+	int i;
+
+	for (i = 0; i < 8; i++) {
+		r.val[i / 4].v[(2 * i) % 8] = a.v[i];
+		r.val[i / 4].v[(2 * i) % 8 + 1] = b.v[i];
+	}
+	return r;
+}
+
+static inline uint16x8_t vshll_n_u8(uint8x8_t a, int n)
+{
+	uint16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = (uint16_t)(a.v[i] << n);
+	return r;
+}
+
+/* shift b right by n and insert it in a, keeping the n top bits of a */
+static inline uint16x8_t vsriq_n_u16(uint16x8_t a, uint16x8_t b, int n)
+{
+	uint16_t mask = (uint16_t)(0xffff >> n);
+	uint16x8_t r;
+	int i;
+
+	for (i = 0; i < 8; i++)
+		r.v[i] = (a.v[i] & ~mask) | ((b.v[i] >> n) & mask);
+	return r;
+}
+
+#endif /* _ARM_NEON_H_ */
@@ -0,0 +1,729 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the pixel format kernels against golden references:
+ *
+ * - YUYV to RGB within one LSB of the exact BT.601 conversion, RGB565
+ *   being the truncation of ARGB8888;
+ * - planar and semiplanar layouts against a direct model, and the round
+ *   trips through them;
+ * - the demosaic against a bilinear interpolation with mirrored borders,
+ *   for the four patterns, and on gradients;
+ * - the scalers against exact pixel center mapping and a floating point
+ *   bilinear interpolation.
+ *
+ * Widths cover the NEON blocks (16 pixels) and their tails, and the bytes
+ * around each output row are checked to be left alone.
+ *
+ * The outputs are also written to a file with -o, or compared with such a
+ * file with -c: the Makefile uses this to check that the portable and the
+ * NEON variants give the same results. With -b, the kernels are timed at
+ * VGA. Build without sanitizers for meaningful numbers:
+ *
+ *   make clean check SANITIZE= CFLAGS=-O2 ARGS=-b
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "pixfmt/yuv.h"
+#include "pixfmt/bayer.h"
+#include "pixfmt/scale.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+#ifdef __ARM_NEON
+#define TEST_NAME "pixfmt (neon)"
+#else
+#define TEST_NAME "pixfmt"
+#endif
+
+#define MAX_W 660
+#define MAX_H 480
+#define GUARD 0xa5
+
+static uint8_t src[4 * MAX_W * MAX_H] __attribute__((aligned(8)));
+static uint8_t dst[4 * MAX_W * MAX_H + 64] __attribute__((aligned(8)));
+static uint8_t out[4 * MAX_W * MAX_H + 64] __attribute__((aligned(8)));
+static uint8_t plane_y[MAX_W * MAX_H];
+static uint8_t plane_u[MAX_W * MAX_H];
+static uint8_t plane_v[MAX_W * MAX_H];
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static FILE* out_file;
+static FILE* cmp_file;
+static unsigned cmp_mismatches;
+
+/* Write the output of a kernel with -o, compare it with -c */
+static void record(const void* data, size_t size)
+{
+	static uint8_t ref[4 * MAX_W * MAX_H];
+
+	if (out_file)
+		fwrite(data, 1, size, out_file);
+	if (cmp_file) {
+		if (size > sizeof(ref) || fread(ref, 1, size, cmp_file) != size ||
+		    memcmp(ref, data, size) != 0)
+			cmp_mismatches++;
+	}
+}
+
+/* rows of size bytes with stride apart: nothing written in between */
+static bool guard_intact(const uint8_t* p, uint32_t stride, uint32_t size,
+		uint32_t rows)
+{
+	uint32_t row, i;
+
+	for (row = 0; row < rows; row++)
+		for (i = size; i < stride; i++)
+			if (p[row * stride + i] != GUARD)
+				return false;
+	return p[rows * stride] == GUARD;
+}
+
+static int clamp(double v)
+{
+	v = floor(v + 0.5);
+	return v < 0 ? 0 : (v > 255 ? 255 : (int)v);
+}
+
+/* sum and number of the signed errors of the unclamped video range
+ * conversions */
+static double bias_sum;
+static unsigned bias_count;
+
+/* exact BT.601 video range conversion */
+static void bt601(int y, int u, int v, int* rgb, const int* got)
+{
+	double l = 1.164383 * (y - 16);
+	double e[3];
+	int i;
+
+	e[0] = l + 1.596027 * (v - 128);
+	e[1] = l - 0.391762 * (u - 128) - 0.812968 * (v - 128);
+	e[2] = l + 2.017232 * (u - 128);
+	for (i = 0; i < 3; i++) {
+		rgb[i] = clamp(e[i]);
+		if (e[i] > 0.5 && e[i] < 254.5) {
+			bias_sum += got[i] - e[i];
+			bias_count++;
+		}
+	}
+}
+
+static void unpack8888(uint32_t p, int* rgb)
+{
+	rgb[0] = (p >> 16) & 0xff;
+	rgb[1] = (p >> 8) & 0xff;
+	rgb[2] = p & 0xff;
+}
+
+static int max_diff(const int* a, const int* b)
+{
+	int i, m = 0;
+
+	for (i = 0; i < 3; i++)
+		if (abs(a[i] - b[i]) > m)
+			m = abs(a[i] - b[i]);
+	return m;
+}
+
+static void fill_yuyv(uint32_t stride, uint32_t height, bool video_range)
+{
+	uint32_t x, y;
+
+	for (y = 0; y < height; y++)
+		for (x = 0; x < stride; x++) {
+			uint8_t* p = &src[y * stride + x];
+
+			if (!video_range)
+				*p = rnd();
+			else if (x & 1)
+				*p = 16 + rnd() % 225;
+			else
+				*p = 16 + rnd() % 220;
+		}
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void check_rgb(uint32_t width, uint32_t height, bool video_range)
+{
+	uint32_t stride = 2 * width + 2 * (rnd() % 8);
+	uint32_t stride32 = 4 * width + 4 * (rnd() % 4);
+	uint32_t stride16 = 2 * width + 2 * (rnd() % 4);
+	uint32_t x, y;
+	int err = 0;
+
+	fill_yuyv(stride, height, video_range);
+	memset(dst, GUARD, sizeof(dst));
+	CHECK(pixfmt_yuyv_to_rgb(src, stride, dst, stride32, width, height,
+			PIXFMT_ARGB8888) == 0);
+	CHECK(guard_intact(dst, stride32, 4 * width, height));
+	memset(out, GUARD, sizeof(out));
+	CHECK(pixfmt_yuyv_to_rgb(src, stride, out, stride16, width, height,
+			PIXFMT_RGB565) == 0);
+	CHECK(guard_intact(out, stride16, 2 * width, height));
+
+	for (y = 0; y < height; y++) {
+		const uint32_t* argb = (const uint32_t*)(dst + y * stride32);
+		const uint16_t* rgb565 = (const uint16_t*)(out + y * stride16);
+
+		for (x = 0; x < width; x++) {
+			const uint8_t* m = &src[y * stride + (x / 2) * 4];
+			int ref[3], got[3], d;
+
+			unpack8888(argb[x], got);
+			bt601(m[(x & 1) * 2], m[1], m[3], ref, got);
+			d = max_diff(ref, got);
+			if (d > err)
+				err = d;
+			CHECK((argb[x] >> 24) == 0xff);
+			CHECK(rgb565[x] == pixfmt_pack565(got[0], got[1], got[2]));
+		}
+		record(argb, 4 * width);
+		record(rgb565, 2 * width);
+	}
+	CHECK(err <= 1);
+}
+
+static void test_yuyv_to_rgb(void)
+{
+	static const uint32_t widths[] = { 2, 14, 16, 18, 30, 32, 34, 48, 62, 646 };
+	unsigned i;
+	int rgb[3];
+
+	for (i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+		check_rgb(widths[i], 7, true);
+		/* outside the video range: clamped */
+		check_rgb(widths[i], 5, false);
+	}
+	check_rgb(646, 480, true);
+	/* the coefficient rounding errors mostly cancel out */
+	CHECK(bias_count > 500000);
+	CHECK(fabs(bias_sum / bias_count) < 0.08);
+
+	/* black, white and the primaries */
+	src[0] = 16; src[1] = 128; src[2] = 235; src[3] = 128;
+	src[4] = 81; src[5] = 90; src[6] = 81; src[7] = 240;
+	src[8] = 145; src[9] = 54; src[10] = 145; src[11] = 34;
+	src[12] = 41; src[13] = 240; src[14] = 41; src[15] = 110;
+	CHECK(pixfmt_yuyv_to_rgb(src, 16, dst, 32, 8, 1, PIXFMT_ARGB8888) == 0);
+	unpack8888(((uint32_t*)dst)[0], rgb);
+	CHECK(rgb[0] == 0 && rgb[1] == 0 && rgb[2] == 0);
+	unpack8888(((uint32_t*)dst)[1], rgb);
+	CHECK(rgb[0] == 255 && rgb[1] == 255 && rgb[2] == 255);
+	unpack8888(((uint32_t*)dst)[2], rgb);
+	CHECK(rgb[0] >= 254 && rgb[1] <= 1 && rgb[2] <= 1);
+	unpack8888(((uint32_t*)dst)[4], rgb);
+	CHECK(rgb[0] <= 1 && rgb[1] >= 254 && rgb[2] <= 1);
+	unpack8888(((uint32_t*)dst)[6], rgb);
+	CHECK(rgb[0] <= 1 && rgb[1] <= 1 && rgb[2] >= 254);
+
+	CHECK(pixfmt_yuyv_to_rgb(src, 12, dst, 24, 0, 1, PIXFMT_ARGB8888) == -EINVAL);
+	CHECK(pixfmt_yuyv_to_rgb(src, 12, dst, 24, 3, 1, PIXFMT_ARGB8888) == -EINVAL);
+	CHECK(pixfmt_yuyv_to_rgb(src, 12, dst, 24, 2, 0, PIXFMT_ARGB8888) == -EINVAL);
+	CHECK(pixfmt_yuyv_to_rgb(src, 12, dst, 24, 2, 1,
+			(enum _pixfmt_rgb)2) == -EINVAL);
+}
+
+static void check_planar(uint32_t width, uint32_t height,
+		enum _pixfmt_chroma chroma)
+{
+	uint32_t stride = 2 * width + 2 * (rnd() % 8);
+	uint32_t y_stride = width + rnd() % 8;
+	uint32_t c_stride = width / 2 + rnd() % 8;
+	uint32_t uv_stride = width + 2 * (rnd() % 4);
+	uint32_t c_rows = chroma == PIXFMT_CHROMA_420 ? height / 2 : height;
+	uint32_t x, y;
+
+	fill_yuyv(stride, height, false);
+
+	/* planar */
+	memset(plane_y, GUARD, sizeof(plane_y));
+	memset(plane_u, GUARD, sizeof(plane_u));
+	memset(plane_v, GUARD, sizeof(plane_v));
+	CHECK(pixfmt_yuyv_to_planar(src, stride, plane_y, plane_u, plane_v,
+			y_stride, c_stride, width, height, chroma) == 0);
+	CHECK(guard_intact(plane_y, y_stride, width, height));
+	CHECK(guard_intact(plane_u, c_stride, width / 2, c_rows));
+	CHECK(guard_intact(plane_v, c_stride, width / 2, c_rows));
+	for (y = 0; y < height; y++) {
+		const uint8_t* s = &src[y * stride];
+		const uint8_t* s2 = chroma == PIXFMT_CHROMA_420 ? s + stride : s;
+		uint32_t c = chroma == PIXFMT_CHROMA_420 ? y / 2 : y;
+
+		for (x = 0; x < width; x++)
+			CHECK(plane_y[y * y_stride + x] == s[2 * x]);
+		if (chroma == PIXFMT_CHROMA_420 && (y & 1))
+			continue;
+		for (x = 0; x < width / 2; x++) {
+			CHECK(plane_u[c * c_stride + x] == ((s[4 * x + 1] + s2[4 * x + 1] + 1) >> 1));
+			CHECK(plane_v[c * c_stride + x] == ((s[4 * x + 3] + s2[4 * x + 3] + 1) >> 1));
+		}
+		record(plane_u + c * c_stride, width / 2);
+		record(plane_v + c * c_stride, width / 2);
+	}
+
+	/* back to YUYV: the chroma of the 4:2:0 rows pairs is the average */
+	memset(dst, GUARD, sizeof(dst));
+	CHECK(pixfmt_planar_to_yuyv(plane_y, plane_u, plane_v, y_stride, c_stride,
+			dst, stride, width, height, chroma) == 0);
+	CHECK(guard_intact(dst, stride, 2 * width, height));
+	for (y = 0; y < height; y++)
+		for (x = 0; x < 2 * width; x++) {
+			uint32_t y0 = y & ~1u;
+			int e = src[y * stride + x];
+
+			if (chroma == PIXFMT_CHROMA_420 && (x & 1))
+				e = (src[y0 * stride + x] + src[(y0 + 1) * stride + x] + 1) >> 1;
+			CHECK(dst[y * stride + x] == e);
+		}
+
+	/* semiplanar, through the same planes */
+	memset(plane_y, GUARD, sizeof(plane_y));
+	memset(plane_u, GUARD, sizeof(plane_u));
+	CHECK(pixfmt_yuyv_to_semiplanar(src, stride, plane_y, plane_u,
+			y_stride, uv_stride, width, height, chroma) == 0);
+	CHECK(guard_intact(plane_y, y_stride, width, height));
+	CHECK(guard_intact(plane_u, uv_stride, width, c_rows));
+	for (y = 0; y < c_rows; y++) {
+		const uint8_t* c = plane_u + y * uv_stride;
+
+		for (x = 0; x < width / 2; x++) {
+			CHECK(c[2 * x] == dst[(chroma == PIXFMT_CHROMA_420 ? 2 * y : y) * stride + 4 * x + 1]);
+			CHECK(c[2 * x + 1] == dst[(chroma == PIXFMT_CHROMA_420 ? 2 * y : y) * stride + 4 * x + 3]);
+		}
+		record(c, width);
+	}
+	memset(out, GUARD, sizeof(out));
+	CHECK(pixfmt_semiplanar_to_yuyv(plane_y, plane_u, y_stride, uv_stride,
+			out, stride, width, height, chroma) == 0);
+	CHECK(guard_intact(out, stride, 2 * width, height));
+	for (y = 0; y < height; y++)
+		CHECK(memcmp(out + y * stride, dst + y * stride, 2 * width) == 0);
+}
+
+static void test_planar(void)
+{
+	static const uint32_t widths[] = { 2, 14, 16, 18, 30, 32, 34, 48, 62, 646 };
+	unsigned i;
+
+	for (i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+		check_planar(widths[i], 6, PIXFMT_CHROMA_422);
+		check_planar(widths[i], 6, PIXFMT_CHROMA_420);
+	}
+	check_planar(646, 480, PIXFMT_CHROMA_420);
+
+	CHECK(pixfmt_yuyv_to_planar(src, 8, plane_y, plane_u, plane_v, 4, 2,
+			4, 3, PIXFMT_CHROMA_420) == -EINVAL);
+	CHECK(pixfmt_yuyv_to_planar(src, 8, plane_y, plane_u, plane_v, 4, 2,
+			4, 3, (enum _pixfmt_chroma)2) == -EINVAL);
+	CHECK(pixfmt_yuyv_to_semiplanar(src, 8, plane_y, plane_u, 4, 4,
+			5, 2, PIXFMT_CHROMA_422) == -EINVAL);
+	CHECK(pixfmt_planar_to_yuyv(plane_y, plane_u, plane_v, 4, 2, dst, 8,
+			4, 0, PIXFMT_CHROMA_422) == -EINVAL);
+	CHECK(pixfmt_semiplanar_to_yuyv(plane_y, plane_u, 4, 4, dst, 8,
+			0, 2, PIXFMT_CHROMA_420) == -EINVAL);
+}
+
+/* bilinear demosaic with mirrored borders, from the definition */
+static void ref_demosaic(const uint8_t* raw, uint32_t w, uint32_t h,
+		uint32_t pattern, uint32_t x, uint32_t y, int* rgb)
+{
+	int sum[3] = { 0, 0, 0 }, n[3] = { 0, 0, 0 };
+	int dx, dy, c;
+
+	for (dy = -1; dy <= 1; dy++)
+		for (dx = -1; dx <= 1; dx++) {
+			int sx = (int)x + dx, sy = (int)y + dy;
+			int site;
+
+			/* same parity, the pattern is kept */
+			sx = sx < 0 ? 1 : (sx >= (int)w ? (int)w - 2 : sx);
+			sy = sy < 0 ? 1 : (sy >= (int)h ? (int)h - 2 : sy);
+			site = (((sx ^ (pattern & 1)) & 1)) | (((sy ^ (pattern >> 1)) & 1) << 1);
+			c = site == 0 ? 0 : (site == 3 ? 2 : 1);
+			/* green: the 4 nearest only */
+			if (c == 1 && dx && dy)
+				continue;
+			sum[c] += raw[sy * w + sx];
+			n[c]++;
+		}
+	for (c = 0; c < 3; c++) {
+		/* the own sample only, if the pixel has the color */
+		if (n[c] == 0)
+			continue;
+		rgb[c] = (sum[c] + n[c] / 2) / n[c];
+	}
+	c = ((x ^ (pattern & 1)) & 1) | (((y ^ (pattern >> 1)) & 1) << 1);
+	c = c == 0 ? 0 : (c == 3 ? 2 : 1);
+	rgb[c] = raw[y * w + x];
+}
+
+static void check_bayer(uint32_t w, uint32_t h, uint32_t pattern)
+{
+	uint32_t stride32 = 4 * w + 4 * (rnd() % 4);
+	uint32_t stride16 = 2 * w + 2 * (rnd() % 4);
+	uint32_t x, y, i;
+
+	for (i = 0; i < w * h; i++)
+		src[i] = rnd();
+	memset(dst, GUARD, sizeof(dst));
+	CHECK(pixfmt_bayer_to_rgb(src, w, dst, stride32, w, h, pattern,
+			PIXFMT_ARGB8888) == 0);
+	CHECK(guard_intact(dst, stride32, 4 * w, h));
+	memset(out, GUARD, sizeof(out));
+	CHECK(pixfmt_bayer_to_rgb(src, w, out, stride16, w, h, pattern,
+			PIXFMT_RGB565) == 0);
+	CHECK(guard_intact(out, stride16, 2 * w, h));
+	for (y = 0; y < h; y++) {
+		const uint32_t* argb = (const uint32_t*)(dst + y * stride32);
+		const uint16_t* rgb565 = (const uint16_t*)(out + y * stride16);
+
+		for (x = 0; x < w; x++) {
+			int ref[3], got[3];
+
+			ref_demosaic(src, w, h, pattern, x, y, ref);
+			unpack8888(argb[x], got);
+			CHECK(max_diff(ref, got) == 0);
+			CHECK((argb[x] >> 24) == 0xff);
+			CHECK(rgb565[x] == pixfmt_pack565(got[0], got[1], got[2]));
+		}
+		record(argb, 4 * w);
+	}
+}
+
+static void test_bayer(void)
+{
+	static const uint32_t sizes[] = { 2, 3, 4, 5, 8, 17 };
+	uint32_t p, i, j, x, y;
+
+	for (p = 0; p < 4; p++) {
+		for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+			for (j = 0; j < sizeof(sizes) / sizeof(sizes[0]); j++)
+				check_bayer(sizes[i], sizes[j], p);
+		check_bayer(646, 40, p);
+	}
+
+	/* gradients are reconstructed inside the image */
+	for (p = 0; p < 4; p++) {
+		const uint32_t w = 646, h = 480;
+		int err = 0;
+
+		for (y = 0; y < h; y++)
+			for (x = 0; x < w; x++) {
+				int r = (x + y) / 5, g = (2 * x + y) / 8, b = 200 - x / 4;
+				uint32_t site = ((x ^ p) & 1) | (((y ^ (p >> 1)) & 1) << 1);
+
+				src[y * w + x] = site == 0 ? r : (site == 3 ? b : g);
+			}
+		CHECK(pixfmt_bayer_to_rgb(src, w, dst, 4 * w, w, h, p,
+				PIXFMT_ARGB8888) == 0);
+		for (y = 1; y < h - 1; y++)
+			for (x = 1; x < w - 1; x++) {
+				int ref[3] = { (int)(x + y) / 5, (int)(2 * x + y) / 8,
+						200 - (int)x / 4 };
+				int got[3], d;
+
+				unpack8888(((uint32_t*)dst)[y * w + x], got);
+				d = max_diff(ref, got);
+				if (d > err)
+					err = d;
+			}
+		CHECK(err <= 1);
+	}
+
+	CHECK(pixfmt_bayer_to_rgb(src, 4, dst, 16, 1, 2, PIXFMT_BAYER_RGGB,
+			PIXFMT_ARGB8888) == -EINVAL);
+	CHECK(pixfmt_bayer_to_rgb(src, 4, dst, 16, 2, 1, PIXFMT_BAYER_RGGB,
+			PIXFMT_ARGB8888) == -EINVAL);
+	CHECK(pixfmt_bayer_to_rgb(src, 4, dst, 16, 2, 2, (enum _pixfmt_bayer)4,
+			PIXFMT_ARGB8888) == -EINVAL);
+	CHECK(pixfmt_bayer_to_rgb(src, 4, dst, 16, 2, 2, PIXFMT_BAYER_RGGB,
+			(enum _pixfmt_rgb)2) == -EINVAL);
+}
+
+/* source pixel of the exact center mapping, in [0, size) */
+static uint32_t center(uint32_t i, uint32_t src_size, uint32_t dst_size)
+{
+	return (uint32_t)floor((i + 0.5) * src_size / dst_size);
+}
+
+static void check_nearest(uint32_t sw, uint32_t sh, uint32_t dw, uint32_t dh,
+		uint32_t bpp)
+{
+	uint32_t sstride = sw * bpp + bpp * (rnd() % 4);
+	uint32_t dstride = dw * bpp + bpp * (rnd() % 4);
+	bool exact = (sw % dw == 0 || dw % sw == 0) && (sh % dh == 0 || dh % sh == 0);
+	uint32_t x, y, i;
+
+	for (i = 0; i < sstride * sh; i++)
+		src[i] = rnd();
+	memset(dst, GUARD, sizeof(dst));
+	CHECK(pixfmt_scale_nearest(src, sstride, sw, sh, dst, dstride, dw, dh,
+			bpp) == 0);
+	CHECK(guard_intact(dst, dstride, dw * bpp, dh));
+	for (y = 0; y < dh; y++) {
+		const uint8_t* d = dst + y * dstride;
+
+		for (x = 0; x < dw; x++) {
+			uint32_t cx = center(x, sw, dw), cy = center(y, sh, dh);
+			bool found = false;
+			int ox, oy;
+
+			/* the fixed point position may fall on the pixel before */
+			for (oy = exact ? 0 : -1; oy <= 0; oy++)
+				for (ox = exact ? 0 : -1; ox <= 0; ox++) {
+					int sx = (int)cx + ox, sy = (int)cy + oy;
+
+					if (sx >= 0 && sy >= 0 && !memcmp(d + x * bpp,
+							src + sy * sstride + sx * bpp, bpp))
+						found = true;
+				}
+			CHECK(found);
+		}
+		record(d, dw * bpp);
+	}
+}
+
+static double ref_bilinear(const uint8_t* s, uint32_t stride, uint32_t sw,
+		uint32_t sh, uint32_t dw, uint32_t dh, uint32_t x, uint32_t y,
+		uint32_t channels, uint32_t c)
+{
+	double sx = (x + 0.5) * sw / dw - 0.5, sy = (y + 0.5) * sh / dh - 0.5;
+	uint32_t x0, y0, x1, y1;
+	double fx, fy;
+
+	sx = sx < 0 ? 0 : (sx > sw - 1 ? sw - 1 : sx);
+	sy = sy < 0 ? 0 : (sy > sh - 1 ? sh - 1 : sy);
+	x0 = (uint32_t)sx;
+	y0 = (uint32_t)sy;
+	x1 = x0 + 1 < sw ? x0 + 1 : x0;
+	y1 = y0 + 1 < sh ? y0 + 1 : y0;
+	fx = sx - x0;
+	fy = sy - y0;
+	return (s[y0 * stride + x0 * channels + c] * (1 - fx)
+		+ s[y0 * stride + x1 * channels + c] * fx) * (1 - fy)
+		+ (s[y1 * stride + x0 * channels + c] * (1 - fx)
+		+ s[y1 * stride + x1 * channels + c] * fx) * fy;
+}
+
+static void check_bilinear(uint32_t sw, uint32_t sh, uint32_t dw, uint32_t dh,
+		uint32_t channels)
+{
+	uint32_t sstride = sw * channels + rnd() % 4;
+	uint32_t dstride = dw * channels + rnd() % 4;
+	uint32_t x, y, c, i;
+	int err = 0;
+
+	for (i = 0; i < sstride * sh; i++)
+		src[i] = rnd();
+	memset(dst, GUARD, sizeof(dst));
+	CHECK(pixfmt_scale_bilinear(src, sstride, sw, sh, dst, dstride, dw, dh,
+			channels) == 0);
+	CHECK(guard_intact(dst, dstride, dw * channels, dh));
+	for (y = 0; y < dh; y++) {
+		for (x = 0; x < dw; x++)
+			for (c = 0; c < channels; c++) {
+				double v = ref_bilinear(src, sstride, sw, sh, dw, dh,
+						x, y, channels, c);
+				int d = abs(clamp(v) - dst[y * dstride + x * channels + c]);
+
+				if (d > err)
+					err = d;
+			}
+		record(dst + y * dstride, dw * channels);
+	}
+	/* 8-bit weights: up to one LSB per axis on random data */
+	CHECK(err <= 2);
+}
+
+static void test_scale(void)
+{
+	static const uint32_t sizes[][4] = {
+		{ 646, 480, 646, 480 }, { 640, 480, 320, 240 },
+		{ 640, 480, 160, 120 }, { 646, 480, 200, 133 },
+		{ 33, 17, 7, 5 }, { 7, 5, 33, 17 }, { 1, 1, 5, 3 },
+		{ 5, 3, 1, 1 }, { 320, 2, 640, 4 }, { 3, 300, 2, 200 },
+	};
+	uint32_t i, b, x, y;
+
+	for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+		for (b = 1; b <= 4; b *= 2)
+			check_nearest(sizes[i][0], sizes[i][1], sizes[i][2],
+					sizes[i][3], b);
+		for (b = 1; b <= 4; b++)
+			check_bilinear(sizes[i][0], sizes[i][1], sizes[i][2],
+					sizes[i][3], b);
+	}
+
+	/* identity */
+	for (i = 0; i < 646 * 480; i++)
+		src[i] = rnd();
+	CHECK(pixfmt_scale_nearest(src, 646, 646, 480, dst, 646, 646, 480, 1) == 0);
+	CHECK(memcmp(src, dst, 646 * 480) == 0);
+	CHECK(pixfmt_scale_bilinear(src, 646, 646, 480, dst, 646, 646, 480, 1) == 0);
+	CHECK(memcmp(src, dst, 646 * 480) == 0);
+
+	/* 2:1 bilinear is a 2x2 box filter */
+	CHECK(pixfmt_scale_bilinear(src, 646, 646, 480, dst, 323, 323, 240, 1) == 0);
+	for (y = 0; y < 240; y++)
+		for (x = 0; x < 323; x++) {
+			const uint8_t* s = &src[2 * y * 646 + 2 * x];
+			int sum = s[0] + s[1] + s[646] + s[647];
+
+			CHECK(abs((sum + 2) / 4 - dst[y * 323 + x]) <= 1);
+		}
+
+	/* YUYV macropixels */
+	fill_yuyv(2 * 646, 480, false);
+	CHECK(pixfmt_scale_nearest(src, 2 * 646, 323, 480, dst, 2 * 320, 160,
+			240, 4) == 0);
+	for (y = 0; y < 240; y++)
+		for (x = 0; x < 160; x++)
+			CHECK(!memcmp(dst + y * 640 + 4 * x,
+					src + center(y, 480, 240) * 1292 + 4 * center(x, 323, 160), 4));
+
+	CHECK(pixfmt_scale_nearest(src, 4, 0, 1, dst, 4, 1, 1, 1) == -EINVAL);
+	CHECK(pixfmt_scale_nearest(src, 4, 1, 1, dst, 4, 1, 0, 1) == -EINVAL);
+	CHECK(pixfmt_scale_nearest(src, 4, 1, 1, dst, 4, 1, 1, 3) == -EINVAL);
+	CHECK(pixfmt_scale_nearest(src, 4, PIXFMT_SCALE_MAX_SIZE + 1, 1, dst, 4,
+			1, 1, 1) == -EINVAL);
+	CHECK(pixfmt_scale_bilinear(src, 4, 1, 1, dst, 4, 1, 1, 0) == -EINVAL);
+	CHECK(pixfmt_scale_bilinear(src, 4, 1, 1, dst, 4, 1, 1, 5) == -EINVAL);
+	CHECK(pixfmt_scale_bilinear(src, 4, 1, 1, dst, 4,
+			PIXFMT_SCALE_MAX_SIZE + 1, 1, 1) == -EINVAL);
+}
+
+static void benchmark(void)
+{
+	const uint32_t w = 640, h = 480, n = 50;
+	double t;
+	uint32_t i;
+
+	t = now();
+	for (i = 0; i < n; i++)
+		pixfmt_yuyv_to_rgb(src, 2 * w, dst, 2 * w, w, h, PIXFMT_RGB565);
+	printf("YUYV to RGB565: %.1f MP/s\n", n * w * h / (now() - t) / 1e6);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		pixfmt_yuyv_to_rgb(src, 2 * w, dst, 4 * w, w, h, PIXFMT_ARGB8888);
+	printf("YUYV to ARGB8888: %.1f MP/s\n", n * w * h / (now() - t) / 1e6);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		pixfmt_yuyv_to_planar(src, 2 * w, plane_y, plane_u, plane_v, w,
+				w / 2, w, h, PIXFMT_CHROMA_420);
+	printf("YUYV to planar 4:2:0: %.1f MP/s\n", n * w * h / (now() - t) / 1e6);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		pixfmt_bayer_to_rgb(src, w, dst, 4 * w, w, h, PIXFMT_BAYER_RGGB,
+				PIXFMT_ARGB8888);
+	printf("demosaic to ARGB8888: %.1f MP/s\n", n * w * h / (now() - t) / 1e6);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		pixfmt_scale_bilinear(src, w, w, h, dst, w / 2, w / 2, h / 2, 1);
+	printf("bilinear 2:1: %.1f MP/s (output)\n",
+	       n * w * h / 4 / (now() - t) / 1e6);
+
+	t = now();
+	for (i = 0; i < n; i++)
+		pixfmt_scale_nearest(src, 4 * w, w / 2, h / 2, dst, 2 * w, w / 4,
+				h / 4, 4);
+	printf("nearest 2:1, 32 bits: %.1f MP/s (output)\n",
+	       n * w * h / 16 / (now() - t) / 1e6);
+}
+
+int main(int argc, char* argv[])
+{
+	bool bench = false;
+
+	if (argc > 2 && strcmp(argv[1], "-o") == 0) {
+		out_file = fopen(argv[2], "wb");
+		REQUIRE(out_file);
+	} else if (argc > 2 && strcmp(argv[1], "-c") == 0) {
+		cmp_file = fopen(argv[2], "rb");
+		REQUIRE(cmp_file);
+	}
+	if (argc > 1 && strcmp(argv[argc - 1], "-b") == 0)
+		bench = true;
+
+	test_yuyv_to_rgb();
+	test_planar();
+	test_bayer();
+	test_scale();
+	if (bench)
+		benchmark();
+
+	if (out_file)
+		fclose(out_file);
+	if (cmp_file) {
+		/* same outputs, and no more */
+		CHECK(cmp_mismatches == 0);
+		CHECK(fgetc(cmp_file) == EOF);
+		fclose(cmp_file);
+	}
+	return host_test_end(TEST_NAME);
+}
@@ -0,0 +1,380 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the PTPv2 slave. A simulated two-step master sends
+ * Announce, Sync and Follow_Up messages once per second and answers the
+ * Delay_Req messages of the slave. The local clock starts 3.2 s ahead and
+ * runs 50 ppm fast; each path has a 10 us delay with up to +/- 1 us of
+ * jitter. The test checks that the slave steps once, then locks its
+ * frequency and offset.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "apps/ptp.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated clocks
+ *----------------------------------------------------------------------------*/
+
+#define PATH_DELAY_NS 10000.0
+#define DRIFT         50e-6   /* local clock error */
+
+static struct {
+	double master_ns;       /* master (true) time */
+	double offset_ns;       /* local clock - master clock */
+	double adj;             /* frequency adjustment applied */
+	uint32_t seed;
+	double jitter_ns;       /* path delay jitter amplitude */
+} sim;
+
+static double jitter(void)
+{
+	/* Small LCG, identical on every host */
+	sim.seed = sim.seed * 1103515245u + 12345u;
+	return ((double)((sim.seed >> 8) & 0xffff) / 32767.5 - 1.0) * sim.jitter_ns;
+}
+
+static void to_ptp(double ns, struct _ptp_time* t)
+{
+	t->sec = (int64_t)floor(ns / 1e9);
+	t->nsec = (int32_t)(ns - (double)t->sec * 1e9);
+	if (t->nsec >= 1000000000) {
+		t->nsec -= 1000000000;
+		t->sec++;
+	}
+}
+
+static void advance(double ns)
+{
+	sim.master_ns += ns;
+	sim.offset_ns += ns * (DRIFT + sim.adj);
+}
+
+static void local_time(void* arg, struct _ptp_time* t)
+{
+	(void)arg;
+	to_ptp(sim.master_ns + sim.offset_ns, t);
+}
+
+static void adjust_time(void* arg, int64_t delta_ns)
+{
+	(void)arg;
+	sim.offset_ns += (double)delta_ns;
+}
+
+static int adjust_freq(void* arg, int32_t ppb)
+{
+	(void)arg;
+	sim.adj = ppb * 1e-9;
+	return 0;
+}
+
+static const struct _ptp_clock_ops clock_ops = {
+	.get_time = local_time,
+	.adjust_time = adjust_time,
+	.adjust_freq = adjust_freq,
+};
+
+static const uint8_t slave_id[8] = { 0x02, 0x11, 0x22, 0xff, 0xfe, 0x33, 0x44, 0x55 };
+static const struct _ptp_port_identity master_port = {
+	.clock_identity = { 0x02, 0xaa, 0xbb, 0xff, 0xfe, 0xcc, 0xdd, 0xee },
+	.port_number = 1,
+};
+
+static void send_announce(struct _ptp_slave* slave,
+		const struct _ptp_port_identity* source)
+{
+	struct _ptp_msg msg;
+	uint8_t buf[PTP_ANNOUNCE_LENGTH];
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = PTP_MSG_ANNOUNCE;
+	msg.length = PTP_ANNOUNCE_LENGTH;
+	msg.source = *source;
+	REQUIRE(ptp_msg_pack(&msg, buf, sizeof(buf)) == PTP_ANNOUNCE_LENGTH);
+	CHECK(!ptp_slave_rx(slave, buf, PTP_ANNOUNCE_LENGTH, NULL));
+}
+
+/* One Sync interval: Sync, Follow_Up, and the Delay_Req exchange when the
+ * slave asks for it. The interval lasts one second of master time. */
+static void sync_interval(struct _ptp_slave* slave, uint16_t seq)
+{
+	struct _ptp_msg msg, req;
+	struct _ptp_time t1, t2, t3;
+	uint8_t buf[64];
+	uint16_t len;
+	double start = sim.master_ns;
+	bool delay_req;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.source = master_port;
+	msg.sequence_id = seq;
+
+	/* Two-step Sync, then its origin time in the Follow_Up. The
+	 * correction field carries 1.5 ns of residence time. */
+	to_ptp(sim.master_ns, &t1);
+	msg.type = PTP_MSG_SYNC;
+	msg.length = PTP_SYNC_LENGTH;
+	msg.flags = PTP_FLAG_TWO_STEP;
+	msg.correction = 3 << 15;
+	REQUIRE(ptp_msg_pack(&msg, buf, sizeof(buf)) == PTP_SYNC_LENGTH);
+	advance(PATH_DELAY_NS + jitter());
+	local_time(NULL, &t2);
+	CHECK(!ptp_slave_rx(slave, buf, PTP_SYNC_LENGTH, &t2));
+
+	msg.type = PTP_MSG_FOLLOW_UP;
+	msg.flags = 0;
+	msg.correction = 0;
+	msg.timestamp = t1;
+	ptp_time_add(&msg.timestamp, -1);
+	REQUIRE(ptp_msg_pack(&msg, buf, sizeof(buf)) == PTP_FOLLOW_UP_LENGTH);
+	delay_req = ptp_slave_rx(slave, buf, PTP_FOLLOW_UP_LENGTH, NULL);
+
+	if (delay_req) {
+		len = ptp_slave_pack_delay_req(slave, buf, sizeof(buf));
+		REQUIRE(len == PTP_DELAY_REQ_LENGTH);
+		REQUIRE(ptp_msg_unpack(buf, len, &req) == 0);
+		CHECK(req.type == PTP_MSG_DELAY_REQ);
+		CHECK(memcmp(req.source.clock_identity, slave_id, 8) == 0);
+		local_time(NULL, &t3);
+		ptp_slave_tx_timestamp(slave, &t3);
+		advance(PATH_DELAY_NS + jitter());
+
+		memset(&msg, 0, sizeof(msg));
+		msg.type = PTP_MSG_DELAY_RESP;
+		msg.length = PTP_DELAY_RESP_LENGTH;
+		msg.source = master_port;
+		msg.sequence_id = req.sequence_id;
+		msg.requesting = req.source;
+		to_ptp(sim.master_ns, &msg.timestamp);
+		REQUIRE(ptp_msg_pack(&msg, buf, sizeof(buf)) == PTP_DELAY_RESP_LENGTH);
+		CHECK(!ptp_slave_rx(slave, buf, PTP_DELAY_RESP_LENGTH, NULL));
+	}
+
+	advance(1e9 - (sim.master_ns - start));
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_time(void)
+{
+	struct _ptp_time a = { 10, 999999999 }, b = { 11, 1 };
+
+	CHECK(ptp_time_diff(&b, &a) == 2);
+	CHECK(ptp_time_diff(&a, &b) == -2);
+	ptp_time_add(&a, 2);
+	CHECK(a.sec == 11 && a.nsec == 1);
+	ptp_time_add(&a, -3);
+	CHECK(a.sec == 10 && a.nsec == 999999998);
+	ptp_time_add(&a, -2500000000ll);
+	CHECK(a.sec == 8 && a.nsec == 499999998);
+	ptp_time_add(&a, 1500000002ll);
+	CHECK(a.sec == 10 && a.nsec == 0);
+}
+
+static void test_messages(void)
+{
+	static const struct {
+		uint8_t type;
+		uint16_t length;
+	} types[] = {
+		{ PTP_MSG_SYNC, PTP_SYNC_LENGTH },
+		{ PTP_MSG_DELAY_REQ, PTP_DELAY_REQ_LENGTH },
+		{ PTP_MSG_FOLLOW_UP, PTP_FOLLOW_UP_LENGTH },
+		{ PTP_MSG_DELAY_RESP, PTP_DELAY_RESP_LENGTH },
+		{ PTP_MSG_ANNOUNCE, PTP_ANNOUNCE_LENGTH },
+	};
+	struct _ptp_msg msg, out;
+	uint8_t buf[PTP_ANNOUNCE_LENGTH];
+	unsigned i;
+
+	for (i = 0; i < sizeof(types) / sizeof(types[0]); i++) {
+		memset(&msg, 0, sizeof(msg));
+		msg.type = types[i].type;
+		msg.length = types[i].length;
+		msg.domain = 4;
+		msg.flags = PTP_FLAG_TWO_STEP;
+		msg.correction = -123456789012ll;
+		msg.source = master_port;
+		msg.sequence_id = 0xbeef;
+		msg.log_interval = -3;
+		msg.timestamp.sec = 0x123456789aull;
+		msg.timestamp.nsec = 999999999;
+		if (msg.type == PTP_MSG_DELAY_RESP)
+			memcpy(msg.requesting.clock_identity, slave_id, 8);
+
+		REQUIRE(ptp_msg_pack(&msg, buf, sizeof(buf)) == types[i].length);
+		CHECK(buf[1] == 2);
+		REQUIRE(ptp_msg_unpack(buf, types[i].length, &out) == 0);
+		CHECK(out.type == msg.type && out.length == msg.length);
+		CHECK(out.domain == 4 && out.flags == msg.flags);
+		CHECK(out.correction == msg.correction);
+		CHECK(memcmp(&out.source.clock_identity,
+			     master_port.clock_identity, 8) == 0);
+		CHECK(out.source.port_number == 1);
+		CHECK(out.sequence_id == 0xbeef && out.log_interval == -3);
+		CHECK(out.timestamp.sec == msg.timestamp.sec);
+		CHECK(out.timestamp.nsec == msg.timestamp.nsec);
+		if (msg.type == PTP_MSG_DELAY_RESP)
+			CHECK(memcmp(out.requesting.clock_identity, slave_id, 8) == 0);
+
+		/* Truncated message */
+		CHECK(ptp_msg_unpack(buf, types[i].length - 1, &out) == -EINVAL);
+	}
+
+	/* Too small a buffer */
+	CHECK(ptp_msg_pack(&msg, buf, msg.length - 1) == 0);
+
+	/* PTPv1, invalid nanoseconds */
+	memset(&msg, 0, sizeof(msg));
+	msg.type = PTP_MSG_SYNC;
+	msg.length = PTP_SYNC_LENGTH;
+	REQUIRE(ptp_msg_pack(&msg, buf, sizeof(buf)) == PTP_SYNC_LENGTH);
+	buf[1] = 1;
+	CHECK(ptp_msg_unpack(buf, PTP_SYNC_LENGTH, &out) == -EINVAL);
+	buf[1] = 2;
+	buf[40] = 0xff;
+	CHECK(ptp_msg_unpack(buf, PTP_SYNC_LENGTH, &out) == -EINVAL);
+}
+
+static void test_servo(void)
+{
+	struct _ptp_servo servo;
+	int32_t ppb = 0;
+
+	ptp_servo_init(&servo, PTP_SERVO_KP, PTP_SERVO_KI, 1000, 1000000);
+	CHECK(ptp_servo_sample(&servo, 5000, 1.0, &ppb) == PTP_SERVO_STEP);
+
+	ptp_servo_init(&servo, PTP_SERVO_KP, PTP_SERVO_KI, 10000, 1000000);
+	CHECK(ptp_servo_sample(&servo, 500, 1.0, &ppb) == PTP_SERVO_LOCKED);
+	CHECK(ppb == -500);
+	CHECK(ptp_servo_sample(&servo, 2000, 1.0, &ppb) == PTP_SERVO_TRACKING);
+	CHECK(ppb == -2150);
+	/* Saturated: no integration */
+	CHECK(ptp_servo_sample(&servo, 900000, 1.0, &ppb) == PTP_SERVO_TRACKING);
+	CHECK(ppb == -10000);
+	CHECK(fabs(servo.drift - 0.3 * (500 + 2000)) < 1e-6);
+	CHECK(ptp_servo_sample(&servo, 2000000, 1.0, &ppb) == PTP_SERVO_STEP);
+}
+
+/* Run the slave for 120 s against the simulated master */
+static void run_slave(double jitter_ns, double max_offset_ns, double max_freq_err_ppb)
+{
+	struct _ptp_slave slave;
+	double worst = 0.0;
+	int32_t freq_min = INT32_MAX, freq_max = INT32_MIN;
+	int i;
+
+	memset(&sim, 0, sizeof(sim));
+	sim.master_ns = 1e12;
+	sim.offset_ns = 3.2e9;
+	sim.seed = 1;
+	sim.jitter_ns = jitter_ns;
+
+	ptp_slave_init(&slave, &clock_ops, NULL, slave_id, 0);
+
+	/* Nothing is done before the master is known */
+	sync_interval(&slave, 0);
+	CHECK(slave.stats.sync == 0 && slave.stats.dropped == 2);
+
+	send_announce(&slave, &master_port);
+	for (i = 1; i <= 120; i++) {
+		sync_interval(&slave, i);
+		if (i >= 30) {
+			if (fabs(sim.offset_ns) > worst)
+				worst = fabs(sim.offset_ns);
+			if (slave.stats.freq < freq_min)
+				freq_min = slave.stats.freq;
+			if (slave.stats.freq > freq_max)
+				freq_max = slave.stats.freq;
+		}
+	}
+
+	printf("jitter %4.0f ns: steps %u, worst offset %4.0f ns, "
+	       "freq %d to %d ppb, path delay %lld ns\n",
+	       jitter_ns, slave.stats.steps, worst, freq_min, freq_max,
+	       (long long)slave.stats.path_delay);
+
+	CHECK(slave.stats.steps == 1);
+	CHECK(slave.stats.sync == 120 && slave.stats.follow_up == 120);
+	CHECK(slave.stats.delay_resp == slave.stats.delay_req);
+	CHECK(slave.stats.delay_req > 0);
+	CHECK(worst < max_offset_ns);
+	CHECK(freq_min > -DRIFT * 1e9 - max_freq_err_ppb);
+	CHECK(freq_max < -DRIFT * 1e9 + max_freq_err_ppb);
+	CHECK(llabs(slave.stats.path_delay - (int64_t)PATH_DELAY_NS) < 500);
+	if (jitter_ns == 0.0)
+		CHECK(slave.servo.state == PTP_SERVO_LOCKED);
+
+	/* Messages from another master are dropped */
+	{
+		struct _ptp_port_identity other = master_port;
+		uint32_t dropped = slave.stats.dropped;
+		uint32_t sync = slave.stats.sync;
+		struct _ptp_time saved = { 0, 0 };
+		struct _ptp_msg msg;
+		uint8_t buf[PTP_SYNC_LENGTH];
+
+		other.port_number = 2;
+		send_announce(&slave, &other);
+		memset(&msg, 0, sizeof(msg));
+		msg.type = PTP_MSG_SYNC;
+		msg.length = PTP_SYNC_LENGTH;
+		msg.source = other;
+		REQUIRE(ptp_msg_pack(&msg, buf, sizeof(buf)) == PTP_SYNC_LENGTH);
+		CHECK(!ptp_slave_rx(&slave, buf, PTP_SYNC_LENGTH, &saved));
+		CHECK(slave.stats.sync == sync);
+		CHECK(slave.stats.dropped == dropped + 1);
+	}
+}
+
+int main(void)
+{
+	test_time();
+	test_messages();
+	test_servo();
+	run_slave(0.0, 50.0, 50.0);
+	run_slave(1000.0, 3000.0, 2500.0);
+	return host_test_end("ptp");
+}
@@ -0,0 +1,251 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the PWM waveform generators. The fixed-point sine and the
+ * rendered duties are compared with floating point references; SVPWM is
+ * checked through its line-to-line output, which must stay sinusoidal while
+ * the phases use the 15% extra headroom.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "peripherals/pwmc_wave.h"
+
+#include "host_test.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static double turn(uint32_t phase)
+{
+	return phase * (2 * M_PI / 4294967296.0);
+}
+
+/* Duty of a channel for a waveform value in -1..1 */
+static double duty(uint16_t period, double value)
+{
+	return period * (0.5 + 0.5 * value);
+}
+
+static void init_wave(struct _pwmc_wave* wave, uint8_t shape, uint8_t channels,
+		uint16_t period, uint16_t amplitude, uint32_t step, uint32_t spread)
+{
+	memset(wave, 0, sizeof(*wave));
+	wave->shape = shape;
+	wave->channels = channels;
+	wave->period = period;
+	wave->amplitude = amplitude;
+	wave->step = step;
+	wave->spread = spread;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_sin(void)
+{
+	uint64_t p;
+	double err, max_err = 0;
+
+	for (p = 0; p < (1ull << 32); p += 123457) {
+		err = fabs(pwmc_wave_sin(p) - 32767 * sin(turn(p)));
+		if (err > max_err)
+			max_err = err;
+		CHECK(pwmc_wave_sin(p + 0x80000000u) == -pwmc_wave_sin(p));
+	}
+	CHECK(max_err <= 3);
+
+	CHECK(pwmc_wave_sin(0) == 0);
+	CHECK(pwmc_wave_sin(0x40000000) == 32767);
+	CHECK(pwmc_wave_sin(0x80000000) == 0);
+	CHECK(pwmc_wave_sin(0xc0000000) == -32767);
+}
+
+static void test_phase_step(void)
+{
+	struct _pwmc_wave wave;
+	uint16_t frames[400];
+
+	/* 50 Hz at 20 kHz: one turn every 400 frames */
+	CHECK(pwmc_wave_phase_step(50000, 20000) == 4294967296ull / 400);
+	CHECK(pwmc_wave_phase_step(1, 1000) == 4294967296ull / 1000000);
+	CHECK(PWMC_WAVE_PHASE(1, 3) == 4294967296ull / 3);
+
+	init_wave(&wave, PWMC_WAVE_SINE, 1, 1000, PWMC_WAVE_Q15_ONE,
+			pwmc_wave_phase_step(50000, 20000), 0);
+	pwmc_wave_fill(&wave, frames, 400);
+	CHECK(wave.phase == (uint32_t)(400 * wave.step));
+	CHECK(wave.phase + 400 < 800);
+}
+
+static void test_sine(void)
+{
+	static const uint16_t amplitudes[] = { 32768, 16384, 1000 };
+	struct _pwmc_wave wave;
+	uint16_t frames[2 * 3 * 300], split[2 * 3 * 300];
+	unsigned a;
+	int i, c;
+
+	for (a = 0; a < sizeof(amplitudes) / sizeof(amplitudes[0]); a++) {
+		uint32_t step = pwmc_wave_phase_step(50000, 20000);
+
+		init_wave(&wave, PWMC_WAVE_SINE, 3, 2000, amplitudes[a], step,
+				PWMC_WAVE_PHASE(1, 3));
+		wave.phase = 0x12345678;
+		pwmc_wave_fill(&wave, frames, 600);
+
+		for (i = 0; i < 600; i++) {
+			for (c = 0; c < 3; c++) {
+				double th = turn(0x12345678 + i * step + c * PWMC_WAVE_PHASE(1, 3));
+				double ref = duty(2000, amplitudes[a] / 32768.0 * sin(th));
+
+				CHECK(fabs(frames[3 * i + c] - ref) <= 1);
+			}
+		}
+
+		/* consecutive fills are continuous */
+		wave.phase = 0x12345678;
+		pwmc_wave_fill(&wave, split, 1);
+		pwmc_wave_fill(&wave, split + 3, 299);
+		pwmc_wave_fill(&wave, split + 3 * 300, 300);
+		CHECK(memcmp(frames, split, sizeof(frames)) == 0);
+	}
+}
+
+static void test_svpwm(void)
+{
+	const uint16_t amplitude = (uint16_t)(32768 * 1.15);
+	const uint32_t step = pwmc_wave_phase_step(50000, 20000);
+	struct _pwmc_wave wave;
+	uint16_t frames[3 * 400];
+	int i, c, min = 0xffff, max = 0;
+	double err, max_err = 0;
+
+	init_wave(&wave, PWMC_WAVE_SVPWM, 3, 1000, amplitude, step, PWMC_WAVE_PHASE(1, 3));
+	pwmc_wave_fill(&wave, frames, 200);
+	pwmc_wave_fill(&wave, frames + 3 * 200, 200);
+
+	for (i = 0; i < 3 * 400; i++) {
+		if (frames[i] < min)
+			min = frames[i];
+		if (frames[i] > max)
+			max = frames[i];
+	}
+	/* full use of the period, without clamping */
+	CHECK(min > 0 && min < 10);
+	CHECK(max < 1000 && max > 990);
+
+	/* line-to-line output sinusoidal */
+	for (i = 0; i < 400; i++) {
+		for (c = 0; c < 3; c++) {
+			double th = turn(i * step);
+			double ref = 1000 * amplitude / 32768.0 * 0.5 *
+				(sin(th + c * 2 * M_PI / 3) - sin(th + ((c + 1) % 3) * 2 * M_PI / 3));
+
+			err = fabs(frames[3 * i + c] - frames[3 * i + (c + 1) % 3] - ref);
+			if (err > max_err)
+				max_err = err;
+		}
+	}
+	CHECK(max_err <= 1.5);
+
+	/* the same depth clamps a plain sine */
+	init_wave(&wave, PWMC_WAVE_SINE, 3, 1000, amplitude, step, PWMC_WAVE_PHASE(1, 3));
+	pwmc_wave_fill(&wave, frames, 400);
+	min = 0xffff;
+	max = 0;
+	for (i = 0; i < 3 * 400; i++) {
+		if (frames[i] < min)
+			min = frames[i];
+		if (frames[i] > max)
+			max = frames[i];
+	}
+	CHECK(min == 0 && max == 1000);
+}
+
+static void test_shapes(void)
+{
+	static const uint16_t ramp[] = { 0, 20, 40, 60, 80 };
+	static const uint16_t triangle[] = { 0, 25, 50, 75, 100, 75, 50, 25 };
+	struct _pwmc_wave wave;
+	uint16_t frames[8];
+	int i;
+
+	init_wave(&wave, PWMC_WAVE_RAMP, 1, 100, PWMC_WAVE_Q15_ONE, PWMC_WAVE_PHASE(1, 5), 0);
+	pwmc_wave_fill(&wave, frames, 5);
+	for (i = 0; i < 5; i++)
+		CHECK(frames[i] == ramp[i]);
+
+	init_wave(&wave, PWMC_WAVE_TRIANGLE, 1, 100, PWMC_WAVE_Q15_ONE, PWMC_WAVE_PHASE(1, 8), 0);
+	pwmc_wave_fill(&wave, frames, 8);
+	for (i = 0; i < 8; i++)
+		CHECK(frames[i] == triangle[i]);
+
+	/* channels spread by a quarter of a turn */
+	init_wave(&wave, PWMC_WAVE_TRIANGLE, 4, 100, PWMC_WAVE_Q15_ONE, 0, PWMC_WAVE_PHASE(1, 4));
+	pwmc_wave_fill(&wave, frames, 2);
+	for (i = 0; i < 4; i++) {
+		CHECK(frames[i] == triangle[2 * i]);
+		CHECK(frames[4 + i] == triangle[2 * i]);
+	}
+}
+
+static void test_interleave(void)
+{
+	static const uint16_t samples[4] = { 1, 2, 3, 4 };
+	static const uint16_t expected[12] = { 0, 0, 1, 0, 0, 2, 0, 0, 3, 0, 0, 4 };
+	uint16_t frames[13];
+
+	memset(frames, 0, sizeof(frames));
+	frames[12] = 0xffff;
+	pwmc_wave_interleave(frames, 3, 2, samples, 4);
+	CHECK(memcmp(frames, expected, sizeof(expected)) == 0);
+	CHECK(frames[12] == 0xffff);
+}
+
+int main(void)
+{
+	test_sin();
+	test_phase_step();
+	test_sine();
+	test_svpwm();
+	test_shapes();
+	test_interleave();
+	return host_test_end("pwmc_wave");
+}
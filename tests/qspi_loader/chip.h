@@ -0,0 +1,62 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host stand-in for the chip header: the QSPI instance type and the QSPI
+ * instruction frame values used by the qspiflash driver.
+ */
+
+#ifndef _CHIP_H_
+#define _CHIP_H_
+
+#include "compiler.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+	uint32_t dummy;
+} Qspi;
+
+#define ID_QSPI0 52
+
+#define QSPI_IFR_WIDTH_SINGLE_BIT_SPI (0x0u << 0)
+#define QSPI_IFR_WIDTH_DUAL_OUTPUT (0x1u << 0)
+#define QSPI_IFR_WIDTH_QUAD_OUTPUT (0x2u << 0)
+#define QSPI_IFR_WIDTH_DUAL_IO (0x3u << 0)
+#define QSPI_IFR_WIDTH_QUAD_IO (0x4u << 0)
+#define QSPI_IFR_WIDTH_DUAL_CMD (0x5u << 0)
+#define QSPI_IFR_WIDTH_QUAD_CMD (0x6u << 0)
+
+#define QSPI_IFR_TFRTYP_TRSFR_READ (0x0u << 12)
+#define QSPI_IFR_TFRTYP_TRSFR_READ_MEMORY (0x1u << 12)
+#define QSPI_IFR_TFRTYP_TRSFR_WRITE (0x2u << 12)
+#define QSPI_IFR_TFRTYP_TRSFR_WRITE_MEMORY (0x3u << 12)
+
+#endif /* _CHIP_H_ */
@@ -0,0 +1,546 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the QSPI flash loader. The loader and the qspiflash driver
+ * run against a simulated MX25L12835F-like SPI-NOR flash on a simulated
+ * clock: QSPI transfers at 66MHz, tPP 0.5ms, 64KB block erase 400ms, a
+ * 115200 bauds console and a host downloading at 2MB/s. The flash ignores
+ * and counts any command but status reads while it is busy, as a real
+ * device would.
+ *
+ * The host calls FlashInit, FlashErase and FlashWrite as C-SPY does, then
+ * FlashChecksum and FlashSignoff. The test checks the flash contents, the
+ * checksum against Crc16(), that --verify catches corrupted bytes
+ * (including in the last buffer), that a read error in FlashChecksum stops
+ * in FlashBreak(), and that writing runs within 10% of the time the flash
+ * needs for the erases and page programs. With -b, the simulated
+ * throughputs are printed.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "crc32.h"
+
+#include "host_test.h"
+
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* the loader, with its console output and CRC-32 on the simulated clock */
+#define printf console_printf
+#define crc32_update timed_crc32_update
+extern int console_printf(const char* format, ...);
+static uint32_t timed_crc32_update(uint32_t crc, const void* data,
+		uint32_t len);
+#include "qspi_flash_loader.c"
+#undef printf
+#undef crc32_update
+
+/*----------------------------------------------------------------------------
+ *        Simulated SPI-NOR flash
+ *----------------------------------------------------------------------------*/
+
+#define FLASH_SIZE (16 * 1024 * 1024)
+#define PAGE 256
+
+/* timings in ns */
+#define T_QSPI_CLK 15
+#define T_CMD_SETUP 1000
+#define T_PP 500000
+#define T_SE 40000000
+#define T_BE32 200000000
+#define T_BE64 400000000
+#define T_WRSR 1000000
+#define T_UART_CHAR 86806
+#define T_CRC32_BYTE 8
+#define T_CRC16_BYTE 60
+
+static uint64_t now;
+static uint8_t mem[FLASH_SIZE];
+static uint64_t busy_until;
+static uint64_t device_time;
+static bool wel;
+static uint8_t sr, cr;
+static unsigned violations;
+static unsigned n_pp, n_erase;
+static int64_t corrupt_addr;
+static bool fail_reads;
+
+static unsigned line_width(uint32_t width, int phase)
+{
+	/* phase: 0 instruction, 1 address/mode/dummy, 2 data */
+	switch (width) {
+	case QSPI_IFR_WIDTH_QUAD_OUTPUT:
+		return phase == 2 ? 4 : 1;
+	case QSPI_IFR_WIDTH_QUAD_IO:
+		return phase ? 4 : 1;
+	case QSPI_IFR_WIDTH_QUAD_CMD:
+		return 4;
+	case QSPI_IFR_WIDTH_DUAL_OUTPUT:
+		return phase == 2 ? 2 : 1;
+	case QSPI_IFR_WIDTH_DUAL_IO:
+		return phase ? 2 : 1;
+	case QSPI_IFR_WIDTH_DUAL_CMD:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+static bool is_busy(void)
+{
+	return now < busy_until;
+}
+
+static void start_busy(uint64_t duration)
+{
+	busy_until = now + duration;
+	device_time += duration;
+}
+
+void qspi_initialize(Qspi* qspi)
+{
+}
+
+uint32_t qspi_set_baudrate(Qspi* qspi, uint32_t baudrate)
+{
+	return baudrate;
+}
+
+bool qspi_perform_command(Qspi* qspi, const struct _qspi_cmd* cmd)
+{
+	static const uint8_t id[3] = { 0xc2, 0x20, 0x18 };
+	uint32_t width = cmd->ifr_width;
+	uint32_t len = cmd->enable.data ? cmd->buffer_len : 0;
+	uint32_t addr = cmd->address;
+	const uint8_t* tx = cmd->tx_buffer;
+	uint64_t cycles = 0;
+	uint32_t size, i, x;
+
+	if (cmd->enable.instruction)
+		cycles += 8 / line_width(width, 0);
+	if (cmd->enable.address)
+		cycles += cmd->enable.address * 8 / line_width(width, 1);
+	if (cmd->enable.mode)
+		cycles += cmd->num_mode_cycles;
+	if (cmd->enable.dummy)
+		cycles += cmd->num_dummy_cycles;
+	cycles += (uint64_t)len * 8 / line_width(width, 2);
+	now += T_CMD_SETUP + cycles * T_QSPI_CLK;
+
+	if (is_busy() && cmd->instruction != 0x05) {
+		violations++;
+		return true;
+	}
+
+	switch (cmd->instruction) {
+	case 0x9f: /* read ID */
+	case 0xaf:
+		memcpy(cmd->rx_buffer, id, min_u32(len, sizeof(id)));
+		break;
+	case 0x05: /* read status */
+		*(uint8_t*)cmd->rx_buffer = sr | (is_busy() ? 1 : 0) |
+			(wel ? 2 : 0);
+		break;
+	case 0x15: /* read configuration */
+		*(uint8_t*)cmd->rx_buffer = cr;
+		break;
+	case 0x06: /* write enable */
+		wel = true;
+		break;
+	case 0x01: /* write status/configuration */
+		REQUIRE(wel);
+		sr = tx[0] & 0xfc;
+		if (len > 1)
+			cr = tx[1];
+		wel = false;
+		start_busy(T_WRSR);
+		break;
+	case 0x02: /* page program, wrapping in the page */
+		REQUIRE(wel && len <= PAGE && addr < FLASH_SIZE);
+		for (i = 0; i < len; i++) {
+			x = (addr & ~(PAGE - 1)) | ((addr + i) & (PAGE - 1));
+			mem[x] &= tx[i];
+			if ((int64_t)x == corrupt_addr)
+				mem[x] ^= 0x10;
+		}
+		wel = false;
+		start_busy(T_PP);
+		n_pp++;
+		break;
+	case 0x20: /* erase 4KB, 32KB, 64KB */
+	case 0x52:
+	case 0xd8:
+		REQUIRE(wel);
+		size = cmd->instruction == 0x20 ? 4096 :
+			cmd->instruction == 0x52 ? 32768 : 65536;
+		memset(mem + (addr & ~(size - 1)), 0xff, size);
+		wel = false;
+		start_busy(size == 4096 ? T_SE :
+				size == 32768 ? T_BE32 : T_BE64);
+		n_erase++;
+		break;
+	case 0x03: /* reads: single, fast, 1-1-4 and 1-4-4 */
+	case 0x0b:
+	case 0x6b:
+	case 0xeb:
+		if (fail_reads && len)
+			return false;
+		REQUIRE(addr + len <= FLASH_SIZE);
+		if (cmd->rx_buffer)
+			memcpy(cmd->rx_buffer, mem + addr, len);
+		break;
+	default:
+		REQUIRE(false);
+	}
+	return true;
+}
+
+/*----------------------------------------------------------------------------
+ *        Simulated loader environment
+ *----------------------------------------------------------------------------*/
+
+uint32_t trace_level = TRACE_LEVEL_SILENT;
+
+static Qspi qspi0;
+
+const struct qspiflash_pin_definition qspiflash_pin_defs[] = {
+	{ .instance = 0, .ioset = 3, .addr = &qspi0, .num_pins = 0 },
+};
+
+const int num_qspiflash_pin_defs = 1;
+
+static bool console_echo;
+static char last_message[256];
+
+int console_printf(const char* format, ...)
+{
+	va_list ap;
+	int n;
+
+	va_start(ap, format);
+	n = vsnprintf(last_message, sizeof(last_message), format, ap);
+	va_end(ap);
+	now += (uint64_t)n * T_UART_CHAR;
+	if (console_echo)
+		fputs(last_message, stdout);
+	return n;
+}
+
+static uint32_t timed_crc32_update(uint32_t crc, const void* data,
+		uint32_t len)
+{
+	now += (uint64_t)len * T_CRC32_BYTE;
+	return crc32_update(crc, data, len);
+}
+
+void board_cfg_lowlevel(bool clocks, bool ddram, bool mmu) {}
+void board_cfg_console(uint32_t baudrate) {}
+void dma_initialize(bool polling) {}
+void matrix_remap_ram(void) {}
+void pio_configure(const struct _pin *pins, uint32_t size) {}
+void pio_reset_all_it(void) {}
+
+uint32_t pmc_get_peripheral_clock(uint32_t id)
+{
+	return 166000000;
+}
+
+/* 1 tick is 1 ms */
+
+uint64_t timer_get_tick(void)
+{
+	return now / 1000000;
+}
+
+uint64_t timer_get_us(void)
+{
+	return now / 1000;
+}
+
+void timer_start_timeout(struct _timeout* timeout, uint64_t count)
+{
+	timeout->start = timer_get_tick();
+	timeout->count = count;
+}
+
+uint8_t timer_timeout_reached(struct _timeout* timeout)
+{
+	return timer_get_tick() - timeout->start >= timeout->count;
+}
+
+const char* findOption(char* option, int withValue, int argc,
+		char const* argv[])
+{
+	int i;
+
+	for (i = 0; i < argc; i++)
+		if (strcmp(option, argv[i]) == 0)
+			return withValue ? (i + 1 < argc ? argv[i + 1] : 0) :
+				argv[i];
+	return 0;
+}
+
+/* framework2/flash_loader.c */
+uint16_t Crc16_helper(uint8_t const *p, uint32_t len, uint16_t sum)
+{
+	int i;
+
+	now += (uint64_t)len * T_CRC16_BYTE;
+	while (len--) {
+		uint8_t byte = *p++;
+
+		for (i = 0; i < 8; ++i) {
+			uint32_t osum = sum;
+
+			sum <<= 1;
+			if (byte & 0x80)
+				sum |= 1;
+			if (osum & 0x8000)
+				sum ^= 0x1021;
+			byte <<= 1;
+		}
+	}
+	return sum;
+}
+
+static jmp_buf flash_break;
+static bool flash_break_expected;
+
+void FlashBreak(void)
+{
+	REQUIRE(flash_break_expected);
+	longjmp(flash_break, 1);
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+#define BASE 0xd0000000u
+#define HOST_NS_PER_BYTE 500
+
+static uint8_t image[2 * 1024 * 1024];
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+static uint16_t crc16(const uint8_t* p, uint32_t len)
+{
+	uint8_t zero[2] = { 0, 0 };
+
+	return Crc16_helper(zero, 2, Crc16_helper(p, len, 0));
+}
+
+struct run {
+	uint32_t size;         /* image size */
+	uint32_t offset;       /* image offset in the flash */
+	uint32_t buf;          /* loader buffer size */
+	bool verify;
+	bool checksum;
+	int64_t corrupt;       /* flash address to corrupt, -1 for none */
+};
+
+/* loader call that failed */
+static const char* failed_call;
+
+/* load an image as C-SPY does, returns the first error */
+static uint32_t load(const struct run* r, double* kbps)
+{
+	char const* argv[] = { "--instance", "0", "--ioset", "3",
+		"--freq", "66", "--verify" };
+	uint32_t i, addr, block, end, count, sum;
+	uint32_t result = RESULT_OK;
+	uint64_t start, busy;
+
+	/* programmed, not erased */
+	memset(mem, 0xa5, sizeof(mem));
+	busy_until = device_time = 0;
+	wel = false;
+	sr = cr = 0;
+	violations = n_pp = n_erase = 0;
+	corrupt_addr = r->corrupt;
+	fail_reads = false;
+	failed_call = NULL;
+	now = 0;
+
+	/* with erased areas, left to the erase */
+	for (i = 0; i < r->size; i++)
+		image[i] = (i % 4096) < 512 ? 0xff : rnd();
+
+	REQUIRE(FlashInit((void*)(uintptr_t)BASE, r->size, BASE, 0,
+				r->verify ? 7 : 6, argv) == RESULT_OK);
+	start = now;
+
+	/* erase each 64KB block before writing it, buffer by buffer */
+	for (addr = r->offset; addr < r->offset + r->size &&
+			result == RESULT_OK; ) {
+		block = addr & ~0xffffu;
+		end = min_u32(block + 0x10000, r->offset + r->size);
+		result = FlashErase((void*)(uintptr_t)(BASE + block), 0x10000);
+		if (result != RESULT_OK)
+			failed_call = "FlashErase";
+		while (result == RESULT_OK && addr < end) {
+			count = min_u32(r->buf, end - addr);
+			now += (uint64_t)count * HOST_NS_PER_BYTE;
+			result = FlashWrite((void*)(uintptr_t)(BASE + block),
+					addr - block, count,
+					(char const*)image + addr - r->offset);
+			if (result != RESULT_OK)
+				failed_call = "FlashWrite";
+			addr += count;
+		}
+	}
+	if (result == RESULT_OK) {
+		result = FlashSignoff();
+		if (result != RESULT_OK)
+			failed_call = "FlashSignoff";
+	}
+	busy = now - start;
+
+	if (result == RESULT_OK && r->checksum) {
+		sum = FlashChecksum((void*)(uintptr_t)(BASE + r->offset),
+				r->size);
+		CHECK(sum == crc16(image, r->size));
+	}
+
+	if (r->corrupt < 0) {
+		CHECK(result == RESULT_OK);
+		CHECK(memcmp(mem + r->offset, image, r->size) == 0);
+	}
+	CHECK(violations == 0);
+	*kbps = r->size / 1024.0 / (busy * 1e-9);
+	return result;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_throughput(bool print)
+{
+	struct run r = { .size = 512 * 1024, .corrupt = -1 };
+	static const uint32_t bufs[] = { 4096, 32768 };
+	double kbps, bound;
+	unsigned i, v;
+
+	for (v = 0; v < 2; v++)
+		for (i = 0; i < ARRAY_SIZE(bufs); i++) {
+			r.buf = bufs[i];
+			r.verify = v;
+			CHECK(load(&r, &kbps) == RESULT_OK);
+			CHECK(n_pp == r.size / PAGE && n_erase == r.size / 65536);
+			/* erases and page programs, back to back */
+			bound = r.size / 1024.0 / (device_time * 1e-9);
+			if (!r.verify)
+				CHECK(kbps > 0.9 * bound);
+			if (print)
+				printf("%u KB in %u KB buffers%s: %.1f KB/s "
+				       "(flash bound %.1f KB/s)\n",
+				       (unsigned)(r.size / 1024),
+				       (unsigned)(r.buf / 1024),
+				       r.verify ? ", verify" : "", kbps, bound);
+		}
+}
+
+static void test_checksum(void)
+{
+	struct run r = { .size = 512 * 1024, .buf = 32768, .checksum = true,
+		.corrupt = -1 };
+	struct run odd = { .size = 100000, .offset = 0x10123, .buf = 4000,
+		.verify = true, .checksum = true, .corrupt = -1 };
+	double kbps;
+
+	CHECK(load(&r, &kbps) == RESULT_OK);
+	CHECK(load(&odd, &kbps) == RESULT_OK);
+}
+
+static void test_verify(void)
+{
+	struct run r = { .size = 128 * 1024, .buf = 8192, .verify = true };
+	double kbps;
+
+	r.corrupt = 70000;
+	CHECK(load(&r, &kbps) == RESULT_ERROR);
+	CHECK(strstr(last_message, "Verify failed") != NULL);
+	CHECK(failed_call && strcmp(failed_call, "FlashWrite") == 0);
+
+	/* in the last buffer, checked by the last write before entering
+	 * XIP mode */
+	r.corrupt = r.size - 1;
+	CHECK(load(&r, &kbps) == RESULT_ERROR);
+	CHECK(strstr(last_message, "Verify failed") != NULL);
+	CHECK(failed_call && strcmp(failed_call, "FlashWrite") == 0);
+
+	/* not detected without --verify */
+	r.verify = false;
+	CHECK(load(&r, &kbps) == RESULT_OK);
+	CHECK(mem[r.size - 1] != image[r.size - 1]);
+}
+
+static void test_checksum_read_error(void)
+{
+	struct run r = { .size = 64 * 1024, .buf = 32768, .corrupt = -1 };
+	volatile bool returned = false;
+	double kbps;
+
+	CHECK(load(&r, &kbps) == RESULT_OK);
+	fail_reads = true;
+	flash_break_expected = true;
+	if (setjmp(flash_break) == 0) {
+		FlashChecksum((void*)(uintptr_t)BASE, r.size);
+		returned = true;
+	}
+	flash_break_expected = false;
+	CHECK(!returned);
+	CHECK(strstr(last_message, "Failed to read") != NULL);
+}
+
+int main(int argc, char* argv[])
+{
+	bool print = argc > 1 && strcmp(argv[1], "-b") == 0;
+
+	test_throughput(print);
+	test_checksum();
+	test_verify();
+	test_checksum_read_error();
+	return host_test_end("qspi_loader");
+}
@@ -0,0 +1,389 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the sensor hub. The bus stand-in simulates two I2C buses of
+ * sensors answering burst reads with a pattern derived from their address
+ * and register, completing the transfers either synchronously or later, as
+ * in async/DMA mode. The reads must follow the fixed timetable of every
+ * device, share the bus transaction between consecutive devices of a bus,
+ * and release it once nothing is due.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "sensor/sensor_hub.h"
+#include "peripherals/bus.h"
+#include "timer.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated buses
+ *----------------------------------------------------------------------------*/
+
+/* address of a device that never acknowledges */
+#define NACK_ADDR 0x7f
+
+static uint64_t now_us;
+
+static struct {
+	bool async;
+	int open;             /* bus with an open transaction, -1 if none */
+	uint32_t transactions;
+	uint32_t transfers;
+	uint32_t errors;      /* protocol violations */
+
+	/* transfer completing in the background */
+	struct _callback* pending;
+	uint64_t end;
+} bus;
+
+static void bus_init(bool async)
+{
+	memset(&bus, 0, sizeof(bus));
+	bus.async = async;
+	bus.open = -1;
+}
+
+static uint8_t pattern(uint8_t addr, uint8_t reg, int i)
+{
+	return addr + reg + i;
+}
+
+/* Advance the clock, completing the background transfer when it ends */
+static void advance(uint64_t us)
+{
+	now_us += us;
+	if (bus.pending && now_us >= bus.end) {
+		struct _callback* cb = bus.pending;
+
+		bus.pending = NULL;
+		callback_call(cb, NULL);
+	}
+}
+
+int bus_start_transaction(uint8_t bus_id)
+{
+	if (bus.open >= 0)
+		bus.errors++;
+	bus.open = bus_id;
+	bus.transactions++;
+	return 0;
+}
+
+int bus_stop_transaction(uint8_t bus_id)
+{
+	if (bus.open != bus_id || bus.pending)
+		bus.errors++;
+	bus.open = -1;
+	return 0;
+}
+
+int bus_transfer(uint8_t bus_id, uint16_t remote, struct _buffer* buf, uint16_t buffers, struct _callback* cb)
+{
+	uint64_t duration;
+	uint32_t i;
+
+	if (bus.open != bus_id || bus.pending || buffers != 2 ||
+	    buf[0].size != 1 || !(buf[1].attr & BUS_BUF_ATTR_RX)) {
+		bus.errors++;
+		return -EINVAL;
+	}
+	bus.transfers++;
+
+	if (remote == NACK_ADDR)
+		return -ECONNABORTED;
+
+	for (i = 0; i < buf[1].size; i++)
+		buf[1].data[i] = pattern(remote, buf[0].data[0], i);
+
+	duration = 50 + 25 * buf[1].size;
+	if (bus.async) {
+		bus.pending = cb;
+		bus.end = now_us + duration;
+	} else {
+		now_us += duration;
+		callback_call(cb, NULL);
+	}
+	return 0;
+}
+
+int bus_wait_transfer(uint8_t bus_id)
+{
+	return 0;
+}
+
+uint64_t timer_get_us(void)
+{
+	return now_us;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static int decode(void* arg, const uint8_t* raw, struct _sensor_hub_sample* sample)
+{
+	const struct _sensor_hub_device* dev = (const struct _sensor_hub_device*)arg;
+	int i;
+
+	sample->count = dev->len < SENSOR_HUB_MAX_VALUES ? dev->len : SENSOR_HUB_MAX_VALUES;
+	for (i = 0; i < sample->count; i++)
+		sample->value[i] = raw[i];
+	return 0;
+}
+
+static int decode_error(void* arg, const uint8_t* raw, struct _sensor_hub_sample* sample)
+{
+	return -EIO;
+}
+
+static void device_init(struct _sensor_hub_device* dev, uint8_t bus_id,
+		uint8_t addr, uint8_t reg, uint8_t len, uint32_t period)
+{
+	memset(dev, 0, sizeof(*dev));
+	dev->bus = bus_id;
+	dev->addr = addr;
+	dev->reg = reg;
+	dev->len = len;
+	dev->period = period;
+	dev->decode = decode;
+	dev->arg = dev;
+}
+
+static bool sample_matches(const struct _sensor_hub_device* dev,
+		const struct _sensor_hub_sample* sample)
+{
+	int i;
+
+	if (sample->count == 0)
+		return false;
+	for (i = 0; i < sample->count; i++)
+		if (sample->value[i] != pattern(dev->addr, dev->reg, i))
+			return false;
+	return true;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_add(void)
+{
+	static struct _sensor_hub hub;
+	static struct _sensor_hub_sample ring[4];
+	struct _sensor_hub_device dev[SENSOR_HUB_MAX_DEVICES + 1];
+	int i;
+
+	sensor_hub_init(&hub, ring, 4);
+
+	device_init(&dev[0], 0, 0x10, 0, 6, 1000);
+	dev[0].decode = NULL;
+	CHECK(sensor_hub_add(&hub, &dev[0]) == -EINVAL);
+	device_init(&dev[0], 0, 0x10, 0, 0, 1000);
+	CHECK(sensor_hub_add(&hub, &dev[0]) == -EINVAL);
+	device_init(&dev[0], 0, 0x10, 0, SENSOR_HUB_MAX_BURST + 1, 1000);
+	CHECK(sensor_hub_add(&hub, &dev[0]) == -EINVAL);
+	device_init(&dev[0], 0, 0x10, 0, 6, 0);
+	CHECK(sensor_hub_add(&hub, &dev[0]) == -EINVAL);
+
+	/* period raised to the conversion time */
+	device_init(&dev[0], 0, 0x10, 0, SENSOR_HUB_MAX_BURST, 1000);
+	dev[0].conversion = 2500;
+	CHECK(sensor_hub_add(&hub, &dev[0]) == 0);
+	CHECK(dev[0].period == 2500);
+
+	for (i = 1; i < SENSOR_HUB_MAX_DEVICES; i++) {
+		device_init(&dev[i], 0, 0x10 + i, 0, 6, 1000);
+		CHECK(sensor_hub_add(&hub, &dev[i]) == i);
+	}
+	device_init(&dev[i], 0, 0x10 + i, 0, 6, 1000);
+	CHECK(sensor_hub_add(&hub, &dev[i]) == -ENOMEM);
+	CHECK(hub.count == SENSOR_HUB_MAX_DEVICES);
+}
+
+/*
+ * Devices on two buses with different periods, one of them never
+ * acknowledging, polled for one second from a main loop that sleeps for
+ * the idle time reported by the hub
+ */
+static void test_timetable(bool async)
+{
+	enum { DEVICES = 13, DURATION = 1000000, START = 1000, JITTER = 3000 };
+	static struct _sensor_hub hub;
+	static struct _sensor_hub_sample ring[64];
+	struct _sensor_hub_device dev[DEVICES];
+	struct _sensor_hub_sample sample;
+	uint32_t got[DEVICES] = { 0 };
+	uint32_t total = 0;
+	int i;
+
+	bus_init(async);
+	sensor_hub_init(&hub, ring, 64);
+	for (i = 0; i < DEVICES; i++) {
+		device_init(&dev[i], i % 2, i == DEVICES - 1 ? NACK_ADDR : 0x10 + i,
+				i, 1 + i % 8, 10000 * (1 + i % 3));
+		REQUIRE(sensor_hub_add(&hub, &dev[i]) == i);
+	}
+
+	now_us = START;
+	sensor_hub_start(&hub);
+	while (now_us < START + DURATION) {
+		uint32_t idle;
+
+		total += sensor_hub_poll(&hub);
+		if (!async)
+			CHECK(!sensor_hub_is_busy(&hub));
+		if (!sensor_hub_is_busy(&hub))
+			CHECK(bus.open < 0);
+
+		while (sensor_hub_read(&hub, &sample)) {
+			const struct _sensor_hub_device* d = &dev[sample.device];
+			/* due time of this read on the fixed timetable */
+			uint64_t due = START + (uint64_t)got[sample.device] * d->period;
+
+			CHECK(sample_matches(d, &sample));
+			CHECK(sample.timestamp > due);
+			CHECK(sample.timestamp < due + JITTER);
+			got[sample.device]++;
+		}
+
+		idle = sensor_hub_get_idle_time(&hub);
+		if (sensor_hub_is_busy(&hub))
+			CHECK(idle == 0);
+		advance(idle ? idle : 10);
+	}
+
+	CHECK(bus.errors == 0);
+	CHECK(hub.ring.dropped == 0);
+	for (i = 0; i < DEVICES - 1; i++) {
+		CHECK(got[i] >= DURATION / dev[i].period);
+		CHECK(got[i] <= DURATION / dev[i].period + 1);
+		CHECK(got[i] == dev[i].samples);
+		CHECK(dev[i].missed == 0);
+		CHECK(dev[i].errors == 0);
+	}
+	CHECK(got[DEVICES - 1] == 0);
+	CHECK(dev[DEVICES - 1].errors >= DURATION / dev[DEVICES - 1].period);
+	CHECK(total == bus.transfers - dev[DEVICES - 1].errors);
+	/* due devices of the same bus share a transaction */
+	CHECK(bus.transactions < bus.transfers / 2);
+}
+
+/* A late poll skips the slots that are over without shifting the others */
+static void test_late(void)
+{
+	static struct _sensor_hub hub;
+	static struct _sensor_hub_sample ring[8];
+	struct _sensor_hub_device dev;
+	struct _sensor_hub_sample sample;
+
+	bus_init(false);
+	sensor_hub_init(&hub, ring, 8);
+	device_init(&dev, 0, 0x20, 4, 6, 10000);
+	REQUIRE(sensor_hub_add(&hub, &dev) == 0);
+
+	now_us = 0;
+	sensor_hub_start(&hub);
+	CHECK(sensor_hub_get_idle_time(&hub) == 0);
+	CHECK(sensor_hub_poll(&hub) == 1);
+	CHECK(sensor_hub_get_idle_time(&hub) == 10000 - now_us);
+	CHECK(sensor_hub_poll(&hub) == 0);
+
+	now_us = 35000;
+	CHECK(sensor_hub_poll(&hub) == 1);
+	CHECK(dev.missed == 2);
+	CHECK(dev.next == 40000);
+	CHECK(sensor_hub_get_idle_time(&hub) == 40000 - now_us);
+
+	now_us = 40000;
+	CHECK(sensor_hub_poll(&hub) == 1);
+	CHECK(dev.missed == 2);
+	CHECK(dev.next == 50000);
+
+	CHECK(sensor_hub_read(&hub, &sample) && sample.timestamp < 1000);
+	CHECK(sensor_hub_read(&hub, &sample) && sample.timestamp > 35000);
+	CHECK(sensor_hub_read(&hub, &sample) && sample.timestamp > 40000);
+	CHECK(!sensor_hub_read(&hub, &sample));
+	CHECK(bus.errors == 0);
+}
+
+/* Full ring and decode errors */
+static void test_ring(void)
+{
+	static struct _sensor_hub hub;
+	static struct _sensor_hub_sample ring[4];
+	struct _sensor_hub_device dev[2];
+	struct _sensor_hub_sample sample;
+	int i;
+
+	bus_init(false);
+	sensor_hub_init(&hub, ring, 4);
+	device_init(&dev[0], 0, 0x20, 0, 2, 1000);
+	device_init(&dev[1], 1, 0x30, 0, 2, 1000);
+	dev[1].decode = decode_error;
+	REQUIRE(sensor_hub_add(&hub, &dev[0]) == 0);
+	REQUIRE(sensor_hub_add(&hub, &dev[1]) == 1);
+
+	now_us = 0;
+	sensor_hub_start(&hub);
+	for (i = 0; i < 5; i++) {
+		CHECK(sensor_hub_poll(&hub) == 1);
+		now_us = (i + 1) * 1000;
+	}
+	CHECK(dev[0].samples == 5);
+	CHECK(dev[1].samples == 0 && dev[1].errors == 5);
+	CHECK(hub.ring.dropped == 2);
+
+	/* the oldest samples are kept */
+	for (i = 0; i < 3; i++) {
+		CHECK(sensor_hub_read(&hub, &sample));
+		CHECK(sample.device == 0 && sample_matches(&dev[0], &sample));
+		CHECK(sample.timestamp > i * 1000 && sample.timestamp < i * 1000 + 1000);
+	}
+	CHECK(!sensor_hub_read(&hub, &sample));
+	CHECK(bus.errors == 0);
+}
+
+int main(void)
+{
+	test_add();
+	test_timetable(false);
+	test_timetable(true);
+	test_late();
+	test_ring();
+	return host_test_end("sensor_hub");
+}
@@ -0,0 +1,287 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Register arrays in the format of the sensor configuration files before
+ * their conversion, input of scripts/sensorpack. The Makefile builds this
+ * file as is, and the tables produced by the tool with SAMPLE_PACKED
+ * defined.
+ */
+
+#include "video/image_sensor_inf.h"
+
+#include <stddef.h>
+
+static const struct sensor_reg sample_init[] = {
+
+	/* Software reset */
+	{0x3103, 0x11},
+	{0x3008, 0x82},
+	{0x3008, 0x42},
+
+	/* PLL control */
+	{0x3034, 0x1a},
+	{0x3035, 0x11}, /* system clock divider */
+	{0x3036, 0x46},
+	{0x3037, 0x13},
+	{0x3108, 0x01},
+
+	/* Gamma curve, longer than a record */
+	{0x5480, 0x03},
+	{0x5481, 0x0a},
+	{0x5482, 0x11},
+	{0x5483, 0x18},
+	{0x5484, 0x1f},
+	{0x5485, 0x26},
+	{0x5486, 0x2d},
+	{0x5487, 0x34},
+	{0x5488, 0x3b},
+	{0x5489, 0x42},
+	{0x548a, 0x49},
+	{0x548b, 0x50},
+	{0x548c, 0x57},
+	{0x548d, 0x5e},
+	{0x548e, 0x65},
+	{0x548f, 0x6c},
+	{0x5490, 0x73},
+	{0x5491, 0x7a},
+	{0x5492, 0x81},
+	{0x5493, 0x88},
+	{0x5494, 0x8f},
+	{0x5495, 0x96},
+	{0x5496, 0x9d},
+	{0x5497, 0xa4},
+	{0x5498, 0xab},
+	{0x5499, 0xb2},
+	{0x549a, 0xb9},
+	{0x549b, 0xc0},
+	{0x549c, 0xc7},
+	{0x549d, 0xce},
+	{0x549e, 0xd5},
+	{0x549f, 0xdc},
+	{0x54a0, 0xe3},
+	{0x54a1, 0xea},
+	{0x54a2, 0xf1},
+	{0x54a3, 0xf8},
+	{0x54a4, 0xff},
+	{0x54a5, 0x06},
+	{0x54a6, 0x0d},
+	{0x54a7, 0x14},
+	{0x54a8, 0x1b},
+	{0x54a9, 0x22},
+	{0x54aa, 0x29},
+	{0x54ab, 0x30},
+	{0x54ac, 0x37},
+	{0x54ad, 0x3e},
+	{0x54ae, 0x45},
+	{0x54af, 0x4c},
+	{0x54b0, 0x53},
+	{0x54b1, 0x5a},
+	{0x54b2, 0x61},
+	{0x54b3, 0x68},
+	{0x54b4, 0x6f},
+	{0x54b5, 0x76},
+	{0x54b6, 0x7d},
+	{0x54b7, 0x84},
+	{0x54b8, 0x8b},
+	{0x54b9, 0x92},
+	{0x54ba, 0x99},
+	{0x54bb, 0xa0},
+	{0x54bc, 0xa7},
+	{0x54bd, 0xae},
+	{0x54be, 0xb5},
+	{0x54bf, 0xbc},
+	{0x54c0, 0xc3},
+	{0x54c1, 0xca},
+	{0x54c2, 0xd1},
+	{0x54c3, 0xd8},
+	{0x54c4, 0xdf},
+	{0x54c5, 0xe6},
+	{0x54c6, 0xed},
+	{0x54c7, 0xf4},
+	{0x54c8, 0xfb},
+	{0x54c9, 0x02},
+	{0x54ca, 0x09},
+	{0x54cb, 0x10},
+	{0x54cc, 0x17},
+	{0x54cd, 0x1e},
+	{0x54ce, 0x25},
+	{0x54cf, 0x2c},
+	{0x54d0, 0x33},
+	{0x54d1, 0x3a},
+	{0x54d2, 0x41},
+	{0x54d3, 0x48},
+	{0x54d4, 0x4f},
+	{0x54d5, 0x56},
+	{0x54d6, 0x5d},
+	{0x54d7, 0x64},
+	{0x54d8, 0x6b},
+	{0x54d9, 0x72},
+	{0x54da, 0x79},
+	{0x54db, 0x80},
+	{0x54dc, 0x87},
+	{0x54dd, 0x8e},
+	{0x54de, 0x95},
+	{0x54df, 0x9c},
+	{0x54e0, 0xa3},
+	{0x54e1, 0xaa},
+	{0x54e2, 0xb1},
+	{0x54e3, 0xb8},
+	{0x54e4, 0xbf},
+	{0x54e5, 0xc6},
+	{0x54e6, 0xcd},
+	{0x54e7, 0xd4},
+	{0x54e8, 0xdb},
+	{0x54e9, 0xe2},
+	{0x54ea, 0xe9},
+	{0x54eb, 0xf0},
+	{0x54ec, 0xf7},
+	{0x54ed, 0xfe},
+	{0x54ee, 0x05},
+	{0x54ef, 0x0c},
+	{0x54f0, 0x13},
+	{0x54f1, 0x1a},
+	{0x54f2, 0x21},
+	{0x54f3, 0x28},
+	{0x54f4, 0x2f},
+	{0x54f5, 0x36},
+	{0x54f6, 0x3d},
+	{0x54f7, 0x44},
+	{0x54f8, 0x4b},
+	{0x54f9, 0x52},
+	{0x54fa, 0x59},
+	{0x54fb, 0x60},
+	{0x54fc, 0x67},
+	{0x54fd, 0x6e},
+	{0x54fe, 0x75},
+	{0x54ff, 0x7c},
+	{0x5500, 0x83},
+	{0x5501, 0x8a},
+	{0x5502, 0x91},
+	{0x5503, 0x98},
+	{0x5504, 0x9f},
+	{0x5505, 0xa6},
+	{0x5506, 0xad},
+	{0x5507, 0xb4},
+	{0x5508, 0xbb},
+	{0x5509, 0xc2},
+	{0x550a, 0xc9},
+	{0x550b, 0xd0},
+	{0x550c, 0xd7},
+	{0x550d, 0xde},
+	{0x550e, 0xe5},
+	{0x550f, 0xec},
+	{0x5510, 0xf3},
+
+	/* Wait for the PLL */
+	{0xFFFF, 10},
+	{0x4300, 0x30},
+	{0x4301, 0x00},
+	{0x3008, 0x02}, /* wake up */
+	{0xFF, 0xFF}
+};
+
+static const struct sensor_reg sample_mode[] = {
+	{0x3103, 0x11},
+	{0x3008, 0x82},
+	{0xFFFF, 20},
+	{0x3008, 0x42},
+	{0x3034, 0x1a},
+	{0x3035, 0x21},
+	{0x3036, 0x46},
+	{0x3037, 0x13},
+	{0x3108, 0x01},
+	{0x3808, 0x02},
+	{0x3809, 0x80},
+	{0x380a, 0x01},
+	{0x380b, 0xe0},
+	{0x4300, 0x30},
+	{0x4301, 0x00},
+	{0x3008, 0x02},
+	{0xFF, 0xFF}
+};
+
+/* No reset: a firmware download */
+static const struct sensor_reg sample_firmware[] = {
+	{0x3000, 0x20},
+	{0x8000, 0x05},
+	{0x8001, 0x22},
+	{0x8002, 0x3f},
+	{0x8003, 0x5c},
+	{0x8004, 0x79},
+	{0x8005, 0x96},
+	{0x8006, 0xb3},
+	{0x8007, 0xd0},
+	{0x8008, 0xed},
+	{0x8009, 0x0a},
+	{0x800a, 0x27},
+	{0x800b, 0x44},
+	{0x800c, 0x61},
+	{0x800d, 0x7e},
+	{0x800e, 0x9b},
+	{0x800f, 0xb8},
+	{0x8010, 0xd5},
+	{0x8011, 0xf2},
+	{0x8012, 0x0f},
+	{0x8013, 0x2c},
+	{0x8014, 0x49},
+	{0x8015, 0x66},
+	{0x8016, 0x83},
+	{0x8017, 0xa0},
+	{0x8018, 0xbd},
+	{0x8019, 0xda},
+	{0x801a, 0xf7},
+	{0x801b, 0x14},
+	{0x801c, 0x31},
+	{0x801d, 0x4e},
+	{0x801e, 0x6b},
+	{0x801f, 0x88},
+	{0x8020, 0xa5},
+	{0x8021, 0xc2},
+	{0x8022, 0xdf},
+	{0x8023, 0xfc},
+	{0x8024, 0x19},
+	{0x8025, 0x36},
+	{0x8026, 0x53},
+	{0x8027, 0x70},
+	{0x3022, 0x00},
+	{0x3000, 0x00},
+	{0xFF, 0xFF}
+};
+
+#ifdef SAMPLE_PACKED
+const uint8_t* const sample_packed[] = {
+#else
+const struct sensor_reg* const sample_regs[] = {
+#endif
+	sample_init,
+	sample_mode,
+	sample_firmware,
+	NULL
+};
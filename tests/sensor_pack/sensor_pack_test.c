@@ -0,0 +1,800 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the packed image sensor tables (drivers/video/sensor_pack.c).
+ *
+ * - The decoder on hand-built records.
+ * - The tables produced by scripts/sensorpack from sample_regs.c against
+ *   the original arrays.
+ * - The OV5640 and OV9740 tables against the arrays of ov5640_regs.c and
+ *   ov9740_regs.c, the configuration files they were converted from.
+ * - sensor_pack_apply() on random pairs of tables and on every pair of
+ *   OV5640 and OV9740 outputs, over a simulated register file where the
+ *   reset write restores the defaults: applying the differences leaves the
+ *   sensor in the same state as a full write, and the writes, bus
+ *   transfers and delays are those documented.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "video/image_sensor_inf.h"
+#include "video/sensor_pack.h"
+
+#include "host_test.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated sensor
+ *----------------------------------------------------------------------------*/
+
+static uint8_t regs[65536];
+
+static uint16_t reset_reg;
+static uint8_t reset_mask;
+
+static unsigned writes, transfers, delay_ms, delays;
+static int fail_at = -1;
+
+static uint8_t default_value(unsigned reg)
+{
+	return (uint8_t)(reg * 37 + 11);
+}
+
+static void sensor_reset(void)
+{
+	unsigned i;
+
+	for (i = 0; i < 65536; i++)
+		regs[i] = default_value(i);
+}
+
+static void sensor_select(uint16_t reg, uint8_t mask)
+{
+	reset_reg = reg;
+	reset_mask = mask;
+	sensor_reset();
+}
+
+/* per-write check hook of the random tests */
+static void (*write_hook)(uint16_t reg, const uint8_t* data, uint16_t count);
+
+static int sensor_write(void* arg, uint16_t reg, const uint8_t* data,
+		uint16_t count)
+{
+	unsigned i;
+
+	CHECK(arg == regs);
+	CHECK(count > 0);
+	if (fail_at >= 0 && (int)transfers == fail_at)
+		return -5;
+	transfers++;
+	if (write_hook)
+		write_hook(reg, data, count);
+	for (i = 0; i < count; i++) {
+		uint16_t r = reg + i;
+
+		if (r == reset_reg && (data[i] & reset_mask))
+			sensor_reset();
+		else
+			regs[r] = data[i];
+		writes++;
+	}
+	return 0;
+}
+
+static void sensor_delay(void* arg, uint32_t ms)
+{
+	CHECK(arg == regs);
+	delay_ms += ms;
+	delays++;
+}
+
+static const struct sensor_pack_ops ops = {
+	.write = sensor_write,
+	.delay = sensor_delay,
+	.arg = regs,
+};
+
+static void counters_clear(void)
+{
+	writes = transfers = delay_ms = delays = 0;
+}
+
+/*----------------------------------------------------------------------------
+ *        Table builder
+ *----------------------------------------------------------------------------*/
+
+#define MAX_TABLE 2048
+#define MAX_EVENTS 512
+
+enum { EV_WRITE, EV_RESET, EV_DELAY };
+
+/* a table and the list of its writes, for the model */
+struct table {
+	uint8_t b[MAX_TABLE];
+	unsigned size;
+	struct {
+		uint8_t kind;
+		uint16_t reg;
+		uint8_t val;
+		uint16_t rec;
+	} ev[MAX_EVENTS];
+	unsigned events;
+	unsigned body;          /* first event after the last reset */
+	unsigned records;
+};
+
+static void t_init(struct table* t)
+{
+	t->size = 0;
+	t->events = 0;
+	t->body = 0;
+	t->records = 0;
+}
+
+static void t_event(struct table* t, uint8_t kind, uint16_t reg, uint8_t val)
+{
+	REQUIRE(t->events < MAX_EVENTS);
+	t->ev[t->events].kind = kind;
+	t->ev[t->events].reg = reg;
+	t->ev[t->events].val = val;
+	t->ev[t->events].rec = t->records;
+	t->events++;
+}
+
+static void t_seq(struct table* t, uint16_t reg, const uint8_t* vals,
+		unsigned count)
+{
+	const uint8_t hdr[] = { SENSOR_SEQ(reg, count) };
+	unsigned i;
+
+	REQUIRE(count >= 1 && count <= SENSOR_SEQ_MAX);
+	REQUIRE(t->size + 3 + count < MAX_TABLE);
+	memcpy(t->b + t->size, hdr, 3);
+	memcpy(t->b + t->size + 3, vals, count);
+	t->size += 3 + count;
+	for (i = 0; i < count; i++)
+		t_event(t, EV_WRITE, reg + i, vals[i]);
+	t->records++;
+}
+
+static void t_reset(struct table* t, uint16_t reg, uint8_t val)
+{
+	const uint8_t rec[] = { SENSOR_RESET(reg, val) };
+
+	REQUIRE(t->size + sizeof(rec) < MAX_TABLE);
+	memcpy(t->b + t->size, rec, sizeof(rec));
+	t->size += sizeof(rec);
+	t_event(t, EV_RESET, reg, val);
+	t->records++;
+	t->body = t->events;
+}
+
+static void t_delay(struct table* t, uint8_t ms)
+{
+	const uint8_t rec[] = { SENSOR_DELAY(ms) };
+
+	REQUIRE(t->size + sizeof(rec) < MAX_TABLE);
+	memcpy(t->b + t->size, rec, sizeof(rec));
+	t->size += sizeof(rec);
+	t_event(t, EV_DELAY, 0, ms);
+	t->records++;
+}
+
+static void t_end(struct table* t)
+{
+	REQUIRE(t->size < MAX_TABLE);
+	t->b[t->size++] = SENSOR_END;
+}
+
+/* writes of reg after the last reset, last value in *val */
+static unsigned t_lookup(const struct table* t, uint16_t reg, uint8_t* val)
+{
+	unsigned i, n = 0;
+
+	for (i = t->body; i < t->events; i++)
+		if (t->ev[i].kind == EV_WRITE && t->ev[i].reg == reg) {
+			*val = t->ev[i].val;
+			n++;
+		}
+	return n;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint32_t seed = 1;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245u + 12345u;
+	return seed >> 8;
+}
+
+/* model of the diff apply of target over current */
+static const struct table* model_target;
+static const struct table* model_current;
+
+static bool model_skip(unsigned i)
+{
+	const struct table* t = model_target;
+	uint8_t tval, cval;
+
+	if (i < t->body || t->ev[i].kind != EV_WRITE)
+		return false;
+	if (t_lookup(t, t->ev[i].reg, &tval) != 1)
+		return false;
+	if (t_lookup(model_current, t->ev[i].reg, &cval) != 1)
+		return false;
+	return cval == t->ev[i].val;
+}
+
+/* the write calls must not cover a register to skip */
+static void check_write(uint16_t reg, const uint8_t* data, uint16_t count)
+{
+	const struct table* t = model_target;
+	unsigned i, k;
+	uint8_t val;
+
+	for (k = 0; k < count; k++) {
+		for (i = t->body; i < t->events; i++)
+			if (t->ev[i].kind == EV_WRITE
+			    && t->ev[i].reg == (uint16_t)(reg + k)
+			    && t->ev[i].val == data[k])
+				break;
+		REQUIRE(i < t->events);
+		if (t_lookup(t, t->ev[i].reg, &val) == 1)
+			CHECK(!model_skip(i));
+	}
+}
+
+/* a body writing every register of [base, base + n) once, in runs */
+static void random_body(struct table* t, uint16_t base, unsigned n,
+		const uint8_t* vals, bool delays)
+{
+	unsigned starts[64], lens[64], count = 0, i;
+
+	for (i = 0; i < n; i += lens[count++]) {
+		starts[count] = i;
+		lens[count] = 1 + rnd() % 8;
+		if (lens[count] > n - i)
+			lens[count] = n - i;
+	}
+	/* runs in random order */
+	for (i = count - 1; i > 0; i--) {
+		unsigned j = rnd() % (i + 1);
+		unsigned s = starts[i], l = lens[i];
+
+		starts[i] = starts[j];
+		lens[i] = lens[j];
+		starts[j] = s;
+		lens[j] = l;
+	}
+	for (i = 0; i < count; i++) {
+		t_seq(t, base + starts[i], vals + starts[i], lens[i]);
+		if (delays && rnd() % 4 == 0)
+			t_delay(t, 1 + rnd() % 20);
+	}
+}
+
+static void strobe(struct table* t)
+{
+	unsigned i, n = 1 + rnd() % 3;
+
+	for (i = 0; i < n; i++) {
+		uint8_t v = rnd() % 4;
+
+		t_seq(t, 0x3212, &v, 1);
+	}
+}
+
+static void prefix(struct table* t, uint8_t val)
+{
+	const uint8_t pre[] = { 0x11, val };
+
+	t_seq(t, 0x3103, pre, 2);
+	t_reset(t, 0x3008, 0x82);
+	t_delay(t, 5);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static void test_decoder(void)
+{
+	static struct table t;
+	struct sensor_pack_rec rec;
+	const uint8_t* p;
+	uint8_t vals[SENSOR_SEQ_MAX];
+	unsigned i;
+
+	for (i = 0; i < SENSOR_SEQ_MAX; i++)
+		vals[i] = rnd();
+	t_init(&t);
+	t_seq(&t, 0x1234, vals, 1);
+	t_seq(&t, 0xff80, vals, SENSOR_SEQ_MAX);
+	t_reset(&t, 0x3008, 0x82);
+	t_delay(&t, 255);
+	t_end(&t);
+
+	p = sensor_pack_next(t.b, &rec);
+	CHECK(rec.type == SENSOR_PACK_SEQ);
+	CHECK(rec.reg == 0x1234 && rec.count == 1);
+	CHECK(rec.data == t.b + 3 && rec.data[0] == vals[0]);
+	CHECK(p == t.b + 4);
+
+	p = sensor_pack_next(p, &rec);
+	CHECK(rec.type == SENSOR_PACK_SEQ);
+	CHECK(rec.reg == 0xff80 && rec.count == SENSOR_SEQ_MAX);
+	CHECK(memcmp(rec.data, vals, SENSOR_SEQ_MAX) == 0);
+	CHECK(p == t.b + 7 + SENSOR_SEQ_MAX);
+
+	p = sensor_pack_next(p, &rec);
+	CHECK(rec.type == SENSOR_PACK_RESET);
+	CHECK(rec.reg == 0x3008 && rec.count == 1 && rec.data[0] == 0x82);
+
+	p = sensor_pack_next(p, &rec);
+	CHECK(rec.type == SENSOR_PACK_DELAY);
+	CHECK(rec.count == 255 && rec.data == NULL);
+	REQUIRE(p == t.b + t.size - 1);
+
+	CHECK(sensor_pack_next(p, &rec) == NULL);
+	CHECK(rec.type == SENSOR_PACK_END);
+	CHECK(rec.count == 0);
+
+	CHECK(sensor_pack_size(t.b) == t.size);
+	CHECK(sensor_pack_size(p) == 1);
+}
+
+static void test_sample_tables(void)
+{
+	extern const struct sensor_reg* const sample_regs[];
+	extern const uint8_t* const sample_packed[];
+	unsigned n;
+
+	for (n = 0; sample_regs[n]; n++) {
+		const struct sensor_reg* r = sample_regs[n];
+		const uint8_t* p = sample_packed[n];
+		struct sensor_pack_rec rec;
+		bool reset_delay = false, long_run = false;
+		unsigned k;
+
+		REQUIRE(p != NULL);
+		while (p) {
+			p = sensor_pack_next(p, &rec);
+			switch (rec.type) {
+			case SENSOR_PACK_SEQ:
+				if (rec.count == SENSOR_SEQ_MAX)
+					long_run = true;
+				/* fall through */
+			case SENSOR_PACK_RESET:
+				for (k = 0; k < rec.count; k++, r++) {
+					CHECK(r->reg == rec.reg + k);
+					CHECK(r->val == rec.data[k]);
+					CHECK((rec.type == SENSOR_PACK_RESET)
+					      == (r->reg == 0x3008 && r->val == 0x82));
+				}
+				/* runs are as long as possible */
+				if (rec.type == SENSOR_PACK_SEQ
+				    && rec.count < SENSOR_SEQ_MAX)
+					CHECK(r->reg != rec.reg + rec.count
+					      || (r->reg == 0x3008 && r->val == 0x82));
+				/* the reset gets a delay if it has none */
+				reset_delay = rec.type == SENSOR_PACK_RESET
+					&& r->reg != 0xFFFF;
+				break;
+			case SENSOR_PACK_DELAY:
+				if (reset_delay) {
+					CHECK(rec.count == 5);
+				} else {
+					CHECK(r->reg == 0xFFFF);
+					CHECK(r->val == rec.count);
+					r++;
+				}
+				reset_delay = false;
+				break;
+			default:
+				CHECK(!reset_delay);
+				CHECK(r->reg == 0xFF && r->val == 0xFF);
+				break;
+			}
+		}
+		CHECK(long_run == (n == 0));
+	}
+	CHECK(n == 3);
+	CHECK(sample_packed[n] == NULL);
+}
+
+/* writes and delays of a packed table against the array it comes from,
+ * with a reset_delay ms delay added after the reset */
+static void check_converted(const uint8_t* p, const struct sensor_reg* r,
+		uint16_t reset_reg, uint8_t reset_val, uint8_t reset_delay)
+{
+	struct sensor_pack_rec rec;
+	bool added_delay = false;
+	unsigned k;
+
+	while (p) {
+		p = sensor_pack_next(p, &rec);
+		CHECK(!added_delay || rec.type == SENSOR_PACK_DELAY);
+		switch (rec.type) {
+		case SENSOR_PACK_SEQ:
+		case SENSOR_PACK_RESET:
+			for (k = 0; k < rec.count; k++, r++) {
+				REQUIRE(r->reg == rec.reg + k);
+				REQUIRE(r->val == rec.data[k]);
+				CHECK((rec.type == SENSOR_PACK_RESET)
+				      == (r->reg == reset_reg && r->val == reset_val));
+			}
+			/* the reset gets a delay if it has none */
+			added_delay = rec.type == SENSOR_PACK_RESET
+				&& reset_delay && r->reg != 0xFFFF;
+			break;
+		case SENSOR_PACK_DELAY:
+			if (added_delay) {
+				CHECK(rec.count == reset_delay);
+			} else {
+				CHECK(r->reg == 0xFFFF);
+				CHECK(r->val == rec.count);
+				r++;
+			}
+			added_delay = false;
+			break;
+		default:
+			CHECK(r->reg == 0xFF && r->val == 0xFF);
+			break;
+		}
+	}
+}
+
+static void test_converted_tables(void)
+{
+	extern const struct sensor_profile ov5640_regs_profile;
+	extern const struct sensor_profile ov9740_regs_profile;
+	static const struct {
+		const struct sensor_profile* packed;
+		const struct sensor_profile* regs;
+		uint16_t reset_reg;
+		uint8_t reset_val;
+		uint8_t reset_delay;
+	} sensors[] = {
+		{ &ov5640_profile, &ov5640_regs_profile, 0x3008, 0x82, 0 },
+		{ &ov9740_profile, &ov9740_regs_profile, 0x0103, 0x01, 5 },
+	};
+	unsigned s, k, outputs = 0;
+
+	for (s = 0; s < 2; s++) {
+		const struct sensor_profile* packed = sensors[s].packed;
+		const struct sensor_profile* regs = sensors[s].regs;
+
+		CHECK(!strcmp(packed->name, regs->name));
+		CHECK(packed->flags == (SENSOR_FLAG_BURST | SENSOR_FLAG_DIFF));
+		CHECK(regs->flags == 0);
+		for (k = 0; k < SENSOR_SUPPORTED_OUTPUTS; k++) {
+			const struct sensor_output* po = packed->output_conf[k];
+			const struct sensor_output* ro = regs->output_conf[k];
+
+			REQUIRE((po == NULL) == (ro == NULL));
+			if (!po)
+				continue;
+			CHECK(po->type == ro->type);
+			CHECK(po->output_resolution == ro->output_resolution);
+			CHECK(po->output_format == ro->output_format);
+			CHECK(po->output_width == ro->output_width);
+			CHECK(po->output_height == ro->output_height);
+			CHECK(po->output_setting == NULL);
+			CHECK(ro->output_packed == NULL);
+			REQUIRE(po->output_packed != NULL);
+			REQUIRE(ro->output_setting != NULL);
+			check_converted(po->output_packed, ro->output_setting,
+					sensors[s].reset_reg, sensors[s].reset_val,
+					sensors[s].reset_delay);
+			outputs++;
+		}
+	}
+	CHECK(outputs == 9);
+}
+
+/* same writes up to the reset, and nothing set by current only */
+static bool model_diffable(const struct table* target,
+		const struct table* current)
+{
+	unsigned i;
+	uint8_t val;
+
+	if (target->body != current->body)
+		return false;
+	for (i = 0; i < target->body; i++)
+		if (target->ev[i].kind != current->ev[i].kind
+		    || target->ev[i].reg != current->ev[i].reg
+		    || target->ev[i].val != current->ev[i].val)
+			return false;
+	for (i = current->body; i < current->events; i++)
+		if (current->ev[i].kind == EV_WRITE
+		    && !t_lookup(target, current->ev[i].reg, &val))
+			return false;
+	return true;
+}
+
+/* apply target over current and check against the model */
+static void check_pair(const struct table* target, const struct table* current)
+{
+	static uint8_t full[65536];
+	bool diffable = model_diffable(target, current);
+	unsigned i, expected = 0, runs = 0, expected_delay = 0;
+	bool dirty = false, run = false;
+	uint16_t rec = 0xffff;
+	int ret;
+
+	sensor_reset();
+	REQUIRE(sensor_pack_apply(target->b, NULL, &ops) >= 0);
+	memcpy(full, regs, sizeof(full));
+
+	sensor_reset();
+	REQUIRE(sensor_pack_apply(current->b, NULL, &ops) >= 0);
+
+	model_target = target;
+	model_current = current;
+	for (i = diffable ? target->body : 0; i < target->events; i++) {
+		if (target->ev[i].rec != rec)
+			run = false;
+		rec = target->ev[i].rec;
+		if (target->ev[i].kind == EV_DELAY) {
+			if (!diffable || dirty)
+				expected_delay += target->ev[i].val;
+			dirty = false;
+		} else if (diffable && model_skip(i)) {
+			run = false;
+		} else {
+			expected++;
+			if (!run)
+				runs++;
+			run = true;
+			dirty = true;
+		}
+	}
+
+	counters_clear();
+	write_hook = diffable ? check_write : NULL;
+	ret = sensor_pack_apply(target->b, current->b, &ops);
+	write_hook = NULL;
+	CHECK(ret == (int)expected);
+	CHECK(writes == expected);
+	CHECK(transfers == runs);
+	CHECK(delay_ms == expected_delay);
+	CHECK(memcmp(full, regs, sizeof(full)) == 0);
+}
+
+static void test_random_pairs(void)
+{
+	static struct table target, current;
+	uint8_t tvals[48], cvals[48];
+	unsigned i, k, diffable = 0;
+
+	sensor_select(0x3008, 0x80);
+	for (i = 0; i < 4000; i++) {
+		unsigned n = 4 + rnd() % 40;
+		unsigned variant = rnd() % 10;
+		uint8_t extra = rnd();
+
+		for (k = 0; k < n; k++) {
+			/* few values: many registers keep theirs */
+			tvals[k] = rnd() % 3;
+			cvals[k] = rnd() % 3;
+		}
+
+		t_init(&target);
+		if (rnd() % 8 == 0) {
+			/* a delay before any write */
+			t_delay(&target, 1);
+		}
+		prefix(&target, 0x02);
+		if (rnd() % 2)
+			strobe(&target);
+		random_body(&target, 0x4000, n, tvals, true);
+		if (rnd() % 2)
+			strobe(&target);
+		if (rnd() % 2) {
+			/* only set by target */
+			t_seq(&target, 0x4800, &extra, 1);
+		}
+		t_end(&target);
+
+		t_init(&current);
+		if (variant == 0) {
+			/* different writes before the reset */
+			prefix(&current, 0x03);
+		} else if (variant == 1) {
+			/* no reset */
+			t_seq(&current, 0x3103, (const uint8_t[]){ 0x11 }, 1);
+		} else if (variant == 2) {
+			/* same writes as target up to its reset, then more */
+			prefix(&current, 0x02);
+			t_seq(&current, 0x3103, (const uint8_t[]){ 0x11 }, 1);
+			t_reset(&current, 0x3008, 0x82);
+		} else {
+			prefix(&current, 0x02);
+		}
+		if (rnd() % 2)
+			strobe(&current);
+		random_body(&current, 0x4000, n, cvals, rnd() % 2);
+		if (variant == 3) {
+			/* a register target leaves to its default */
+			t_seq(&current, 0x4900, &extra, 1);
+		} else if (variant == 4) {
+			/* a register written twice by current only */
+			t_seq(&current, 0x4000, &cvals[0], 1);
+		}
+		t_end(&current);
+
+		check_pair(&target, &current);
+		diffable += model_diffable(&target, &current);
+	}
+	CHECK(diffable > 1000 && diffable < 3000);
+
+	/* applying a table over itself writes the registers written
+	 * several times only */
+	t_init(&target);
+	prefix(&target, 0x02);
+	for (k = 0; k < 20; k++)
+		tvals[k] = rnd();
+	strobe(&target);
+	random_body(&target, 0x4000, 20, tvals, true);
+	strobe(&target);
+	t_end(&target);
+	CHECK(model_diffable(&target, &target));
+	check_pair(&target, &target);
+	for (k = 0, i = 0; k < target.events; k++)
+		if (target.ev[k].kind == EV_WRITE && target.ev[k].reg == 0x3212)
+			i++;
+	CHECK(writes == i);
+}
+
+static void test_write_error(void)
+{
+	static struct table t;
+	uint8_t vals[8] = { 0 };
+	unsigned i;
+
+	t_init(&t);
+	prefix(&t, 0x02);
+	for (i = 0; i < 4; i++) {
+		t_seq(&t, 0x4000 + 16 * i, vals, 8);
+		t_delay(&t, 1);
+	}
+	t_end(&t);
+
+	for (i = 0; i < 6; i++) {
+		sensor_reset();
+		counters_clear();
+		fail_at = i;
+		CHECK(sensor_pack_apply(t.b, NULL, &ops) == -5);
+		CHECK(transfers == i);
+		CHECK(delays == (i >= 2 ? i - 1 : 0));
+	}
+	fail_at = -1;
+}
+
+static void test_profiles(void)
+{
+	static uint8_t full[65536];
+	static const struct {
+		const struct sensor_profile* profile;
+		uint16_t reset_reg;
+		uint8_t reset_mask;
+	} sensors[] = {
+		{ &ov5640_profile, 0x3008, 0x80 },
+		{ &ov9740_profile, 0x0103, 0x01 },
+	};
+	unsigned s, a, b, k, pairs = 0, reduced = 0;
+
+	for (s = 0; s < 2; s++) {
+		const struct sensor_profile* prof = sensors[s].profile;
+
+		sensor_select(sensors[s].reset_reg, sensors[s].reset_mask);
+		for (a = 0; a < SENSOR_SUPPORTED_OUTPUTS && prof->output_conf[a]; a++) {
+			const struct sensor_output* oa = prof->output_conf[a];
+
+			REQUIRE(oa->output_packed != NULL);
+			for (b = 0; b < SENSOR_SUPPORTED_OUTPUTS && prof->output_conf[b]; b++) {
+				const struct sensor_output* ob = prof->output_conf[b];
+				unsigned full_writes, full_delay;
+				int ret;
+
+				if (oa->type || ob->type)
+					continue;
+
+				sensor_reset();
+				counters_clear();
+				CHECK(sensor_pack_apply(ob->output_packed, NULL, &ops)
+				      == (int)writes);
+				memcpy(full, regs, sizeof(full));
+				full_writes = writes;
+				full_delay = delay_ms;
+				CHECK(full_writes > 0);
+
+				sensor_reset();
+				sensor_pack_apply(oa->output_packed, NULL, &ops);
+				counters_clear();
+				ret = sensor_pack_apply(ob->output_packed,
+						oa->output_packed, &ops);
+				CHECK(ret == (int)writes);
+				CHECK(memcmp(full, regs, sizeof(full)) == 0);
+				CHECK(writes <= full_writes);
+				CHECK(delay_ms <= full_delay);
+				/* some outputs set registers others leave to
+				 * their default: written whole */
+				if (writes < full_writes)
+					reduced++;
+				if (a == b)
+					CHECK(writes < full_writes);
+				pairs++;
+			}
+		}
+	}
+	CHECK(pairs > 10);
+	CHECK(reduced * 2 > pairs);
+
+	/* the AF firmware has no reset: always written whole */
+	sensor_select(0x3008, 0x80);
+	for (k = 0; k < SENSOR_SUPPORTED_OUTPUTS && ov5640_profile.output_conf[k]; k++) {
+		const struct sensor_output* o = ov5640_profile.output_conf[k];
+		unsigned full_writes;
+
+		if (!o->type)
+			continue;
+		counters_clear();
+		sensor_pack_apply(o->output_packed, NULL, &ops);
+		full_writes = writes;
+		counters_clear();
+		CHECK(sensor_pack_apply(o->output_packed,
+				ov5640_profile.output_conf[0]->output_packed, &ops)
+		      == (int)full_writes);
+		CHECK(writes == full_writes);
+	}
+}
+
+int main(void)
+{
+	test_decoder();
+	test_sample_tables();
+	test_random_pairs();
+	test_write_error();
+	test_converted_tables();
+	test_profiles();
+	return host_test_end("sensor_pack");
+}
@@ -0,0 +1,215 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the lwIP event loop. Two fake interfaces have frames queued
+ * and the lwIP timeouts are stubbed; the test checks the per-interface
+ * budget, the round-robin, when the idle function is called and for how
+ * long, and the statistics.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "lwip/opt.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+
+#include "arch/sys_loop.h"
+
+#include "host_test.h"
+
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Local variables
+ *----------------------------------------------------------------------------*/
+
+/* Frames waiting on each fake interface, indexed by netif->num */
+static int queued[2];
+
+/* Per-call log of the budgets given to poll() */
+static struct {
+	int netif[16];
+	u16_t budget[16];
+	int count;
+} poll_log;
+
+static u32_t sleeptime;
+static u32_t idle_timeout;
+static int idle_calls;
+static int timeout_checks;
+
+/*----------------------------------------------------------------------------
+ *        Stubs
+ *----------------------------------------------------------------------------*/
+
+void sys_check_timeouts(void)
+{
+	timeout_checks++;
+}
+
+u32_t sys_timeouts_sleeptime(void)
+{
+	return sleeptime;
+}
+
+static u16_t fake_poll(struct netif *netif, u16_t budget)
+{
+	int n = queued[netif->num] < budget ? queued[netif->num] : budget;
+
+	if (poll_log.count < 16) {
+		poll_log.netif[poll_log.count] = netif->num;
+		poll_log.budget[poll_log.count] = budget;
+		poll_log.count++;
+	}
+	queued[netif->num] -= n;
+	return n;
+}
+
+static bool fake_pending(struct netif *netif)
+{
+	return queued[netif->num] > 0;
+}
+
+static void fake_idle(u32_t timeout)
+{
+	idle_calls++;
+	idle_timeout = timeout;
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+static struct netif netif_a, netif_b;
+
+static void setup(void)
+{
+	memset(&netif_a, 0, sizeof(netif_a));
+	memset(&netif_b, 0, sizeof(netif_b));
+	netif_a.num = 0;
+	netif_b.num = 1;
+	memset(queued, 0, sizeof(queued));
+	memset(&poll_log, 0, sizeof(poll_log));
+	sleeptime = 5;
+	idle_timeout = 0;
+	idle_calls = 0;
+	timeout_checks = 0;
+
+	sys_loop_init(fake_idle);
+	REQUIRE(sys_loop_add_netif(&netif_a, fake_poll, fake_pending) == ERR_OK);
+	REQUIRE(sys_loop_add_netif(&netif_b, fake_poll, fake_pending) == ERR_OK);
+}
+
+static void test_add_netif(void)
+{
+	struct netif netif;
+	int i;
+
+	sys_loop_init(fake_idle);
+	for (i = 0; i < SYS_LOOP_MAX_NETIF; i++)
+		CHECK(sys_loop_add_netif(&netif, fake_poll, fake_pending) == ERR_OK);
+	CHECK(sys_loop_add_netif(&netif, fake_poll, fake_pending) == ERR_MEM);
+
+	/* init forgets the registered interfaces */
+	sys_loop_init(fake_idle);
+	CHECK(sys_loop_add_netif(&netif, fake_poll, fake_pending) == ERR_OK);
+}
+
+static void test_budget(void)
+{
+	struct _sys_loop_stats stats;
+
+	setup();
+	queued[0] = 2 * SYS_LOOP_BUDGET + 8;
+	queued[1] = 3;
+	CHECK(sys_loop_pending());
+
+	/* netif_a uses all its budget: no sleep, but netif_b is served */
+	CHECK(sys_loop_run_once() == SYS_LOOP_BUDGET + 3);
+	CHECK(idle_calls == 0);
+	CHECK(queued[1] == 0);
+	CHECK(poll_log.count == 2);
+	CHECK(poll_log.netif[0] == 0 && poll_log.netif[1] == 1);
+	CHECK(poll_log.budget[0] == SYS_LOOP_BUDGET);
+	CHECK(poll_log.budget[1] == SYS_LOOP_BUDGET);
+	CHECK(timeout_checks == 1);
+	CHECK(sys_loop_pending());
+
+	CHECK(sys_loop_run_once() == SYS_LOOP_BUDGET);
+	CHECK(idle_calls == 0);
+
+	/* Last frames: the loop goes idle until the next timeout */
+	CHECK(sys_loop_run_once() == 8);
+	CHECK(idle_calls == 1 && idle_timeout == 5);
+	CHECK(!sys_loop_pending());
+	CHECK(timeout_checks == 3);
+
+	sys_loop_get_stats(&stats);
+	CHECK(stats.rounds == 3);
+	CHECK(stats.frames == 2 * SYS_LOOP_BUDGET + 11);
+	CHECK(stats.busy_rounds == 2);
+	CHECK(stats.idles == 1);
+}
+
+static void test_sleep(void)
+{
+	struct _sys_loop_stats stats;
+
+	setup();
+
+	/* No timeout pending: sleep is capped */
+	sleeptime = 0xffffffff;
+	CHECK(sys_loop_run_once() == 0);
+	CHECK(idle_calls == 1 && idle_timeout == SYS_LOOP_MAX_SLEEP);
+
+	/* A timeout is due now: do not sleep */
+	sleeptime = 0;
+	CHECK(sys_loop_run_once() == 0);
+	CHECK(idle_calls == 1);
+
+	/* Without idle function, the loop never sleeps */
+	sys_loop_init(NULL);
+	CHECK(sys_loop_add_netif(&netif_a, fake_poll, fake_pending) == ERR_OK);
+	sleeptime = 5;
+	CHECK(sys_loop_run_once() == 0);
+	CHECK(idle_calls == 1);
+	sys_loop_get_stats(&stats);
+	CHECK(stats.rounds == 1 && stats.idles == 0);
+}
+
+int main(void)
+{
+	test_add_netif();
+	test_budget();
+	test_sleep();
+	return host_test_end("sys_loop");
+}
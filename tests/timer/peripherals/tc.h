@@ -0,0 +1,68 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host stand-in for the TC driver header, implemented by the simulated
+ * Timer Counter of the test.
+ */
+
+#ifndef _TC_H_
+#define _TC_H_
+
+#include "chip.h"
+
+#include <stdint.h>
+
+#define TC_CMR_TCCLKS_Msk 0x7u
+#define TC_CMR_WAVSEL_UP  (0x0u << 13)
+#define TC_CMR_WAVE       (0x1u << 15)
+
+#define TC_SR_COVFS  (0x1u << 0)
+#define TC_IER_COVFS (0x1u << 0)
+#define TC_IER_CPAS  (0x1u << 2)
+#define TC_IDR_CPAS  (0x1u << 2)
+
+extern void tc_configure(Tc* tc, uint32_t channel, uint32_t mode);
+
+extern void tc_start(Tc* tc, uint32_t channel);
+
+extern void tc_enable_it(Tc* tc, uint32_t channel, uint32_t mask);
+
+extern void tc_disable_it(Tc* tc, uint32_t channel, uint32_t mask);
+
+extern uint32_t tc_get_status(Tc* tc, uint32_t channel);
+
+extern uint32_t tc_get_channel_freq(Tc* tc, uint32_t channel);
+
+extern void tc_set_ra_rb_rc(Tc* tc, uint32_t channel,
+		uint32_t* ra, uint32_t* rb, uint32_t* rc);
+
+extern uint32_t tc_get_cv(Tc* tc, uint32_t channel);
+
+#endif /* _TC_H_ */
@@ -0,0 +1,273 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the system timer across DVFS transitions. The simulated
+ * Timer Counter is a 32-bit counter clocked from MCK; the test moves it
+ * forward by hand and changes its frequency between the PRE and POST
+ * notifications, like dvfs_set_opp() does. Every tick must be counted
+ * once, at the frequency it was counted at, including the ticks counted
+ * while the clocks switch.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "chip.h"
+#include "peripherals/pmc.h"
+#include "peripherals/tc.h"
+#include "power/dvfs.h"
+#include "timer.h"
+
+#include "host_test.h"
+
+#include <stdint.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated Timer Counter
+ *----------------------------------------------------------------------------*/
+
+bool host_irq_enabled = true;
+
+static struct {
+	uint64_t ticks;     /* counted since tc_start() */
+	uint32_t overflows; /* overflows reported by tc_get_status() */
+	uint32_t freq;      /* channel frequency */
+	bool started;
+} tc_sim;
+
+static struct _dvfs_notifier* notifier;
+
+uint32_t get_tc_id_from_addr(const Tc* addr, uint8_t channel)
+{
+	(void)addr;
+	(void)channel;
+	return 0;
+}
+
+bool pmc_is_peripheral_enabled(uint32_t id)
+{
+	(void)id;
+	return true;
+}
+
+void pmc_configure_peripheral(uint32_t id, const struct _pmc_periph_cfg* cfg, bool enable)
+{
+	(void)id;
+	(void)cfg;
+	(void)enable;
+}
+
+void tc_configure(Tc* tc, uint32_t channel, uint32_t mode)
+{
+	(void)tc;
+	(void)channel;
+	CHECK(mode & TC_CMR_WAVE);
+	tc_sim.ticks = 0;
+	tc_sim.overflows = 0;
+	tc_sim.started = false;
+}
+
+void tc_start(Tc* tc, uint32_t channel)
+{
+	(void)tc;
+	(void)channel;
+	tc_sim.started = true;
+}
+
+void tc_enable_it(Tc* tc, uint32_t channel, uint32_t mask)
+{
+	(void)tc;
+	(void)channel;
+	(void)mask;
+}
+
+void tc_disable_it(Tc* tc, uint32_t channel, uint32_t mask)
+{
+	(void)tc;
+	(void)channel;
+	(void)mask;
+}
+
+/* COVFS is cleared on read: one overflow reported per read */
+uint32_t tc_get_status(Tc* tc, uint32_t channel)
+{
+	(void)tc;
+	(void)channel;
+	if ((tc_sim.ticks >> 32) > tc_sim.overflows) {
+		tc_sim.overflows++;
+		return TC_SR_COVFS;
+	}
+	return 0;
+}
+
+uint32_t tc_get_channel_freq(Tc* tc, uint32_t channel)
+{
+	(void)tc;
+	(void)channel;
+	return tc_sim.freq;
+}
+
+void tc_set_ra_rb_rc(Tc* tc, uint32_t channel,
+		uint32_t* ra, uint32_t* rb, uint32_t* rc)
+{
+	(void)tc;
+	(void)channel;
+	(void)ra;
+	(void)rb;
+	(void)rc;
+}
+
+uint32_t tc_get_cv(Tc* tc, uint32_t channel)
+{
+	(void)tc;
+	(void)channel;
+	return (uint32_t)tc_sim.ticks;
+}
+
+void dvfs_register_notifier(struct _dvfs_notifier* n)
+{
+	notifier = n;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+/* Count ticks, reading the timer at least once per half counter period so
+ * that no overflow is missed */
+static void run(uint64_t ticks)
+{
+	while (ticks) {
+		uint64_t step = ticks < (1ull << 31) ? ticks : (1ull << 31);
+
+		tc_sim.ticks += step;
+		ticks -= step;
+		(void)timer_get_us();
+	}
+}
+
+static int notify(enum _dvfs_event event)
+{
+	REQUIRE(notifier != NULL && notifier->fn != NULL);
+	return notifier->fn(event, NULL, notifier->arg);
+}
+
+/* Frequency change: switch_ticks are counted while the clocks switch */
+static void change_freq(uint32_t freq, uint64_t switch_ticks)
+{
+	CHECK(notify(DVFS_PRE_CHANGE) == 0);
+	tc_sim.ticks += switch_ticks;
+	tc_sim.freq = freq;
+	CHECK(notify(DVFS_POST_CHANGE) == 0);
+}
+
+static void setup(uint32_t freq)
+{
+	notifier = NULL;
+	tc_sim.freq = freq;
+	timer_configure(NULL, 0, 0);
+	CHECK(tc_sim.started);
+	CHECK(timer_get_us() == 0);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+/* Ticks are converted at the frequency they were counted at */
+static void test_freq_change(void)
+{
+	setup(12000000);
+	run(12000000);
+	CHECK(timer_get_us() == 1000000);
+	CHECK(timer_get_tick() == 1000);
+
+	/* 600 ticks at 6 MHz while switching */
+	change_freq(6000000, 600);
+	CHECK(timer_get_us() == 1000100);
+	run(6000000);
+	CHECK(timer_get_us() == 2000100);
+
+	/* Ticks counted between PRE and POST belong to the new frequency,
+	 * the ones before PRE to the old one */
+	run(3000);
+	change_freq(83000000, 8300);
+	CHECK(timer_get_us() == 2000100 + 500 + 100);
+	run(83000000ull * 3 + 41500);
+	CHECK(timer_get_us() == 5001200);
+	CHECK(timer_get_tick() == 5001);
+
+	/* Back and forth, without time going backwards */
+	change_freq(12000000, 0);
+	change_freq(166000000, 166);
+	CHECK(timer_get_us() == 5001200 + 1);
+	run(166);
+	CHECK(timer_get_us() == 5001200 + 2);
+}
+
+/* A refused transition leaves the frequency as it was */
+static void test_abort(void)
+{
+	setup(1000000);
+	run(2500);
+	CHECK(notify(DVFS_PRE_CHANGE) == 0);
+	run(500);
+	CHECK(notify(DVFS_ABORT_CHANGE) == 0);
+	CHECK(timer_get_us() == 3000);
+	run(1000000);
+	CHECK(timer_get_us() == 1003000);
+}
+
+/* The 32-bit counter overflows every few seconds at MCK rates, across
+ * frequency changes too */
+static void test_overflow(void)
+{
+	uint64_t us;
+
+	setup(100000000);
+	run(0xfffff000u);
+	us = timer_get_us();
+	CHECK(us == 0xfffff000ull / 100);
+	change_freq(50000000, 0x2000);
+	CHECK(tc_sim.overflows == 1);
+	CHECK(timer_get_us() == us + 0x2000 / 50);
+	run(50000000ull * 600);
+	CHECK(timer_get_us() == us + 0x2000 / 50 + 600000000);
+	CHECK(tc_sim.overflows == (tc_sim.ticks >> 32));
+}
+
+int main(void)
+{
+	test_freq_change();
+	test_abort();
+	test_overflow();
+	return host_test_end("timer");
+}
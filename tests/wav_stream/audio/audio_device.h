@@ -0,0 +1,59 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host stand-in for the audio device API, implemented by the test as a
+ * device transferring one block at a time at the sample rate.
+ */
+
+#ifndef _AUDIO_DEVICE_H_
+#define _AUDIO_DEVICE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "callback.h"
+
+enum audio_device_direction {
+	AUDIO_DEVICE_PLAY,
+	AUDIO_DEVICE_RECORD,
+};
+
+struct _audio_desc {
+	enum audio_device_direction direction;
+	uint32_t sample_rate;
+	uint16_t num_channels;
+	uint16_t bits_per_sample;
+};
+
+extern void audio_stop(struct _audio_desc *desc);
+
+extern void audio_transfer(struct _audio_desc *desc, void *buffer, uint32_t size, struct _callback* cb);
+
+#endif /* _AUDIO_DEVICE_H_ */
@@ -0,0 +1,652 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/*
+ * Host test of the Wav streaming player and recorder, with the FatFs of the
+ * package over a RAM disk whose accesses take simulated time, including
+ * periodic card stalls. The simulated audio device transfers one block per
+ * block duration and runs the completion callbacks as interrupts, also in
+ * the middle of the disk accesses. Recorded samples are a counter, so that
+ * the files and the played data can be checked sample by sample.
+ */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include "audio/audio_device.h"
+#include "diskio.h"
+#include "ff.h"
+#include "wav.h"
+#include "wav_stream.h"
+
+#include "host_test.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*----------------------------------------------------------------------------
+ *        Simulated audio device
+ *----------------------------------------------------------------------------*/
+
+static uint64_t now_ns;
+
+static struct {
+	struct _audio_desc* desc;
+	const uint8_t* scratch;  /* scratch block of the stream */
+	bool running;
+	bool pending;
+	uint8_t* buffer;
+	uint32_t size;
+	struct _callback cb;
+	uint64_t end;
+	uint32_t errors;         /* overlapping transfers */
+
+	uint32_t counter;        /* next recorded sample */
+
+	uint8_t* played;         /* played data, without the silence */
+	uint32_t played_len;
+	uint32_t played_max;
+	uint32_t silence;        /* scratch blocks played */
+	uint32_t noise;          /* non-zero scratch blocks played */
+} audio;
+
+static void audio_init(struct _audio_desc* desc, const uint8_t* scratch)
+{
+	uint8_t* played = audio.played;
+	uint32_t played_max = audio.played_max;
+
+	memset(&audio, 0, sizeof(audio));
+	audio.desc = desc;
+	audio.scratch = scratch;
+	audio.played = played;
+	audio.played_max = played_max;
+}
+
+static uint64_t block_ns(uint32_t size)
+{
+	const struct _audio_desc* desc = audio.desc;
+
+	return (uint64_t)size * 1000000000ull /
+		(desc->sample_rate * desc->num_channels * (desc->bits_per_sample / 8));
+}
+
+static void audio_complete(void)
+{
+	struct _callback cb = audio.cb;
+	uint32_t i;
+
+	audio.pending = false;
+	if (audio.desc->direction == AUDIO_DEVICE_RECORD) {
+		for (i = 0; i < audio.size / (audio.desc->bits_per_sample / 8); i++) {
+			if (audio.desc->bits_per_sample == 32) {
+				uint32_t slot = (audio.counter++ & 0xffffff) << 8;
+				memcpy(audio.buffer + 4 * i, &slot, 4);
+			} else {
+				uint16_t slot = audio.counter++;
+				memcpy(audio.buffer + 2 * i, &slot, 2);
+			}
+		}
+	} else if (audio.buffer == audio.scratch) {
+		audio.silence++;
+		for (i = 0; i < audio.size; i++)
+			if (audio.buffer[i]) {
+				audio.noise++;
+				break;
+			}
+	} else {
+		REQUIRE(audio.played_len + audio.size <= audio.played_max);
+		memcpy(audio.played + audio.played_len, audio.buffer, audio.size);
+		audio.played_len += audio.size;
+	}
+
+	callback_call(&cb, NULL);
+	if (!audio.pending)
+		audio.running = false;
+}
+
+/* Advance the clock, running the transfer completion interrupts */
+static void advance(uint64_t ns)
+{
+	now_ns += ns;
+	while (audio.pending && now_ns >= audio.end)
+		audio_complete();
+}
+
+void audio_transfer(struct _audio_desc *desc, void *buffer, uint32_t size, struct _callback* cb)
+{
+	if (audio.pending)
+		audio.errors++;
+	audio.end = (audio.running ? audio.end : now_ns) + block_ns(size);
+	audio.running = true;
+	audio.pending = true;
+	audio.buffer = buffer;
+	audio.size = size;
+	audio.cb = *cb;
+}
+
+void audio_stop(struct _audio_desc *desc)
+{
+	audio.pending = false;
+	audio.running = false;
+}
+
+/*----------------------------------------------------------------------------
+ *        RAM disk
+ *----------------------------------------------------------------------------*/
+
+#define SECTORS (128u * 1024)  /* 64 MiB */
+
+static struct {
+	uint8_t* data;
+	uint64_t latency_ns;
+	uint64_t sector_ns;
+	uint32_t stall_every;   /* accesses between two stalls, 0 for none */
+	uint64_t stall_ns;
+	uint32_t accesses;
+} disk;
+
+static void disk_timing(uint64_t latency_us, uint32_t stall_every, uint64_t stall_us)
+{
+	disk.latency_ns = latency_us * 1000;
+	disk.sector_ns = 2000;
+	disk.stall_every = stall_every;
+	disk.stall_ns = stall_us * 1000;
+	disk.accesses = 0;
+}
+
+static void disk_access(UINT count)
+{
+	uint64_t ns = disk.latency_ns + disk.sector_ns * count;
+
+	if (disk.stall_every && ++disk.accesses % disk.stall_every == 0)
+		ns += disk.stall_ns;
+	advance(ns);
+}
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+	return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+	return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+	if (sector + count > SECTORS)
+		return RES_PARERR;
+	memcpy(buff, disk.data + (size_t)sector * 512, count * 512);
+	disk_access(count);
+	return RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+	if (sector + count > SECTORS)
+		return RES_PARERR;
+	memcpy(disk.data + (size_t)sector * 512, buff, count * 512);
+	disk_access(count);
+	return RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
+{
+	switch (cmd) {
+	case GET_SECTOR_COUNT:
+		*(DWORD*)buff = SECTORS;
+		break;
+	case GET_SECTOR_SIZE:
+		*(WORD*)buff = 512;
+		break;
+	case GET_BLOCK_SIZE:
+		*(DWORD*)buff = 1;
+		break;
+	}
+	return RES_OK;
+}
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+#define BLOCKS 8
+#define BLOCK_SIZE 8192
+
+static FATFS fs;
+static uint32_t poll_max_blocks; /* most blocks moved by a poll */
+static uint8_t ring[(BLOCKS + 1) * BLOCK_SIZE] __attribute__((aligned(32)));
+
+/*
+ * FatFs R0.12 reads one byte past the end of the paths it parses: pass them
+ * in zero-padded buffers
+ */
+static const char* fname(const char* name)
+{
+	static char paths[4][32];
+	static int next;
+	char* path = paths[next++ % 4];
+
+	memset(path, 0, sizeof(paths[0]));
+	strncpy(path, name, sizeof(paths[0]) - 2);
+	return path;
+}
+
+static int poll(struct _wav_stream* stream)
+{
+	uint32_t count = stream->fs_count;
+	int err = wav_stream_poll(stream);
+
+	if (stream->fs_count - count > poll_max_blocks)
+		poll_max_blocks = stream->fs_count - count;
+	return err;
+}
+
+static uint8_t* read_file(const char* path, uint32_t* size)
+{
+	FIL file;
+	UINT br;
+	uint8_t* data;
+
+	REQUIRE(f_open(&file, fname(path), FA_READ) == FR_OK);
+	*size = f_size(&file);
+	data = malloc(*size + 1);
+	REQUIRE(data);
+	REQUIRE(f_read(&file, data, *size, &br) == FR_OK && br == *size);
+	f_close(&file);
+	return data;
+}
+
+static void write_file(const char* path, const void* data, uint32_t size)
+{
+	FIL file;
+	UINT bw;
+
+	REQUIRE(f_open(&file, fname(path), FA_WRITE | FA_CREATE_ALWAYS) == FR_OK);
+	REQUIRE(f_write(&file, data, size, &bw) == FR_OK && bw == size);
+	REQUIRE(f_close(&file) == FR_OK);
+}
+
+/* Sample i of the data of a file, as an audio slot */
+static uint32_t file_slot(const uint8_t* data, uint32_t i, uint16_t bits)
+{
+	if (bits == 24)
+		return (data[3 * i] << 8) | (data[3 * i + 1] << 16) |
+			((uint32_t)data[3 * i + 2] << 24);
+	return data[2 * i] | (data[2 * i + 1] << 8);
+}
+
+static uint32_t played_slot(uint32_t i, uint16_t slot_bits)
+{
+	uint32_t slot = 0;
+
+	memcpy(&slot, audio.played + i * slot_bits / 8, slot_bits / 8);
+	return slot;
+}
+
+/* Record for a duration (ms), polling every 50 us */
+static int record(const char* path, struct _audio_desc* desc, uint16_t bits,
+		uint32_t block_size, uint32_t duration, struct _wav_stream_stats* stats)
+{
+	static struct _wav_stream stream;
+	uint64_t end;
+	int err;
+
+	audio_init(desc, ring + BLOCKS * block_size);
+	REQUIRE(wav_stream_open_record(&stream, desc, fname(path), bits, ring, block_size, BLOCKS) == 0);
+	REQUIRE(wav_stream_start(&stream) == 0);
+	CHECK(wav_stream_start(&stream) == -EBUSY);
+
+	end = now_ns + duration * 1000000ull;
+	err = 0;
+	poll_max_blocks = 0;
+	while (now_ns < end && !err) {
+		err = poll(&stream);
+		advance(50000);
+	}
+	CHECK(wav_stream_stop(&stream) == 0);
+	wav_stream_get_stats(&stream, stats);
+	CHECK(audio.errors == 0);
+	return err;
+}
+
+/* Play a file to the end, polling every 50 us */
+static int play(const char* path, struct _audio_desc* desc, uint32_t block_size,
+		struct _wav_stream_stats* stats)
+{
+	static struct _wav_stream stream;
+	int err;
+
+	/* leftovers of a recording in the scratch block */
+	memset(ring + BLOCKS * block_size, 0xa5, block_size);
+	audio_init(desc, ring + BLOCKS * block_size);
+	err = wav_stream_open_play(&stream, desc, fname(path), ring, block_size, BLOCKS);
+	if (err)
+		return err;
+	REQUIRE(wav_stream_start(&stream) == 0);
+
+	poll_max_blocks = 0;
+	while (!wav_stream_is_done(&stream) && !err) {
+		err = poll(&stream);
+		advance(50000);
+	}
+	CHECK(!audio.pending);
+	CHECK(wav_stream_stop(&stream) == 0);
+	wav_stream_get_stats(&stream, stats);
+	CHECK(audio.errors == 0);
+	CHECK(audio.noise == 0);
+	return err;
+}
+
+/* Check the played data against the samples of a file */
+static void check_played(const uint8_t* data, uint32_t data_size, uint16_t bits,
+		uint16_t slot_bits, uint32_t block_size)
+{
+	uint32_t samples = data_size / (bits / 8);
+	uint32_t i, bad = 0;
+
+	/* the last block is padded with silence */
+	CHECK(audio.played_len == (samples * slot_bits / 8 + block_size - 1) / block_size * block_size);
+	for (i = 0; i < samples; i++)
+		if (played_slot(i, slot_bits) != file_slot(data, i, bits))
+			bad++;
+	for (; i < audio.played_len / (slot_bits / 8); i++)
+		if (played_slot(i, slot_bits) != 0)
+			bad++;
+	CHECK(bad == 0);
+}
+
+/*----------------------------------------------------------------------------
+ *        Tests
+ *----------------------------------------------------------------------------*/
+
+/* 8 channels at 48 kHz, 24 bits, with 20 ms card stalls */
+static void test_24bit(void)
+{
+	struct _audio_desc desc = { AUDIO_DEVICE_RECORD, 48000, 8, 32 };
+	struct _wav_stream_stats stats;
+	struct _wav_header header;
+	uint32_t size, samples, i, bad;
+	uint8_t* data;
+
+	disk_timing(300, 200, 20000);
+	CHECK(record("rec24.wav", &desc, 24, BLOCK_SIZE, 10000, &stats) == 0);
+	CHECK(stats.xruns == 0);
+	CHECK(stats.min_margin >= 2);
+	CHECK(stats.blocks >= 10000000 / 5334 - 1);
+
+	data = read_file("rec24.wav", &size);
+	memcpy(&header, data, sizeof(header));
+	CHECK(wav_is_valid(&header));
+	CHECK(header.audio_format == WAV_FORMAT_PCM);
+	CHECK(header.num_channels == 8 && header.sample_rate == 48000);
+	CHECK(header.bits_per_sample == 24 && header.block_align == 24);
+	CHECK(header.byte_rate == 48000 * 24);
+	CHECK(header.subchunk2_id == WAV_DATAID);
+	CHECK(header.subchunk2_size == stats.blocks * BLOCK_SIZE / 4 * 3);
+	CHECK(header.chunk_size == size - 8);
+	CHECK(size == sizeof(header) + header.subchunk2_size);
+
+	samples = header.subchunk2_size / 3;
+	for (i = 0, bad = 0; i < samples; i++)
+		if (file_slot(data + sizeof(header), i, 24) != (i & 0xffffff) << 8)
+			bad++;
+	CHECK(bad == 0);
+
+	/* play it back, the format comes from the file */
+	memset(&desc, 0, sizeof(desc));
+	desc.direction = AUDIO_DEVICE_PLAY;
+	CHECK(play("rec24.wav", &desc, BLOCK_SIZE, &stats) == 0);
+	CHECK(desc.sample_rate == 48000 && desc.num_channels == 8);
+	CHECK(desc.bits_per_sample == 32);
+	CHECK(stats.xruns == 0 && audio.silence == 0);
+	CHECK(stats.min_margin >= 2);
+	check_played(data + sizeof(header), header.subchunk2_size, 24, 32, BLOCK_SIZE);
+	free(data);
+}
+
+/* Stereo 16 bits, data ending in the middle of a block */
+static void test_16bit(void)
+{
+	struct _audio_desc desc = { AUDIO_DEVICE_RECORD, 44100, 2, 16 };
+	struct _wav_stream_stats stats;
+	struct _wav_header header;
+	uint32_t size, i, bad;
+	uint8_t* data;
+
+	disk_timing(300, 0, 0);
+	CHECK(record("rec16.wav", &desc, 16, 4096, 500, &stats) == 0);
+	CHECK(stats.xruns == 0);
+
+	data = read_file("rec16.wav", &size);
+	memcpy(&header, data, sizeof(header));
+	CHECK(header.bits_per_sample == 16 && header.block_align == 4);
+	CHECK(header.subchunk2_size == stats.blocks * 4096);
+	for (i = 0, bad = 0; i < header.subchunk2_size / 2; i++)
+		if (file_slot(data + sizeof(header), i, 16) != (i & 0xffff))
+			bad++;
+	CHECK(bad == 0);
+
+	/* truncate to 1001 frames and a half */
+	header.subchunk2_size = 1001 * 4 + 2;
+	header.chunk_size = sizeof(header) - 8 + header.subchunk2_size;
+	memcpy(data, &header, sizeof(header));
+	write_file("short16.wav", data, sizeof(header) + header.subchunk2_size);
+
+	memset(&desc, 0, sizeof(desc));
+	desc.direction = AUDIO_DEVICE_PLAY;
+	CHECK(play("short16.wav", &desc, 4096, &stats) == 0);
+	CHECK(desc.bits_per_sample == 16 && desc.num_channels == 2);
+	CHECK(stats.blocks == 1001 * 4 / 4096 + 1);
+	check_played(data + sizeof(header), 1001 * 4, 16, 16, 4096);
+	free(data);
+}
+
+/* A card too slow for the stream: counted xruns, no data lost or reordered */
+static void test_xruns(void)
+{
+	struct _audio_desc desc = { AUDIO_DEVICE_PLAY };
+	struct _wav_stream_stats stats;
+	struct _wav_header header;
+	uint32_t size, samples_per_block, i, k, bad;
+	uint8_t* data;
+
+	data = read_file("rec24.wav", &size);
+	memcpy(&header, data, sizeof(header));
+
+	disk_timing(3000, 50, 200000);
+	CHECK(play("rec24.wav", &desc, BLOCK_SIZE, &stats) == 0);
+	CHECK(stats.xruns > 0 && stats.xruns == audio.silence);
+	CHECK(stats.min_margin == 0);
+	/* the main loop is not held by the card */
+	CHECK(poll_max_blocks <= BLOCKS);
+	check_played(data + sizeof(header), header.subchunk2_size, 24, 32, BLOCK_SIZE);
+	free(data);
+
+	/* recording drops whole blocks */
+	desc.direction = AUDIO_DEVICE_RECORD;
+	desc.sample_rate = 48000;
+	desc.num_channels = 8;
+	desc.bits_per_sample = 32;
+	CHECK(record("slow.wav", &desc, 24, BLOCK_SIZE, 2000, &stats) == 0);
+	CHECK(stats.xruns > 0);
+	CHECK(poll_max_blocks <= BLOCKS);
+
+	data = read_file("slow.wav", &size);
+	memcpy(&header, data, sizeof(header));
+	CHECK(header.subchunk2_size == stats.blocks * BLOCK_SIZE / 4 * 3);
+	samples_per_block = BLOCK_SIZE / 4;
+	bad = 0;
+	k = 0;
+	for (i = 0; i < header.subchunk2_size / 3; i++) {
+		uint32_t slot = file_slot(data + sizeof(header), i, 24) >> 8;
+
+		if (i % samples_per_block == 0) {
+			/* a block starts after the last one or the dropped ones */
+			if (slot < k || slot % samples_per_block)
+				bad++;
+			k = slot;
+		} else if (slot != ++k) {
+			bad++;
+		}
+	}
+	CHECK(bad == 0);
+	CHECK(k / samples_per_block + 1 <= stats.blocks + stats.xruns);
+	CHECK(k / samples_per_block + 1 >= stats.blocks + stats.xruns - 1);
+	free(data);
+	disk_timing(300, 0, 0);
+}
+
+/* RIFF chunks around the format and data, extensible format, streamed file */
+static void test_parse(void)
+{
+	static const uint8_t list[] = { 'L', 'I', 'S', 'T', 3, 0, 0, 0, 'a', 'b', 'c', 0 };
+	struct _audio_desc desc = { AUDIO_DEVICE_PLAY };
+	struct _wav_stream_stats stats;
+	struct _wav_header header;
+	uint8_t file[4096], samples[1001];
+	uint8_t* p = file;
+	uint32_t u32, i;
+	uint16_t u16;
+	struct _wav_stream stream;
+
+	for (i = 0; i < sizeof(samples); i++)
+		samples[i] = i * 7;
+
+	/* RIFF, LIST, 40-byte extensible fmt, data with an unknown size */
+	wav_init_header(&header, 8000, 2, 16, 0);
+	memcpy(p, &header, 12);
+	p += 12;
+	memcpy(p, list, sizeof(list));
+	p += sizeof(list);
+	memcpy(p, "fmt ", 4);
+	u32 = 40;
+	memcpy(p + 4, &u32, 4);
+	memcpy(p + 8, &header.audio_format, 16);
+	u16 = WAV_FORMAT_EXTENSIBLE;
+	memcpy(p + 8, &u16, 2);
+	memset(p + 24, 0x55, 24);
+	p += 48;
+	memcpy(p, "data", 4);
+	u32 = 0xffffffff;
+	memcpy(p + 4, &u32, 4);
+	p += 8;
+	memcpy(p, samples, sizeof(samples));
+	p += sizeof(samples);
+	write_file("chunks.wav", file, p - file);
+
+	CHECK(play("chunks.wav", &desc, 512, &stats) == 0);
+	CHECK(desc.sample_rate == 8000 && desc.num_channels == 2 && desc.bits_per_sample == 16);
+	/* the trailing partial frame is dropped */
+	check_played(samples, 1000, 16, 16, 512);
+
+	/* unsupported audio format */
+	u16 = 3;
+	memcpy(file + 12 + sizeof(list) + 8, &u16, 2);
+	write_file("float.wav", file, p - file);
+	CHECK(play("float.wav", &desc, 512, &stats) == -EINVAL);
+
+	/* no fmt chunk */
+	write_file("nofmt.wav", file, 12);
+	CHECK(play("nofmt.wav", &desc, 512, &stats) == -EINVAL);
+
+	/* not a RIFF file */
+	memcpy(file, "RIFX", 4);
+	write_file("rifx.wav", file, p - file);
+	CHECK(play("rifx.wav", &desc, 512, &stats) == -EINVAL);
+
+	CHECK(play("missing.wav", &desc, 512, &stats) == -ENOENT);
+
+	/* block size not a multiple of the frame slots, too few blocks */
+	CHECK(wav_stream_open_play(&stream, &desc, fname("chunks.wav"), ring, 510, BLOCKS) == -EINVAL);
+	CHECK(wav_stream_open_play(&stream, &desc, fname("chunks.wav"), ring, 512, 1) == -EINVAL);
+	desc.direction = AUDIO_DEVICE_RECORD;
+	desc.bits_per_sample = 32;
+	CHECK(wav_stream_open_record(&stream, &desc, fname("bad.wav"), 16, ring, 512, BLOCKS) == -EINVAL);
+	desc.bits_per_sample = 24;
+	CHECK(wav_stream_open_record(&stream, &desc, fname("bad.wav"), 24, ring, 512, BLOCKS) == -EINVAL);
+
+	/* empty data: done as soon as started */
+	wav_init_header(&header, 8000, 2, 16, 0);
+	write_file("empty.wav", &header, sizeof(header));
+	desc.direction = AUDIO_DEVICE_PLAY;
+	CHECK(play("empty.wav", &desc, 512, &stats) == 0);
+	CHECK(stats.blocks == 0 && audio.played_len == 0 && audio.silence == 0);
+}
+
+/* A recording reaching the maximum Wav data size */
+static void test_efbig(void)
+{
+	struct _audio_desc desc = { AUDIO_DEVICE_RECORD, 48000, 2, 16 };
+	static struct _wav_stream stream;
+	uint32_t max = 0xffffffffu - sizeof(struct _wav_header) + 8;
+	uint64_t end = now_ns + 1000000000ull;
+	int err = 0;
+
+	audio_init(&desc, ring + BLOCKS * 4096);
+	REQUIRE(wav_stream_open_record(&stream, &desc, fname("big.wav"), 16, ring, 4096, BLOCKS) == 0);
+	REQUIRE(wav_stream_start(&stream) == 0);
+	stream.data_size = max - 3 * 4096 - 100;
+
+	while (!err && now_ns < end) {
+		err = wav_stream_poll(&stream);
+		advance(50000);
+	}
+	CHECK(err == -EFBIG);
+	CHECK(stream.data_size == max - 100);
+	CHECK(wav_stream_stop(&stream) == 0);
+	CHECK(stream.header.chunk_size == 0xffffffffu - 100);
+	CHECK(stream.header.subchunk2_size == max - 100);
+}
+
+int main(void)
+{
+	audio.played_max = 64 << 20;
+	audio.played = malloc(audio.played_max);
+	disk.data = calloc(SECTORS, 512);
+	REQUIRE(audio.played && disk.data);
+
+	REQUIRE(f_mount(&fs, "", 0) == FR_OK);
+	REQUIRE(f_mkfs("", 1, 0) == FR_OK);
+	REQUIRE(f_mount(&fs, "", 1) == FR_OK);
+
+	test_24bit();
+	test_16bit();
+	test_xruns();
+	test_parse();
+	test_efbig();
+
+	free(audio.played);
+	free(disk.data);
+	return host_test_end("wav_stream");
+}
@@ -73,6 +73,16 @@ static inline uint32_t max_u32(uint32_t a, uint32_t b)
 	return a > b ? a : b;
 }
 
+/**
+ *  Returns the minimum value between two 64-bit integers.
+ *  \param a First integer to compare
+ *  \param b Second integer to compare
+ */
+static inline uint64_t min_u64(uint64_t a, uint64_t b)
+{
+	return a < b ? a : b;
+}
+
 /**
  *  Returns the absolute value of an integer.
  *  \param value Integer value
@@ -36,6 +36,9 @@
 #include "irq/irq.h"
 #include "peripherals/pmc.h"
 #include "peripherals/tc.h"
+#ifdef CONFIG_HAVE_DVFS
+#include "power/dvfs.h"
+#endif
 #include "timer.h"
 
 /*----------------------------------------------------------------------------
@@ -47,6 +50,11 @@ struct _timer {
 	uint8_t channel;
 	uint32_t channel_freq;
 	volatile uint32_t upper;
+#ifdef CONFIG_HAVE_DVFS
+	uint64_t base;    /**< TC count when channel_freq was last changed */
+	uint64_t base_us; /**< time (us) when channel_freq was last changed */
+	struct _dvfs_notifier dvfs;
+#endif
 };
 
 /*----------------------------------------------------------------------------
@@ -80,6 +88,8 @@ static uint32_t timer_get_upper_tick_counter(void)
  */
 static void timer_irq_handler(uint32_t source, void* user_arg)
 {
+	/* alarms are one-shot */
+	tc_disable_it(_timer.tc, _timer.channel, TC_IDR_CPAS);
 	timer_update_upper_tick_counter();
 }
 
@@ -97,6 +107,57 @@ static uint64_t _timer_get_tick(void)
 	return (((uint64_t)upper) << TC_CHANNEL_SIZE) | lower;
 }
 
+#ifdef CONFIG_HAVE_DVFS
+
+static uint64_t _timer_ticks_to_us(uint64_t count)
+{
+	/* split to avoid overflowing the multiplication */
+	return (count / _timer.channel_freq) * 1000000 +
+		((count % _timer.channel_freq) * 1000000) / _timer.channel_freq;
+}
+
+static uint64_t _timer_get_us(void)
+{
+	return _timer.base_us + _timer_ticks_to_us(_timer_get_tick() - _timer.base);
+}
+
+/**
+ * \brief Add the ticks counted since the base to the base time, at the
+ * current channel frequency, and restart from there.
+ */
+static void _timer_rebase(void)
+{
+	uint64_t tick = _timer_get_tick();
+
+	_timer.base_us += _timer_ticks_to_us(tick - _timer.base);
+	_timer.base = tick;
+}
+
+/**
+ * \brief DVFS notifier: the TC clock may be derived from MCK, count the
+ * elapsed time at the old frequency before it changes and restart from
+ * there at the new frequency. Ticks counted while switching clocks are
+ * converted at the new frequency.
+ */
+static int _timer_dvfs_notifier(enum _dvfs_event event,
+		const struct _dvfs_transition* transition, void* arg)
+{
+	switch (event) {
+	case DVFS_PRE_CHANGE:
+		_timer_rebase();
+		break;
+	case DVFS_POST_CHANGE:
+		_timer.channel_freq = tc_get_channel_freq(_timer.tc, _timer.channel);
+		_timer_rebase();
+		break;
+	default:
+		break;
+	}
+	return 0;
+}
+
+#endif /* CONFIG_HAVE_DVFS */
+
 /*----------------------------------------------------------------------------
  *         Exported Functions
  *----------------------------------------------------------------------------*/
@@ -114,6 +175,12 @@ void timer_configure(Tc* tc, uint8_t channel, uint32_t clock_source)
 	tc_configure(tc, channel, TC_CMR_WAVE | TC_CMR_WAVSEL_UP |
 			(clock_source & TC_CMR_TCCLKS_Msk));
 	_timer.channel_freq = tc_get_channel_freq(tc, channel);
+#ifdef CONFIG_HAVE_DVFS
+	_timer.base = 0;
+	_timer.base_us = 0;
+	_timer.dvfs.fn = _timer_dvfs_notifier;
+	dvfs_register_notifier(&_timer.dvfs);
+#endif
 #ifndef CONFIG_TIMER_POLLING
 	irq_add_handler(tc_id, timer_irq_handler, &_timer);
 	irq_enable(tc_id);
@@ -154,7 +221,41 @@ void timer_sleep(uint64_t count)
 
 uint64_t timer_get_tick(void)
 {
+#ifdef CONFIG_HAVE_DVFS
+	return _timer_get_us() / 1000;
+#else
 	return (_timer_get_tick() * 1000) / _timer.channel_freq;
+#endif
+}
+
+uint64_t timer_get_us(void)
+{
+#ifdef CONFIG_HAVE_DVFS
+	return _timer_get_us();
+#else
+	return (_timer_get_tick() * 1000000) / _timer.channel_freq;
+#endif
+}
+
+void timer_set_alarm(uint64_t tick)
+{
+#ifndef CONFIG_TIMER_POLLING
+#ifdef CONFIG_HAVE_DVFS
+	uint64_t us = tick * 1000;
+	uint32_t ra;
+
+	if (us < _timer.base_us)
+		us = _timer.base_us;
+	us -= _timer.base_us;
+	ra = (uint32_t)(_timer.base + (us * _timer.channel_freq) / 1000000);
+#else
+	uint32_t ra = (uint32_t)((tick * _timer.channel_freq) / 1000);
+#endif
+
+	/* RA compare interrupt, disabled again by the timer interrupt handler */
+	tc_set_ra_rb_rc(_timer.tc, _timer.channel, &ra, NULL, NULL);
+	tc_enable_it(_timer.tc, _timer.channel, TC_IER_CPAS);
+#endif
 }
 
 void sleep(uint32_t count)
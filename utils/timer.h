@@ -105,6 +105,25 @@ extern uint64_t timer_get_interval(uint64_t start, uint64_t end);
  */
 extern uint64_t timer_get_tick(void);
 
+/**
+ * \brief Returns the time elapsed since the timer was configured, in
+ * microseconds
+ */
+extern uint64_t timer_get_us(void);
+
+/**
+ * \brief Request a timer interrupt at the given tick, to wake up the CPU
+ * from cpu_idle().
+ *
+ * The alarm is one-shot and is cancelled by any timer interrupt. Only the
+ * lower bits of the TC counter are compared: a tick further than one TC
+ * counter period away wakes the CPU up early, as does the counter overflow
+ * interrupt. Does nothing if CONFIG_TIMER_POLLING is defined.
+ *
+ * \param tick Tick (millisecond) at which to wake up.
+ */
+extern void timer_set_alarm(uint64_t tick);
+
 /**
  *  \brief Wait for at least count seconds.
  */
@@ -37,19 +37,6 @@
 
 #include "wav.h"
 
-/*----------------------------------------------------------------------------
- *        Definitions
- *----------------------------------------------------------------------------*/
-
-/** WAV letters "RIFF" */
-#define WAV_CHUNKID       0x46464952
-
-/** WAV letters "WAVE"*/
-#define WAV_FORMAT        0x45564157
-
-/** WAV letters "fmt "*/
-#define WAV_SUBCHUNKID    0x20746D66
-
 /*----------------------------------------------------------------------------
  *        Exported functions
  *----------------------------------------------------------------------------*/
@@ -67,6 +54,36 @@ bool wav_is_valid(const struct _wav_header *header)
 			&& header->subchunk1_size == 0x10);
 }
 
+/**
+ * \brief Fill the header of a PCM Wav file.
+ *
+ * \param header Wav header information.
+ * \param sample_rate Sample rate (Hz).
+ * \param num_channels Number of channels.
+ * \param bits_per_sample Bits per sample (8, 16, 24 or 32).
+ * \param data_size Size of the audio data in bytes.
+ */
+void wav_init_header(struct _wav_header *header, uint32_t sample_rate,
+		uint16_t num_channels, uint16_t bits_per_sample,
+		uint32_t data_size)
+{
+	uint16_t block_align = num_channels * ((bits_per_sample + 7) / 8);
+
+	header->chunk_id = WAV_CHUNKID;
+	header->chunk_size = sizeof(*header) - 8 + data_size;
+	header->format = WAV_FORMAT;
+	header->subchunk1_id = WAV_SUBCHUNKID;
+	header->subchunk1_size = 0x10;
+	header->audio_format = WAV_FORMAT_PCM;
+	header->num_channels = num_channels;
+	header->sample_rate = sample_rate;
+	header->byte_rate = sample_rate * block_align;
+	header->block_align = block_align;
+	header->bits_per_sample = bits_per_sample;
+	header->subchunk2_id = WAV_DATAID;
+	header->subchunk2_size = data_size;
+}
+
 /**
  * \brief Display the information of the WAV file (sample rate, stereo/mono
  * and frame size).
@@ -37,6 +37,28 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** WAV letters "RIFF" */
+#define WAV_CHUNKID       0x46464952
+
+/** WAV letters "WAVE"*/
+#define WAV_FORMAT        0x45564157
+
+/** WAV letters "fmt "*/
+#define WAV_SUBCHUNKID    0x20746D66
+
+/** WAV letters "data"*/
+#define WAV_DATAID        0x61746164
+
+/** WAV PCM audio format */
+#define WAV_FORMAT_PCM    1
+
+/** WAV extensible audio format (PCM with more than 2 channels or 16 bits) */
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
 /*----------------------------------------------------------------------------
  *        Types
  *----------------------------------------------------------------------------*/
@@ -77,6 +99,10 @@ struct _wav_header {
 
 extern bool wav_is_valid(const struct _wav_header *header);
 
+extern void wav_init_header(struct _wav_header *header, uint32_t sample_rate,
+		uint16_t num_channels, uint16_t bits_per_sample,
+		uint32_t data_size);
+
 extern void wav_display_info(const struct _wav_header *header);
 
 #endif /* #ifndef WAV_H */
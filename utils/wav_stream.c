@@ -0,0 +1,470 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/** \file */
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "callback.h"
+#include "compiler.h"
+#include "wav_stream.h"
+
+/*----------------------------------------------------------------------------
+ *        Definitions
+ *----------------------------------------------------------------------------*/
+
+/** Largest data chunk of a Wav file */
+#define WAV_STREAM_MAX_DATA (0xFFFFFFFFu - sizeof(struct _wav_header) + 8)
+
+/*----------------------------------------------------------------------------
+ *        Local functions
+ *----------------------------------------------------------------------------*/
+
+static uint8_t* _wav_stream_block(struct _wav_stream* stream, uint32_t count)
+{
+	return stream->buffer + (count % stream->blocks) * stream->block_size;
+}
+
+static uint8_t* _wav_stream_scratch(struct _wav_stream* stream)
+{
+	return stream->buffer + stream->blocks * stream->block_size;
+}
+
+/** Bytes of file data for a full block */
+static uint32_t _wav_stream_file_block_size(struct _wav_stream* stream)
+{
+	return stream->block_size / stream->slot_bytes * stream->sample_bytes;
+}
+
+/**
+ * \brief Expand packed 24-bit samples, read at the end of the block, to
+ * MSB-aligned 32-bit slots. Forward order is safe: the samples were read
+ * at least one slot per sample from the start of the block, each slot is
+ * written below the next packed sample to read.
+ */
+static void _wav_stream_unpack24(uint8_t* block, uint32_t offset,
+		uint32_t len)
+{
+	const uint8_t* src = block + offset;
+	uint32_t i;
+
+	for (i = 0; i < len / 3; i++) {
+		block[4 * i] = 0;
+		block[4 * i + 1] = src[3 * i];
+		block[4 * i + 2] = src[3 * i + 1];
+		block[4 * i + 3] = src[3 * i + 2];
+	}
+}
+
+/** \brief Pack 32-bit slots to 24-bit samples in place */
+static void _wav_stream_pack24(uint8_t* block, uint32_t block_size)
+{
+	uint32_t i;
+
+	for (i = 0; i < block_size / 4; i++) {
+		block[3 * i] = block[4 * i + 1];
+		block[3 * i + 1] = block[4 * i + 2];
+		block[3 * i + 2] = block[4 * i + 3];
+	}
+}
+
+static int _wav_stream_callback(void* arg, void* arg2);
+
+static void _wav_stream_submit(struct _wav_stream* stream)
+{
+	struct _callback _cb;
+	uint32_t pending = stream->fs_count - stream->dma_count;
+	bool play = stream->audio->direction == AUDIO_DEVICE_PLAY;
+	uint32_t ready;
+	uint8_t* block;
+
+	/* playback needs a filled block, recording a free one */
+	ready = play ? pending : stream->blocks + pending;
+
+	/* the ring drains at the end of the file, do not account for it */
+	if (ready < stream->stats.min_margin && !(play && stream->eof))
+		stream->stats.min_margin = ready;
+
+	if (ready > 0) {
+		block = _wav_stream_block(stream, stream->dma_count);
+		stream->scratch = false;
+	} else {
+		block = _wav_stream_scratch(stream);
+		if (play)
+			memset(block, 0, stream->block_size);
+		stream->scratch = true;
+		stream->stats.xruns++;
+	}
+
+	callback_set(&_cb, _wav_stream_callback, stream);
+	audio_transfer(stream->audio, block, stream->block_size, &_cb);
+}
+
+static int _wav_stream_callback(void* arg, void* arg2)
+{
+	struct _wav_stream* stream = (struct _wav_stream*)arg;
+
+	if (stream->state != WAV_STREAM_RUNNING)
+		return 0;
+
+	if (!stream->scratch) {
+		stream->dma_count++;
+		stream->stats.blocks++;
+	}
+
+	if (stream->audio->direction == AUDIO_DEVICE_PLAY && stream->eof &&
+	    stream->fs_count == stream->dma_count) {
+		stream->state = WAV_STREAM_DONE;
+		return 0;
+	}
+
+	_wav_stream_submit(stream);
+
+	return 0;
+}
+
+static int _wav_stream_check_format(struct _wav_stream* stream,
+		uint16_t num_channels, uint16_t bits_per_sample,
+		uint16_t slot_bits, uint32_t block_size, uint32_t blocks)
+{
+	if (num_channels == 0 || blocks < 2)
+		return -EINVAL;
+	if (slot_bits != 8 && slot_bits != 16 && slot_bits != 32)
+		return -EINVAL;
+	if (bits_per_sample != slot_bits &&
+	    !(bits_per_sample == 24 && slot_bits == 32))
+		return -EINVAL;
+	if (block_size == 0 || block_size % (num_channels * slot_bits / 8))
+		return -EINVAL;
+
+	stream->sample_bytes = bits_per_sample / 8;
+	stream->slot_bytes = slot_bits / 8;
+
+	return 0;
+}
+
+static void _wav_stream_init(struct _wav_stream* stream,
+		struct _audio_desc* audio, uint8_t* buffer,
+		uint32_t block_size, uint32_t blocks)
+{
+	memset(stream, 0, sizeof(*stream));
+	stream->audio = audio;
+	stream->buffer = buffer;
+	stream->block_size = block_size;
+	stream->blocks = blocks;
+	stream->state = WAV_STREAM_IDLE;
+	stream->stats.min_margin = blocks;
+}
+
+static int _wav_stream_fail(struct _wav_stream* stream, int err)
+{
+	f_close(&stream->file);
+	return err;
+}
+
+/**
+ * \brief Read ahead into the free blocks, up to one ring per call so that a
+ * card slower than the stream does not hold the caller
+ */
+static int _wav_stream_read(struct _wav_stream* stream)
+{
+	uint32_t full = _wav_stream_file_block_size(stream);
+	uint32_t count;
+
+	for (count = 0; count < stream->blocks && !stream->eof &&
+	     stream->fs_count - stream->dma_count < stream->blocks; count++) {
+		uint8_t* block = _wav_stream_block(stream, stream->fs_count);
+		uint32_t len = full;
+		uint32_t offset;
+		UINT br;
+
+		if (len > stream->data_size)
+			len = stream->data_size;
+		offset = stream->block_size - len;
+		if (stream->sample_bytes == stream->slot_bytes)
+			offset = 0;
+
+		if (f_read(&stream->file, block + offset, len, &br) != FR_OK) {
+			stream->error = -EIO;
+			return -EIO;
+		}
+		/* a truncated file ends the data */
+		if (br < len)
+			stream->data_size = 0;
+		else
+			stream->data_size -= len;
+		len = br - br % stream->sample_bytes;
+
+		if (stream->sample_bytes != stream->slot_bytes) {
+			_wav_stream_unpack24(block, offset, len);
+			len = len / stream->sample_bytes * stream->slot_bytes;
+		}
+		if (len < stream->block_size)
+			memset(block + len, 0, stream->block_size - len);
+
+		/* publish the block before the end of file, for the DMA
+		 * callback not to stop on a block it has not played */
+		COMPILER_BARRIER();
+		stream->fs_count++;
+		COMPILER_BARRIER();
+		if (stream->data_size == 0)
+			stream->eof = true;
+	}
+
+	return 0;
+}
+
+/**
+ * \brief Write behind the blocks filled when called, the blocks recorded
+ * meanwhile are left to the next call
+ */
+static int _wav_stream_write(struct _wav_stream* stream)
+{
+	uint32_t len = _wav_stream_file_block_size(stream);
+	uint32_t end = stream->dma_count;
+
+	while (stream->fs_count != end) {
+		uint8_t* block = _wav_stream_block(stream, stream->fs_count);
+		UINT bw;
+
+		if (len > WAV_STREAM_MAX_DATA - stream->data_size)
+			return -EFBIG;
+
+		if (stream->sample_bytes != stream->slot_bytes)
+			_wav_stream_pack24(block, stream->block_size);
+
+		if (f_write(&stream->file, block, len, &bw) != FR_OK ||
+		    bw != len) {
+			stream->error = -EIO;
+			return -EIO;
+		}
+		stream->data_size += len;
+		COMPILER_BARRIER();
+		stream->fs_count++;
+	}
+
+	return 0;
+}
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+int wav_stream_open_play(struct _wav_stream* stream,
+		struct _audio_desc* audio, const char* path,
+		uint8_t* buffer, uint32_t block_size, uint32_t blocks)
+{
+	struct _wav_header* header = &stream->header;
+	struct {
+		uint32_t id;
+		uint32_t size;
+	} chunk;
+	bool fmt = false;
+	uint32_t data_offset;
+	UINT br;
+	int err;
+
+	_wav_stream_init(stream, audio, buffer, block_size, blocks);
+
+	if (f_open(&stream->file, path, FA_READ) != FR_OK)
+		return -ENOENT;
+
+	if (f_read(&stream->file, header, 12, &br) != FR_OK)
+		return _wav_stream_fail(stream, -EIO);
+	if (br != 12 || header->chunk_id != WAV_CHUNKID ||
+	    header->format != WAV_FORMAT)
+		return _wav_stream_fail(stream, -EINVAL);
+
+	/* walk the chunks up to the data, skipping the unknown ones */
+	for (;;) {
+		if (f_read(&stream->file, &chunk, sizeof(chunk), &br) != FR_OK)
+			return _wav_stream_fail(stream, -EIO);
+		if (br != sizeof(chunk))
+			return _wav_stream_fail(stream, -EINVAL);
+
+		if (chunk.id == WAV_DATAID)
+			break;
+
+		if (chunk.id == WAV_SUBCHUNKID && chunk.size >= 16) {
+			header->subchunk1_id = chunk.id;
+			header->subchunk1_size = chunk.size;
+			if (f_read(&stream->file, &header->audio_format, 16,
+				   &br) != FR_OK)
+				return _wav_stream_fail(stream, -EIO);
+			if (br != 16)
+				return _wav_stream_fail(stream, -EINVAL);
+			chunk.size -= 16;
+			fmt = true;
+		}
+		if (f_lseek(&stream->file, f_tell(&stream->file) +
+			    chunk.size + (chunk.size & 1)) != FR_OK)
+			return _wav_stream_fail(stream, -EIO);
+	}
+
+	if (!fmt || (header->audio_format != WAV_FORMAT_PCM &&
+		     header->audio_format != WAV_FORMAT_EXTENSIBLE))
+		return _wav_stream_fail(stream, -EINVAL);
+
+	err = _wav_stream_check_format(stream, header->num_channels,
+			header->bits_per_sample,
+			header->bits_per_sample == 24 ? 32 : header->bits_per_sample,
+			block_size, blocks);
+	if (err < 0)
+		return _wav_stream_fail(stream, err);
+
+	/* streamed files may not have the data size filled in */
+	data_offset = f_tell(&stream->file);
+	stream->data_size = f_size(&stream->file) - data_offset;
+	if (chunk.size < stream->data_size)
+		stream->data_size = chunk.size;
+	stream->data_size -= stream->data_size % (header->num_channels *
+						  stream->sample_bytes);
+	header->subchunk2_id = chunk.id;
+	header->subchunk2_size = stream->data_size;
+	stream->eof = stream->data_size == 0;
+
+	audio->sample_rate = header->sample_rate;
+	audio->num_channels = header->num_channels;
+	audio->bits_per_sample = stream->slot_bytes * 8;
+
+	return 0;
+}
+
+int wav_stream_open_record(struct _wav_stream* stream,
+		struct _audio_desc* audio, const char* path,
+		uint16_t bits_per_sample, uint8_t* buffer,
+		uint32_t block_size, uint32_t blocks)
+{
+	UINT bw;
+	int err;
+
+	_wav_stream_init(stream, audio, buffer, block_size, blocks);
+
+	err = _wav_stream_check_format(stream, audio->num_channels,
+			bits_per_sample, audio->bits_per_sample,
+			block_size, blocks);
+	if (err < 0)
+		return err;
+
+	if (f_open(&stream->file, path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+		return -ENOENT;
+
+	/* sizes are filled in by wav_stream_stop() */
+	wav_init_header(&stream->header, audio->sample_rate,
+			audio->num_channels, bits_per_sample, 0);
+	if (f_write(&stream->file, &stream->header, sizeof(stream->header),
+		    &bw) != FR_OK || bw != sizeof(stream->header))
+		return _wav_stream_fail(stream, -EIO);
+
+	return 0;
+}
+
+int wav_stream_start(struct _wav_stream* stream)
+{
+	int err;
+
+	if (stream->state != WAV_STREAM_IDLE)
+		return -EBUSY;
+
+	if (stream->audio->direction == AUDIO_DEVICE_PLAY) {
+		err = _wav_stream_read(stream);
+		if (err < 0)
+			return err;
+		if (stream->fs_count == 0) {
+			stream->state = WAV_STREAM_DONE;
+			return 0;
+		}
+	}
+
+	stream->state = WAV_STREAM_RUNNING;
+	_wav_stream_submit(stream);
+
+	return 0;
+}
+
+int wav_stream_poll(struct _wav_stream* stream)
+{
+	if (stream->error)
+		return stream->error;
+	if (stream->state == WAV_STREAM_IDLE)
+		return 0;
+
+	if (stream->audio->direction == AUDIO_DEVICE_PLAY)
+		return _wav_stream_read(stream);
+	else
+		return _wav_stream_write(stream);
+}
+
+bool wav_stream_is_done(struct _wav_stream* stream)
+{
+	return stream->state == WAV_STREAM_DONE;
+}
+
+int wav_stream_stop(struct _wav_stream* stream)
+{
+	int err = 0;
+	UINT bw;
+
+	if (stream->state == WAV_STREAM_RUNNING)
+		audio_stop(stream->audio);
+	stream->state = WAV_STREAM_DONE;
+
+	if (stream->audio->direction == AUDIO_DEVICE_RECORD) {
+		/* the block being recorded when stopped is dropped */
+		err = _wav_stream_write(stream);
+		if (err == -EFBIG)
+			err = 0;
+
+		stream->header.chunk_size = sizeof(stream->header) - 8
+			+ stream->data_size;
+		stream->header.subchunk2_size = stream->data_size;
+		if (f_lseek(&stream->file, 0) != FR_OK ||
+		    f_write(&stream->file, &stream->header,
+			    sizeof(stream->header), &bw) != FR_OK ||
+		    bw != sizeof(stream->header))
+			err = -EIO;
+	}
+
+	if (f_close(&stream->file) != FR_OK)
+		err = -EIO;
+
+	return err;
+}
+
+void wav_stream_get_stats(struct _wav_stream* stream,
+		struct _wav_stream_stats* stats)
+{
+	*stats = stream->stats;
+}
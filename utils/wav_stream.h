@@ -0,0 +1,199 @@
+/* ----------------------------------------------------------------------------
+ *         SAM Software Package License
+ * ----------------------------------------------------------------------------
+ * Copyright (c) 2017, Atmel Corporation
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * - Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the disclaimer below.
+ *
+ * Atmel's name may not be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * DISCLAIMER: THIS SOFTWARE IS PROVIDED BY ATMEL "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT ARE
+ * DISCLAIMED. IN NO EVENT SHALL ATMEL BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+ * OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ * EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ * ----------------------------------------------------------------------------
+ */
+
+/**
+ * \file
+ *
+ * Streaming of Wav files between FatFs and an audio device.
+ *
+ * The stream owns a ring of blocks shared between the file system, served
+ * from the main loop by wav_stream_poll(), and the audio DMA, chained from
+ * its completion interrupt. On playback the file is read ahead into the free
+ * blocks, on recording the filled blocks are written behind.
+ *
+ * When the file system falls behind, the DMA plays silence (or records into
+ * a scratch block that is dropped) for one block and retries, so the audio
+ * device never stops; such blocks are counted as xruns. The smallest number
+ * of blocks ready ahead of the DMA is recorded as the stream margin.
+ *
+ * 24-bit samples are packed on three bytes in the file and MSB-aligned in
+ * 32-bit slots on the audio side, the conversion is done in place in the
+ * ring.
+ *
+ * Blocks should be multiple of the sector size for FatFs to transfer them
+ * directly between the ring and the media.
+ */
+
+#ifndef WAV_STREAM_H
+#define WAV_STREAM_H
+
+/*----------------------------------------------------------------------------
+ *        Headers
+ *----------------------------------------------------------------------------*/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "audio/audio_device.h"
+#include "ff.h"
+#include "wav.h"
+
+/*----------------------------------------------------------------------------
+ *        Types
+ *----------------------------------------------------------------------------*/
+
+enum _wav_stream_state {
+	WAV_STREAM_IDLE,
+	WAV_STREAM_RUNNING,
+	WAV_STREAM_DONE,
+};
+
+struct _wav_stream_stats {
+	uint32_t blocks;       /**< blocks transferred by the audio device */
+	uint32_t xruns;        /**< silence or dropped blocks */
+	uint32_t min_margin;   /**< fewest blocks ready when the DMA needed one */
+};
+
+struct _wav_stream {
+	FIL file;
+	struct _audio_desc* audio;
+	struct _wav_header header;
+
+	uint8_t* buffer;          /**< ring blocks followed by the scratch block */
+	uint32_t block_size;      /**< audio bytes per block */
+	uint32_t blocks;          /**< blocks in the ring */
+	uint8_t sample_bytes;     /**< bytes per sample in the file */
+	uint8_t slot_bytes;       /**< bytes per sample on the audio side */
+
+	uint32_t data_size;       /**< playback: bytes left, record: bytes written */
+	int error;
+
+	volatile uint32_t fs_count;  /**< blocks read or written by FatFs */
+	volatile uint32_t dma_count; /**< blocks transferred by the DMA */
+	volatile bool scratch;       /**< the DMA is using the scratch block */
+	volatile bool eof;
+	volatile uint8_t state;      /**< enum _wav_stream_state */
+
+	struct _wav_stream_stats stats;
+};
+
+/*----------------------------------------------------------------------------
+ *        Exported functions
+ *----------------------------------------------------------------------------*/
+
+/**
+ * \brief Open a Wav file for playback.
+ *
+ * The sample rate, number of channels and sample size of the audio
+ * descriptor are set from the file: the caller then configures and enables
+ * the audio device before starting the stream.
+ *
+ * \param stream Stream to initialize.
+ * \param audio Audio playback device.
+ * \param path Path of the file.
+ * \param buffer Ring memory, (blocks + 1) * block_size bytes, cache aligned.
+ * \param block_size Size of a block, multiple of 4 * number of channels.
+ * \param blocks Number of blocks in the ring (at least 2).
+ * \return 0 on success, -ENOENT if the file cannot be opened, -EINVAL if it
+ * is not a supported PCM Wav file or the block size does not fit it, -EIO
+ * on read errors.
+ */
+extern int wav_stream_open_play(struct _wav_stream* stream,
+		struct _audio_desc* audio, const char* path,
+		uint8_t* buffer, uint32_t block_size, uint32_t blocks);
+
+/**
+ * \brief Create a Wav file for recording.
+ *
+ * The format is taken from the audio descriptor, with bits_per_sample
+ * bits per sample in the file (24 for 32-bit slots, or the slot size).
+ * The header is finalized by wav_stream_stop().
+ *
+ * \param stream Stream to initialize.
+ * \param audio Audio record device.
+ * \param path Path of the file, overwritten if it exists.
+ * \param bits_per_sample Sample size in the file.
+ * \param buffer Ring memory, (blocks + 1) * block_size bytes, cache aligned.
+ * \param block_size Size of a block, multiple of 4 * number of channels.
+ * \param blocks Number of blocks in the ring (at least 2).
+ * \return 0 on success, -ENOENT if the file cannot be created, -EINVAL on
+ * unsupported format, -EIO on write errors.
+ */
+extern int wav_stream_open_record(struct _wav_stream* stream,
+		struct _audio_desc* audio, const char* path,
+		uint16_t bits_per_sample, uint8_t* buffer,
+		uint32_t block_size, uint32_t blocks);
+
+/**
+ * \brief Start the audio transfers.
+ *
+ * Playback streams fill the whole ring before starting.
+ *
+ * \param stream Opened stream.
+ * \return 0 on success, -EIO on file errors, -EBUSY if already started.
+ */
+extern int wav_stream_start(struct _wav_stream* stream);
+
+/**
+ * \brief Move data between the ring and the file, to be called from the
+ * main loop at least once per block duration. Each call moves at most one
+ * ring of blocks, and returns even if the card is slower than the stream.
+ *
+ * \param stream Stream.
+ * \return 0 on success, -EIO on file errors, -EFBIG when a recording
+ * reached the maximum Wav data size: the stream should be stopped.
+ */
+extern int wav_stream_poll(struct _wav_stream* stream);
+
+/**
+ * \brief Check whether a playback stream has played the whole file.
+ * \param stream Stream.
+ */
+extern bool wav_stream_is_done(struct _wav_stream* stream);
+
+/**
+ * \brief Stop the audio transfers and close the file.
+ *
+ * Recording streams write the blocks left in the ring and finalize the
+ * header.
+ *
+ * \param stream Stream.
+ * \return 0 on success, -EIO on file errors.
+ */
+extern int wav_stream_stop(struct _wav_stream* stream);
+
+/**
+ * \brief Get the transfer statistics of a stream.
+ * \param stream Stream.
+ * \param stats Filled with the statistics.
+ */
+extern void wav_stream_get_stats(struct _wav_stream* stream,
+		struct _wav_stream_stats* stats);
+
+#endif /* WAV_STREAM_H */